@@ -244,6 +244,7 @@ const std::unordered_map<std::wstring, int> ACCELERATOR_MAPPINGS = {
 	{L"search", IDM_TOOLS_SEARCH},
 	{L"customize_colors", IDM_TOOLS_CUSTOMIZECOLORS},
 	{L"run_script", IDM_TOOLS_RUNSCRIPT},
+	{L"memory_usage", IDM_TOOLS_MEMORYUSAGE},
 	{L"options", IDM_TOOLS_OPTIONS},
 
 	{L"help", IDM_HELP_HELP},
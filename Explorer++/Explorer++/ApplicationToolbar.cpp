@@ -28,6 +28,7 @@
 #include "../Helper/RegistrySettings.h"
 #include "../Helper/ShellHelper.h"
 #include "../Helper/XMLSettings.h"
+#include "../Helper/XmlStream.h"
 #include <boost/algorithm/string.hpp>
 #include <boost/format.hpp>
 #include <comdef.h>
@@ -531,94 +532,64 @@ void ApplicationToolbarPersistentSettings::SaveRegistrySettings(HKEY hParentKey)
 	}
 }
 
-void ApplicationToolbarPersistentSettings::LoadXMLSettings(IXMLDOMNode *pNode)
+void ApplicationToolbarPersistentSettings::LoadXMLSettings(XmlStreamReader &reader)
 {
-	TCHAR szName[512];
-	TCHAR szCommand[512];
-	BOOL bShowNameOnToolbar = TRUE;
+	int depth = reader.GetDepth();
 
-	BOOL bNameFound = FALSE;
-	BOOL bCommandFound = FALSE;
-
-	IXMLDOMNamedNodeMap *am = nullptr;
-	HRESULT hr = pNode->get_attributes(&am);
-
-	if (FAILED(hr))
+	while (reader.ReadChildElement(depth))
 	{
-		return;
-	}
-
-	long lChildNodes;
-	am->get_length(&lChildNodes);
-
-	for (int i = 0; i < lChildNodes; i++)
-	{
-		IXMLDOMNode *pAttributeNode = nullptr;
-		am->get_item(i, &pAttributeNode);
-
-		BSTR bstrName;
-		BSTR bstrValue;
-		pAttributeNode->get_nodeName(&bstrName);
-		pAttributeNode->get_text(&bstrValue);
-
-		if (lstrcmpi(bstrName, SETTING_NAME) == 0)
+		if (reader.GetName() != L"ApplicationButton")
 		{
-			StringCchCopy(szName, SIZEOF_ARRAY(szName), bstrValue);
-
-			bNameFound = TRUE;
+			continue;
 		}
-		else if (lstrcmpi(bstrName, SETTING_COMMAND) == 0)
-		{
-			StringCchCopy(szCommand, SIZEOF_ARRAY(szCommand), bstrValue);
 
-			bCommandFound = TRUE;
-		}
-		else if (lstrcmpi(bstrName, SETTING_SHOW_NAME_ON_TOOLBAR) == 0)
+		TCHAR szName[512];
+		TCHAR szCommand[512];
+		BOOL bShowNameOnToolbar = TRUE;
+
+		BOOL bNameFound = FALSE;
+		BOOL bCommandFound = FALSE;
+
+		for (size_t i = 0; i < reader.GetNumAttributes(); i++)
 		{
-			bShowNameOnToolbar = NXMLSettings::DecodeBoolValue(bstrValue);
-		}
-	}
+			const WCHAR *name = reader.GetAttributeName(i).c_str();
+			const WCHAR *value = reader.GetAttributeValue(i).c_str();
 
-	if (bNameFound && bCommandFound)
-	{
-		AddButton(szName, szCommand, bShowNameOnToolbar, nullptr);
-	}
+			if (lstrcmpi(name, SETTING_NAME) == 0)
+			{
+				StringCchCopy(szName, SIZEOF_ARRAY(szName), value);
 
-	IXMLDOMNode *pNextSibling = nullptr;
-	hr = pNode->get_nextSibling(&pNextSibling);
+				bNameFound = TRUE;
+			}
+			else if (lstrcmpi(name, SETTING_COMMAND) == 0)
+			{
+				StringCchCopy(szCommand, SIZEOF_ARRAY(szCommand), value);
 
-	if (hr == S_OK)
-	{
-		hr = pNextSibling->get_nextSibling(&pNextSibling);
+				bCommandFound = TRUE;
+			}
+			else if (lstrcmpi(name, SETTING_SHOW_NAME_ON_TOOLBAR) == 0)
+			{
+				bShowNameOnToolbar = NXMLSettings::DecodeBoolValue(value);
+			}
+		}
 
-		if (hr == S_OK)
+		if (bNameFound && bCommandFound)
 		{
-			LoadXMLSettings(pNextSibling);
+			AddButton(szName, szCommand, bShowNameOnToolbar, nullptr);
 		}
 	}
 }
 
-void ApplicationToolbarPersistentSettings::SaveXMLSettings(
-	IXMLDOMDocument *pXMLDom, IXMLDOMElement *pe)
+void ApplicationToolbarPersistentSettings::SaveXMLSettings(XmlStreamWriter &writer)
 {
-	BSTR bstr_wsntt = SysAllocString(L"\n\t\t");
-
 	for (const auto &button : m_Buttons)
 	{
-		NXMLSettings::AddWhiteSpaceToNode(pXMLDom, bstr_wsntt, pe);
-
-		IXMLDOMElement *pParentNode = nullptr;
-		NXMLSettings::CreateElementNode(
-			pXMLDom, &pParentNode, pe, _T("ApplicationButton"), button.Name.c_str());
-		NXMLSettings::AddAttributeToNode(
-			pXMLDom, pParentNode, SETTING_COMMAND, button.Command.c_str());
-		NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_SHOW_NAME_ON_TOOLBAR,
+		NXMLSettings::StartNamedElement(writer, _T("ApplicationButton"), button.Name.c_str());
+		writer.WriteAttribute(SETTING_COMMAND, button.Command);
+		writer.WriteAttribute(SETTING_SHOW_NAME_ON_TOOLBAR,
 			NXMLSettings::EncodeBoolValue(button.ShowNameOnToolbar));
-
-		pParentNode->Release();
+		writer.EndElement();
 	}
-
-	SysFreeString(bstr_wsntt);
 }
 
 bool ApplicationToolbarPersistentSettings::AddButton(const std::wstring &name,
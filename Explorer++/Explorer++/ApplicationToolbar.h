@@ -13,6 +13,8 @@
 class ApplicationToolbar;
 class ApplicationToolbarDropHandler;
 __interface IExplorerplusplus;
+class XmlStreamReader;
+class XmlStreamWriter;
 
 struct ApplicationButton
 {
@@ -31,8 +33,8 @@ public:
 	void SaveRegistrySettings(HKEY hParentKey);
 	void LoadRegistrySettings(HKEY hParentKey);
 
-	void SaveXMLSettings(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pe);
-	void LoadXMLSettings(IXMLDOMNode *pNode);
+	void SaveXMLSettings(XmlStreamWriter &writer);
+	void LoadXMLSettings(XmlStreamReader &reader);
 
 private:
 	friend ApplicationToolbar;
@@ -0,0 +1,596 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "Bookmarks/BookmarkBinaryStorage.h"
+#include "Bookmarks/BookmarkTree.h"
+#include "../Helper/MappedFile.h"
+#include "../ThirdParty/cereal/archives/binary.hpp"
+#include <wil/resource.h>
+#include <optional>
+#include <sstream>
+#include <unordered_map>
+
+// The snapshot is laid out as follows:
+//
+// Header:
+//   uint32 magic, uint32 version
+//   uint32 size of each section (bookmarks toolbar, bookmarks menu, other
+//   bookmarks)
+//
+// Each section:
+//   uint64 date created, uint64 date modified (of the permanent folder)
+//   uint32 number of child items, uint32 total number of items
+//   GUID table: 16 bytes for each item, in the same order as the items
+//   uint32 number of non-standard GUIDs, then an item index and string for each
+//   Items, in pre-order:
+//     uint8 type, string name, string location (bookmarks only),
+//     uint64 date created, uint64 date modified,
+//     uint32 number of children (folders only)
+//
+// Strings are stored as a 32-bit length, followed by the UTF-16 code units.
+// Because each item's children immediately follow it, the items in a section
+// can be rebuilt in a single sequential read.
+
+namespace
+{
+// Allows a block of memory (e.g. a mapped view of a file) to be read through a
+// std::istream without being copied.
+class MemoryStreamBuffer : public std::streambuf
+{
+public:
+	MemoryStreamBuffer(const uint8_t *data, size_t size)
+	{
+		auto *start = reinterpret_cast<char *>(const_cast<uint8_t *>(data));
+		setg(start, start, start + size);
+	}
+};
+
+void WriteString(cereal::BinaryOutputArchive &archive, const std::wstring &text)
+{
+	archive(static_cast<uint32_t>(text.size()));
+	archive(cereal::binary_data(text.data(), text.size() * sizeof(wchar_t)));
+}
+
+void ReadString(cereal::BinaryInputArchive &archive, size_t maxLength, std::wstring &text)
+{
+	uint32_t length;
+	archive(length);
+
+	// The length is checked before anything is allocated, so that a corrupt
+	// length can't result in an excessively large allocation.
+	if (length > maxLength)
+	{
+		throw cereal::Exception("Invalid string length");
+	}
+
+	text.resize(length);
+	archive(cereal::binary_data(text.data(), length * sizeof(wchar_t)));
+}
+
+uint64_t FileTimeToUint64(const FILETIME &fileTime)
+{
+	return (static_cast<uint64_t>(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime;
+}
+
+FILETIME Uint64ToFileTime(uint64_t value)
+{
+	FILETIME fileTime;
+	fileTime.dwLowDateTime = static_cast<DWORD>(value);
+	fileTime.dwHighDateTime = static_cast<DWORD>(value >> 32);
+	return fileTime;
+}
+
+std::wstring FormatGuid(const GUID &guid)
+{
+	WCHAR guidString[40];
+	StringFromGUID2(guid, guidString, SIZEOF_ARRAY(guidString));
+
+	// Matches the format used by CreateGUID() (i.e. without the surrounding
+	// braces).
+	std::wstring finalValue = guidString;
+	return finalValue.substr(1, finalValue.length() - 2);
+}
+
+// GUIDs are stored in their 16-byte binary form where possible. That's only the
+// case if formatting the binary form produces exactly the original string,
+// which won't be true for a GUID that was edited by hand (e.g. in the config
+// file).
+bool ParseGuid(const std::wstring &guidString, GUID &guid)
+{
+	std::wstring bracedGuid = L"{" + guidString + L"}";
+
+	if (FAILED(IIDFromString(bracedGuid.c_str(), &guid)))
+	{
+		return false;
+	}
+
+	return FormatGuid(guid) == guidString;
+}
+
+void CollectItems(const BookmarkItem *folder, std::vector<const BookmarkItem *> &items)
+{
+	for (const auto &child : folder->GetChildren())
+	{
+		items.push_back(child.get());
+
+		if (child->IsFolder())
+		{
+			CollectItems(child.get(), items);
+		}
+	}
+}
+}
+
+BookmarkBinaryStorage::BookmarkBinaryStorage(BookmarkTree *bookmarkTree) :
+	m_bookmarkTree(bookmarkTree),
+	m_sections{ { Section{ bookmarkTree->GetBookmarksToolbarFolder() },
+		Section{ bookmarkTree->GetBookmarksMenuFolder() },
+		Section{ bookmarkTree->GetOtherBookmarksFolder() } } }
+{
+	m_connections.push_back(m_bookmarkTree->bookmarkItemAddedSignal.AddObserver(
+		std::bind(&BookmarkBinaryStorage::OnBookmarkItemAdded, this, std::placeholders::_1,
+			std::placeholders::_2)));
+	m_connections.push_back(m_bookmarkTree->bookmarkItemUpdatedSignal.AddObserver(
+		std::bind(&BookmarkBinaryStorage::OnBookmarkItemUpdated, this, std::placeholders::_1,
+			std::placeholders::_2)));
+	m_connections.push_back(m_bookmarkTree->bookmarkItemMovedSignal.AddObserver(
+		std::bind(&BookmarkBinaryStorage::OnBookmarkItemMoved, this, std::placeholders::_1,
+			std::placeholders::_2, std::placeholders::_3, std::placeholders::_4,
+			std::placeholders::_5)));
+	m_connections.push_back(m_bookmarkTree->bookmarkItemPreRemovalSignal.AddObserver(
+		std::bind(&BookmarkBinaryStorage::OnBookmarkItemPreRemoval, this, std::placeholders::_1)));
+}
+
+bool BookmarkBinaryStorage::Load(const std::filesystem::path &path)
+{
+	auto mappedFile = MappedFile::Open(path);
+
+	if (!mappedFile)
+	{
+		return false;
+	}
+
+	return Load(mappedFile->GetData(), mappedFile->GetSize());
+}
+
+bool BookmarkBinaryStorage::Load(const uint8_t *data, size_t size)
+{
+	constexpr size_t HEADER_SIZE = (2 + NUM_SECTIONS) * sizeof(uint32_t);
+
+	if (size < HEADER_SIZE)
+	{
+		return false;
+	}
+
+	std::array<size_t, NUM_SECTIONS> sectionOffsets;
+	std::array<size_t, NUM_SECTIONS> sectionSizes;
+	std::array<BookmarkItems, NUM_SECTIONS> sectionItems;
+	std::array<FILETIME, NUM_SECTIONS> datesCreated;
+	std::array<FILETIME, NUM_SECTIONS> datesModified;
+
+	// Nothing is added to the tree until the entire snapshot has been read, so
+	// that a corrupt snapshot doesn't result in a partially loaded tree.
+	try
+	{
+		MemoryStreamBuffer streamBuffer(data, HEADER_SIZE);
+		std::istream stream(&streamBuffer);
+		cereal::BinaryInputArchive archive(stream);
+
+		uint32_t magic;
+		uint32_t version;
+		archive(magic, version);
+
+		if (magic != FILE_MAGIC || version != FILE_VERSION)
+		{
+			return false;
+		}
+
+		size_t offset = HEADER_SIZE;
+
+		for (size_t i = 0; i < m_sections.size(); i++)
+		{
+			uint32_t sectionSize;
+			archive(sectionSize);
+
+			if (sectionSize > size - offset)
+			{
+				return false;
+			}
+
+			sectionOffsets[i] = offset;
+			sectionSizes[i] = sectionSize;
+			offset += sectionSize;
+		}
+
+		for (size_t i = 0; i < m_sections.size(); i++)
+		{
+			if (!DeserializeSection(data + sectionOffsets[i], sectionSizes[i], sectionItems[i],
+					datesCreated[i], datesModified[i]))
+			{
+				return false;
+			}
+		}
+	}
+	catch (const cereal::Exception &)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < m_sections.size(); i++)
+	{
+		auto &section = m_sections[i];
+		assert(section.folder->GetChildren().empty());
+
+		size_t index = 0;
+
+		for (auto &bookmarkItem : sectionItems[i])
+		{
+			m_bookmarkTree->AddBookmarkItem(section.folder, std::move(bookmarkItem), index++);
+		}
+
+		section.folder->SetDateCreated(datesCreated[i]);
+		section.folder->SetDateModified(datesModified[i]);
+
+		// The folder now matches the snapshot, so the data that was read can be
+		// written back out as-is until something in the folder changes.
+		section.data.assign(reinterpret_cast<const char *>(data + sectionOffsets[i]),
+			sectionSizes[i]);
+		section.dirty = false;
+	}
+
+	return true;
+}
+
+bool BookmarkBinaryStorage::Save(const std::filesystem::path &path)
+{
+	std::string data = Serialize();
+
+	std::filesystem::path tempPath = path;
+	tempPath += L".tmp";
+
+	wil::unique_hfile file(CreateFile(tempPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL, nullptr));
+
+	if (!file)
+	{
+		return false;
+	}
+
+	DWORD numBytesWritten;
+	BOOL res = WriteFile(
+		file.get(), data.data(), static_cast<DWORD>(data.size()), &numBytesWritten, nullptr);
+
+	// The data is flushed before the file is renamed, so that a crash can't
+	// result in the existing snapshot being replaced with one that's incomplete.
+	if (!res || numBytesWritten != data.size() || !FlushFileBuffers(file.get()))
+	{
+		file.reset();
+		DeleteFile(tempPath.c_str());
+		return false;
+	}
+
+	file.reset();
+
+	res = MoveFileEx(tempPath.c_str(), path.c_str(),
+		MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+
+	if (!res)
+	{
+		DeleteFile(tempPath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+std::string BookmarkBinaryStorage::Serialize()
+{
+	for (auto &section : m_sections)
+	{
+		if (section.dirty)
+		{
+			section.data = SerializeSection(section.folder);
+			section.dirty = false;
+		}
+	}
+
+	std::ostringstream stream;
+
+	{
+		cereal::BinaryOutputArchive archive(stream);
+		archive(FILE_MAGIC, FILE_VERSION);
+
+		for (const auto &section : m_sections)
+		{
+			archive(static_cast<uint32_t>(section.data.size()));
+		}
+
+		for (const auto &section : m_sections)
+		{
+			archive(cereal::binary_data(section.data.data(), section.data.size()));
+		}
+	}
+
+	return stream.str();
+}
+
+std::string BookmarkBinaryStorage::SerializeSection(const BookmarkItem *folder)
+{
+	std::vector<const BookmarkItem *> items;
+	CollectItems(folder, items);
+
+	std::ostringstream stream;
+
+	{
+		cereal::BinaryOutputArchive archive(stream);
+		archive(FileTimeToUint64(folder->GetDateCreated()),
+			FileTimeToUint64(folder->GetDateModified()));
+		archive(static_cast<uint32_t>(folder->GetChildren().size()),
+			static_cast<uint32_t>(items.size()));
+
+		std::vector<std::pair<uint32_t, std::wstring>> nonStandardGuids;
+
+		for (uint32_t i = 0; i < items.size(); i++)
+		{
+			std::wstring guidString = items[i]->GetGUID();
+			GUID guid;
+
+			if (!ParseGuid(guidString, guid))
+			{
+				guid = GUID_NULL;
+				nonStandardGuids.emplace_back(i, guidString);
+			}
+
+			archive(cereal::binary_data(&guid, sizeof(guid)));
+		}
+
+		archive(static_cast<uint32_t>(nonStandardGuids.size()));
+
+		for (const auto &[index, guidString] : nonStandardGuids)
+		{
+			archive(index);
+			WriteString(archive, guidString);
+		}
+
+		for (const auto *bookmarkItem : items)
+		{
+			archive(static_cast<uint8_t>(bookmarkItem->GetType()));
+			WriteString(archive, bookmarkItem->GetName());
+
+			if (bookmarkItem->IsBookmark())
+			{
+				WriteString(archive, bookmarkItem->GetLocation());
+			}
+
+			archive(FileTimeToUint64(bookmarkItem->GetDateCreated()),
+				FileTimeToUint64(bookmarkItem->GetDateModified()));
+
+			if (bookmarkItem->IsFolder())
+			{
+				archive(static_cast<uint32_t>(bookmarkItem->GetChildren().size()));
+			}
+		}
+	}
+
+	return stream.str();
+}
+
+bool BookmarkBinaryStorage::DeserializeSection(const uint8_t *data, size_t size,
+	BookmarkItems &items, FILETIME &dateCreated, FILETIME &dateModified)
+{
+	MemoryStreamBuffer streamBuffer(data, size);
+	std::istream stream(&streamBuffer);
+	cereal::BinaryInputArchive archive(stream);
+
+	// No string can be longer than the section itself.
+	size_t maxStringLength = size / sizeof(wchar_t);
+
+	uint64_t folderDateCreated;
+	uint64_t folderDateModified;
+	archive(folderDateCreated, folderDateModified);
+
+	dateCreated = Uint64ToFileTime(folderDateCreated);
+	dateModified = Uint64ToFileTime(folderDateModified);
+
+	uint32_t numTopLevelItems;
+	uint32_t numItems;
+	archive(numTopLevelItems, numItems);
+
+	if (numItems > size / sizeof(GUID))
+	{
+		return false;
+	}
+
+	std::vector<GUID> guids(numItems);
+	archive(cereal::binary_data(guids.data(), guids.size() * sizeof(GUID)));
+
+	uint32_t numNonStandardGuids;
+	archive(numNonStandardGuids);
+
+	if (numNonStandardGuids > numItems)
+	{
+		return false;
+	}
+
+	std::unordered_map<uint32_t, std::wstring> nonStandardGuids;
+
+	for (uint32_t i = 0; i < numNonStandardGuids; i++)
+	{
+		uint32_t index;
+		archive(index);
+
+		std::wstring guidString;
+		ReadString(archive, maxStringLength, guidString);
+
+		if (index >= numItems)
+		{
+			return false;
+		}
+
+		nonStandardGuids[index] = guidString;
+	}
+
+	struct PendingFolder
+	{
+		BookmarkItem *folder;
+		uint32_t numRemainingChildren;
+		FILETIME dateModified;
+	};
+
+	// The folders whose children are still being read. Using an explicit stack
+	// (rather than recursion) means that deeply nested folders can't exhaust
+	// the call stack.
+	std::vector<PendingFolder> pendingFolders;
+	uint32_t numRemainingTopLevelItems = numTopLevelItems;
+
+	for (uint32_t i = 0; i < numItems; i++)
+	{
+		uint8_t type;
+		archive(type);
+
+		if (type != static_cast<uint8_t>(BookmarkItem::Type::Folder)
+			&& type != static_cast<uint8_t>(BookmarkItem::Type::Bookmark))
+		{
+			return false;
+		}
+
+		std::wstring name;
+		ReadString(archive, maxStringLength, name);
+
+		std::optional<std::wstring> location;
+
+		if (type == static_cast<uint8_t>(BookmarkItem::Type::Bookmark))
+		{
+			std::wstring bookmarkLocation;
+			ReadString(archive, maxStringLength, bookmarkLocation);
+			location = bookmarkLocation;
+		}
+
+		uint64_t itemDateCreated;
+		uint64_t itemDateModified;
+		archive(itemDateCreated, itemDateModified);
+
+		uint32_t numChildren = 0;
+
+		if (type == static_cast<uint8_t>(BookmarkItem::Type::Folder))
+		{
+			archive(numChildren);
+		}
+
+		auto guidItr = nonStandardGuids.find(i);
+		std::wstring guid =
+			(guidItr != nonStandardGuids.end()) ? guidItr->second : FormatGuid(guids[i]);
+
+		auto bookmarkItem = std::make_unique<BookmarkItem>(guid, name, location);
+		bookmarkItem->SetDateCreated(Uint64ToFileTime(itemDateCreated));
+
+		BookmarkItem *rawBookmarkItem;
+
+		if (pendingFolders.empty())
+		{
+			if (numRemainingTopLevelItems == 0)
+			{
+				return false;
+			}
+
+			numRemainingTopLevelItems--;
+			items.push_back(std::move(bookmarkItem));
+			rawBookmarkItem = items.back().get();
+		}
+		else
+		{
+			pendingFolders.back().numRemainingChildren--;
+			rawBookmarkItem = pendingFolders.back().folder->AddChild(std::move(bookmarkItem));
+		}
+
+		// Adding a child to a folder updates the folder's modification date, so
+		// that date can only be set once all the children have been added.
+		if (numChildren > 0)
+		{
+			pendingFolders.push_back(
+				{ rawBookmarkItem, numChildren, Uint64ToFileTime(itemDateModified) });
+		}
+		else
+		{
+			rawBookmarkItem->SetDateModified(Uint64ToFileTime(itemDateModified));
+		}
+
+		while (!pendingFolders.empty() && pendingFolders.back().numRemainingChildren == 0)
+		{
+			pendingFolders.back().folder->SetDateModified(pendingFolders.back().dateModified);
+			pendingFolders.pop_back();
+		}
+	}
+
+	return pendingFolders.empty() && numRemainingTopLevelItems == 0;
+}
+
+BookmarkBinaryStorage::Section *BookmarkBinaryStorage::GetSectionForItem(
+	const BookmarkItem *bookmarkItem)
+{
+	const BookmarkItem *currentItem = bookmarkItem;
+
+	while (currentItem && currentItem->GetParent() != m_bookmarkTree->GetRoot())
+	{
+		currentItem = currentItem->GetParent();
+	}
+
+	if (!currentItem)
+	{
+		return nullptr;
+	}
+
+	for (auto &section : m_sections)
+	{
+		if (section.folder == currentItem)
+		{
+			return &section;
+		}
+	}
+
+	return nullptr;
+}
+
+void BookmarkBinaryStorage::MarkSectionDirty(const BookmarkItem *bookmarkItem)
+{
+	Section *section = GetSectionForItem(bookmarkItem);
+
+	if (section)
+	{
+		section->dirty = true;
+	}
+}
+
+void BookmarkBinaryStorage::OnBookmarkItemAdded(BookmarkItem &bookmarkItem, size_t index)
+{
+	UNREFERENCED_PARAMETER(index);
+
+	MarkSectionDirty(&bookmarkItem);
+}
+
+void BookmarkBinaryStorage::OnBookmarkItemUpdated(
+	BookmarkItem &bookmarkItem, BookmarkItem::PropertyType propertyType)
+{
+	UNREFERENCED_PARAMETER(propertyType);
+
+	MarkSectionDirty(&bookmarkItem);
+}
+
+void BookmarkBinaryStorage::OnBookmarkItemMoved(BookmarkItem *bookmarkItem,
+	const BookmarkItem *oldParent, size_t oldIndex, const BookmarkItem *newParent,
+	size_t newIndex)
+{
+	UNREFERENCED_PARAMETER(bookmarkItem);
+	UNREFERENCED_PARAMETER(oldIndex);
+	UNREFERENCED_PARAMETER(newIndex);
+
+	MarkSectionDirty(oldParent);
+	MarkSectionDirty(newParent);
+}
+
+void BookmarkBinaryStorage::OnBookmarkItemPreRemoval(BookmarkItem &bookmarkItem)
+{
+	MarkSectionDirty(&bookmarkItem);
+}
\ No newline at end of file
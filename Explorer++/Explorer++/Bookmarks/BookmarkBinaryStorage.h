@@ -0,0 +1,74 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "Bookmarks/BookmarkItem.h"
+#include <boost/signals2.hpp>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+class BookmarkTree;
+
+// Stores a bookmark tree in a compact, versioned binary snapshot. Compared with
+// the XML and registry formats (which remain the import/export formats), a
+// snapshot can be loaded in a single sequential pass directly from a mapped
+// view of the file.
+//
+// The snapshot is split into one section per permanent folder. The encoded
+// form of each section is retained and it's only re-encoded when something
+// within that folder changes, so saving after a small change only needs to
+// serialize the affected folder.
+class BookmarkBinaryStorage
+{
+public:
+	BookmarkBinaryStorage(BookmarkTree *bookmarkTree);
+
+	// Adds the bookmarks in the snapshot to the tree, which is expected to be
+	// empty. Returns false (and leaves the tree unchanged) if the file doesn't
+	// exist or doesn't contain a valid snapshot.
+	bool Load(const std::filesystem::path &path);
+	bool Load(const uint8_t *data, size_t size);
+
+	// Writes the snapshot to a temporary file, then renames it over the
+	// existing file, so that the existing snapshot is never left partially
+	// written.
+	bool Save(const std::filesystem::path &path);
+	std::string Serialize();
+
+private:
+	static constexpr uint32_t FILE_MAGIC = 0x4B425845; // "EXBK"
+	static constexpr uint32_t FILE_VERSION = 1;
+
+	// One section for each of the permanent folders (the bookmarks toolbar,
+	// bookmarks menu and other bookmarks folders, in that order).
+	static constexpr size_t NUM_SECTIONS = 3;
+
+	struct Section
+	{
+		BookmarkItem *folder;
+		std::string data;
+		bool dirty = true;
+	};
+
+	static std::string SerializeSection(const BookmarkItem *folder);
+	static bool DeserializeSection(const uint8_t *data, size_t size, BookmarkItems &items,
+		FILETIME &dateCreated, FILETIME &dateModified);
+
+	Section *GetSectionForItem(const BookmarkItem *bookmarkItem);
+	void MarkSectionDirty(const BookmarkItem *bookmarkItem);
+
+	void OnBookmarkItemAdded(BookmarkItem &bookmarkItem, size_t index);
+	void OnBookmarkItemUpdated(BookmarkItem &bookmarkItem, BookmarkItem::PropertyType propertyType);
+	void OnBookmarkItemMoved(BookmarkItem *bookmarkItem, const BookmarkItem *oldParent,
+		size_t oldIndex, const BookmarkItem *newParent, size_t newIndex);
+	void OnBookmarkItemPreRemoval(BookmarkItem &bookmarkItem);
+
+	BookmarkTree *m_bookmarkTree;
+	std::array<Section, NUM_SECTIONS> m_sections;
+	std::vector<boost::signals2::scoped_connection> m_connections;
+};
\ No newline at end of file
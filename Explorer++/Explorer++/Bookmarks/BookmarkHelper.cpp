@@ -23,8 +23,6 @@ int CALLBACK SortByLocation(const BookmarkItem *firstItem, const BookmarkItem *s
 int CALLBACK SortByDateAdded(const BookmarkItem *firstItem, const BookmarkItem *secondItem);
 int CALLBACK SortByDateModified(const BookmarkItem *firstItem, const BookmarkItem *secondItem);
 
-BookmarkItem *GetBookmarkItemByIdResursive(BookmarkItem *bookmarkItem, std::wstring_view guid);
-
 bool BookmarkHelper::IsFolder(const std::unique_ptr<BookmarkItem> &bookmarkItem)
 {
 	return bookmarkItem->IsFolder();
@@ -137,9 +135,24 @@ void BookmarkHelper::BookmarkAllTabs(BookmarkTree *bookmarkTree, HMODULE resoure
 	for (auto tabRef : coreInterface->GetTabContainer()->GetAllTabsInOrder())
 	{
 		auto &tab = tabRef.get();
-		auto entry = tab.GetShellBrowser()->GetNavigationController()->GetCurrentEntry();
-		auto bookmark = std::make_unique<BookmarkItem>(
-			std::nullopt, entry->GetDisplayName(), tab.GetShellBrowser()->GetDirectory());
+		std::wstring displayName;
+
+		if (tab.IsLoaded())
+		{
+			auto entry = tab.GetShellBrowser()->GetNavigationController()->GetCurrentEntry();
+			displayName = entry->GetDisplayName();
+		}
+		else
+		{
+			// There's no need to load the tab just to bookmark it.
+			TCHAR name[MAX_PATH];
+			GetDisplayName(
+				tab.GetDirectoryIdl().get(), name, SIZEOF_ARRAY(name), SHGDN_INFOLDER);
+			displayName = name;
+		}
+
+		auto bookmark =
+			std::make_unique<BookmarkItem>(std::nullopt, displayName, tab.GetDirectory());
 
 		bookmarkTree->AddBookmarkItem(bookmarkFolder, std::move(bookmark), index);
 
@@ -300,32 +313,7 @@ void BookmarkHelper::PasteBookmarkItems(
 BookmarkItem *BookmarkHelper::GetBookmarkItemById(
 	BookmarkTree *bookmarkTree, std::wstring_view guid)
 {
-	return GetBookmarkItemByIdResursive(bookmarkTree->GetRoot(), guid);
-}
-
-BookmarkItem *GetBookmarkItemByIdResursive(BookmarkItem *bookmarkItem, std::wstring_view guid)
-{
-	if (bookmarkItem->GetGUID() == guid)
-	{
-		return bookmarkItem;
-	}
-
-	if (!bookmarkItem->IsFolder())
-	{
-		return nullptr;
-	}
-
-	for (auto &child : bookmarkItem->GetChildren())
-	{
-		BookmarkItem *result = GetBookmarkItemByIdResursive(child.get(), guid);
-
-		if (result)
-		{
-			return result;
-		}
-	}
-
-	return nullptr;
+	return bookmarkTree->GetBookmarkItemById(guid);
 }
 
 bool BookmarkHelper::IsAncestor(BookmarkItem *bookmarkItem, BookmarkItem *possibleAncestor)
@@ -247,4 +247,26 @@ void BookmarkItem::VisitRecursively(std::function<void(BookmarkItem *currentItem
 	{
 		child->VisitRecursively(callback);
 	}
+}
+
+size_t BookmarkItem::GetMemoryUsage() const
+{
+	size_t memoryUsage = sizeof(*this);
+	memoryUsage += m_guid.capacity() * sizeof(wchar_t);
+	memoryUsage += m_name.capacity() * sizeof(wchar_t);
+	memoryUsage += m_location.capacity() * sizeof(wchar_t);
+
+	if (m_originalGuid)
+	{
+		memoryUsage += m_originalGuid->capacity() * sizeof(wchar_t);
+	}
+
+	memoryUsage += m_children.capacity() * sizeof(BookmarkItems::value_type);
+
+	for (const auto &child : m_children)
+	{
+		memoryUsage += child->GetMemoryUsage();
+	}
+
+	return memoryUsage;
 }
\ No newline at end of file
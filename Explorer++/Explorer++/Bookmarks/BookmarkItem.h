@@ -101,6 +101,10 @@ public:
 
 	void VisitRecursively(std::function<void(BookmarkItem *currentItem)> callback);
 
+	// Returns an estimate of the memory used by this item and all of its
+	// descendants.
+	size_t GetMemoryUsage() const;
+
 	// Signals
 	SignalWrapper<BookmarkItem, void(BookmarkItem &bookmarkItem, PropertyType propertyType)>
 		updatedSignal;
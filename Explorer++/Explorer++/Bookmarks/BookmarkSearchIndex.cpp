@@ -0,0 +1,91 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "Bookmarks/BookmarkSearchIndex.h"
+#include "Bookmarks/BookmarkTree.h"
+
+BookmarkSearchIndex::BookmarkSearchIndex(BookmarkTree *bookmarkTree) : m_bookmarkTree(bookmarkTree)
+{
+	m_bookmarkTree->GetRoot()->VisitRecursively(
+		[this](BookmarkItem *currentItem) { AddBookmarkItem(currentItem); });
+
+	m_connections.push_back(m_bookmarkTree->bookmarkItemAddedSignal.AddObserver(
+		std::bind(&BookmarkSearchIndex::OnBookmarkItemAdded, this, std::placeholders::_1,
+			std::placeholders::_2)));
+	m_connections.push_back(m_bookmarkTree->bookmarkItemUpdatedSignal.AddObserver(
+		std::bind(&BookmarkSearchIndex::OnBookmarkItemUpdated, this, std::placeholders::_1,
+			std::placeholders::_2)));
+	m_connections.push_back(m_bookmarkTree->bookmarkItemPreRemovalSignal.AddObserver(
+		std::bind(&BookmarkSearchIndex::OnBookmarkItemPreRemoval, this, std::placeholders::_1)));
+}
+
+std::vector<BookmarkItem *> BookmarkSearchIndex::Search(
+	std::wstring_view query, size_t maxResults) const
+{
+	std::vector<BookmarkItem *> bookmarkItems;
+
+	for (const auto &result : m_index.Search(query, maxResults))
+	{
+		BookmarkItem *bookmarkItem = m_bookmarkTree->GetBookmarkItemById(result.key);
+		assert(bookmarkItem);
+
+		bookmarkItems.push_back(bookmarkItem);
+	}
+
+	return bookmarkItems;
+}
+
+void BookmarkSearchIndex::RecordVisit(const BookmarkItem *bookmarkItem)
+{
+	m_index.RecordUse(bookmarkItem->GetGUID());
+}
+
+size_t BookmarkSearchIndex::GetMemoryUsage() const
+{
+	return m_index.GetMemoryUsage();
+}
+
+void BookmarkSearchIndex::AddBookmarkItem(const BookmarkItem *bookmarkItem)
+{
+	// The permanent folders are always visible, so there's no need to be able
+	// to search for them.
+	if (m_bookmarkTree->IsPermanentNode(bookmarkItem))
+	{
+		return;
+	}
+
+	m_index.AddOrUpdate(bookmarkItem->GetGUID(), bookmarkItem->GetName(),
+		bookmarkItem->IsBookmark() ? bookmarkItem->GetLocation() : std::wstring());
+}
+
+void BookmarkSearchIndex::OnBookmarkItemAdded(BookmarkItem &bookmarkItem, size_t index)
+{
+	UNREFERENCED_PARAMETER(index);
+
+	// The signal is only broadcast for the item that was added, not for any of
+	// its children.
+	bookmarkItem.VisitRecursively(
+		[this](BookmarkItem *currentItem) { AddBookmarkItem(currentItem); });
+}
+
+void BookmarkSearchIndex::OnBookmarkItemUpdated(
+	BookmarkItem &bookmarkItem, BookmarkItem::PropertyType propertyType)
+{
+	if (propertyType != BookmarkItem::PropertyType::Name
+		&& propertyType != BookmarkItem::PropertyType::Location)
+	{
+		return;
+	}
+
+	AddBookmarkItem(&bookmarkItem);
+}
+
+void BookmarkSearchIndex::OnBookmarkItemPreRemoval(BookmarkItem &bookmarkItem)
+{
+	// The removal signal only includes the GUID of the item being removed, so
+	// the item's children (which are also removed) are handled here instead.
+	bookmarkItem.VisitRecursively(
+		[this](BookmarkItem *currentItem) { m_index.Remove(currentItem->GetGUID()); });
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "Bookmarks/BookmarkItem.h"
+#include "../Helper/FuzzySearchIndex.h"
+#include <boost/signals2.hpp>
+#include <string_view>
+#include <vector>
+
+class BookmarkTree;
+
+// Maintains a search index over the names and locations of the items in a
+// bookmark tree. The index is kept up to date as items are added, updated and
+// removed, so searches don't need to walk the tree.
+class BookmarkSearchIndex
+{
+public:
+	BookmarkSearchIndex(BookmarkTree *bookmarkTree);
+
+	// Returns the items that best match the query, ordered from best to worst.
+	std::vector<BookmarkItem *> Search(std::wstring_view query, size_t maxResults) const;
+
+	// Records that the bookmark was opened. Bookmarks that are opened more
+	// often (and more recently) are ranked higher in search results.
+	void RecordVisit(const BookmarkItem *bookmarkItem);
+
+	size_t GetMemoryUsage() const;
+
+private:
+	void AddBookmarkItem(const BookmarkItem *bookmarkItem);
+
+	void OnBookmarkItemAdded(BookmarkItem &bookmarkItem, size_t index);
+	void OnBookmarkItemUpdated(BookmarkItem &bookmarkItem, BookmarkItem::PropertyType propertyType);
+	void OnBookmarkItemPreRemoval(BookmarkItem &bookmarkItem);
+
+	BookmarkTree *m_bookmarkTree;
+	FuzzySearchIndex m_index;
+	std::vector<boost::signals2::scoped_connection> m_connections;
+};
\ No newline at end of file
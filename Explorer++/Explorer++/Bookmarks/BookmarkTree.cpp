@@ -7,6 +7,7 @@
 #include "Bookmarks/BookmarkHelper.h"
 #include "MainResource.h"
 #include "ResourceHelper.h"
+#include <utility>
 
 BookmarkTree::BookmarkTree() :
 	m_root(ROOT_FOLDER_GUID,
@@ -30,6 +31,8 @@ BookmarkTree::BookmarkTree() :
 		std::nullopt);
 	m_otherBookmarks = otherBookmarksFolder.get();
 	m_root.AddChild(std::move(otherBookmarksFolder));
+
+	m_root.VisitRecursively([this](BookmarkItem *currentItem) { AddToIndex(currentItem); });
 }
 
 BookmarkItem *BookmarkTree::GetRoot()
@@ -85,6 +88,8 @@ BookmarkItem *BookmarkTree::AddBookmarkItem(
 		currentItem->updatedSignal.AddObserver(std::bind(&BookmarkTree::OnBookmarkItemUpdated, this,
 												   std::placeholders::_1, std::placeholders::_2),
 			boost::signals2::at_front);
+
+		AddToIndex(currentItem);
 	});
 
 	if (index > parent->GetChildren().size())
@@ -146,6 +151,9 @@ void BookmarkTree::RemoveBookmarkItem(BookmarkItem *bookmarkItem)
 
 	std::wstring guid = bookmarkItem->GetGUID();
 
+	bookmarkItem->VisitRecursively(
+		[this](BookmarkItem *currentItem) { RemoveFromIndex(currentItem); });
+
 	size_t childIndex = parent->GetChildIndex(bookmarkItem);
 	parent->RemoveChild(childIndex);
 	bookmarkItemRemovedSignal.m_signal(guid);
@@ -157,6 +165,36 @@ void BookmarkTree::OnBookmarkItemUpdated(
 	bookmarkItemUpdatedSignal.m_signal(bookmarkItem, propertyType);
 }
 
+BookmarkItem *BookmarkTree::GetBookmarkItemById(std::wstring_view guid)
+{
+	return const_cast<BookmarkItem *>(std::as_const(*this).GetBookmarkItemById(guid));
+}
+
+const BookmarkItem *BookmarkTree::GetBookmarkItemById(std::wstring_view guid) const
+{
+	auto itr = m_guidIndex.find(std::wstring(guid));
+
+	if (itr == m_guidIndex.end())
+	{
+		return nullptr;
+	}
+
+	return itr->second;
+}
+
+void BookmarkTree::AddToIndex(BookmarkItem *bookmarkItem)
+{
+	[[maybe_unused]] auto [itr, inserted] =
+		m_guidIndex.insert({ bookmarkItem->GetGUID(), bookmarkItem });
+	assert(inserted);
+}
+
+void BookmarkTree::RemoveFromIndex(BookmarkItem *bookmarkItem)
+{
+	[[maybe_unused]] size_t numRemoved = m_guidIndex.erase(bookmarkItem->GetGUID());
+	assert(numRemoved == 1);
+}
+
 bool BookmarkTree::CanAddChildren(const BookmarkItem *bookmarkItem) const
 {
 	return bookmarkItem != &m_root;
@@ -171,4 +209,20 @@ bool BookmarkTree::IsPermanentNode(const BookmarkItem *bookmarkItem) const
 	}
 
 	return false;
+}
+
+size_t BookmarkTree::GetMemoryUsage() const
+{
+	size_t memoryUsage = m_root.GetMemoryUsage();
+
+	// Each entry in the index is stored in a separate node, alongside a pointer
+	// to the next node.
+	memoryUsage += m_guidIndex.bucket_count() * sizeof(void *);
+
+	for (const auto &entry : m_guidIndex)
+	{
+		memoryUsage += sizeof(void *) + sizeof(entry) + entry.first.capacity() * sizeof(wchar_t);
+	}
+
+	return memoryUsage;
 }
\ No newline at end of file
@@ -7,6 +7,9 @@
 #include "Bookmarks/BookmarkItem.h"
 #include "SignalWrapper.h"
 #include <tchar.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 
 class BookmarkTree
 {
@@ -21,6 +24,10 @@ public:
 	BookmarkItem *GetOtherBookmarksFolder();
 	const BookmarkItem *GetOtherBookmarksFolder() const;
 
+	// Returns null if there's no item in the tree with the specified GUID.
+	BookmarkItem *GetBookmarkItemById(std::wstring_view guid);
+	const BookmarkItem *GetBookmarkItemById(std::wstring_view guid) const;
+
 	bool CanAddChildren(const BookmarkItem *bookmarkItem) const;
 	bool IsPermanentNode(const BookmarkItem *bookmarkItem) const;
 
@@ -29,6 +36,8 @@ public:
 	void MoveBookmarkItem(BookmarkItem *bookmarkItem, BookmarkItem *newParent, size_t index);
 	void RemoveBookmarkItem(BookmarkItem *bookmarkItem);
 
+	size_t GetMemoryUsage() const;
+
 	// Signals
 	SignalWrapper<BookmarkTree, void(BookmarkItem &bookmarkItem, size_t index)>
 		bookmarkItemAddedSignal;
@@ -52,8 +61,17 @@ private:
 
 	void OnBookmarkItemUpdated(BookmarkItem &bookmarkItem, BookmarkItem::PropertyType propertyType);
 
+	void AddToIndex(BookmarkItem *bookmarkItem);
+	void RemoveFromIndex(BookmarkItem *bookmarkItem);
+
 	BookmarkItem m_root;
 	BookmarkItem *m_bookmarksToolbar;
 	BookmarkItem *m_bookmarksMenu;
 	BookmarkItem *m_otherBookmarks;
+
+	// Maps the GUID of each item in the tree (including the root and the
+	// permanent folders) to the item. An item's GUID never changes and moving
+	// an item doesn't change its address, so this only needs to be updated
+	// when items are added or removed.
+	std::unordered_map<std::wstring, BookmarkItem *> m_guidIndex;
 };
\ No newline at end of file
@@ -8,140 +8,143 @@
 #include "Bookmarks/BookmarkStorage.h"
 #include "Bookmarks/BookmarkTree.h"
 #include "../Helper/XMLSettings.h"
-#include <wil/com.h>
+#include "../Helper/XmlStream.h"
 
 namespace V2
 {
 const TCHAR bookmarksKeyNodeName[] = _T("Bookmarksv2");
 
-void Load(IXMLDOMNode *parentNode, BookmarkTree *bookmarkTree);
-void LoadPermanentFolder(IXMLDOMNode *parentNode, BookmarkTree *bookmarkTree,
-	BookmarkItem *bookmarkItem, const std::wstring &name);
+void Load(XmlStreamReader &reader, BookmarkTree *bookmarkTree);
+void LoadPermanentFolder(
+	XmlStreamReader &reader, BookmarkTree *bookmarkTree, BookmarkItem *bookmarkItem);
 void LoadBookmarkChildren(
-	IXMLDOMNode *parentNode, BookmarkTree *bookmarkTree, BookmarkItem *parentBookmarkItem);
-std::unique_ptr<BookmarkItem> LoadBookmarkItem(IXMLDOMNode *parentNode, BookmarkTree *bookmarkTree);
-
-void Save(IXMLDOMDocument *xmlDocument, IXMLDOMElement *parentNode, BookmarkTree *bookmarkTree,
-	int indent);
-void SavePermanentFolder(IXMLDOMDocument *xmlDocument, IXMLDOMElement *parentNode,
-	const BookmarkItem *bookmarkItem, const std::wstring &name, int indent);
-void SaveBookmarkChildren(IXMLDOMDocument *xmlDocument, IXMLDOMElement *parentNode,
-	const BookmarkItem *parentBookmarkItem, int indent);
-void SaveBookmarkItem(IXMLDOMDocument *xmlDocument, IXMLDOMElement *parentNode,
-	const BookmarkItem *bookmarkItem, int indent);
+	XmlStreamReader &reader, BookmarkTree *bookmarkTree, BookmarkItem *parentBookmarkItem);
+std::unique_ptr<BookmarkItem> LoadBookmarkItem(XmlStreamReader &reader, BookmarkTree *bookmarkTree);
+
+void Save(XmlStreamWriter &writer, BookmarkTree *bookmarkTree);
+void SavePermanentFolder(
+	XmlStreamWriter &writer, const BookmarkItem *bookmarkItem, const std::wstring &name);
+void SaveBookmarkChildren(XmlStreamWriter &writer, const BookmarkItem *parentBookmarkItem);
+void SaveBookmarkItem(XmlStreamWriter &writer, const BookmarkItem *bookmarkItem);
 }
 
 namespace V1
 {
 const TCHAR bookmarksKeyNodeName[] = _T("Bookmarks");
 
-void Load(IXMLDOMNode *parentNode, BookmarkTree *bookmarkTree);
+void Load(XmlStreamReader &reader, BookmarkTree *bookmarkTree);
 void LoadBookmarkChildren(
-	IXMLDOMNode *parentNode, BookmarkTree *bookmarkTree, BookmarkItem *parentBookmarkItem);
+	XmlStreamReader &reader, BookmarkTree *bookmarkTree, BookmarkItem *parentBookmarkItem);
 std::unique_ptr<BookmarkItem> LoadBookmarkItem(
-	IXMLDOMNode *parentNode, BookmarkTree *bookmarkTree, bool &showOnToolbarOutput);
+	XmlStreamReader &reader, BookmarkTree *bookmarkTree, bool &showOnToolbarOutput);
 }
 
-void BookmarkXmlStorage::Load(IXMLDOMDocument *xmlDocument, BookmarkTree *bookmarkTree)
+void BookmarkXmlStorage::Load(const XmlSections &sections, BookmarkTree *bookmarkTree)
 {
-	wil::com_ptr<IXMLDOMNode> bookmarksNode;
-	auto queryString = wil::make_bstr(
-		(std::wstring(L"/ExplorerPlusPlus/") + std::wstring(V2::bookmarksKeyNodeName)).c_str());
-	HRESULT hr = xmlDocument->selectSingleNode(queryString.get(), &bookmarksNode);
+	auto reader = sections.OpenSection(V2::bookmarksKeyNodeName);
 
-	if (hr == S_OK)
+	if (reader)
 	{
-		V2::Load(bookmarksNode.get(), bookmarkTree);
+		V2::Load(*reader, bookmarkTree);
 		return;
 	}
 
-	queryString = wil::make_bstr(
-		(std::wstring(L"/ExplorerPlusPlus/") + std::wstring(V1::bookmarksKeyNodeName)).c_str());
-	hr = xmlDocument->selectSingleNode(queryString.get(), &bookmarksNode);
+	reader = sections.OpenSection(V1::bookmarksKeyNodeName);
 
-	if (hr == S_OK)
+	if (reader)
 	{
-		V1::Load(bookmarksNode.get(), bookmarkTree);
+		V1::Load(*reader, bookmarkTree);
 		return;
 	}
 }
 
-void V2::Load(IXMLDOMNode *parentNode, BookmarkTree *bookmarkTree)
+void V2::Load(XmlStreamReader &reader, BookmarkTree *bookmarkTree)
 {
-	LoadPermanentFolder(parentNode, bookmarkTree, bookmarkTree->GetBookmarksToolbarFolder(),
-		BookmarkStorage::BOOKMARKS_TOOLBAR_NODE_NAME);
-	LoadPermanentFolder(parentNode, bookmarkTree, bookmarkTree->GetBookmarksMenuFolder(),
-		BookmarkStorage::BOOKMARKS_MENU_NODE_NAME);
-	LoadPermanentFolder(parentNode, bookmarkTree, bookmarkTree->GetOtherBookmarksFolder(),
-		BookmarkStorage::OTHER_BOOKMARKS_NODE_NAME);
-}
+	int depth = reader.GetDepth();
 
-void V2::LoadPermanentFolder(IXMLDOMNode *parentNode, BookmarkTree *bookmarkTree,
-	BookmarkItem *bookmarkItem, const std::wstring &name)
-{
-	wil::com_ptr<IXMLDOMNode> childNode;
-	auto queryString = wil::make_bstr((L"./PermanentItem[@name='" + name + L"']").c_str());
-	HRESULT hr = parentNode->selectSingleNode(queryString.get(), &childNode);
-
-	if (hr == S_OK)
+	while (reader.ReadChildElement(depth))
 	{
-		wil::com_ptr<IXMLDOMNamedNodeMap> attributeMap;
-		childNode->get_attributes(&attributeMap);
+		if (reader.GetName() != L"PermanentItem")
+		{
+			continue;
+		}
+
+		std::wstring name;
+		NXMLSettings::GetStringAttribute(reader, L"name", name);
 
-		FILETIME dateCreated;
-		NXMLSettings::ReadDateTime(attributeMap.get(), _T("DateCreated"), dateCreated);
-		bookmarkItem->SetDateCreated(dateCreated);
+		BookmarkItem *bookmarkItem;
 
-		FILETIME dateModified;
-		NXMLSettings::ReadDateTime(attributeMap.get(), _T("DateModified"), dateModified);
-		bookmarkItem->SetDateModified(dateModified);
+		if (name == BookmarkStorage::BOOKMARKS_TOOLBAR_NODE_NAME)
+		{
+			bookmarkItem = bookmarkTree->GetBookmarksToolbarFolder();
+		}
+		else if (name == BookmarkStorage::BOOKMARKS_MENU_NODE_NAME)
+		{
+			bookmarkItem = bookmarkTree->GetBookmarksMenuFolder();
+		}
+		else if (name == BookmarkStorage::OTHER_BOOKMARKS_NODE_NAME)
+		{
+			bookmarkItem = bookmarkTree->GetOtherBookmarksFolder();
+		}
+		else
+		{
+			continue;
+		}
 
-		LoadBookmarkChildren(childNode.get(), bookmarkTree, bookmarkItem);
+		LoadPermanentFolder(reader, bookmarkTree, bookmarkItem);
 	}
 }
 
-void V2::LoadBookmarkChildren(
-	IXMLDOMNode *parentNode, BookmarkTree *bookmarkTree, BookmarkItem *parentBookmarkItem)
+void V2::LoadPermanentFolder(
+	XmlStreamReader &reader, BookmarkTree *bookmarkTree, BookmarkItem *bookmarkItem)
 {
-	auto makeQueryString = [](int index) {
-		return wil::make_bstr((L"./Bookmark[@name='" + std::to_wstring(index) + L"']").c_str());
-	};
+	FILETIME dateCreated;
+	NXMLSettings::ReadDateTime(reader, _T("DateCreated"), dateCreated);
+	bookmarkItem->SetDateCreated(dateCreated);
 
-	wil::com_ptr<IXMLDOMNode> childNode;
-	int index = 0;
-	auto queryString = makeQueryString(index);
+	FILETIME dateModified;
+	NXMLSettings::ReadDateTime(reader, _T("DateModified"), dateModified);
+	bookmarkItem->SetDateModified(dateModified);
+
+	LoadBookmarkChildren(reader, bookmarkTree, bookmarkItem);
+}
 
-	while (parentNode->selectSingleNode(queryString.get(), &childNode) == S_OK)
+void V2::LoadBookmarkChildren(
+	XmlStreamReader &reader, BookmarkTree *bookmarkTree, BookmarkItem *parentBookmarkItem)
+{
+	int depth = reader.GetDepth();
+
+	while (reader.ReadChildElement(depth))
 	{
-		auto childBookmarkItem = LoadBookmarkItem(childNode.get(), bookmarkTree);
-		bookmarkTree->AddBookmarkItem(parentBookmarkItem, std::move(childBookmarkItem), index);
+		if (reader.GetName() != L"Bookmark")
+		{
+			continue;
+		}
 
-		index++;
-		queryString = makeQueryString(index);
+		auto childBookmarkItem = LoadBookmarkItem(reader, bookmarkTree);
+		bookmarkTree->AddBookmarkItem(parentBookmarkItem, std::move(childBookmarkItem),
+			parentBookmarkItem->GetChildren().size());
 	}
 }
 
 std::unique_ptr<BookmarkItem> V2::LoadBookmarkItem(
-	IXMLDOMNode *parentNode, BookmarkTree *bookmarkTree)
+	XmlStreamReader &reader, BookmarkTree *bookmarkTree)
 {
-	wil::com_ptr<IXMLDOMNamedNodeMap> attributeMap;
-	parentNode->get_attributes(&attributeMap);
-
 	int type;
-	NXMLSettings::GetIntFromMap(attributeMap.get(), L"Type", type);
+	NXMLSettings::GetIntAttribute(reader, L"Type", type);
 
 	std::wstring guid;
-	NXMLSettings::GetStringFromMap(attributeMap.get(), L"GUID", guid);
+	NXMLSettings::GetStringAttribute(reader, L"GUID", guid);
 
 	std::wstring name;
-	NXMLSettings::GetStringFromMap(attributeMap.get(), L"ItemName", name);
+	NXMLSettings::GetStringAttribute(reader, L"ItemName", name);
 
 	std::optional<std::wstring> locationOptional;
 
 	if (type == static_cast<int>(BookmarkItem::Type::Bookmark))
 	{
 		std::wstring location;
-		NXMLSettings::GetStringFromMap(attributeMap.get(), L"Location", location);
+		NXMLSettings::GetStringAttribute(reader, L"Location", location);
 
 		locationOptional = location;
 	}
@@ -149,44 +152,40 @@ std::unique_ptr<BookmarkItem> V2::LoadBookmarkItem(
 	auto bookmarkItem = std::make_unique<BookmarkItem>(guid, name, locationOptional);
 
 	FILETIME dateCreated;
-	NXMLSettings::ReadDateTime(attributeMap.get(), _T("DateCreated"), dateCreated);
+	NXMLSettings::ReadDateTime(reader, _T("DateCreated"), dateCreated);
 	bookmarkItem->SetDateCreated(dateCreated);
 
 	FILETIME dateModified;
-	NXMLSettings::ReadDateTime(attributeMap.get(), _T("DateModified"), dateModified);
+	NXMLSettings::ReadDateTime(reader, _T("DateModified"), dateModified);
 	bookmarkItem->SetDateModified(dateModified);
 
 	if (type == static_cast<int>(BookmarkItem::Type::Folder))
 	{
-		LoadBookmarkChildren(parentNode, bookmarkTree, bookmarkItem.get());
+		LoadBookmarkChildren(reader, bookmarkTree, bookmarkItem.get());
 	}
 
 	return bookmarkItem;
 }
 
-void V1::Load(IXMLDOMNode *parentNode, BookmarkTree *bookmarkTree)
+void V1::Load(XmlStreamReader &reader, BookmarkTree *bookmarkTree)
 {
-	LoadBookmarkChildren(parentNode, bookmarkTree, nullptr);
+	LoadBookmarkChildren(reader, bookmarkTree, nullptr);
 }
 
 void V1::LoadBookmarkChildren(
-	IXMLDOMNode *parentNode, BookmarkTree *bookmarkTree, BookmarkItem *parentBookmarkItem)
+	XmlStreamReader &reader, BookmarkTree *bookmarkTree, BookmarkItem *parentBookmarkItem)
 {
-	wil::com_ptr<IXMLDOMNodeList> children;
-	auto queryString = wil::make_bstr(L"./Bookmark");
-	HRESULT hr = parentNode->selectNodes(queryString.get(), &children);
+	int depth = reader.GetDepth();
 
-	if (hr != S_OK)
+	while (reader.ReadChildElement(depth))
 	{
-		return;
-	}
-
-	wil::com_ptr<IXMLDOMNode> childNode;
+		if (reader.GetName() != L"Bookmark")
+		{
+			continue;
+		}
 
-	while (children->nextNode(&childNode) == S_OK)
-	{
 		bool showOnToolbar;
-		auto childBookmarkItem = LoadBookmarkItem(childNode.get(), bookmarkTree, showOnToolbar);
+		auto childBookmarkItem = LoadBookmarkItem(reader, bookmarkTree, showOnToolbar);
 
 		if (!parentBookmarkItem)
 		{
@@ -212,19 +211,16 @@ void V1::LoadBookmarkChildren(
 }
 
 std::unique_ptr<BookmarkItem> V1::LoadBookmarkItem(
-	IXMLDOMNode *parentNode, BookmarkTree *bookmarkTree, bool &showOnToolbarOutput)
+	XmlStreamReader &reader, BookmarkTree *bookmarkTree, bool &showOnToolbarOutput)
 {
-	wil::com_ptr<IXMLDOMNamedNodeMap> attributeMap;
-	parentNode->get_attributes(&attributeMap);
-
 	int type;
-	NXMLSettings::GetIntFromMap(attributeMap.get(), L"Type", type);
+	NXMLSettings::GetIntAttribute(reader, L"Type", type);
 
 	std::wstring name;
-	NXMLSettings::GetStringFromMap(attributeMap.get(), L"name", name);
+	NXMLSettings::GetStringAttribute(reader, L"name", name);
 
 	std::wstring showOnToolbar;
-	NXMLSettings::GetStringFromMap(attributeMap.get(), L"ShowOnBookmarksToolbar", showOnToolbar);
+	NXMLSettings::GetStringAttribute(reader, L"ShowOnBookmarksToolbar", showOnToolbar);
 
 	showOnToolbarOutput = NXMLSettings::DecodeBoolValue(showOnToolbar.c_str());
 
@@ -233,7 +229,7 @@ std::unique_ptr<BookmarkItem> V1::LoadBookmarkItem(
 	if (type == static_cast<int>(BookmarkStorage::BookmarkTypeV1::Bookmark))
 	{
 		std::wstring location;
-		NXMLSettings::GetStringFromMap(attributeMap.get(), L"Location", location);
+		NXMLSettings::GetStringAttribute(reader, L"Location", location);
 
 		locationOptional = location;
 	}
@@ -242,114 +238,84 @@ std::unique_ptr<BookmarkItem> V1::LoadBookmarkItem(
 
 	if (type == static_cast<int>(BookmarkStorage::BookmarkTypeV1::Folder))
 	{
-		wil::com_ptr<IXMLDOMNode> bookmarksNode;
-		auto queryString = wil::make_bstr(L"./Bookmarks");
-		HRESULT hr = parentNode->selectSingleNode(queryString.get(), &bookmarksNode);
+		int depth = reader.GetDepth();
 
-		if (hr == S_OK)
+		while (reader.ReadChildElement(depth))
 		{
-			LoadBookmarkChildren(bookmarksNode.get(), bookmarkTree, bookmarkItem.get());
+			if (reader.GetName() == L"Bookmarks")
+			{
+				LoadBookmarkChildren(reader, bookmarkTree, bookmarkItem.get());
+				break;
+			}
 		}
 	}
 
 	return bookmarkItem;
 }
 
-void BookmarkXmlStorage::Save(IXMLDOMDocument *xmlDocument, IXMLDOMElement *parentNode,
-	BookmarkTree *bookmarkTree, int indent)
+void BookmarkXmlStorage::Save(XmlStreamWriter &writer, BookmarkTree *bookmarkTree)
 {
-	auto newline = wil::make_bstr((std::wstring(L"\n") + std::wstring(indent, '\t')).c_str());
-	NXMLSettings::AddWhiteSpaceToNode(xmlDocument, newline.get(), parentNode);
-
-	wil::com_ptr<IXMLDOMElement> bookmarksNode;
-	auto bookmarksKeyNodeName = wil::make_bstr(V2::bookmarksKeyNodeName);
-	HRESULT hr = xmlDocument->createElement(bookmarksKeyNodeName.get(), &bookmarksNode);
-
-	if (hr == S_OK)
-	{
-		V2::Save(xmlDocument, bookmarksNode.get(), bookmarkTree, indent + 1);
-
-		NXMLSettings::AddWhiteSpaceToNode(xmlDocument, newline.get(), bookmarksNode.get());
-		NXMLSettings::AppendChildToParent(bookmarksNode.get(), parentNode);
-	}
+	writer.StartElement(V2::bookmarksKeyNodeName);
+	V2::Save(writer, bookmarkTree);
+	writer.EndElement();
 }
 
-void V2::Save(IXMLDOMDocument *xmlDocument, IXMLDOMElement *parentNode, BookmarkTree *bookmarkTree,
-	int indent)
+void V2::Save(XmlStreamWriter &writer, BookmarkTree *bookmarkTree)
 {
-	SavePermanentFolder(xmlDocument, parentNode, bookmarkTree->GetBookmarksToolbarFolder(),
-		BookmarkStorage::BOOKMARKS_TOOLBAR_NODE_NAME, indent);
-	SavePermanentFolder(xmlDocument, parentNode, bookmarkTree->GetBookmarksMenuFolder(),
-		BookmarkStorage::BOOKMARKS_MENU_NODE_NAME, indent);
-	SavePermanentFolder(xmlDocument, parentNode, bookmarkTree->GetOtherBookmarksFolder(),
-		BookmarkStorage::OTHER_BOOKMARKS_NODE_NAME, indent);
+	SavePermanentFolder(writer, bookmarkTree->GetBookmarksToolbarFolder(),
+		BookmarkStorage::BOOKMARKS_TOOLBAR_NODE_NAME);
+	SavePermanentFolder(writer, bookmarkTree->GetBookmarksMenuFolder(),
+		BookmarkStorage::BOOKMARKS_MENU_NODE_NAME);
+	SavePermanentFolder(writer, bookmarkTree->GetOtherBookmarksFolder(),
+		BookmarkStorage::OTHER_BOOKMARKS_NODE_NAME);
 }
 
-void V2::SavePermanentFolder(IXMLDOMDocument *xmlDocument, IXMLDOMElement *parentNode,
-	const BookmarkItem *bookmarkItem, const std::wstring &name, int indent)
+void V2::SavePermanentFolder(
+	XmlStreamWriter &writer, const BookmarkItem *bookmarkItem, const std::wstring &name)
 {
-	auto newline = wil::make_bstr((std::wstring(L"\n") + std::wstring(indent, '\t')).c_str());
-	NXMLSettings::AddWhiteSpaceToNode(xmlDocument, newline.get(), parentNode);
-
-	wil::com_ptr<IXMLDOMElement> childNode;
-	NXMLSettings::CreateElementNode(
-		xmlDocument, &childNode, parentNode, L"PermanentItem", name.c_str());
+	NXMLSettings::StartNamedElement(writer, L"PermanentItem", name.c_str());
 
-	NXMLSettings::SaveDateTime(
-		xmlDocument, childNode.get(), _T("DateCreated"), bookmarkItem->GetDateCreated());
-	NXMLSettings::SaveDateTime(
-		xmlDocument, childNode.get(), _T("DateModified"), bookmarkItem->GetDateModified());
+	NXMLSettings::SaveDateTime(writer, _T("DateCreated"), bookmarkItem->GetDateCreated());
+	NXMLSettings::SaveDateTime(writer, _T("DateModified"), bookmarkItem->GetDateModified());
 
-	SaveBookmarkChildren(xmlDocument, childNode.get(), bookmarkItem, indent + 1);
+	SaveBookmarkChildren(writer, bookmarkItem);
 
-	NXMLSettings::AddWhiteSpaceToNode(xmlDocument, newline.get(), childNode.get());
+	writer.EndElement();
 }
 
-void V2::SaveBookmarkChildren(IXMLDOMDocument *xmlDocument, IXMLDOMElement *parentNode,
-	const BookmarkItem *parentBookmarkItem, int indent)
+void V2::SaveBookmarkChildren(XmlStreamWriter &writer, const BookmarkItem *parentBookmarkItem)
 {
 	int index = 0;
 
 	for (auto &child : parentBookmarkItem->GetChildren())
 	{
-		auto newline = wil::make_bstr((std::wstring(L"\n") + std::wstring(indent, '\t')).c_str());
-		NXMLSettings::AddWhiteSpaceToNode(xmlDocument, newline.get(), parentNode);
-
-		wil::com_ptr<IXMLDOMElement> childNode;
-		NXMLSettings::CreateElementNode(
-			xmlDocument, &childNode, parentNode, _T("Bookmark"), std::to_wstring(index).c_str());
+		NXMLSettings::StartNamedElement(writer, _T("Bookmark"), std::to_wstring(index).c_str());
 
-		SaveBookmarkItem(xmlDocument, childNode.get(), child.get(), indent);
+		SaveBookmarkItem(writer, child.get());
 
-		NXMLSettings::AddWhiteSpaceToNode(xmlDocument, newline.get(), childNode.get());
+		writer.EndElement();
 
 		index++;
 	}
 }
 
-void V2::SaveBookmarkItem(IXMLDOMDocument *xmlDocument, IXMLDOMElement *parentNode,
-	const BookmarkItem *bookmarkItem, int indent)
+void V2::SaveBookmarkItem(XmlStreamWriter &writer, const BookmarkItem *bookmarkItem)
 {
-	NXMLSettings::AddAttributeToNode(xmlDocument, parentNode, _T("Type"),
-		NXMLSettings::EncodeIntValue(static_cast<int>(bookmarkItem->GetType())));
-	NXMLSettings::AddAttributeToNode(
-		xmlDocument, parentNode, _T("GUID"), bookmarkItem->GetGUID().c_str());
-	NXMLSettings::AddAttributeToNode(
-		xmlDocument, parentNode, _T("ItemName"), bookmarkItem->GetName().c_str());
+	writer.WriteAttribute(
+		_T("Type"), NXMLSettings::EncodeIntValue(static_cast<int>(bookmarkItem->GetType())));
+	writer.WriteAttribute(_T("GUID"), bookmarkItem->GetGUID());
+	writer.WriteAttribute(_T("ItemName"), bookmarkItem->GetName());
 
 	if (bookmarkItem->GetType() == BookmarkItem::Type::Bookmark)
 	{
-		NXMLSettings::AddAttributeToNode(
-			xmlDocument, parentNode, _T("Location"), bookmarkItem->GetLocation().c_str());
+		writer.WriteAttribute(_T("Location"), bookmarkItem->GetLocation());
 	}
 
-	NXMLSettings::SaveDateTime(
-		xmlDocument, parentNode, _T("DateCreated"), bookmarkItem->GetDateCreated());
-	NXMLSettings::SaveDateTime(
-		xmlDocument, parentNode, _T("DateModified"), bookmarkItem->GetDateModified());
+	NXMLSettings::SaveDateTime(writer, _T("DateCreated"), bookmarkItem->GetDateCreated());
+	NXMLSettings::SaveDateTime(writer, _T("DateModified"), bookmarkItem->GetDateModified());
 
 	if (bookmarkItem->GetType() == BookmarkItem::Type::Folder)
 	{
-		SaveBookmarkChildren(xmlDocument, parentNode, bookmarkItem, indent + 1);
+		SaveBookmarkChildren(writer, bookmarkItem);
 	}
 }
\ No newline at end of file
@@ -4,13 +4,12 @@
 
 #pragma once
 
-#include <MsXml2.h>
-
 class BookmarkTree;
+class XmlSections;
+class XmlStreamWriter;
 
 namespace BookmarkXmlStorage
 {
-void Load(IXMLDOMDocument *xmlDocument, BookmarkTree *bookmarkTree);
-void Save(IXMLDOMDocument *xmlDocument, IXMLDOMElement *parentNode, BookmarkTree *bookmarkTree,
-	int indent);
+void Load(const XmlSections &sections, BookmarkTree *bookmarkTree);
+void Save(XmlStreamWriter &writer, BookmarkTree *bookmarkTree);
 }
\ No newline at end of file
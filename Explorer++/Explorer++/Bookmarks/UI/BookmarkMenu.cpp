@@ -4,16 +4,15 @@
 
 #include "stdafx.h"
 #include "Bookmarks/UI/BookmarkMenu.h"
-#include "Bookmarks/BookmarkIconManager.h"
 
 BookmarkMenu::BookmarkMenu(BookmarkTree *bookmarkTree, HMODULE resourceModule,
 	IExplorerplusplus *expp, Navigation *navigation, IconFetcher *iconFetcher, HWND parentWindow) :
 	m_parentWindow(parentWindow),
-	m_menuBuilder(expp, iconFetcher, resourceModule),
+	m_menuBuilder(expp, bookmarkTree, iconFetcher, resourceModule),
 	m_bookmarkContextMenu(bookmarkTree, resourceModule, expp),
 	m_controller(navigation),
 	m_showingMenu(false),
-	m_menuItemPositionMappings(nullptr)
+	m_menuInfo(nullptr)
 {
 	m_windowSubclasses.push_back(std::make_unique<WindowSubclassWrapper>(
 		parentWindow, ParentWindowSubclassStub, SUBCLASS_ID, reinterpret_cast<DWORD_PTR>(this)));
@@ -33,6 +32,14 @@ LRESULT CALLBACK BookmarkMenu::ParentWindowSubclass(
 {
 	switch (msg)
 	{
+	case WM_INITMENUPOPUP:
+		if (m_showingMenu
+			&& m_menuBuilder.OnInitMenuPopup(reinterpret_cast<HMENU>(wParam), *m_menuInfo))
+		{
+			return 0;
+		}
+		break;
+
 	case WM_MENURBUTTONUP:
 	{
 		POINT pt;
@@ -68,9 +75,9 @@ void BookmarkMenu::OnMenuRightButtonUp(HMENU menu, int index, const POINT &pt)
 		return;
 	}
 
-	auto itr = m_menuItemPositionMappings->find({ menu, index });
+	auto itr = m_menuInfo->itemPositionMap.find({ menu, index });
 
-	if (itr == m_menuItemPositionMappings->end())
+	if (itr == m_menuInfo->itemPositionMap.end())
 	{
 		return;
 	}
@@ -89,11 +96,9 @@ BOOL BookmarkMenu::ShowMenu(BookmarkItem *bookmarkItem, const POINT &pt,
 		return FALSE;
 	}
 
-	std::vector<wil::unique_hbitmap> menuImages;
-	BookmarkMenuBuilder::ItemIdMap menuItemIdMappings;
-	BookmarkMenuBuilder::ItemPositionMap menuItemPositionMappings;
-	BOOL res = m_menuBuilder.BuildMenu(m_parentWindow, menu.get(), bookmarkItem, { MIN_ID, MAX_ID },
-		0, menuItemIdMappings, menuImages, &menuItemPositionMappings, nullptr, includePredicate);
+	BookmarkMenuBuilder::MenuInfo menuInfo({ MIN_ID, MAX_ID });
+	BOOL res = m_menuBuilder.BuildMenu(
+		m_parentWindow, menu.get(), bookmarkItem, 0, menuInfo, includePredicate);
 
 	if (!res)
 	{
@@ -101,24 +106,24 @@ BOOL BookmarkMenu::ShowMenu(BookmarkItem *bookmarkItem, const POINT &pt,
 	}
 
 	m_showingMenu = true;
-	m_menuItemPositionMappings = &menuItemPositionMappings;
+	m_menuInfo = &menuInfo;
 
 	int cmd = TrackPopupMenu(
 		menu.get(), TPM_LEFTALIGN | TPM_RETURNCMD, pt.x, pt.y, 0, m_parentWindow, nullptr);
 
 	m_showingMenu = false;
-	m_menuItemPositionMappings = nullptr;
+	m_menuInfo = nullptr;
 
 	if (cmd != 0)
 	{
-		OnMenuItemSelected(cmd, menuItemIdMappings);
+		OnMenuItemSelected(cmd, menuInfo.itemIdMap);
 	}
 
 	return TRUE;
 }
 
 void BookmarkMenu::OnMenuItemSelected(
-	int menuItemId, BookmarkMenuBuilder::ItemIdMap &menuItemIdMappings)
+	int menuItemId, const BookmarkMenuBuilder::ItemIdMap &menuItemIdMappings)
 {
 	auto itr = menuItemIdMappings.find(menuItemId);
 
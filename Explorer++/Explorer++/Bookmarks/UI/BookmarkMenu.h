@@ -39,7 +39,8 @@ private:
 	LRESULT CALLBACK ParentWindowSubclass(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
 	void OnMenuRightButtonUp(HMENU menu, int index, const POINT &pt);
-	void OnMenuItemSelected(int menuItemId, BookmarkMenuBuilder::ItemIdMap &menuItemIdMappings);
+	void OnMenuItemSelected(
+		int menuItemId, const BookmarkMenuBuilder::ItemIdMap &menuItemIdMappings);
 
 	HWND m_parentWindow;
 	BookmarkMenuBuilder m_menuBuilder;
@@ -47,7 +48,7 @@ private:
 	BookmarkMenuController m_controller;
 
 	bool m_showingMenu;
-	BookmarkMenuBuilder::ItemPositionMap *m_menuItemPositionMappings;
+	BookmarkMenuBuilder::MenuInfo *m_menuInfo;
 
 	std::vector<std::unique_ptr<WindowSubclassWrapper>> m_windowSubclasses;
 };
\ No newline at end of file
@@ -4,61 +4,78 @@
 
 #include "stdafx.h"
 #include "Bookmarks/UI/BookmarkMenuBuilder.h"
-#include "Bookmarks/BookmarkIconManager.h"
+#include "Bookmarks/BookmarkTree.h"
+#include "CoreInterface.h"
+#include "Icon.h"
+#include "IconResourceLoader.h"
 #include "MainResource.h"
 #include "ResourceHelper.h"
+#include "../Helper/CachedIcons.h"
 #include "../Helper/DpiCompatibility.h"
+#include "../Helper/IconFetcher.h"
 #include "../Helper/ImageHelper.h"
+#include "../Helper/ShellHelper.h"
 #include <boost/format.hpp>
-#include <wil/common.h>
 
-BookmarkMenuBuilder::BookmarkMenuBuilder(
-	IExplorerplusplus *expp, IconFetcher *iconFetcher, HMODULE resourceModule) :
+BookmarkMenuBuilder::BookmarkMenuBuilder(IExplorerplusplus *expp, BookmarkTree *bookmarkTree,
+	IconFetcher *iconFetcher, HMODULE resourceModule) :
 	m_expp(expp),
+	m_bookmarkTree(bookmarkTree),
 	m_iconFetcher(iconFetcher),
-	m_resourceModule(resourceModule)
+	m_resourceModule(resourceModule),
+	m_iconDpi(0),
+	m_iconWidth(0),
+	m_iconHeight(0),
+	m_defaultFolderIconSystemIndex(GetDefaultFolderIconIndex())
 {
+	SHGetImageList(SHIL_SYSSMALL, IID_PPV_ARGS(&m_systemImageList));
 }
 
 BOOL BookmarkMenuBuilder::BuildMenu(HWND parentWindow, HMENU menu, BookmarkItem *bookmarkItem,
-	const MenuIdRange &menuIdRange, int startPosition, ItemIdMap &itemIdMap,
-	std::vector<wil::unique_hbitmap> &menuImages, ItemPositionMap *itemPositionMap,
-	int *nextMenuItemId, IncludePredicate includePredicate)
+	int startPosition, MenuInfo &menuInfo, IncludePredicate includePredicate)
 {
 	assert(bookmarkItem->IsFolder());
 
-	m_menuIdRange = menuIdRange;
-	m_idCounter = menuIdRange.startId;
+	UpdateIconSize(parentWindow);
 
-	auto &dpiCompat = DpiCompatibility::GetInstance();
-	UINT dpi = dpiCompat.GetDpiForWindow(parentWindow);
-	int iconWidth = dpiCompat.GetSystemMetricsForDpi(SM_CXSMICON, dpi);
-	int iconHeight = dpiCompat.GetSystemMetricsForDpi(SM_CYSMICON, dpi);
+	return AddItemsToMenu(menu, bookmarkItem, startPosition, menuInfo, includePredicate);
+}
 
-	BookmarkIconManager bookmarkIconManager(m_expp, m_iconFetcher, nullptr, iconWidth, iconHeight);
+bool BookmarkMenuBuilder::OnInitMenuPopup(HMENU menu, MenuInfo &menuInfo)
+{
+	auto itr = menuInfo.pendingSubmenus.find(menu);
 
-	BOOL res = BuildMenu(menu, bookmarkItem, startPosition, itemIdMap, bookmarkIconManager,
-		menuImages, itemPositionMap, true, includePredicate);
-	wil::assign_to_opt_param(nextMenuItemId, m_idCounter);
+	if (itr == menuInfo.pendingSubmenus.end())
+	{
+		return false;
+	}
 
-	return res;
+	BookmarkItem *bookmarkFolder = m_bookmarkTree->GetBookmarkItemById(itr->second);
+	menuInfo.pendingSubmenus.erase(itr);
+
+	if (!bookmarkFolder || !bookmarkFolder->IsFolder())
+	{
+		return false;
+	}
+
+	AddItemsToMenu(menu, bookmarkFolder, 0, menuInfo, nullptr);
+
+	return true;
 }
 
-BOOL BookmarkMenuBuilder::BuildMenu(HMENU menu, BookmarkItem *bookmarkItem, int startPosition,
-	ItemIdMap &itemIdMap, BookmarkIconManager &bookmarkIconManager,
-	std::vector<wil::unique_hbitmap> &menuImages, ItemPositionMap *itemPositionMap,
-	bool applyIncludePredicate, IncludePredicate includePredicate)
+BOOL BookmarkMenuBuilder::AddItemsToMenu(HMENU menu, BookmarkItem *bookmarkItem,
+	int startPosition, MenuInfo &menuInfo, IncludePredicate includePredicate)
 {
 	if (bookmarkItem->GetChildren().empty())
 	{
-		return AddEmptyBookmarkFolderToMenu(menu, bookmarkItem, startPosition, itemPositionMap);
+		return AddEmptyBookmarkFolderToMenu(menu, bookmarkItem, startPosition, menuInfo);
 	}
 
 	int position = startPosition;
 
 	for (auto &childItem : bookmarkItem->GetChildren())
 	{
-		if (applyIncludePredicate && includePredicate && !includePredicate(childItem.get()))
+		if (includePredicate && !includePredicate(childItem.get()))
 		{
 			continue;
 		}
@@ -67,13 +84,11 @@ BOOL BookmarkMenuBuilder::BuildMenu(HMENU menu, BookmarkItem *bookmarkItem, int
 
 		if (childItem->IsFolder())
 		{
-			res = AddBookmarkFolderToMenu(menu, childItem.get(), position, itemIdMap,
-				bookmarkIconManager, menuImages, itemPositionMap);
+			res = AddBookmarkFolderToMenu(menu, childItem.get(), position, menuInfo);
 		}
 		else
 		{
-			res = AddBookmarkToMenu(menu, childItem.get(), position, itemIdMap, bookmarkIconManager,
-				menuImages, itemPositionMap);
+			res = AddBookmarkToMenu(menu, childItem.get(), position, menuInfo);
 		}
 
 		if (!res)
@@ -88,7 +103,7 @@ BOOL BookmarkMenuBuilder::BuildMenu(HMENU menu, BookmarkItem *bookmarkItem, int
 }
 
 BOOL BookmarkMenuBuilder::AddEmptyBookmarkFolderToMenu(
-	HMENU menu, BookmarkItem *bookmarkItem, int position, ItemPositionMap *itemPositionMap)
+	HMENU menu, BookmarkItem *bookmarkItem, int position, MenuInfo &menuInfo)
 {
 	std::wstring bookmarkFolderEmpty =
 		ResourceHelper::LoadString(m_resourceModule, IDS_BOOKMARK_FOLDER_EMPTY);
@@ -106,24 +121,21 @@ BOOL BookmarkMenuBuilder::AddEmptyBookmarkFolderToMenu(
 		return FALSE;
 	}
 
-	if (itemPositionMap)
-	{
-		// If you right-click the empty item shown in a bookmark drop-down in
-		// Chrome/Firefox, the parent item will be used as the target of any
-		// context menu operations (e.g. selecting "Copy" will copy the parent
-		// folder).
-		// To enable similar behavior here, the empty item is mapped to the
-		// parent.
-		itemPositionMap->insert({ { menu, position }, bookmarkItem });
-	}
+	// If you right-click the empty item shown in a bookmark drop-down in
+	// Chrome/Firefox, the parent item will be used as the target of any context
+	// menu operations (e.g. selecting "Copy" will copy the parent folder).
+	// To enable similar behavior here, the empty item is mapped to the parent.
+	menuInfo.itemPositionMap.insert({ { menu, position }, bookmarkItem });
 
 	return res;
 }
 
-BOOL BookmarkMenuBuilder::AddBookmarkFolderToMenu(HMENU menu, BookmarkItem *bookmarkItem,
-	int position, ItemIdMap &itemIdMap, BookmarkIconManager &bookmarkIconManager,
-	std::vector<wil::unique_hbitmap> &menuImages, ItemPositionMap *itemPositionMap)
+BOOL BookmarkMenuBuilder::AddBookmarkFolderToMenu(
+	HMENU menu, BookmarkItem *bookmarkItem, int position, MenuInfo &menuInfo)
 {
+	// The submenu is left empty here and populated when it's about to be
+	// shown. Note that as DestroyMenu is recursive, the submenu will be
+	// destroyed when its parent menu is.
 	HMENU subMenu = CreatePopupMenu();
 
 	if (subMenu == nullptr)
@@ -142,27 +154,24 @@ BOOL BookmarkMenuBuilder::AddBookmarkFolderToMenu(HMENU menu, BookmarkItem *book
 
 	if (!res)
 	{
+		DestroyMenu(subMenu);
 		return FALSE;
 	}
 
-	AddIconToMenuItem(menu, position, bookmarkItem, bookmarkIconManager, menuImages);
+	AddIconToMenuItem(menu, position, bookmarkItem, menuInfo);
 
-	if (itemPositionMap)
-	{
-		itemPositionMap->insert({ { menu, position }, bookmarkItem });
-	}
+	menuInfo.itemPositionMap.insert({ { menu, position }, bookmarkItem });
+	menuInfo.pendingSubmenus.insert({ subMenu, bookmarkItem->GetGUID() });
 
-	return BuildMenu(subMenu, bookmarkItem, 0, itemIdMap, bookmarkIconManager, menuImages,
-		itemPositionMap, false, nullptr);
+	return res;
 }
 
-BOOL BookmarkMenuBuilder::AddBookmarkToMenu(HMENU menu, BookmarkItem *bookmarkItem, int position,
-	ItemIdMap &itemIdMap, BookmarkIconManager &bookmarkIconManager,
-	std::vector<wil::unique_hbitmap> &menuImages, ItemPositionMap *itemPositionMap)
+BOOL BookmarkMenuBuilder::AddBookmarkToMenu(
+	HMENU menu, BookmarkItem *bookmarkItem, int position, MenuInfo &menuInfo)
 {
-	int id = m_idCounter++;
+	int id = menuInfo.nextMenuItemId++;
 
-	if (id >= m_menuIdRange.endId)
+	if (id >= menuInfo.menuIdRange.endId)
 	{
 		return FALSE;
 	}
@@ -181,35 +190,98 @@ BOOL BookmarkMenuBuilder::AddBookmarkToMenu(HMENU menu, BookmarkItem *bookmarkIt
 		return FALSE;
 	}
 
-	AddIconToMenuItem(menu, position, bookmarkItem, bookmarkIconManager, menuImages);
+	AddIconToMenuItem(menu, position, bookmarkItem, menuInfo);
+
+	menuInfo.itemIdMap.insert({ id, bookmarkItem });
+	menuInfo.itemPositionMap.insert({ { menu, position }, bookmarkItem });
+
+	return res;
+}
+
+void BookmarkMenuBuilder::UpdateIconSize(HWND parentWindow)
+{
+	auto &dpiCompat = DpiCompatibility::GetInstance();
+	UINT dpi = dpiCompat.GetDpiForWindow(parentWindow);
+
+	if (dpi == m_iconDpi)
+	{
+		return;
+	}
+
+	m_iconDpi = dpi;
+	m_iconWidth = dpiCompat.GetSystemMetricsForDpi(SM_CXSMICON, dpi);
+	m_iconHeight = dpiCompat.GetSystemMetricsForDpi(SM_CYSMICON, dpi);
+
+	// Any bitmaps that were created at the previous size may still be in use
+	// by an existing menu, so they can't be destroyed here. However, the menu
+	// that's about to be built replaces any existing menu in both of the places
+	// this class is used, so the bitmaps will no longer be needed by the time
+	// the new menu is shown.
+	m_folderBitmap = m_expp->GetIconResourceLoader()->LoadBitmapFromPNGAndScale(
+		Icon::Folder, m_iconWidth, m_iconHeight);
+	m_systemIconBitmaps.clear();
+}
 
-	itemIdMap.insert({ id, bookmarkItem });
+void BookmarkMenuBuilder::AddIconToMenuItem(
+	HMENU menu, int position, const BookmarkItem *bookmarkItem, MenuInfo &menuInfo)
+{
+	if (bookmarkItem->IsFolder())
+	{
+		SetMenuItemBitmap(menu, position, m_folderBitmap.get());
+		return;
+	}
 
-	if (itemPositionMap)
+	auto cachedIconIndex = m_expp->GetCachedIcons()->findByPath(bookmarkItem->GetLocation());
+
+	if (cachedIconIndex)
 	{
-		itemPositionMap->insert({ { menu, position }, bookmarkItem });
+		SetMenuItemBitmap(menu, position, GetSystemIconBitmap(*cachedIconIndex));
+		return;
 	}
 
-	return res;
+	// Bookmarks use the standard folder icon until their actual icon has been
+	// retrieved. Once that happens, the icon will also be in the shared cache,
+	// so it will be used immediately the next time the menu is built.
+	SetMenuItemBitmap(menu, position, GetSystemIconBitmap(m_defaultFolderIconSystemIndex));
+
+	m_iconFetcher->QueueIconTask(bookmarkItem->GetLocation(),
+		[this, menu, position, token = std::weak_ptr<bool>(menuInfo.token)](int systemIconIndex) {
+			if (token.expired() || systemIconIndex == m_defaultFolderIconSystemIndex)
+			{
+				return;
+			}
+
+			SetMenuItemBitmap(menu, position, GetSystemIconBitmap(systemIconIndex));
+		});
 }
 
-void BookmarkMenuBuilder::AddIconToMenuItem(HMENU menu, int position,
-	const BookmarkItem *bookmarkItem, BookmarkIconManager &bookmarkIconManager,
-	std::vector<wil::unique_hbitmap> &menuImages)
+HBITMAP BookmarkMenuBuilder::GetSystemIconBitmap(int systemIconIndex)
 {
-	int iconIndex = bookmarkIconManager.GetBookmarkItemIconIndex(bookmarkItem);
+	auto itr = m_systemIconBitmaps.find(systemIconIndex);
+
+	if (itr != m_systemIconBitmaps.end())
+	{
+		return itr->second.get();
+	}
 
-	wil::com_ptr<IImageList> imageList;
-	HRESULT hr =
-		HIMAGELIST_QueryInterface(bookmarkIconManager.GetImageList(), IID_PPV_ARGS(&imageList));
+	wil::unique_hicon icon;
+	HRESULT hr = m_systemImageList->GetIcon(systemIconIndex, ILD_NORMAL, &icon);
 
 	if (FAILED(hr))
 	{
-		return;
+		return nullptr;
 	}
 
-	auto bitmap = ImageHelper::ImageListIconToBitmap(imageList.get(), iconIndex);
+	wil::unique_hbitmap bitmap(
+		ImageHelper::IconToBitmapPARGB32(icon.get(), m_iconWidth, m_iconHeight));
+	HBITMAP rawBitmap = bitmap.get();
+	m_systemIconBitmaps.insert({ systemIconIndex, std::move(bitmap) });
 
+	return rawBitmap;
+}
+
+void BookmarkMenuBuilder::SetMenuItemBitmap(HMENU menu, int position, HBITMAP bitmap)
+{
 	if (!bitmap)
 	{
 		return;
@@ -218,11 +290,6 @@ void BookmarkMenuBuilder::AddIconToMenuItem(HMENU menu, int position,
 	MENUITEMINFO mii;
 	mii.cbSize = sizeof(mii);
 	mii.fMask = MIIM_BITMAP;
-	mii.hbmpItem = bitmap.get();
-	const BOOL res = SetMenuItemInfo(menu, position, true, &mii);
-
-	if (res)
-	{
-		menuImages.push_back(std::move(bitmap));
-	}
+	mii.hbmpItem = bitmap;
+	SetMenuItemInfo(menu, position, TRUE, &mii);
 }
\ No newline at end of file
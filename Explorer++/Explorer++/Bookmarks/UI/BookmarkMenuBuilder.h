@@ -7,14 +7,23 @@
 #include "Bookmarks/BookmarkItem.h"
 #include "MenuHelper.h"
 #include <boost/functional/hash.hpp>
+#include <wil/com.h>
+#include <wil/resource.h>
 #include <functional>
+#include <memory>
+#include <string>
 #include <unordered_map>
 #include <utility>
 
-class BookmarkIconManager;
+class BookmarkTree;
 class IconFetcher;
 __interface IExplorerplusplus;
 
+// Builds menus for bookmark folders. Only the items in the top-level folder are
+// added when the menu is built. The submenu for each nested folder is populated
+// the first time it's shown (i.e. when the parent window receives
+// WM_INITMENUPOPUP for it), so the cost of building a menu doesn't depend on the
+// size of the entire bookmark hierarchy.
 class BookmarkMenuBuilder
 {
 public:
@@ -30,32 +39,74 @@ public:
 
 	using IncludePredicate = std::function<bool(const BookmarkItem *bookmarkItem)>;
 
-	BookmarkMenuBuilder(IExplorerplusplus *expp, IconFetcher *iconFetcher, HMODULE resourceModule);
+	// Holds the state associated with a built menu. As submenus are populated
+	// on demand, this needs to remain alive for as long as the menu does. It
+	// should also be destroyed before the builder.
+	struct MenuInfo
+	{
+		explicit MenuInfo(const MenuIdRange &menuIdRange) :
+			menuIdRange(menuIdRange),
+			nextMenuItemId(menuIdRange.startId)
+		{
+		}
 
-	BOOL BuildMenu(HWND parentWindow, HMENU menu, BookmarkItem *bookmarkItem,
-		const MenuIdRange &menuIdRange, int startPosition, ItemIdMap &itemIdMap,
-		std::vector<wil::unique_hbitmap> &menuImages, ItemPositionMap *itemPositionMap = nullptr,
-		int *nextMenuItemId = nullptr, IncludePredicate includePredicate = nullptr);
+		MenuIdRange menuIdRange;
+		int nextMenuItemId;
+
+		ItemIdMap itemIdMap;
+		ItemPositionMap itemPositionMap;
+
+		// Maps submenus that haven't been populated yet to the GUID of the
+		// folder they represent. The GUID is used (rather than a pointer to the
+		// folder) so that if the folder is deleted while the menu is open, the
+		// submenu will simply be left empty.
+		std::unordered_map<HMENU, std::wstring> pendingSubmenus;
+
+		// Used to determine whether the menu still exists when an icon
+		// finishes loading.
+		std::shared_ptr<bool> token = std::make_shared<bool>(true);
+	};
+
+	BookmarkMenuBuilder(IExplorerplusplus *expp, BookmarkTree *bookmarkTree,
+		IconFetcher *iconFetcher, HMODULE resourceModule);
+
+	BOOL BuildMenu(HWND parentWindow, HMENU menu, BookmarkItem *bookmarkItem, int startPosition,
+		MenuInfo &menuInfo, IncludePredicate includePredicate = nullptr);
+
+	// Should be called when the parent window receives WM_INITMENUPOPUP. If the
+	// menu is a bookmark folder submenu that hasn't been populated yet, its
+	// items will be added. Returns true if the menu was populated.
+	bool OnInitMenuPopup(HMENU menu, MenuInfo &menuInfo);
 
 private:
-	BOOL BuildMenu(HMENU menu, BookmarkItem *bookmarkItem, int startPosition, ItemIdMap &itemIdMap,
-		BookmarkIconManager &bookmarkIconManager, std::vector<wil::unique_hbitmap> &menuImages,
-		ItemPositionMap *itemPositionMap, bool applyIncludePredicate,
-		IncludePredicate includePredicate);
+	BOOL AddItemsToMenu(HMENU menu, BookmarkItem *bookmarkItem, int startPosition,
+		MenuInfo &menuInfo, IncludePredicate includePredicate);
 	BOOL AddEmptyBookmarkFolderToMenu(
-		HMENU menu, BookmarkItem *bookmarkItem, int position, ItemPositionMap *itemPositionMap);
-	BOOL AddBookmarkFolderToMenu(HMENU menu, BookmarkItem *bookmarkItem, int position,
-		ItemIdMap &itemIdMap, BookmarkIconManager &bookmarkIconManager,
-		std::vector<wil::unique_hbitmap> &menuImages, ItemPositionMap *itemPositionMap);
-	BOOL AddBookmarkToMenu(HMENU menu, BookmarkItem *bookmarkItem, int position,
-		ItemIdMap &itemIdMap, BookmarkIconManager &bookmarkIconManager,
-		std::vector<wil::unique_hbitmap> &menuImages, ItemPositionMap *itemPositionMap);
-	void AddIconToMenuItem(HMENU menu, int position, const BookmarkItem *bookmarkItem,
-		BookmarkIconManager &bookmarkIconManager, std::vector<wil::unique_hbitmap> &menuImages);
+		HMENU menu, BookmarkItem *bookmarkItem, int position, MenuInfo &menuInfo);
+	BOOL AddBookmarkFolderToMenu(
+		HMENU menu, BookmarkItem *bookmarkItem, int position, MenuInfo &menuInfo);
+	BOOL AddBookmarkToMenu(
+		HMENU menu, BookmarkItem *bookmarkItem, int position, MenuInfo &menuInfo);
+
+	void UpdateIconSize(HWND parentWindow);
+	void AddIconToMenuItem(
+		HMENU menu, int position, const BookmarkItem *bookmarkItem, MenuInfo &menuInfo);
+	HBITMAP GetSystemIconBitmap(int systemIconIndex);
+	void SetMenuItemBitmap(HMENU menu, int position, HBITMAP bitmap);
 
 	IExplorerplusplus *m_expp;
+	BookmarkTree *m_bookmarkTree;
 	IconFetcher *m_iconFetcher;
 	HMODULE m_resourceModule;
-	MenuIdRange m_menuIdRange;
-	int m_idCounter;
+
+	// Menu item bitmaps are owned by the builder and reused each time a menu is
+	// built. They're discarded if the icon size changes (e.g. because the
+	// parent window moved to a monitor with a different DPI).
+	UINT m_iconDpi;
+	int m_iconWidth;
+	int m_iconHeight;
+	wil::com_ptr<IImageList> m_systemImageList;
+	int m_defaultFolderIconSystemIndex;
+	wil::unique_hbitmap m_folderBitmap;
+	std::unordered_map<int, wil::unique_hbitmap> m_systemIconBitmaps;
 };
\ No newline at end of file
@@ -4,7 +4,6 @@
 
 #include "stdafx.h"
 #include "Bookmarks/UI/BookmarksMainMenu.h"
-#include "Bookmarks/BookmarkIconManager.h"
 #include "Bookmarks/BookmarkTree.h"
 #include "CoreInterface.h"
 #include "MainResource.h"
@@ -19,8 +18,11 @@ BookmarksMainMenu::BookmarksMainMenu(IExplorerplusplus *expp, IconFetcher *iconF
 	m_expp(expp),
 	m_bookmarkTree(bookmarkTree),
 	m_menuIdRange(menuIdRange),
-	m_menuBuilder(expp, iconFetcher, expp->GetLanguageModule())
+	m_menuBuilder(expp, bookmarkTree, iconFetcher, expp->GetLanguageModule())
 {
+	m_windowSubclasses.push_back(std::make_unique<WindowSubclassWrapper>(expp->GetMainWindow(),
+		MainWindowSubclassStub, SUBCLASS_ID, reinterpret_cast<DWORD_PTR>(this)));
+
 	m_connections.push_back(expp->AddMainMenuPreShowObserver(
 		std::bind(&BookmarksMainMenu::OnMainMenuPreShow, this, std::placeholders::_1)));
 }
@@ -34,11 +36,37 @@ BookmarksMainMenu::~BookmarksMainMenu()
 	SetMenuItemInfo(GetMenu(m_expp->GetMainWindow()), IDM_BOOKMARKS, FALSE, &mii);
 }
 
+LRESULT CALLBACK BookmarksMainMenu::MainWindowSubclassStub(
+	HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam, UINT_PTR uIdSubclass, DWORD_PTR dwRefData)
+{
+	UNREFERENCED_PARAMETER(uIdSubclass);
+
+	auto *bookmarksMainMenu = reinterpret_cast<BookmarksMainMenu *>(dwRefData);
+	return bookmarksMainMenu->MainWindowSubclass(hwnd, uMsg, wParam, lParam);
+}
+
+LRESULT CALLBACK BookmarksMainMenu::MainWindowSubclass(
+	HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+	switch (msg)
+	{
+	case WM_INITMENUPOPUP:
+		if (m_menuInfo
+			&& m_menuBuilder.OnInitMenuPopup(reinterpret_cast<HMENU>(wParam), *m_menuInfo))
+		{
+			return 0;
+		}
+		break;
+	}
+
+	return DefSubclassProc(hwnd, msg, wParam, lParam);
+}
+
 void BookmarksMainMenu::OnMainMenuPreShow(HMENU mainMenu)
 {
 	std::vector<wil::unique_hbitmap> menuImages;
-	BookmarkMenuBuilder::ItemIdMap menuItemIdMappings;
-	auto bookmarksMenu = BuildMainBookmarksMenu(menuImages, menuItemIdMappings);
+	auto menuInfo = std::make_unique<BookmarkMenuBuilder::MenuInfo>(m_menuIdRange);
+	auto bookmarksMenu = BuildMainBookmarksMenu(menuImages, *menuInfo);
 
 	MENUITEMINFO mii;
 	mii.cbSize = sizeof(mii);
@@ -48,12 +76,11 @@ void BookmarksMainMenu::OnMainMenuPreShow(HMENU mainMenu)
 
 	m_bookmarksMenu = std::move(bookmarksMenu);
 	m_menuImages = std::move(menuImages);
-	m_menuItemIdMappings = menuItemIdMappings;
+	m_menuInfo = std::move(menuInfo);
 }
 
 wil::unique_hmenu BookmarksMainMenu::BuildMainBookmarksMenu(
-	std::vector<wil::unique_hbitmap> &menuImages,
-	BookmarkMenuBuilder::ItemIdMap &menuItemIdMappings)
+	std::vector<wil::unique_hbitmap> &menuImages, BookmarkMenuBuilder::MenuInfo &menuInfo)
 {
 	wil::unique_hmenu menu(CreatePopupMenu());
 
@@ -95,19 +122,14 @@ wil::unique_hmenu BookmarksMainMenu::BuildMainBookmarksMenu(
 	ResourceHelper::SetMenuItemImage(menu.get(), IDM_BOOKMARKS_MANAGEBOOKMARKS,
 		m_expp->GetIconResourceLoader(), Icon::Bookmarks, dpi, menuImages);
 
-	int nextMenuItemId;
-	AddBookmarkItemsToMenu(menu.get(), m_menuIdRange, GetMenuItemCount(menu.get()), menuImages,
-		menuItemIdMappings, &nextMenuItemId);
-
-	AddOtherBookmarksToMenu(menu.get(), { nextMenuItemId, m_menuIdRange.endId },
-		GetMenuItemCount(menu.get()), menuImages, menuItemIdMappings);
+	AddBookmarkItemsToMenu(menu.get(), GetMenuItemCount(menu.get()), menuInfo);
+	AddOtherBookmarksToMenu(menu.get(), GetMenuItemCount(menu.get()), menuInfo);
 
 	return menu;
 }
 
-void BookmarksMainMenu::AddBookmarkItemsToMenu(HMENU menu, const MenuIdRange &menuIdRange,
-	int position, std::vector<wil::unique_hbitmap> &menuImages,
-	BookmarkMenuBuilder::ItemIdMap &menuItemIdMappings, int *maxMenuItemId)
+void BookmarksMainMenu::AddBookmarkItemsToMenu(
+	HMENU menu, int position, BookmarkMenuBuilder::MenuInfo &menuInfo)
 {
 	BookmarkItem *bookmarksMenuFolder = m_bookmarkTree->GetBookmarksMenuFolder();
 
@@ -122,13 +144,11 @@ void BookmarksMainMenu::AddBookmarkItemsToMenu(HMENU menu, const MenuIdRange &me
 	mii.fType = MFT_SEPARATOR;
 	InsertMenuItem(menu, position++, TRUE, &mii);
 
-	m_menuBuilder.BuildMenu(m_expp->GetMainWindow(), menu, bookmarksMenuFolder, menuIdRange,
-		position, menuItemIdMappings, menuImages, nullptr, maxMenuItemId);
+	m_menuBuilder.BuildMenu(m_expp->GetMainWindow(), menu, bookmarksMenuFolder, position, menuInfo);
 }
 
-void BookmarksMainMenu::AddOtherBookmarksToMenu(HMENU menu, const MenuIdRange &menuIdRange,
-	int position, std::vector<wil::unique_hbitmap> &menuImages,
-	BookmarkMenuBuilder::ItemIdMap &menuItemIdMappings)
+void BookmarksMainMenu::AddOtherBookmarksToMenu(
+	HMENU menu, int position, BookmarkMenuBuilder::MenuInfo &menuInfo)
 {
 	BookmarkItem *otherBookmarksFolder = m_bookmarkTree->GetOtherBookmarksFolder();
 
@@ -146,8 +166,7 @@ void BookmarksMainMenu::AddOtherBookmarksToMenu(HMENU menu, const MenuIdRange &m
 	// Note that as DestroyMenu is recursive, this menu will be destroyed when
 	// its parent menu is.
 	HMENU subMenu = CreatePopupMenu();
-	m_menuBuilder.BuildMenu(m_expp->GetMainWindow(), subMenu, otherBookmarksFolder, menuIdRange, 0,
-		menuItemIdMappings, menuImages);
+	m_menuBuilder.BuildMenu(m_expp->GetMainWindow(), subMenu, otherBookmarksFolder, 0, menuInfo);
 
 	std::wstring otherBookmarksName = otherBookmarksFolder->GetName();
 
@@ -161,9 +180,14 @@ void BookmarksMainMenu::AddOtherBookmarksToMenu(HMENU menu, const MenuIdRange &m
 
 void BookmarksMainMenu::OnMenuItemClicked(int menuItemId)
 {
-	auto itr = m_menuItemIdMappings.find(menuItemId);
+	if (!m_menuInfo)
+	{
+		return;
+	}
+
+	auto itr = m_menuInfo->itemIdMap.find(menuItemId);
 
-	if (itr == m_menuItemIdMappings.end())
+	if (itr == m_menuInfo->itemIdMap.end())
 	{
 		return;
 	}
@@ -6,8 +6,11 @@
 
 #include "Bookmarks/UI/BookmarkMenuBuilder.h"
 #include "MenuHelper.h"
+#include "../Helper/WindowSubclassWrapper.h"
 #include <boost/signals2.hpp>
 #include <wil/resource.h>
+#include <memory>
+#include <vector>
 
 class BookmarkTree;
 class IconFetcher;
@@ -23,15 +26,17 @@ public:
 	void OnMenuItemClicked(int menuItemId);
 
 private:
+	static const UINT_PTR SUBCLASS_ID = 0;
+
+	static LRESULT CALLBACK MainWindowSubclassStub(HWND hwnd, UINT uMsg, WPARAM wParam,
+		LPARAM lParam, UINT_PTR uIdSubclass, DWORD_PTR dwRefData);
+	LRESULT CALLBACK MainWindowSubclass(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
+
 	void OnMainMenuPreShow(HMENU mainMenu);
 	wil::unique_hmenu BuildMainBookmarksMenu(std::vector<wil::unique_hbitmap> &menuImages,
-		BookmarkMenuBuilder::ItemIdMap &menuItemIdMappings);
-	void AddBookmarkItemsToMenu(HMENU menu, const MenuIdRange &menuIdRange, int position,
-		std::vector<wil::unique_hbitmap> &menuImages,
-		BookmarkMenuBuilder::ItemIdMap &menuItemIdMappings, int *maxMenuItemId);
-	void AddOtherBookmarksToMenu(HMENU menu, const MenuIdRange &menuIdRange, int position,
-		std::vector<wil::unique_hbitmap> &menuImages,
-		BookmarkMenuBuilder::ItemIdMap &menuItemIdMappings);
+		BookmarkMenuBuilder::MenuInfo &menuInfo);
+	void AddBookmarkItemsToMenu(HMENU menu, int position, BookmarkMenuBuilder::MenuInfo &menuInfo);
+	void AddOtherBookmarksToMenu(HMENU menu, int position, BookmarkMenuBuilder::MenuInfo &menuInfo);
 
 	IExplorerplusplus *m_expp;
 	BookmarkTree *m_bookmarkTree;
@@ -42,7 +47,10 @@ private:
 
 	std::vector<wil::unique_hbitmap> m_menuImages;
 
-	BookmarkMenuBuilder::ItemIdMap m_menuItemIdMappings;
+	// Submenus are populated as they're opened, so this needs to be kept for as
+	// long as the menu is.
+	std::unique_ptr<BookmarkMenuBuilder::MenuInfo> m_menuInfo;
 
+	std::vector<std::unique_ptr<WindowSubclassWrapper>> m_windowSubclasses;
 	std::vector<boost::signals2::scoped_connection> m_connections;
 };
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include "../Helper/StringHelper.h"
 #include "../Helper/WindowHelper.h"
 #include "../Helper/XMLSettings.h"
+#include "../Helper/XmlStream.h"
 #include <wil/resource.h>
 
 namespace NColorRuleDialog
@@ -302,40 +303,37 @@ void ColorRuleDialogPersistentSettings::LoadExtraRegistrySettings(HKEY hKey)
 		reinterpret_cast<LPBYTE>(&m_cfCustomColors), &dwSize);
 }
 
-void ColorRuleDialogPersistentSettings::SaveExtraXMLSettings(
-	IXMLDOMDocument *pXMLDom, IXMLDOMElement *pParentNode)
+void ColorRuleDialogPersistentSettings::SaveExtraXMLSettings(XmlStreamWriter &writer)
 {
 	TCHAR szNode[32];
 
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, _T("InitialColor_r"),
+	writer.WriteAttribute(_T("InitialColor_r"),
 		NXMLSettings::EncodeIntValue(GetRValue(m_cfInitialColor)));
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, _T("InitialColor_g"),
+	writer.WriteAttribute(_T("InitialColor_g"),
 		NXMLSettings::EncodeIntValue(GetGValue(m_cfInitialColor)));
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, _T("InitialColor_b"),
+	writer.WriteAttribute(_T("InitialColor_b"),
 		NXMLSettings::EncodeIntValue(GetBValue(m_cfInitialColor)));
 
 	for (int i = 0; i < SIZEOF_ARRAY(m_cfCustomColors); i++)
 	{
 		StringCchPrintf(szNode, SIZEOF_ARRAY(szNode), _T("r%d"), i);
-		NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, szNode,
-			NXMLSettings::EncodeIntValue(GetRValue(m_cfCustomColors[i])));
+		writer.WriteAttribute(szNode, NXMLSettings::EncodeIntValue(GetRValue(m_cfCustomColors[i])));
 		StringCchPrintf(szNode, SIZEOF_ARRAY(szNode), _T("g%d"), i);
-		NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, szNode,
-			NXMLSettings::EncodeIntValue(GetGValue(m_cfCustomColors[i])));
+		writer.WriteAttribute(szNode, NXMLSettings::EncodeIntValue(GetGValue(m_cfCustomColors[i])));
 		StringCchPrintf(szNode, SIZEOF_ARRAY(szNode), _T("b%d"), i);
-		NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, szNode,
-			NXMLSettings::EncodeIntValue(GetBValue(m_cfCustomColors[i])));
+		writer.WriteAttribute(szNode, NXMLSettings::EncodeIntValue(GetBValue(m_cfCustomColors[i])));
 	}
 }
 
-void ColorRuleDialogPersistentSettings::LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue)
+void ColorRuleDialogPersistentSettings::LoadExtraXMLSettings(
+	const WCHAR *wszName, const WCHAR *wszValue)
 {
-	if (CheckWildcardMatch(_T("r*"), bstrName, TRUE) || CheckWildcardMatch(_T("g*"), bstrName, TRUE)
-		|| CheckWildcardMatch(_T("b*"), bstrName, TRUE))
+	if (CheckWildcardMatch(_T("r*"), wszName, TRUE) || CheckWildcardMatch(_T("g*"), wszName, TRUE)
+		|| CheckWildcardMatch(_T("b*"), wszName, TRUE))
 	{
 		/* At the very least, the attribute name
 		should reference a color component and index. */
-		if (lstrlen(bstrName) < 2)
+		if (lstrlen(wszName) < 2)
 		{
 			return;
 		}
@@ -343,7 +341,7 @@ void ColorRuleDialogPersistentSettings::LoadExtraXMLSettings(BSTR bstrName, BSTR
 		int iIndex = 0;
 
 		/* Extract the index. */
-		std::wstring strIndex = bstrName;
+		std::wstring strIndex = wszName;
 		std::wistringstream iss(strIndex.substr(1));
 		iss >> iIndex;
 
@@ -353,34 +351,34 @@ void ColorRuleDialogPersistentSettings::LoadExtraXMLSettings(BSTR bstrName, BSTR
 		}
 
 		COLORREF clr = m_cfCustomColors[iIndex];
-		BYTE c = static_cast<BYTE>(NXMLSettings::DecodeIntValue(bstrValue));
+		BYTE c = static_cast<BYTE>(NXMLSettings::DecodeIntValue(wszValue));
 
-		if (CheckWildcardMatch(_T("r*"), bstrName, TRUE))
+		if (CheckWildcardMatch(_T("r*"), wszName, TRUE))
 		{
 			m_cfCustomColors[iIndex] = RGB(c, GetGValue(clr), GetBValue(clr));
 		}
-		else if (CheckWildcardMatch(_T("g*"), bstrName, TRUE))
+		else if (CheckWildcardMatch(_T("g*"), wszName, TRUE))
 		{
 			m_cfCustomColors[iIndex] = RGB(GetRValue(clr), c, GetBValue(clr));
 		}
-		else if (CheckWildcardMatch(_T("b*"), bstrName, TRUE))
+		else if (CheckWildcardMatch(_T("b*"), wszName, TRUE))
 		{
 			m_cfCustomColors[iIndex] = RGB(GetRValue(clr), GetGValue(clr), c);
 		}
 	}
 	else
 	{
-		BYTE c = static_cast<BYTE>(NXMLSettings::DecodeIntValue(bstrValue));
+		BYTE c = static_cast<BYTE>(NXMLSettings::DecodeIntValue(wszValue));
 
-		if (lstrcmpi(_T("InitialColor_r"), bstrName) == 0)
+		if (lstrcmpi(_T("InitialColor_r"), wszName) == 0)
 		{
 			m_cfInitialColor = RGB(c, GetGValue(m_cfInitialColor), GetBValue(m_cfInitialColor));
 		}
-		else if (lstrcmpi(_T("InitialColor_g"), bstrName) == 0)
+		else if (lstrcmpi(_T("InitialColor_g"), wszName) == 0)
 		{
 			m_cfInitialColor = RGB(GetRValue(m_cfInitialColor), c, GetBValue(m_cfInitialColor));
 		}
-		else if (lstrcmpi(_T("InitialColor_b"), bstrName) == 0)
+		else if (lstrcmpi(_T("InitialColor_b"), wszName) == 0)
 		{
 			m_cfInitialColor = RGB(GetRValue(m_cfInitialColor), GetGValue(m_cfInitialColor), c);
 		}
@@ -32,8 +32,8 @@ private:
 	void SaveExtraRegistrySettings(HKEY hKey) override;
 	void LoadExtraRegistrySettings(HKEY hKey) override;
 
-	void SaveExtraXMLSettings(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pParentNode) override;
-	void LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue) override;
+	void SaveExtraXMLSettings(XmlStreamWriter &writer) override;
+	void LoadExtraXMLSettings(const WCHAR *wszName, const WCHAR *wszValue) override;
 
 	COLORREF m_cfInitialColor;
 	COLORREF m_cfCustomColors[16];
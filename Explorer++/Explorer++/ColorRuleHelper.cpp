@@ -9,7 +9,7 @@
 #include "../Helper/Macros.h"
 #include "../Helper/RegistrySettings.h"
 #include "../Helper/XMLSettings.h"
-#include <comdef.h>
+#include "../Helper/XmlStream.h"
 #include <vector>
 
 namespace
@@ -25,9 +25,9 @@ namespace
 		HKEY hKey, const NColorRuleHelper::ColorRule &ColorRule, int iCount);
 
 	void LoadColorRulesFromXMLInternal(
-		IXMLDOMNode *pNode, std::vector<NColorRuleHelper::ColorRule> &ColorRules);
+		const XmlStreamReader &reader, std::vector<NColorRuleHelper::ColorRule> &ColorRules);
 	void SaveColorRulesToXMLInternal(
-		IXMLDOMDocument *pXMLDom, IXMLDOMElement *pe, const NColorRuleHelper::ColorRule &colorRule);
+		XmlStreamWriter &writer, const NColorRuleHelper::ColorRule &colorRule);
 }
 
 std::vector<NColorRuleHelper::ColorRule> NColorRuleHelper::GetDefaultColorRules()
@@ -169,105 +169,87 @@ namespace
 }
 
 void NColorRuleHelper::LoadColorRulesFromXML(
-	IXMLDOMDocument *pXMLDom, std::vector<NColorRuleHelper::ColorRule> &ColorRules)
+	const XmlSections &sections, std::vector<NColorRuleHelper::ColorRule> &ColorRules)
 {
-	IXMLDOMNode *pNode = nullptr;
-	BSTR bstr = nullptr;
-	HRESULT hr;
+	auto reader = sections.OpenSection(L"ColorRules");
 
-	if (!pXMLDom)
+	if (!reader)
 	{
-		goto clean;
+		return;
 	}
 
-	bstr = SysAllocString(L"//ColorRule");
-	hr = pXMLDom->selectSingleNode(bstr, &pNode);
+	int depth = reader->GetDepth();
+	bool rulesCleared = false;
 
-	if (hr == S_OK)
+	while (reader->ReadChildElement(depth))
 	{
-		ColorRules.clear();
-		LoadColorRulesFromXMLInternal(pNode, ColorRules);
-	}
+		if (reader->GetName() != L"ColorRule")
+		{
+			continue;
+		}
 
-clean:
-	if (bstr)
-	{
-		SysFreeString(bstr);
-	}
-	if (pNode)
-	{
-		pNode->Release();
+		/* The existing rules are only replaced if
+		there's at least one rule in the file. */
+		if (!rulesCleared)
+		{
+			ColorRules.clear();
+			rulesCleared = true;
+		}
+
+		LoadColorRulesFromXMLInternal(*reader, ColorRules);
 	}
 }
 
 namespace
 {
 	void LoadColorRulesFromXMLInternal(
-		IXMLDOMNode *pNode, std::vector<NColorRuleHelper::ColorRule> &ColorRules)
+		const XmlStreamReader &reader, std::vector<NColorRuleHelper::ColorRule> &ColorRules)
 	{
-		IXMLDOMNamedNodeMap *am = nullptr;
-		IXMLDOMNode *pAttributeNode = nullptr;
-		IXMLDOMNode *pNextSibling = nullptr;
 		NColorRuleHelper::ColorRule colorRule;
 		BOOL bDescriptionFound = FALSE;
 		BOOL bFilenamePatternFound = FALSE;
-		BSTR bstrName;
-		BSTR bstrValue;
 		BYTE r = 0;
 		BYTE g = 0;
 		BYTE b = 0;
-		HRESULT hr;
-		long nAttributeNodes;
-
-		hr = pNode->get_attributes(&am);
-
-		if (FAILED(hr))
-		{
-			return;
-		}
-
-		am->get_length(&nAttributeNodes);
 
 		colorRule.caseInsensitive = FALSE;
 
-		for (long i = 0; i < nAttributeNodes; i++)
+		for (size_t i = 0; i < reader.GetNumAttributes(); i++)
 		{
-			am->get_item(i, &pAttributeNode);
+			const WCHAR *name = reader.GetAttributeName(i).c_str();
+			const WCHAR *value = reader.GetAttributeValue(i).c_str();
 
-			pAttributeNode->get_nodeName(&bstrName);
-			pAttributeNode->get_text(&bstrValue);
-
-			if (lstrcmpi(bstrName, L"Name") == 0)
+			if (lstrcmpi(name, L"Name") == 0)
 			{
-				colorRule.strDescription = _bstr_t(bstrValue);
+				colorRule.strDescription = value;
 
 				bDescriptionFound = TRUE;
 			}
-			else if (lstrcmpi(bstrName, L"FilenamePattern") == 0)
+			else if (lstrcmpi(name, L"FilenamePattern") == 0)
 			{
-				colorRule.strFilterPattern = _bstr_t(bstrValue);
+				colorRule.strFilterPattern = value;
 
 				bFilenamePatternFound = TRUE;
 			}
-			else if (lstrcmpi(bstrName, L"CaseInsensitive") == 0)
+			else if (lstrcmpi(name, L"CaseInsensitive") == 0)
 			{
-				colorRule.caseInsensitive = NXMLSettings::DecodeBoolValue(bstrValue);
+				colorRule.caseInsensitive = NXMLSettings::DecodeBoolValue(value);
 			}
-			else if (lstrcmpi(bstrName, L"Attributes") == 0)
+			else if (lstrcmpi(name, L"Attributes") == 0)
 			{
-				colorRule.dwFilterAttributes = NXMLSettings::DecodeIntValue(bstrValue);
+				colorRule.dwFilterAttributes = NXMLSettings::DecodeIntValue(value);
 			}
-			else if (lstrcmpi(bstrName, L"r") == 0)
+			else if (lstrcmpi(name, L"r") == 0)
 			{
-				r = static_cast<BYTE>(NXMLSettings::DecodeIntValue(bstrValue));
+				r = static_cast<BYTE>(NXMLSettings::DecodeIntValue(value));
 			}
-			else if (lstrcmpi(bstrName, L"g") == 0)
+			else if (lstrcmpi(name, L"g") == 0)
 			{
-				g = static_cast<BYTE>(NXMLSettings::DecodeIntValue(bstrValue));
+				g = static_cast<BYTE>(NXMLSettings::DecodeIntValue(value));
 			}
-			else if (lstrcmpi(bstrName, L"b") == 0)
+			else if (lstrcmpi(name, L"b") == 0)
 			{
-				b = static_cast<BYTE>(NXMLSettings::DecodeIntValue(bstrValue));
+				b = static_cast<BYTE>(NXMLSettings::DecodeIntValue(value));
 			}
 		}
 
@@ -277,86 +259,39 @@ namespace
 
 			ColorRules.push_back(colorRule);
 		}
-
-		hr = pNode->get_nextSibling(&pNextSibling);
-
-		if (hr == S_OK)
-		{
-			hr = pNextSibling->get_nextSibling(&pNextSibling);
-
-			if (hr == S_OK)
-			{
-				LoadColorRulesFromXMLInternal(pNextSibling, ColorRules);
-			}
-		}
 	}
 }
 
-void NColorRuleHelper::SaveColorRulesToXML(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pRoot,
-	const std::vector<NColorRuleHelper::ColorRule> &ColorRules)
+void NColorRuleHelper::SaveColorRulesToXML(
+	XmlStreamWriter &writer, const std::vector<NColorRuleHelper::ColorRule> &ColorRules)
 {
-	IXMLDOMElement *pe = nullptr;
-	BSTR bstr_wsnt = SysAllocString(L"\n\t");
-	BSTR bstr;
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom, bstr_wsnt, pRoot);
-
-	bstr = SysAllocString(L"ColorRules");
-	pXMLDom->createElement(bstr, &pe);
-	SysFreeString(bstr);
+	writer.StartElement(L"ColorRules");
 
 	for (const auto &colorRule : ColorRules)
 	{
-		SaveColorRulesToXMLInternal(pXMLDom, pe, colorRule);
+		SaveColorRulesToXMLInternal(writer, colorRule);
 	}
 
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom, bstr_wsnt, pe);
-
-	NXMLSettings::AppendChildToParent(pe, pRoot);
-	pe->Release();
-	pe = nullptr;
-
-	SysFreeString(bstr_wsnt);
+	writer.EndElement();
 }
 
 namespace
 {
 	void SaveColorRulesToXMLInternal(
-		IXMLDOMDocument *pXMLDom, IXMLDOMElement *pe, const NColorRuleHelper::ColorRule &colorRule)
+		XmlStreamWriter &writer, const NColorRuleHelper::ColorRule &colorRule)
 	{
-		IXMLDOMElement *pParentNode = nullptr;
-		BSTR bstr_indent;
-		WCHAR wszIndent[128];
-		static int iIndent = 2;
-
-		StringCchPrintf(wszIndent, SIZEOF_ARRAY(wszIndent), L"\n");
-
-		for (int i = 0; i < iIndent; i++)
-		{
-			StringCchCat(wszIndent, SIZEOF_ARRAY(wszIndent), L"\t");
-		}
-
-		bstr_indent = SysAllocString(wszIndent);
-
-		NXMLSettings::AddWhiteSpaceToNode(pXMLDom, bstr_indent, pe);
-
-		SysFreeString(bstr_indent);
-
-		NXMLSettings::CreateElementNode(
-			pXMLDom, &pParentNode, pe, _T("ColorRule"), colorRule.strDescription.c_str());
-		NXMLSettings::AddAttributeToNode(
-			pXMLDom, pParentNode, _T("FilenamePattern"), colorRule.strFilterPattern.c_str());
-		NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, _T("CaseInsensitive"),
+		NXMLSettings::StartNamedElement(writer, _T("ColorRule"), colorRule.strDescription.c_str());
+		writer.WriteAttribute(_T("FilenamePattern"), colorRule.strFilterPattern);
+		writer.WriteAttribute(_T("CaseInsensitive"),
 			NXMLSettings::EncodeBoolValue(colorRule.caseInsensitive));
-		NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, _T("Attributes"),
+		writer.WriteAttribute(_T("Attributes"),
 			NXMLSettings::EncodeIntValue(colorRule.dwFilterAttributes));
-		NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, _T("r"),
+		writer.WriteAttribute(_T("r"),
 			NXMLSettings::EncodeIntValue(GetRValue(colorRule.rgbColour)));
-		NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, _T("g"),
+		writer.WriteAttribute(_T("g"),
 			NXMLSettings::EncodeIntValue(GetGValue(colorRule.rgbColour)));
-		NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, _T("b"),
+		writer.WriteAttribute(_T("b"),
 			NXMLSettings::EncodeIntValue(GetBValue(colorRule.rgbColour)));
-
-		pParentNode->Release();
+		writer.EndElement();
 	}
 }
\ No newline at end of file
@@ -4,9 +4,11 @@
 
 #pragma once
 
-#include <MsXml2.h>
 #include <objbase.h>
 
+class XmlSections;
+class XmlStreamWriter;
+
 namespace NColorRuleHelper
 {
 	struct ColorRule
@@ -26,7 +28,6 @@ namespace NColorRuleHelper
 	void LoadColorRulesFromRegistry(std::vector<ColorRule> &ColorRules);
 	void SaveColorRulesToRegistry(const std::vector<ColorRule> &ColorRules);
 
-	void LoadColorRulesFromXML(IXMLDOMDocument *pXMLDom, std::vector<ColorRule> &ColorRules);
-	void SaveColorRulesToXML(
-		IXMLDOMDocument *pXMLDom, IXMLDOMElement *pRoot, const std::vector<ColorRule> &ColorRules);
+	void LoadColorRulesFromXML(const XmlSections &sections, std::vector<ColorRule> &ColorRules);
+	void SaveColorRulesToXML(XmlStreamWriter &writer, const std::vector<ColorRule> &ColorRules);
 }
\ No newline at end of file
@@ -5,8 +5,10 @@
 #include "stdafx.h"
 #include "CommandLine.h"
 #include "Explorer++_internal.h"
+#include "Logging.h"
 #include "MainResource.h"
 #include "ResourceHelper.h"
+#include "Tracing.h"
 #include "../Helper/Macros.h"
 #include "../Helper/ProcessHelper.h"
 #include "../Helper/SetDefaultFileManager.h"
@@ -15,7 +17,6 @@
 #include "../ThirdParty/CLI11/CLI11.hpp"
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
-#include <boost/log/core.hpp>
 #include <iostream>
 #include <map>
 
@@ -29,6 +30,7 @@ struct CommandLineSettings
 	bool clearRegistrySettings;
 	bool enableLogging;
 	bool enablePlugins;
+	bool enableTracing;
 	bool removeAsDefault;
 	ReplaceExplorerMode replaceExplorerMode;
 	std::string language;
@@ -79,6 +81,13 @@ std::optional<CommandLine::ExitInfo> CommandLine::ProcessCommandLine()
 		"Enable the Lua plugin system"
 	);
 
+	commandLineSettings.enableTracing = false;
+	app.add_flag(
+		"--enable-tracing",
+		commandLineSettings.enableTracing,
+		"Record trace events and write them to Explorer++Trace.json on exit"
+	);
+
 	commandLineSettings.removeAsDefault = false;
 	auto removeAsDefaultOption = app.add_flag(
 		"--remove-as-default",
@@ -195,7 +204,7 @@ std::optional<CommandLine::ExitInfo> ProcessCommandLineSettings(const CommandLin
 
 	if (commandLineSettings.enableLogging)
 	{
-		boost::log::core::get()->set_logging_enabled(true);
+		SetLoggingEnabled(true);
 	}
 
 	if (commandLineSettings.enablePlugins)
@@ -203,6 +212,11 @@ std::optional<CommandLine::ExitInfo> ProcessCommandLineSettings(const CommandLin
 		g_enablePlugins = true;
 	}
 
+	if (commandLineSettings.enableTracing)
+	{
+		SetTracingEnabled(true);
+	}
+
 	if (commandLineSettings.removeAsDefault)
 	{
 		OnUpdateReplaceExplorerSetting(ReplaceExplorerMode::None);
@@ -9,6 +9,7 @@
 #include "ShellBrowser/FolderSettings.h"
 #include "ShellBrowser/ViewModes.h"
 #include "ValueWrapper.h"
+#include "VersionedSnapshot.h"
 #include "../Helper/Macros.h"
 #include "../Helper/SetDefaultFileManager.h"
 #include "../Helper/ShellHelper.h"
@@ -66,6 +67,14 @@ struct Config
 		playNavigationSound = TRUE;
 		confirmCloseTabs = FALSE;
 		synchronizeTreeview = TRUE;
+		prefetchFolders = FALSE;
+		persistIconCache = FALSE;
+		enableTracing = FALSE;
+		thumbnailCacheSize = DEFAULT_THUMBNAIL_CACHE_SIZE;
+		thumbnailDiskCacheSize = DEFAULT_THUMBNAIL_DISK_CACHE_SIZE;
+		thumbnailSize = DEFAULT_THUMBNAIL_SIZE;
+		tabHibernationIdleTimeout = 0;
+		tabHibernationMemoryBudget = 0;
 		displayWindowWidth = DEFAULT_DISPLAYWINDOW_WIDTH;
 		displayWindowHeight = DEFAULT_DISPLAYWINDOW_HEIGHT;
 		displayWindowVertical = FALSE;
@@ -119,6 +128,7 @@ struct Config
 		globalFolderSettings.folderColumns.myNetworkPlacesColumns =
 			std::vector<Column_t>(std::begin(MY_NETWORK_PLACES_DEFAULT_COLUMNS),
 				std::end(MY_NETWORK_PLACES_DEFAULT_COLUMNS));
+		globalFolderSettingsSnapshot.publish(globalFolderSettings);
 
 		defaultFolderSettings.sortMode = SortMode::Name;
 		defaultFolderSettings.viewMode = ViewMode::Icons;
@@ -135,6 +145,10 @@ struct Config
 
 	static const UINT DEFAULT_TREEVIEW_WIDTH = 208;
 
+	static const UINT DEFAULT_THUMBNAIL_CACHE_SIZE = 64;
+	static const UINT DEFAULT_THUMBNAIL_DISK_CACHE_SIZE = 256;
+	static const UINT DEFAULT_THUMBNAIL_SIZE = 120;
+
 	DWORD language;
 	IconTheme iconTheme;
 	StartupMode startupMode;
@@ -168,6 +182,45 @@ struct Config
 	BOOL playNavigationSound;
 	BOOL confirmCloseTabs;
 	BOOL synchronizeTreeview;
+
+	// If enabled, folders that are likely to be navigated to next (e.g. a
+	// folder that's being hovered over) will be enumerated in the background.
+	BOOL prefetchFolders;
+
+	// If enabled, the location of each cached icon will be saved on exit, so
+	// that icons can be shown immediately in the next session.
+	BOOL persistIconCache;
+
+	// If enabled, trace events (e.g. the time taken by each part of a
+	// navigation) are recorded and written out on exit. Tracing can also be
+	// enabled with the --enable-tracing command line option.
+	BOOL enableTracing;
+
+	// The maximum amount of memory (in MB) used by the thumbnails shown in
+	// each tab. Once this is reached, thumbnails that aren't visible are
+	// discarded and regenerated if they're scrolled back into view.
+	unsigned int thumbnailCacheSize;
+
+	// The maximum size (in MB) of the file that extracted thumbnails are
+	// saved to, so that they don't have to be extracted again the next time
+	// a folder is shown. A value of 0 disables the cache.
+	unsigned int thumbnailDiskCacheSize;
+
+	// The width and height (in pixels) of the area each thumbnail is shown
+	// in. This can be changed by holding ctrl and scrolling while in
+	// thumbnails view.
+	unsigned int thumbnailSize;
+
+	// Background tabs that haven't been used for this many minutes will be
+	// hibernated (i.e. unloaded until they're next selected). A value of 0
+	// disables this.
+	unsigned int tabHibernationIdleTimeout;
+
+	// If the loaded tabs are using more than this amount of memory (in MB),
+	// the least recently used background tabs will be hibernated. A value of
+	// 0 disables this.
+	unsigned int tabHibernationMemoryBudget;
+
 	LONG displayWindowWidth;
 	LONG displayWindowHeight;
 	BOOL displayWindowVertical;
@@ -197,6 +250,12 @@ struct Config
 	// possible to adjust them on a per-tab basis.
 	GlobalFolderSettings globalFolderSettings;
 
+	// An immutable copy of globalFolderSettings that can be handed to
+	// background tasks without copying the settings (which includes the
+	// column vectors) each time. This needs to be republished whenever
+	// globalFolderSettings is changed.
+	VersionedSnapshot<GlobalFolderSettings> globalFolderSettingsSnapshot;
+
 	FolderSettings defaultFolderSettings;
 
 private:
@@ -21,13 +21,23 @@ enum class MousewheelSource
 
 class CachedIcons;
 struct Config;
+class FolderListingCache;
+class FolderPrefetcher;
+class IconResolutionService;
 class IconResourceLoader;
 __interface IDirectoryMonitor;
+class MemoryAccountant;
 class ShellBrowser;
 class StatusBar;
+class ThumbnailDiskCache;
 class TabContainer;
 class TabRestorer;
 
+namespace ctpl
+{
+class thread_pool;
+}
+
 /* Basic interface between Explorerplusplus
 and some of the other components (such as the
 dialogs and toolbars). */
@@ -47,6 +57,18 @@ __interface IExplorerplusplus
 
 	IconResourceLoader *GetIconResourceLoader() const;
 	CachedIcons *GetCachedIcons();
+	FolderListingCache *GetFolderListingCache();
+	FolderPrefetcher *GetFolderPrefetcher();
+	IconResolutionService *GetIconResolutionService();
+
+	// A pool shared between all tabs, used to determine item groups in
+	// parallel.
+	ctpl::thread_pool *GetGroupingThreadPool();
+
+	// Returns null if the thumbnail disk cache has been disabled.
+	ThumbnailDiskCache *GetThumbnailDiskCache();
+
+	MemoryAccountant *GetMemoryAccountant();
 
 	HWND GetTreeView() const;
 
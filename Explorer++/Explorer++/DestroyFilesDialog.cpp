@@ -12,6 +12,7 @@
 #include "../Helper/RegistrySettings.h"
 #include "../Helper/StringHelper.h"
 #include "../Helper/XMLSettings.h"
+#include "../Helper/XmlStream.h"
 
 const TCHAR DestroyFilesDialogPersistentSettings::SETTINGS_KEY[] = _T("DestroyFiles");
 
@@ -310,18 +311,18 @@ void DestroyFilesDialogPersistentSettings::LoadExtraRegistrySettings(HKEY hKey)
 		hKey, SETTING_OVERWRITE_METHOD, reinterpret_cast<LPDWORD>(&m_overwriteMethod));
 }
 
-void DestroyFilesDialogPersistentSettings::SaveExtraXMLSettings(
-	IXMLDOMDocument *pXMLDom, IXMLDOMElement *pParentNode)
+void DestroyFilesDialogPersistentSettings::SaveExtraXMLSettings(XmlStreamWriter &writer)
 {
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_OVERWRITE_METHOD,
+	writer.WriteAttribute(SETTING_OVERWRITE_METHOD,
 		NXMLSettings::EncodeIntValue(static_cast<int>(m_overwriteMethod)));
 }
 
-void DestroyFilesDialogPersistentSettings::LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue)
+void DestroyFilesDialogPersistentSettings::LoadExtraXMLSettings(
+	const WCHAR *wszName, const WCHAR *wszValue)
 {
-	if (lstrcmpi(bstrName, SETTING_OVERWRITE_METHOD) == 0)
+	if (lstrcmpi(wszName, SETTING_OVERWRITE_METHOD) == 0)
 	{
 		m_overwriteMethod = static_cast<NFileOperations::OverwriteMethod>(
-			NXMLSettings::DecodeIntValue(bstrValue));
+			NXMLSettings::DecodeIntValue(wszValue));
 	}
 }
\ No newline at end of file
@@ -21,7 +21,7 @@
 #include "SplitFileDialog.h"
 #include "UpdateCheckDialog.h"
 #include "WildcardSelectDialog.h"
-#include "../Helper/XMLSettings.h"
+#include "../Helper/XmlStream.h"
 
 namespace
 {
@@ -84,124 +84,55 @@ void Explorerplusplus::SaveDialogStatesToRegistry()
 	}
 }
 
-void Explorerplusplus::LoadDialogStatesFromXML(IXMLDOMDocument *pXMLDom)
+void Explorerplusplus::LoadDialogStatesFromXML(const XmlSections &sections)
 {
-	IXMLDOMNodeList *pNodes = nullptr;
-	IXMLDOMNode *pNode = nullptr;
-	IXMLDOMNamedNodeMap *am = nullptr;
-	IXMLDOMNode *pChildNode = nullptr;
-	BSTR bstrName;
-	BSTR bstrValue;
-	BSTR bstr = nullptr;
-	HRESULT hr;
-	long length;
-	long lChildNodes;
-
-	if (pXMLDom == nullptr)
+	auto reader = sections.OpenSection(DIALOGS_XML_KEY);
+
+	if (!reader)
 	{
-		goto clean;
+		return;
 	}
 
-	TCHAR tempNodeSelector[64];
-	StringCchPrintf(
-		tempNodeSelector, SIZEOF_ARRAY(tempNodeSelector), _T("//%s/*"), DIALOGS_XML_KEY);
-	bstr = SysAllocString(tempNodeSelector);
-	pXMLDom->selectNodes(bstr, &pNodes);
+	int depth = reader->GetDepth();
 
-	if (!pNodes)
-	{
-		goto clean;
-	}
-	else
+	while (reader->ReadChildElement(depth))
 	{
-		pNodes->get_length(&length);
+		auto name = reader->FindAttribute(L"name");
+
+		if (!name)
+		{
+			continue;
+		}
+
+		std::wstring dialogName(*name);
 
-		for (long i = 0; i < length; i++)
+		for (DialogSettings *ds : DIALOG_SETTINGS)
 		{
-			/* This should never fail, as the number
-			of nodes has already been counted (so
-			they must exist). */
-			hr = pNodes->get_item(i, &pNode);
+			TCHAR settingsKey[64];
+			bool success = ds->GetSettingsKey(settingsKey, SIZEOF_ARRAY(settingsKey));
+			assert(success);
 
-			if (SUCCEEDED(hr))
+			if (!success)
 			{
-				hr = pNode->get_attributes(&am);
-
-				if (SUCCEEDED(hr))
-				{
-					/* Retrieve the total number of attributes
-					attached to this node. */
-					am->get_length(&lChildNodes);
-
-					if (lChildNodes >= 1)
-					{
-						am->get_item(0, &pChildNode);
-
-						pChildNode->get_nodeName(&bstrName);
-						pChildNode->get_text(&bstrValue);
-
-						for (DialogSettings *ds : DIALOG_SETTINGS)
-						{
-							TCHAR settingsKey[64];
-							bool success =
-								ds->GetSettingsKey(settingsKey, SIZEOF_ARRAY(settingsKey));
-							assert(success);
-
-							if (!success)
-							{
-								continue;
-							}
-
-							if (lstrcmpi(bstrValue, settingsKey) == 0)
-							{
-								ds->LoadXMLSettings(am, lChildNodes);
-							}
-						}
-					}
-				}
+				continue;
 			}
 
-			pNode->Release();
-			pNode = nullptr;
+			if (lstrcmpi(dialogName.c_str(), settingsKey) == 0)
+			{
+				ds->LoadXMLSettings(*reader);
+			}
 		}
 	}
-
-clean:
-	if (bstr)
-	{
-		SysFreeString(bstr);
-	}
-	if (pNodes)
-	{
-		pNodes->Release();
-	}
-	if (pNode)
-	{
-		pNode->Release();
-	}
 }
 
-void Explorerplusplus::SaveDialogStatesToXML(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pRoot)
+void Explorerplusplus::SaveDialogStatesToXML(XmlStreamWriter &writer)
 {
-	IXMLDOMElement *pe = nullptr;
-	BSTR bstr = nullptr;
-	BSTR bstr_wsnt = SysAllocString(L"\n\t");
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom, bstr_wsnt, pRoot);
-
-	bstr = SysAllocString(DIALOGS_XML_KEY);
-	pXMLDom->createElement(bstr, &pe);
-	SysFreeString(bstr);
-	bstr = nullptr;
+	writer.StartElement(DIALOGS_XML_KEY);
 
 	for (DialogSettings *ds : DIALOG_SETTINGS)
 	{
-		ds->SaveXMLSettings(pXMLDom, pe);
+		ds->SaveXMLSettings(writer);
 	}
 
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom, bstr_wsnt, pe);
-
-	NXMLSettings::AppendChildToParent(pe, pRoot);
-	pe->Release();
-	pe = nullptr;
+	writer.EndElement();
 }
\ No newline at end of file
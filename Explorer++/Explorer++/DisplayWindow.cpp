@@ -16,6 +16,11 @@ void Explorerplusplus::UpdateDisplayWindow(const Tab &tab)
 {
 	DisplayWindow_ClearTextBuffer(m_hDisplayWindow);
 
+	// Any image properties that are still being read are for the previous
+	// selection and will be ignored.
+	m_displayWindowThreadPool.clear_queue();
+	m_imagePropertiesResults.clear();
+
 	int nSelected = tab.GetShellBrowser()->GetNumSelected();
 
 	if (nSelected == 0)
@@ -202,109 +207,7 @@ void Explorerplusplus::UpdateDisplayWindowForOneFile(const Tab &tab)
 
 			if (IsImage(szFullItemName))
 			{
-				TCHAR szOutput[256];
-				TCHAR szTemp[64];
-				UINT uWidth;
-				UINT uHeight;
-				Gdiplus::Image *pimg = nullptr;
-
-				pimg = new Gdiplus::Image(szFullItemName, FALSE);
-
-				if (pimg->GetLastStatus() == Gdiplus::Ok)
-				{
-					uWidth = pimg->GetWidth();
-					LoadString(m_hLanguageModule, IDS_GENERAL_DISPLAYWINDOW_IMAGEWIDTH, szTemp,
-						SIZEOF_ARRAY(szTemp));
-					StringCchPrintf(szOutput, SIZEOF_ARRAY(szOutput), szTemp, uWidth);
-					DisplayWindow_BufferText(m_hDisplayWindow, szOutput);
-
-					uHeight = pimg->GetHeight();
-					LoadString(m_hLanguageModule, IDS_GENERAL_DISPLAYWINDOW_IMAGEHEIGHT, szTemp,
-						SIZEOF_ARRAY(szTemp));
-					StringCchPrintf(szOutput, SIZEOF_ARRAY(szOutput), szTemp, uHeight);
-					DisplayWindow_BufferText(m_hDisplayWindow, szOutput);
-
-					Gdiplus::PixelFormat format;
-					UINT uBitDepth;
-
-					format = pimg->GetPixelFormat();
-
-					switch (format)
-					{
-					case PixelFormat1bppIndexed:
-						uBitDepth = 1;
-						break;
-
-					case PixelFormat4bppIndexed:
-						uBitDepth = 4;
-						break;
-
-					case PixelFormat8bppIndexed:
-						uBitDepth = 8;
-						break;
-
-					case PixelFormat16bppARGB1555:
-					case PixelFormat16bppGrayScale:
-					case PixelFormat16bppRGB555:
-					case PixelFormat16bppRGB565:
-						uBitDepth = 16;
-						break;
-
-					case PixelFormat24bppRGB:
-						uBitDepth = 24;
-						break;
-
-					case PixelFormat32bppARGB:
-					case PixelFormat32bppPARGB:
-					case PixelFormat32bppRGB:
-						uBitDepth = 32;
-						break;
-
-					case PixelFormat48bppRGB:
-						uBitDepth = 48;
-						break;
-
-					case PixelFormat64bppARGB:
-					case PixelFormat64bppPARGB:
-						uBitDepth = 64;
-						break;
-
-					default:
-						uBitDepth = 0;
-						break;
-					}
-
-					if (uBitDepth == 0)
-					{
-						LoadString(m_hLanguageModule, IDS_GENERAL_DISPLAYWINDOW_BITDEPTHUNKNOWN,
-							szTemp, SIZEOF_ARRAY(szTemp));
-						StringCchCopy(szOutput, SIZEOF_ARRAY(szOutput), szTemp);
-					}
-					else
-					{
-						LoadString(m_hLanguageModule, IDS_GENERAL_DISPLAYWINDOW_BITDEPTH, szTemp,
-							SIZEOF_ARRAY(szTemp));
-						StringCchPrintf(szOutput, SIZEOF_ARRAY(szOutput), szTemp, uBitDepth);
-					}
-
-					DisplayWindow_BufferText(m_hDisplayWindow, szOutput);
-
-					Gdiplus::REAL res;
-
-					res = pimg->GetHorizontalResolution();
-					LoadString(m_hLanguageModule, IDS_GENERAL_DISPLAYWINDOW_HORIZONTALRESOLUTION,
-						szTemp, SIZEOF_ARRAY(szTemp));
-					StringCchPrintf(szOutput, SIZEOF_ARRAY(szOutput), szTemp, res);
-					DisplayWindow_BufferText(m_hDisplayWindow, szOutput);
-
-					res = pimg->GetVerticalResolution();
-					LoadString(m_hLanguageModule, IDS_GENERAL_DISPLAYWINDOW_VERTICALRESOLUTION,
-						szTemp, SIZEOF_ARRAY(szTemp));
-					StringCchPrintf(szOutput, SIZEOF_ARRAY(szOutput), szTemp, res);
-					DisplayWindow_BufferText(m_hDisplayWindow, szOutput);
-				}
-
-				delete pimg;
+				QueueImagePropertiesTask(szFullItemName);
 			}
 
 			/* Only attempt to show file previews for files (not folders). Also, only
@@ -313,6 +216,7 @@ void Explorerplusplus::UpdateDisplayWindowForOneFile(const Tab &tab)
 				&& m_config->showFilePreviews && m_config->showDisplayWindow)
 			{
 				DisplayWindow_SetThumbnailFile(m_hDisplayWindow, szFullItemName, TRUE);
+				PrefetchDisplayWindowPreviews(tab, iSelected);
 			}
 			else
 			{
@@ -401,4 +305,164 @@ void Explorerplusplus::UpdateDisplayWindowForMultipleFiles(const Tab &tab)
 	}
 
 	DisplayWindow_BufferText(m_hDisplayWindow, szTotalSize);
+}
+
+void Explorerplusplus::QueueImagePropertiesTask(const std::wstring &filePath)
+{
+	int resultId = m_imagePropertiesResultIdCounter++;
+
+	auto result =
+		m_displayWindowThreadPool.push([hwnd = m_hContainer, resultId, filePath](int id) {
+			UNREFERENCED_PARAMETER(id);
+
+			return ReadImagePropertiesAsync(hwnd, resultId, filePath);
+		});
+
+	m_imagePropertiesResults.insert({ resultId, std::move(result) });
+}
+
+std::optional<Explorerplusplus::DWImageProperties> Explorerplusplus::ReadImagePropertiesAsync(
+	HWND hwnd, int resultId, const std::wstring &filePath)
+{
+	std::optional<DWImageProperties> imageProperties;
+
+	// The image data itself isn't decoded here; only the header is read.
+	Gdiplus::Image image(filePath.c_str(), FALSE);
+
+	if (image.GetLastStatus() == Gdiplus::Ok)
+	{
+		imageProperties = DWImageProperties();
+		imageProperties->width = image.GetWidth();
+		imageProperties->height = image.GetHeight();
+		imageProperties->bitDepth = GetBitDepth(image.GetPixelFormat());
+		imageProperties->horizontalResolution = image.GetHorizontalResolution();
+		imageProperties->verticalResolution = image.GetVerticalResolution();
+	}
+
+	PostMessage(hwnd, WM_APP_IMAGEPROPERTIESREADY, resultId, 0);
+
+	return imageProperties;
+}
+
+UINT Explorerplusplus::GetBitDepth(Gdiplus::PixelFormat format)
+{
+	switch (format)
+	{
+	case PixelFormat1bppIndexed:
+		return 1;
+
+	case PixelFormat4bppIndexed:
+		return 4;
+
+	case PixelFormat8bppIndexed:
+		return 8;
+
+	case PixelFormat16bppARGB1555:
+	case PixelFormat16bppGrayScale:
+	case PixelFormat16bppRGB555:
+	case PixelFormat16bppRGB565:
+		return 16;
+
+	case PixelFormat24bppRGB:
+		return 24;
+
+	case PixelFormat32bppARGB:
+	case PixelFormat32bppPARGB:
+	case PixelFormat32bppRGB:
+		return 32;
+
+	case PixelFormat48bppRGB:
+		return 48;
+
+	case PixelFormat64bppARGB:
+	case PixelFormat64bppPARGB:
+		return 64;
+	}
+
+	return 0;
+}
+
+void Explorerplusplus::OnImagePropertiesReady(int resultId)
+{
+	auto itr = m_imagePropertiesResults.find(resultId);
+
+	if (itr == m_imagePropertiesResults.end())
+	{
+		return;
+	}
+
+	auto imageProperties = itr->second.get();
+	m_imagePropertiesResults.erase(itr);
+
+	if (!imageProperties)
+	{
+		return;
+	}
+
+	TCHAR szOutput[256];
+	TCHAR szTemp[64];
+
+	LoadString(
+		m_hLanguageModule, IDS_GENERAL_DISPLAYWINDOW_IMAGEWIDTH, szTemp, SIZEOF_ARRAY(szTemp));
+	StringCchPrintf(szOutput, SIZEOF_ARRAY(szOutput), szTemp, imageProperties->width);
+	DisplayWindow_BufferText(m_hDisplayWindow, szOutput);
+
+	LoadString(
+		m_hLanguageModule, IDS_GENERAL_DISPLAYWINDOW_IMAGEHEIGHT, szTemp, SIZEOF_ARRAY(szTemp));
+	StringCchPrintf(szOutput, SIZEOF_ARRAY(szOutput), szTemp, imageProperties->height);
+	DisplayWindow_BufferText(m_hDisplayWindow, szOutput);
+
+	if (imageProperties->bitDepth == 0)
+	{
+		LoadString(m_hLanguageModule, IDS_GENERAL_DISPLAYWINDOW_BITDEPTHUNKNOWN, szTemp,
+			SIZEOF_ARRAY(szTemp));
+		StringCchCopy(szOutput, SIZEOF_ARRAY(szOutput), szTemp);
+	}
+	else
+	{
+		LoadString(
+			m_hLanguageModule, IDS_GENERAL_DISPLAYWINDOW_BITDEPTH, szTemp, SIZEOF_ARRAY(szTemp));
+		StringCchPrintf(szOutput, SIZEOF_ARRAY(szOutput), szTemp, imageProperties->bitDepth);
+	}
+
+	DisplayWindow_BufferText(m_hDisplayWindow, szOutput);
+
+	LoadString(m_hLanguageModule, IDS_GENERAL_DISPLAYWINDOW_HORIZONTALRESOLUTION, szTemp,
+		SIZEOF_ARRAY(szTemp));
+	StringCchPrintf(
+		szOutput, SIZEOF_ARRAY(szOutput), szTemp, imageProperties->horizontalResolution);
+	DisplayWindow_BufferText(m_hDisplayWindow, szOutput);
+
+	LoadString(m_hLanguageModule, IDS_GENERAL_DISPLAYWINDOW_VERTICALRESOLUTION, szTemp,
+		SIZEOF_ARRAY(szTemp));
+	StringCchPrintf(szOutput, SIZEOF_ARRAY(szOutput), szTemp, imageProperties->verticalResolution);
+	DisplayWindow_BufferText(m_hDisplayWindow, szOutput);
+}
+
+// Previews for the images on either side of the selected item (in the
+// current sort order) are decoded ahead of time, so that moving the selection
+// with the arrow keys doesn't have to wait for each preview in turn.
+void Explorerplusplus::PrefetchDisplayWindowPreviews(const Tab &tab, int selectedItem)
+{
+	int numItems = ListView_GetItemCount(m_hActiveListView);
+
+	for (int distance = 1; distance <= DISPLAY_WINDOW_PREFETCH_DISTANCE; distance++)
+	{
+		for (int item : { selectedItem + distance, selectedItem - distance })
+		{
+			if (item < 0 || item >= numItems)
+			{
+				continue;
+			}
+
+			TCHAR szFullItemName[MAX_PATH];
+			tab.GetShellBrowser()->GetItemFullName(
+				item, szFullItemName, SIZEOF_ARRAY(szFullItemName));
+
+			if (IsImage(szFullItemName))
+			{
+				DisplayWindow_PrefetchThumbnailFile(m_hDisplayWindow, szFullItemName);
+			}
+		}
+	}
 }
\ No newline at end of file
@@ -78,7 +78,15 @@ DisplayWindow::DisplayWindow(HWND hDisplayWindow, DWInitialSettings_t *pInitialS
 	m_SurroundColor(pInitialSettings->SurroundColor),
 	m_hMainIcon(pInitialSettings->hIcon),
 	m_hDisplayFont(pInitialSettings->hFont),
-	m_bVertical(FALSE)
+	m_bVertical(FALSE),
+	m_previewCache(PREVIEW_CACHE_SIZE),
+	m_previewResultIdCounter(0),
+	m_previewThreadPool(1,
+		[] {
+			CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+			SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+		},
+		CoUninitialize)
 {
 	g_ObjectCount++;
 
@@ -86,18 +94,16 @@ DisplayWindow::DisplayWindow(HWND hDisplayWindow, DWInitialSettings_t *pInitialS
 	m_LeftIndent = 80;
 
 	m_bSizing = FALSE;
-	m_hbmThumbnail = nullptr;
 	m_bShowThumbnail = FALSE;
-	m_bThumbnailExtracted = FALSE;
-	m_bThumbnailExtractionFailed = FALSE;
 	m_hBitmapBackground = nullptr;
-
-	InitializeCriticalSection(&m_csDWThumbnails);
 }
 
 DisplayWindow::~DisplayWindow()
 {
-	DeleteCriticalSection(&m_csDWThumbnails);
+	// Nothing is waiting for the results of the remaining tasks, so there's
+	// no point running them.
+	CancelPreviewTasks(nullptr);
+	m_previewThreadPool.clear_queue();
 
 	DeleteDC(m_hdcBackground);
 	DeleteObject(m_hBitmapBackground);
@@ -239,6 +245,14 @@ LRESULT CALLBACK DisplayWindow::DisplayWindowProc(
 		RedrawWindow(displayWindow, nullptr, nullptr, RDW_INVALIDATE);
 		break;
 
+	case DWM_PREFETCHTHUMBNAILFILE:
+		OnPrefetchThumbnailFile(reinterpret_cast<const TCHAR *>(wParam));
+		break;
+
+	case WM_APP_PREVIEW_READY:
+		OnPreviewReady(static_cast<int>(wParam));
+		break;
+
 	case DWM_GETCENTRECOLOR:
 		return m_CentreColor.ToCOLORREF();
 
@@ -307,6 +321,10 @@ LRESULT CALLBACK DisplayWindow::DisplayWindowProc(
 		OnSize(LOWORD(lParam), HIWORD(lParam));
 		break;
 
+	case WM_TIMER:
+		OnTimer(static_cast<UINT_PTR>(wParam));
+		break;
+
 	case WM_USER_DISPLAYWINDOWMOVED:
 		m_bVertical = (BOOL) wParam;
 		InvalidateRect(m_hDisplayWindow, nullptr, TRUE);
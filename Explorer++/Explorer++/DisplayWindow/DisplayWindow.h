@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include "../Helper/LruCache.h"
+#include "../ThirdParty/CTPL/cpl_stl.h"
+#include <wil/resource.h>
+
 #pragma warning(push)
 #pragma warning(disable : 4458)
 #include <gdiplus.h>
@@ -11,6 +15,12 @@
 
 #pragma warning(push)
 #pragma warning(disable : 4995)
+#include <atomic>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #pragma warning(pop)
 
@@ -29,10 +39,18 @@
 #define DWM_BUFFERTEXT (DWM_BASE + 15)
 #define DWM_CLEARTEXTBUFFER (DWM_BASE + 16)
 #define DWM_SETLINE (DWM_BASE + 17)
+#define DWM_PREFETCHTHUMBNAILFILE (DWM_BASE + 18)
 
 #define DisplayWindow_SetThumbnailFile(hDisplay, FileName, bShowImage)                             \
 	SendMessage(hDisplay, DWM_SETTHUMBNAILFILE, (WPARAM) FileName, (LPARAM) bShowImage)
 
+/* Decodes the preview for a file in the background, so that
+it can be shown immediately if the file is selected. Should be
+sent after DWM_SETTHUMBNAILFILE, since that cancels any
+prefetches that are still pending. */
+#define DisplayWindow_PrefetchThumbnailFile(hDisplay, FileName)                                    \
+	SendMessage(hDisplay, DWM_PREFETCHTHUMBNAILFILE, (WPARAM) FileName, 0)
+
 #define DisplayWindow_GetSurroundColor(hDisplay) SendMessage(hDisplay, DWM_GETSURROUNDCOLOR, 0, 0)
 
 #define DisplayWindow_SetColors(hDisplay, rgbColor)                                                \
@@ -77,12 +95,6 @@ typedef struct
 	TCHAR szText[512];
 } LineData_t;
 
-typedef struct
-{
-	void *pdw;
-	BOOL bCancelled;
-} ThumbnailEntry_t;
-
 static int g_ObjectCount = 0;
 
 class DisplayWindow
@@ -94,11 +106,56 @@ public:
 	static LRESULT CALLBACK DisplayWindowProcStub(
 		HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
-	void ExtractThumbnailImageInternal(ThumbnailEntry_t *pte);
-
 private:
 #define BORDER_COLOUR Gdiplus::Color(128, 128, 128)
 
+	static const UINT WM_APP_PREVIEW_READY = WM_APP + 150;
+
+	// While the window is being resized, the current preview is scaled to fit
+	// and the preview is only decoded again once the size has stopped
+	// changing for this long.
+	static const UINT_PTR RESIZE_PREVIEW_TIMER_ID = 1;
+	static const UINT RESIZE_PREVIEW_TIMEOUT = 250;
+
+	// The number of decoded previews that are retained. This includes
+	// previews that have been prefetched.
+	static const size_t PREVIEW_CACHE_SIZE = 8;
+
+	struct Preview
+	{
+		wil::unique_hbitmap bitmap;
+		int width;
+		int height;
+	};
+
+	// Previews are decoded at the height of the display window, so a preview
+	// can only be reused while the window remains the same height.
+	struct PreviewKey
+	{
+		std::wstring filePath;
+		int height;
+
+		bool operator==(const PreviewKey &other) const
+		{
+			return filePath == other.filePath && height == other.height;
+		}
+	};
+
+	struct PreviewKeyHash
+	{
+		size_t operator()(const PreviewKey &key) const
+		{
+			return std::hash<std::wstring>()(key.filePath) ^ (std::hash<int>()(key.height) << 1);
+		}
+	};
+
+	struct PendingPreview
+	{
+		PreviewKey key;
+		std::shared_ptr<std::atomic<bool>> cancelled;
+		std::future<std::shared_ptr<Preview>> result;
+	};
+
 	LRESULT CALLBACK DisplayWindowProc(HWND displayWindow, UINT msg, WPARAM wParam, LPARAM lParam);
 
 	LONG OnMouseMove(LPARAM lParam);
@@ -115,9 +172,19 @@ private:
 	void PatchBackground(HDC hdc, RECT *rc, RECT *updateRect);
 
 	void OnSize(int width, int height);
-
-	void ExtractThumbnailImage();
-	void CancelThumbnailExtraction();
+	void OnTimer(UINT_PTR timerId);
+
+	void OnPrefetchThumbnailFile(const TCHAR *filePath);
+	std::optional<PreviewKey> GetPreviewKey(const std::wstring &filePath) const;
+	void RequestPreview();
+	void UpdateImageSize();
+	void QueuePreviewTask(const PreviewKey &key);
+	static std::shared_ptr<Preview> DecodePreviewAsync(HWND hwnd, int resultId,
+		const PreviewKey &key, const std::atomic<bool> &cancelled);
+	static std::shared_ptr<Preview> DecodePreview(
+		const PreviewKey &key, const std::atomic<bool> &cancelled);
+	void OnPreviewReady(int resultId);
+	void CancelPreviewTasks(const PreviewKey *keyToKeep);
 
 	HWND m_hDisplayWindow;
 
@@ -138,11 +205,11 @@ private:
 	BOOL m_bVertical;
 
 	/* Thumbnails. */
-	CRITICAL_SECTION m_csDWThumbnails;
-	HBITMAP m_hbmThumbnail;
 	BOOL m_bShowThumbnail;
-	BOOL m_bThumbnailExtracted;
-	BOOL m_bThumbnailExtractionFailed;
+	std::shared_ptr<Preview> m_preview;
+	LruCache<PreviewKey, std::shared_ptr<Preview>, PreviewKeyHash> m_previewCache;
+	std::unordered_map<int, PendingPreview> m_pendingPreviews;
+	int m_previewResultIdCounter;
 
 	int m_xColumnFinal;
 
@@ -150,6 +217,10 @@ private:
 	HBITMAP m_hBitmapBackground;
 	HICON m_hMainIcon;
 	HFONT m_hDisplayFont;
+
+	// Declared last, so that any running task finishes before the rest of the
+	// object is destroyed.
+	ctpl::thread_pool m_previewThreadPool;
 };
 
 HWND CreateDisplayWindow(HWND parent, DWInitialSettings_t *pSettings);
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include "../Helper/Macros.h"
 #include "../Helper/ShellHelper.h"
 #include "../Helper/WindowHelper.h"
+#include <wil/com.h>
 
 /* Defines how close the text can get to the bottom
 of the display window before it is moved into the
@@ -34,8 +35,6 @@ can float. */
 at the top and bottom of the thumbnail. */
 #define THUMB_HEIGHT_DELTA 20
 
-std::list<ThumbnailEntry_t> g_ThumbnailEntries;
-
 void DisplayWindow::DrawGradientFill(HDC hdc, RECT *rc)
 {
 	if (m_hBitmapBackground)
@@ -107,169 +106,266 @@ void DisplayWindow::PatchBackground(HDC hdc, RECT *rc, RECT *updateRect)
 
 void DisplayWindow::DrawThumbnail(HDC hdcMem)
 {
-	if (!m_bThumbnailExtracted)
+	if (!m_preview)
+	{
+		return;
+	}
+
+	RECT rc;
+	GetClientRect(m_hDisplayWindow, &rc);
+
+	HDC hdcSrc = CreateCompatibleDC(hdcMem);
+	auto hBitmapOld = (HBITMAP) SelectObject(hdcSrc, m_preview->bitmap.get());
+
+	if (m_iImageWidth == m_preview->width && m_iImageHeight == m_preview->height)
 	{
-		ExtractThumbnailImage();
+		BitBlt(hdcMem, m_xColumnFinal, THUMB_IMAGE_TOP, GetRectWidth(&rc) - m_xColumnFinal,
+			GetRectHeight(&rc) - THUMB_HEIGHT_DELTA, hdcSrc, 0, 0, SRCCOPY);
 	}
 	else
 	{
-		if (!m_bThumbnailExtractionFailed)
-		{
-			RECT rc;
-			GetClientRect(m_hDisplayWindow, &rc);
+		// The window has been resized since the preview was decoded. The
+		// preview is scaled until the preview for the new size is available.
+		int originalMode = SetStretchBltMode(hdcMem, HALFTONE);
+		StretchBlt(hdcMem, m_xColumnFinal, THUMB_IMAGE_TOP, m_iImageWidth, m_iImageHeight, hdcSrc,
+			0, 0, m_preview->width, m_preview->height, SRCCOPY);
+		SetStretchBltMode(hdcMem, originalMode);
+	}
+
+	SelectObject(hdcSrc, hBitmapOld);
+	DeleteDC(hdcSrc);
+}
 
-			HDC hdcSrc = CreateCompatibleDC(hdcMem);
-			auto hBitmapOld = (HBITMAP) SelectObject(hdcSrc, m_hbmThumbnail);
+std::optional<DisplayWindow::PreviewKey> DisplayWindow::GetPreviewKey(
+	const std::wstring &filePath) const
+{
+	RECT rc;
+	GetClientRect(m_hDisplayWindow, &rc);
 
-			BitBlt(hdcMem, m_xColumnFinal, THUMB_IMAGE_TOP, GetRectWidth(&rc) - m_xColumnFinal,
-				GetRectHeight(&rc) - THUMB_HEIGHT_DELTA, hdcSrc, 0, 0, SRCCOPY);
+	int height = GetRectHeight(&rc) - THUMB_HEIGHT_DELTA;
 
-			SelectObject(hdcSrc, hBitmapOld);
-			DeleteDC(hdcSrc);
-		}
+	if (height <= 0)
+	{
+		return std::nullopt;
+	}
+
+	return PreviewKey{ filePath, height };
+}
+
+// Shows the preview for the current file, decoding it in the background if
+// it's not already cached. Any existing preview is left in place (scaled to
+// fit) until the new preview is available, so the caller should reset it
+// first if it's for a different file.
+void DisplayWindow::RequestPreview()
+{
+	KillTimer(m_hDisplayWindow, RESIZE_PREVIEW_TIMER_ID);
+
+	auto key = GetPreviewKey(m_ImageFile);
+
+	// Any pending request for a different file (or size) is no longer needed.
+	CancelPreviewTasks(key ? &*key : nullptr);
+
+	if (!key)
+	{
+		UpdateImageSize();
+		return;
+	}
+
+	auto cachedPreview = m_previewCache.Get(*key);
+
+	if (cachedPreview)
+	{
+		m_preview = *cachedPreview;
+		UpdateImageSize();
+		return;
+	}
+
+	UpdateImageSize();
+	QueuePreviewTask(*key);
+}
+
+// Determines the size the current preview is drawn at, which is the height of
+// the window, regardless of the height the preview was decoded at.
+void DisplayWindow::UpdateImageSize()
+{
+	auto key = GetPreviewKey(m_ImageFile);
+
+	if (!m_preview || !key || m_preview->height <= 0)
+	{
+		m_iImageWidth = 0;
+		m_iImageHeight = 0;
+		return;
 	}
+
+	m_iImageHeight = key->height;
+	m_iImageWidth = MulDiv(m_preview->width, key->height, m_preview->height);
 }
 
-DWORD WINAPI Thread_ExtractThumbnailImage(LPVOID lpParameter)
+void DisplayWindow::OnPrefetchThumbnailFile(const TCHAR *filePath)
 {
-	DisplayWindow *pdw = nullptr;
+	auto key = GetPreviewKey(filePath);
 
-	pdw = (DisplayWindow *) ((ThumbnailEntry_t *) lpParameter)->pdw;
+	if (!key || m_previewCache.Contains(*key))
+	{
+		return;
+	}
+
+	QueuePreviewTask(*key);
+}
 
-	CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+void DisplayWindow::QueuePreviewTask(const PreviewKey &key)
+{
+	for (const auto &[resultId, pendingPreview] : m_pendingPreviews)
+	{
+		UNREFERENCED_PARAMETER(resultId);
 
-	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+		if (pendingPreview.key == key)
+		{
+			return;
+		}
+	}
 
-	pdw->ExtractThumbnailImageInternal((ThumbnailEntry_t *) lpParameter);
+	int resultId = m_previewResultIdCounter++;
+	auto cancelled = std::make_shared<std::atomic<bool>>(false);
 
-	/* TODO: Erase the item. */
-	// g_ThumbnailEntries.erase();
+	auto result = m_previewThreadPool.push(
+		[hwnd = m_hDisplayWindow, resultId, key, cancelled](int id) {
+			UNREFERENCED_PARAMETER(id);
 
-	CoUninitialize();
+			return DecodePreviewAsync(hwnd, resultId, key, *cancelled);
+		});
 
-	return 0;
+	m_pendingPreviews.insert({ resultId, { key, cancelled, std::move(result) } });
 }
 
-void DisplayWindow::ExtractThumbnailImage()
+std::shared_ptr<DisplayWindow::Preview> DisplayWindow::DecodePreviewAsync(
+	HWND hwnd, int resultId, const PreviewKey &key, const std::atomic<bool> &cancelled)
 {
-	ThumbnailEntry_t te;
+	std::shared_ptr<Preview> preview;
+
+	if (!cancelled)
+	{
+		preview = DecodePreview(key, cancelled);
+	}
 
-	te.pdw = (void *) this;
-	te.bCancelled = FALSE;
-	g_ThumbnailEntries.push_back(te);
+	// The notification is always sent, even if the task was cancelled, so
+	// that the pending request will be removed.
+	PostMessage(hwnd, WM_APP_PREVIEW_READY, resultId, 0);
 
-	HANDLE hThread = CreateThread(
-		nullptr, 0, Thread_ExtractThumbnailImage, (LPVOID) &g_ThumbnailEntries.back(), 0, nullptr);
-	CloseHandle(hThread);
+	return preview;
 }
 
-void DisplayWindow::ExtractThumbnailImageInternal(ThumbnailEntry_t *pte)
+std::shared_ptr<DisplayWindow::Preview> DisplayWindow::DecodePreview(
+	const PreviewKey &key, const std::atomic<bool> &cancelled)
 {
-	IExtractImage *pExtractImage = nullptr;
-	IShellFolder *pShellFolder = nullptr;
-	PIDLIST_ABSOLUTE pidlParent = nullptr;
-	PIDLIST_ABSOLUTE pidlFull = nullptr;
-	PITEMID_CHILD pridl = nullptr;
-	HBITMAP hBitmap;
-	BITMAP bm;
-	RECT rc;
-	SIZE size;
+	unique_pidl_absolute pidlFull;
+	HRESULT hr =
+		SHParseDisplayName(key.filePath.c_str(), nullptr, wil::out_param(pidlFull), 0, nullptr);
+
+	if (FAILED(hr))
+	{
+		return nullptr;
+	}
+
+	wil::com_ptr<IShellFolder> shellFolder;
+	PCUITEMID_CHILD pidlChild;
+	hr = SHBindToParent(pidlFull.get(), IID_PPV_ARGS(&shellFolder), &pidlChild);
+
+	if (FAILED(hr))
+	{
+		return nullptr;
+	}
+
+	wil::com_ptr<IExtractImage> extractImage;
+	hr = GetUIObjectOf(shellFolder.get(), nullptr, 1, &pidlChild, IID_PPV_ARGS(&extractImage));
+
+	if (FAILED(hr))
+	{
+		return nullptr;
+	}
+
+	/* First, query the thumbnail so that its actual aspect
+	ratio can be calculated. */
 	TCHAR szImage[MAX_PATH];
 	DWORD dwPriority;
-	DWORD dwFlags;
-	HRESULT hr;
+	DWORD dwFlags = IEIFLAG_OFFLINE | IEIFLAG_QUALITY | IEIFLAG_ORIGSIZE;
+	SIZE size = { key.height, key.height };
 
-	m_bThumbnailExtracted = TRUE;
-	m_bThumbnailExtractionFailed = TRUE;
+	hr = extractImage->GetLocation(
+		szImage, SIZEOF_ARRAY(szImage), &dwPriority, &size, 32, &dwFlags);
+
+	if (FAILED(hr))
+	{
+		return nullptr;
+	}
 
-	hr = SHParseDisplayName(m_ImageFile, nullptr, &pidlFull, 0, nullptr);
+	wil::unique_hbitmap initialBitmap;
+	hr = extractImage->Extract(&initialBitmap);
 
-	if (SUCCEEDED(hr))
+	if (FAILED(hr) || cancelled)
 	{
-		pidlParent = ILCloneFull(pidlFull);
-		ILRemoveLastID(pidlParent);
+		return nullptr;
+	}
 
-		pridl = ILCloneChild(ILFindLastID(pidlFull));
+	BITMAP bm;
+	GetObject(initialBitmap.get(), sizeof(BITMAP), &bm);
+	initialBitmap.reset();
 
-		hr = BindToIdl(pidlParent, IID_PPV_ARGS(&pShellFolder));
+	/* ...now query the thumbnail again, this time adjusting
+	the width of the suggested area based on the actual aspect
+	ratio. */
+	dwFlags = IEIFLAG_OFFLINE | IEIFLAG_QUALITY | IEIFLAG_ASPECT | IEIFLAG_ORIGSIZE;
+	size.cy = key.height;
+	size.cx = (LONG) ((double) size.cy * ((double) bm.bmWidth / (double) bm.bmHeight));
+	extractImage->GetLocation(szImage, SIZEOF_ARRAY(szImage), &dwPriority, &size, 32, &dwFlags);
 
-		if (SUCCEEDED(hr))
-		{
-			hr = GetUIObjectOf(
-				pShellFolder, nullptr, 1, &pridl, IID_PPV_ARGS(&pExtractImage));
-
-			if (SUCCEEDED(hr))
-			{
-				GetClientRect(m_hDisplayWindow, &rc);
-
-				/* First, query the thumbnail so that its actual aspect
-				ratio can be calculated. */
-				dwFlags = IEIFLAG_OFFLINE | IEIFLAG_QUALITY | IEIFLAG_ORIGSIZE;
-				size.cx = GetRectHeight(&rc) - THUMB_HEIGHT_DELTA;
-				size.cy = GetRectHeight(&rc) - THUMB_HEIGHT_DELTA;
-
-				hr = pExtractImage->GetLocation(
-					szImage, SIZEOF_ARRAY(szImage), &dwPriority, &size, 32, &dwFlags);
-
-				if (SUCCEEDED(hr))
-				{
-					hr = pExtractImage->Extract(&hBitmap);
-
-					if (SUCCEEDED(hr))
-					{
-						/* Get bitmap information (including height and width). */
-						GetObject(hBitmap, sizeof(BITMAP), &bm);
-
-						/* Delete the original bitmap. */
-						DeleteObject(hBitmap);
-
-						/* ...now query the thumbnail again, this time adjusting
-						the width of the suggested area based on the actual aspect
-						ratio. */
-						dwFlags =
-							IEIFLAG_OFFLINE | IEIFLAG_QUALITY | IEIFLAG_ASPECT | IEIFLAG_ORIGSIZE;
-						size.cy = GetRectHeight(&rc) - THUMB_HEIGHT_DELTA;
-						size.cx =
-							(LONG)((double) size.cy * ((double) bm.bmWidth / (double) bm.bmHeight));
-						m_iImageWidth = size.cx;
-						m_iImageHeight = size.cy;
-						pExtractImage->GetLocation(
-							szImage, SIZEOF_ARRAY(szImage), &dwPriority, &size, 32, &dwFlags);
-						hr = pExtractImage->Extract(&m_hbmThumbnail);
-
-						if (SUCCEEDED(hr))
-						{
-							/* Check first if we've been cancelled. This might happen,
-							for example, if another file is selected while the current
-							thumbnail is been found. */
-							EnterCriticalSection(&m_csDWThumbnails);
-
-							if (!pte->bCancelled)
-							{
-								m_bThumbnailExtractionFailed = FALSE;
-								InvalidateRect(m_hDisplayWindow, nullptr, FALSE);
-							}
-
-							LeaveCriticalSection(&m_csDWThumbnails);
-						}
-						else
-						{
-							m_bThumbnailExtractionFailed = TRUE;
-							m_hbmThumbnail = nullptr;
-						}
-					}
-				}
-
-				pExtractImage->Release();
-			}
-
-			pShellFolder->Release();
-		}
+	auto preview = std::make_shared<Preview>();
+	hr = extractImage->Extract(&preview->bitmap);
+
+	if (FAILED(hr))
+	{
+		return nullptr;
+	}
+
+	preview->width = size.cx;
+	preview->height = size.cy;
+
+	return preview;
+}
+
+void DisplayWindow::OnPreviewReady(int resultId)
+{
+	auto itr = m_pendingPreviews.find(resultId);
+
+	if (itr == m_pendingPreviews.end())
+	{
+		return;
+	}
+
+	PreviewKey key = itr->second.key;
+	auto preview = itr->second.result.get();
+	m_pendingPreviews.erase(itr);
+
+	if (!preview)
+	{
+		return;
+	}
 
-		CoTaskMemFree(pidlFull);
-		CoTaskMemFree(pidlParent);
-		CoTaskMemFree(pridl);
+	m_previewCache.Put(key, preview);
+
+	auto currentKey = GetPreviewKey(m_ImageFile);
+
+	// The result replaces any existing preview for the file, since that
+	// preview may have been decoded at a different size.
+	if (!m_bShowThumbnail || !currentKey || !(key == *currentKey))
+	{
+		return;
 	}
+
+	m_preview = preview;
+	UpdateImageSize();
+
+	InvalidateRect(m_hDisplayWindow, nullptr, FALSE);
 }
 
 void DisplayWindow::PaintText(HDC hdc, unsigned int x)
@@ -446,18 +542,22 @@ void DisplayWindow::OnRButtonUp(WPARAM wParam, LPARAM lParam)
 	}
 }
 
-void DisplayWindow::CancelThumbnailExtraction()
+// Tasks that have already started will still run to completion (or until
+// they next check whether they've been cancelled), but their results won't be
+// used.
+void DisplayWindow::CancelPreviewTasks(const PreviewKey *keyToKeep)
 {
-	std::list<ThumbnailEntry_t>::iterator itr;
-
-	EnterCriticalSection(&m_csDWThumbnails);
-
-	for (itr = g_ThumbnailEntries.begin(); itr != g_ThumbnailEntries.end(); itr++)
+	for (auto itr = m_pendingPreviews.begin(); itr != m_pendingPreviews.end();)
 	{
-		itr->bCancelled = TRUE;
-	}
+		if (keyToKeep && itr->second.key == *keyToKeep)
+		{
+			++itr;
+			continue;
+		}
 
-	LeaveCriticalSection(&m_csDWThumbnails);
+		*itr->second.cancelled = true;
+		itr = m_pendingPreviews.erase(itr);
+	}
 }
 
 void DisplayWindow::OnSetThumbnailFile(WPARAM wParam, LPARAM lParam)
@@ -466,18 +566,18 @@ void DisplayWindow::OnSetThumbnailFile(WPARAM wParam, LPARAM lParam)
 
 	if (m_bShowThumbnail)
 	{
-		CancelThumbnailExtraction();
-
-		if (m_hbmThumbnail)
-		{
-			DeleteObject(m_hbmThumbnail);
-		}
-
-		m_iImageWidth = 0;
-		m_iImageHeight = 0;
-		m_bThumbnailExtracted = FALSE;
-		m_bThumbnailExtractionFailed = FALSE;
 		StringCchCopy(m_ImageFile, SIZEOF_ARRAY(m_ImageFile), (TCHAR *) wParam);
+
+		// The existing preview is for a different file.
+		m_preview.reset();
+		RequestPreview();
+	}
+	else
+	{
+		KillTimer(m_hDisplayWindow, RESIZE_PREVIEW_TIMER_ID);
+		CancelPreviewTasks(nullptr);
+		m_preview.reset();
+		UpdateImageSize();
 	}
 }
 
@@ -493,9 +593,41 @@ void DisplayWindow::OnSize(int width, int height)
 
 	ReleaseDC(m_hDisplayWindow, hdc);
 
+	// Previews are decoded to fit the height of the window, so a new preview
+	// is needed whenever the height changes. Decoding is relatively expensive,
+	// so the current preview is scaled until the window has stopped being
+	// resized.
+	if (m_bShowThumbnail)
+	{
+		UpdateImageSize();
+
+		auto key = GetPreviewKey(m_ImageFile);
+
+		if (!key || !m_preview || key->height != m_preview->height)
+		{
+			SetTimer(m_hDisplayWindow, RESIZE_PREVIEW_TIMER_ID, RESIZE_PREVIEW_TIMEOUT, nullptr);
+		}
+	}
+
 	RedrawWindow(m_hDisplayWindow, nullptr, nullptr, RDW_INVALIDATE);
 }
 
+void DisplayWindow::OnTimer(UINT_PTR timerId)
+{
+	if (timerId != RESIZE_PREVIEW_TIMER_ID)
+	{
+		return;
+	}
+
+	KillTimer(m_hDisplayWindow, RESIZE_PREVIEW_TIMER_ID);
+
+	if (m_bShowThumbnail)
+	{
+		RequestPreview();
+		RedrawWindow(m_hDisplayWindow, nullptr, nullptr, RDW_INVALIDATE);
+	}
+}
+
 void DisplayWindow::OnSetFont(HFONT hFont)
 {
 	m_hDisplayFont = hFont;
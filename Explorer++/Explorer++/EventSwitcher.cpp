@@ -193,13 +193,24 @@ BOOL Explorerplusplus::OnMouseWheel(MousewheelSource mousewheelSource, WPARAM wP
 		if (wParam & MK_CONTROL)
 		{
 			Tab &selectedTab = m_tabContainer->GetSelectedTab();
+			ShellBrowser *shellBrowser = selectedTab.GetShellBrowser();
 
 			/* Switch listview views. For each wheel delta
 			(notch) the wheel is scrolled through, switch
-			the view once. */
+			the view once. In thumbnails view, the thumbnail
+			size is changed first, with the view only being
+			switched once the smallest/largest size has been
+			reached. */
 			for (int i = 0; i < abs(m_zDeltaTotal / WHEEL_DELTA); i++)
 			{
-				selectedTab.GetShellBrowser()->CycleViewMode((m_zDeltaTotal > 0));
+				if (shellBrowser->GetViewMode() == +ViewMode::Thumbnails
+					&& shellBrowser->ZoomThumbnails(m_zDeltaTotal > 0))
+				{
+					m_config->thumbnailSize = shellBrowser->GetThumbnailSize();
+					continue;
+				}
+
+				shellBrowser->CycleViewMode((m_zDeltaTotal > 0));
 			}
 		}
 		else if (wParam & MK_SHIFT)
@@ -12,10 +12,13 @@
 #include "Explorer++_internal.h"
 #include "MenuRanges.h"
 #include "Plugins/PluginManager.h"
+#include "TabHibernator.h"
 #include "TabRestorerUI.h"
 #include "UiTheming.h"
 #include "../Helper/WindowSubclassWrapper.h"
 #include "../Helper/iDirectoryMonitor.h"
+#include <algorithm>
+#include <thread>
 
 /* These entries correspond to shell
 extensions that are known to be
@@ -32,12 +35,22 @@ const std::vector<std::wstring> Explorerplusplus::BLACKLISTED_BACKGROUND_MENU_CL
 
 Explorerplusplus::Explorerplusplus(HWND hwnd) :
 	m_hContainer(hwnd),
-	m_cachedIcons(MAX_CACHED_ICONS),
+	m_cachedIcons(MAX_CACHED_ICONS, IconResolutionService::ResolveIconLocation),
+	m_iconResolutionService(&m_cachedIcons),
+	m_folderListingCache(FOLDER_LISTING_CACHE_MAX_BYTES),
+	m_folderPrefetcher(&m_folderListingCache),
+	m_groupingThreadPool(
+		std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, MAX_GROUPING_THREADS),
+		std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED), CoUninitialize),
 	m_pluginMenuManager(hwnd, MENU_PLUGIN_STARTID, MENU_PLUGIN_ENDID),
 	m_acceleratorUpdater(&g_hAccl),
 	m_pluginCommandManager(&g_hAccl, ACCELERATOR_PLUGIN_STARTID, ACCELERATOR_PLUGIN_ENDID),
-	m_bookmarkIconFetcher(hwnd, &m_cachedIcons),
-	m_tabBarBackgroundBrush(CreateSolidBrush(TAB_BAR_DARK_MODE_BACKGROUND_COLOR))
+	m_bookmarkSearchIndex(&m_bookmarkTree),
+	m_bookmarkBinaryStorage(&m_bookmarkTree),
+	m_bookmarkIconFetcher(hwnd, &m_iconResolutionService),
+	m_tabBarBackgroundBrush(CreateSolidBrush(TAB_BAR_DARK_MODE_BACKGROUND_COLOR)),
+	m_displayWindowThreadPool(1),
+	m_imagePropertiesResultIdCounter(0)
 {
 	m_hLanguageModule = nullptr;
 
@@ -5,6 +5,8 @@
 #pragma once
 
 #include "AcceleratorUpdater.h"
+#include "Bookmarks/BookmarkBinaryStorage.h"
+#include "Bookmarks/BookmarkSearchIndex.h"
 #include "Bookmarks/BookmarkTree.h"
 #include "CoreInterface.h"
 #include "Navigation.h"
@@ -12,6 +14,8 @@
 #include "Plugins/PluginCommandManager.h"
 #include "Plugins/PluginMenuManager.h"
 #include "ShellBrowser/Columns.h"
+#include "ShellBrowser/FolderListingCache.h"
+#include "ShellBrowser/FolderPrefetcher.h"
 #include "ShellBrowser/SortModes.h"
 #include "Tab.h"
 #include "TabNavigationInterface.h"
@@ -21,13 +25,22 @@
 #include "../Helper/FileActionHandler.h"
 #include "../Helper/FileContextMenuManager.h"
 #include "../Helper/IconFetcher.h"
+#include "../Helper/MemoryAccounting.h"
+#include "../Helper/ThumbnailDiskCache.h"
+#include "../ThirdParty/CTPL/cpl_stl.h"
 #include <boost/signals2.hpp>
 #include <wil/resource.h>
+#include <future>
 #include <optional>
+#include <unordered_map>
 
 /* Sent when a folder size calculation has finished. */
 #define WM_APP_FOLDERSIZECOMPLETED WM_APP + 3
 
+/* Sent when the properties of the image shown in the
+display window have been read. */
+#define WM_APP_IMAGEPROPERTIESREADY WM_APP + 4
+
 /* Private definitions. */
 #define FROM_LISTVIEW 0
 #define FROM_TREEVIEW 1
@@ -50,12 +63,16 @@ class MainWindow;
 class ShellBrowser;
 class ShellTreeView;
 class TabContainer;
+class TabHibernator;
 class TabRestorer;
 class TabRestorerUI;
 struct TabSettings;
 class TaskbarThumbnails;
 class UiTheming;
 class WindowSubclassWrapper;
+class XmlSections;
+class XmlStreamReader;
+class XmlStreamWriter;
 
 namespace NColorRuleHelper
 {
@@ -116,10 +133,26 @@ private:
 	static const UINT_PTR LISTVIEW_ITEM_CHANGED_TIMER_ID = 100001;
 	static const UINT LISTVIEW_ITEM_CHANGED_TIMEOUT = 50;
 
+	static const UINT_PTR TAB_HIBERNATION_TIMER_ID = 100002;
+	static const UINT TAB_HIBERNATION_INTERVAL = 60000;
+
 	// Represents the maximum number of icons that can be cached. This cache is
 	// shared between various components in the application.
 	static const int MAX_CACHED_ICONS = 1000;
 
+	// The maximum amount of memory that can be used to hold recently visited
+	// folder listings. The cache is shared between all tabs.
+	static const size_t FOLDER_LISTING_CACHE_MAX_BYTES = 32 * 1024 * 1024;
+
+	// The maximum number of threads used to group items. Grouping is only
+	// done in parallel for large folders and the threads are shared between
+	// all tabs, so there's little benefit in using every available core.
+	static const int MAX_GROUPING_THREADS = 4;
+
+	// The number of items on either side of the selected item whose previews
+	// will be decoded ahead of time in the display window.
+	static const int DISPLAY_WINDOW_PREFETCH_DISTANCE = 2;
+
 	static inline constexpr COLORREF TAB_BAR_DARK_MODE_BACKGROUND_COLOR = RGB(25, 25, 25);
 
 	static inline const int CLOSE_TOOLBAR_WIDTH = 24;
@@ -157,6 +190,18 @@ private:
 		int uId;
 	};
 
+	struct DWImageProperties
+	{
+		UINT width;
+		UINT height;
+
+		// Will be 0 if the bit depth couldn't be determined.
+		UINT bitDepth;
+
+		Gdiplus::REAL horizontalResolution;
+		Gdiplus::REAL verticalResolution;
+	};
+
 	LRESULT CALLBACK WindowProcedure(HWND hwnd, UINT Msg, WPARAM wParam, LPARAM lParam);
 
 	static LRESULT CALLBACK ListViewProcStub(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam,
@@ -221,6 +266,7 @@ private:
 	void OnSearch();
 	void OnCustomizeColors();
 	void OnRunScript();
+	void OnShowMemoryUsage();
 	void OnShowOptions();
 	void OnShowHelp();
 	void OnCheckForUpdates();
@@ -277,7 +323,7 @@ private:
 	void InitializeTabs();
 	boost::signals2::connection AddTabsInitializedObserver(
 		const TabsInitializedSignal::slot_type &observer) override;
-	void OnTabCreated(int tabId, BOOL switchToNewTab);
+	void OnTabLoaded(const Tab &tab);
 	void OnTabSelected(const Tab &tab);
 	void ShowTabBar() override;
 	void HideTabBar() override;
@@ -332,6 +378,12 @@ private:
 	void ValidateSingleColumnSet(int iColumnSet, std::vector<Column_t> &columns);
 	void ApplyDisplayWindowPosition();
 	void ApplyToolbarSettings();
+	void LoadIconCache();
+	void SaveIconCache();
+	bool LoadBookmarksSnapshot();
+	void SaveBookmarksSnapshot();
+	void CreateThumbnailDiskCache();
+	std::wstring GetCacheFilePath(const TCHAR *fileName);
 	void TestConfigFile();
 
 	/* Registry settings. */
@@ -357,31 +409,27 @@ private:
 	void LoadDialogStatesFromRegistry();
 
 	/* XML Settings. */
-	void LoadGenericSettingsFromXML(IXMLDOMDocument *pXMLDom);
-	void SaveGenericSettingsToXML(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pRoot);
-	int LoadTabSettingsFromXML(IXMLDOMDocument *pXMLDom);
-	void SaveTabSettingsToXML(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pRoot);
-	void SaveTabSettingsToXMLnternal(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pe);
-	int LoadColumnFromXML(IXMLDOMNode *pNode, std::vector<Column_t> &outputColumns);
-	void SaveColumnToXML(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pColumnsNode,
-		const std::vector<Column_t> &columns, const TCHAR *szColumnSet, int iIndent);
-	void LoadBookmarksFromXML(IXMLDOMDocument *pXMLDom);
-	void SaveBookmarksToXML(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pRoot);
-	int LoadDefaultColumnsFromXML(IXMLDOMDocument *pXMLDom);
-	void SaveDefaultColumnsToXML(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pRoot);
-	void SaveDefaultColumnsToXMLInternal(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pColumnsNode);
-	void SaveWindowPositionToXML(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pRoot);
-	void SaveWindowPositionToXMLInternal(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pWndPosNode);
-	void LoadApplicationToolbarFromXML(IXMLDOMDocument *pXMLDom);
-	void SaveApplicationToolbarToXML(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pRoot);
-	void LoadToolbarInformationFromXML(IXMLDOMDocument *pXMLDom);
-	void SaveToolbarInformationToXML(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pRoot);
-	void SaveToolbarInformationToXMLnternal(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pe);
-	void LoadDialogStatesFromXML(IXMLDOMDocument *pXMLDom);
-	void SaveDialogStatesToXML(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pRoot);
-	void MapAttributeToValue(IXMLDOMNode *pNode, WCHAR *wszName, WCHAR *wszValue);
-	void MapTabAttributeValue(
-		WCHAR *wszName, WCHAR *wszValue, TabSettings &tabSettings, FolderSettings &folderSettings);
+	void LoadGenericSettingsFromXML(const XmlSections &sections);
+	void SaveGenericSettingsToXML(XmlStreamWriter &writer);
+	int LoadTabSettingsFromXML(const XmlSections &sections);
+	void SaveTabSettingsToXML(XmlStreamWriter &writer);
+	int LoadColumnFromXML(const XmlStreamReader &reader, std::vector<Column_t> &outputColumns);
+	void SaveColumnToXML(XmlStreamWriter &writer, const std::vector<Column_t> &columns,
+		const TCHAR *szColumnSet);
+	void LoadBookmarksFromXML(const XmlSections &sections);
+	void SaveBookmarksToXML(XmlStreamWriter &writer);
+	int LoadDefaultColumnsFromXML(const XmlSections &sections);
+	void SaveDefaultColumnsToXML(XmlStreamWriter &writer);
+	void SaveWindowPositionToXML(XmlStreamWriter &writer);
+	void LoadApplicationToolbarFromXML(const XmlSections &sections);
+	void SaveApplicationToolbarToXML(XmlStreamWriter &writer);
+	void LoadToolbarInformationFromXML(const XmlSections &sections);
+	void SaveToolbarInformationToXML(XmlStreamWriter &writer);
+	void LoadDialogStatesFromXML(const XmlSections &sections);
+	void SaveDialogStatesToXML(XmlStreamWriter &writer);
+	void MapAttributeToValue(XmlStreamReader &reader, std::wstring_view wszName);
+	void MapTabAttributeValue(const WCHAR *wszName, const WCHAR *wszValue,
+		TabSettings &tabSettings, FolderSettings &folderSettings);
 
 	/* Window state update. */
 	void UpdateWindowStates(const Tab &tab);
@@ -437,6 +485,12 @@ private:
 	void UpdateDisplayWindowForZeroFiles(const Tab &tab);
 	void UpdateDisplayWindowForOneFile(const Tab &tab);
 	void UpdateDisplayWindowForMultipleFiles(const Tab &tab);
+	void QueueImagePropertiesTask(const std::wstring &filePath);
+	static std::optional<DWImageProperties> ReadImagePropertiesAsync(
+		HWND hwnd, int resultId, const std::wstring &filePath);
+	static UINT GetBitDepth(Gdiplus::PixelFormat format);
+	void OnImagePropertiesReady(int resultId);
+	void PrefetchDisplayWindowPreviews(const Tab &tab, int selectedItem);
 
 	/* Columns. */
 	void CopyColumnInfoToClipboard();
@@ -457,6 +511,12 @@ private:
 	IDirectoryMonitor *GetDirectoryMonitor() const override;
 	IconResourceLoader *GetIconResourceLoader() const override;
 	CachedIcons *GetCachedIcons() override;
+	FolderListingCache *GetFolderListingCache() override;
+	FolderPrefetcher *GetFolderPrefetcher() override;
+	ctpl::thread_pool *GetGroupingThreadPool() override;
+	IconResolutionService *GetIconResolutionService() override;
+	ThumbnailDiskCache *GetThumbnailDiskCache() override;
+	MemoryAccountant *GetMemoryAccountant() override;
 	BOOL GetSavePreferencesToXmlFile() const override;
 	void SetSavePreferencesToXmlFile(BOOL savePreferencesToXmlFile) override;
 
@@ -472,6 +532,9 @@ private:
 	// Dark mode
 	void SetUpDarkMode();
 
+	// Memory accounting
+	void RegisterMemorySources();
+
 	// Rebar
 	HMENU CreateRebarHistoryMenu(BOOL bBack);
 	std::optional<int> OnRebarCustomDraw(NMHDR *nmhdr);
@@ -535,7 +598,15 @@ private:
 
 	std::unique_ptr<IconResourceLoader> m_iconResourceLoader;
 
+	MemoryAccountant m_memoryAccountant;
+
 	CachedIcons m_cachedIcons;
+	IconResolutionService m_iconResolutionService;
+	std::unique_ptr<ThumbnailDiskCache> m_thumbnailDiskCache;
+
+	FolderListingCache m_folderListingCache;
+	FolderPrefetcher m_folderPrefetcher;
+	ctpl::thread_pool m_groupingThreadPool;
 
 	MainMenuPreShowSignal m_mainMenuPreShowSignal;
 	ApplicationShuttingDownSignal m_applicationShuttingDownSignal;
@@ -552,6 +623,8 @@ private:
 	/* Theming. */
 	std::unique_ptr<UiTheming> m_uiTheming;
 
+	std::unique_ptr<TabHibernator> m_tabHibernator;
+
 	/* Plugins. */
 	std::unique_ptr<Plugins::PluginManager> m_pluginManager;
 	Plugins::PluginMenuManager m_pluginMenuManager;
@@ -572,25 +645,15 @@ private:
 
 	/* Bookmarks. */
 	BookmarkTree m_bookmarkTree;
+	BookmarkSearchIndex m_bookmarkSearchIndex;
+	BookmarkBinaryStorage m_bookmarkBinaryStorage;
 	std::unique_ptr<BookmarksMainMenu> m_bookmarksMainMenu;
 	BookmarksToolbar *m_pBookmarksToolbar;
 
-	// IconFetcher retrieves file icons in a background thread. A queue of requests is maintained
-	// and that queue is cleared when the instance is destroyed. However, any current request that's
-	// running in the background thread will continue to run and the main thread will wait for it to
-	// finish.
-	// This, however, could cause problems if the IconFetcher instance is held by an object that
-	// only exists for a specific period of time. For example, if the instance were being managed by
-	// the manage bookmark dialog, and the dialog was closed, the instance would be destroyed and
-	// the main thread would wait for any operation in the background thread to finish. That could
-	// then cause the application to appear to hang.
-	// Since this class exists for the entire lifetime of the application, it means that the
-	// IconFetcher instance will only be destroyed at application shutdown and that's the only point
-	// at which the main thread will wait. While the application is running, the most that would
-	// happen is that the process of retrieving other icons would be delayed.
-	// Ideally, it would be better to cancel operations that are running in the background thread,
-	// but as far as I'm aware, it's not possible to cancel SHGetFileInfo (which is what's
-	// ultimately used to retrieve the icons).
+	// This is shared by the bookmark menus, toolbar and dialogs. Icons are retrieved by
+	// m_iconResolutionService, so destroying an IconFetcher doesn't wait for any outstanding
+	// requests, but using a single instance means that requests made by short-lived windows (e.g.
+	// the bookmark menu) can still populate the icon cache after those windows have gone.
 	IconFetcher m_bookmarkIconFetcher;
 
 	/* Customize colors. */
@@ -609,6 +672,13 @@ private:
 	std::list<DWFolderSize> m_DWFolderSizes;
 	int m_iDWFolderSizeUniqueId;
 
+	/* Display window image properties. Reading these can take a
+	noticeable amount of time for large images, so it's done in
+	the background. */
+	ctpl::thread_pool m_displayWindowThreadPool;
+	std::unordered_map<int, std::future<std::optional<DWImageProperties>>> m_imagePropertiesResults;
+	int m_imagePropertiesResultIdCounter;
+
 	/* Drag and drop. */
 	bool m_bDragging;
 	bool m_bDragCancelled;
@@ -624,4 +694,7 @@ private:
 	int m_zDeltaTotal;
 
 	bool m_blockNextListViewSelection;
+
+	/* Memory accounting. */
+	std::vector<MemoryAccountant::Registration> m_memoryRegistrations;
 };
\ No newline at end of file
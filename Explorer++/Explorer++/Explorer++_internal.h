@@ -23,6 +23,25 @@ namespace NExplorerplusplus
 
 	const TCHAR LOG_FILENAME[] = _T("Explorer++.log");
 
+	/* Trace events are written to this file (in the
+	Chrome trace event format) on exit. */
+	const TCHAR TRACE_FILENAME[] = _T("Explorer++Trace.json");
+
+	/* Holds the location of each cached icon, when
+	the icon cache is persisted between sessions. */
+	const TCHAR ICON_CACHE_FILENAME[] = _T("IconCache.dat");
+
+	/* A binary snapshot of the bookmarks, which is
+	faster to load than the bookmarks stored in the
+	registry or config file. */
+	const TCHAR BOOKMARKS_SNAPSHOT_FILENAME[] = _T("Bookmarks.dat");
+
+	/* Extracted thumbnails are stored in the pack
+	file. The index file records the location of each
+	thumbnail within the pack file. */
+	const TCHAR THUMBNAIL_CACHE_PACK_FILENAME[] = _T("ThumbnailCache.pack");
+	const TCHAR THUMBNAIL_CACHE_INDEX_FILENAME[] = _T("ThumbnailCache.idx");
+
 	/* Command line arguments supplied to the program
 	for each jump list task. */
 	const TCHAR JUMPLIST_TASK_NEWTAB_ARGUMENT[] = _T("--open-new-tab");
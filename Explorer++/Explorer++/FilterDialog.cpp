@@ -11,6 +11,7 @@
 #include "ShellBrowser/ShellBrowser.h"
 #include "../Helper/RegistrySettings.h"
 #include "../Helper/XMLSettings.h"
+#include "../Helper/XmlStream.h"
 #include <list>
 
 const TCHAR FilterDialogPersistentSettings::SETTINGS_KEY[] = _T("Filter");
@@ -186,18 +187,18 @@ void FilterDialogPersistentSettings::LoadExtraRegistrySettings(HKEY hKey)
 	NRegistrySettings::ReadStringListFromRegistry(hKey, SETTING_FILTER_LIST, m_FilterList);
 }
 
-void FilterDialogPersistentSettings::SaveExtraXMLSettings(
-	IXMLDOMDocument *pXMLDom, IXMLDOMElement *pParentNode)
+void FilterDialogPersistentSettings::SaveExtraXMLSettings(XmlStreamWriter &writer)
 {
-	NXMLSettings::AddStringListToNode(pXMLDom, pParentNode, SETTING_FILTER_LIST, m_FilterList);
+	NXMLSettings::AddStringListToNode(writer, SETTING_FILTER_LIST, m_FilterList);
 }
 
-void FilterDialogPersistentSettings::LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue)
+void FilterDialogPersistentSettings::LoadExtraXMLSettings(
+	const WCHAR *wszName, const WCHAR *wszValue)
 {
-	if (CompareString(LOCALE_INVARIANT, NORM_IGNORECASE, bstrName, lstrlen(SETTING_FILTER_LIST),
+	if (CompareString(LOCALE_INVARIANT, NORM_IGNORECASE, wszName, lstrlen(SETTING_FILTER_LIST),
 			SETTING_FILTER_LIST, lstrlen(SETTING_FILTER_LIST))
 		== CSTR_EQUAL)
 	{
-		m_FilterList.emplace_back(bstrValue);
+		m_FilterList.emplace_back(wszValue);
 	}
 }
\ No newline at end of file
@@ -7,7 +7,6 @@
 #include "DarkModeDialogBase.h"
 #include "../Helper/DialogSettings.h"
 #include "../Helper/ResizableDialog.h"
-#include <MsXml2.h>
 #include <objbase.h>
 
 class FilterDialog;
@@ -33,8 +32,8 @@ private:
 	void SaveExtraRegistrySettings(HKEY hKey) override;
 	void LoadExtraRegistrySettings(HKEY hKey) override;
 
-	void SaveExtraXMLSettings(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pParentNode) override;
-	void LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue) override;
+	void SaveExtraXMLSettings(XmlStreamWriter &writer) override;
+	void LoadExtraXMLSettings(const WCHAR *wszName, const WCHAR *wszValue) override;
 
 	std::list<std::wstring> m_FilterList;
 };
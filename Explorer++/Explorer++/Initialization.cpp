@@ -16,7 +16,9 @@
 #include "MenuHelper.h"
 #include "MenuRanges.h"
 #include "ShellBrowser/ViewModes.h"
+#include "TabHibernator.h"
 #include "TaskbarThumbnails.h"
+#include "Tracing.h"
 #include "UiTheming.h"
 #include "ViewModeHelper.h"
 #include "../Helper/CustomGripper.h"
@@ -39,6 +41,21 @@ void Explorerplusplus::OnCreate()
 	LoadAllSettings(&pLoadSave);
 	ApplyToolbarSettings();
 
+	if (m_config->enableTracing)
+	{
+		SetTracingEnabled(true);
+	}
+
+	if (m_config->persistIconCache)
+	{
+		LoadIconCache();
+	}
+
+	if (m_config->thumbnailDiskCacheSize > 0)
+	{
+		CreateThumbnailDiskCache();
+	}
+
 	m_iconResourceLoader = std::make_unique<IconResourceLoader>(m_config->iconTheme);
 
 	SetLanguageModule();
@@ -93,6 +110,10 @@ void Explorerplusplus::OnCreate()
 
 	m_uiTheming = std::make_unique<UiTheming>(this, m_tabContainer);
 
+	m_tabHibernator = std::make_unique<TabHibernator>(m_tabContainer, m_config);
+
+	RegisterMemorySources();
+
 	COLORREF gripperBackgroundColor;
 
 	if (DarkModeHelper::GetInstance().IsDarkModeEnabled())
@@ -110,6 +131,10 @@ void Explorerplusplus::OnCreate()
 
 	SetTimer(m_hContainer, AUTOSAVE_TIMER_ID, AUTOSAVE_TIMEOUT, nullptr);
 
+	// The timer is always started, so that hibernation can be enabled without
+	// restarting. Each tick does nothing while hibernation is disabled.
+	SetTimer(m_hContainer, TAB_HIBERNATION_TIMER_ID, TAB_HIBERNATION_INTERVAL, nullptr);
+
 	m_InitializationFinished.set(true);
 }
 
@@ -173,4 +198,18 @@ void Explorerplusplus::SetUpDarkMode()
 		DarkModeHelper::WCA_USEDARKMODECOLORS, &dark, sizeof(dark)
 	};
 	darkModeHelper.SetWindowCompositionAttribute(m_hContainer, &compositionData);
+}
+
+// Registers the memory used by components that are shared between tabs. Each
+// tab registers its own memory when it's created.
+void Explorerplusplus::RegisterMemorySources()
+{
+	m_memoryRegistrations.push_back(m_memoryAccountant.AddSource(
+		L"Icon cache", std::nullopt, [this] { return m_cachedIcons.getMemoryUsage(); }));
+	m_memoryRegistrations.push_back(m_memoryAccountant.AddSource(L"Folder listing cache",
+		std::nullopt, [this] { return m_folderListingCache.GetMemoryUsage(); }));
+	m_memoryRegistrations.push_back(m_memoryAccountant.AddSource(
+		L"Bookmarks", std::nullopt, [this] { return m_bookmarkTree.GetMemoryUsage(); }));
+	m_memoryRegistrations.push_back(m_memoryAccountant.AddSource(L"Bookmark search index",
+		std::nullopt, [this] { return m_bookmarkSearchIndex.GetMemoryUsage(); }));
 }
\ No newline at end of file
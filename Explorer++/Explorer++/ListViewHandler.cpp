@@ -333,7 +333,7 @@ int Explorerplusplus::DetermineListViewObjectIndex(HWND hListView)
 {
 	for (auto &item : m_tabContainer->GetAllTabs())
 	{
-		if (item.second->GetShellBrowser()->GetListView() == hListView)
+		if (item.second->IsLoaded() && item.second->GetShellBrowser()->GetListView() == hListView)
 		{
 			return item.first;
 		}
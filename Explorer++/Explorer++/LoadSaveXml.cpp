@@ -7,8 +7,10 @@
 #include "ColorRuleHelper.h"
 #include "Explorer++.h"
 #include "Explorer++_internal.h"
+#include "XMLSettings.h"
 #include "../Helper/ProcessHelper.h"
-#include "../Helper/XMLSettings.h"
+#include "../Helper/XmlStream.h"
+#include <fstream>
 
 LoadSaveXML::LoadSaveXML(Explorerplusplus *pContainer, BOOL bLoad) :
 	m_pContainer(pContainer),
@@ -29,214 +31,130 @@ LoadSaveXML::LoadSaveXML(Explorerplusplus *pContainer, BOOL bLoad) :
 
 LoadSaveXML::~LoadSaveXML()
 {
-	if (m_bLoad)
-		ReleaseLoadEnvironment();
-	else
+	if (!m_bLoad)
 		ReleaseSaveEnvironment();
 }
 
 void LoadSaveXML::InitializeLoadEnvironment()
 {
-	TCHAR szConfigFile[MAX_PATH];
-	VARIANT_BOOL status;
-	VARIANT var;
-
-	m_bLoadedCorrectly = FALSE;
-
-	m_pXMLDom = NXMLSettings::DomFromCOM();
-
-	if (!m_pXMLDom)
-		goto clean;
-
-	GetProcessImageName(GetCurrentProcessId(), szConfigFile, SIZEOF_ARRAY(szConfigFile));
-	PathRemoveFileSpec(szConfigFile);
-	PathAppend(szConfigFile, NExplorerplusplus::XML_FILENAME);
-
-	var = NXMLSettings::VariantString(NExplorerplusplus::XML_FILENAME);
-	m_pXMLDom->load(var, &status);
+	auto document = ReadXMLConfigFile();
 
-	if (status != VARIANT_TRUE)
-		goto clean;
+	/* If the file couldn't be read, there won't be any
+	sections, so nothing will be loaded. */
+	if (!document)
+		return;
 
-	m_bLoadedCorrectly = TRUE;
-
-clean:
-	if (&var) VariantClear(&var);
-}
-
-void LoadSaveXML::ReleaseLoadEnvironment()
-{
-	if (m_bLoadedCorrectly)
-	{
-		m_pXMLDom->Release();
-		m_pXMLDom = nullptr;
-	}
+	m_document = std::move(*document);
+	m_sections = XmlSections(m_document);
 }
 
 void LoadSaveXML::InitializeSaveEnvironment()
 {
-	IXMLDOMProcessingInstruction *pi = nullptr;
-	IXMLDOMComment *pc = nullptr;
-	BSTR									bstr = nullptr;
-	BSTR									bstr1 = nullptr;
-	BSTR									bstr_wsnt = SysAllocString(L"\n\t");
-
-	m_pXMLDom = NXMLSettings::DomFromCOM();
-
-	if (!m_pXMLDom)
-		goto clean;
-
-	/* Insert the XML header. */
-	bstr = SysAllocString(L"xml");
-	bstr1 = SysAllocString(L"version='1.0'");
-	m_pXMLDom->createProcessingInstruction(bstr, bstr1, &pi);
-	NXMLSettings::AppendChildToParent(pi, m_pXMLDom);
-
-	pi->Release();
-	pi = nullptr;
-	SysFreeString(bstr);
-	bstr = nullptr;
-	SysFreeString(bstr1);
-	bstr1 = nullptr;
+	m_writer.WriteDeclaration();
 
 	/* Short header comment, explaining file purpose. */
-	bstr = SysAllocString(L" Preference file for Explorer++ ");
-	m_pXMLDom->createComment(bstr, &pc);
-	NXMLSettings::AppendChildToParent(pc, m_pXMLDom);
-	SysFreeString(bstr);
-	bstr = nullptr;
-	pc->Release();
-	pc = nullptr;
+	m_writer.WriteComment(L" Preference file for Explorer++ ");
 
 	/* Create the root element. CANNOT use '+' signs
 	within the element name. */
-	bstr = SysAllocString(L"ExplorerPlusPlus");
-	m_pXMLDom->createElement(bstr, &m_pRoot);
-	SysFreeString(bstr);
-	bstr = nullptr;
-
-	NXMLSettings::AppendChildToParent(m_pRoot, m_pXMLDom);
-
-	NXMLSettings::AddWhiteSpaceToNode(m_pXMLDom, bstr_wsnt, m_pRoot);
-
-clean:
-	if (bstr) SysFreeString(bstr);
-	if (bstr1) SysFreeString(bstr1);
-
-	if (pi) pi->Release();
-	if (pc) pc->Release();
+	m_writer.StartElement(L"ExplorerPlusPlus");
 }
 
 void LoadSaveXML::ReleaseSaveEnvironment()
 {
-	HANDLE	hProcess;
 	TCHAR	szConfigFile[MAX_PATH];
-	DWORD	dwProcessId;
-	BSTR	bstr_wsn = SysAllocString(L"\n");
-	BSTR	bstr = nullptr;
-	VARIANT	var;
-
-	NXMLSettings::AddWhiteSpaceToNode(m_pXMLDom, bstr_wsn, m_pRoot);
 
-	m_pXMLDom->get_xml(&bstr);
+	m_writer.EndElement();
 
 	/* To ensure the configuration file is saved to the same directory
 	as the executable, determine the fully qualified path of the executable,
 	then save the configuration file in that directory. */
-	dwProcessId = GetCurrentProcessId();
-	hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, dwProcessId);
-	GetModuleFileNameEx(hProcess, nullptr, szConfigFile, SIZEOF_ARRAY(szConfigFile));
-	CloseHandle(hProcess);
-
+	GetProcessImageName(GetCurrentProcessId(), szConfigFile, SIZEOF_ARRAY(szConfigFile));
 	PathRemoveFileSpec(szConfigFile);
 	PathAppend(szConfigFile, NExplorerplusplus::XML_FILENAME);
 
-	var = NXMLSettings::VariantString(szConfigFile);
-	m_pXMLDom->save(var);
-
-	m_pRoot->Release();
-	m_pRoot = nullptr;
+	std::string data = EncodeXmlDocument(m_writer.GetDocument());
 
-	m_pXMLDom->Release();
-	m_pXMLDom = nullptr;
+	std::ofstream outputStream(szConfigFile, std::ios::binary | std::ios::trunc);
+	outputStream.write(data.data(), data.size());
 }
 
 void LoadSaveXML::LoadGenericSettings()
 {
-	m_pContainer->LoadGenericSettingsFromXML(m_pXMLDom);
+	m_pContainer->LoadGenericSettingsFromXML(m_sections);
 }
 
 void LoadSaveXML::LoadBookmarks()
 {
-	m_pContainer->LoadBookmarksFromXML(m_pXMLDom);
+	m_pContainer->LoadBookmarksFromXML(m_sections);
 }
 
 int LoadSaveXML::LoadPreviousTabs()
 {
-	return m_pContainer->LoadTabSettingsFromXML(m_pXMLDom);
+	return m_pContainer->LoadTabSettingsFromXML(m_sections);
 }
 
 void LoadSaveXML::LoadDefaultColumns()
 {
-	m_pContainer->LoadDefaultColumnsFromXML(m_pXMLDom);
+	m_pContainer->LoadDefaultColumnsFromXML(m_sections);
 }
 
 void LoadSaveXML::LoadApplicationToolbar()
 {
-	m_pContainer->LoadApplicationToolbarFromXML(m_pXMLDom);
+	m_pContainer->LoadApplicationToolbarFromXML(m_sections);
 }
 
 void LoadSaveXML::LoadToolbarInformation()
 {
-	m_pContainer->LoadToolbarInformationFromXML(m_pXMLDom);
+	m_pContainer->LoadToolbarInformationFromXML(m_sections);
 }
 
 void LoadSaveXML::LoadColorRules()
 {
-	NColorRuleHelper::LoadColorRulesFromXML(m_pXMLDom, m_pContainer->m_ColorRules);
+	NColorRuleHelper::LoadColorRulesFromXML(m_sections, m_pContainer->m_ColorRules);
 }
 
 void LoadSaveXML::LoadDialogStates()
 {
-	m_pContainer->LoadDialogStatesFromXML(m_pXMLDom);
+	m_pContainer->LoadDialogStatesFromXML(m_sections);
 }
 
 void LoadSaveXML::SaveGenericSettings()
 {
-	m_pContainer->SaveGenericSettingsToXML(m_pXMLDom, m_pRoot);
+	m_pContainer->SaveGenericSettingsToXML(m_writer);
 }
 
 void LoadSaveXML::SaveBookmarks()
 {
-	m_pContainer->SaveBookmarksToXML(m_pXMLDom, m_pRoot);
+	m_pContainer->SaveBookmarksToXML(m_writer);
 }
 
 void LoadSaveXML::SaveTabs()
 {
-	m_pContainer->SaveTabSettingsToXML(m_pXMLDom, m_pRoot);
+	m_pContainer->SaveTabSettingsToXML(m_writer);
 }
 
 void LoadSaveXML::SaveDefaultColumns()
 {
-	m_pContainer->SaveDefaultColumnsToXML(m_pXMLDom, m_pRoot);
+	m_pContainer->SaveDefaultColumnsToXML(m_writer);
 }
 
 void LoadSaveXML::SaveApplicationToolbar()
 {
-	m_pContainer->SaveApplicationToolbarToXML(m_pXMLDom, m_pRoot);
+	m_pContainer->SaveApplicationToolbarToXML(m_writer);
 }
 
 void LoadSaveXML::SaveToolbarInformation()
 {
-	m_pContainer->SaveToolbarInformationToXML(m_pXMLDom, m_pRoot);
+	m_pContainer->SaveToolbarInformationToXML(m_writer);
 }
 
 void LoadSaveXML::SaveColorRules()
 {
-	NColorRuleHelper::SaveColorRulesToXML(m_pXMLDom, m_pRoot, m_pContainer->m_ColorRules);
+	NColorRuleHelper::SaveColorRulesToXML(m_writer, m_pContainer->m_ColorRules);
 }
 
 void LoadSaveXML::SaveDialogStates()
 {
-	m_pContainer->SaveDialogStatesToXML(m_pXMLDom, m_pRoot);
+	m_pContainer->SaveDialogStatesToXML(m_writer);
 }
\ No newline at end of file
@@ -5,8 +5,8 @@
 #pragma once
 
 #include "LoadSaveInterface.h"
-#include <MsXml2.h>
-#include <objbase.h>
+#include "../Helper/XmlStream.h"
+#include <string>
 
 class Explorerplusplus;
 
@@ -40,19 +40,18 @@ public:
 private:
 
 	void	InitializeLoadEnvironment();
-	void	ReleaseLoadEnvironment();
 	void	InitializeSaveEnvironment();
 	void	ReleaseSaveEnvironment();
 
 	Explorerplusplus *m_pContainer;
 	BOOL					m_bLoad;
 
-	/* These are used for saving + loading. */
-	IXMLDOMDocument *m_pXMLDom;
-
-	/* Used exclusively for loading. */
-	BOOL					m_bLoadedCorrectly;
+	/* Used exclusively for loading. The sections
+	refer to the document, so it needs to be kept
+	around for as long as they are. */
+	std::wstring			m_document;
+	XmlSections				m_sections;
 
 	/* Used exclusively for saving. */
-	IXMLDOMElement *m_pRoot;
+	XmlStreamWriter			m_writer;
 };
\ No newline at end of file
@@ -7,36 +7,72 @@
 #include "../Helper/Logging.h"
 #include "../Helper/Macros.h"
 #include "../Helper/ProcessHelper.h"
-#include <boost/locale/generator.hpp>
-#include <boost/log/expressions.hpp>
-#include <boost/log/support/date_time.hpp>
-#include <boost/log/utility/setup/common_attributes.hpp>
-#include <boost/log/utility/setup/file.hpp>
+#include "../Helper/StringHelper.h"
+#include <fstream>
+#include <iomanip>
 
-BOOST_LOG_ATTRIBUTE_KEYWORD(severity, "Severity", SeverityLevel);
+namespace
+{
+bool g_loggingEnabled = false;
+
+void WriteLogEntry(std::ofstream &stream, const AsyncLogger::Entry &entry)
+{
+	time_t time = AsyncLogger::Clock::to_time_t(entry.time);
+	tm localTime;
+	localtime_s(&localTime, &time);
+
+	std::wostringstream line;
+	line << L"[" << std::put_time(&localTime, L"%Y-%m-%d %H:%M:%S") << L"; "
+		 << static_cast<SeverityLevel>(entry.severity) << L"]: " << entry.message << L"\n";
+
+	// The log file is written as UTF-8. It's flushed after each entry, since the
+	// logger is never destroyed (and so the file is never explicitly closed).
+	stream << wstrToStr(line.str()) << std::flush;
+}
+}
+
+void SetLoggingEnabled(bool enabled)
+{
+	g_loggingEnabled = enabled;
+}
 
 void InitializeLogging(const TCHAR *filename)
 {
+	// If logging is disabled, no logger is created and any messages that are
+	// logged will be discarded immediately.
+	if (!g_loggingEnabled)
+	{
+		return;
+	}
+
 	TCHAR szLogFile[MAX_PATH];
 	GetProcessImageName(GetCurrentProcessId(), szLogFile, SIZEOF_ARRAY(szLogFile));
 
 	PathRemoveFileSpec(szLogFile);
 	PathAppend(szLogFile, filename);
 
-	boost::log::add_common_attributes();
-
-	boost::shared_ptr<boost::log::sinks::synchronous_sink<boost::log::sinks::text_file_backend>> sink = boost::log::add_file_log(
-		boost::log::keywords::file_name = szLogFile,
-		boost::log::keywords::open_mode = std::ios_base::app,
-		boost::log::keywords::format =
-		(
-			boost::log::expressions::stream
-			<< "[" << boost::log::expressions::format_date_time<boost::posix_time::ptime>("TimeStamp", "%Y-%m-%d %H:%M:%S")
-			<< "; " << severity.or_default(info)
-			<< "]: " << boost::log::expressions::message
-			)
-	);
-
-	std::locale locale = boost::locale::generator()("en_US.UTF-8");
-	sink->imbue(locale);
+	auto stream = std::make_shared<std::ofstream>(
+		szLogFile, std::ios_base::out | std::ios_base::binary | std::ios_base::app);
+
+	if (!stream->is_open())
+	{
+		return;
+	}
+
+	// The logger is intentionally leaked. Messages can be logged right up until
+	// the process exits (e.g. from static destructors), so the logger needs to
+	// outlive everything else. ShutdownLogging() writes out any remaining
+	// messages and stops the background thread.
+	auto sink = [stream](const AsyncLogger::Entry &entry) { WriteLogEntry(*stream, entry); };
+	g_logger.store(new AsyncLogger(sink, warning), std::memory_order_release);
+}
+
+void ShutdownLogging()
+{
+	AsyncLogger *logger = g_logger.load(std::memory_order_acquire);
+
+	if (logger)
+	{
+		logger->Stop();
+	}
 }
\ No newline at end of file
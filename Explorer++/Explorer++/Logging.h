@@ -4,4 +4,8 @@
 
 #pragma once
 
-void InitializeLogging(const TCHAR *filename);
\ No newline at end of file
+// Should be called before InitializeLogging(). Logging is disabled by default.
+void SetLoggingEnabled(bool enabled);
+
+void InitializeLogging(const TCHAR *filename);
+void ShutdownLogging();
\ No newline at end of file
@@ -15,6 +15,7 @@
 #include "HelpFileMissingDialog.h"
 #include "IModelessDialogNotification.h"
 #include "MainResource.h"
+#include "MemoryUsageDialog.h"
 #include "MergeFilesDialog.h"
 #include "ModelessDialogs.h"
 #include "OptionsDialog.h"
@@ -143,6 +144,13 @@ void Explorerplusplus::OnRunScript()
 	}
 }
 
+void Explorerplusplus::OnShowMemoryUsage()
+{
+	MemoryUsageDialog memoryUsageDialog(
+		m_hLanguageModule, m_hContainer, &m_memoryAccountant, m_tabContainer);
+	memoryUsageDialog.ShowModalDialog();
+}
+
 void Explorerplusplus::OnShowOptions()
 {
 	if (g_hwndOptions == nullptr)
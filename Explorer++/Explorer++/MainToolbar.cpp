@@ -19,6 +19,7 @@
 #include "../Helper/ImageHelper.h"
 #include "../Helper/Macros.h"
 #include "../Helper/XMLSettings.h"
+#include "../Helper/XmlStream.h"
 #include <boost/bimap.hpp>
 
 // Enable C4062: enumerator 'identifier' in switch of enum 'enumeration' is not handled
@@ -882,31 +883,20 @@ MainToolbarPersistentSettings &MainToolbarPersistentSettings::GetInstance()
 	return persistentSettings;
 }
 
-void MainToolbarPersistentSettings::LoadXMLSettings(IXMLDOMNode *pNode)
+void MainToolbarPersistentSettings::LoadXMLSettings(const XmlStreamReader &reader)
 {
-	IXMLDOMNode *pChildNode = nullptr;
-	IXMLDOMNamedNodeMap *am = nullptr;
-	BSTR bstrValue;
-
 	std::vector<ToolbarButton> toolbarButtons;
 
-	pNode->get_attributes(&am);
-
-	long lChildNodes;
-	long j = 0;
-
-	/* Retrieve the total number of attributes
-	attached to this node. */
-	am->get_length(&lChildNodes);
-
-	for (j = 1; j < lChildNodes; j++)
+	for (size_t i = 0; i < reader.GetNumAttributes(); i++)
 	{
-		am->get_item(j, &pChildNode);
-
-		/* Element value. */
-		pChildNode->get_text(&bstrValue);
+		/* The name attribute identifies the setting
+		itself, so it can be skipped. */
+		if (reader.GetAttributeName(i) == L"name")
+		{
+			continue;
+		}
 
-		auto itr = TOOLBAR_BUTTON_XML_NAME_MAPPINGS.right.find(bstrValue);
+		auto itr = TOOLBAR_BUTTON_XML_NAME_MAPPINGS.right.find(reader.GetAttributeValue(i));
 
 		if (itr == TOOLBAR_BUTTON_XML_NAME_MAPPINGS.right.end())
 		{
@@ -919,7 +909,7 @@ void MainToolbarPersistentSettings::LoadXMLSettings(IXMLDOMNode *pNode)
 	m_toolbarButtons = toolbarButtons;
 }
 
-void MainToolbarPersistentSettings::SaveXMLSettings(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pe)
+void MainToolbarPersistentSettings::SaveXMLSettings(XmlStreamWriter &writer)
 {
 	int index = 0;
 
@@ -930,7 +920,7 @@ void MainToolbarPersistentSettings::SaveXMLSettings(IXMLDOMDocument *pXMLDom, IX
 
 		std::wstring buttonName = TOOLBAR_BUTTON_XML_NAME_MAPPINGS.left.at(button);
 
-		NXMLSettings::AddAttributeToNode(pXMLDom, pe, szButtonAttributeName, buttonName.c_str());
+		writer.WriteAttribute(szButtonAttributeName, buttonName);
 
 		index++;
 	}
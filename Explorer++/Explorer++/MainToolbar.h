@@ -16,6 +16,8 @@
 struct Config;
 __interface IExplorerplusplus;
 class MainToolbar;
+class XmlStreamReader;
+class XmlStreamWriter;
 
 class MainToolbarPersistentSettings
 {
@@ -23,8 +25,8 @@ public:
 
 	static MainToolbarPersistentSettings &GetInstance();
 
-	void LoadXMLSettings(IXMLDOMNode *pNode);
-	void SaveXMLSettings(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pe);
+	void LoadXMLSettings(const XmlStreamReader &reader);
+	void SaveXMLSettings(XmlStreamWriter &writer);
 
 private:
 
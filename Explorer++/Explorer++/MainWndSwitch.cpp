@@ -27,6 +27,7 @@
 #include "ShellTreeView/ShellTreeView.h"
 #include "TabBacking.h"
 #include "TabContainer.h"
+#include "TabHibernator.h"
 #include "TabRestorerUI.h"
 #include "ToolbarButtons.h"
 #include "../Helper/BulkClipboardWriter.h"
@@ -35,6 +36,7 @@
 #include "../Helper/ListViewHelper.h"
 #include "../Helper/Macros.h"
 #include "../Helper/ShellHelper.h"
+#include "../Helper/Tracing.h"
 #include "../Helper/WindowHelper.h"
 
 static const int FOLDER_SIZE_LINE_INDEX = 1;
@@ -84,6 +86,8 @@ LRESULT CALLBACK Explorerplusplus::WndProcStub(HWND hwnd,UINT Msg,WPARAM wParam,
 
 LRESULT CALLBACK Explorerplusplus::WindowProcedure(HWND hwnd,UINT Msg,WPARAM wParam,LPARAM lParam)
 {
+	TRACE_EVENT1("messages", "MainWindowMessage", "message", Msg);
+
 	switch(Msg)
 	{
 	case WM_CREATE:
@@ -116,6 +120,10 @@ LRESULT CALLBACK Explorerplusplus::WindowProcedure(HWND hwnd,UINT Msg,WPARAM wPa
 		{
 			SaveAllSettings();
 		}
+		else if (wParam == TAB_HIBERNATION_TIMER_ID)
+		{
+			m_tabHibernator->HibernateTabs();
+		}
 		else if (wParam == LISTVIEW_ITEM_CHANGED_TIMER_ID)
 		{
 			Tab &selectedTab = m_tabContainer->GetSelectedTab();
@@ -136,7 +144,9 @@ LRESULT CALLBACK Explorerplusplus::WindowProcedure(HWND hwnd,UINT Msg,WPARAM wPa
 	{
 		Tab *tab = m_tabContainer->GetTabOptional(static_cast<int>(wParam));
 
-		if (tab)
+		/* If the tab has been hibernated since the
+		changes were received, they can be ignored. */
+		if (tab && tab->IsLoaded())
 		{
 			tab->GetShellBrowser()->DirectoryAltered();
 		}
@@ -227,6 +237,10 @@ LRESULT CALLBACK Explorerplusplus::WindowProcedure(HWND hwnd,UINT Msg,WPARAM wPa
 		}
 		break;
 
+	case WM_APP_IMAGEPROPERTIESREADY:
+		OnImagePropertiesReady(static_cast<int>(wParam));
+		break;
+
 	case WM_COPYDATA:
 		{
 			auto *pcds = reinterpret_cast<COPYDATASTRUCT *>(lParam);
@@ -1172,6 +1186,8 @@ LRESULT Explorerplusplus::HandleMenuOrAccelerator(HWND hwnd, WPARAM wParam)
 			m_config->globalFolderSettings.folderColumns.realFolderColumns = currentColumns;
 		}
 
+		m_config->globalFolderSettingsSnapshot.publish(m_config->globalFolderSettings);
+
 		pShellFolder->Release();
 	}
 	break;
@@ -1291,6 +1307,10 @@ LRESULT Explorerplusplus::HandleMenuOrAccelerator(HWND hwnd, WPARAM wParam)
 		OnRunScript();
 		break;
 
+	case IDM_TOOLS_MEMORYUSAGE:
+		OnShowMemoryUsage();
+		break;
+
 	case IDM_TOOLS_OPTIONS:
 		OnShowOptions();
 		break;
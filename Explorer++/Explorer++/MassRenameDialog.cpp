@@ -23,6 +23,7 @@
 #include "../Helper/Macros.h"
 #include "../Helper/RegistrySettings.h"
 #include "../Helper/XMLSettings.h"
+#include "../Helper/XmlStream.h"
 #include <boost/algorithm/string.hpp>
 #include <iomanip>
 #include <list>
@@ -420,23 +421,21 @@ void MassRenameDialogPersistentSettings::LoadExtraRegistrySettings(HKEY hKey)
 		hKey, SETTING_COLUMN_WIDTH_2, reinterpret_cast<DWORD *>(&m_iColumnWidth2));
 }
 
-void MassRenameDialogPersistentSettings::SaveExtraXMLSettings(
-	IXMLDOMDocument *pXMLDom, IXMLDOMElement *pParentNode)
+void MassRenameDialogPersistentSettings::SaveExtraXMLSettings(XmlStreamWriter &writer)
 {
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_COLUMN_WIDTH_1,
-		NXMLSettings::EncodeIntValue(m_iColumnWidth1));
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_COLUMN_WIDTH_2,
-		NXMLSettings::EncodeIntValue(m_iColumnWidth2));
+	writer.WriteAttribute(SETTING_COLUMN_WIDTH_1, NXMLSettings::EncodeIntValue(m_iColumnWidth1));
+	writer.WriteAttribute(SETTING_COLUMN_WIDTH_2, NXMLSettings::EncodeIntValue(m_iColumnWidth2));
 }
 
-void MassRenameDialogPersistentSettings::LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue)
+void MassRenameDialogPersistentSettings::LoadExtraXMLSettings(
+	const WCHAR *wszName, const WCHAR *wszValue)
 {
-	if (lstrcmpi(bstrName, SETTING_COLUMN_WIDTH_1) == 0)
+	if (lstrcmpi(wszName, SETTING_COLUMN_WIDTH_1) == 0)
 	{
-		m_iColumnWidth1 = NXMLSettings::DecodeIntValue(bstrValue);
+		m_iColumnWidth1 = NXMLSettings::DecodeIntValue(wszValue);
 	}
-	else if (lstrcmpi(bstrName, SETTING_COLUMN_WIDTH_2) == 0)
+	else if (lstrcmpi(wszName, SETTING_COLUMN_WIDTH_2) == 0)
 	{
-		m_iColumnWidth2 = NXMLSettings::DecodeIntValue(bstrValue);
+		m_iColumnWidth2 = NXMLSettings::DecodeIntValue(wszValue);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,144 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "MemoryUsageDialog.h"
+#include "MainResource.h"
+#include "ResourceHelper.h"
+#include "Tab.h"
+#include "TabContainer.h"
+#include "../Helper/Macros.h"
+#include "../Helper/MemoryAccounting.h"
+#include "../Helper/StringHelper.h"
+#include "../Helper/WindowHelper.h"
+
+MemoryUsageDialog::MemoryUsageDialog(HINSTANCE instance, HWND parent,
+	const MemoryAccountant *memoryAccountant, TabContainer *tabContainer) :
+	DarkModeDialogBase(instance, IDD_MEMORY_USAGE, parent, false),
+	m_memoryAccountant(memoryAccountant),
+	m_tabContainer(tabContainer)
+{
+}
+
+INT_PTR MemoryUsageDialog::OnInitDialog()
+{
+	HWND listView = GetDlgItem(m_hDlg, IDC_MEMORY_USAGE_LISTVIEW);
+	SetWindowTheme(listView, L"Explorer", nullptr);
+	ListView_SetExtendedListViewStyleEx(listView, LVS_EX_FULLROWSELECT, LVS_EX_FULLROWSELECT);
+
+	InsertColumn(listView, 0, IDS_MEMORY_USAGE_COLUMN_TAB, LVCFMT_LEFT);
+	InsertColumn(listView, 1, IDS_MEMORY_USAGE_COLUMN_COMPONENT, LVCFMT_LEFT);
+	InsertColumn(listView, 2, IDS_MEMORY_USAGE_COLUMN_MEMORY, LVCFMT_RIGHT);
+
+	RefreshEntries();
+
+	AllowDarkModeForListView(IDC_MEMORY_USAGE_LISTVIEW);
+	AllowDarkModeForControls({ IDC_MEMORY_USAGE_REFRESH });
+
+	CenterWindow(GetParent(m_hDlg), m_hDlg);
+
+	return TRUE;
+}
+
+void MemoryUsageDialog::InsertColumn(HWND listView, int index, UINT stringId, int format)
+{
+	std::wstring text = ResourceHelper::LoadString(GetInstance(), stringId);
+
+	LVCOLUMN lvColumn;
+	lvColumn.mask = LVCF_TEXT | LVCF_FMT;
+	lvColumn.pszText = text.data();
+	lvColumn.fmt = format;
+	ListView_InsertColumn(listView, index, &lvColumn);
+}
+
+void MemoryUsageDialog::RefreshEntries()
+{
+	HWND listView = GetDlgItem(m_hDlg, IDC_MEMORY_USAGE_LISTVIEW);
+
+	SendMessage(listView, WM_SETREDRAW, FALSE, 0);
+	ListView_DeleteAllItems(listView);
+
+	std::wstring sharedText = ResourceHelper::LoadString(GetInstance(), IDS_MEMORY_USAGE_SHARED);
+	size_t totalBytes = 0;
+
+	for (const auto &entry : m_memoryAccountant->GetEntries())
+	{
+		std::wstring tabName = sharedText;
+
+		if (entry.tabId)
+		{
+			// Sources are registered by the objects that own the memory, so
+			// there may briefly be entries for a tab that's in the process of
+			// being closed.
+			const Tab *tab = m_tabContainer->GetTabOptional(*entry.tabId);
+
+			if (!tab)
+			{
+				continue;
+			}
+
+			tabName = tab->GetName();
+		}
+
+		InsertEntry(listView, tabName, entry.category, entry.bytes);
+		totalBytes += entry.bytes;
+	}
+
+	InsertEntry(listView, ResourceHelper::LoadString(GetInstance(), IDS_MEMORY_USAGE_TOTAL), L"",
+		totalBytes);
+
+	for (int i = 0; i < 3; i++)
+	{
+		ListView_SetColumnWidth(listView, i, LVSCW_AUTOSIZE_USEHEADER);
+	}
+
+	SendMessage(listView, WM_SETREDRAW, TRUE, 0);
+}
+
+void MemoryUsageDialog::InsertEntry(
+	HWND listView, const std::wstring &tabName, const std::wstring &category, size_t bytes)
+{
+	std::wstring tabNameCopy = tabName;
+
+	LVITEM lvItem;
+	lvItem.mask = LVIF_TEXT;
+	lvItem.iItem = ListView_GetItemCount(listView);
+	lvItem.iSubItem = 0;
+	lvItem.pszText = tabNameCopy.data();
+	int index = ListView_InsertItem(listView, &lvItem);
+
+	std::wstring categoryCopy = category;
+	ListView_SetItemText(listView, index, 1, categoryCopy.data());
+
+	TCHAR sizeText[32];
+	ULARGE_INTEGER size;
+	size.QuadPart = bytes;
+	FormatSizeString(size, sizeText, SIZEOF_ARRAY(sizeText));
+	ListView_SetItemText(listView, index, 2, sizeText);
+}
+
+INT_PTR MemoryUsageDialog::OnCommand(WPARAM wParam, LPARAM lParam)
+{
+	UNREFERENCED_PARAMETER(lParam);
+
+	switch (LOWORD(wParam))
+	{
+	case IDC_MEMORY_USAGE_REFRESH:
+		RefreshEntries();
+		break;
+
+	case IDOK:
+	case IDCANCEL:
+		EndDialog(m_hDlg, 0);
+		break;
+	}
+
+	return 0;
+}
+
+INT_PTR MemoryUsageDialog::OnClose()
+{
+	EndDialog(m_hDlg, 0);
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "DarkModeDialogBase.h"
+
+class MemoryAccountant;
+class TabContainer;
+
+// Lists the memory used by each tab and by the shared parts of the
+// application (e.g. the caches), as reported to the MemoryAccountant.
+class MemoryUsageDialog : public DarkModeDialogBase
+{
+public:
+	MemoryUsageDialog(HINSTANCE instance, HWND parent, const MemoryAccountant *memoryAccountant,
+		TabContainer *tabContainer);
+
+protected:
+	INT_PTR OnInitDialog() override;
+	INT_PTR OnCommand(WPARAM wParam, LPARAM lParam) override;
+	INT_PTR OnClose() override;
+
+private:
+	void InsertColumn(HWND listView, int index, UINT stringId, int format);
+	void RefreshEntries();
+	void InsertEntry(HWND listView, const std::wstring &tabName, const std::wstring &category,
+		size_t bytes);
+
+	const MemoryAccountant *m_memoryAccountant;
+	TabContainer *m_tabContainer;
+};
\ No newline at end of file
@@ -259,6 +259,11 @@ LRESULT Explorerplusplus::OnDeviceChange(WPARAM wParam, LPARAM lParam)
 	update its contents). */
 	for (auto &tab : m_tabContainer->GetAllTabs() | boost::adaptors::map_values)
 	{
+		if (!tab->IsLoaded())
+		{
+			continue;
+		}
+
 		tab->GetShellBrowser()->OnDeviceChange(wParam, lParam);
 	}
 
@@ -308,7 +313,10 @@ void Explorerplusplus::DirectoryAlteredCallback(
 
 	Tab *tab = pContainer->m_tabContainer->GetTabOptional(pDirectoryAltered->iIndex);
 
-	if (tab)
+	// A notification may still arrive after a tab has been hibernated (and
+	// its directory monitor stopped). It's not necessary to reload the tab in
+	// that case, since the folder will be revalidated when it's reloaded.
+	if (tab && tab->IsLoaded())
 	{
 		std::wstring directory = tab->GetShellBrowser()->GetDirectory();
 		LOG(debug) << _T("Directory change notification received for \"") << directory
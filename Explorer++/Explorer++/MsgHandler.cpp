@@ -38,6 +38,8 @@
 #include <boost/range/adaptor/map.hpp>
 #include <wil/resource.h>
 #include <algorithm>
+#include <filesystem>
+#include <fstream>
 
 /* The treeview is offset by a small
 amount on the left. */
@@ -107,7 +109,11 @@ void Explorerplusplus::LoadAllSettings(ILoadSave **pLoadSave)
 		*pLoadSave = new LoadSaveRegistry(this);
 	}
 
-	(*pLoadSave)->LoadBookmarks();
+	if (!LoadBookmarksSnapshot())
+	{
+		(*pLoadSave)->LoadBookmarks();
+	}
+
 	(*pLoadSave)->LoadGenericSettings();
 	(*pLoadSave)->LoadDefaultColumns();
 	(*pLoadSave)->LoadApplicationToolbar();
@@ -116,6 +122,103 @@ void Explorerplusplus::LoadAllSettings(ILoadSave **pLoadSave)
 	(*pLoadSave)->LoadDialogStates();
 
 	ValidateLoadedSettings();
+
+	m_config->globalFolderSettingsSnapshot.publish(m_config->globalFolderSettings);
+}
+
+void Explorerplusplus::LoadIconCache()
+{
+	std::ifstream inputStream(
+		GetCacheFilePath(NExplorerplusplus::ICON_CACHE_FILENAME), std::ios::binary);
+
+	if (!inputStream)
+	{
+		return;
+	}
+
+	m_cachedIcons.load(inputStream);
+}
+
+void Explorerplusplus::SaveIconCache()
+{
+	std::ofstream outputStream(GetCacheFilePath(NExplorerplusplus::ICON_CACHE_FILENAME),
+		std::ios::binary | std::ios::trunc);
+
+	if (!outputStream)
+	{
+		return;
+	}
+
+	m_cachedIcons.save(outputStream);
+}
+
+// The bookmarks are still saved to the registry/config file (which remain the
+// format used to import and export them), so the snapshot is only used if it's
+// at least as recent as the config file. That way, changes made to the config
+// file by hand (or by another version of the application) aren't ignored.
+// There's no equivalent way of telling whether the bookmarks in the registry
+// have changed, so the snapshot isn't used at all when loading from the
+// registry.
+bool Explorerplusplus::LoadBookmarksSnapshot()
+{
+	if (!m_bLoadSettingsFromXML)
+	{
+		return false;
+	}
+
+	std::filesystem::path snapshotPath =
+		GetCacheFilePath(NExplorerplusplus::BOOKMARKS_SNAPSHOT_FILENAME);
+
+	std::error_code errorCode;
+	auto snapshotTime = std::filesystem::last_write_time(snapshotPath, errorCode);
+
+	if (errorCode)
+	{
+		return false;
+	}
+
+	auto configFileTime = std::filesystem::last_write_time(
+		GetCacheFilePath(NExplorerplusplus::XML_FILENAME), errorCode);
+
+	if (errorCode || snapshotTime < configFileTime)
+	{
+		return false;
+	}
+
+	return m_bookmarkBinaryStorage.Load(snapshotPath);
+}
+
+void Explorerplusplus::SaveBookmarksSnapshot()
+{
+	// The snapshot is only ever loaded alongside the config file.
+	if (!m_bSavePreferencesToXMLFile)
+	{
+		return;
+	}
+
+	m_bookmarkBinaryStorage.Save(GetCacheFilePath(NExplorerplusplus::BOOKMARKS_SNAPSHOT_FILENAME));
+}
+
+void Explorerplusplus::CreateThumbnailDiskCache()
+{
+	m_thumbnailDiskCache = std::make_unique<ThumbnailDiskCache>(
+		GetCacheFilePath(NExplorerplusplus::THUMBNAIL_CACHE_PACK_FILENAME),
+		GetCacheFilePath(NExplorerplusplus::THUMBNAIL_CACHE_INDEX_FILENAME),
+		static_cast<uint64_t>(m_config->thumbnailDiskCacheSize) * 1024 * 1024);
+}
+
+/* As with the config file, the icon and thumbnail
+caches are stored in the same directory as the
+executable. */
+std::wstring Explorerplusplus::GetCacheFilePath(const TCHAR *fileName)
+{
+	TCHAR cacheFile[MAX_PATH];
+	GetProcessImageName(GetCurrentProcessId(), cacheFile, SIZEOF_ARRAY(cacheFile));
+
+	PathRemoveFileSpec(cacheFile);
+	PathAppend(cacheFile, fileName);
+
+	return cacheFile;
 }
 
 void Explorerplusplus::OpenItem(const TCHAR *szItem, BOOL bOpenInNewTab, BOOL bOpenInNewWindow)
@@ -482,6 +585,13 @@ BOOL Explorerplusplus::OnSize(int MainWindowWidth, int MainWindowHeight)
 
 	for (auto &tab : m_tabContainer->GetAllTabs() | boost::adaptors::map_values)
 	{
+		// Unloaded tabs have no listview. The listview will be positioned
+		// when the tab is loaded.
+		if (!tab->IsLoaded())
+		{
+			continue;
+		}
+
 		uFlags = SWP_NOZORDER;
 
 		if (m_tabContainer->IsTabSelected(*tab))
@@ -592,9 +702,15 @@ int Explorerplusplus::OnClose()
 	m_pluginManager.reset();
 
 	KillTimer(m_hContainer, AUTOSAVE_TIMER_ID);
+	KillTimer(m_hContainer, TAB_HIBERNATION_TIMER_ID);
 
 	SaveAllSettings();
 
+	if (m_config->persistIconCache)
+	{
+		SaveIconCache();
+	}
+
 	DestroyWindow(m_hContainer);
 
 	return 0;
@@ -1157,6 +1273,11 @@ void Explorerplusplus::OnAssocChanged()
 	/* Now, go through each tab, and refresh each icon. */
 	for (auto &tab : m_tabContainer->GetAllTabs() | boost::adaptors::map_values)
 	{
+		if (!tab->IsLoaded())
+		{
+			continue;
+		}
+
 		tab->GetShellBrowser()->GetNavigationController()->Refresh();
 	}
 
@@ -1379,6 +1500,11 @@ void Explorerplusplus::SaveAllSettings()
 	pLoadSave->SaveDialogStates();
 
 	delete pLoadSave;
+
+	// The config file is written when pLoadSave is destroyed. The snapshot needs
+	// to be written after that, so that it's treated as current when it's next
+	// loaded.
+	SaveBookmarksSnapshot();
 }
 
 const Config *Explorerplusplus::GetConfig() const
@@ -1441,6 +1567,36 @@ CachedIcons *Explorerplusplus::GetCachedIcons()
 	return &m_cachedIcons;
 }
 
+FolderListingCache *Explorerplusplus::GetFolderListingCache()
+{
+	return &m_folderListingCache;
+}
+
+FolderPrefetcher *Explorerplusplus::GetFolderPrefetcher()
+{
+	return &m_folderPrefetcher;
+}
+
+ctpl::thread_pool *Explorerplusplus::GetGroupingThreadPool()
+{
+	return &m_groupingThreadPool;
+}
+
+IconResolutionService *Explorerplusplus::GetIconResolutionService()
+{
+	return &m_iconResolutionService;
+}
+
+ThumbnailDiskCache *Explorerplusplus::GetThumbnailDiskCache()
+{
+	return m_thumbnailDiskCache.get();
+}
+
+MemoryAccountant *Explorerplusplus::GetMemoryAccountant()
+{
+	return &m_memoryAccountant;
+}
+
 BOOL Explorerplusplus::GetSavePreferencesToXmlFile() const
 {
 	return m_bSavePreferencesToXMLFile;
@@ -44,7 +44,7 @@ void Navigation::OnNavigateUp()
 
 	if (SUCCEEDED(hr))
 	{
-		const Tab &resultingTab = m_tabContainer->GetTab(resultingTabId);
+		Tab &resultingTab = m_tabContainer->GetTab(resultingTabId);
 		std::wstring directory = resultingTab.GetShellBrowser()->GetDirectory();
 
 		TCHAR directoryFileName[MAX_PATH];
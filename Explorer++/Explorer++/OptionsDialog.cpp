@@ -858,8 +858,15 @@ INT_PTR CALLBACK OptionsDialog::FilesFoldersProc(HWND hDlg, UINT uMsg, WPARAM wP
 			m_config->globalFolderSettings.sizeDisplayFormat =
 				(SizeDisplayFormat) SendMessage(hCBSize, CB_GETITEMDATA, iSel, 0);
 
+			m_config->globalFolderSettingsSnapshot.publish(m_config->globalFolderSettings);
+
 			for (auto &tab : m_tabContainer->GetAllTabs() | boost::adaptors::map_values)
 			{
+				if (!tab->IsLoaded())
+				{
+					continue;
+				}
+
 				tab->GetShellBrowser()->GetNavigationController()->Refresh();
 
 				ListViewHelper::ActivateOneClickSelect(tab->GetShellBrowser()->GetListView(),
@@ -1089,6 +1096,7 @@ INT_PTR CALLBACK OptionsDialog::WindowProc(HWND hDlg, UINT uMsg, WPARAM wParam,
 
 			m_config->globalFolderSettings.showGridlines =
 				(IsDlgButtonChecked(hDlg, IDC_OPTION_GRIDLINES) == BST_CHECKED);
+			m_config->globalFolderSettingsSnapshot.publish(m_config->globalFolderSettings);
 
 			bCheckBoxSelection =
 				(IsDlgButtonChecked(hDlg, IDC_OPTION_CHECKBOXSELECTION) == BST_CHECKED);
@@ -1097,6 +1105,11 @@ INT_PTR CALLBACK OptionsDialog::WindowProc(HWND hDlg, UINT uMsg, WPARAM wParam,
 			{
 				for (auto &tab : m_tabContainer->GetAllTabs() | boost::adaptors::map_values)
 				{
+					if (!tab->IsLoaded())
+					{
+						continue;
+					}
+
 					auto dwExtendedStyle =
 						ListView_GetExtendedListViewStyle(tab->GetShellBrowser()->GetListView());
 
@@ -1125,6 +1138,11 @@ INT_PTR CALLBACK OptionsDialog::WindowProc(HWND hDlg, UINT uMsg, WPARAM wParam,
 
 			for (auto &tab : m_tabContainer->GetAllTabs() | boost::adaptors::map_values)
 			{
+				if (!tab->IsLoaded())
+				{
+					continue;
+				}
+
 				/* TODO: The tab should monitor for settings
 				changes itself. */
 				tab->GetShellBrowser()->OnGridlinesSettingChanged();
@@ -1411,6 +1429,8 @@ INT_PTR CALLBACK OptionsDialog::DefaultSettingsProc(
 				SetDefaultColumnsDialog setDefaultColumnsDialog(
 					m_instance, hDlg, m_config->globalFolderSettings.folderColumns);
 				setDefaultColumnsDialog.ShowModalDialog();
+
+				m_config->globalFolderSettingsSnapshot.publish(m_config->globalFolderSettings);
 			}
 			break;
 			}
@@ -5,6 +5,7 @@
 #include "stdafx.h"
 #include "Plugins/ApiBinding.h"
 #include "Plugins/CommandApi/Events/CommandInvoked.h"
+#include "Plugins/DiagnosticsApi.h"
 #include "Plugins/MenuApi.h"
 #include "Plugins/PluginMenuManager.h"
 #include "Plugins/TabsApi/Events/TabCreated.h"
@@ -15,6 +16,7 @@
 #include "Plugins/UiApi.h"
 #include "ShellBrowser/SortModes.h"
 #include "ShellBrowser/ViewModes.h"
+#include "CoreInterface.h"
 #include "SolWrapper.h"
 #include "TabContainer.h"
 #include "UiTheming.h"
@@ -23,6 +25,7 @@ void BindTabsAPI(sol::state &state, IExplorerplusplus *expp, TabContainer *tabCo
 void BindMenuApi(sol::state &state, Plugins::PluginMenuManager *pluginMenuManager);
 void BindUiApi(sol::state &state, UiTheming *uiTheming);
 void BindCommandApi(int pluginId, sol::state &state, Plugins::PluginCommandManager *pluginCommandManager);
+void BindDiagnosticsApi(sol::state &state, const MemoryAccountant *memoryAccountant);
 template<typename T>
 void BindObserverMethods(sol::state &state, sol::table &parentTable, const std::string &observerTableName, const std::shared_ptr<T> &object);
 template<typename T>
@@ -36,6 +39,7 @@ void Plugins::BindAllApiMethods(int pluginId, sol::state &state, PluginInterface
 	BindMenuApi(state, pluginInterface->GetPluginMenuManager());
 	BindUiApi(state, pluginInterface->GetUiTheming());
 	BindCommandApi(pluginId, state, pluginInterface->GetPluginCommandManager());
+	BindDiagnosticsApi(state, pluginInterface->GetCoreInterface()->GetMemoryAccountant());
 }
 
 void BindTabsAPI(sol::state &state, IExplorerplusplus *expp, TabContainer *tabContainer)
@@ -113,6 +117,22 @@ void BindCommandApi(int pluginId, sol::state &state, Plugins::PluginCommandManag
 	BindObserverMethods(state, commandsMetaTable, "onCommand", commandInvoked);
 }
 
+void BindDiagnosticsApi(sol::state &state, const MemoryAccountant *memoryAccountant)
+{
+	std::shared_ptr<Plugins::DiagnosticsApi> diagnosticsApi = std::make_shared<Plugins::DiagnosticsApi>(memoryAccountant);
+
+	sol::table diagnosticsTable = state.create_named_table("diagnostics");
+	sol::table metaTable = MarkTableReadOnly(state, diagnosticsTable);
+
+	metaTable.set_function("getMemoryUsage", &Plugins::DiagnosticsApi::getMemoryUsage, diagnosticsApi);
+
+	metaTable.new_usertype<Plugins::DiagnosticsApi::MemoryUsage>("MemoryUsage",
+		"category", &Plugins::DiagnosticsApi::MemoryUsage::category,
+		"tabId", &Plugins::DiagnosticsApi::MemoryUsage::tabId,
+		"bytes", &Plugins::DiagnosticsApi::MemoryUsage::bytes,
+		"__tostring", &Plugins::DiagnosticsApi::MemoryUsage::toString);
+}
+
 template<typename T>
 void BindObserverMethods(sol::state &state, sol::table &parentTable, const std::string &observerTableName, const std::shared_ptr<T> &object)
 {
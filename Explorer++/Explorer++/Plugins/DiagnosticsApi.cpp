@@ -0,0 +1,40 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "Plugins/DiagnosticsApi.h"
+#include "../Helper/MemoryAccounting.h"
+
+Plugins::DiagnosticsApi::MemoryUsage::MemoryUsage(const MemoryUsageEntry &entry) :
+	category(entry.category),
+	tabId(entry.tabId),
+	bytes(entry.bytes)
+{
+
+}
+
+std::wstring Plugins::DiagnosticsApi::MemoryUsage::toString()
+{
+	return _T("category = ") + category
+		+ _T(", tabId = ") + (tabId ? std::to_wstring(*tabId) : _T("nil"))
+		+ _T(", bytes = ") + std::to_wstring(bytes);
+}
+
+Plugins::DiagnosticsApi::DiagnosticsApi(const MemoryAccountant *memoryAccountant) :
+	m_memoryAccountant(memoryAccountant)
+{
+
+}
+
+std::vector<Plugins::DiagnosticsApi::MemoryUsage> Plugins::DiagnosticsApi::getMemoryUsage()
+{
+	std::vector<MemoryUsage> memoryUsage;
+
+	for (const auto &entry : m_memoryAccountant->GetEntries())
+	{
+		memoryUsage.emplace_back(entry);
+	}
+
+	return memoryUsage;
+}
\ No newline at end of file
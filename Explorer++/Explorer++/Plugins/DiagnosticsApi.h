@@ -0,0 +1,41 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+class MemoryAccountant;
+struct MemoryUsageEntry;
+
+namespace Plugins
+{
+	class DiagnosticsApi
+	{
+	public:
+
+		struct MemoryUsage
+		{
+			std::wstring category;
+
+			// Empty for memory that's shared between tabs.
+			std::optional<int> tabId;
+
+			size_t bytes;
+
+			MemoryUsage(const MemoryUsageEntry &entry);
+			std::wstring toString();
+		};
+
+		DiagnosticsApi(const MemoryAccountant *memoryAccountant);
+
+		std::vector<MemoryUsage> getMemoryUsage();
+
+	private:
+
+		const MemoryAccountant *m_memoryAccountant;
+	};
+}
\ No newline at end of file
@@ -5,19 +5,26 @@
 #include "stdafx.h"
 #include "Plugins/LuaPlugin.h"
 #include "Plugins/ApiBinding.h"
+#include "CoreInterface.h"
 #include "SolWrapper.h"
 
 int Plugins::LuaPlugin::idCounter = 1;
 
 inline int onPanic(lua_State *L);
+void *luaAllocate(void *userData, void *ptr, size_t oldSize, size_t newSize);
 
 Plugins::LuaPlugin::LuaPlugin(const std::wstring &directory, const Manifest &manifest,
 	PluginInterface *pluginInterface) :
 	m_directory(directory),
 	m_manifest(manifest),
-	m_lua(onPanic),
+	m_lua(onPanic, luaAllocate, &m_memoryCounter),
 	m_id(idCounter++)
 {
+	// The scripting dialog creates a plugin without a manifest.
+	std::wstring category = manifest.name.empty() ? L"Lua scripts" : L"Plugin: " + manifest.name;
+	MemoryAccountant *memoryAccountant = pluginInterface->GetCoreInterface()->GetMemoryAccountant();
+	m_memoryRegistration = memoryAccountant->AddCounter(category, std::nullopt, &m_memoryCounter);
+
 	BindAllApiMethods(m_id, m_lua, pluginInterface);
 }
 
@@ -41,6 +48,11 @@ sol::state &Plugins::LuaPlugin::GetLuaState()
 	return m_lua;
 }
 
+void *luaAllocate(void *userData, void *ptr, size_t oldSize, size_t newSize)
+{
+	return CountingRealloc(static_cast<MemoryCounter *>(userData), ptr, oldSize, newSize);
+}
+
 inline int onPanic(lua_State *L)
 {
 	UNREFERENCED_PARAMETER(L);
@@ -6,6 +6,7 @@
 
 #include "PluginInterface.h"
 #include "Plugins/Manifest.h"
+#include "../Helper/MemoryAccounting.h"
 #include "../ThirdParty/Sol/forward.hpp"
 
 namespace Plugins
@@ -30,8 +31,13 @@ namespace Plugins
 		std::wstring m_directory;
 		Manifest m_manifest;
 
+		// All allocations made by the Lua state go through this counter, so
+		// it needs to be declared before the state.
+		MemoryCounter m_memoryCounter;
 		sol::state m_lua;
 		const int m_id;
+
+		MemoryAccountant::Registration m_memoryRegistration;
 	};
 
 	class LuaPanicException : public std::runtime_error
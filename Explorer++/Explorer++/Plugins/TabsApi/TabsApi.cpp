@@ -15,14 +15,14 @@
 #include "SolWrapper.h"
 #include "TabContainer.h"
 
-Plugins::TabsApi::FolderSettings::FolderSettings(const ShellBrowser &shellBrowser)
+Plugins::TabsApi::FolderSettings::FolderSettings(const ::FolderSettings &folderSettings) :
+	sortMode(folderSettings.sortMode),
+	viewMode(folderSettings.viewMode)
 {
-	sortMode = shellBrowser.GetSortMode();
-	viewMode = shellBrowser.GetViewMode();
-	sortAscending = shellBrowser.GetSortAscending();
-	showInGroups = shellBrowser.GetShowInGroups();
-	showHidden = shellBrowser.GetShowHidden();
-	autoArrange = shellBrowser.GetAutoArrange();
+	sortAscending = folderSettings.sortAscending;
+	showInGroups = folderSettings.showInGroups;
+	showHidden = folderSettings.showHidden;
+	autoArrange = folderSettings.autoArrange;
 }
 
 std::wstring Plugins::TabsApi::FolderSettings::toString()
@@ -36,10 +36,10 @@ std::wstring Plugins::TabsApi::FolderSettings::toString()
 }
 
 Plugins::TabsApi::Tab::Tab(const ::Tab &tabInternal) :
-	folderSettings(*tabInternal.GetShellBrowser())
+	folderSettings(tabInternal.GetFolderSettings())
 {
 	id = tabInternal.GetId();
-	location = tabInternal.GetShellBrowser()->GetDirectory();
+	location = tabInternal.GetDirectory();
 	name = tabInternal.GetName();
 	locked = (tabInternal.GetLockState() == ::Tab::LockState::Locked);
 	addressLocked = (tabInternal.GetLockState() == ::Tab::LockState::AddressLocked);
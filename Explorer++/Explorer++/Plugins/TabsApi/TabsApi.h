@@ -13,7 +13,6 @@
 
 __interface IExplorerplusplus;
 class Navigation;
-class ShellBrowser;
 class TabContainer;
 struct TabSettings;
 
@@ -31,7 +30,7 @@ namespace Plugins
 			bool showHidden;
 			bool autoArrange;
 
-			FolderSettings(const ShellBrowser &shellBrowser);
+			FolderSettings(const ::FolderSettings &folderSettings);
 			std::wstring toString();
 		};
 
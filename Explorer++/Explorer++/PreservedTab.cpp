@@ -4,6 +4,7 @@
 
 #include "stdafx.h"
 #include "PreservedTab.h"
+#include "ShellBrowser/HistoryEntry.h"
 #include "ShellBrowser/PreservedHistoryEntry.h"
 #include "ShellBrowser/ShellBrowser.h"
 #include "ShellBrowser/ShellNavigationController.h"
@@ -12,11 +13,13 @@ PreservedTab::PreservedTab(const Tab &tab, int index) :
 	id(tab.GetId()),
 	index(index),
 	history(CopyHistoryEntries(tab)),
-	currentEntry(tab.GetShellBrowser()->GetNavigationController()->GetCurrentIndex()),
+	currentEntry(tab.IsLoaded()
+			? tab.GetShellBrowser()->GetNavigationController()->GetCurrentIndex()
+			: tab.GetPreservedCurrentEntry()),
 	useCustomName(tab.GetUseCustomName()),
 	customName(tab.GetUseCustomName() ? tab.GetName() : std::wstring()),
 	lockState(tab.GetLockState()),
-	preservedFolderState(tab.GetShellBrowser())
+	preservedFolderState(tab.GetFolderSettings())
 {
 }
 
@@ -26,6 +29,36 @@ std::vector<std::unique_ptr<PreservedHistoryEntry>> PreservedTab::CopyHistoryEnt
 {
 	std::vector<std::unique_ptr<PreservedHistoryEntry>> history;
 
+	if (!tab.IsLoaded())
+	{
+		// A hibernated tab still has the history it had before it was
+		// unloaded.
+		const auto &preservedHistory = tab.GetPreservedHistory();
+
+		if (!preservedHistory.empty())
+		{
+			for (const auto &preservedEntry : preservedHistory)
+			{
+				history.push_back(
+					std::make_unique<PreservedHistoryEntry>(HistoryEntry(*preservedEntry)));
+			}
+
+			return history;
+		}
+
+		// A tab that was never loaded has no history, beyond the directory it
+		// was created in.
+		auto pidlDirectory = tab.GetDirectoryIdl();
+
+		TCHAR displayName[MAX_PATH];
+		GetDisplayName(pidlDirectory.get(), displayName, SIZEOF_ARRAY(displayName), SHGDN_INFOLDER);
+
+		history.push_back(std::make_unique<PreservedHistoryEntry>(
+			HistoryEntry(pidlDirectory.get(), displayName)));
+
+		return history;
+	}
+
 	for (int i = 0; i < tab.GetShellBrowser()->GetNavigationController()->GetNumHistoryEntries();
 		 i++)
 	{
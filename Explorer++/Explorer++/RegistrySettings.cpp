@@ -140,6 +140,14 @@ LONG Explorerplusplus::SaveGenericSettingsToRegistry()
 		NRegistrySettings::SaveDwordToRegistry(hSettingsKey,_T("OverwriteExistingFilesConfirmation"),m_config->overwriteExistingFilesConfirmation);
 		NRegistrySettings::SaveDwordToRegistry(hSettingsKey,_T("LargeToolbarIcons"),m_config->useLargeToolbarIcons.get());
 		NRegistrySettings::SaveDwordToRegistry(hSettingsKey,_T("PlayNavigationSound"),m_config->playNavigationSound);
+		NRegistrySettings::SaveDwordToRegistry(hSettingsKey,_T("PrefetchFolders"),m_config->prefetchFolders);
+		NRegistrySettings::SaveDwordToRegistry(hSettingsKey,_T("PersistIconCache"),m_config->persistIconCache);
+		NRegistrySettings::SaveDwordToRegistry(hSettingsKey,_T("EnableTracing"),m_config->enableTracing);
+		NRegistrySettings::SaveDwordToRegistry(hSettingsKey,_T("ThumbnailCacheSize"),m_config->thumbnailCacheSize);
+		NRegistrySettings::SaveDwordToRegistry(hSettingsKey,_T("ThumbnailDiskCacheSize"),m_config->thumbnailDiskCacheSize);
+		NRegistrySettings::SaveDwordToRegistry(hSettingsKey,_T("ThumbnailSize"),m_config->thumbnailSize);
+		NRegistrySettings::SaveDwordToRegistry(hSettingsKey,_T("TabHibernationIdleTimeout"),m_config->tabHibernationIdleTimeout);
+		NRegistrySettings::SaveDwordToRegistry(hSettingsKey,_T("TabHibernationMemoryBudget"),m_config->tabHibernationMemoryBudget);
 
 		NRegistrySettings::SaveStringToRegistry(hSettingsKey,_T("NewTabDirectory"), m_config->defaultTabDirectory.c_str());
 
@@ -292,6 +300,14 @@ LONG Explorerplusplus::LoadGenericSettingsFromRegistry()
 		m_config->useLargeToolbarIcons.set(numericValue);
 
 		NRegistrySettings::ReadDwordFromRegistry(hSettingsKey,_T("PlayNavigationSound"),(LPDWORD)&m_config->playNavigationSound);
+		NRegistrySettings::ReadDwordFromRegistry(hSettingsKey,_T("PrefetchFolders"),(LPDWORD)&m_config->prefetchFolders);
+		NRegistrySettings::ReadDwordFromRegistry(hSettingsKey,_T("PersistIconCache"),(LPDWORD)&m_config->persistIconCache);
+		NRegistrySettings::ReadDwordFromRegistry(hSettingsKey,_T("EnableTracing"),(LPDWORD)&m_config->enableTracing);
+		NRegistrySettings::ReadDwordFromRegistry(hSettingsKey,_T("ThumbnailCacheSize"),(LPDWORD)&m_config->thumbnailCacheSize);
+		NRegistrySettings::ReadDwordFromRegistry(hSettingsKey,_T("ThumbnailDiskCacheSize"),(LPDWORD)&m_config->thumbnailDiskCacheSize);
+		NRegistrySettings::ReadDwordFromRegistry(hSettingsKey,_T("ThumbnailSize"),(LPDWORD)&m_config->thumbnailSize);
+		NRegistrySettings::ReadDwordFromRegistry(hSettingsKey,_T("TabHibernationIdleTimeout"),(LPDWORD)&m_config->tabHibernationIdleTimeout);
+		NRegistrySettings::ReadDwordFromRegistry(hSettingsKey,_T("TabHibernationMemoryBudget"),(LPDWORD)&m_config->tabHibernationMemoryBudget);
 
 		TCHAR value[MAX_PATH];
 		NRegistrySettings::ReadStringFromRegistry(hSettingsKey,_T("NewTabDirectory"),value,SIZEOF_ARRAY(value));
@@ -487,26 +503,29 @@ void Explorerplusplus::SaveTabSettingsToRegistry()
 
 			if(returnValue == ERROR_SUCCESS)
 			{
-				auto pidlDirectory = tab.GetShellBrowser()->GetDirectoryIdl();
+				/* Tabs that haven't been loaded yet can
+				be saved without loading them. */
+				auto pidlDirectory = tab.GetDirectoryIdl();
 				RegSetValueEx(hTabKey,_T("Directory"),0,REG_BINARY,
 					(LPBYTE)pidlDirectory.get(),ILGetSize(pidlDirectory.get()));
 
-				viewMode = tab.GetShellBrowser()->GetViewMode();
+				FolderSettings folderSettings = tab.GetFolderSettings();
+
+				viewMode = folderSettings.viewMode;
 
 				NRegistrySettings::SaveDwordToRegistry(hTabKey,_T("ViewMode"),viewMode);
 
-				sortMode = tab.GetShellBrowser()->GetSortMode();
+				sortMode = folderSettings.sortMode;
 				NRegistrySettings::SaveDwordToRegistry(hTabKey,_T("SortMode"),sortMode);
 
-				NRegistrySettings::SaveDwordToRegistry(hTabKey,_T("SortAscending"), tab.GetShellBrowser()->GetSortAscending());
-				NRegistrySettings::SaveDwordToRegistry(hTabKey,_T("ShowInGroups"), tab.GetShellBrowser()->GetShowInGroups());
-				NRegistrySettings::SaveDwordToRegistry(hTabKey,_T("ApplyFilter"), tab.GetShellBrowser()->GetFilterStatus());
-				NRegistrySettings::SaveDwordToRegistry(hTabKey,_T("FilterCaseSensitive"), tab.GetShellBrowser()->GetFilterCaseSensitive());
-				NRegistrySettings::SaveDwordToRegistry(hTabKey,_T("ShowHidden"), tab.GetShellBrowser()->GetShowHidden());
-				NRegistrySettings::SaveDwordToRegistry(hTabKey,_T("AutoArrange"), tab.GetShellBrowser()->GetAutoArrange());
+				NRegistrySettings::SaveDwordToRegistry(hTabKey,_T("SortAscending"), folderSettings.sortAscending);
+				NRegistrySettings::SaveDwordToRegistry(hTabKey,_T("ShowInGroups"), folderSettings.showInGroups);
+				NRegistrySettings::SaveDwordToRegistry(hTabKey,_T("ApplyFilter"), folderSettings.applyFilter);
+				NRegistrySettings::SaveDwordToRegistry(hTabKey,_T("FilterCaseSensitive"), folderSettings.filterCaseSensitive);
+				NRegistrySettings::SaveDwordToRegistry(hTabKey,_T("ShowHidden"), folderSettings.showHidden);
+				NRegistrySettings::SaveDwordToRegistry(hTabKey,_T("AutoArrange"), folderSettings.autoArrange);
 
-				std::wstring filter = tab.GetShellBrowser()->GetFilter();
-				NRegistrySettings::SaveStringToRegistry(hTabKey,_T("Filter"),filter.c_str());
+				NRegistrySettings::SaveStringToRegistry(hTabKey,_T("Filter"),folderSettings.filter.c_str());
 
 				/* Now save the tabs columns. */
 				returnValue = RegCreateKeyEx(hTabKey,_T("Columns"),
@@ -515,7 +534,7 @@ void Explorerplusplus::SaveTabSettingsToRegistry()
 
 				if(returnValue == ERROR_SUCCESS)
 				{
-					FolderColumns folderColumns = tab.GetShellBrowser()->ExportAllColumns();
+					FolderColumns folderColumns = tab.GetFolderColumns();
 
 					SaveColumnToRegistry(hColumnsKey,_T("ControlPanelColumns"),&folderColumns.controlPanelColumns);
 					SaveColumnToRegistry(hColumnsKey,_T("MyComputerColumns"),&folderColumns.myComputerColumns);
@@ -671,7 +690,12 @@ int Explorerplusplus::LoadTabSettingsFromRegistry()
 			TabSettings tabSettings;
 
 			tabSettings.index = i;
-			tabSettings.selected = true;
+
+			/* The tab that was selected will be
+			reselected (and loaded) by RestoreTabs().
+			The other tabs are only loaded once
+			they're used. */
+			tabSettings.deferLoad = true;
 
 			NRegistrySettings::ReadDwordFromRegistry(hTabKey,_T("Locked"),&value);
 
@@ -23,6 +23,7 @@
 #include "../Helper/ShellHelper.h"
 #include "../Helper/WindowHelper.h"
 #include "../Helper/XMLSettings.h"
+#include "../Helper/XmlStream.h"
 #include <regex>
 
 namespace NSearchDialog
@@ -1350,107 +1351,97 @@ void SearchDialogPersistentSettings::LoadExtraRegistrySettings(HKEY hKey)
 	ListToCircularBuffer(searchPatternList, m_searchPatterns);
 }
 
-void SearchDialogPersistentSettings::SaveExtraXMLSettings(
-	IXMLDOMDocument *pXMLDom, IXMLDOMElement *pParentNode)
+void SearchDialogPersistentSettings::SaveExtraXMLSettings(XmlStreamWriter &writer)
 {
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_COLUMN_WIDTH_1,
-		NXMLSettings::EncodeIntValue(m_iColumnWidth1));
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_COLUMN_WIDTH_2,
-		NXMLSettings::EncodeIntValue(m_iColumnWidth2));
-	NXMLSettings::AddAttributeToNode(
-		pXMLDom, pParentNode, SETTING_SEARCH_DIRECTORY_TEXT, m_szSearchPattern);
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_SEARCH_SUB_FOLDERS,
+	writer.WriteAttribute(SETTING_COLUMN_WIDTH_1, NXMLSettings::EncodeIntValue(m_iColumnWidth1));
+	writer.WriteAttribute(SETTING_COLUMN_WIDTH_2, NXMLSettings::EncodeIntValue(m_iColumnWidth2));
+	writer.WriteAttribute(SETTING_SEARCH_DIRECTORY_TEXT, m_szSearchPattern);
+	writer.WriteAttribute(SETTING_SEARCH_SUB_FOLDERS,
 		NXMLSettings::EncodeBoolValue(m_bSearchSubFolders));
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_USE_REGULAR_EXPRESSIONS,
+	writer.WriteAttribute(SETTING_USE_REGULAR_EXPRESSIONS,
 		NXMLSettings::EncodeBoolValue(m_bUseRegularExpressions));
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_CASE_INSENSITIVE,
+	writer.WriteAttribute(SETTING_CASE_INSENSITIVE,
 		NXMLSettings::EncodeBoolValue(m_bCaseInsensitive));
-	NXMLSettings::AddAttributeToNode(
-		pXMLDom, pParentNode, SETTING_ARCHIVE, NXMLSettings::EncodeBoolValue(m_bArchive));
-	NXMLSettings::AddAttributeToNode(
-		pXMLDom, pParentNode, SETTING_HIDDEN, NXMLSettings::EncodeBoolValue(m_bHidden));
-	NXMLSettings::AddAttributeToNode(
-		pXMLDom, pParentNode, SETTING_READ_ONLY, NXMLSettings::EncodeBoolValue(m_bReadOnly));
-	NXMLSettings::AddAttributeToNode(
-		pXMLDom, pParentNode, SETTING_SYSTEM, NXMLSettings::EncodeBoolValue(m_bSystem));
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_SORT_MODE,
+	writer.WriteAttribute(SETTING_ARCHIVE, NXMLSettings::EncodeBoolValue(m_bArchive));
+	writer.WriteAttribute(SETTING_HIDDEN, NXMLSettings::EncodeBoolValue(m_bHidden));
+	writer.WriteAttribute(SETTING_READ_ONLY, NXMLSettings::EncodeBoolValue(m_bReadOnly));
+	writer.WriteAttribute(SETTING_SYSTEM, NXMLSettings::EncodeBoolValue(m_bSystem));
+	writer.WriteAttribute(SETTING_SORT_MODE,
 		NXMLSettings::EncodeIntValue(static_cast<int>(m_SortMode)));
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_SORT_ASCENDING,
-		NXMLSettings::EncodeBoolValue(m_bSortAscending));
+	writer.WriteAttribute(SETTING_SORT_ASCENDING, NXMLSettings::EncodeBoolValue(m_bSortAscending));
 
 	std::list<std::wstring> searchDirectoriesList;
 	CircularBufferToList(m_searchDirectories, searchDirectoriesList);
-	NXMLSettings::AddStringListToNode(
-		pXMLDom, pParentNode, SETTING_DIRECTORY_LIST, searchDirectoriesList);
+	NXMLSettings::AddStringListToNode(writer, SETTING_DIRECTORY_LIST, searchDirectoriesList);
 
 	std::list<std::wstring> searchPatternList;
 	CircularBufferToList(m_searchPatterns, searchPatternList);
-	NXMLSettings::AddStringListToNode(
-		pXMLDom, pParentNode, SETTING_PATTERN_LIST, searchPatternList);
+	NXMLSettings::AddStringListToNode(writer, SETTING_PATTERN_LIST, searchPatternList);
 }
 
-void SearchDialogPersistentSettings::LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue)
+void SearchDialogPersistentSettings::LoadExtraXMLSettings(
+	const WCHAR *wszName, const WCHAR *wszValue)
 {
-	if (lstrcmpi(bstrName, SETTING_COLUMN_WIDTH_1) == 0)
+	if (lstrcmpi(wszName, SETTING_COLUMN_WIDTH_1) == 0)
 	{
-		m_iColumnWidth1 = NXMLSettings::DecodeIntValue(bstrValue);
+		m_iColumnWidth1 = NXMLSettings::DecodeIntValue(wszValue);
 	}
-	else if (lstrcmpi(bstrName, SETTING_COLUMN_WIDTH_2) == 0)
+	else if (lstrcmpi(wszName, SETTING_COLUMN_WIDTH_2) == 0)
 	{
-		m_iColumnWidth2 = NXMLSettings::DecodeIntValue(bstrValue);
+		m_iColumnWidth2 = NXMLSettings::DecodeIntValue(wszValue);
 	}
-	else if (lstrcmpi(bstrName, SETTING_SEARCH_DIRECTORY_TEXT) == 0)
+	else if (lstrcmpi(wszName, SETTING_SEARCH_DIRECTORY_TEXT) == 0)
 	{
-		StringCchCopy(m_szSearchPattern, SIZEOF_ARRAY(m_szSearchPattern), bstrValue);
+		StringCchCopy(m_szSearchPattern, SIZEOF_ARRAY(m_szSearchPattern), wszValue);
 	}
-	else if (lstrcmpi(bstrName, SETTING_SEARCH_SUB_FOLDERS) == 0)
+	else if (lstrcmpi(wszName, SETTING_SEARCH_SUB_FOLDERS) == 0)
 	{
-		m_bSearchSubFolders = NXMLSettings::DecodeBoolValue(bstrValue);
+		m_bSearchSubFolders = NXMLSettings::DecodeBoolValue(wszValue);
 	}
-	else if (lstrcmpi(bstrName, SETTING_USE_REGULAR_EXPRESSIONS) == 0)
+	else if (lstrcmpi(wszName, SETTING_USE_REGULAR_EXPRESSIONS) == 0)
 	{
-		m_bUseRegularExpressions = NXMLSettings::DecodeBoolValue(bstrValue);
+		m_bUseRegularExpressions = NXMLSettings::DecodeBoolValue(wszValue);
 	}
-	else if (lstrcmpi(bstrName, SETTING_CASE_INSENSITIVE) == 0)
+	else if (lstrcmpi(wszName, SETTING_CASE_INSENSITIVE) == 0)
 	{
-		m_bCaseInsensitive = NXMLSettings::DecodeBoolValue(bstrValue);
+		m_bCaseInsensitive = NXMLSettings::DecodeBoolValue(wszValue);
 	}
-	else if (lstrcmpi(bstrName, SETTING_ARCHIVE) == 0)
+	else if (lstrcmpi(wszName, SETTING_ARCHIVE) == 0)
 	{
-		m_bArchive = NXMLSettings::DecodeBoolValue(bstrValue);
+		m_bArchive = NXMLSettings::DecodeBoolValue(wszValue);
 	}
-	else if (lstrcmpi(bstrName, SETTING_HIDDEN) == 0)
+	else if (lstrcmpi(wszName, SETTING_HIDDEN) == 0)
 	{
-		m_bHidden = NXMLSettings::DecodeBoolValue(bstrValue);
+		m_bHidden = NXMLSettings::DecodeBoolValue(wszValue);
 	}
-	else if (lstrcmpi(bstrName, SETTING_READ_ONLY) == 0)
+	else if (lstrcmpi(wszName, SETTING_READ_ONLY) == 0)
 	{
-		m_bReadOnly = NXMLSettings::DecodeBoolValue(bstrValue);
+		m_bReadOnly = NXMLSettings::DecodeBoolValue(wszValue);
 	}
-	else if (lstrcmpi(bstrName, SETTING_SYSTEM) == 0)
+	else if (lstrcmpi(wszName, SETTING_SYSTEM) == 0)
 	{
-		m_bSystem = NXMLSettings::DecodeBoolValue(bstrValue);
+		m_bSystem = NXMLSettings::DecodeBoolValue(wszValue);
 	}
-	else if (lstrcmpi(bstrName, SETTING_SORT_MODE) == 0)
+	else if (lstrcmpi(wszName, SETTING_SORT_MODE) == 0)
 	{
-		m_SortMode = static_cast<SortMode>(NXMLSettings::DecodeIntValue(bstrValue));
+		m_SortMode = static_cast<SortMode>(NXMLSettings::DecodeIntValue(wszValue));
 	}
-	else if (lstrcmpi(bstrName, SETTING_SORT_ASCENDING) == 0)
+	else if (lstrcmpi(wszName, SETTING_SORT_ASCENDING) == 0)
 	{
-		m_bSortAscending = NXMLSettings::DecodeBoolValue(bstrValue);
+		m_bSortAscending = NXMLSettings::DecodeBoolValue(wszValue);
 	}
-	else if (CompareString(LOCALE_INVARIANT, NORM_IGNORECASE, bstrName,
+	else if (CompareString(LOCALE_INVARIANT, NORM_IGNORECASE, wszName,
 				 lstrlen(SETTING_DIRECTORY_LIST), SETTING_DIRECTORY_LIST,
 				 lstrlen(SETTING_DIRECTORY_LIST))
 		== CSTR_EQUAL)
 	{
-		m_searchDirectories.push_back(bstrValue);
+		m_searchDirectories.push_back(wszValue);
 	}
-	else if (CompareString(LOCALE_INVARIANT, NORM_IGNORECASE, bstrName,
+	else if (CompareString(LOCALE_INVARIANT, NORM_IGNORECASE, wszName,
 				 lstrlen(SETTING_PATTERN_LIST), SETTING_PATTERN_LIST, lstrlen(SETTING_PATTERN_LIST))
 		== CSTR_EQUAL)
 	{
-		m_searchPatterns.push_back(bstrValue);
+		m_searchPatterns.push_back(wszValue);
 	}
 }
 
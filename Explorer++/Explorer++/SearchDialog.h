@@ -9,7 +9,6 @@
 #include "../Helper/FileContextMenuManager.h"
 #include "../Helper/ReferenceCount.h"
 #include <boost/circular_buffer.hpp>
-#include <MsXml2.h>
 #include <objbase.h>
 #include <list>
 #include <regex>
@@ -72,8 +71,8 @@ private:
 	void SaveExtraRegistrySettings(HKEY hKey) override;
 	void LoadExtraRegistrySettings(HKEY hKey) override;
 
-	void SaveExtraXMLSettings(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pParentNode) override;
-	void LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue) override;
+	void SaveExtraXMLSettings(XmlStreamWriter &writer) override;
+	void LoadExtraXMLSettings(const WCHAR *wszName, const WCHAR *wszValue) override;
 
 	template <typename T>
 	void CircularBufferToList(const boost::circular_buffer<T> &cb, std::list<T> &list);
@@ -12,6 +12,7 @@
 #include "../Helper/RegistrySettings.h"
 #include "../Helper/ShellHelper.h"
 #include "../Helper/XMLSettings.h"
+#include "../Helper/XmlStream.h"
 #include <algorithm>
 
 const TCHAR SetDefaultColumnsDialogPersistentSettings::SETTINGS_KEY[] = _T("SetDefaultColumns");
@@ -427,17 +428,17 @@ void SetDefaultColumnsDialogPersistentSettings::LoadExtraRegistrySettings(HKEY h
 	m_FolderType = static_cast<FolderType>(value);
 }
 
-void SetDefaultColumnsDialogPersistentSettings::SaveExtraXMLSettings(
-	IXMLDOMDocument *pXMLDom, IXMLDOMElement *pParentNode)
+void SetDefaultColumnsDialogPersistentSettings::SaveExtraXMLSettings(XmlStreamWriter &writer)
 {
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_FOLDER_TYPE,
+	writer.WriteAttribute(SETTING_FOLDER_TYPE,
 		NXMLSettings::EncodeIntValue(static_cast<int>(m_FolderType)));
 }
 
-void SetDefaultColumnsDialogPersistentSettings::LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue)
+void SetDefaultColumnsDialogPersistentSettings::LoadExtraXMLSettings(
+	const WCHAR *wszName, const WCHAR *wszValue)
 {
-	if (lstrcmpi(bstrName, SETTING_FOLDER_TYPE) == 0)
+	if (lstrcmpi(wszName, SETTING_FOLDER_TYPE) == 0)
 	{
-		m_FolderType = static_cast<FolderType>(NXMLSettings::DecodeIntValue(bstrValue));
+		m_FolderType = static_cast<FolderType>(NXMLSettings::DecodeIntValue(wszValue));
 	}
 }
\ No newline at end of file
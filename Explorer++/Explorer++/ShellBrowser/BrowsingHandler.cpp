@@ -5,18 +5,50 @@
 #include "stdafx.h"
 #include "ShellBrowser.h"
 #include "Config.h"
+#include "FolderListingCache.h"
+#include "FolderPrefetcher.h"
 #include "ItemData.h"
 #include "MainResource.h"
 #include "ViewModes.h"
 #include "../Helper/IconFetcher.h"
 #include "../Helper/ListViewHelper.h"
+#include "../Helper/Logging.h"
 #include "../Helper/Macros.h"
 #include "../Helper/ShellHelper.h"
+#include "../Helper/TimeHelper.h"
+#include "../Helper/Tracing.h"
 #include <wil/com.h>
+#include <algorithm>
 #include <list>
 
 HRESULT ShellBrowser::BrowseFolder(PCIDLIST_ABSOLUTE pidlDirectory, bool addHistoryEntry)
 {
+	std::shared_ptr<const FolderListing> cachedListing;
+
+	// When prefetching is enabled, the folder may have been enumerated in
+	// anticipation of this navigation. A navigation that doesn't add a history
+	// entry is a refresh, which should always enumerate the folder.
+	if (addHistoryEntry && m_config->prefetchFolders)
+	{
+		cachedListing = FindCachedFolderListing(pidlDirectory);
+	}
+
+	return BrowseFolderInternal(pidlDirectory, addHistoryEntry, cachedListing);
+}
+
+HRESULT ShellBrowser::BrowseFolderFromHistory(PCIDLIST_ABSOLUTE pidlDirectory)
+{
+	// If the folder was visited recently, the previous listing can be shown
+	// straight away. The folder is then enumerated again in the background
+	// and any differences are applied once that's finished.
+	return BrowseFolderInternal(pidlDirectory, false, FindCachedFolderListing(pidlDirectory));
+}
+
+HRESULT ShellBrowser::BrowseFolderInternal(PCIDLIST_ABSOLUTE pidlDirectory, bool addHistoryEntry,
+	std::shared_ptr<const FolderListing> cachedListing)
+{
+	TRACE_EVENT("navigation", "BrowseFolder");
+
 	SetCursor(LoadCursor(nullptr, IDC_WAIT));
 
 	auto resetCursor = wil::scope_exit([] {
@@ -26,10 +58,13 @@ HRESULT ShellBrowser::BrowseFolder(PCIDLIST_ABSOLUTE pidlDirectory, bool addHist
 	if (m_bFolderVisited)
 	{
 		SaveColumnWidths();
+		StoreFolderListing();
 	}
 
 	ClearPendingResults();
 
+	m_folderPrefetcher->CancelPendingRequests();
+
 	EnterCriticalSection(&m_csDirectoryAltered);
 	m_FilesAdded.clear();
 	m_FileSelectionList.clear();
@@ -57,7 +92,14 @@ HRESULT ShellBrowser::BrowseFolder(PCIDLIST_ABSOLUTE pidlDirectory, bool addHist
 
 	m_nTotalItems = 0;
 
-	EnumerateFolder(pidlDirectory);
+	if (cachedListing)
+	{
+		InsertFolderListingItems(pidlDirectory, *cachedListing);
+	}
+	else
+	{
+		EnumerateFolder(pidlDirectory);
+	}
 
 	/* Window updates needs these to be set. */
 	m_NumFilesSelected = 0;
@@ -72,7 +114,23 @@ HRESULT ShellBrowser::BrowseFolder(PCIDLIST_ABSOLUTE pidlDirectory, bool addHist
 	InsertAwaitingItems(FALSE);
 
 	VerifySortMode();
-	SortFolder(m_folderSettings.sortMode);
+
+	// Items from a cached listing are inserted in the order they were
+	// previously displayed in. If the sort settings haven't changed since
+	// then, there's no need to sort the items again.
+	if (cachedListing && cachedListing->sortMode == m_folderSettings.sortMode
+		&& cachedListing->sortAscending == m_folderSettings.sortAscending
+		&& !m_folderSettings.showInGroups)
+	{
+		if (m_folderSettings.viewMode == +ViewMode::Details)
+		{
+			ApplyHeaderSortArrow();
+		}
+	}
+	else
+	{
+		SortFolder(m_folderSettings.sortMode);
+	}
 
 	ListView_EnsureVisible(m_hListView, 0, FALSE);
 
@@ -88,8 +146,15 @@ HRESULT ShellBrowser::BrowseFolder(PCIDLIST_ABSOLUTE pidlDirectory, bool addHist
 
 	m_uniqueFolderId++;
 
+	if (cachedListing)
+	{
+		QueueFolderRevalidation(cachedListing);
+	}
+
 	m_navigationCompletedSignal(pidlDirectory, addHistoryEntry);
 
+	PrefetchNeighboringFolders(pidlDirectory);
+
 	return S_OK;
 }
 
@@ -105,6 +170,9 @@ void ShellBrowser::ClearPendingResults()
 
 	m_infoTipsThreadPool.clear_queue();
 	m_infoTipResults.clear();
+
+	m_folderRevalidationThreadPool.clear_queue();
+	m_folderRevalidationResults.clear();
 }
 
 void ShellBrowser::ResetFolderState()
@@ -113,16 +181,13 @@ void ShellBrowser::ResetFolderState()
 	imagelist, and create a new one. */
 	if (m_folderSettings.viewMode == +ViewMode::Thumbnails)
 	{
-		auto himlOld = ListView_GetImageList(m_hListView, LVSIL_NORMAL);
-
-		int nItems = ListView_GetItemCount(m_hListView);
+		auto thumbnailStats = m_thumbnailStore.GetStats();
+		LOG(debug) << _T("ShellBrowser - Thumbnails: ") << thumbnailStats.residentBytes
+				   << _T(" bytes resident, ") << thumbnailStats.hits << _T(" hits, ")
+				   << thumbnailStats.misses << _T(" misses, ") << thumbnailStats.evictions
+				   << _T(" evictions");
 
-		/* Create and set the new imagelist. */
-		HIMAGELIST himl = ImageList_Create(
-			THUMBNAIL_ITEM_WIDTH, THUMBNAIL_ITEM_HEIGHT, ILC_COLOR32, nItems, nItems + 100);
-		ListView_SetImageList(m_hListView, himl, LVSIL_NORMAL);
-
-		ImageList_Destroy(himlOld);
+		CreateThumbnailsImageList();
 	}
 
 	m_directoryState = DirectoryState();
@@ -135,10 +200,14 @@ void ShellBrowser::ResetFolderState()
 	m_cachedFolderSizes.clear();
 	m_FilteredItemsList.clear();
 	m_AwaitingAddList.clear();
+
+	m_lastHotTrackedItem = -1;
 }
 
 HRESULT ShellBrowser::EnumerateFolder(PCIDLIST_ABSOLUTE pidlDirectory)
 {
+	TRACE_EVENT("navigation", "EnumerateFolder");
+
 	DetermineFolderVirtual(pidlDirectory);
 
 	wil::com_ptr<IShellFolder> pShellFolder;
@@ -282,7 +351,7 @@ int ShellBrowser::SetItemInformation(
 	}
 	else
 	{
-		WIN32_FIND_DATA wfd;
+		WIN32_FIND_DATA wfd = {};
 
 		StringCchCopy(wfd.cFileName, SIZEOF_ARRAY(wfd.cFileName), szFileName);
 		wfd.nFileSizeLow = 0;
@@ -297,6 +366,8 @@ int ShellBrowser::SetItemInformation(
 
 void ShellBrowser::InsertAwaitingItems(BOOL bInsertIntoGroup)
 {
+	TRACE_EVENT1("navigation", "InsertAwaitingItems", "numItems", m_AwaitingAddList.size());
+
 	int nPrevItems = ListView_GetItemCount(m_hListView);
 
 	if (nPrevItems == 0 && m_AwaitingAddList.empty())
@@ -331,6 +402,13 @@ void ShellBrowser::InsertAwaitingItems(BOOL bInsertIntoGroup)
 
 	int nAdded = 0;
 
+	std::optional<DateBucketer> dateBucketer;
+
+	if (bInsertIntoGroup)
+	{
+		dateBucketer.emplace(CreateDateBucketerForCurrentDay());
+	}
+
 	for (const auto &awaitingItem : m_AwaitingAddList)
 	{
 		const auto &itemInfo = m_itemInfoMap.at(awaitingItem.iItemInternal);
@@ -350,7 +428,7 @@ void ShellBrowser::InsertAwaitingItems(BOOL bInsertIntoGroup)
 		if (bInsertIntoGroup)
 		{
 			lv.mask |= LVIF_GROUPID;
-			lv.iGroupId = DetermineItemGroup(awaitingItem.iItemInternal);
+			lv.iGroupId = DetermineItemGroup(awaitingItem.iItemInternal, *dateBucketer);
 		}
 
 		lv.iItem = awaitingItem.iItem;
@@ -425,6 +503,11 @@ void ShellBrowser::InsertAwaitingItems(BOOL bInsertIntoGroup)
 		nAdded++;
 	}
 
+	if (bInsertIntoGroup)
+	{
+		UpdateGroupHeaders();
+	}
+
 	if (m_folderSettings.autoArrange)
 	{
 		ListViewHelper::SetAutoArrange(m_hListView, TRUE);
@@ -520,6 +603,7 @@ void ShellBrowser::RemoveItem(int iItemInternal)
 	}
 
 	m_itemInfoMap.erase(iItemInternal);
+	m_thumbnailStore.Remove(iItemInternal);
 
 	nItems = ListView_GetItemCount(m_hListView);
 
@@ -531,6 +615,272 @@ void ShellBrowser::RemoveItem(int iItemInternal)
 	}
 }
 
+std::shared_ptr<const FolderListing> ShellBrowser::FindCachedFolderListing(
+	PCIDLIST_ABSOLUTE pidlDirectory)
+{
+	auto cachedListing = m_folderListingCache->Find(pidlDirectory);
+
+	if (cachedListing && cachedListing->showHidden != m_folderSettings.showHidden)
+	{
+		return nullptr;
+	}
+
+	return cachedListing;
+}
+
+bool ShellBrowser::IsFolderListingCacheable() const
+{
+	// Only real folders are cached, since changes to those folders can be
+	// applied as regular directory modifications. The desktop is excluded,
+	// as it contains a number of virtual items.
+	return !m_bVirtualFolder && !CompareVirtualFolders(CSIDL_DESKTOP);
+}
+
+// Saves the current folder listing (in its displayed order), so that the
+// folder can be shown immediately if it's navigated back to.
+void ShellBrowser::StoreFolderListing()
+{
+	if (!IsFolderListingCacheable())
+	{
+		return;
+	}
+
+	// Copying the listing is relatively expensive for large folders, so the
+	// size is checked first, to avoid copying a listing that won't be cached.
+	size_t estimatedSize =
+		sizeof(FolderListing) + (m_itemInfoMap.size() * sizeof(FolderListingItem));
+
+	for (const auto &entry : m_itemInfoMap)
+	{
+		estimatedSize += FolderListing::GetItemMemoryUsage(
+			entry.second.pridl.get(), lstrlen(entry.second.szDisplayName) + 1);
+	}
+
+	if (estimatedSize > m_folderListingCache->GetMaxListingSize())
+	{
+		// Any previous listing for this folder is now out of date.
+		m_folderListingCache->Remove(m_directoryState.pidlDirectory.get());
+		return;
+	}
+
+	int numItems = ListView_GetItemCount(m_hListView);
+
+	std::vector<int> internalIndexes;
+	internalIndexes.reserve(m_itemInfoMap.size());
+
+	for (int i = 0; i < numItems; i++)
+	{
+		internalIndexes.push_back(GetItemInternalIndex(i));
+	}
+
+	// Filtered items still need to be stored, since the filter may be
+	// changed after navigating back to the folder. They're merged into the
+	// displayed items in sorted order, so that the stored listing matches
+	// the order a fresh enumeration would be sorted into.
+	std::vector<int> filteredIndexes(m_FilteredItemsList.begin(), m_FilteredItemsList.end());
+
+	auto compareItems = [this](int first, int second) {
+		return Sort(first, second) < 0;
+	};
+
+	std::stable_sort(filteredIndexes.begin(), filteredIndexes.end(), compareItems);
+
+	auto displayedEnd = internalIndexes.end();
+	internalIndexes.insert(internalIndexes.end(), filteredIndexes.begin(), filteredIndexes.end());
+	std::inplace_merge(
+		internalIndexes.begin(), displayedEnd, internalIndexes.end(), compareItems);
+
+	auto listing = std::make_shared<FolderListing>();
+	listing->showHidden = m_folderSettings.showHidden;
+	listing->sortMode = m_folderSettings.sortMode;
+	listing->sortAscending = m_folderSettings.sortAscending;
+	listing->items.reserve(internalIndexes.size());
+
+	for (int internalIndex : internalIndexes)
+	{
+		const ItemInfo_t &itemInfo = m_itemInfoMap.at(internalIndex);
+
+		FolderListingItem item;
+		item.pidlChild.reset(ILCloneChild(itemInfo.pridl.get()));
+		item.displayName = itemInfo.szDisplayName;
+		item.wfd = itemInfo.wfd;
+		listing->items.push_back(std::move(item));
+	}
+
+	m_folderListingCache->Insert(m_directoryState.pidlDirectory.get(), listing);
+}
+
+void ShellBrowser::InsertFolderListingItems(
+	PCIDLIST_ABSOLUTE pidlDirectory, const FolderListing &listing)
+{
+	TRACE_EVENT1("navigation", "InsertFolderListingItems", "numItems", listing.items.size());
+
+	DetermineFolderVirtual(pidlDirectory);
+
+	m_directoryState.pidlDirectory.reset(ILCloneFull(pidlDirectory));
+
+	for (const auto &item : listing.items)
+	{
+		int itemId = GenerateUniqueItemId();
+
+		auto &itemInfo = m_itemInfoMap[itemId];
+		itemInfo.pidlComplete.reset(ILCombine(pidlDirectory, item.pidlChild.get()));
+		itemInfo.pridl.reset(ILCloneChild(item.pidlChild.get()));
+		StringCchCopy(itemInfo.szDisplayName, SIZEOF_ARRAY(itemInfo.szDisplayName),
+			item.displayName.c_str());
+		itemInfo.wfd = item.wfd;
+		itemInfo.bDrive = FALSE;
+
+		AddItemInternal(-1, itemId, FALSE);
+	}
+}
+
+void ShellBrowser::QueueFolderRevalidation(std::shared_ptr<const FolderListing> cachedListing)
+{
+	int revalidationResultId = m_folderRevalidationResultIDCounter++;
+
+	std::wstring directory = m_CurDir;
+
+	auto result = m_folderRevalidationThreadPool.push(
+		[this, revalidationResultId, directory, cachedListing](int id) {
+			UNREFERENCED_PARAMETER(id);
+
+			return RevalidateFolderAsync(
+				m_hListView, revalidationResultId, directory, cachedListing);
+		});
+
+	m_folderRevalidationResults.insert({ revalidationResultId, std::move(result) });
+}
+
+std::optional<ShellBrowser::FolderRevalidationResult> ShellBrowser::RevalidateFolderAsync(
+	HWND listView, int revalidationResultId, const std::wstring &directory,
+	std::shared_ptr<const FolderListing> cachedListing)
+{
+	unique_pidl_absolute pidlDirectory;
+	HRESULT hr =
+		SHParseDisplayName(directory.c_str(), nullptr, wil::out_param(pidlDirectory), 0, nullptr);
+
+	if (FAILED(hr))
+	{
+		return std::nullopt;
+	}
+
+	auto currentListing = EnumerateFolderListing(pidlDirectory.get(), cachedListing->showHidden);
+
+	if (!currentListing)
+	{
+		return std::nullopt;
+	}
+
+	FolderRevalidationResult result;
+	result.changes = DiffFolderListings(*cachedListing, *currentListing);
+
+	// The result is only retrieved once this message is received, so it's
+	// posted as late as possible, to avoid blocking the UI thread while the
+	// result is still being generated.
+	PostMessage(listView, WM_APP_FOLDER_REVALIDATION_READY, revalidationResultId, 0);
+
+	return result;
+}
+
+void ShellBrowser::ProcessFolderRevalidationResult(int revalidationResultId)
+{
+	auto itr = m_folderRevalidationResults.find(revalidationResultId);
+
+	if (itr == m_folderRevalidationResults.end())
+	{
+		// This result is for a previous folder.
+		return;
+	}
+
+	auto result = itr->second.get();
+	m_folderRevalidationResults.erase(itr);
+
+	if (!result || result->changes.empty())
+	{
+		return;
+	}
+
+	SendMessage(m_hListView, WM_SETREDRAW, FALSE, NULL);
+
+	for (const auto &change : result->changes)
+	{
+		switch (change.action)
+		{
+		case FILE_ACTION_ADDED:
+			OnFileActionAdded(change.fileName.c_str());
+			break;
+
+		case FILE_ACTION_MODIFIED:
+			ModifyItemInternal(change.fileName.c_str());
+			break;
+
+		case FILE_ACTION_REMOVED:
+			RemoveItemInternal(change.fileName.c_str());
+			break;
+		}
+	}
+
+	SendMessage(m_hListView, WM_SETREDRAW, TRUE, NULL);
+
+	SendMessage(m_hOwner, WM_USER_DIRECTORYMODIFIED, m_ID, 0);
+}
+
+void ShellBrowser::PrefetchFolder(PCIDLIST_ABSOLUTE pidlDirectory)
+{
+	if (!m_config->prefetchFolders)
+	{
+		return;
+	}
+
+	m_folderPrefetcher->RequestPrefetch(pidlDirectory, m_folderSettings.showHidden);
+}
+
+void ShellBrowser::PrefetchItem(int internalIndex)
+{
+	const auto &itemInfo = m_itemInfoMap.at(internalIndex);
+
+	if (!WI_IsFlagSet(itemInfo.wfd.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY))
+	{
+		return;
+	}
+
+	PrefetchFolder(itemInfo.pidlComplete.get());
+}
+
+// After navigating, the folders most likely to be visited next are the
+// entries immediately around the current one in the history, as well as the
+// parent folder. Requests are processed newest first, so the back entry is
+// requested last.
+void ShellBrowser::PrefetchNeighboringFolders(PCIDLIST_ABSOLUTE pidlDirectory)
+{
+	if (!m_config->prefetchFolders)
+	{
+		return;
+	}
+
+	auto *forwardEntry = m_navigationController->GetEntry(1);
+
+	if (forwardEntry)
+	{
+		PrefetchFolder(forwardEntry->GetPidl().get());
+	}
+
+	unique_pidl_absolute pidlParent(ILCloneFull(pidlDirectory));
+
+	if (ILRemoveLastID(pidlParent.get()))
+	{
+		PrefetchFolder(pidlParent.get());
+	}
+
+	auto *backEntry = m_navigationController->GetEntry(-1);
+
+	if (backEntry)
+	{
+		PrefetchFolder(backEntry->GetPidl().get());
+	}
+}
+
 void ShellBrowser::PlayNavigationSound() const
 {
 	if (m_config->playNavigationSound)
@@ -13,6 +13,7 @@
 #include "SortModes.h"
 #include "ViewModes.h"
 #include "../Helper/Macros.h"
+#include "../Helper/Tracing.h"
 #include <cassert>
 #include <list>
 
@@ -21,21 +22,33 @@ void ShellBrowser::QueueColumnTask(int itemInternalIndex, ColumnType columnType)
 	int columnResultID = m_columnResultIDCounter++;
 
 	BasicItemInfo_t basicItemInfo = getBasicItemInfo(itemInternalIndex);
-	GlobalFolderSettings globalFolderSettings = m_config->globalFolderSettings;
 
-	auto result = m_columnThreadPool.push([this, columnResultID, columnType, itemInternalIndex,
-											  basicItemInfo, globalFolderSettings](int id) {
-		UNREFERENCED_PARAMETER(id);
+	// Only a pointer to the current settings is captured here. If the
+	// settings are changed while this task is pending, the task will
+	// still complete using the version it was queued with.
+	auto globalFolderSettings = m_config->globalFolderSettingsSnapshot.get();
 
-		return GetColumnTextAsync(m_hListView, columnResultID, columnType, itemInternalIndex,
-			basicItemInfo, globalFolderSettings);
-	});
+	auto queuedTime = GetTraceTimestamp();
+
+	auto result = m_columnThreadPool.push(
+		[this, columnResultID, columnType, itemInternalIndex, basicItemInfo, globalFolderSettings,
+			queuedTime](int id) {
+			UNREFERENCED_PARAMETER(id);
+
+			TRACE_ELAPSED("tasks", "ColumnTaskQueued", queuedTime);
+			TRACE_EVENT("tasks", "ColumnTask");
+
+			return GetColumnTextAsync(m_hListView, columnResultID, columnType, itemInternalIndex,
+				basicItemInfo, *globalFolderSettings);
+		});
 
 	// The function call above might finish before this line runs,
 	// but that doesn't matter, as the results won't be processed
 	// until a message posted to the main thread has been handled
 	// (which can only occur after this function has returned).
 	m_columnResults.insert({ columnResultID, std::move(result) });
+
+	TRACE_COUNTER("tasks", "PendingColumnResults", m_columnResults.size());
 }
 
 ShellBrowser::ColumnResult_t ShellBrowser::GetColumnTextAsync(HWND listView, int columnResultId,
@@ -59,6 +72,8 @@ ShellBrowser::ColumnResult_t ShellBrowser::GetColumnTextAsync(HWND listView, int
 
 void ShellBrowser::ProcessColumnResult(int columnResultId)
 {
+	TRACE_EVENT("tasks", "ProcessColumnResult");
+
 	auto itr = m_columnResults.find(columnResultId);
 
 	if (itr == m_columnResults.end())
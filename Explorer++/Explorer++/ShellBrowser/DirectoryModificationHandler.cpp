@@ -182,6 +182,15 @@ void ShellBrowser::OnFileActionAdded(const TCHAR *szFileName)
 	BOOL bFileAdded = FALSE;
 	HRESULT hr;
 
+	/* The item may already be present. That can happen if
+	it was added when revalidating a cached folder listing
+	and the directory monitor also reported the addition. */
+	if (LocateFileItemInternalIndex(szFileName) != -1)
+	{
+		ModifyItemInternal(szFileName);
+		return;
+	}
+
 	StringCchCopy(fullFileName, SIZEOF_ARRAY(fullFileName), m_CurDir);
 	PathAppend(fullFileName, szFileName);
 
@@ -0,0 +1,203 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "FolderListing.h"
+#include "../Helper/Macros.h"
+#include <wil/com.h>
+#include <string_view>
+#include <unordered_map>
+
+namespace
+{
+	WIN32_FIND_DATA GetItemFindData(PCIDLIST_ABSOLUTE pidlItem, const TCHAR *displayName)
+	{
+		TCHAR path[MAX_PATH];
+		BOOL res = SHGetPathFromIDList(pidlItem, path);
+
+		WIN32_FIND_DATA wfd = {};
+
+		if (res)
+		{
+			wil::unique_hfind findFile(FindFirstFile(path, &wfd));
+
+			if (findFile)
+			{
+				return wfd;
+			}
+		}
+
+		// The item may not exist on the filesystem, in which case the
+		// placeholder data here matches what ShellBrowser uses.
+		StringCchCopy(wfd.cFileName, SIZEOF_ARRAY(wfd.cFileName), displayName);
+		wfd.nFileSizeLow = 0;
+		wfd.nFileSizeHigh = 0;
+		wfd.dwFileAttributes = FILE_ATTRIBUTE_DIRECTORY;
+
+		return wfd;
+	}
+
+	bool IsFileTimeSet(const FILETIME &fileTime)
+	{
+		return fileTime.dwLowDateTime != 0 || fileTime.dwHighDateTime != 0;
+	}
+
+	bool HasItemChanged(const WIN32_FIND_DATA &oldData, const WIN32_FIND_DATA &newData)
+	{
+		if (oldData.dwFileAttributes != newData.dwFileAttributes
+			|| oldData.nFileSizeLow != newData.nFileSizeLow
+			|| oldData.nFileSizeHigh != newData.nFileSizeHigh)
+		{
+			return true;
+		}
+
+		// Items that couldn't be found on the filesystem only have placeholder
+		// find data, with no timestamp, so there's nothing to compare.
+		if (!IsFileTimeSet(oldData.ftLastWriteTime) || !IsFileTimeSet(newData.ftLastWriteTime))
+		{
+			return false;
+		}
+
+		return CompareFileTime(&oldData.ftLastWriteTime, &newData.ftLastWriteTime) != 0;
+	}
+}
+
+size_t FolderListing::GetMemoryUsage() const
+{
+	size_t memoryUsage = sizeof(*this) + (items.capacity() * sizeof(FolderListingItem));
+
+	for (const auto &item : items)
+	{
+		memoryUsage += GetItemMemoryUsage(item.pidlChild.get(), item.displayName.capacity());
+	}
+
+	return memoryUsage;
+}
+
+size_t FolderListing::GetItemMemoryUsage(PCUITEMID_CHILD pidlChild, size_t displayNameLength)
+{
+	return ILGetSize(pidlChild) + (displayNameLength * sizeof(wchar_t));
+}
+
+std::unique_ptr<FolderListing> EnumerateFolderListing(PCIDLIST_ABSOLUTE pidlDirectory,
+	BOOL showHidden, FolderListingContinueCallback shouldContinue)
+{
+	wil::com_ptr<IShellFolder> shellFolder;
+	HRESULT hr = BindToIdl(pidlDirectory, IID_PPV_ARGS(&shellFolder));
+
+	if (FAILED(hr))
+	{
+		return nullptr;
+	}
+
+	SHCONTF enumFlags = SHCONTF_FOLDERS | SHCONTF_NONFOLDERS;
+
+	if (showHidden)
+	{
+		enumFlags |= SHCONTF_INCLUDEHIDDEN | SHCONTF_INCLUDESUPERHIDDEN;
+	}
+
+	wil::com_ptr<IEnumIDList> enumerator;
+	hr = shellFolder->EnumObjects(nullptr, enumFlags, &enumerator);
+
+	if (FAILED(hr) || !enumerator)
+	{
+		return nullptr;
+	}
+
+	auto listing = std::make_unique<FolderListing>();
+	listing->showHidden = showHidden;
+	listing->sortAscending = TRUE;
+
+	ULONG numFetched = 1;
+	unique_pidl_child pidlItem;
+
+	while (enumerator->Next(1, wil::out_param(pidlItem), &numFetched) == S_OK && (numFetched == 1))
+	{
+		ULONG attributes = SFGAO_FOLDER;
+		PCITEMID_CHILD items[] = { pidlItem.get() };
+		shellFolder->GetAttributesOf(1, items, &attributes);
+
+		// See ShellBrowser::EnumerateFolder for the reasoning behind these
+		// flags. Only real folders are enumerated here.
+		SHGDNF nameFlags = SHGDN_INFOLDER;
+
+		if (!(attributes & SFGAO_FOLDER))
+		{
+			nameFlags |= SHGDN_FORPARSING;
+		}
+
+		STRRET str;
+		hr = shellFolder->GetDisplayNameOf(pidlItem.get(), nameFlags, &str);
+
+		if (FAILED(hr))
+		{
+			continue;
+		}
+
+		TCHAR displayName[MAX_PATH];
+		StrRetToBuf(&str, pidlItem.get(), displayName, SIZEOF_ARRAY(displayName));
+
+		unique_pidl_absolute pidlComplete(ILCombine(pidlDirectory, pidlItem.get()));
+
+		FolderListingItem item;
+		item.wfd = GetItemFindData(pidlComplete.get(), displayName);
+		item.displayName = displayName;
+		item.pidlChild = std::move(pidlItem);
+		listing->items.push_back(std::move(item));
+
+		if (shouldContinue && !shouldContinue(listing->items.size()))
+		{
+			return nullptr;
+		}
+	}
+
+	return listing;
+}
+
+std::vector<FolderListingChange> DiffFolderListings(
+	const FolderListing &oldListing, const FolderListing &newListing)
+{
+	std::unordered_map<std::wstring_view, const WIN32_FIND_DATA *> oldItems;
+
+	for (const auto &item : oldListing.items)
+	{
+		oldItems.insert({ item.wfd.cFileName, &item.wfd });
+	}
+
+	std::vector<FolderListingChange> addedOrModified;
+
+	for (const auto &item : newListing.items)
+	{
+		auto itr = oldItems.find(item.wfd.cFileName);
+
+		if (itr == oldItems.end())
+		{
+			addedOrModified.push_back({ FILE_ACTION_ADDED, item.wfd.cFileName });
+			continue;
+		}
+
+		if (HasItemChanged(*itr->second, item.wfd))
+		{
+			addedOrModified.push_back({ FILE_ACTION_MODIFIED, item.wfd.cFileName });
+		}
+
+		oldItems.erase(itr);
+	}
+
+	// Anything left over no longer exists. Removals are returned first, so
+	// that an item count never temporarily exceeds the final count.
+	std::vector<FolderListingChange> changes;
+
+	for (const auto &[fileName, findData] : oldItems)
+	{
+		UNREFERENCED_PARAMETER(findData);
+
+		changes.push_back({ FILE_ACTION_REMOVED, std::wstring(fileName) });
+	}
+
+	changes.insert(changes.end(), addedOrModified.begin(), addedOrModified.end());
+
+	return changes;
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "SortModes.h"
+#include "../Helper/ShellHelper.h"
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct FolderListingItem
+{
+	unique_pidl_child pidlChild;
+	std::wstring displayName;
+	WIN32_FIND_DATA wfd;
+};
+
+// A copy of the items in a (filesystem) folder. If the listing was taken
+// from a folder that was being displayed, the items will be in their
+// displayed order and the sort settings used to produce that order will be
+// recorded. Listings that are produced by a background enumeration are
+// unsorted.
+struct FolderListing
+{
+	std::vector<FolderListingItem> items;
+	BOOL showHidden;
+
+	std::optional<SortMode> sortMode;
+	BOOL sortAscending;
+
+	size_t GetMemoryUsage() const;
+
+	// Returns the memory used by an item, beyond the FolderListingItem
+	// structure itself.
+	static size_t GetItemMemoryUsage(PCUITEMID_CHILD pidlChild, size_t displayNameLength);
+};
+
+// Represents a single difference between two listings of the same folder.
+// The action is one of the FILE_ACTION_* values used by
+// ReadDirectoryChangesW, which allows the change to be applied through the
+// same path as a directory modification.
+struct FolderListingChange
+{
+	DWORD action;
+	std::wstring fileName;
+};
+
+// Called with the number of items enumerated so far. Returning false will
+// stop the enumeration, in which case no listing will be returned.
+using FolderListingContinueCallback = std::function<bool(size_t numItems)>;
+
+// Enumerates a filesystem folder, in the same way that ShellBrowser does.
+// This doesn't depend on any window, so can be called from a background
+// thread (provided COM has been initialized on that thread).
+std::unique_ptr<FolderListing> EnumerateFolderListing(PCIDLIST_ABSOLUTE pidlDirectory,
+	BOOL showHidden, FolderListingContinueCallback shouldContinue = nullptr);
+
+std::vector<FolderListingChange> DiffFolderListings(
+	const FolderListing &oldListing, const FolderListing &newListing);
\ No newline at end of file
@@ -0,0 +1,110 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "FolderListingCache.h"
+
+FolderListingCache::FolderListingCache(size_t maxBytes) : m_maxBytes(maxBytes), m_currentBytes(0)
+{
+}
+
+void FolderListingCache::Insert(
+	PCIDLIST_ABSOLUTE pidlDirectory, std::shared_ptr<const FolderListing> listing)
+{
+	size_t size = listing->GetMemoryUsage();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto &keyIndex = m_cachedListings.get<1>();
+	auto itr = keyIndex.find(GetKey(pidlDirectory));
+
+	if (itr != keyIndex.end())
+	{
+		m_currentBytes -= itr->size;
+		keyIndex.erase(itr);
+	}
+
+	if (size > GetMaxListingSize())
+	{
+		return;
+	}
+
+	m_cachedListings.push_front({ GetKey(pidlDirectory), std::move(listing), size });
+	m_currentBytes += size;
+
+	RemoveOldestListings();
+}
+
+std::shared_ptr<const FolderListing> FolderListingCache::Find(PCIDLIST_ABSOLUTE pidlDirectory)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto &keyIndex = m_cachedListings.get<1>();
+	auto itr = keyIndex.find(GetKey(pidlDirectory));
+
+	if (itr == keyIndex.end())
+	{
+		return nullptr;
+	}
+
+	// Move the listing to the front, so that it's the last to be removed.
+	m_cachedListings.relocate(m_cachedListings.begin(), m_cachedListings.project<0>(itr));
+
+	return itr->listing;
+}
+
+void FolderListingCache::Remove(PCIDLIST_ABSOLUTE pidlDirectory)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto &keyIndex = m_cachedListings.get<1>();
+	auto itr = keyIndex.find(GetKey(pidlDirectory));
+
+	if (itr == keyIndex.end())
+	{
+		return;
+	}
+
+	m_currentBytes -= itr->size;
+	keyIndex.erase(itr);
+}
+
+bool FolderListingCache::Contains(PCIDLIST_ABSOLUTE pidlDirectory) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto &keyIndex = m_cachedListings.get<1>();
+	return keyIndex.find(GetKey(pidlDirectory)) != keyIndex.end();
+}
+
+size_t FolderListingCache::GetMemoryUsage() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_currentBytes;
+}
+
+size_t FolderListingCache::GetMaxListingSize() const
+{
+	// A listing that would take up most of the cache on its own isn't worth
+	// storing, since it would force every other listing out.
+	return m_maxBytes / MAX_LISTING_FRACTION;
+}
+
+void FolderListingCache::RemoveOldestListings()
+{
+	while (m_currentBytes > m_maxBytes && !m_cachedListings.empty())
+	{
+		m_currentBytes -= m_cachedListings.back().size;
+		m_cachedListings.pop_back();
+	}
+}
+
+// Listings are keyed on the raw bytes of the folder's pidl. The pidl used to
+// navigate to a folder from the history is the same pidl that was used when
+// the folder was first opened, so there's no need for a more expensive
+// (shell-based) comparison here.
+std::string FolderListingCache::GetKey(PCIDLIST_ABSOLUTE pidlDirectory)
+{
+	return std::string(reinterpret_cast<const char *>(pidlDirectory), ILGetSize(pidlDirectory));
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "FolderListing.h"
+#include "../Helper/Macros.h"
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/multi_index_container.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Holds recently visited folder listings, so that a folder can be displayed
+// immediately when navigating back to it. The cache is bounded by the total
+// memory used by the listings, with the least recently used listings being
+// removed first. This class is thread-safe.
+class FolderListingCache
+{
+public:
+	FolderListingCache(size_t maxBytes);
+
+	void Insert(PCIDLIST_ABSOLUTE pidlDirectory, std::shared_ptr<const FolderListing> listing);
+	std::shared_ptr<const FolderListing> Find(PCIDLIST_ABSOLUTE pidlDirectory);
+	void Remove(PCIDLIST_ABSOLUTE pidlDirectory);
+
+	// Unlike Find(), this doesn't affect the order in which listings are
+	// removed.
+	bool Contains(PCIDLIST_ABSOLUTE pidlDirectory) const;
+
+	size_t GetMemoryUsage() const;
+
+	// Listings larger than this (a quarter of the cache) won't be stored.
+	size_t GetMaxListingSize() const;
+
+private:
+	DISALLOW_COPY_AND_ASSIGN(FolderListingCache);
+
+	static const size_t MAX_LISTING_FRACTION = 4;
+
+	struct CachedListing
+	{
+		std::string key;
+		std::shared_ptr<const FolderListing> listing;
+		size_t size;
+	};
+
+	typedef boost::multi_index_container<CachedListing,
+		boost::multi_index::indexed_by<boost::multi_index::sequenced<>,
+			boost::multi_index::hashed_unique<
+				boost::multi_index::member<CachedListing, std::string, &CachedListing::key>>>>
+		CachedListingSet;
+
+	static std::string GetKey(PCIDLIST_ABSOLUTE pidlDirectory);
+
+	void RemoveOldestListings();
+
+	CachedListingSet m_cachedListings;
+	const size_t m_maxBytes;
+	size_t m_currentBytes;
+	mutable std::mutex m_mutex;
+};
\ No newline at end of file
@@ -0,0 +1,127 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "FolderPrefetcher.h"
+#include "FolderListing.h"
+#include "FolderListingCache.h"
+#include <algorithm>
+
+FolderPrefetcher::FolderPrefetcher(FolderListingCache *folderListingCache) :
+	m_folderListingCache(folderListingCache),
+	m_generation(0),
+	m_threadPool(1, OnThreadStarted, OnThreadStopped)
+{
+}
+
+FolderPrefetcher::~FolderPrefetcher()
+{
+	CancelPendingRequests();
+}
+
+void FolderPrefetcher::OnThreadStarted()
+{
+	CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+
+	// Prefetching is purely speculative, so it shouldn't compete with any
+	// other I/O. Note that this also lowers the I/O priority of the thread.
+	SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+}
+
+void FolderPrefetcher::OnThreadStopped()
+{
+	SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+
+	CoUninitialize();
+}
+
+void FolderPrefetcher::RequestPrefetch(PCIDLIST_ABSOLUTE pidlDirectory, BOOL showHidden)
+{
+	// Only filesystem folders can be cached.
+	TCHAR path[MAX_PATH];
+	BOOL res = SHGetPathFromIDList(pidlDirectory, path);
+
+	if (!res || !PathIsDirectory(path))
+	{
+		return;
+	}
+
+	if (m_folderListingCache->Contains(pidlDirectory))
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto itr = std::find_if(m_pendingRequests.begin(), m_pendingRequests.end(),
+			[pidlDirectory](const PendingRequest &request) {
+				return CompareIdls(request.pidlDirectory.get(), pidlDirectory);
+			});
+
+		if (itr != m_pendingRequests.end())
+		{
+			m_pendingRequests.erase(itr);
+		}
+
+		m_pendingRequests.push_front({ unique_pidl_absolute(ILCloneFull(pidlDirectory)), showHidden });
+
+		if (m_pendingRequests.size() > MAX_PENDING_REQUESTS)
+		{
+			m_pendingRequests.pop_back();
+		}
+	}
+
+	unsigned int generation = m_generation;
+
+	m_threadPool.push([this, generation](int id) {
+		UNREFERENCED_PARAMETER(id);
+
+		ProcessNextRequest(generation);
+	});
+}
+
+void FolderPrefetcher::CancelPendingRequests()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_pendingRequests.clear();
+	m_generation++;
+
+	m_threadPool.clear_queue();
+}
+
+void FolderPrefetcher::ProcessNextRequest(unsigned int generation)
+{
+	PendingRequest request;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (generation != m_generation || m_pendingRequests.empty())
+		{
+			return;
+		}
+
+		request = std::move(m_pendingRequests.front());
+		m_pendingRequests.pop_front();
+	}
+
+	if (m_folderListingCache->Contains(request.pidlDirectory.get()))
+	{
+		return;
+	}
+
+	auto listing = EnumerateFolderListing(request.pidlDirectory.get(), request.showHidden,
+		[this, generation](size_t numItems) {
+			return generation == m_generation && numItems <= MAX_ITEMS_PER_FOLDER;
+		});
+
+	if (!listing || generation != m_generation)
+	{
+		return;
+	}
+
+	m_folderListingCache->Insert(request.pidlDirectory.get(), std::move(listing));
+}
\ No newline at end of file
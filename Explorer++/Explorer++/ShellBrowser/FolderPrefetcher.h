@@ -0,0 +1,61 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "../Helper/Macros.h"
+#include "../Helper/ShellHelper.h"
+#include "../ThirdParty/CTPL/cpl_stl.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+class FolderListingCache;
+
+// Speculatively enumerates folders that are likely to be navigated to next
+// (e.g. a folder that's being hovered over) and places the results in the
+// folder listing cache. Folders are enumerated one at a time, on a single
+// background thread that runs at background I/O priority.
+//
+// Only a small number of requests are held at once. Newer requests are
+// processed first and, once the limit is reached, the oldest requests are
+// dropped. All outstanding work is abandoned when CancelPendingRequests() is
+// called, which should happen whenever a real navigation starts.
+class FolderPrefetcher
+{
+public:
+	FolderPrefetcher(FolderListingCache *folderListingCache);
+	~FolderPrefetcher();
+
+	void RequestPrefetch(PCIDLIST_ABSOLUTE pidlDirectory, BOOL showHidden);
+	void CancelPendingRequests();
+
+private:
+	DISALLOW_COPY_AND_ASSIGN(FolderPrefetcher);
+
+	static const size_t MAX_PENDING_REQUESTS = 4;
+
+	// Folders with more items than this won't be prefetched. This limits the
+	// amount of time and memory spent on any single speculative enumeration.
+	static const size_t MAX_ITEMS_PER_FOLDER = 2000;
+
+	struct PendingRequest
+	{
+		unique_pidl_absolute pidlDirectory;
+		BOOL showHidden;
+	};
+
+	static void OnThreadStarted();
+	static void OnThreadStopped();
+
+	void ProcessNextRequest(unsigned int generation);
+
+	FolderListingCache *m_folderListingCache;
+
+	std::mutex m_mutex;
+	std::deque<PendingRequest> m_pendingRequests;
+	std::atomic<unsigned int> m_generation;
+
+	ctpl::thread_pool m_threadPool;
+};
\ No newline at end of file
@@ -0,0 +1,24 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+// The parts of a folder's view that aren't retained when it's navigated
+// away from. Items are identified by their filenames, so that the state can
+// be reapplied once the folder has been enumerated again.
+struct FolderViewState
+{
+	std::vector<std::wstring> selectedItems;
+	std::optional<std::wstring> focusedItem;
+
+	// In the details and list views, this is the first visible item. The
+	// other views are scrolled by pixel, so the offset of the view is
+	// recorded instead.
+	std::optional<std::wstring> topItem;
+	POINT scrollOffset;
+};
\ No newline at end of file
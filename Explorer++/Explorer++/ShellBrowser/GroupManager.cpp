@@ -13,11 +13,11 @@
 #include "../Helper/Macros.h"
 #include "../Helper/ShellHelper.h"
 #include "../Helper/TimeHelper.h"
-#include <boost/date_time/gregorian/gregorian.hpp>
-#include <boost/date_time/posix_time/posix_time.hpp>
+#include "../Helper/Tracing.h"
 #include <wil/common.h>
 #include <iphlpapi.h>
 #include <propkey.h>
+#include <algorithm>
 #include <cassert>
 #include <list>
 
@@ -26,6 +26,46 @@ namespace
 const UINT KBYTE = 1024;
 const UINT MBYTE = 1024 * 1024;
 const UINT GBYTE = 1024 * 1024 * 1024;
+
+// FileTimeToSystemTime() fails for any value greater than this.
+const uint64_t MAX_FILE_TIMESTAMP = 0x7FFFFFFFFFFFFFFF;
+
+UINT GetDateBucketStringId(DateBucket dateBucket)
+{
+	switch (dateBucket)
+	{
+	case DateBucket::Future:
+		return IDS_GROUPBY_DATE_FUTURE;
+
+	case DateBucket::Today:
+		return IDS_GROUPBY_DATE_TODAY;
+
+	case DateBucket::Yesterday:
+		return IDS_GROUPBY_DATE_YESTERDAY;
+
+	case DateBucket::ThisWeek:
+		return IDS_GROUPBY_DATE_THIS_WEEK;
+
+	case DateBucket::LastWeek:
+		return IDS_GROUPBY_DATE_LAST_WEEK;
+
+	case DateBucket::ThisMonth:
+		return IDS_GROUPBY_DATE_THIS_MONTH;
+
+	case DateBucket::LastMonth:
+		return IDS_GROUPBY_DATE_LAST_MONTH;
+
+	case DateBucket::ThisYear:
+		return IDS_GROUPBY_DATE_THIS_YEAR;
+
+	case DateBucket::LastYear:
+		return IDS_GROUPBY_DATE_LAST_YEAR;
+
+	case DateBucket::LongAgo:
+	default:
+		return IDS_GROUPBY_DATE_LONG_AGO;
+	}
+}
 }
 
 BOOL ShellBrowser::GetShowInGroups() const
@@ -134,103 +174,111 @@ INT CALLBACK ShellBrowser::GroupFreeSpaceComparison(INT Group1_ID, INT Group2_ID
 
 std::wstring ShellBrowser::RetrieveGroupHeader(int groupId)
 {
-	auto itr =
-		std::find_if(m_GroupList.begin(), m_GroupList.end(), [groupId](const TypeGroup_t &group) {
-			return group.iGroupId == groupId;
-		});
-
-	return itr->header;
+	return m_groups.at(groupId).header;
 }
 
 /*
  * Determines the id of the group the specified
  * item belongs to.
  */
-int ShellBrowser::DetermineItemGroup(int iItemInternal)
+int ShellBrowser::DetermineItemGroup(int iItemInternal, const DateBucketer &dateBucketer)
 {
 	BasicItemInfo_t basicItemInfo = getBasicItemInfo(iItemInternal);
-	PFNLVGROUPCOMPARE groupComparison = nullptr;
-	std::wstring groupHeader;
+	ItemGroup itemGroup =
+		DetermineItemGroup(basicItemInfo, m_config->globalFolderSettings, dateBucketer);
+
+	return CheckGroup(itemGroup.header, itemGroup.comparison);
+}
+
+// Determines the group header for the specified item. This only reads data
+// that remains constant while items are being grouped, so it can be called
+// from multiple threads at once.
+ShellBrowser::ItemGroup ShellBrowser::DetermineItemGroup(const BasicItemInfo_t &basicItemInfo,
+	const GlobalFolderSettings &globalFolderSettings, const DateBucketer &dateBucketer) const
+{
+	ItemGroup itemGroup;
+	itemGroup.comparison = nullptr;
 
 	switch (m_folderSettings.sortMode)
 	{
 	case SortMode::Name:
-		groupHeader = DetermineItemNameGroup(basicItemInfo);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemNameGroup(basicItemInfo);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::Type:
-		groupHeader = DetermineItemTypeGroupVirtual(basicItemInfo);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemTypeGroupVirtual(basicItemInfo);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::Size:
-		groupHeader = DetermineItemSizeGroup(basicItemInfo);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemSizeGroup(basicItemInfo);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::DateModified:
-		groupHeader = DetermineItemDateGroup(basicItemInfo, GroupByDateType::Modified);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header =
+			DetermineItemDateGroup(basicItemInfo, GroupByDateType::Modified, dateBucketer);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::TotalSize:
-		groupHeader = DetermineItemTotalSizeGroup(basicItemInfo);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemTotalSizeGroup(basicItemInfo);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::FreeSpace:
-		groupHeader = DetermineItemFreeSpaceGroup(basicItemInfo);
-		groupComparison = GroupFreeSpaceComparisonStub;
+		itemGroup.header = DetermineItemFreeSpaceGroup(basicItemInfo);
+		itemGroup.comparison = GroupFreeSpaceComparisonStub;
 		break;
 
 	case SortMode::DateDeleted:
 		break;
 
 	case SortMode::OriginalLocation:
-		groupHeader = DetermineItemSummaryGroup(
-			basicItemInfo, &SCID_ORIGINAL_LOCATION, m_config->globalFolderSettings);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemSummaryGroup(
+			basicItemInfo, &SCID_ORIGINAL_LOCATION, globalFolderSettings);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::Attributes:
-		groupHeader = DetermineItemAttributeGroup(basicItemInfo);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemAttributeGroup(basicItemInfo);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::ShortName:
-		groupHeader = DetermineItemNameGroup(basicItemInfo);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemNameGroup(basicItemInfo);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::Owner:
-		groupHeader = DetermineItemOwnerGroup(basicItemInfo);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemOwnerGroup(basicItemInfo);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::ProductName:
-		groupHeader = DetermineItemVersionGroup(basicItemInfo, _T("ProductName"));
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemVersionGroup(basicItemInfo, _T("ProductName"));
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::Company:
-		groupHeader = DetermineItemVersionGroup(basicItemInfo, _T("CompanyName"));
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemVersionGroup(basicItemInfo, _T("CompanyName"));
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::Description:
-		groupHeader = DetermineItemVersionGroup(basicItemInfo, _T("FileDescription"));
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemVersionGroup(basicItemInfo, _T("FileDescription"));
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::FileVersion:
-		groupHeader = DetermineItemVersionGroup(basicItemInfo, _T("FileVersion"));
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemVersionGroup(basicItemInfo, _T("FileVersion"));
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::ProductVersion:
-		groupHeader = DetermineItemVersionGroup(basicItemInfo, _T("ProductVersion"));
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemVersionGroup(basicItemInfo, _T("ProductVersion"));
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::ShortcutTo:
@@ -240,76 +288,78 @@ int ShellBrowser::DetermineItemGroup(int iItemInternal)
 		break;
 
 	case SortMode::Extension:
-		groupHeader = DetermineItemExtensionGroup(basicItemInfo);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemExtensionGroup(basicItemInfo);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::Created:
-		groupHeader = DetermineItemDateGroup(basicItemInfo, GroupByDateType::Created);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header =
+			DetermineItemDateGroup(basicItemInfo, GroupByDateType::Created, dateBucketer);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::Accessed:
-		groupHeader = DetermineItemDateGroup(basicItemInfo, GroupByDateType::Accessed);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header =
+			DetermineItemDateGroup(basicItemInfo, GroupByDateType::Accessed, dateBucketer);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::Title:
-		groupHeader =
-			DetermineItemSummaryGroup(basicItemInfo, &PKEY_Title, m_config->globalFolderSettings);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header =
+			DetermineItemSummaryGroup(basicItemInfo, &PKEY_Title, globalFolderSettings);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::Subject:
-		groupHeader =
-			DetermineItemSummaryGroup(basicItemInfo, &PKEY_Subject, m_config->globalFolderSettings);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header =
+			DetermineItemSummaryGroup(basicItemInfo, &PKEY_Subject, globalFolderSettings);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::Authors:
-		groupHeader =
-			DetermineItemSummaryGroup(basicItemInfo, &PKEY_Author, m_config->globalFolderSettings);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header =
+			DetermineItemSummaryGroup(basicItemInfo, &PKEY_Author, globalFolderSettings);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::Keywords:
-		groupHeader = DetermineItemSummaryGroup(
-			basicItemInfo, &PKEY_Keywords, m_config->globalFolderSettings);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemSummaryGroup(
+			basicItemInfo, &PKEY_Keywords, globalFolderSettings);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::Comments:
-		groupHeader =
-			DetermineItemSummaryGroup(basicItemInfo, &PKEY_Comment, m_config->globalFolderSettings);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header =
+			DetermineItemSummaryGroup(basicItemInfo, &PKEY_Comment, globalFolderSettings);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::CameraModel:
-		groupHeader = DetermineItemCameraPropertyGroup(basicItemInfo, PropertyTagEquipModel);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemCameraPropertyGroup(basicItemInfo, PropertyTagEquipModel);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::DateTaken:
-		groupHeader = DetermineItemCameraPropertyGroup(basicItemInfo, PropertyTagDateTime);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemCameraPropertyGroup(basicItemInfo, PropertyTagDateTime);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::Width:
-		groupHeader = DetermineItemCameraPropertyGroup(basicItemInfo, PropertyTagImageWidth);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemCameraPropertyGroup(basicItemInfo, PropertyTagImageWidth);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::Height:
-		groupHeader = DetermineItemCameraPropertyGroup(basicItemInfo, PropertyTagImageHeight);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemCameraPropertyGroup(basicItemInfo, PropertyTagImageHeight);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::VirtualComments:
 		break;
 
 	case SortMode::FileSystem:
-		groupHeader = DetermineItemFileSystemGroup(basicItemInfo);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemFileSystemGroup(basicItemInfo);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	case SortMode::NumPrinterDocuments:
@@ -325,8 +375,8 @@ int ShellBrowser::DetermineItemGroup(int iItemInternal)
 		break;
 
 	case SortMode::NetworkAdapterStatus:
-		groupHeader = DetermineItemNetworkStatus(basicItemInfo);
-		groupComparison = GroupNameComparisonStub;
+		itemGroup.header = DetermineItemNetworkStatus(basicItemInfo);
+		itemGroup.comparison = GroupNameComparisonStub;
 		break;
 
 	default:
@@ -334,7 +384,7 @@ int ShellBrowser::DetermineItemGroup(int iItemInternal)
 		break;
 	}
 
-	return CheckGroup(groupHeader, groupComparison);
+	return itemGroup;
 }
 
 /*
@@ -342,31 +392,22 @@ int ShellBrowser::DetermineItemGroup(int iItemInternal)
  * in the listview. If not, the group is inserted
  * into its sorted position with the specified
  * header text.
+ *
+ * The item count shown in the group header isn't
+ * updated here. Instead, the group is marked and
+ * UpdateGroupHeaders() should be called once all
+ * items have been assigned to their groups.
  */
-int ShellBrowser::CheckGroup(std::wstring_view groupHeader, PFNLVGROUPCOMPARE groupComparison)
+int ShellBrowser::CheckGroup(const std::wstring &groupHeader, PFNLVGROUPCOMPARE groupComparison)
 {
-	auto itr = std::find_if(
-		m_GroupList.begin(), m_GroupList.end(), [groupHeader](const TypeGroup_t &group) {
-			return group.header == groupHeader;
-		});
+	auto itr = m_groupIdsByHeader.find(groupHeader);
 
-	auto generateListViewHeader = [](std::wstring_view header, int numItems) {
-		return std::wstring(header) + L" (" + std::to_wstring(numItems) + L")";
-	};
-
-	if (itr != m_GroupList.end())
+	if (itr != m_groupIdsByHeader.end())
 	{
-		itr->nItems++;
-
-		std::wstring listViewHeader = generateListViewHeader(groupHeader, itr->nItems);
-
-		LVGROUP lvGroup;
-		lvGroup.cbSize = sizeof(LVGROUP);
-		lvGroup.mask = LVGF_HEADER;
-		lvGroup.pszHeader = listViewHeader.data();
-		ListView_SetGroupInfo(m_hListView, itr->iGroupId, &lvGroup);
+		m_groups.at(itr->second).nItems++;
+		m_groupsPendingHeaderUpdate.insert(itr->second);
 
-		return itr->iGroupId;
+		return itr->second;
 	}
 
 	int groupId = m_iGroupId++;
@@ -375,9 +416,10 @@ int ShellBrowser::CheckGroup(std::wstring_view groupHeader, PFNLVGROUPCOMPARE gr
 	typeGroup.header = groupHeader;
 	typeGroup.iGroupId = groupId;
 	typeGroup.nItems = 1;
-	m_GroupList.push_back(typeGroup);
+	m_groups.insert({ groupId, typeGroup });
+	m_groupIdsByHeader.insert({ groupHeader, groupId });
 
-	std::wstring listViewHeader = generateListViewHeader(groupHeader, typeGroup.nItems);
+	std::wstring listViewHeader = GenerateGroupListViewHeader(typeGroup);
 
 	LVINSERTGROUPSORTED lvigs;
 	lvigs.lvGroup.cbSize = sizeof(LVGROUP);
@@ -393,6 +435,27 @@ int ShellBrowser::CheckGroup(std::wstring_view groupHeader, PFNLVGROUPCOMPARE gr
 	return groupId;
 }
 
+std::wstring ShellBrowser::GenerateGroupListViewHeader(const TypeGroup_t &group)
+{
+	return group.header + L" (" + std::to_wstring(group.nItems) + L")";
+}
+
+void ShellBrowser::UpdateGroupHeaders()
+{
+	for (int groupId : m_groupsPendingHeaderUpdate)
+	{
+		std::wstring listViewHeader = GenerateGroupListViewHeader(m_groups.at(groupId));
+
+		LVGROUP lvGroup;
+		lvGroup.cbSize = sizeof(LVGROUP);
+		lvGroup.mask = LVGF_HEADER;
+		lvGroup.pszHeader = listViewHeader.data();
+		ListView_SetGroupInfo(m_hListView, groupId, &lvGroup);
+	}
+
+	m_groupsPendingHeaderUpdate.clear();
+}
+
 /*
  * Determines the id of the group to which the specified
  * item belongs, based on the item's name.
@@ -524,113 +587,99 @@ std::wstring ShellBrowser::DetermineItemTypeGroupVirtual(const BasicItemInfo_t &
 	return shfi.szTypeName;
 }
 
-std::wstring ShellBrowser::DetermineItemDateGroup(
-	const BasicItemInfo_t &itemInfo, GroupByDateType dateType) const
+std::wstring ShellBrowser::DetermineItemDateGroup(const BasicItemInfo_t &itemInfo,
+	GroupByDateType dateType, const DateBucketer &dateBucketer) const
 {
-	using namespace boost::gregorian;
-	using namespace boost::posix_time;
-
-	SYSTEMTIME stFileTime;
-	BOOL ret = FALSE;
-
-	switch (dateType)
-	{
-	case GroupByDateType::Modified:
-		ret = FileTimeToLocalSystemTime(&itemInfo.wfd.ftLastWriteTime, &stFileTime);
-		break;
+	uint64_t timestamp = GetItemTimestamp(itemInfo.wfd, dateType);
 
-	case GroupByDateType::Created:
-		ret = FileTimeToLocalSystemTime(&itemInfo.wfd.ftCreationTime, &stFileTime);
-		break;
-
-	case GroupByDateType::Accessed:
-		ret = FileTimeToLocalSystemTime(&itemInfo.wfd.ftLastAccessTime, &stFileTime);
-		break;
-
-	default:
-		throw std::runtime_error("Incorrect date type");
-	}
-
-	if (!ret)
+	if (timestamp > MAX_FILE_TIMESTAMP)
 	{
 		return ResourceHelper::LoadString(m_hResourceModule, IDS_GROUPBY_UNSPECIFIED);
 	}
 
-	FILETIME localFileTime;
-	ret = SystemTimeToFileTime(&stFileTime, &localFileTime);
+	return ResourceHelper::LoadString(
+		m_hResourceModule, GetDateBucketStringId(dateBucketer.Classify(timestamp)));
+}
+
+// Grouping by date only requires the timestamp of each item to be classified,
+// which is cheap enough that all the items are handled in a single batch here.
+std::vector<ShellBrowser::ItemGroup> ShellBrowser::DetermineItemDateGroups(
+	const std::vector<BasicItemInfo_t> &items, GroupByDateType dateType,
+	const DateBucketer &dateBucketer) const
+{
+	std::vector<uint64_t> timestamps;
+	timestamps.reserve(items.size());
 
-	if (!ret)
+	for (const auto &item : items)
 	{
-		return ResourceHelper::LoadString(m_hResourceModule, IDS_GROUPBY_UNSPECIFIED);
+		timestamps.push_back(GetItemTimestamp(item.wfd, dateType));
 	}
 
-	auto filePosixTime = from_ftime<ptime>(localFileTime);
-	date fileDate = filePosixTime.date();
+	std::vector<DateBucket> buckets(items.size());
+	dateBucketer.ClassifyAll(timestamps.data(), buckets.data(), timestamps.size());
 
-	date today = day_clock::local_day();
+	// There are only a handful of possible headers, so each one is only loaded
+	// once.
+	std::unordered_map<UINT, std::wstring> headers;
 
-	if (fileDate > today)
-	{
-		return ResourceHelper::LoadString(m_hResourceModule, IDS_GROUPBY_DATE_FUTURE);
-	}
+	std::vector<ItemGroup> itemGroups(items.size());
 
-	if (fileDate == today)
+	for (size_t i = 0; i < items.size(); i++)
 	{
-		return ResourceHelper::LoadString(m_hResourceModule, IDS_GROUPBY_DATE_TODAY);
-	}
+		UINT stringId = (timestamps[i] > MAX_FILE_TIMESTAMP) ? IDS_GROUPBY_UNSPECIFIED
+															 : GetDateBucketStringId(buckets[i]);
 
-	date yesterday = today - days(1);
+		auto itr = headers.find(stringId);
 
-	if (fileDate == yesterday)
-	{
-		return ResourceHelper::LoadString(m_hResourceModule, IDS_GROUPBY_DATE_YESTERDAY);
-	}
-
-	// Note that this assumes that Sunday is the first day of the week.
-	unsigned short currentWeekday = today.day_of_week().as_number();
-	date startOfWeek = today - days(currentWeekday);
+		if (itr == headers.end())
+		{
+			itr = headers
+					  .insert({ stringId,
+						  ResourceHelper::LoadString(m_hResourceModule, stringId) })
+					  .first;
+		}
 
-	if (fileDate >= startOfWeek)
-	{
-		return ResourceHelper::LoadString(m_hResourceModule, IDS_GROUPBY_DATE_THIS_WEEK);
+		itemGroups[i].header = itr->second;
+		itemGroups[i].comparison = GroupNameComparisonStub;
 	}
 
-	date startOfLastWeek = startOfWeek - weeks(1);
+	return itemGroups;
+}
 
-	if (fileDate >= startOfLastWeek)
+std::optional<ShellBrowser::GroupByDateType> ShellBrowser::GetGroupByDateType(SortMode sortMode)
+{
+	switch (sortMode)
 	{
-		return ResourceHelper::LoadString(m_hResourceModule, IDS_GROUPBY_DATE_LAST_WEEK);
-	}
-
-	date startOfMonth = date(today.year(), today.month(), 1);
+	case SortMode::DateModified:
+		return GroupByDateType::Modified;
 
-	if (fileDate >= startOfMonth)
-	{
-		return ResourceHelper::LoadString(m_hResourceModule, IDS_GROUPBY_DATE_THIS_MONTH);
-	}
+	case SortMode::Created:
+		return GroupByDateType::Created;
 
-	date startOfLastMonth = startOfMonth - months(1);
+	case SortMode::Accessed:
+		return GroupByDateType::Accessed;
 
-	if (fileDate >= startOfLastMonth)
-	{
-		return ResourceHelper::LoadString(m_hResourceModule, IDS_GROUPBY_DATE_LAST_MONTH);
+	default:
+		return std::nullopt;
 	}
+}
 
-	date startOfYear = date(today.year(), 1, 1);
-
-	if (fileDate >= startOfYear)
+uint64_t ShellBrowser::GetItemTimestamp(const WIN32_FIND_DATA &wfd, GroupByDateType dateType)
+{
+	switch (dateType)
 	{
-		return ResourceHelper::LoadString(m_hResourceModule, IDS_GROUPBY_DATE_THIS_YEAR);
-	}
+	case GroupByDateType::Modified:
+		return FileTimeToTimestamp(wfd.ftLastWriteTime);
+
+	case GroupByDateType::Created:
+		return FileTimeToTimestamp(wfd.ftCreationTime);
 
-	date startOfLastYear = startOfYear - years(1);
+	case GroupByDateType::Accessed:
+		return FileTimeToTimestamp(wfd.ftLastAccessTime);
 
-	if (fileDate >= startOfLastYear)
-	{
-		return ResourceHelper::LoadString(m_hResourceModule, IDS_GROUPBY_DATE_LAST_YEAR);
+	default:
+		throw std::runtime_error("Incorrect date type");
 	}
-
-	return ResourceHelper::LoadString(m_hResourceModule, IDS_GROUPBY_DATE_LONG_AGO);
 }
 
 std::wstring ShellBrowser::DetermineItemSummaryGroup(const BasicItemInfo_t &itemInfo,
@@ -883,6 +932,8 @@ void ShellBrowser::InsertItemIntoGroup(int iItem, int iGroupId)
 
 void ShellBrowser::MoveItemsIntoGroups()
 {
+	TRACE_EVENT("group", "MoveItemsIntoGroups");
+
 	LVITEM item;
 	int nItems;
 	int iGroupId;
@@ -895,9 +946,14 @@ void ShellBrowser::MoveItemsIntoGroups()
 
 	SendMessage(m_hListView, WM_SETREDRAW, (WPARAM) FALSE, (LPARAM) NULL);
 
-	m_GroupList.clear();
+	m_groups.clear();
+	m_groupIdsByHeader.clear();
+	m_groupsPendingHeaderUpdate.clear();
 	m_iGroupId = 0;
 
+	std::vector<BasicItemInfo_t> items;
+	items.reserve(nItems);
+
 	for (i = 0; i < nItems; i++)
 	{
 		item.mask = LVIF_PARAM;
@@ -905,10 +961,80 @@ void ShellBrowser::MoveItemsIntoGroups()
 		item.iSubItem = 0;
 		ListView_GetItem(m_hListView, &item);
 
-		iGroupId = DetermineItemGroup((int) item.lParam);
+		items.push_back(getBasicItemInfo((int) item.lParam));
+	}
+
+	std::vector<ItemGroup> itemGroups = DetermineItemGroups(items);
+
+	for (i = 0; i < nItems; i++)
+	{
+		iGroupId = CheckGroup(itemGroups[i].header, itemGroups[i].comparison);
 
 		InsertItemIntoGroup(i, iGroupId);
 	}
 
+	UpdateGroupHeaders();
+
 	SendMessage(m_hListView, WM_SETREDRAW, (WPARAM) TRUE, (LPARAM) NULL);
+}
+
+// Determining the group of an item can be expensive (e.g. when grouping by
+// owner or by a property stored within the file), so for larger folders, the
+// work is split between several background threads. The UI thread waits for
+// all the results, so none of the state read during the process can change
+// in the meantime.
+std::vector<ShellBrowser::ItemGroup> ShellBrowser::DetermineItemGroups(
+	const std::vector<BasicItemInfo_t> &items)
+{
+	TRACE_EVENT1("group", "DetermineItemGroups", "numItems", items.size());
+
+	auto dateBucketer = CreateDateBucketerForCurrentDay();
+	auto dateType = GetGroupByDateType(m_folderSettings.sortMode);
+
+	if (dateType)
+	{
+		return DetermineItemDateGroups(items, *dateType, dateBucketer);
+	}
+
+	std::vector<ItemGroup> itemGroups(items.size());
+
+	auto globalFolderSettings = m_config->globalFolderSettingsSnapshot.get();
+
+	auto determineGroups = [this, &items, &itemGroups, globalFolderSettings, &dateBucketer](
+							   size_t start, size_t end) {
+		for (size_t i = start; i < end; i++)
+		{
+			itemGroups[i] = DetermineItemGroup(items[i], *globalFolderSettings, dateBucketer);
+		}
+	};
+
+	if (items.size() < PARALLEL_GROUPING_THRESHOLD)
+	{
+		determineGroups(0, items.size());
+		return itemGroups;
+	}
+
+	// The pool is shared between all tabs, so the tasks for this folder may be queued behind
+	// those for another folder.
+	size_t numThreads = m_groupingThreadPool->size();
+	size_t chunkSize = (items.size() + numThreads - 1) / numThreads;
+	std::vector<std::future<void>> results;
+
+	for (size_t start = 0; start < items.size(); start += chunkSize)
+	{
+		size_t end = std::min(start + chunkSize, items.size());
+
+		results.push_back(m_groupingThreadPool->push([determineGroups, start, end](int id) {
+			UNREFERENCED_PARAMETER(id);
+
+			determineGroups(start, end);
+		}));
+	}
+
+	for (auto &result : results)
+	{
+		result.get();
+	}
+
+	return itemGroups;
 }
\ No newline at end of file
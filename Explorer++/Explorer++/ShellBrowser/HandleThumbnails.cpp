@@ -6,7 +6,12 @@
 #include "ShellBrowser.h"
 #include "ItemData.h"
 #include "ViewModes.h"
+#include "../Helper/CachedIcons.h"
+#include "../Helper/ImageHelper.h"
+#include "../Helper/ImageScaling.h"
+#include "../Helper/Logging.h"
 #include "../Helper/ShellHelper.h"
+#include "../Helper/ThumbnailDiskCache.h"
 #include <boost/scope_exit.hpp>
 #include <list>
 
@@ -16,9 +21,188 @@
 #define THUMBNAIL_TYPE_ICON 0
 #define THUMBNAIL_TYPE_EXTRACTED 1
 
+namespace
+{
+// Only regular files are cached. The thumbnail for a folder is based on its
+// contents, which can change without the folder itself being modified.
+std::optional<ThumbnailKey> GetThumbnailDiskCacheKey(
+	const BasicItemInfo_t &basicItemInfo, int width, int height)
+{
+	const WIN32_FIND_DATA &wfd = basicItemInfo.wfd;
+
+	if (WI_IsFlagSet(wfd.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY)
+		|| (wfd.ftLastWriteTime.dwLowDateTime == 0 && wfd.ftLastWriteTime.dwHighDateTime == 0))
+	{
+		return std::nullopt;
+	}
+
+	ThumbnailKey key;
+	key.pathHash = CachedIcons::hashPath(basicItemInfo.getFullPath());
+	key.fileSize = (static_cast<uint64_t>(wfd.nFileSizeHigh) << 32) | wfd.nFileSizeLow;
+	key.lastWriteTime = (static_cast<uint64_t>(wfd.ftLastWriteTime.dwHighDateTime) << 32)
+		| wfd.ftLastWriteTime.dwLowDateTime;
+	key.width = width;
+	key.height = height;
+	return key;
+}
+
+std::optional<ThumbnailImage> BitmapToThumbnailImage(HBITMAP bitmap)
+{
+	BITMAP bitmapInfo;
+
+	if (GetObject(bitmap, sizeof(bitmapInfo), &bitmapInfo) == 0)
+	{
+		return std::nullopt;
+	}
+
+	ThumbnailImage image;
+	image.width = bitmapInfo.bmWidth;
+	image.height = std::abs(bitmapInfo.bmHeight);
+	image.pixels.resize(static_cast<size_t>(image.width) * image.height * 4);
+
+	// A negative height requests a top-down bitmap.
+	BITMAPINFO bmi;
+	ImageHelper::InitBitmapInfo(&bmi, sizeof(bmi), image.width, -static_cast<LONG>(image.height), 32);
+
+	HDC hdc = GetDC(nullptr);
+	int numLines = GetDIBits(
+		hdc, bitmap, 0, image.height, image.pixels.data(), &bmi, DIB_RGB_COLORS);
+	ReleaseDC(nullptr, hdc);
+
+	if (numLines != static_cast<int>(image.height))
+	{
+		return std::nullopt;
+	}
+
+	return image;
+}
+
+wil::unique_hbitmap ThumbnailImageToBitmap(const ThumbnailImage &image)
+{
+	SIZE size = { static_cast<LONG>(image.width), -static_cast<LONG>(image.height) };
+	void *bits;
+	HBITMAP bitmap;
+	HRESULT hr = ImageHelper::Create32BitHBITMAP(nullptr, &size, &bits, &bitmap);
+
+	if (FAILED(hr))
+	{
+		return nullptr;
+	}
+
+	memcpy(bits, image.pixels.data(), image.pixels.size());
+
+	return wil::unique_hbitmap(bitmap);
+}
+
+// Scales the image down so that it fits within a square of the specified
+// size.
+ThumbnailImage ScaleThumbnailImage(const ThumbnailImage &image, int size)
+{
+	auto [width, height] = ImageScaling::GetScaledSize(image.width, image.height, size, size);
+
+	if (width == image.width && height == image.height)
+	{
+		return image;
+	}
+
+	ThumbnailImage scaledImage;
+	scaledImage.width = width;
+	scaledImage.height = height;
+	scaledImage.pixels.resize(static_cast<size_t>(width) * height * 4);
+	ImageScaling::ScaleImage(image.pixels.data(), image.width, image.height,
+		scaledImage.pixels.data(), width, height);
+
+	return scaledImage;
+}
+}
+
+int ShellBrowser::GetThumbnailSize() const
+{
+	return m_thumbnailSize;
+}
+
+void ShellBrowser::SetThumbnailSize(int thumbnailSize)
+{
+	thumbnailSize = GetNearestThumbnailSize(thumbnailSize);
+
+	if (thumbnailSize == m_thumbnailSize)
+	{
+		return;
+	}
+
+	m_thumbnailSize = thumbnailSize;
+
+	if (!m_bThumbnailsSetup)
+	{
+		return;
+	}
+
+	// Any results that are still pending are for the previous size and will
+	// be ignored.
+	m_thumbnailThreadPool.clear_queue();
+	m_thumbnailResults.clear();
+
+	ListView_SetIconSpacing(m_hListView, THUMBNAIL_ITEM_HORIZONTAL_SPACING + m_thumbnailSize,
+		THUMBNAIL_ITEM_VERTICAL_SPACING + m_thumbnailSize);
+
+	CreateThumbnailsImageList();
+
+	int nItems = ListView_GetItemCount(m_hListView);
+
+	for (int i = 0; i < nItems; i++)
+	{
+		LVITEM lvItem;
+		lvItem.mask = LVIF_IMAGE;
+		lvItem.iItem = i;
+		lvItem.iSubItem = 0;
+		lvItem.iImage = I_IMAGECALLBACK;
+		ListView_SetItem(m_hListView, &lvItem);
+	}
+}
+
+bool ShellBrowser::ZoomThumbnails(bool zoomIn)
+{
+	auto itr = std::find(THUMBNAIL_SIZES.begin(), THUMBNAIL_SIZES.end(), m_thumbnailSize);
+	assert(itr != THUMBNAIL_SIZES.end());
+
+	if (zoomIn)
+	{
+		if (itr == THUMBNAIL_SIZES.end() - 1)
+		{
+			return false;
+		}
+
+		itr++;
+	}
+	else
+	{
+		if (itr == THUMBNAIL_SIZES.begin())
+		{
+			return false;
+		}
+
+		itr--;
+	}
+
+	SetThumbnailSize(*itr);
+
+	return true;
+}
+
+int ShellBrowser::GetNearestThumbnailSize(int size)
+{
+	return *std::min_element(THUMBNAIL_SIZES.begin(), THUMBNAIL_SIZES.end(),
+		[size](int size1, int size2) { return std::abs(size1 - size) < std::abs(size2 - size); });
+}
+
+// Each image in the thumbnails image list is a 32-bit bitmap.
+size_t ShellBrowser::GetThumbnailItemBytes() const
+{
+	return static_cast<size_t>(m_thumbnailSize) * m_thumbnailSize * 4;
+}
+
 void ShellBrowser::SetupThumbnailsView()
 {
-	HIMAGELIST himl;
 	LVITEM lvItem;
 	int nItems;
 	int i = 0;
@@ -38,12 +222,10 @@ void ShellBrowser::SetupThumbnailsView()
 
 	ListView_SetExtendedListViewStyleEx(m_hListView, LVS_EX_BORDERSELECT, LVS_EX_BORDERSELECT);
 
-	ListView_SetIconSpacing(m_hListView, THUMBNAIL_ITEM_HORIZONTAL_SPACING + THUMBNAIL_ITEM_WIDTH,
-		THUMBNAIL_ITEM_VERTICAL_SPACING + THUMBNAIL_ITEM_HEIGHT);
+	ListView_SetIconSpacing(m_hListView, THUMBNAIL_ITEM_HORIZONTAL_SPACING + m_thumbnailSize,
+		THUMBNAIL_ITEM_VERTICAL_SPACING + m_thumbnailSize);
 
-	himl = ImageList_Create(
-		THUMBNAIL_ITEM_WIDTH, THUMBNAIL_ITEM_HEIGHT, ILC_COLOR32, nItems, nItems + 100);
-	ListView_SetImageList(m_hListView, himl, LVSIL_NORMAL);
+	CreateThumbnailsImageList();
 
 	for (i = 0; i < nItems; i++)
 	{
@@ -74,6 +256,7 @@ void ShellBrowser::RemoveThumbnailsView()
 
 	m_thumbnailThreadPool.clear_queue();
 	m_thumbnailResults.clear();
+	m_thumbnailStore.Clear();
 
 	for (i = 0; i < nItems; i++)
 	{
@@ -92,24 +275,132 @@ void ShellBrowser::RemoveThumbnailsView()
 	m_bThumbnailsSetup = FALSE;
 }
 
+// Images are only ever added to the end of this image list. Once the
+// thumbnail budget has been reached, existing images are overwritten instead.
+void ShellBrowser::CreateThumbnailsImageList()
+{
+	auto himlOld = ListView_GetImageList(m_hListView, LVSIL_NORMAL);
+
+	int maxImages = static_cast<int>(m_thumbnailStore.GetByteBudget() / GetThumbnailItemBytes());
+	int nItems = ListView_GetItemCount(m_hListView);
+
+	HIMAGELIST himl = ImageList_Create(
+		m_thumbnailSize, m_thumbnailSize, ILC_COLOR32, (std::min)(nItems, maxImages), 100);
+	ListView_SetImageList(m_hListView, himl, LVSIL_NORMAL);
+
+	m_thumbnailStore.Clear();
+
+	// The system image list is shared and must not be destroyed.
+	if (himlOld && himlOld != m_hListViewImageList)
+	{
+		ImageList_Destroy(himlOld);
+	}
+}
+
 void ShellBrowser::QueueThumbnailTask(int internalIndex)
 {
 	int thumbnailResultID = m_thumbnailResultIDCounter++;
 
 	BasicItemInfo_t basicItemInfo = getBasicItemInfo(internalIndex);
 
-	auto result =
-		m_thumbnailThreadPool.push([this, thumbnailResultID, internalIndex, basicItemInfo](int id) {
+	auto result = m_thumbnailThreadPool.push(
+		[this, thumbnailResultID, internalIndex, basicItemInfo, thumbnailSize = m_thumbnailSize](
+			int id) {
 			UNREFERENCED_PARAMETER(id);
 
-			return FindThumbnailAsync(m_hListView, thumbnailResultID, internalIndex, basicItemInfo);
+			return FindThumbnailAsync(m_hListView, thumbnailResultID, internalIndex, basicItemInfo,
+				thumbnailSize, m_thumbnailDiskCache);
 		});
 
 	m_thumbnailResults.insert({ thumbnailResultID, std::move(result) });
 }
 
-std::optional<ShellBrowser::ThumbnailResult_t> ShellBrowser::FindThumbnailAsync(
-	HWND listView, int thumbnailResultId, int internalIndex, const BasicItemInfo_t &basicItemInfo)
+// Without the disk cache, the thumbnail is extracted at the size it will be
+// displayed at. When the disk cache is enabled, the thumbnail is instead
+// extracted at the largest size and the full size image is stored alongside
+// the requested size, so that switching to another size later on only
+// requires the cached image to be scaled, rather than the file being decoded
+// again.
+std::optional<ShellBrowser::ThumbnailResult_t> ShellBrowser::FindThumbnailAsync(HWND listView,
+	int thumbnailResultId, int internalIndex, const BasicItemInfo_t &basicItemInfo,
+	int thumbnailSize, ThumbnailDiskCache *thumbnailDiskCache)
+{
+	const int sourceSize = THUMBNAIL_SIZES.back();
+
+	std::optional<ThumbnailKey> cacheKey;
+	std::optional<ThumbnailKey> sourceCacheKey;
+
+	if (thumbnailDiskCache)
+	{
+		cacheKey = GetThumbnailDiskCacheKey(basicItemInfo, thumbnailSize, thumbnailSize);
+		sourceCacheKey = GetThumbnailDiskCacheKey(basicItemInfo, sourceSize, sourceSize);
+	}
+
+	std::optional<ThumbnailImage> image;
+
+	if (cacheKey)
+	{
+		image = thumbnailDiskCache->Find(*cacheKey);
+	}
+
+	if (!image)
+	{
+		bool useSourceImage = sourceCacheKey && thumbnailSize != sourceSize;
+		std::optional<ThumbnailImage> sourceImage;
+
+		if (useSourceImage)
+		{
+			sourceImage = thumbnailDiskCache->Find(*sourceCacheKey);
+		}
+
+		if (!sourceImage)
+		{
+			auto sourceBitmap =
+				ExtractThumbnail(basicItemInfo, useSourceImage ? sourceSize : thumbnailSize);
+
+			if (!sourceBitmap)
+			{
+				return std::nullopt;
+			}
+
+			sourceImage = BitmapToThumbnailImage(sourceBitmap.get());
+
+			if (!sourceImage)
+			{
+				return std::nullopt;
+			}
+
+			if (useSourceImage)
+			{
+				thumbnailDiskCache->Add(*sourceCacheKey, *sourceImage);
+			}
+		}
+
+		image = ScaleThumbnailImage(*sourceImage, thumbnailSize);
+
+		if (cacheKey)
+		{
+			thumbnailDiskCache->Add(*cacheKey, *image);
+		}
+	}
+
+	wil::unique_hbitmap thumbnailBitmap = ThumbnailImageToBitmap(*image);
+
+	if (!thumbnailBitmap)
+	{
+		return std::nullopt;
+	}
+
+	PostMessage(listView, WM_APP_THUMBNAIL_RESULT_READY, thumbnailResultId, 0);
+
+	ThumbnailResult_t result;
+	result.itemInternalIndex = internalIndex;
+	result.bitmap = std::move(thumbnailBitmap);
+
+	return result;
+}
+
+wil::unique_hbitmap ShellBrowser::ExtractThumbnail(const BasicItemInfo_t &basicItemInfo, int size)
 {
 	IShellFolder *pShellFolder = nullptr;
 	HRESULT hr =
@@ -117,7 +408,7 @@ std::optional<ShellBrowser::ThumbnailResult_t> ShellBrowser::FindThumbnailAsync(
 
 	if (FAILED(hr))
 	{
-		return std::nullopt;
+		return nullptr;
 	}
 
 	BOOST_SCOPE_EXIT(pShellFolder)
@@ -133,7 +424,7 @@ std::optional<ShellBrowser::ThumbnailResult_t> ShellBrowser::FindThumbnailAsync(
 
 	if (FAILED(hr))
 	{
-		return std::nullopt;
+		return nullptr;
 	}
 
 	BOOST_SCOPE_EXIT(pExtractImage)
@@ -142,9 +433,9 @@ std::optional<ShellBrowser::ThumbnailResult_t> ShellBrowser::FindThumbnailAsync(
 	}
 	BOOST_SCOPE_EXIT_END
 
-	SIZE size;
-	size.cx = THUMBNAIL_ITEM_WIDTH;
-	size.cy = THUMBNAIL_ITEM_HEIGHT;
+	SIZE thumbnailSize;
+	thumbnailSize.cx = size;
+	thumbnailSize.cy = size;
 
 	DWORD dwFlags = IEIFLAG_OFFLINE | IEIFLAG_QUALITY;
 
@@ -153,11 +444,11 @@ std::optional<ShellBrowser::ThumbnailResult_t> ShellBrowser::FindThumbnailAsync(
 	TCHAR szImage[MAX_PATH];
 	DWORD dwPriority;
 	hr = pExtractImage->GetLocation(
-		szImage, SIZEOF_ARRAY(szImage), &dwPriority, &size, 32, &dwFlags);
+		szImage, SIZEOF_ARRAY(szImage), &dwPriority, &thumbnailSize, 32, &dwFlags);
 
 	if (FAILED(hr))
 	{
-		return std::nullopt;
+		return nullptr;
 	}
 
 	wil::unique_hbitmap thumbnailBitmap;
@@ -165,16 +456,10 @@ std::optional<ShellBrowser::ThumbnailResult_t> ShellBrowser::FindThumbnailAsync(
 
 	if (FAILED(hr))
 	{
-		return std::nullopt;
+		return nullptr;
 	}
 
-	PostMessage(listView, WM_APP_THUMBNAIL_RESULT_READY, thumbnailResultId, 0);
-
-	ThumbnailResult_t result;
-	result.itemInternalIndex = internalIndex;
-	result.bitmap = std::move(thumbnailBitmap);
-
-	return result;
+	return thumbnailBitmap;
 }
 
 void ShellBrowser::ProcessThumbnailResult(int thumbnailResultId)
@@ -199,8 +484,6 @@ void ShellBrowser::ProcessThumbnailResult(int thumbnailResultId)
 		return;
 	}
 
-	int imageIndex = GetExtractedThumbnail(result->bitmap.get());
-
 	auto index = LocateItemByInternalIndex(result->itemInternalIndex);
 
 	if (!index)
@@ -208,28 +491,77 @@ void ShellBrowser::ProcessThumbnailResult(int thumbnailResultId)
 		return;
 	}
 
-	LVITEM lvItem;
-	lvItem.mask = LVIF_IMAGE;
-	lvItem.iItem = *index;
-	lvItem.iSubItem = 0;
-	lvItem.iImage = imageIndex;
-	ListView_SetItem(m_hListView, &lvItem);
+	// If the item's placeholder has been evicted in the meantime, the
+	// thumbnail will be requested again when the item is next shown.
+	auto slot = m_thumbnailStore.GetSlot(result->itemInternalIndex);
+
+	if (!slot)
+	{
+		return;
+	}
+
+	// The extracted thumbnail replaces the placeholder image in the same slot,
+	// so the item itself doesn't need to be updated, just redrawn.
+	SetExtractedThumbnail(*slot, result->bitmap.get());
+	ListView_RedrawItems(m_hListView, *index, *index);
 }
 
 /* Draws a thumbnail based on an items icon. */
-int ShellBrowser::GetIconThumbnail(int iInternalIndex) const
+int ShellBrowser::GetIconThumbnail(int iInternalIndex)
 {
-	return GetThumbnailInternal(THUMBNAIL_TYPE_ICON, iInternalIndex, nullptr);
+	int slot = AllocateThumbnailSlot(iInternalIndex);
+	SetThumbnailInternal(slot, THUMBNAIL_TYPE_ICON, iInternalIndex, nullptr);
+	return slot;
 }
 
 /* Draws an items extracted thumbnail. */
-int ShellBrowser::GetExtractedThumbnail(HBITMAP hThumbnailBitmap) const
+void ShellBrowser::SetExtractedThumbnail(int slot, HBITMAP hThumbnailBitmap) const
 {
-	return GetThumbnailInternal(THUMBNAIL_TYPE_EXTRACTED, 0, hThumbnailBitmap);
+	SetThumbnailInternal(slot, THUMBNAIL_TYPE_EXTRACTED, 0, hThumbnailBitmap);
 }
 
-int ShellBrowser::GetThumbnailInternal(
-	int iType, int iInternalIndex, HBITMAP hThumbnailBitmap) const
+int ShellBrowser::AllocateThumbnailSlot(int internalIndex)
+{
+	auto result = m_thumbnailStore.Insert(internalIndex, GetThumbnailItemBytes(),
+		std::bind(&ShellBrowser::CanEvictThumbnail, this, std::placeholders::_1));
+
+	// Any item whose thumbnail was evicted is switched back to a callback
+	// image, so that its thumbnail will be regenerated if the item is shown
+	// again.
+	for (int evictedInternalIndex : result.evictedKeys)
+	{
+		auto index = LocateItemByInternalIndex(evictedInternalIndex);
+
+		if (!index)
+		{
+			continue;
+		}
+
+		LVITEM lvItem;
+		lvItem.mask = LVIF_IMAGE;
+		lvItem.iItem = *index;
+		lvItem.iSubItem = 0;
+		lvItem.iImage = I_IMAGECALLBACK;
+		ListView_SetItem(m_hListView, &lvItem);
+	}
+
+	return result.slot;
+}
+
+bool ShellBrowser::CanEvictThumbnail(int internalIndex) const
+{
+	auto index = LocateItemByInternalIndex(internalIndex);
+
+	if (!index)
+	{
+		return true;
+	}
+
+	return !ListView_IsItemVisible(m_hListView, *index);
+}
+
+void ShellBrowser::SetThumbnailInternal(
+	int slot, int iType, int iInternalIndex, HBITMAP hThumbnailBitmap) const
 {
 	HDC hdc;
 	HDC hdcBacking;
@@ -237,20 +569,20 @@ int ShellBrowser::GetThumbnailInternal(
 	HBITMAP hBackingBitmapOld;
 	HIMAGELIST himl;
 	HBRUSH hbr;
-	int iImage;
 
 	hdc = GetDC(m_hListView);
 	hdcBacking = CreateCompatibleDC(hdc);
 
 	/* Backing bitmap. */
-	hBackingBitmap = CreateCompatibleBitmap(hdc, THUMBNAIL_ITEM_WIDTH, THUMBNAIL_ITEM_HEIGHT);
+	hBackingBitmap = CreateCompatibleBitmap(hdc, m_thumbnailSize, m_thumbnailSize);
 	hBackingBitmapOld = (HBITMAP) SelectObject(hdcBacking, hBackingBitmap);
 
 	/* Set the background of the new bitmap to be the same color as the
 	background in the listview. */
 	hbr = CreateSolidBrush(ListView_GetBkColor(m_hListView));
-	RECT rect = { 0, 0, THUMBNAIL_ITEM_WIDTH, THUMBNAIL_ITEM_HEIGHT };
+	RECT rect = { 0, 0, m_thumbnailSize, m_thumbnailSize };
 	FillRect(hdcBacking, &rect, hbr);
+	DeleteObject(hbr);
 
 	if (iType == THUMBNAIL_TYPE_ICON)
 	{
@@ -269,14 +601,19 @@ int ShellBrowser::GetThumbnailInternal(
 	DeleteDC(hdcBacking);
 	ReleaseDC(m_hListView, hdc);
 
-	/* Add the new bitmap to the imagelist. */
+	/* Store the new bitmap in the slot. Slots are handed out sequentially, so
+	a new slot is always at the end of the imagelist. */
 	himl = ListView_GetImageList(m_hListView, LVSIL_NORMAL);
-	iImage = ImageList_Add(himl, hBackingBitmap, nullptr);
+
+	if (slot >= ImageList_GetImageCount(himl))
+	{
+		ImageList_SetImageCount(himl, slot + 1);
+	}
+
+	ImageList_Replace(himl, slot, hBackingBitmap, nullptr);
 
 	/* Now delete the backing bitmap. */
 	DeleteObject(hBackingBitmap);
-
-	return iImage;
 }
 
 void ShellBrowser::DrawIconThumbnailInternal(HDC hdcBacking, int iInternalIndex) const
@@ -293,8 +630,8 @@ void ShellBrowser::DrawIconThumbnailInternal(HDC hdcBacking, int iInternalIndex)
 
 	ImageList_GetIconSize(m_hListViewImageList, &iIconWidth, &iIconHeight);
 
-	DrawIconEx(hdcBacking, (THUMBNAIL_ITEM_WIDTH - iIconWidth) / 2,
-		(THUMBNAIL_ITEM_HEIGHT - iIconHeight) / 2, hIcon, 0, 0, 0, nullptr, DI_NORMAL);
+	DrawIconEx(hdcBacking, (m_thumbnailSize - iIconWidth) / 2, (m_thumbnailSize - iIconHeight) / 2,
+		hIcon, 0, 0, 0, nullptr, DI_NORMAL);
 	DestroyIcon(hIcon);
 }
 
@@ -312,9 +649,8 @@ void ShellBrowser::DrawThumbnailInternal(HDC hdcBacking, HBITMAP hThumbnailBitma
 
 	/* Now, draw the thumbnail bitmap (in its centered position)
 	directly on top of the new bitmap. */
-	BitBlt(hdcBacking, (THUMBNAIL_ITEM_WIDTH - bm.bmWidth) / 2,
-		(THUMBNAIL_ITEM_HEIGHT - bm.bmHeight) / 2, THUMBNAIL_ITEM_WIDTH, THUMBNAIL_ITEM_HEIGHT,
-		hdcThumbnail, 0, 0, SRCCOPY);
+	BitBlt(hdcBacking, (m_thumbnailSize - bm.bmWidth) / 2, (m_thumbnailSize - bm.bmHeight) / 2,
+		m_thumbnailSize, m_thumbnailSize, hdcThumbnail, 0, 0, SRCCOPY);
 
 	SelectObject(hdcThumbnail, hThumbnailBitmapOld);
 	DeleteDC(hdcThumbnail);
@@ -17,6 +17,7 @@
 #include "../Helper/IconFetcher.h"
 #include "../Helper/ListViewHelper.h"
 #include "../Helper/ShellHelper.h"
+#include "../Helper/Tracing.h"
 #include <boost/format.hpp>
 #include <wil/common.h>
 
@@ -57,6 +58,8 @@ LRESULT CALLBACK ShellBrowser::ListViewProcStub(
 
 LRESULT CALLBACK ShellBrowser::ListViewProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
+	TRACE_EVENT1("messages", "ListViewMessage", "message", uMsg);
+
 	switch (uMsg)
 	{
 	case WM_MBUTTONDOWN:
@@ -117,6 +120,10 @@ LRESULT CALLBACK ShellBrowser::ListViewProc(HWND hwnd, UINT uMsg, WPARAM wParam,
 	case WM_APP_INFO_TIP_READY:
 		ProcessInfoTipResult(static_cast<int>(wParam));
 		break;
+
+	case WM_APP_FOLDER_REVALIDATION_READY:
+		ProcessFolderRevalidationResult(static_cast<int>(wParam));
+		break;
 	}
 
 	return DefSubclassProc(hwnd, uMsg, wParam, lParam);
@@ -152,6 +159,10 @@ LRESULT CALLBACK ShellBrowser::ListViewParentProc(
 				OnListViewItemChanged(reinterpret_cast<NMLISTVIEW *>(lParam));
 				break;
 
+			case LVN_HOTTRACK:
+				OnListViewHotTrack(reinterpret_cast<NMLISTVIEW *>(lParam));
+				break;
+
 			case LVN_KEYDOWN:
 				OnListViewKeyDown(reinterpret_cast<NMLVKEYDOWN *>(lParam));
 				break;
@@ -248,10 +259,23 @@ void ShellBrowser::OnListViewGetDisplayInfo(LPARAM lParam)
 	if (m_folderSettings.viewMode == +ViewMode::Thumbnails
 		&& (plvItem->mask & LVIF_IMAGE) == LVIF_IMAGE)
 	{
-		plvItem->iImage = GetIconThumbnail(internalIndex);
-		plvItem->mask |= LVIF_DI_SETITEM;
+		// If the item still has a slot (e.g. because its image was reset by
+		// something other than an eviction), the existing thumbnail can be
+		// reused.
+		auto slot = m_thumbnailStore.Lookup(internalIndex);
+
+		if (slot)
+		{
+			plvItem->iImage = *slot;
+		}
+		else
+		{
+			plvItem->iImage = GetIconThumbnail(internalIndex);
 
-		QueueThumbnailTask(internalIndex);
+			QueueThumbnailTask(internalIndex);
+		}
+
+		plvItem->mask |= LVIF_DI_SETITEM;
 
 		return;
 	}
@@ -321,14 +345,11 @@ std::optional<int> ShellBrowser::GetCachedIconIndex(const ItemInfo_t &itemInfo)
 		return std::nullopt;
 	}
 
-	auto cachedItr = m_cachedIcons->findByPath(filePath);
-
-	if (cachedItr == m_cachedIcons->end())
-	{
-		return std::nullopt;
-	}
+	auto itemType = WI_IsFlagSet(itemInfo.wfd.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY)
+		? CachedIcons::ItemType::Folder
+		: CachedIcons::ItemType::File;
 
-	return cachedItr->iconIndex;
+	return m_cachedIcons->findByPath(filePath, itemType);
 }
 
 void ShellBrowser::ProcessIconResult(int internalIndex, int iconIndex)
@@ -368,16 +389,18 @@ void ShellBrowser::QueueInfoTipTask(int internalIndex, const std::wstring &exist
 	int infoTipResultId = m_infoTipResultIDCounter++;
 
 	BasicItemInfo_t basicItemInfo = getBasicItemInfo(internalIndex);
-	Config configCopy = *m_config;
+	InfoTipType infoTipType = m_config->infoTipType;
+	auto globalFolderSettings = m_config->globalFolderSettingsSnapshot.get();
 	bool virtualFolder = InVirtualFolder();
 
-	auto result =
-		m_infoTipsThreadPool.push([this, infoTipResultId, internalIndex, basicItemInfo, configCopy,
-									  virtualFolder, existingInfoTip](int id) {
+	auto result = m_infoTipsThreadPool.push(
+		[this, infoTipResultId, internalIndex, basicItemInfo, infoTipType, globalFolderSettings,
+			virtualFolder, existingInfoTip](int id) {
 			UNREFERENCED_PARAMETER(id);
 
 			auto result = GetInfoTipAsync(m_hListView, infoTipResultId, internalIndex,
-				basicItemInfo, configCopy, m_hResourceModule, virtualFolder);
+				basicItemInfo, infoTipType, *globalFolderSettings, m_hResourceModule,
+				virtualFolder);
 
 			// If the item name is truncated in the listview,
 			// existingInfoTip will contain that value. Therefore, it's
@@ -396,13 +419,14 @@ void ShellBrowser::QueueInfoTipTask(int internalIndex, const std::wstring &exist
 
 std::optional<ShellBrowser::InfoTipResult> ShellBrowser::GetInfoTipAsync(HWND listView,
 	int infoTipResultId, int internalIndex, const BasicItemInfo_t &basicItemInfo,
-	const Config &config, HINSTANCE instance, bool virtualFolder)
+	InfoTipType infoTipType, const GlobalFolderSettings &globalFolderSettings, HINSTANCE instance,
+	bool virtualFolder)
 {
 	std::wstring infoTip;
 
 	/* Use Explorer infotips if the option is selected, or this is a
 	virtual folder. Otherwise, show the modified date. */
-	if ((config.infoTipType == InfoTipType::System) || virtualFolder)
+	if ((infoTipType == InfoTipType::System) || virtualFolder)
 	{
 		TCHAR infoTipText[256];
 		HRESULT hr = GetItemInfoTip(
@@ -423,7 +447,7 @@ std::optional<ShellBrowser::InfoTipResult> ShellBrowser::GetInfoTipAsync(HWND li
 		TCHAR fileModificationText[256];
 		BOOL fileTimeResult =
 			CreateFileTimeString(&basicItemInfo.wfd.ftLastWriteTime, fileModificationText,
-				SIZEOF_ARRAY(fileModificationText), config.globalFolderSettings.showFriendlyDates);
+				SIZEOF_ARRAY(fileModificationText), globalFolderSettings.showFriendlyDates);
 
 		if (!fileTimeResult)
 		{
@@ -518,9 +542,35 @@ void ShellBrowser::OnListViewItemChanged(const NMLISTVIEW *changeData)
 
 	UpdateFileSelectionInfo(static_cast<int>(changeData->lParam), currentlySelected);
 
+	if (currentlySelected && ListView_GetSelectedCount(m_hListView) == 1)
+	{
+		PrefetchItem(static_cast<int>(changeData->lParam));
+	}
+
 	listViewSelectionChanged.m_signal();
 }
 
+void ShellBrowser::OnListViewHotTrack(const NMLISTVIEW *hotTrackData)
+{
+	if (hotTrackData->iItem == -1 || hotTrackData->iItem == m_lastHotTrackedItem)
+	{
+		return;
+	}
+
+	m_lastHotTrackedItem = hotTrackData->iItem;
+
+	LVITEM lvItem;
+	lvItem.mask = LVIF_PARAM;
+	lvItem.iItem = hotTrackData->iItem;
+	lvItem.iSubItem = 0;
+	BOOL res = ListView_GetItem(m_hListView, &lvItem);
+
+	if (res)
+	{
+		PrefetchItem(static_cast<int>(lvItem.lParam));
+	}
+}
+
 void ShellBrowser::UpdateFileSelectionInfo(int internalIndex, BOOL selected)
 {
 	ULARGE_INTEGER ulFileSize;
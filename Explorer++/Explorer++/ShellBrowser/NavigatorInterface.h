@@ -12,6 +12,10 @@ typedef boost::signals2::signal<void(PCIDLIST_ABSOLUTE pidlDirectory, bool addHi
 __interface NavigatorInterface
 {
 	HRESULT BrowseFolder(PCIDLIST_ABSOLUTE pidlDirectory, bool addHistoryEntry = true);
+
+	// Called when navigating to an existing history entry (e.g. when going
+	// back or forward). A history entry won't be added in this case.
+	HRESULT BrowseFolderFromHistory(PCIDLIST_ABSOLUTE pidlDirectory);
 	boost::signals2::connection AddNavigationCompletedObserver(
 		const NavigationCompletedSignal::slot_type &observer,
 		boost::signals2::connect_position position = boost::signals2::at_back);
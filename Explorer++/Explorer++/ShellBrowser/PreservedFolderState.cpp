@@ -4,9 +4,8 @@
 
 #include "stdafx.h"
 #include "PreservedFolderState.h"
-#include "ShellBrowser.h"
 
-PreservedFolderState::PreservedFolderState(const ShellBrowser *shellBrowser) :
-	folderSettings(shellBrowser->GetFolderSettings())
+PreservedFolderState::PreservedFolderState(const FolderSettings &folderSettings) :
+	folderSettings(folderSettings)
 {
 }
\ No newline at end of file
@@ -7,12 +7,10 @@
 #include "FolderSettings.h"
 #include "../Helper/Macros.h"
 
-class ShellBrowser;
-
 struct PreservedFolderState
 {
 public:
-	PreservedFolderState(const ShellBrowser *shellBrowser);
+	PreservedFolderState(const FolderSettings &folderSettings);
 
 	FolderSettings folderSettings;
 
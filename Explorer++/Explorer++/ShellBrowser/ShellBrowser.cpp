@@ -7,6 +7,8 @@
 #include "Config.h"
 #include "CoreInterface.h"
 #include "DarkModeHelper.h"
+#include "FolderListingCache.h"
+#include "FolderViewState.h"
 #include "ItemData.h"
 #include "MainResource.h"
 #include "MassRenameDialog.h"
@@ -23,6 +25,7 @@
 #include "../Helper/ListViewHelper.h"
 #include "../Helper/Macros.h"
 #include "../Helper/ShellHelper.h"
+#include "../Helper/Tracing.h"
 #include <boost/scope_exit.hpp>
 #include <wil/com.h>
 #include <list>
@@ -115,20 +118,38 @@ ShellBrowser::ShellBrowser(int id, HWND hOwner, IExplorerplusplus *coreInterface
 	m_folderColumns(initialColumns
 			? *initialColumns
 			: coreInterface->GetConfig()->globalFolderSettings.folderColumns),
+	m_itemInfoMap(decltype(m_itemInfoMap)::allocator_type(&m_itemsMemoryCounter)),
 	m_columnThreadPool(
 		1, std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED), CoUninitialize),
+	m_columnResults(decltype(m_columnResults)::allocator_type(&m_pendingTasksMemoryCounter)),
 	m_columnResultIDCounter(0),
 	m_thumbnailThreadPool(
 		1, std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED), CoUninitialize),
+	m_thumbnailResults(
+		decltype(m_thumbnailResults)::allocator_type(&m_pendingTasksMemoryCounter)),
 	m_thumbnailResultIDCounter(0),
+	m_thumbnailStore(
+		static_cast<size_t>(coreInterface->GetConfig()->thumbnailCacheSize) * 1024 * 1024),
+	m_thumbnailDiskCache(coreInterface->GetThumbnailDiskCache()),
+	m_thumbnailSize(GetNearestThumbnailSize(coreInterface->GetConfig()->thumbnailSize)),
 	m_infoTipsThreadPool(
 		1, std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED), CoUninitialize),
-	m_infoTipResultIDCounter(0)
+	m_infoTipResults(decltype(m_infoTipResults)::allocator_type(&m_pendingTasksMemoryCounter)),
+	m_infoTipResultIDCounter(0),
+	m_folderListingCache(coreInterface->GetFolderListingCache()),
+	m_groupingThreadPool(coreInterface->GetGroupingThreadPool()),
+	m_folderRevalidationThreadPool(
+		1, std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED), CoUninitialize),
+	m_folderRevalidationResults(
+		decltype(m_folderRevalidationResults)::allocator_type(&m_pendingTasksMemoryCounter)),
+	m_folderRevalidationResultIDCounter(0),
+	m_folderPrefetcher(coreInterface->GetFolderPrefetcher())
 {
 	m_iRefCount = 1;
 
 	m_hListView = SetUpListView(hOwner);
-	m_iconFetcher = std::make_unique<IconFetcher>(m_hListView, m_cachedIcons);
+	m_iconFetcher =
+		std::make_unique<IconFetcher>(m_hListView, coreInterface->GetIconResolutionService());
 	m_navigationController =
 		std::make_unique<ShellNavigationController>(this, tabNavigation, m_iconFetcher.get());
 
@@ -149,6 +170,7 @@ ShellBrowser::ShellBrowser(int id, HWND hOwner, IExplorerplusplus *coreInterface
 	m_bNewItemCreated = FALSE;
 	m_iDropped = -1;
 	m_middleButtonItem = -1;
+	m_lastHotTrackedItem = -1;
 
 	m_uniqueFolderId = 0;
 
@@ -163,6 +185,14 @@ ShellBrowser::ShellBrowser(int id, HWND hOwner, IExplorerplusplus *coreInterface
 
 	m_connections.push_back(coreInterface->AddApplicationShuttingDownObserver(
 		std::bind(&ShellBrowser::OnApplicationShuttingDown, this)));
+
+	MemoryAccountant *memoryAccountant = coreInterface->GetMemoryAccountant();
+	m_memoryRegistrations.push_back(
+		memoryAccountant->AddCounter(L"Items", m_ID, &m_itemsMemoryCounter));
+	m_memoryRegistrations.push_back(
+		memoryAccountant->AddCounter(L"Pending tasks", m_ID, &m_pendingTasksMemoryCounter));
+	m_memoryRegistrations.push_back(memoryAccountant->AddSource(
+		L"Thumbnails", m_ID, [this] { return m_thumbnailStore.GetStats().residentBytes; }));
 }
 
 ShellBrowser::~ShellBrowser()
@@ -174,6 +204,7 @@ ShellBrowser::~ShellBrowser()
 	m_columnThreadPool.clear_queue();
 	m_thumbnailThreadPool.clear_queue();
 	m_infoTipsThreadPool.clear_queue();
+	m_folderRevalidationThreadPool.clear_queue();
 
 	/* Release the drag and drop helpers. */
 	m_pDropTargetHelper->Release();
@@ -1151,6 +1182,8 @@ BOOL ShellBrowser::GetFilterCaseSensitive() const
 
 void ShellBrowser::UpdateFiltering()
 {
+	TRACE_EVENT("filter", "UpdateFiltering");
+
 	if (m_folderSettings.applyFilter)
 	{
 		RemoveFilteredItems();
@@ -1363,6 +1396,110 @@ void ShellBrowser::SelectItems(const std::list<std::wstring> &PastedFileList)
 	}
 }
 
+FolderViewState ShellBrowser::GetViewState() const
+{
+	FolderViewState viewState;
+
+	int index = -1;
+
+	while ((index = ListView_GetNextItem(m_hListView, index, LVNI_SELECTED)) != -1)
+	{
+		viewState.selectedItems.emplace_back(GetItemByIndex(index).wfd.cFileName);
+	}
+
+	int focusedIndex = ListView_GetNextItem(m_hListView, -1, LVNI_FOCUSED);
+
+	if (focusedIndex != -1)
+	{
+		viewState.focusedItem = GetItemByIndex(focusedIndex).wfd.cFileName;
+	}
+
+	viewState.scrollOffset = {};
+
+	if (m_folderSettings.viewMode == +ViewMode::Details
+		|| m_folderSettings.viewMode == +ViewMode::List)
+	{
+		int topIndex = ListView_GetTopIndex(m_hListView);
+
+		if (topIndex >= 0 && topIndex < ListView_GetItemCount(m_hListView))
+		{
+			viewState.topItem = GetItemByIndex(topIndex).wfd.cFileName;
+		}
+	}
+	else
+	{
+		ListView_GetOrigin(m_hListView, &viewState.scrollOffset);
+	}
+
+	return viewState;
+}
+
+// Should be called once the folder the state was taken from has been
+// navigated back to. Items that no longer exist are ignored.
+void ShellBrowser::RestoreViewState(const FolderViewState &viewState)
+{
+	std::unordered_set<std::wstring> selectedItems(
+		viewState.selectedItems.begin(), viewState.selectedItems.end());
+
+	int numItems = ListView_GetItemCount(m_hListView);
+	int topIndex = -1;
+
+	for (int i = 0; i < numItems; i++)
+	{
+		const std::wstring fileName = GetItemByIndex(i).wfd.cFileName;
+
+		if (selectedItems.count(fileName) > 0)
+		{
+			ListViewHelper::SelectItem(m_hListView, i, TRUE);
+		}
+
+		if (viewState.focusedItem && fileName == *viewState.focusedItem)
+		{
+			ListViewHelper::FocusItem(m_hListView, i, TRUE);
+		}
+
+		if (viewState.topItem && fileName == *viewState.topItem)
+		{
+			topIndex = i;
+		}
+	}
+
+	if (topIndex != -1)
+	{
+		RECT currentTopItemRect;
+		RECT itemRect;
+
+		if (ListView_GetItemRect(m_hListView, ListView_GetTopIndex(m_hListView),
+				&currentTopItemRect, LVIR_BOUNDS)
+			&& ListView_GetItemRect(m_hListView, topIndex, &itemRect, LVIR_BOUNDS))
+		{
+			// The details view scrolls vertically, while the list view scrolls
+			// horizontally (by column).
+			if (m_folderSettings.viewMode == +ViewMode::Details)
+			{
+				ListView_Scroll(m_hListView, 0, itemRect.top - currentTopItemRect.top);
+			}
+			else
+			{
+				ListView_Scroll(m_hListView, itemRect.left - currentTopItemRect.left, 0);
+			}
+		}
+	}
+	else if (viewState.scrollOffset.x != 0 || viewState.scrollOffset.y != 0)
+	{
+		ListView_Scroll(m_hListView, viewState.scrollOffset.x, viewState.scrollOffset.y);
+	}
+}
+
+// This is the memory used by the items in the current folder, any pending
+// tasks and the current set of thumbnails. It doesn't include the memory used
+// by the listview itself.
+size_t ShellBrowser::GetMemoryUsage() const
+{
+	return sizeof(*this) + m_itemsMemoryCounter.GetBytes()
+		+ m_pendingTasksMemoryCounter.GetBytes() + m_thumbnailStore.GetStats().residentBytes;
+}
+
 void ShellBrowser::OnDeviceChange(WPARAM wParam, LPARAM lParam)
 {
 	/* Note changes made here may have no effect. Since
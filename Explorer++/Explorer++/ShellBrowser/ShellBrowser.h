@@ -6,22 +6,29 @@
 
 #include "ColumnDataRetrieval.h"
 #include "Columns.h"
+#include "FolderListing.h"
 #include "FolderSettings.h"
 #include "NavigatorInterface.h"
 #include "SignalWrapper.h"
 #include "SortModes.h"
+#include "ThumbnailStore.h"
 #include "ViewModes.h"
+#include "../Helper/DateBucketer.h"
 #include "../Helper/DropHandler.h"
 #include "../Helper/Macros.h"
+#include "../Helper/MemoryAccounting.h"
 #include "../Helper/ShellHelper.h"
 #include "../ThirdParty/CTPL/cpl_stl.h"
 #include <boost/signals2.hpp>
 #include <wil/com.h>
 #include <wil/resource.h>
+#include <array>
 #include <future>
 #include <list>
 #include <optional>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #define WM_USER_UPDATEWINDOWS (WM_APP + 17)
 #define WM_USER_FILESADDED (WM_APP + 51)
@@ -33,13 +40,18 @@ struct BasicItemInfo_t;
 class CachedIcons;
 struct Config;
 class FileActionHandler;
+class FolderListingCache;
+class FolderPrefetcher;
+struct FolderViewState;
 class IconFetcher;
 class IconResourceLoader;
 __interface IExplorerplusplus;
+enum class InfoTipType;
 struct PreservedFolderState;
 struct PreservedHistoryEntry;
 class ShellNavigationController;
 __interface TabNavigationInterface;
+class ThumbnailDiskCache;
 class WindowSubclassWrapper;
 
 typedef struct
@@ -101,6 +113,12 @@ public:
 	ViewMode GetViewMode() const;
 	void SetViewMode(ViewMode viewMode);
 	void CycleViewMode(bool cycleForward);
+	int GetThumbnailSize() const;
+	void SetThumbnailSize(int thumbnailSize);
+
+	// Moves to the next larger/smaller thumbnail size. Returns false if the
+	// size is already at the end of the range.
+	bool ZoomThumbnails(bool zoomIn);
 	SortMode GetSortMode() const;
 	void SetSortMode(SortMode sortMode);
 	void SortFolder(SortMode sortMode);
@@ -173,6 +191,13 @@ public:
 	FolderColumns ExportAllColumns();
 	void QueueRename(PCIDLIST_ABSOLUTE pidlItem);
 	void SelectItems(const std::list<std::wstring> &PastedFileList);
+	FolderViewState GetViewState() const;
+	void RestoreViewState(const FolderViewState &viewState);
+	size_t GetMemoryUsage() const;
+
+	// Adds the current folder listing to the listing cache. This happens
+	// automatically when navigating away from a folder.
+	void StoreFolderListing();
 	void OnDeviceChange(WPARAM wParam, LPARAM lParam);
 
 	void OnGridlinesSettingChanged();
@@ -184,6 +209,12 @@ public:
 private:
 	DISALLOW_COPY_AND_ASSIGN(ShellBrowser);
 
+	// Maps an internal ID to a value, with the memory used by the map being
+	// recorded against a MemoryCounter.
+	template <typename T>
+	using CountedMap = std::unordered_map<int, T, std::hash<int>, std::equal_to<int>,
+		CountingAllocator<std::pair<const int, T>>>;
+
 	struct DirectoryState
 	{
 		unique_pidl_absolute pidlDirectory;
@@ -265,6 +296,17 @@ private:
 		std::wstring infoTip;
 	};
 
+	struct FolderRevalidationResult
+	{
+		std::vector<FolderListingChange> changes;
+	};
+
+	struct ItemGroup
+	{
+		std::wstring header;
+		PFNLVGROUPCOMPARE comparison;
+	};
+
 	enum class GroupByDateType
 	{
 		Created,
@@ -280,9 +322,17 @@ private:
 	static const UINT WM_APP_COLUMN_RESULT_READY = WM_APP + 150;
 	static const UINT WM_APP_THUMBNAIL_RESULT_READY = WM_APP + 151;
 	static const UINT WM_APP_INFO_TIP_READY = WM_APP + 152;
+	static const UINT WM_APP_FOLDER_REVALIDATION_READY = WM_APP + 153;
+
+	// When grouping at least this many items, the group for each item will be
+	// determined on a set of background threads.
+	static const size_t PARALLEL_GROUPING_THRESHOLD = 1000;
 
-	static const int THUMBNAIL_ITEM_WIDTH = 120;
-	static const int THUMBNAIL_ITEM_HEIGHT = 120;
+	// The sizes that thumbnails can be shown at, in ascending order. Each
+	// thumbnail is only extracted once, at the largest size, and then scaled
+	// down to every other size, so that changing the size doesn't require the
+	// source file to be decoded again.
+	static constexpr std::array<int, 6> THUMBNAIL_SIZES = { 64, 96, 120, 160, 192, 256 };
 
 	ShellBrowser(int id, HWND hOwner, IExplorerplusplus *coreInterface,
 		TabNavigationInterface *tabNavigation, FileActionHandler *fileActionHandler,
@@ -301,8 +351,11 @@ private:
 
 	/* NavigatorInterface methods. */
 	HRESULT BrowseFolder(PCIDLIST_ABSOLUTE pidlDirectory, bool addHistoryEntry = true) override;
+	HRESULT BrowseFolderFromHistory(PCIDLIST_ABSOLUTE pidlDirectory) override;
 
 	/* Browsing support. */
+	HRESULT BrowseFolderInternal(PCIDLIST_ABSOLUTE pidlDirectory, bool addHistoryEntry,
+		std::shared_ptr<const FolderListing> cachedListing);
 	HRESULT EnumerateFolder(PCIDLIST_ABSOLUTE pidlDirectory);
 	void ClearPendingResults();
 	void ResetFolderState();
@@ -320,6 +373,21 @@ private:
 	void ApplyFilteringBackgroundImage(bool apply);
 	void PlayNavigationSound() const;
 
+	/* Folder listing cache. */
+	std::shared_ptr<const FolderListing> FindCachedFolderListing(PCIDLIST_ABSOLUTE pidlDirectory);
+	bool IsFolderListingCacheable() const;
+	void InsertFolderListingItems(PCIDLIST_ABSOLUTE pidlDirectory, const FolderListing &listing);
+	void QueueFolderRevalidation(std::shared_ptr<const FolderListing> cachedListing);
+	static std::optional<FolderRevalidationResult> RevalidateFolderAsync(HWND listView,
+		int revalidationResultId, const std::wstring &directory,
+		std::shared_ptr<const FolderListing> cachedListing);
+	void ProcessFolderRevalidationResult(int revalidationResultId);
+
+	/* Folder prefetching. */
+	void PrefetchFolder(PCIDLIST_ABSOLUTE pidlDirectory);
+	void PrefetchItem(int internalIndex);
+	void PrefetchNeighboringFolders(PCIDLIST_ABSOLUTE pidlDirectory);
+
 	static LRESULT CALLBACK ListViewProcStub(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam,
 		UINT_PTR uIdSubclass, DWORD_PTR dwRefData);
 	LRESULT CALLBACK ListViewProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
@@ -340,10 +408,11 @@ private:
 	LRESULT OnListViewGetInfoTip(NMLVGETINFOTIP *getInfoTip);
 	void QueueInfoTipTask(int internalIndex, const std::wstring &existingInfoTip);
 	static std::optional<InfoTipResult> GetInfoTipAsync(HWND listView, int infoTipResultId,
-		int internalIndex, const BasicItemInfo_t &basicItemInfo, const Config &config,
-		HINSTANCE instance, bool virtualFolder);
+		int internalIndex, const BasicItemInfo_t &basicItemInfo, InfoTipType infoTipType,
+		const GlobalFolderSettings &globalFolderSettings, HINSTANCE instance, bool virtualFolder);
 	void ProcessInfoTipResult(int infoTipResultId);
 	void OnListViewItemChanged(const NMLISTVIEW *changeData);
+	void OnListViewHotTrack(const NMLISTVIEW *hotTrackData);
 	void UpdateFileSelectionInfo(int internalIndex, BOOL selected);
 	void OnListViewKeyDown(const NMLVKEYDOWN *lvKeyDown);
 	std::vector<std::wstring> GetSelectedItems();
@@ -412,13 +481,20 @@ private:
 	static INT CALLBACK GroupFreeSpaceComparisonStub(INT Group1_ID, INT Group2_ID, void *pvData);
 	INT CALLBACK GroupFreeSpaceComparison(INT Group1_ID, INT Group2_ID);
 	std::wstring RetrieveGroupHeader(int groupId);
-	int DetermineItemGroup(int iItemInternal);
+	int DetermineItemGroup(int iItemInternal, const DateBucketer &dateBucketer);
+	ItemGroup DetermineItemGroup(const BasicItemInfo_t &basicItemInfo,
+		const GlobalFolderSettings &globalFolderSettings, const DateBucketer &dateBucketer) const;
+	std::vector<ItemGroup> DetermineItemGroups(const std::vector<BasicItemInfo_t> &items);
+	std::vector<ItemGroup> DetermineItemDateGroups(const std::vector<BasicItemInfo_t> &items,
+		GroupByDateType dateType, const DateBucketer &dateBucketer) const;
+	static std::optional<GroupByDateType> GetGroupByDateType(SortMode sortMode);
+	static uint64_t GetItemTimestamp(const WIN32_FIND_DATA &wfd, GroupByDateType dateType);
 	std::wstring DetermineItemNameGroup(const BasicItemInfo_t &itemInfo) const;
 	std::wstring DetermineItemSizeGroup(const BasicItemInfo_t &itemInfo) const;
 	std::wstring DetermineItemTotalSizeGroup(const BasicItemInfo_t &itemInfo) const;
 	std::wstring DetermineItemTypeGroupVirtual(const BasicItemInfo_t &itemInfo) const;
-	std::wstring DetermineItemDateGroup(
-		const BasicItemInfo_t &itemInfo, GroupByDateType dateType) const;
+	std::wstring DetermineItemDateGroup(const BasicItemInfo_t &itemInfo, GroupByDateType dateType,
+		const DateBucketer &dateBucketer) const;
 	std::wstring DetermineItemSummaryGroup(const BasicItemInfo_t &itemInfo, const SHCOLUMNID *pscid,
 		const GlobalFolderSettings &globalFolderSettings) const;
 	std::wstring DetermineItemFreeSpaceGroup(const BasicItemInfo_t &itemInfo) const;
@@ -433,7 +509,9 @@ private:
 	std::wstring DetermineItemNetworkStatus(const BasicItemInfo_t &itemInfo) const;
 
 	/* Other grouping support. */
-	int CheckGroup(std::wstring_view groupHeader, PFNLVGROUPCOMPARE groupComparison);
+	int CheckGroup(const std::wstring &groupHeader, PFNLVGROUPCOMPARE groupComparison);
+	static std::wstring GenerateGroupListViewHeader(const TypeGroup_t &group);
+	void UpdateGroupHeaders();
 	void InsertItemIntoGroup(int iItem, int iGroupId);
 	void MoveItemsIntoGroups();
 
@@ -444,13 +522,21 @@ private:
 	/* Thumbnails view. */
 	void QueueThumbnailTask(int internalIndex);
 	static std::optional<ThumbnailResult_t> FindThumbnailAsync(HWND listView, int thumbnailResultId,
-		int internalIndex, const BasicItemInfo_t &basicItemInfo);
+		int internalIndex, const BasicItemInfo_t &basicItemInfo, int thumbnailSize,
+		ThumbnailDiskCache *thumbnailDiskCache);
+	static wil::unique_hbitmap ExtractThumbnail(const BasicItemInfo_t &basicItemInfo, int size);
+	static int GetNearestThumbnailSize(int size);
+	size_t GetThumbnailItemBytes() const;
 	void ProcessThumbnailResult(int thumbnailResultId);
 	void SetupThumbnailsView();
 	void RemoveThumbnailsView();
-	int GetIconThumbnail(int iInternalIndex) const;
-	int GetExtractedThumbnail(HBITMAP hThumbnailBitmap) const;
-	int GetThumbnailInternal(int iType, int iInternalIndex, HBITMAP hThumbnailBitmap) const;
+	int GetIconThumbnail(int iInternalIndex);
+	void SetExtractedThumbnail(int slot, HBITMAP hThumbnailBitmap) const;
+	int AllocateThumbnailSlot(int internalIndex);
+	bool CanEvictThumbnail(int internalIndex) const;
+	void SetThumbnailInternal(
+		int slot, int iType, int iInternalIndex, HBITMAP hThumbnailBitmap) const;
+	void CreateThumbnailsImageList();
 	void DrawIconThumbnailInternal(HDC hdcBacking, int iInternalIndex) const;
 	void DrawThumbnailInternal(HDC hdcBacking, HBITMAP hThumbnailBitmap) const;
 
@@ -507,12 +593,18 @@ private:
 
 	DirectoryState m_directoryState;
 
+	// The item map and the pending task result maps allocate through these
+	// counters, so that the memory they use can be reported. They need to be
+	// declared before the maps.
+	MemoryCounter m_itemsMemoryCounter;
+	MemoryCounter m_pendingTasksMemoryCounter;
+
 	/* Stores various extra information on files, such
 	as display name. */
-	std::unordered_map<int, ItemInfo_t> m_itemInfoMap;
+	CountedMap<ItemInfo_t> m_itemInfoMap;
 
 	ctpl::thread_pool m_columnThreadPool;
-	std::unordered_map<int, std::future<ColumnResult_t>> m_columnResults;
+	CountedMap<std::future<ColumnResult_t>> m_columnResults;
 	int m_columnResultIDCounter;
 
 	std::unique_ptr<IconFetcher> m_iconFetcher;
@@ -521,13 +613,28 @@ private:
 	IconResourceLoader *m_iconResourceLoader;
 
 	ctpl::thread_pool m_thumbnailThreadPool;
-	std::unordered_map<int, std::future<std::optional<ThumbnailResult_t>>> m_thumbnailResults;
+	CountedMap<std::future<std::optional<ThumbnailResult_t>>> m_thumbnailResults;
 	int m_thumbnailResultIDCounter;
 
+	// Tracks which items currently have a slot in the thumbnails image list.
+	ThumbnailStore m_thumbnailStore;
+
+	ThumbnailDiskCache *m_thumbnailDiskCache;
+	int m_thumbnailSize;
+
 	ctpl::thread_pool m_infoTipsThreadPool;
-	std::unordered_map<int, std::future<std::optional<InfoTipResult>>> m_infoTipResults;
+	CountedMap<std::future<std::optional<InfoTipResult>>> m_infoTipResults;
 	int m_infoTipResultIDCounter;
 
+	FolderListingCache *m_folderListingCache;
+	ctpl::thread_pool m_folderRevalidationThreadPool;
+	CountedMap<std::future<std::optional<FolderRevalidationResult>>> m_folderRevalidationResults;
+	int m_folderRevalidationResultIDCounter;
+
+	FolderPrefetcher *m_folderPrefetcher;
+
+	std::vector<MemoryAccountant::Registration> m_memoryRegistrations;
+
 	/* Cached folder size data. */
 	mutable std::unordered_map<int, ULONGLONG> m_cachedFolderSizes;
 
@@ -572,6 +679,11 @@ private:
 
 	int m_middleButtonItem;
 
+	/* The last item hovered over. Used to avoid
+	repeatedly requesting a prefetch of the same
+	folder. */
+	int m_lastHotTrackedItem;
+
 	/* Shell new. */
 	BOOL m_bNewItemCreated;
 	PCIDLIST_ABSOLUTE m_pidlNewItem;
@@ -613,9 +725,15 @@ private:
 	explicitly, rather than taken from the size
 	of the group list, to avoid warnings concerning
 	size_t and int. */
-	std::list<TypeGroup_t> m_GroupList;
+	std::unordered_map<int, TypeGroup_t> m_groups;
+	std::unordered_map<std::wstring, int> m_groupIdsByHeader;
+	std::unordered_set<int> m_groupsPendingHeaderUpdate;
 	int m_iGroupId;
 
+	/* Used to determine the groups for large folders.
+	Shared between all tabs. */
+	ctpl::thread_pool *m_groupingThreadPool;
+
 	/* Filtering related data. */
 	std::list<int> m_FilteredItemsList;
 };
\ No newline at end of file
@@ -120,7 +120,17 @@ HRESULT ShellNavigationController::Refresh()
 
 HRESULT ShellNavigationController::BrowseFolder(const HistoryEntry *entry, bool addHistoryEntry)
 {
-	return BrowseFolder(entry->GetPidl().get(), addHistoryEntry);
+	if (addHistoryEntry)
+	{
+		return BrowseFolder(entry->GetPidl().get(), addHistoryEntry);
+	}
+
+	if (m_navigationMode == NavigationMode::ForceNewTab && GetCurrentEntry() != nullptr)
+	{
+		return m_tabNavigation->CreateNewTab(entry->GetPidl().get(), true);
+	}
+
+	return m_navigator->BrowseFolderFromHistory(entry->GetPidl().get());
 }
 
 HRESULT ShellNavigationController::BrowseFolder(const std::wstring &path, bool addHistoryEntry)
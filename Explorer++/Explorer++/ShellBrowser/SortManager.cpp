@@ -8,11 +8,14 @@
 #include "SortHelper.h"
 #include "SortModes.h"
 #include "ViewModes.h"
+#include "../Helper/Tracing.h"
 #include <propkey.h>
 #include <cassert>
 
 void ShellBrowser::SortFolder(SortMode sortMode)
 {
+	TRACE_EVENT1("sort", "SortFolder", "numItems", m_nTotalItems);
+
 	m_folderSettings.sortMode = sortMode;
 
 	if (m_folderSettings.showInGroups)
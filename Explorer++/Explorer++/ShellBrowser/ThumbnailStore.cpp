@@ -0,0 +1,163 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "ThumbnailStore.h"
+
+ThumbnailStore::ThumbnailStore(size_t byteBudget) : m_numSlots(0), m_byteBudget(byteBudget)
+{
+}
+
+std::optional<int> ThumbnailStore::Lookup(int key)
+{
+	auto &keyIndex = m_entries.get<1>();
+	auto itr = keyIndex.find(key);
+
+	if (itr == keyIndex.end())
+	{
+		m_stats.misses++;
+		return std::nullopt;
+	}
+
+	m_stats.hits++;
+	m_entries.relocate(m_entries.begin(), m_entries.project<0>(itr));
+
+	return itr->slot;
+}
+
+std::optional<int> ThumbnailStore::GetSlot(int key) const
+{
+	auto &keyIndex = m_entries.get<1>();
+	auto itr = keyIndex.find(key);
+
+	if (itr == keyIndex.end())
+	{
+		return std::nullopt;
+	}
+
+	return itr->slot;
+}
+
+ThumbnailStore::InsertResult ThumbnailStore::Insert(
+	int key, size_t bytes, EvictionFilter canEvict)
+{
+	InsertResult result;
+
+	auto &keyIndex = m_entries.get<1>();
+	auto itr = keyIndex.find(key);
+
+	if (itr != keyIndex.end())
+	{
+		// The thumbnail is being replaced (e.g. an icon placeholder is being
+		// replaced with the extracted image), so the existing slot can be
+		// reused.
+		Entry updatedEntry = *itr;
+		m_stats.residentBytes -= updatedEntry.bytes;
+		updatedEntry.bytes = bytes;
+		keyIndex.replace(itr, updatedEntry);
+		m_entries.relocate(m_entries.begin(), m_entries.project<0>(itr));
+
+		EvictToFit(bytes, key, canEvict, result.evictedKeys);
+
+		m_stats.residentBytes += bytes;
+		result.slot = updatedEntry.slot;
+
+		return result;
+	}
+
+	EvictToFit(bytes, key, canEvict, result.evictedKeys);
+
+	result.slot = AllocateSlot();
+	m_entries.push_front({ key, result.slot, bytes });
+	m_stats.residentBytes += bytes;
+	m_stats.numEntries = m_entries.size();
+
+	return result;
+}
+
+void ThumbnailStore::EvictToFit(
+	size_t bytes, int keyToKeep, const EvictionFilter &canEvict, std::vector<int> &evictedKeys)
+{
+	auto itr = m_entries.end();
+
+	while (m_stats.residentBytes + bytes > m_byteBudget && itr != m_entries.begin())
+	{
+		--itr;
+
+		if (itr->key == keyToKeep || (canEvict && !canEvict(itr->key)))
+		{
+			continue;
+		}
+
+		evictedKeys.push_back(itr->key);
+		m_stats.evictions++;
+
+		auto next = std::next(itr);
+		EraseEntry(itr);
+		itr = next;
+	}
+}
+
+int ThumbnailStore::AllocateSlot()
+{
+	if (m_freeSlots.empty())
+	{
+		return m_numSlots++;
+	}
+
+	int slot = m_freeSlots.back();
+	m_freeSlots.pop_back();
+	return slot;
+}
+
+void ThumbnailStore::EraseEntry(EntrySet::iterator itr)
+{
+	m_stats.residentBytes -= itr->bytes;
+	m_freeSlots.push_back(itr->slot);
+	m_entries.erase(itr);
+	m_stats.numEntries = m_entries.size();
+}
+
+void ThumbnailStore::Remove(int key)
+{
+	auto &keyIndex = m_entries.get<1>();
+	auto itr = keyIndex.find(key);
+
+	if (itr == keyIndex.end())
+	{
+		return;
+	}
+
+	EraseEntry(m_entries.project<0>(itr));
+}
+
+void ThumbnailStore::Clear()
+{
+	m_entries.clear();
+	m_freeSlots.clear();
+	m_numSlots = 0;
+
+	m_stats.residentBytes = 0;
+	m_stats.numEntries = 0;
+}
+
+void ThumbnailStore::SetByteBudget(size_t byteBudget)
+{
+	m_byteBudget = byteBudget;
+}
+
+size_t ThumbnailStore::GetByteBudget() const
+{
+	return m_byteBudget;
+}
+
+int ThumbnailStore::GetNumSlots() const
+{
+	return m_numSlots;
+}
+
+ThumbnailStore::Stats ThumbnailStore::GetStats() const
+{
+	return m_stats;
+}
\ No newline at end of file
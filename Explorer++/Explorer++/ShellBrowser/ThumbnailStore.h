@@ -0,0 +1,112 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/multi_index_container.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+// Tracks which items have a thumbnail in the listview's image list and
+// limits the amount of memory those thumbnails use.
+//
+// Each thumbnail occupies a slot (i.e. an index in the image list). When the
+// byte budget is exceeded, the least recently used thumbnails are evicted and
+// their slots are handed out again, so the image list never grows beyond the
+// number of thumbnails that fit in the budget (plus any that can't currently
+// be evicted).
+//
+// This class only does the bookkeeping. It doesn't create or draw any
+// bitmaps, which is left to the caller.
+class ThumbnailStore
+{
+public:
+	struct Stats
+	{
+		size_t residentBytes = 0;
+		size_t numEntries = 0;
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+	};
+
+	struct InsertResult
+	{
+		int slot;
+
+		// The keys of any thumbnails that were evicted to make room. The
+		// caller is responsible for detaching these items from their slots.
+		std::vector<int> evictedKeys;
+	};
+
+	// Returns true if the thumbnail with the specified key can be evicted.
+	// This allows thumbnails that are currently visible to be retained, even
+	// if they're the least recently used. Note that this means the budget may
+	// be exceeded if every resident thumbnail is visible.
+	using EvictionFilter = std::function<bool(int key)>;
+
+	explicit ThumbnailStore(size_t byteBudget);
+
+	// Returns the slot for the specified key, marking it as the most recently
+	// used. This is counted as either a hit or a miss.
+	std::optional<int> Lookup(int key);
+
+	// Returns the slot for the specified key, without affecting the stats or
+	// the eviction order.
+	std::optional<int> GetSlot(int key) const;
+
+	// Assigns a slot to the specified key, evicting older thumbnails as
+	// needed. If the key is already present, its existing slot is retained.
+	InsertResult Insert(int key, size_t bytes, EvictionFilter canEvict = nullptr);
+
+	void Remove(int key);
+
+	// Removes all thumbnails and resets the slot numbering (e.g. because the
+	// image list has been recreated). The hit, miss and eviction counts are
+	// retained.
+	void Clear();
+
+	// The new budget will be applied the next time a thumbnail is inserted.
+	void SetByteBudget(size_t byteBudget);
+	size_t GetByteBudget() const;
+
+	// The number of distinct slots that have been handed out since the store
+	// was last cleared. This is the number of images the image list needs to
+	// hold.
+	int GetNumSlots() const;
+
+	Stats GetStats() const;
+
+private:
+	struct Entry
+	{
+		int key;
+		int slot;
+		size_t bytes;
+	};
+
+	// The sequenced index is ordered from the most recently used entry to the
+	// least recently used entry.
+	using EntrySet = boost::multi_index_container<Entry,
+		boost::multi_index::indexed_by<boost::multi_index::sequenced<>,
+			boost::multi_index::hashed_unique<
+				boost::multi_index::member<Entry, int, &Entry::key>>>>;
+
+	void EvictToFit(size_t bytes, int keyToKeep, const EvictionFilter &canEvict,
+		std::vector<int> &evictedKeys);
+	int AllocateSlot();
+	void EraseEntry(EntrySet::iterator itr);
+
+	EntrySet m_entries;
+	std::vector<int> m_freeSlots;
+	int m_numSlots;
+	size_t m_byteBudget;
+	Stats m_stats;
+};
\ No newline at end of file
@@ -36,6 +36,11 @@ void ShellTreeView::DirectoryAltered()
 	notifications referred to files that didn't exist. */
 	for(const auto &af : m_AlteredList)
 	{
+		if(af.dwAction != FILE_ACTION_MODIFIED)
+		{
+			InvalidateCachedSubfolders(af.szFileName);
+		}
+
 		switch(af.dwAction)
 		{
 			case FILE_ACTION_ADDED:
@@ -450,6 +455,11 @@ void ShellTreeView::AddItemInternal(HTREEITEM hParent,const TCHAR *szFullFileNam
 						tvis.itemex				= tvItem;
 
 						hItem = TreeView_InsertItem(m_hTreeView,&tvis);
+
+						if(hItem != nullptr)
+						{
+							AddItemToPathIndex(hItem,szFullFileName);
+						}
 					}
 				}
 
@@ -507,6 +517,9 @@ void ShellTreeView::RenameItem(HTREEITEM hItem, const TCHAR *szFullFileName)
 			/* Now recursively go through each of this items children and
 			update their pidl's. */
 			UpdateChildren(hItem,pidlParent);
+
+			/* The paths of the item and its children have also changed. */
+			UpdatePathIndex(hItem);
 		}
 	}
 }
@@ -19,6 +19,9 @@
 #include "Config.h"
 #include "CoreInterface.h"
 #include "DarkModeHelper.h"
+#include "MainResource.h"
+#include "ResourceHelper.h"
+#include "ShellBrowser/FolderPrefetcher.h"
 #include "TabContainer.h"
 #include "../Helper/CachedIcons.h"
 #include "../Helper/Controls.h"
@@ -29,29 +32,75 @@
 #include "../Helper/Macros.h"
 #include "../Helper/ShellHelper.h"
 #include <wil/common.h>
+#include <algorithm>
 
-int CALLBACK CompareItemsStub(LPARAM lParam1, LPARAM lParam2, LPARAM lParamSort);
 DWORD WINAPI Thread_MonitorAllDrives(LPVOID pParam);
 
+namespace
+{
+// Parsing paths are compared case-insensitively, so they're converted to a common form before
+// being indexed.
+std::wstring NormalizeParsingPath(std::wstring parsingPath)
+{
+	if (parsingPath.size() > 1 && parsingPath.back() == '\\')
+	{
+		parsingPath.pop_back();
+	}
+
+	CharUpperBuff(parsingPath.data(), static_cast<DWORD>(parsingPath.size()));
+
+	return parsingPath;
+}
+
+// Some items (e.g. certain virtual items) don't have a parsing path. Those items are indexed by
+// the contents of their pidl instead. The prefix used here ensures that the key can't match a
+// real parsing path.
+std::wstring GetPidlIndexKey(PCIDLIST_ABSOLUTE pidl)
+{
+	const TCHAR hexDigits[] = _T("0123456789ABCDEF");
+
+	auto *bytes = reinterpret_cast<const BYTE *>(pidl);
+	UINT size = ILGetSize(pidl);
+
+	std::wstring key = L"::PIDL:";
+	key.reserve(key.size() + (size * 2));
+
+	for (UINT i = 0; i < size; i++)
+	{
+		key.push_back(hexDigits[bytes[i] >> 4]);
+		key.push_back(hexDigits[bytes[i] & 0xF]);
+	}
+
+	return key;
+}
+}
+
 ShellTreeView::ShellTreeView(HWND hParent, IExplorerplusplus *coreInterface,
 	IDirectoryMonitor *pDirMon, TabContainer *tabContainer, FileActionHandler *fileActionHandler,
 	CachedIcons *cachedIcons) :
 	m_hTreeView(CreateTreeView(hParent)),
 	m_config(coreInterface->GetConfig()),
+	m_hLanguageModule(coreInterface->GetLanguageModule()),
 	m_pDirMon(pDirMon),
 	m_tabContainer(tabContainer),
 	m_fileActionHandler(fileActionHandler),
 	m_cachedIcons(cachedIcons),
+	m_folderPrefetcher(coreInterface->GetFolderPrefetcher()),
 	m_iRefCount(1),
 	m_itemIDCounter(0),
 	m_bDragDropRegistered(FALSE),
-	m_iconThreadPool(
-		1, std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED), CoUninitialize),
-	m_iconResultIDCounter(0),
+	m_iconFetcher(m_hTreeView, coreInterface->GetIconResolutionService()),
 	m_subfoldersThreadPool(
 		1, std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED), CoUninitialize),
+	m_networkSubfoldersThreadPool(
+		1, std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED), CoUninitialize),
 	m_subfoldersResultIDCounter(0),
-	m_cutItem(nullptr)
+	m_subfoldersCache(SUBFOLDERS_CACHE_SIZE),
+	m_expansionThreadPool(
+		1, std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED), CoUninitialize),
+	m_expansionResultIDCounter(0),
+	m_cutItem(nullptr),
+	m_lastHoveredItem(nullptr)
 {
 	auto &darkModeHelper = DarkModeHelper::GetInstance();
 
@@ -113,9 +162,14 @@ HWND ShellTreeView::GetHWND() const
 
 ShellTreeView::~ShellTreeView()
 {
-	DeleteCriticalSection(&m_cs);
+	// Any queued enumerations would otherwise still be run when the thread pool is destroyed.
+	m_expansionThreadPool.clear_queue();
+	CancelAllExpansions();
 
-	m_iconThreadPool.clear_queue();
+	m_subfoldersThreadPool.clear_queue();
+	m_networkSubfoldersThreadPool.clear_queue();
+
+	DeleteCriticalSection(&m_cs);
 }
 
 void ShellTreeView::OnApplicationShuttingDown()
@@ -141,7 +195,14 @@ LRESULT CALLBACK ShellTreeView::TreeViewProc(HWND hwnd, UINT msg, WPARAM wParam,
 	switch (msg)
 	{
 	case WM_TIMER:
-		DirectoryAltered();
+		if (wParam == LOADING_PLACEHOLDER_TIMER_ID)
+		{
+			OnLoadingPlaceholderTimer();
+		}
+		else
+		{
+			DirectoryAltered();
+		}
 		break;
 
 	case WM_DEVICECHANGE:
@@ -189,6 +250,12 @@ LRESULT CALLBACK ShellTreeView::TreeViewProc(HWND hwnd, UINT msg, WPARAM wParam,
 
 	case WM_MOUSEMOVE:
 	{
+		if (!(wParam & (MK_LBUTTON | MK_RBUTTON | MK_MBUTTON)))
+		{
+			POINT pt = { GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam) };
+			OnHover(&pt);
+		}
+
 		if (!m_bDragging && !m_bDragCancelled && m_bDragAllowed)
 		{
 			if ((wParam & MK_RBUTTON) && !(wParam & MK_LBUTTON) && !(wParam & MK_MBUTTON))
@@ -236,14 +303,18 @@ LRESULT CALLBACK ShellTreeView::TreeViewProc(HWND hwnd, UINT msg, WPARAM wParam,
 		OnClipboardUpdate();
 		return 0;
 
-	case WM_APP_ICON_RESULT_READY:
-		ProcessIconResult(static_cast<int>(wParam));
-		break;
-
 	case WM_APP_SUBFOLDERS_RESULT_READY:
 		ProcessSubfoldersResult(static_cast<int>(wParam));
 		break;
 
+	case WM_APP_QUEUE_SUBFOLDERS_TASKS:
+		QueueSubfoldersTasks();
+		break;
+
+	case WM_APP_ENUMERATION_RESULT_READY:
+		ProcessExpansionResult(static_cast<int>(wParam));
+		break;
+
 	case WM_DESTROY:
 		if (m_bDragDropRegistered)
 		{
@@ -291,6 +362,10 @@ LRESULT CALLBACK ShellTreeView::ParentWndProc(HWND hwnd, UINT uMsg, WPARAM wPara
 				OnItemExpanding(reinterpret_cast<NMTREEVIEW *>(lParam));
 				break;
 
+			case TVN_DELETEITEM:
+				OnDeleteItem(reinterpret_cast<NMTREEVIEW *>(lParam));
+				break;
+
 			case TVN_KEYDOWN:
 				return OnKeyDown(reinterpret_cast<NMTVKEYDOWN *>(lParam));
 
@@ -345,27 +420,14 @@ HTREEITEM ShellTreeView::AddRoot()
 
 	if (hDesktop != nullptr)
 	{
+		AddItemToPathIndex(hDesktop, pidl.get());
+
 		SendMessage(m_hTreeView, TVM_EXPAND, TVE_EXPAND, reinterpret_cast<LPARAM>(hDesktop));
 	}
 
 	return hDesktop;
 }
 
-HRESULT ShellTreeView::ExpandDirectory(HTREEITEM hParent)
-{
-	auto pidlDirectory = GetItemPidl(hParent);
-
-	wil::com_ptr<IShellFolder> pShellFolder;
-	HRESULT hr = BindToIdl(pidlDirectory.get(), IID_PPV_ARGS(&pShellFolder));
-
-	if (SUCCEEDED(hr))
-	{
-		AddDirectoryInternal(pShellFolder.get(), pidlDirectory.get(), hParent);
-	}
-
-	return hr;
-}
-
 void ShellTreeView::OnGetDisplayInfo(NMTVDISPINFO *pnmtvdi)
 {
 	TVITEM *ptvItem = &pnmtvdi->item;
@@ -391,9 +453,18 @@ void ShellTreeView::OnGetDisplayInfo(NMTVDISPINFO *pnmtvdi)
 
 	if (WI_IsFlagSet(ptvItem->mask, TVIF_CHILDREN))
 	{
-		ptvItem->cChildren = 1;
+		auto hasSubfolders = GetCachedSubfolders(ptvItem->hItem);
 
-		QueueSubfoldersTask(ptvItem->hItem);
+		if (hasSubfolders)
+		{
+			ptvItem->cChildren = *hasSubfolders ? 1 : 0;
+		}
+		else
+		{
+			ptvItem->cChildren = 1;
+
+			QueueSubfoldersCheck(ptvItem->hItem);
+		}
 	}
 
 	ptvItem->mask |= TVIF_DI_SETITEM;
@@ -410,180 +481,247 @@ std::optional<int> ShellTreeView::GetCachedIconIndex(const ItemInfo_t &itemInfo)
 		return std::nullopt;
 	}
 
-	auto cachedItr = m_cachedIcons->findByPath(filePath);
+	return m_cachedIcons->findByPath(filePath, CachedIcons::ItemType::Folder);
+}
+
+void ShellTreeView::QueueIconTask(HTREEITEM item, int internalIndex)
+{
+	const ItemInfo_t &itemInfo = m_itemInfoMap.at(internalIndex);
+
+	m_iconFetcher.QueueIconTask(itemInfo.pidl.get(), [this, item](int iconIndex) {
+		ProcessIconResult(item, iconIndex);
+	});
+}
 
-	if (cachedItr == m_cachedIcons->end())
+// The shared icon cache will already have been updated by the time this is
+// called.
+void ShellTreeView::ProcessIconResult(HTREEITEM item, int iconIndex)
+{
+	TVITEM tvItem;
+	tvItem.mask = TVIF_HANDLE | TVIF_IMAGE | TVIF_SELECTEDIMAGE | TVIF_STATE;
+	tvItem.hItem = item;
+	tvItem.iImage = iconIndex;
+	tvItem.iSelectedImage = iconIndex;
+	tvItem.stateMask = TVIS_OVERLAYMASK;
+	tvItem.state = INDEXTOOVERLAYMASK(iconIndex >> 24);
+	TreeView_SetItem(m_hTreeView, &tvItem);
+}
+
+void ShellTreeView::QueueSubfoldersCheck(HTREEITEM item)
+{
+	// Items are displayed (and therefore checked) in groups, so rather than queuing a task for
+	// each item, the items are collected and checked together once the current message has been
+	// processed.
+	if (m_pendingSubfoldersChecks.empty())
 	{
-		return std::nullopt;
+		PostMessage(m_hTreeView, WM_APP_QUEUE_SUBFOLDERS_TASKS, 0, 0);
 	}
 
-	return cachedItr->iconIndex;
+	HTREEITEM parentItem = TreeView_GetParent(m_hTreeView, item);
+	m_pendingSubfoldersChecks[parentItem].push_back(item);
 }
 
-void ShellTreeView::QueueIconTask(HTREEITEM item, int internalIndex)
+void ShellTreeView::QueueSubfoldersTasks()
 {
-	const ItemInfo_t &itemInfo = m_itemInfoMap.at(internalIndex);
+	for (const auto &[parentItem, items] : m_pendingSubfoldersChecks)
+	{
+		if (parentItem == nullptr || items.empty())
+		{
+			continue;
+		}
 
-	BasicItemInfo basicItemInfo;
-	basicItemInfo.pidl.reset(ILCloneFull(itemInfo.pidl.get()));
+		auto batch = std::make_shared<SubfoldersBatch>();
+		batch->pidlParent = GetItemPidl(parentItem);
 
-	int iconResultID = m_iconResultIDCounter++;
+		auto parentPath = m_pathsByItem.find(parentItem);
+		batch->isNetworkVolume =
+			(parentPath != m_pathsByItem.end() && PathIsNetworkPath(parentPath->second.c_str()));
+
+		for (HTREEITEM item : items)
+		{
+			SubfoldersCheck check;
+			check.item = item;
+			check.pidl.reset(ILCloneChild(ILFindLastID(GetItemByHandle(item).pidl.get())));
 
-	auto result =
-		m_iconThreadPool.push([this, iconResultID, item, internalIndex, basicItemInfo](int id) {
+			auto itemPath = m_pathsByItem.find(item);
+
+			if (itemPath != m_pathsByItem.end())
+			{
+				check.indexKey = itemPath->second;
+			}
+
+			batch->items.push_back(std::move(check));
+		}
+
+		int subfoldersResultID = m_subfoldersResultIDCounter++;
+
+		// Network items are checked on a separate thread, so that a slow share can't hold up the
+		// checks for local items.
+		ctpl::thread_pool &threadPool =
+			batch->isNetworkVolume ? m_networkSubfoldersThreadPool : m_subfoldersThreadPool;
+
+		auto result = threadPool.push([treeView = m_hTreeView, subfoldersResultID, batch](int id) {
 			UNREFERENCED_PARAMETER(id);
 
-			return FindIconAsync(
-				m_hTreeView, iconResultID, item, internalIndex, basicItemInfo.pidl.get());
+			return CheckSubfoldersAsync(treeView, subfoldersResultID, batch);
 		});
 
-	m_iconResults.insert({ iconResultID, std::move(result) });
+		m_subfoldersResults.insert({ subfoldersResultID, std::move(result) });
+	}
+
+	m_pendingSubfoldersChecks.clear();
 }
 
-std::optional<ShellTreeView::IconResult> ShellTreeView::FindIconAsync(
-	HWND treeView, int iconResultId, HTREEITEM item, int internalIndex, PCIDLIST_ABSOLUTE pidl)
+std::vector<ShellTreeView::SubfoldersResult> ShellTreeView::CheckSubfoldersAsync(
+	HWND treeView, int subfoldersResultId, std::shared_ptr<SubfoldersBatch> batch)
 {
-	SHFILEINFO shfi;
-	DWORD_PTR res = SHGetFileInfo(reinterpret_cast<LPCTSTR>(pidl), 0, &shfi, sizeof(SHFILEINFO),
-		SHGFI_PIDL | SHGFI_ICON | SHGFI_OVERLAYINDEX);
+	std::vector<SubfoldersResult> results;
 
-	if (res == 0)
+	auto cleanup = wil::scope_exit([treeView, subfoldersResultId]() {
+		PostMessage(treeView, WM_APP_SUBFOLDERS_RESULT_READY, subfoldersResultId, 0);
+	});
+
+	wil::com_ptr<IShellFolder> pShellFolder;
+	HRESULT hr = BindToIdl(batch->pidlParent.get(), IID_PPV_ARGS(&pShellFolder));
+
+	if (FAILED(hr))
 	{
-		return std::nullopt;
+		return results;
 	}
 
-	DestroyIcon(shfi.hIcon);
-
-	PostMessage(treeView, WM_APP_ICON_RESULT_READY, iconResultId, 0);
+	auto startTime = std::chrono::steady_clock::now();
 
-	IconResult result;
-	result.item = item;
-	result.internalIndex = internalIndex;
-	result.iconIndex = shfi.iIcon;
+	for (const auto &check : batch->items)
+	{
+		if (batch->isNetworkVolume
+			&& std::chrono::steady_clock::now() - startTime > NETWORK_SUBFOLDERS_BUDGET)
+		{
+			break;
+		}
 
-	return result;
-}
+		PCITEMID_CHILD pidlChild = check.pidl.get();
+		ULONG attributes = SFGAO_HASSUBFOLDER;
+		hr = pShellFolder->GetAttributesOf(1, &pidlChild, &attributes);
 
-void ShellTreeView::ProcessIconResult(int iconResultId)
-{
-	auto itr = m_iconResults.find(iconResultId);
+		if (FAILED(hr))
+		{
+			continue;
+		}
 
-	if (itr == m_iconResults.end())
-	{
-		return;
+		SubfoldersResult result;
+		result.item = check.item;
+		result.indexKey = check.indexKey;
+		result.hasSubfolder = WI_IsFlagSet(attributes, SFGAO_HASSUBFOLDER);
+		results.push_back(std::move(result));
 	}
 
-	auto cleanup = wil::scope_exit([this, itr]() {
-		m_iconResults.erase(itr);
-	});
+	return results;
+}
 
-	auto result = itr->second.get();
+void ShellTreeView::ProcessSubfoldersResult(int subfoldersResultId)
+{
+	auto itr = m_subfoldersResults.find(subfoldersResultId);
 
-	if (!result)
+	if (itr == m_subfoldersResults.end())
 	{
 		return;
 	}
 
-	const ItemInfo_t &itemInfo = m_itemInfoMap.at(result->internalIndex);
-
-	TCHAR filePath[MAX_PATH];
-	HRESULT hr = GetDisplayName(
-		itemInfo.pidl.get(), filePath, static_cast<UINT>(std::size(filePath)), SHGDN_FORPARSING);
+	auto results = itr->second.get();
+	m_subfoldersResults.erase(itr);
 
-	if (SUCCEEDED(hr))
+	for (const auto &result : results)
 	{
-		m_cachedIcons->addOrUpdateFileIcon(filePath, result->iconIndex);
-	}
+		// The item may have been removed while the check was in progress, in which case the
+		// handle may no longer refer to the same item (or to any item at all). Every item is
+		// indexed (either by its parsing path or by its pidl), so the index key recorded when the
+		// check was queued identifies the item.
+		auto itemPath = m_pathsByItem.find(result.item);
 
-	TVITEM tvItem;
-	tvItem.mask = TVIF_HANDLE | TVIF_IMAGE | TVIF_SELECTEDIMAGE | TVIF_STATE;
-	tvItem.hItem = result->item;
-	tvItem.iImage = result->iconIndex;
-	tvItem.iSelectedImage = result->iconIndex;
-	tvItem.stateMask = TVIS_OVERLAYMASK;
-	tvItem.state = INDEXTOOVERLAYMASK(result->iconIndex >> 24);
-	TreeView_SetItem(m_hTreeView, &tvItem);
-}
+		if (itemPath == m_pathsByItem.end() || itemPath->second != result.indexKey)
+		{
+			continue;
+		}
 
-void ShellTreeView::QueueSubfoldersTask(HTREEITEM item)
-{
-	BasicItemInfo basicItemInfo;
-	basicItemInfo.pidl = GetItemPidl(item);
+		CachedSubfoldersResult cachedResult;
+		cachedResult.hasSubfolder = result.hasSubfolder;
 
-	int subfoldersResultID = m_subfoldersResultIDCounter++;
+		if (PathIsNetworkPath(result.indexKey.c_str()))
+		{
+			cachedResult.expiryTime =
+				std::chrono::steady_clock::now() + NETWORK_SUBFOLDERS_CACHE_LIFETIME;
+		}
 
-	auto result =
-		m_subfoldersThreadPool.push([this, subfoldersResultID, item, basicItemInfo](int id) {
-			UNREFERENCED_PARAMETER(id);
+		m_subfoldersCache.Put(result.indexKey, cachedResult);
 
-			return CheckSubfoldersAsync(
-				m_hTreeView, subfoldersResultID, item, basicItemInfo.pidl.get());
-		});
+		if (result.hasSubfolder)
+		{
+			// By default it's assumed that an item has subfolders, so if it does actually have
+			// subfolders, there's nothing else that needs to be done.
+			continue;
+		}
 
-	m_subfoldersResults.insert({ subfoldersResultID, std::move(result) });
+		TVITEM tvItem;
+		tvItem.mask = TVIF_HANDLE | TVIF_CHILDREN;
+		tvItem.hItem = result.item;
+		tvItem.cChildren = 0;
+		TreeView_SetItem(m_hTreeView, &tvItem);
+	}
 }
 
-std::optional<ShellTreeView::SubfoldersResult> ShellTreeView::CheckSubfoldersAsync(
-	HWND treeView, int subfoldersResultId, HTREEITEM item, PCIDLIST_ABSOLUTE pidl)
+std::optional<bool> ShellTreeView::GetCachedSubfolders(HTREEITEM item)
 {
-	wil::com_ptr<IShellFolder> pShellFolder;
-	PCITEMID_CHILD pidlRelative;
-	HRESULT hr = SHBindToParent(pidl, IID_PPV_ARGS(&pShellFolder), &pidlRelative);
+	auto itemPath = m_pathsByItem.find(item);
 
-	if (FAILED(hr))
+	if (itemPath == m_pathsByItem.end())
 	{
 		return std::nullopt;
 	}
 
-	ULONG attributes = SFGAO_HASSUBFOLDER;
-	hr = pShellFolder->GetAttributesOf(1, &pidlRelative, &attributes);
+	auto cachedResult = m_subfoldersCache.Get(itemPath->second);
 
-	if (FAILED(hr))
+	if (!cachedResult)
 	{
 		return std::nullopt;
 	}
 
-	PostMessage(treeView, WM_APP_SUBFOLDERS_RESULT_READY, subfoldersResultId, 0);
-
-	SubfoldersResult result;
-	result.item = item;
-	result.hasSubfolder = WI_IsFlagSet(attributes, SFGAO_HASSUBFOLDER);
+	if (cachedResult->expiryTime && std::chrono::steady_clock::now() >= *cachedResult->expiryTime)
+	{
+		m_subfoldersCache.Remove(itemPath->second);
+		return std::nullopt;
+	}
 
-	return result;
+	return cachedResult->hasSubfolder;
 }
 
-void ShellTreeView::ProcessSubfoldersResult(int subfoldersResultId)
+// Adding, removing or renaming an item can change whether its parent has subfolders, as well as
+// whether the item itself (if it's been removed or renamed) is still valid.
+void ShellTreeView::InvalidateCachedSubfolders(const TCHAR *szFullFileName)
 {
-	auto itr = m_subfoldersResults.find(subfoldersResultId);
+	TCHAR szParent[MAX_PATH];
+	StringCchCopy(szParent, SIZEOF_ARRAY(szParent), szFullFileName);
+	PathRemoveFileSpec(szParent);
 
-	if (itr == m_subfoldersResults.end())
-	{
-		return;
-	}
+	m_subfoldersCache.Remove(NormalizeParsingPath(szFullFileName));
+	m_subfoldersCache.Remove(NormalizeParsingPath(szParent));
+}
 
-	auto cleanup = wil::scope_exit([this, itr]() {
-		m_subfoldersResults.erase(itr);
-	});
+void ShellTreeView::OnDeleteItem(const NMTREEVIEW *nmtv)
+{
+	HTREEITEM item = nmtv->itemOld.hItem;
 
-	auto result = itr->second.get();
+	CancelExpansion(item);
+	RemoveItemFromPathIndex(item);
 
-	if (!result)
+	if (!m_pendingSubfoldersChecks.empty())
 	{
-		return;
-	}
+		m_pendingSubfoldersChecks.erase(item);
 
-	if (result->hasSubfolder)
-	{
-		// By default it's assumed that an item has subfolders, so if it does
-		// actually have subfolders, there's nothing else that needs to be done.
-		return;
+		for (auto &[parentItem, items] : m_pendingSubfoldersChecks)
+		{
+			items.erase(std::remove(items.begin(), items.end(), item), items.end());
+		}
 	}
-
-	TVITEM tvItem;
-	tvItem.mask = TVIF_HANDLE | TVIF_CHILDREN;
-	tvItem.hItem = result->item;
-	tvItem.cChildren = 0;
-	TreeView_SetItem(m_hTreeView, &tvItem);
 }
 
 void ShellTreeView::OnItemExpanding(const NMTREEVIEW *nmtv)
@@ -592,10 +730,12 @@ void ShellTreeView::OnItemExpanding(const NMTREEVIEW *nmtv)
 
 	if (nmtv->action == TVE_EXPAND)
 	{
-		ExpandDirectory(parentItem);
+		QueueExpansionTask(parentItem);
 	}
 	else
 	{
+		CancelExpansion(parentItem);
+
 		auto hSelection = TreeView_GetSelection(m_hTreeView);
 
 		if (hSelection != nullptr)
@@ -654,162 +794,520 @@ LRESULT ShellTreeView::OnKeyDown(const NMTVKEYDOWN *keyDown)
 		}
 		else
 		{
-			DeleteSelectedItem(false);
+			DeleteSelectedItem(false);
+		}
+		break;
+	}
+
+	// If the ctrl key is down, this key sequence is likely a modifier. Stop any other pressed key
+	// from been used in an incremental search.
+	if (IsKeyDown(VK_CONTROL))
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
+void ShellTreeView::QueueExpansionTask(HTREEITEM item)
+{
+	if (FindPendingExpansion(item) != m_pendingExpansions.end())
+	{
+		return;
+	}
+
+	BasicItemInfo basicItemInfo;
+	basicItemInfo.pidl = GetItemPidl(item);
+
+	int expansionResultID = m_expansionResultIDCounter++;
+	bool showHidden = m_bShowHidden;
+	auto cancelled = std::make_shared<std::atomic<bool>>(false);
+
+	auto result = m_expansionThreadPool.push(
+		[treeView = m_hTreeView, expansionResultID, basicItemInfo, showHidden, cancelled](
+			int id) {
+			UNREFERENCED_PARAMETER(id);
+
+			return EnumerateChildrenAsync(
+				treeView, expansionResultID, basicItemInfo.pidl.get(), showHidden, cancelled);
+		});
+
+	PendingExpansion pendingExpansion;
+	pendingExpansion.item = item;
+	pendingExpansion.cancelled = cancelled;
+	pendingExpansion.result = std::move(result);
+	pendingExpansion.placeholderShown = false;
+	m_pendingExpansions.insert({ expansionResultID, std::move(pendingExpansion) });
+
+	SetTimer(m_hTreeView, LOADING_PLACEHOLDER_TIMER_ID, LOADING_PLACEHOLDER_TIMER_ELAPSE, nullptr);
+}
+
+std::vector<ShellTreeView::EnumeratedChild> ShellTreeView::EnumerateChildrenAsync(HWND treeView,
+	int expansionResultId, PCIDLIST_ABSOLUTE pidlDirectory, bool showHidden,
+	std::shared_ptr<std::atomic<bool>> cancelled)
+{
+	if (*cancelled)
+	{
+		return {};
+	}
+
+	auto children = EnumerateChildren(pidlDirectory, showHidden, *cancelled);
+
+	PostMessage(treeView, WM_APP_ENUMERATION_RESULT_READY, expansionResultId, 0);
+
+	return children;
+}
+
+std::vector<ShellTreeView::EnumeratedChild> ShellTreeView::EnumerateChildren(
+	PCIDLIST_ABSOLUTE pidlDirectory, bool showHidden, const std::atomic<bool> &cancelled)
+{
+	wil::com_ptr<IShellFolder> pShellFolder;
+	HRESULT hr = BindToIdl(pidlDirectory, IID_PPV_ARGS(&pShellFolder));
+
+	if (FAILED(hr))
+	{
+		return {};
+	}
+
+	SHCONTF enumFlags = SHCONTF_FOLDERS;
+
+	if (showHidden)
+	{
+		enumFlags |= SHCONTF_INCLUDEHIDDEN | SHCONTF_INCLUDESUPERHIDDEN;
+	}
+
+	wil::com_ptr<IEnumIDList> pEnumIDList;
+	hr = pShellFolder->EnumObjects(nullptr, enumFlags, &pEnumIDList);
+
+	if (FAILED(hr) || !pEnumIDList)
+	{
+		return {};
+	}
+
+	std::vector<EnumeratedChild> children;
+
+	unique_pidl_child rgelt;
+	ULONG uFetched = 1;
+
+	while (!cancelled && pEnumIDList->Next(1, wil::out_param(rgelt), &uFetched) == S_OK
+		&& (uFetched == 1))
+	{
+		STRRET str;
+		hr = pShellFolder->GetDisplayNameOf(rgelt.get(), SHGDN_NORMAL, &str);
+
+		if (FAILED(hr))
+		{
+			continue;
+		}
+
+		TCHAR itemName[MAX_PATH];
+		hr = StrRetToBuf(&str, rgelt.get(), itemName, SIZEOF_ARRAY(itemName));
+
+		if (FAILED(hr))
+		{
+			continue;
+		}
+
+		unique_pidl_absolute pidlComplete(ILCombine(pidlDirectory, rgelt.get()));
+
+		TCHAR parsingPath[MAX_PATH];
+		hr = GetDisplayName(
+			pidlComplete.get(), parsingPath, SIZEOF_ARRAY(parsingPath), SHGDN_FORPARSING);
+
+		if (FAILED(hr))
+		{
+			// The item will still be shown, it just won't be indexed.
+			parsingPath[0] = '\0';
+		}
+
+		TCHAR sortName[MAX_PATH];
+		TCHAR path[MAX_PATH];
+		EnumeratedChild child;
+
+		if (PathIsRoot(parsingPath))
+		{
+			child.sortGroup = SortGroup::Drive;
+			StringCchCopy(sortName, SIZEOF_ARRAY(sortName), parsingPath);
+		}
+		else
+		{
+			child.sortGroup = SHGetPathFromIDList(pidlComplete.get(), path)
+				? SortGroup::FileSystem
+				: SortGroup::Virtual;
+
+			hr = GetDisplayName(
+				pidlComplete.get(), sortName, SIZEOF_ARRAY(sortName), SHGDN_INFOLDER);
+
+			if (FAILED(hr))
+			{
+				StringCchCopy(sortName, SIZEOF_ARRAY(sortName), itemName);
+			}
+		}
+
+		child.pidl = std::move(rgelt);
+		child.name = itemName;
+		child.parsingPath = parsingPath;
+		child.sortName = sortName;
+		children.push_back(std::move(child));
+	}
+
+	if (cancelled)
+	{
+		return {};
+	}
+
+	std::sort(children.begin(), children.end(), IsChildSortedBefore);
+
+	return children;
+}
+
+/* Sorts items in the following order:
+ - Drives
+ - Virtual Items
+ - Real Items
+
+Each set is ordered alphabetically. */
+bool ShellTreeView::IsChildSortedBefore(
+	const EnumeratedChild &child1, const EnumeratedChild &child2)
+{
+	if (child1.sortGroup != child2.sortGroup)
+	{
+		return child1.sortGroup < child2.sortGroup;
+	}
+
+	if (child1.sortGroup == SortGroup::Drive)
+	{
+		return lstrcmpi(child1.sortName.c_str(), child2.sortName.c_str()) < 0;
+	}
+
+	return StrCmpLogicalW(child1.sortName.c_str(), child2.sortName.c_str()) < 0;
+}
+
+void ShellTreeView::ProcessExpansionResult(int expansionResultId)
+{
+	auto itr = m_pendingExpansions.find(expansionResultId);
+
+	if (itr == m_pendingExpansions.end())
+	{
+		// The expansion was cancelled (e.g. because the item was collapsed or
+		// deleted).
+		return;
+	}
+
+	HTREEITEM item = itr->second.item;
+	auto children = itr->second.result.get();
+	m_pendingExpansions.erase(itr);
+
+	InsertChildren(item, std::move(children));
+}
+
+// Items are normally expanded in the background. Callers that need to walk the children of an item
+// immediately (e.g. to locate a nested item) can use this method instead.
+void ShellTreeView::ExpandItemSynchronously(HTREEITEM item)
+{
+	if (TreeView_GetChild(m_hTreeView, item) == nullptr)
+	{
+		SendMessage(m_hTreeView, TVM_EXPAND, TVE_EXPAND, reinterpret_cast<LPARAM>(item));
+	}
+
+	auto itr = FindPendingExpansion(item);
+
+	if (itr == m_pendingExpansions.end())
+	{
+		return;
+	}
+
+	// The background task may be queued behind other enumerations, so rather than waiting on it,
+	// the enumeration is simply performed here.
+	*itr->second.cancelled = true;
+	m_pendingExpansions.erase(itr);
+
+	std::atomic<bool> cancelled(false);
+	auto children = EnumerateChildren(GetItemPidl(item).get(), m_bShowHidden, cancelled);
+
+	InsertChildren(item, std::move(children));
+}
+
+std::unordered_map<int, ShellTreeView::PendingExpansion>::iterator
+ShellTreeView::FindPendingExpansion(HTREEITEM item)
+{
+	// There will typically only be a small number of items being expanded at any one time.
+	return std::find_if(m_pendingExpansions.begin(), m_pendingExpansions.end(),
+		[item](const auto &pendingExpansion) {
+			return pendingExpansion.second.item == item;
+		});
+}
+
+void ShellTreeView::CancelExpansion(HTREEITEM item)
+{
+	auto itr = FindPendingExpansion(item);
+
+	if (itr == m_pendingExpansions.end())
+	{
+		return;
+	}
+
+	*itr->second.cancelled = true;
+	m_pendingExpansions.erase(itr);
+}
+
+void ShellTreeView::CancelAllExpansions()
+{
+	for (auto &pendingExpansion : m_pendingExpansions)
+	{
+		*pendingExpansion.second.cancelled = true;
+	}
+
+	m_pendingExpansions.clear();
+}
+
+void ShellTreeView::OnLoadingPlaceholderTimer()
+{
+	KillTimer(m_hTreeView, LOADING_PLACEHOLDER_TIMER_ID);
+
+	std::wstring placeholderText =
+		ResourceHelper::LoadString(m_hLanguageModule, IDS_SHELL_TREE_VIEW_LOADING);
+
+	for (auto &pendingExpansion : m_pendingExpansions)
+	{
+		PendingExpansion &expansion = pendingExpansion.second;
+
+		if (expansion.placeholderShown)
+		{
+			continue;
+		}
+
+		// The placeholder is given the same pidl as its parent, so that anything that looks it
+		// up (e.g. if it's selected) will simply act on the parent. The placeholder will be
+		// removed once the real children are inserted.
+		int itemId = GenerateUniqueItemId();
+		m_itemInfoMap[itemId].pidl = GetItemPidl(expansion.item);
+
+		TVITEMEX tvItem;
+		tvItem.mask = TVIF_TEXT | TVIF_PARAM | TVIF_CHILDREN;
+		tvItem.pszText = placeholderText.data();
+		tvItem.lParam = itemId;
+		tvItem.cChildren = 0;
+
+		TVINSERTSTRUCT tvis;
+		tvis.hInsertAfter = TVI_LAST;
+		tvis.hParent = expansion.item;
+		tvis.itemex = tvItem;
+
+		if (TreeView_InsertItem(m_hTreeView, &tvis) == nullptr)
+		{
+			m_itemInfoMap.erase(itemId);
 		}
-		break;
+
+		expansion.placeholderShown = true;
 	}
+}
 
-	// If the ctrl key is down, this key sequence is likely a modifier. Stop any other pressed key
-	// from been used in an incremental search.
-	if (IsKeyDown(VK_CONTROL))
+// The children are already sorted, so each item can simply be appended. That avoids the cost of
+// inserting items in sorted order, as well as the cost of sorting the items once they've been
+// inserted.
+void ShellTreeView::InsertChildren(HTREEITEM parentItem, std::vector<EnumeratedChild> children)
+{
+	auto pidlParent = GetItemPidl(parentItem);
+
+	SendMessage(m_hTreeView, WM_SETREDRAW, FALSE, 0);
+
+	// Removes the placeholder, as well as any items that were added (in response to directory
+	// modification notifications) while the enumeration was in progress. Those items will be
+	// included in the enumerated set.
+	RemoveChildren(parentItem);
+
+	for (auto &child : children)
 	{
-		return 1;
+		int itemId = GenerateUniqueItemId();
+		auto &itemInfo = m_itemInfoMap[itemId];
+		itemInfo.pidl.reset(ILCombine(pidlParent.get(), child.pidl.get()));
+		itemInfo.pridl = std::move(child.pidl);
+
+		TVITEMEX tvItem;
+		tvItem.mask = TVIF_TEXT | TVIF_IMAGE | TVIF_SELECTEDIMAGE | TVIF_PARAM | TVIF_CHILDREN;
+		tvItem.pszText = child.name.data();
+		tvItem.iImage = I_IMAGECALLBACK;
+		tvItem.iSelectedImage = I_IMAGECALLBACK;
+		tvItem.lParam = itemId;
+		tvItem.cChildren = I_CHILDRENCALLBACK;
+
+		TVINSERTSTRUCT tvis;
+		tvis.hInsertAfter = TVI_LAST;
+		tvis.hParent = parentItem;
+		tvis.itemex = tvItem;
+
+		HTREEITEM item = TreeView_InsertItem(m_hTreeView, &tvis);
+
+		if (item != nullptr)
+		{
+			AddItemToPathIndex(item,
+				child.parsingPath.empty() ? GetPidlIndexKey(itemInfo.pidl.get())
+										  : child.parsingPath);
+		}
 	}
 
-	return 0;
+	SendMessage(m_hTreeView, WM_SETREDRAW, TRUE, 0);
 }
 
-/* Sorts items in the following order:
- - Drives
- - Virtual Items
- - Real Items
-
-Each set is ordered alphabetically. */
-int CALLBACK CompareItemsStub(LPARAM lParam1, LPARAM lParam2, LPARAM lParamSort)
+void ShellTreeView::RemoveChildren(HTREEITEM parentItem)
 {
-	ShellTreeView *shellTreeView = nullptr;
+	EraseItems(parentItem);
 
-	shellTreeView = (ShellTreeView *) lParamSort;
+	HTREEITEM child;
 
-	return shellTreeView->CompareItems(lParam1, lParam2);
+	while ((child = TreeView_GetChild(m_hTreeView, parentItem)) != nullptr)
+	{
+		TreeView_DeleteItem(m_hTreeView, child);
+	}
 }
 
-int CALLBACK ShellTreeView::CompareItems(LPARAM lParam1, LPARAM lParam2)
+void ShellTreeView::AddItemToPathIndex(HTREEITEM item, const std::wstring &parsingPath)
 {
-	TCHAR szDisplayName1[MAX_PATH];
-	TCHAR szDisplayName2[MAX_PATH];
-	TCHAR szTemp[MAX_PATH];
-	int iItemId1 = (int) lParam1;
-	int iItemId2 = (int) lParam2;
-
-	const ItemInfo_t &itemInfo1 = m_itemInfoMap.at(iItemId1);
-	const ItemInfo_t &itemInfo2 = m_itemInfoMap.at(iItemId2);
+	std::wstring normalizedPath = NormalizeParsingPath(parsingPath);
+	m_itemsByPath.insert({ normalizedPath, item });
+	m_pathsByItem.insert({ item, normalizedPath });
+}
 
-	GetDisplayName(
-		itemInfo1.pidl.get(), szDisplayName1, SIZEOF_ARRAY(szDisplayName1), SHGDN_FORPARSING);
-	GetDisplayName(
-		itemInfo2.pidl.get(), szDisplayName2, SIZEOF_ARRAY(szDisplayName2), SHGDN_FORPARSING);
+void ShellTreeView::AddItemToPathIndex(HTREEITEM item, PCIDLIST_ABSOLUTE pidl)
+{
+	TCHAR parsingPath[MAX_PATH];
+	HRESULT hr = GetDisplayName(pidl, parsingPath, SIZEOF_ARRAY(parsingPath), SHGDN_FORPARSING);
 
-	if (PathIsRoot(szDisplayName1) && !PathIsRoot(szDisplayName2))
+	if (SUCCEEDED(hr))
 	{
-		return -1;
+		AddItemToPathIndex(item, parsingPath);
 	}
-	else if (!PathIsRoot(szDisplayName1) && PathIsRoot(szDisplayName2))
+	else
 	{
-		return 1;
+		AddItemToPathIndex(item, GetPidlIndexKey(pidl));
 	}
-	else if (PathIsRoot(szDisplayName1) && PathIsRoot(szDisplayName2))
+}
+
+void ShellTreeView::RemoveItemFromPathIndex(HTREEITEM item)
+{
+	auto itr = m_pathsByItem.find(item);
+
+	if (itr == m_pathsByItem.end())
 	{
-		return lstrcmpi(szDisplayName1, szDisplayName2);
+		return;
 	}
-	else
+
+	auto [first, last] = m_itemsByPath.equal_range(itr->second);
+
+	for (auto pathItr = first; pathItr != last; ++pathItr)
 	{
-		if (!SHGetPathFromIDList(itemInfo1.pidl.get(), szTemp)
-			&& SHGetPathFromIDList(itemInfo2.pidl.get(), szTemp))
-		{
-			return -1;
-		}
-		else if (SHGetPathFromIDList(itemInfo1.pidl.get(), szTemp)
-			&& !SHGetPathFromIDList(itemInfo2.pidl.get(), szTemp))
-		{
-			return 1;
-		}
-		else
+		if (pathItr->second == item)
 		{
-			GetDisplayName(
-				itemInfo1.pidl.get(), szDisplayName1, SIZEOF_ARRAY(szDisplayName1), SHGDN_INFOLDER);
-			GetDisplayName(
-				itemInfo2.pidl.get(), szDisplayName2, SIZEOF_ARRAY(szDisplayName2), SHGDN_INFOLDER);
-
-			return StrCmpLogicalW(szDisplayName1, szDisplayName2);
+			m_itemsByPath.erase(pathItr);
+			break;
 		}
 	}
+
+	m_pathsByItem.erase(itr);
 }
 
-void ShellTreeView::AddDirectoryInternal(
-	IShellFolder *pShellFolder, PCIDLIST_ABSOLUTE pidlDirectory, HTREEITEM hParent)
+// Updates the indexed path of the specified item and all of its descendants. Used when an item is
+// renamed.
+void ShellTreeView::UpdatePathIndex(HTREEITEM item)
 {
-	SHCONTF enumFlags = SHCONTF_FOLDERS;
+	// Placeholder items are never indexed.
+	if (m_pathsByItem.count(item) > 0)
+	{
+		RemoveItemFromPathIndex(item);
+		AddItemToPathIndex(item, GetItemByHandle(item).pidl.get());
+	}
 
-	if (m_bShowHidden)
+	for (auto child = TreeView_GetChild(m_hTreeView, item); child != nullptr;
+		 child = TreeView_GetNextSibling(m_hTreeView, child))
 	{
-		enumFlags |= SHCONTF_INCLUDEHIDDEN | SHCONTF_INCLUDESUPERHIDDEN;
+		UpdatePathIndex(child);
 	}
+}
 
-	wil::com_ptr<IEnumIDList> pEnumIDList;
-	HRESULT hr = pShellFolder->EnumObjects(nullptr, enumFlags, &pEnumIDList);
+HTREEITEM ShellTreeView::FindIndexedItem(PCIDLIST_ABSOLUTE pidl)
+{
+	TCHAR parsingPath[MAX_PATH];
+	HRESULT hr = GetDisplayName(pidl, parsingPath, SIZEOF_ARRAY(parsingPath), SHGDN_FORPARSING);
 
-	if (FAILED(hr) || !pEnumIDList)
+	auto isMatch = [this, pidl](HTREEITEM item) {
+		return CompareIdls(GetItemByHandle(item).pidl.get(), pidl);
+	};
+
+	if (FAILED(hr))
 	{
-		return;
+		return FindIndexedItem(GetPidlIndexKey(pidl), isMatch);
 	}
 
-	SendMessage(m_hTreeView, WM_SETREDRAW, FALSE, 0);
-
-	std::vector<EnumeratedItem> items;
+	return FindIndexedItem(parsingPath, isMatch);
+}
 
-	unique_pidl_child rgelt;
-	ULONG uFetched = 1;
+// The index should contain every item, but a pidl that refers to an item without a parsing path
+// won't necessarily have the same contents as the pidl the item was indexed with. So if an item
+// can't be found through the index, the children of its parent are searched directly.
+HTREEITEM ShellTreeView::FindChildItem(HTREEITEM parentItem, PCIDLIST_ABSOLUTE pidl)
+{
+	HTREEITEM item = FindIndexedItem(pidl);
 
-	while (pEnumIDList->Next(1, wil::out_param(rgelt), &uFetched) == S_OK && (uFetched == 1))
+	if (item != nullptr)
 	{
-		STRRET str;
-		hr = pShellFolder->GetDisplayNameOf(rgelt.get(), SHGDN_NORMAL, &str);
+		return item;
+	}
 
-		if (SUCCEEDED(hr))
+	for (HTREEITEM child = TreeView_GetChild(m_hTreeView, parentItem); child != nullptr;
+		 child = TreeView_GetNextSibling(m_hTreeView, child))
+	{
+		if (CompareIdls(GetItemByHandle(child).pidl.get(), pidl))
 		{
-			TCHAR itemName[MAX_PATH];
-			hr = StrRetToBuf(&str, rgelt.get(), itemName, SIZEOF_ARRAY(itemName));
-
-			if (SUCCEEDED(hr))
-			{
-				int itemId = GenerateUniqueItemId();
-				m_itemInfoMap[itemId].pidl.reset(ILCombine(pidlDirectory, rgelt.get()));
-				m_itemInfoMap[itemId].pridl.reset(ILCloneChild(rgelt.get()));
-
-				EnumeratedItem item;
-				item.internalIndex = itemId;
-				item.name = itemName;
-				items.push_back(item);
-			}
+			return child;
 		}
 	}
 
-	for (auto &item : items)
+	return nullptr;
+}
+
+HTREEITEM ShellTreeView::FindIndexedItem(
+	const std::wstring &parsingPath, const std::function<bool(HTREEITEM)> &isMatch)
+{
+	auto [first, last] = m_itemsByPath.equal_range(NormalizeParsingPath(parsingPath));
+
+	for (auto itr = first; itr != last; ++itr)
 	{
-		TVITEMEX tvItem;
-		tvItem.mask = TVIF_TEXT | TVIF_IMAGE | TVIF_SELECTEDIMAGE | TVIF_PARAM | TVIF_CHILDREN;
-		tvItem.pszText = item.name.data();
-		tvItem.iImage = I_IMAGECALLBACK;
-		tvItem.iSelectedImage = I_IMAGECALLBACK;
-		tvItem.lParam = item.internalIndex;
-		tvItem.cChildren = I_CHILDRENCALLBACK;
+		if (isMatch(itr->second))
+		{
+			return itr->second;
+		}
+	}
 
-		TVINSERTSTRUCT tvis;
-		tvis.hInsertAfter = TVI_LAST;
-		tvis.hParent = hParent;
-		tvis.itemex = tvItem;
+	return nullptr;
+}
+
+bool ShellTreeView::IsItemDescendantOf(HTREEITEM item, HTREEITEM ancestor) const
+{
+	HTREEITEM currentItem = item;
 
-		TreeView_InsertItem(m_hTreeView, &tvis);
+	while ((currentItem = TreeView_GetParent(m_hTreeView, currentItem)) != nullptr)
+	{
+		if (currentItem == ancestor)
+		{
+			return true;
+		}
 	}
 
-	TVSORTCB tvscb;
-	tvscb.hParent = hParent;
-	tvscb.lpfnCompare = CompareItemsStub;
-	tvscb.lParam = reinterpret_cast<LPARAM>(this);
-	TreeView_SortChildrenCB(m_hTreeView, &tvscb, 0);
+	return false;
+}
 
-	SendMessage(m_hTreeView, WM_SETREDRAW, TRUE, 0);
+int ShellTreeView::GetItemDepth(HTREEITEM item) const
+{
+	int depth = 0;
+	HTREEITEM currentItem = item;
+
+	while ((currentItem = TreeView_GetParent(m_hTreeView, currentItem)) != nullptr)
+	{
+		depth++;
+	}
+
+	return depth;
 }
 
 int ShellTreeView::GenerateUniqueItemId()
@@ -968,76 +1466,12 @@ HTREEITEM ShellTreeView::LocateItem(PCIDLIST_ABSOLUTE pidlDirectory)
 
 /* Finds items that have been deleted or renamed
 (meaning that their pidl's are no longer valid).
-
-Use two basic strategies to find the item:
-1. Find the parent item through its pidl, the child
-through it's name.
-2. Find the item simply by its name.
-The first method would not normally be needed, but
-real folders can have a display name that differs
-from their parsing name.
-For example, the C:\Users\Username\Documents
-folder in Windows 7 has a display name of
-"My Documents". This is an issue, since a
-direct path lookup will fail. */
-/* TODO: Store parsing name with each item, and
-match against that. */
+Since the path index records the parsing path each
+item had when it was added, the item can still be
+found by its (old) path. */
 HTREEITEM ShellTreeView::LocateDeletedItem(const TCHAR *szFullFileName)
 {
-	HTREEITEM hItem = nullptr;
-	PIDLIST_ABSOLUTE pidl = nullptr;
-	TCHAR szParent[MAX_PATH];
-	BOOL bFound = FALSE;
-	HRESULT hr;
-
-	StringCchCopy(szParent, SIZEOF_ARRAY(szParent), szFullFileName);
-	PathRemoveFileSpec(szParent);
-	hr = SHParseDisplayName(szParent, nullptr, &pidl, 0, nullptr);
-
-	if (SUCCEEDED(hr))
-	{
-		hItem = LocateExistingItem(pidl);
-
-		if (hItem != nullptr)
-		{
-			HTREEITEM hChild;
-			TVITEM tvItem;
-			TCHAR szFileName[MAX_PATH];
-
-			hChild = TreeView_GetChild(m_hTreeView, hItem);
-
-			StringCchCopy(szFileName, SIZEOF_ARRAY(szFileName), szFullFileName);
-			PathStripPath(szFileName);
-
-			/* Now try to find the child folder. */
-			while (hChild != nullptr)
-			{
-				TCHAR szItem[MAX_PATH];
-
-				tvItem.mask = TVIF_TEXT | TVIF_HANDLE;
-				tvItem.hItem = hChild;
-				tvItem.pszText = szItem;
-				tvItem.cchTextMax = SIZEOF_ARRAY(szItem);
-				TreeView_GetItem(m_hTreeView, &tvItem);
-
-				if (lstrcmp(szFileName, szItem) == 0)
-				{
-					hItem = hChild;
-					bFound = TRUE;
-					break;
-				}
-
-				hChild = TreeView_GetNextSibling(m_hTreeView, hChild);
-			}
-		}
-	}
-
-	if (!bFound)
-	{
-		hItem = LocateItemByPath(szFullFileName, FALSE);
-	}
-
-	return hItem;
+	return LocateItemByPath(szFullFileName, FALSE);
 }
 
 HTREEITEM ShellTreeView::LocateExistingItem(const TCHAR *szParsingPath)
@@ -1061,59 +1495,58 @@ HTREEITEM ShellTreeView::LocateExistingItem(PCIDLIST_ABSOLUTE pidlDirectory)
 HTREEITEM ShellTreeView::LocateItemInternal(
 	PCIDLIST_ABSOLUTE pidlDirectory, BOOL bOnlyLocateExistingItem)
 {
-	HTREEITEM hRoot;
-	HTREEITEM hItem;
-	TVITEMEX item;
-	BOOL bFound = FALSE;
+	/* Each item in the tree has a pidl that's made up of
+	the pidls of its ancestors. The nearest ancestor that's
+	in the tree can therefore be found by removing one id
+	at a time from the end of the pidl and looking up the
+	result. */
+	std::vector<unique_pidl_absolute> pidls;
+	pidls.emplace_back(ILCloneFull(pidlDirectory));
 
-	/* Get the root of the tree (root of namespace). */
-	hRoot = TreeView_GetRoot(m_hTreeView);
-	hItem = hRoot;
+	while (!ILIsEmpty(pidls.back().get()))
+	{
+		unique_pidl_absolute pidlParent(ILCloneFull(pidls.back().get()));
+		ILRemoveLastID(pidlParent.get());
+		pidls.push_back(std::move(pidlParent));
+	}
 
-	item.mask = TVIF_PARAM | TVIF_HANDLE;
-	item.hItem = hItem;
-	TreeView_GetItem(m_hTreeView, &item);
+	HTREEITEM hItem = nullptr;
+	size_t index = 0;
 
-	/* Keep searching until the specified item
-	is found or it is found the item does not
-	exist in the treeview.
-	Look through each item, once an ancestor is
-	found, look through it's children, expanding
-	the parent node if necessary. */
-	while (!bFound && hItem != nullptr)
+	for (; index < pidls.size(); index++)
 	{
-		if (CompareIdls(m_itemInfoMap.at(static_cast<int>(item.lParam)).pidl.get(), pidlDirectory))
-		{
-			bFound = TRUE;
+		hItem = FindIndexedItem(pidls[index].get());
 
+		if (hItem != nullptr)
+		{
 			break;
 		}
+	}
 
-		if (ILIsParent(
-				m_itemInfoMap.at(static_cast<int>(item.lParam)).pidl.get(), pidlDirectory, FALSE))
-		{
-			if ((TreeView_GetChild(m_hTreeView, hItem)) == nullptr)
-			{
-				if (bOnlyLocateExistingItem)
-				{
-					return nullptr;
-				}
-				else
-				{
-					SendMessage(m_hTreeView, TVM_EXPAND, (WPARAM) TVE_EXPAND, (LPARAM) hItem);
-				}
-			}
+	if (hItem == nullptr || index == 0)
+	{
+		return hItem;
+	}
 
-			hItem = TreeView_GetChild(m_hTreeView, hItem);
-		}
-		else
+	/* The items below the ancestor that was found may
+	still be in the tree (if the index lookup failed), so
+	they're searched for directly, expanding each one
+	along the way if necessary. */
+	while (index > 0)
+	{
+		index--;
+
+		if (!bOnlyLocateExistingItem)
 		{
-			hItem = TreeView_GetNextSibling(m_hTreeView, hItem);
+			ExpandItemSynchronously(hItem);
 		}
 
-		item.mask = TVIF_PARAM | TVIF_HANDLE;
-		item.hItem = hItem;
-		TreeView_GetItem(m_hTreeView, &item);
+		hItem = FindChildItem(hItem, pidls[index].get());
+
+		if (hItem == nullptr)
+		{
+			return nullptr;
+		}
 	}
 
 	return hItem;
@@ -1121,167 +1554,79 @@ HTREEITEM ShellTreeView::LocateItemInternal(
 
 HTREEITEM ShellTreeView::LocateItemByPath(const TCHAR *szItemPath, BOOL bExpand)
 {
-	HTREEITEM hMyComputer;
-	HTREEITEM hItem;
-	HTREEITEM hNextItem;
-	TVITEMEX item;
-	TCHAR *ptr = nullptr;
-	TCHAR itemText[MAX_PATH];
-	TCHAR fullItemPathCopy[MAX_PATH];
-	TCHAR szItemName[MAX_PATH];
-	TCHAR *nextToken = nullptr;
-
-	StringCchCopy(fullItemPathCopy, SIZEOF_ARRAY(fullItemPathCopy), szItemPath);
-
-	PathRemoveBackslash(fullItemPathCopy);
-
 	unique_pidl_absolute pidlMyComputer;
-	SHGetFolderLocation(nullptr, CSIDL_DRIVES, nullptr, 0, wil::out_param(pidlMyComputer));
-
-	hMyComputer = LocateItem(pidlMyComputer.get());
-
-	/* First of drives in system. */
-	hItem = TreeView_GetChild(m_hTreeView, hMyComputer);
+	HRESULT hr =
+		SHGetFolderLocation(nullptr, CSIDL_DRIVES, nullptr, 0, wil::out_param(pidlMyComputer));
 
-	/* My Computer node may not be expanded. */
-	if (hItem == nullptr)
+	if (FAILED(hr))
+	{
 		return nullptr;
+	}
 
-	ptr = wcstok_s(fullItemPathCopy, _T("\\"), &nextToken);
-
-	StringCchCopy(itemText, SIZEOF_ARRAY(itemText), ptr);
-	StringCchCat(itemText, SIZEOF_ARRAY(itemText), _T("\\"));
-	ptr = itemText;
-
-	item.mask = TVIF_HANDLE | TVIF_PARAM;
-	item.hItem = hItem;
-	TreeView_GetItem(m_hTreeView, &item);
-
-	GetDisplayName(m_itemInfoMap.at(static_cast<int>(item.lParam)).pidl.get(), szItemName,
-		SIZEOF_ARRAY(szItemName), SHGDN_FORPARSING);
+	HTREEITEM hMyComputer = LocateExistingItem(pidlMyComputer.get());
 
-	while (StrCmpI(ptr, szItemName) != 0)
+	if (hMyComputer == nullptr)
 	{
-		hItem = TreeView_GetNextSibling(m_hTreeView, hItem);
-
-		if (hItem == nullptr)
-			return nullptr;
-
-		item.mask = TVIF_PARAM;
-		item.hItem = hItem;
-		TreeView_GetItem(m_hTreeView, &item);
-
-		GetDisplayName(m_itemInfoMap.at(static_cast<int>(item.lParam)).pidl.get(), szItemName,
-			SIZEOF_ARRAY(szItemName), SHGDN_FORPARSING);
+		return nullptr;
 	}
 
-	item.mask = TVIF_TEXT;
+	/* Only items beneath My Computer are considered. Items
+	on the desktop tree are located separately. */
+	HTREEITEM hItem = FindIndexedItem(szItemPath, [this, hMyComputer](HTREEITEM item) {
+		return IsItemDescendantOf(item, hMyComputer);
+	});
 
-	while ((ptr = wcstok_s(nullptr, _T("\\"), &nextToken)) != nullptr)
+	if (hItem != nullptr || !bExpand)
 	{
-		if (TreeView_GetChild(m_hTreeView, hItem) == nullptr)
-		{
-			if (bExpand)
-				SendMessage(m_hTreeView, TVM_EXPAND, (WPARAM) TVE_EXPAND, (LPARAM) hItem);
-			else
-				return nullptr;
-		}
-
-		hNextItem = TreeView_GetChild(m_hTreeView, hItem);
-		hItem = hNextItem;
-
-		item.pszText = itemText;
-		item.cchTextMax = SIZEOF_ARRAY(itemText);
-		item.hItem = hItem;
-		TreeView_GetItem(m_hTreeView, &item);
-
-		while (StrCmpI(ptr, itemText) != 0)
-		{
-			hItem = TreeView_GetNextSibling(m_hTreeView, hItem);
+		return hItem;
+	}
 
-			if (hItem == nullptr)
-				return nullptr;
+	unique_pidl_absolute pidl;
+	hr = SHParseDisplayName(szItemPath, nullptr, wil::out_param(pidl), 0, nullptr);
 
-			item.pszText = itemText;
-			item.cchTextMax = SIZEOF_ARRAY(itemText);
-			item.hItem = hItem;
-			TreeView_GetItem(m_hTreeView, &item);
-		}
+	if (FAILED(hr))
+	{
+		return nullptr;
 	}
 
-	return hItem;
+	return LocateItem(pidl.get());
 }
 
-/* Locate an item which is a Desktop (sub)child, if visible.
-   Does not expand any item */
 HTREEITEM ShellTreeView::LocateItemOnDesktopTree(const TCHAR *szFullFileName)
 {
-	HTREEITEM hItem;
-	TVITEMEX tvItem;
-	TCHAR szFileName[MAX_PATH];
-	TCHAR szDesktop[MAX_PATH];
-	TCHAR szCurrentItem[MAX_PATH];
-	TCHAR *pItemName = nullptr;
-	TCHAR *nextToken = nullptr;
-	BOOL bDesktop;
-	BOOL bFound;
-
-	bDesktop = IsDesktopSubChild(szFullFileName);
-
-	if (!bDesktop)
+	if (!IsDesktopSubChild(szFullFileName))
 	{
 		return nullptr;
 	}
 
-	StringCchCopy(szFileName, SIZEOF_ARRAY(szFileName), szFullFileName);
-
+	TCHAR szDesktop[MAX_PATH];
 	SHGetFolderPath(nullptr, CSIDL_DESKTOP, nullptr, SHGFP_TYPE_CURRENT, szDesktop);
 
-	pItemName = &szFileName[lstrlen(szDesktop)];
-
-	if (lstrlen(szFullFileName) > lstrlen(szDesktop))
-	{
-		pItemName++; // Skip the "\\" after the desktop folder name
-	}
-
-	nextToken = nullptr;
-	pItemName = wcstok_s(pItemName, _T("\\"), &nextToken);
-
-	hItem = TreeView_GetRoot(m_hTreeView);
+	/* Items on the desktop tree are reached by following
+	each component of the path (relative to the desktop
+	folder) down from the root. The same path may also
+	appear deeper in the tree (e.g. beneath My Computer),
+	so the depth of the item is used to select the
+	correct one. */
+	int depth = 0;
+	bool inComponent = false;
 
-	while (pItemName != nullptr)
+	for (const TCHAR *ptr = szFullFileName + lstrlen(szDesktop); *ptr != '\0'; ptr++)
 	{
-		hItem = TreeView_GetChild(m_hTreeView, hItem);
-		bFound = FALSE;
-
-		while (hItem != nullptr && !bFound)
+		if (*ptr == '\\')
 		{
-			tvItem.mask = TVIF_TEXT;
-			tvItem.hItem = hItem;
-			tvItem.pszText = szCurrentItem;
-			tvItem.cchTextMax = SIZEOF_ARRAY(szCurrentItem);
-			TreeView_GetItem(m_hTreeView, &tvItem);
-
-			if (lstrcmp(szCurrentItem, pItemName) == 0)
-			{
-				bFound = TRUE;
-			}
-			else
-			{
-				hItem = TreeView_GetNextSibling(m_hTreeView, hItem);
-			}
+			inComponent = false;
 		}
-
-		if (!bFound)
+		else if (!inComponent)
 		{
-			return nullptr;
+			inComponent = true;
+			depth++;
 		}
-
-		// Item found, pass to sub-level
-		pItemName = wcstok_s(nextToken, _T("\\"), &nextToken);
 	}
 
-	return hItem;
+	return FindIndexedItem(szFullFileName, [this, depth](HTREEITEM item) {
+		return GetItemDepth(item) == depth;
+	});
 }
 
 void ShellTreeView::EraseItems(HTREEITEM hParent)
@@ -1714,6 +2059,30 @@ BOOL ShellTreeView::QueryDragging()
 	return m_bDragging;
 }
 
+// The folder being hovered over is a likely navigation target, so it may be
+// worth enumerating ahead of time.
+void ShellTreeView::OnHover(const POINT *pt)
+{
+	if (!m_config->prefetchFolders)
+	{
+		return;
+	}
+
+	TVHITTESTINFO hitTestInfo;
+	hitTestInfo.pt = *pt;
+	HTREEITEM item = TreeView_HitTest(m_hTreeView, &hitTestInfo);
+
+	if (!item || !WI_IsAnyFlagSet(hitTestInfo.flags, TVHT_ONITEM) || item == m_lastHoveredItem)
+	{
+		return;
+	}
+
+	m_lastHoveredItem = item;
+
+	auto pidl = GetItemPidl(item);
+	m_folderPrefetcher->RequestPrefetch(pidl.get(), m_bShowHidden);
+}
+
 void ShellTreeView::SetShowHidden(BOOL bShowHidden)
 {
 	m_bShowHidden = bShowHidden;
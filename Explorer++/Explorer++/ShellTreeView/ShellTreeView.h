@@ -5,17 +5,23 @@
 #pragma once
 
 #include "../Helper/DropHandler.h"
+#include "../Helper/IconFetcher.h"
+#include "../Helper/LruCache.h"
 #include "../Helper/ShellHelper.h"
 #include "../Helper/WindowSubclassWrapper.h"
 #include "../Helper/iDirectoryMonitor.h"
 #include "../ThirdParty/CTPL/cpl_stl.h"
 #include <boost/signals2.hpp>
 #include <wil/com.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <optional>
 
 class CachedIcons;
 struct Config;
 class FileActionHandler;
+class FolderPrefetcher;
 __interface IExplorerplusplus;
 class TabContainer;
 
@@ -42,9 +48,6 @@ public:
 	void SetShowHidden(BOOL bShowHidden);
 	void RefreshAllIcons();
 
-	/* Sorting. */
-	int CALLBACK CompareItems(LPARAM lParam1, LPARAM lParam2);
-
 	/* Drag and Drop. */
 	HRESULT _stdcall DragEnter(
 		IDataObject *pDataObject, DWORD grfKeyState, POINTL pt, DWORD *pdwEffect) override;
@@ -66,8 +69,25 @@ private:
 	static const UINT_PTR SUBCLASS_ID = 0;
 	static const UINT_PTR PARENT_SUBCLASS_ID = 0;
 
-	static const UINT WM_APP_ICON_RESULT_READY = WM_APP + 1;
 	static const UINT WM_APP_SUBFOLDERS_RESULT_READY = WM_APP + 2;
+	static const UINT WM_APP_ENUMERATION_RESULT_READY = WM_APP + 3;
+	static const UINT WM_APP_QUEUE_SUBFOLDERS_TASKS = WM_APP + 4;
+
+	static const size_t SUBFOLDERS_CACHE_SIZE = 10000;
+
+	// Checking items on a network share can be slow, so each batch of network items is only given
+	// a limited amount of time. Any items that haven't been checked by then will simply continue
+	// to show an expand button.
+	static inline constexpr auto NETWORK_SUBFOLDERS_BUDGET = std::chrono::milliseconds(1000);
+
+	// Network volumes aren't monitored for changes, so cached results for network items expire
+	// instead.
+	static inline constexpr auto NETWORK_SUBFOLDERS_CACHE_LIFETIME = std::chrono::minutes(1);
+
+	// If the children of an item haven't been enumerated by the time this timer fires, a
+	// placeholder item will be shown beneath the item until they are.
+	static const UINT_PTR LOADING_PLACEHOLDER_TIMER_ID = 3;
+	static const UINT LOADING_PLACEHOLDER_TIMER_ELAPSE = 250;
 
 	// This is the same background color as used in the Explorer treeview.
 	static inline constexpr COLORREF TREE_VIEW_DARK_MODE_BACKGROUND_COLOR = RGB(25, 25, 25);
@@ -78,11 +98,33 @@ private:
 		unique_pidl_child pridl;
 	} ItemInfo_t;
 
-	typedef struct
+	// Drives are shown first, followed by virtual items (e.g. Control Panel), followed by
+	// filesystem items.
+	enum class SortGroup
 	{
-		int internalIndex;
+		Drive,
+		Virtual,
+		FileSystem
+	};
+
+	// The sort key is generated alongside the item during enumeration, so that sorting doesn't
+	// need to query the shell each time two items are compared.
+	struct EnumeratedChild
+	{
+		unique_pidl_child pidl;
 		std::wstring name;
-	} EnumeratedItem;
+		std::wstring parsingPath;
+		SortGroup sortGroup;
+		std::wstring sortName;
+	};
+
+	struct PendingExpansion
+	{
+		HTREEITEM item;
+		std::shared_ptr<std::atomic<bool>> cancelled;
+		std::future<std::vector<EnumeratedChild>> result;
+		bool placeholderShown;
+	};
 
 	typedef struct
 	{
@@ -102,19 +144,35 @@ private:
 		unique_pidl_absolute pidl;
 	};
 
-	struct IconResult
+	struct SubfoldersCheck
 	{
 		HTREEITEM item;
-		int internalIndex;
-		int iconIndex;
+		unique_pidl_child pidl;
+		std::wstring indexKey;
+	};
+
+	// The items in a batch all share the same parent, so the parent folder only needs to be bound
+	// to once.
+	struct SubfoldersBatch
+	{
+		unique_pidl_absolute pidlParent;
+		std::vector<SubfoldersCheck> items;
+		bool isNetworkVolume;
 	};
 
 	struct SubfoldersResult
 	{
 		HTREEITEM item;
+		std::wstring indexKey;
 		bool hasSubfolder;
 	};
 
+	struct CachedSubfoldersResult
+	{
+		bool hasSubfolder;
+		std::optional<std::chrono::steady_clock::time_point> expiryTime;
+	};
+
 	typedef struct
 	{
 		TCHAR szPath[MAX_PATH];
@@ -138,9 +196,6 @@ private:
 		UINT_PTR uIdSubclass, DWORD_PTR dwRefData);
 	LRESULT CALLBACK ParentWndProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
-	HRESULT ExpandDirectory(HTREEITEM hParent);
-	void AddDirectoryInternal(
-		IShellFolder *pShellFolder, PCIDLIST_ABSOLUTE pidlDirectory, HTREEITEM hParent);
 	void DirectoryModified(DWORD dwAction, const TCHAR *szFullFileName);
 	void DirectoryAltered();
 	HTREEITEM AddRoot();
@@ -156,6 +211,7 @@ private:
 	LRESULT CALLBACK OnDeviceChange(WPARAM wParam, LPARAM lParam);
 	void OnGetDisplayInfo(NMTVDISPINFO *pnmtvdi);
 	void OnItemExpanding(const NMTREEVIEW *nmtv);
+	void OnDeleteItem(const NMTREEVIEW *nmtv);
 	LRESULT OnKeyDown(const NMTVKEYDOWN *keyDown);
 	void UpdateChildren(HTREEITEM hParent, PCIDLIST_ABSOLUTE pidlParent);
 	PCIDLIST_ABSOLUTE UpdateItemInfo(PCIDLIST_ABSOLUTE pidlParent, int iItemId);
@@ -164,6 +220,7 @@ private:
 	HTREEITEM LocateItemOnDesktopTree(const TCHAR *szFullFileName);
 	void OnMiddleButtonDown(const POINT *pt);
 	void OnMiddleButtonUp(const POINT *pt);
+	void OnHover(const POINT *pt);
 	bool OnEndLabelEdit(const NMTVDISPINFO *dispInfo);
 
 	void UpdateCurrentClipboardObject(wil::com_ptr<IDataObject> clipboardDataObject);
@@ -180,15 +237,46 @@ private:
 
 	/* Icons. */
 	void QueueIconTask(HTREEITEM item, int internalIndex);
-	static std::optional<IconResult> FindIconAsync(
-		HWND treeView, int iconResultId, HTREEITEM item, int internalIndex, PCIDLIST_ABSOLUTE pidl);
-	void ProcessIconResult(int iconResultId);
+	void ProcessIconResult(HTREEITEM item, int iconIndex);
 	std::optional<int> GetCachedIconIndex(const ItemInfo_t &itemInfo);
 
-	void QueueSubfoldersTask(HTREEITEM item);
-	static std::optional<SubfoldersResult> CheckSubfoldersAsync(
-		HWND treeView, int subfoldersResultId, HTREEITEM item, PCIDLIST_ABSOLUTE pidl);
+	/* Subfolders. */
+	void QueueSubfoldersCheck(HTREEITEM item);
+	void QueueSubfoldersTasks();
+	static std::vector<SubfoldersResult> CheckSubfoldersAsync(
+		HWND treeView, int subfoldersResultId, std::shared_ptr<SubfoldersBatch> batch);
 	void ProcessSubfoldersResult(int subfoldersResultId);
+	std::optional<bool> GetCachedSubfolders(HTREEITEM item);
+	void InvalidateCachedSubfolders(const TCHAR *szFullFileName);
+
+	/* Expansion. */
+	void QueueExpansionTask(HTREEITEM item);
+	static std::vector<EnumeratedChild> EnumerateChildrenAsync(HWND treeView,
+		int expansionResultId, PCIDLIST_ABSOLUTE pidlDirectory, bool showHidden,
+		std::shared_ptr<std::atomic<bool>> cancelled);
+	static std::vector<EnumeratedChild> EnumerateChildren(
+		PCIDLIST_ABSOLUTE pidlDirectory, bool showHidden, const std::atomic<bool> &cancelled);
+	static bool IsChildSortedBefore(const EnumeratedChild &child1, const EnumeratedChild &child2);
+	void ProcessExpansionResult(int expansionResultId);
+	void ExpandItemSynchronously(HTREEITEM item);
+	std::unordered_map<int, PendingExpansion>::iterator FindPendingExpansion(HTREEITEM item);
+	void CancelExpansion(HTREEITEM item);
+	void CancelAllExpansions();
+	void OnLoadingPlaceholderTimer();
+	void InsertChildren(HTREEITEM parentItem, std::vector<EnumeratedChild> children);
+	void RemoveChildren(HTREEITEM parentItem);
+
+	/* Path index. */
+	void AddItemToPathIndex(HTREEITEM item, const std::wstring &parsingPath);
+	void AddItemToPathIndex(HTREEITEM item, PCIDLIST_ABSOLUTE pidl);
+	void RemoveItemFromPathIndex(HTREEITEM item);
+	void UpdatePathIndex(HTREEITEM item);
+	HTREEITEM FindIndexedItem(PCIDLIST_ABSOLUTE pidl);
+	HTREEITEM FindChildItem(HTREEITEM parentItem, PCIDLIST_ABSOLUTE pidl);
+	HTREEITEM FindIndexedItem(
+		const std::wstring &parsingPath, const std::function<bool(HTREEITEM)> &isMatch);
+	bool IsItemDescendantOf(HTREEITEM item, HTREEITEM ancestor) const;
+	int GetItemDepth(HTREEITEM item) const;
 
 	/* Item id's. */
 	int GenerateUniqueItemId();
@@ -226,21 +314,40 @@ private:
 	std::vector<std::unique_ptr<WindowSubclassWrapper>> m_windowSubclasses;
 	std::vector<boost::signals2::scoped_connection> m_connections;
 	const Config *m_config;
+	HMODULE m_hLanguageModule;
 	TabContainer *m_tabContainer;
 	FileActionHandler *m_fileActionHandler;
 
-	ctpl::thread_pool m_iconThreadPool;
-	std::unordered_map<int, std::future<std::optional<IconResult>>> m_iconResults;
-	int m_iconResultIDCounter;
+	IconFetcher m_iconFetcher;
 
 	ctpl::thread_pool m_subfoldersThreadPool;
-	std::unordered_map<int, std::future<std::optional<SubfoldersResult>>> m_subfoldersResults;
+	ctpl::thread_pool m_networkSubfoldersThreadPool;
+	std::unordered_map<int, std::future<std::vector<SubfoldersResult>>> m_subfoldersResults;
 	int m_subfoldersResultIDCounter;
 
+	// Items waiting to be checked, grouped by their parent.
+	std::unordered_map<HTREEITEM, std::vector<HTREEITEM>> m_pendingSubfoldersChecks;
+
+	// Keyed by the same key used in the path index. Results are retained when an item is
+	// collapsed, so that the children don't need to be checked again when it's next expanded.
+	LruCache<std::wstring, CachedSubfoldersResult> m_subfoldersCache;
+
+	ctpl::thread_pool m_expansionThreadPool;
+	std::unordered_map<int, PendingExpansion> m_pendingExpansions;
+	int m_expansionResultIDCounter;
+
 	/* Item id's and info. */
 	std::unordered_map<int, ItemInfo_t> m_itemInfoMap;
 	int m_itemIDCounter;
+
+	// Maps the parsing path of each item to the item. The same path can appear more than once
+	// in the tree (e.g. a folder on the desktop appears both beneath the root item and beneath My
+	// Computer), so each lookup also needs to check which of the matching items is wanted. Items
+	// that don't have a parsing path are indexed by a key generated from their pidl.
+	std::unordered_multimap<std::wstring, HTREEITEM> m_itemsByPath;
+	std::unordered_map<HTREEITEM, std::wstring> m_pathsByItem;
 	CachedIcons *m_cachedIcons;
+	FolderPrefetcher *m_folderPrefetcher;
 
 	int m_iFolderIcon;
 
@@ -260,6 +367,8 @@ private:
 	HTREEITEM m_cutItem;
 	wil::com_ptr<IDataObject> m_clipboardDataObject;
 
+	HTREEITEM m_lastHoveredItem;
+
 	/* Directory modification. */
 	std::list<AlteredFile_t> m_AlteredList;
 	std::list<AlteredFile_t> m_AlteredTrackingList;
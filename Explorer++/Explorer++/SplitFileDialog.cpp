@@ -17,8 +17,8 @@
 #include "../Helper/StringHelper.h"
 #include "../Helper/WindowHelper.h"
 #include "../Helper/XMLSettings.h"
+#include "../Helper/XmlStream.h"
 #include <boost/scope_exit.hpp>
-#include <comdef.h>
 #include <unordered_map>
 
 #pragma warning(                                                                                   \
@@ -695,22 +695,21 @@ void SplitFileDialogPersistentSettings::LoadExtraRegistrySettings(HKEY hKey)
 	NRegistrySettings::ReadStringFromRegistry(hKey, SETTING_SIZE_GROUP, m_strSplitGroup);
 }
 
-void SplitFileDialogPersistentSettings::SaveExtraXMLSettings(
-	IXMLDOMDocument *pXMLDom, IXMLDOMElement *pParentNode)
+void SplitFileDialogPersistentSettings::SaveExtraXMLSettings(XmlStreamWriter &writer)
 {
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_SIZE, m_strSplitSize.c_str());
-	NXMLSettings::AddAttributeToNode(
-		pXMLDom, pParentNode, SETTING_SIZE_GROUP, m_strSplitGroup.c_str());
+	writer.WriteAttribute(SETTING_SIZE, m_strSplitSize.c_str());
+	writer.WriteAttribute(SETTING_SIZE_GROUP, m_strSplitGroup.c_str());
 }
 
-void SplitFileDialogPersistentSettings::LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue)
+void SplitFileDialogPersistentSettings::LoadExtraXMLSettings(
+	const WCHAR *wszName, const WCHAR *wszValue)
 {
-	if (lstrcmpi(bstrName, SETTING_SIZE) == 0)
+	if (lstrcmpi(wszName, SETTING_SIZE) == 0)
 	{
-		m_strSplitSize = _bstr_t(bstrValue);
+		m_strSplitSize = wszValue;
 	}
-	else if (lstrcmpi(bstrName, SETTING_SIZE_GROUP) == 0)
+	else if (lstrcmpi(wszName, SETTING_SIZE_GROUP) == 0)
 	{
-		m_strSplitGroup = _bstr_t(bstrValue);
+		m_strSplitGroup = wszValue;
 	}
 }
\ No newline at end of file
@@ -8,6 +8,8 @@
 #include "CoreInterface.h"
 #include "PreservedTab.h"
 #include "ShellBrowser/FolderSettings.h"
+#include "ShellBrowser/HistoryEntry.h"
+#include "ShellBrowser/PreservedFolderState.h"
 #include "ShellBrowser/ShellBrowser.h"
 #include "ShellBrowser/ShellNavigationController.h"
 #include <wil/resource.h>
@@ -18,6 +20,9 @@ Tab::Tab(IExplorerplusplus *expp, TabNavigationInterface *tabNavigation,
 	FileActionHandler *fileActionHandler, const FolderSettings *folderSettings,
 	std::optional<FolderColumns> initialColumns) :
 	m_id(idCounter++),
+	m_expp(expp),
+	m_tabNavigation(tabNavigation),
+	m_fileActionHandler(fileActionHandler),
 	m_useCustomName(false),
 	m_lockState(LockState::NotLocked)
 {
@@ -39,6 +44,9 @@ Tab::Tab(IExplorerplusplus *expp, TabNavigationInterface *tabNavigation,
 Tab::Tab(const PreservedTab &preservedTab, IExplorerplusplus *expp,
 	TabNavigationInterface *tabNavigation, FileActionHandler *fileActionHandler) :
 	m_id(idCounter++),
+	m_expp(expp),
+	m_tabNavigation(tabNavigation),
+	m_fileActionHandler(fileActionHandler),
 	m_useCustomName(preservedTab.useCustomName),
 	m_customName(preservedTab.customName),
 	m_lockState(preservedTab.lockState)
@@ -48,16 +56,186 @@ Tab::Tab(const PreservedTab &preservedTab, IExplorerplusplus *expp,
 		preservedTab.preservedFolderState);
 }
 
+Tab::Tab(UnloadedTabState unloadedState, IExplorerplusplus *expp,
+	TabNavigationInterface *tabNavigation, FileActionHandler *fileActionHandler) :
+	m_id(idCounter++),
+	m_expp(expp),
+	m_tabNavigation(tabNavigation),
+	m_fileActionHandler(fileActionHandler),
+	m_shellBrowser(nullptr),
+	m_unloadedState(std::make_unique<UnloadedTabState>(std::move(unloadedState))),
+	m_useCustomName(false),
+	m_lockState(LockState::NotLocked)
+{
+}
+
 int Tab::GetId() const
 {
 	return m_id;
 }
 
+bool Tab::IsLoaded() const
+{
+	return m_shellBrowser != nullptr;
+}
+
+void Tab::EnsureLoaded()
+{
+	if (!m_shellBrowser)
+	{
+		Load();
+	}
+}
+
+ShellBrowser *Tab::GetShellBrowser()
+{
+	EnsureLoaded();
+
+	return m_shellBrowser;
+}
+
 ShellBrowser *Tab::GetShellBrowser() const
 {
+	assert(m_shellBrowser);
+
 	return m_shellBrowser;
 }
 
+void Tab::Load()
+{
+	// The unloaded state is released before the ShellBrowser is handed out, so
+	// that the methods below switch over to querying the ShellBrowser directly.
+	auto unloadedState = std::move(m_unloadedState);
+
+	bool hibernated = !unloadedState->history.empty();
+
+	if (hibernated)
+	{
+		m_shellBrowser = ShellBrowser::CreateFromPreserved(m_id, m_expp->GetMainWindow(), m_expp,
+			m_tabNavigation, m_fileActionHandler, unloadedState->history,
+			unloadedState->currentEntry, PreservedFolderState(unloadedState->folderSettings));
+
+		if (unloadedState->initialColumns)
+		{
+			m_shellBrowser->ImportAllColumns(*unloadedState->initialColumns);
+		}
+	}
+	else
+	{
+		m_shellBrowser = ShellBrowser::CreateNew(m_id, m_expp->GetMainWindow(), m_expp,
+			m_tabNavigation, m_fileActionHandler, unloadedState->folderSettings,
+			unloadedState->initialColumns);
+	}
+
+	m_tabLoadedSignal(*this, unloadedState->pidlDirectory.get(), !hibernated);
+
+	// This is only done once the tab has navigated, since a tab that's
+	// restricted to opening new tabs would otherwise be unable to return to
+	// its current history entry.
+	UpdateNavigationMode();
+
+	if (unloadedState->viewState)
+	{
+		m_shellBrowser->RestoreViewState(*unloadedState->viewState);
+	}
+}
+
+void Tab::Unload()
+{
+	auto unloadedState = std::make_unique<UnloadedTabState>();
+	unloadedState->pidlDirectory = m_shellBrowser->GetDirectoryIdl();
+	unloadedState->folderSettings = m_shellBrowser->GetFolderSettings();
+	unloadedState->initialColumns = m_shellBrowser->ExportAllColumns();
+
+	auto *navigationController = m_shellBrowser->GetNavigationController();
+
+	for (int i = 0; i < navigationController->GetNumHistoryEntries(); i++)
+	{
+		unloadedState->history.push_back(
+			std::make_unique<PreservedHistoryEntry>(*navigationController->GetEntryAtIndex(i)));
+	}
+
+	unloadedState->currentEntry = navigationController->GetCurrentIndex();
+	unloadedState->viewState = m_shellBrowser->GetViewState();
+
+	// This allows the folder to be shown straight away when the tab is
+	// reloaded, rather than having to wait for it to be enumerated again.
+	m_shellBrowser->StoreFolderListing();
+
+	m_shellBrowser->Release();
+	m_shellBrowser = nullptr;
+
+	m_unloadedState = std::move(unloadedState);
+}
+
+const std::vector<std::unique_ptr<PreservedHistoryEntry>> &Tab::GetPreservedHistory() const
+{
+	assert(m_unloadedState);
+
+	return m_unloadedState->history;
+}
+
+int Tab::GetPreservedCurrentEntry() const
+{
+	assert(m_unloadedState);
+
+	return m_unloadedState->currentEntry;
+}
+
+unique_pidl_absolute Tab::GetDirectoryIdl() const
+{
+	if (m_unloadedState)
+	{
+		return unique_pidl_absolute(ILCloneFull(m_unloadedState->pidlDirectory.get()));
+	}
+
+	return m_shellBrowser->GetDirectoryIdl();
+}
+
+std::wstring Tab::GetDirectory() const
+{
+	if (m_unloadedState)
+	{
+		TCHAR directory[MAX_PATH];
+		HRESULT hr = GetDisplayName(m_unloadedState->pidlDirectory.get(), directory,
+			SIZEOF_ARRAY(directory), SHGDN_FORPARSING);
+
+		if (FAILED(hr))
+		{
+			return {};
+		}
+
+		return directory;
+	}
+
+	return m_shellBrowser->GetDirectory();
+}
+
+FolderSettings Tab::GetFolderSettings() const
+{
+	if (m_unloadedState)
+	{
+		return m_unloadedState->folderSettings;
+	}
+
+	return m_shellBrowser->GetFolderSettings();
+}
+
+FolderColumns Tab::GetFolderColumns() const
+{
+	if (m_unloadedState)
+	{
+		if (m_unloadedState->initialColumns)
+		{
+			return *m_unloadedState->initialColumns;
+		}
+
+		return m_expp->GetConfig()->globalFolderSettings.folderColumns;
+	}
+
+	return m_shellBrowser->ExportAllColumns();
+}
+
 // If a custom name has been set, that will be returned. Otherwise, the
 // display name of the current directory will be returned.
 std::wstring Tab::GetName() const
@@ -67,7 +245,7 @@ std::wstring Tab::GetName() const
 		return m_customName;
 	}
 
-	auto pidlDirectory = m_shellBrowser->GetDirectoryIdl();
+	auto pidlDirectory = GetDirectoryIdl();
 
 	TCHAR name[MAX_PATH];
 	HRESULT hr = GetDisplayName(pidlDirectory.get(), name, SIZEOF_ARRAY(name), SHGDN_INFOLDER);
@@ -115,7 +293,19 @@ void Tab::SetLockState(LockState lockState)
 
 	m_lockState = lockState;
 
-	switch (lockState)
+	// If the tab hasn't been loaded yet, the navigation mode will be set once
+	// it is.
+	if (m_shellBrowser)
+	{
+		UpdateNavigationMode();
+	}
+
+	m_tabUpdatedSignal(*this, PropertyType::LockState);
+}
+
+void Tab::UpdateNavigationMode()
+{
+	switch (m_lockState)
 	{
 	case Tab::LockState::NotLocked:
 		m_shellBrowser->GetNavigationController()->SetNavigationMode(
@@ -128,11 +318,14 @@ void Tab::SetLockState(LockState lockState)
 			ShellNavigationController::NavigationMode::ForceNewTab);
 		break;
 	}
-
-	m_tabUpdatedSignal(*this, PropertyType::LockState);
 }
 
 boost::signals2::connection Tab::AddTabUpdatedObserver(const TabUpdatedSignal::slot_type &observer)
 {
 	return m_tabUpdatedSignal.connect(observer);
+}
+
+boost::signals2::connection Tab::AddTabLoadedObserver(const TabLoadedSignal::slot_type &observer)
+{
+	return m_tabLoadedSignal.connect(observer);
 }
\ No newline at end of file
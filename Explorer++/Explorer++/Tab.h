@@ -4,18 +4,38 @@
 
 #pragma once
 
+#include "ShellBrowser/FolderSettings.h"
+#include "ShellBrowser/FolderViewState.h"
+#include "ShellBrowser/PreservedHistoryEntry.h"
 #include "../Helper/Macros.h"
+#include "../Helper/ShellHelper.h"
 #include <boost/signals2.hpp>
+#include <memory>
 #include <optional>
+#include <vector>
 
 class FileActionHandler;
-struct FolderColumns;
-struct FolderSettings;
 __interface IExplorerplusplus;
 struct PreservedTab;
 class ShellBrowser;
 __interface TabNavigationInterface;
 
+// The state held by a tab that hasn't been loaded yet. This is enough to
+// display the tab and save it, without creating a ShellBrowser.
+struct UnloadedTabState
+{
+	unique_pidl_absolute pidlDirectory;
+	FolderSettings folderSettings;
+	std::optional<FolderColumns> initialColumns;
+
+	// These are only set for a tab that was previously loaded and has been
+	// hibernated. In that case, pidlDirectory is the directory of the current
+	// history entry.
+	std::vector<std::unique_ptr<PreservedHistoryEntry>> history;
+	int currentEntry = 0;
+	std::optional<FolderViewState> viewState;
+};
+
 class Tab
 {
 public:
@@ -34,17 +54,52 @@ public:
 
 	typedef boost::signals2::signal<void(const Tab &tab, PropertyType propertyType)>
 		TabUpdatedSignal;
+	typedef boost::signals2::signal<void(
+		const Tab &tab, PCIDLIST_ABSOLUTE pidlDirectory, bool addHistoryEntry)>
+		TabLoadedSignal;
 
 	Tab(IExplorerplusplus *expp, TabNavigationInterface *tabNavigation,
 		FileActionHandler *fileActionHandler, const FolderSettings *folderSettings,
 		std::optional<FolderColumns> initialColumns);
 	Tab(const PreservedTab &preservedTab, IExplorerplusplus *expp,
 		TabNavigationInterface *tabNavigation, FileActionHandler *fileActionHandler);
+	Tab(UnloadedTabState unloadedState, IExplorerplusplus *expp,
+		TabNavigationInterface *tabNavigation, FileActionHandler *fileActionHandler);
 
 	int GetId() const;
 
+	// A tab created from an UnloadedTabState has no ShellBrowser until it's
+	// loaded, at which point it navigates to its directory. The selected tab is
+	// always loaded.
+	bool IsLoaded() const;
+	void EnsureLoaded();
+
+	// Loads the tab, if necessary.
+	ShellBrowser *GetShellBrowser();
+
+	// Never loads the tab, so this can only be called if the tab is known to
+	// be loaded (e.g. because it's selected). Code that runs over every tab
+	// should check IsLoaded() first.
 	ShellBrowser *GetShellBrowser() const;
 
+	// Destroys the ShellBrowser, retaining the tab's history, as well as the
+	// selection and scroll position in the current folder. These will be
+	// restored once the tab is next loaded. The caller is responsible for
+	// stopping any directory monitoring for the tab beforehand.
+	void Unload();
+
+	// For a hibernated tab, these return the history that will be restored
+	// once the tab is next loaded. A tab that has never been loaded has no
+	// preserved history. These should only be called if the tab isn't loaded.
+	const std::vector<std::unique_ptr<PreservedHistoryEntry>> &GetPreservedHistory() const;
+	int GetPreservedCurrentEntry() const;
+
+	// These don't require the tab to be loaded.
+	unique_pidl_absolute GetDirectoryIdl() const;
+	std::wstring GetDirectory() const;
+	FolderSettings GetFolderSettings() const;
+	FolderColumns GetFolderColumns() const;
+
 	std::wstring GetName() const;
 	bool GetUseCustomName() const;
 	void SetCustomName(const std::wstring &name);
@@ -55,6 +110,12 @@ public:
 
 	boost::signals2::connection AddTabUpdatedObserver(const TabUpdatedSignal::slot_type &observer);
 
+	// Called once the ShellBrowser for an unloaded tab has been created. The
+	// observer is responsible for navigating to the directory that's passed
+	// in. If the tab was hibernated, its history will already have been
+	// restored, in which case addHistoryEntry will be false.
+	boost::signals2::connection AddTabLoadedObserver(const TabLoadedSignal::slot_type &observer);
+
 	/* Although each tab manages its
 	own columns, it does not know
 	about any column defaults.
@@ -65,14 +126,23 @@ public:
 private:
 	DISALLOW_COPY_AND_ASSIGN(Tab);
 
+	void Load();
+	void UpdateNavigationMode();
+
 	static int idCounter;
 	const int m_id;
 
+	IExplorerplusplus *m_expp;
+	TabNavigationInterface *m_tabNavigation;
+	FileActionHandler *m_fileActionHandler;
+
 	ShellBrowser *m_shellBrowser;
+	std::unique_ptr<UnloadedTabState> m_unloadedState;
 
 	bool m_useCustomName;
 	std::wstring m_customName;
 	LockState m_lockState;
 
 	TabUpdatedSignal m_tabUpdatedSignal;
+	TabLoadedSignal m_tabLoadedSignal;
 };
\ No newline at end of file
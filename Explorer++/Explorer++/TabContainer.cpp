@@ -64,7 +64,7 @@ TabContainer::TabContainer(HWND parent, TabNavigationInterface *tabNavigation,
 	m_config(config),
 	m_bTabBeenDragged(FALSE),
 	m_iPreviousTabSelectionId(-1),
-	m_iconFetcher(m_hwnd, cachedIcons),
+	m_iconFetcher(m_hwnd, expp->GetIconResolutionService()),
 	m_defaultFolderIconSystemImageListIndex(GetDefaultFolderIconIndex())
 {
 	Initialize(parent);
@@ -486,7 +486,7 @@ void TabContainer::ProcessTabCommand(UINT uMenuID, Tab &tab)
 
 void TabContainer::OnOpenParentInNewTab(const Tab &tab)
 {
-	auto pidlCurrent = tab.GetShellBrowser()->GetDirectoryIdl();
+	auto pidlCurrent = tab.GetDirectoryIdl();
 
 	PIDLIST_ABSOLUTE pidlParent = nullptr;
 	HRESULT hr = GetVirtualParentPath(pidlCurrent.get(), &pidlParent);
@@ -507,6 +507,11 @@ void TabContainer::OnRefreshAllTabs()
 {
 	for (auto &tab : GetAllTabs() | boost::adaptors::map_values)
 	{
+		if (!tab->IsLoaded())
+		{
+			continue;
+		}
+
 		tab->GetShellBrowser()->GetNavigationController()->Refresh();
 	}
 }
@@ -610,8 +615,12 @@ LRESULT CALLBACK TabContainer::ParentWndProc(HWND hwnd, UINT uMsg, WPARAM wParam
 			break;
 
 		case TCN_SELCHANGE:
-			tabSelectedSignal.m_signal(GetSelectedTab());
-			break;
+		{
+			Tab &selectedTab = GetSelectedTab();
+			selectedTab.EnsureLoaded();
+			tabSelectedSignal.m_signal(selectedTab);
+		}
+		break;
 		}
 		break;
 	}
@@ -683,7 +692,7 @@ void TabContainer::OnGetDispInfo(NMTTDISPINFO *dispInfo)
 
 	const Tab &tab = GetTabByIndex(static_cast<int>(dispInfo->hdr.idFrom));
 
-	auto pidlDirectory = tab.GetShellBrowser()->GetDirectoryIdl();
+	auto pidlDirectory = tab.GetDirectoryIdl();
 	auto path = GetFolderPathForDisplay(pidlDirectory.get());
 
 	if (!path)
@@ -792,22 +801,32 @@ void TabContainer::SetTabIcon(const Tab &tab)
 	}
 	else
 	{
-		auto itr = m_cachedIcons->findByPath(tab.GetShellBrowser()->GetDirectory());
+		auto cachedIconIndex =
+			m_cachedIcons->findByPath(tab.GetDirectory(), CachedIcons::ItemType::Folder);
 
-		if (itr != m_cachedIcons->end())
+		if (cachedIconIndex)
 		{
-			SetTabIconFromSystemImageList(tab, itr->iconIndex);
+			SetTabIconFromSystemImageList(tab, *cachedIconIndex);
 		}
 		else
 		{
 			SetTabIconFromImageList(tab, m_defaultFolderIconIndex);
 		}
 
-		auto pidlDirectory = tab.GetShellBrowser()->GetDirectoryIdl();
+		auto pidlDirectory = tab.GetDirectoryIdl();
+
+		// An unloaded tab is still in its original directory, so there's no
+		// folder ID to compare against. If the tab has since been loaded, its
+		// icon will be updated again once the navigation completes.
+		std::optional<int> folderId;
+
+		if (tab.IsLoaded())
+		{
+			folderId = tab.GetShellBrowser()->GetUniqueFolderId();
+		}
 
 		m_iconFetcher.QueueIconTask(pidlDirectory.get(),
-			[this, tabId = tab.GetId(), folderId = tab.GetShellBrowser()->GetUniqueFolderId()](
-				int iconIndex) {
+			[this, tabId = tab.GetId(), folderId](int iconIndex) {
 				auto tab = GetTabOptional(tabId);
 
 				if (!tab)
@@ -815,7 +834,8 @@ void TabContainer::SetTabIcon(const Tab &tab)
 					return;
 				}
 
-				if (tab->GetShellBrowser()->GetUniqueFolderId() != folderId)
+				if (tab->IsLoaded()
+					&& (!folderId || tab->GetShellBrowser()->GetUniqueFolderId() != *folderId))
 				{
 					return;
 				}
@@ -940,8 +960,25 @@ HRESULT TabContainer::CreateNewTab(PCIDLIST_ABSOLUTE pidlDirectory, const TabSet
 		return E_FAIL;
 	}
 
-	auto tabTemp = std::make_unique<Tab>(
-		m_expp, m_tabNavigation, m_fileActionHandler, folderSettings, initialColumns);
+	std::unique_ptr<Tab> tabTemp;
+
+	if (tabSettings.deferLoad && *tabSettings.deferLoad)
+	{
+		UnloadedTabState unloadedState;
+		unloadedState.pidlDirectory.reset(ILCloneFull(pidlDirectory));
+		unloadedState.folderSettings =
+			folderSettings ? *folderSettings : m_config->defaultFolderSettings;
+		unloadedState.initialColumns = initialColumns;
+
+		tabTemp = std::make_unique<Tab>(
+			std::move(unloadedState), m_expp, m_tabNavigation, m_fileActionHandler);
+	}
+	else
+	{
+		tabTemp = std::make_unique<Tab>(
+			m_expp, m_tabNavigation, m_fileActionHandler, folderSettings, initialColumns);
+	}
+
 	auto item = m_tabs.insert({ tabTemp->GetId(), std::move(tabTemp) });
 
 	Tab &tab = *item.first->second;
@@ -992,13 +1029,6 @@ HRESULT TabContainer::SetUpNewTab(Tab &tab, PCIDLIST_ABSOLUTE pidlDirectory,
 	the folder). */
 	InsertNewTab(index, tab.GetId(), pidlDirectory, tabSettings.name);
 
-	// Note that for the listview window to be shown, it has to have a non-zero
-	// size. If the size is zero at the point it's shown, it will instead remain
-	// hidden, even if it's later resized. Currently, if the tab is selected,
-	// the listview is shown during the OnTabSelected() call below. Therefore,
-	// the listview needs to have a non-zero size before that point.
-	m_expp->SetListViewInitialPosition(tab.GetShellBrowser()->GetListView());
-
 	bool selected = false;
 
 	if (tabSettings.selected)
@@ -1006,41 +1036,50 @@ HRESULT TabContainer::SetUpNewTab(Tab &tab, PCIDLIST_ABSOLUTE pidlDirectory,
 		selected = *tabSettings.selected;
 	}
 
-	// Capturing the tab by reference here is safe, since the tab object is
-	// guaranteed to exist whenever this method is called.
-	tab.GetShellBrowser()->AddNavigationCompletedObserver(
-		[this, &tab](PCIDLIST_ABSOLUTE pidlDirectory, bool addHistoryEntry) {
-			UNREFERENCED_PARAMETER(pidlDirectory);
-			UNREFERENCED_PARAMETER(addHistoryEntry);
+	// Tabs that are created unloaded will be set up once they're first used.
+	// Loaded tabs may also be hibernated later on, in which case they'll be
+	// set up again when they're reloaded. Capturing the tab by reference here
+	// is safe, for the same reason as in SetUpShellBrowser().
+	tab.AddTabLoadedObserver([this, &tab](const Tab &loadedTab, PCIDLIST_ABSOLUTE pidlDirectory,
+								 bool addHistoryEntry) {
+		UNREFERENCED_PARAMETER(loadedTab);
 
-			// Re-broadcast the event. This allows other classes to be notified of
-			// navigations in any tab, without having to observe navigation events
-			// for each tab individually.
-			tabNavigationCompletedSignal.m_signal(tab);
-		});
-
-	tab.GetShellBrowser()->listViewSelectionChanged.AddObserver([this, &tab]() {
-		tabListViewSelectionChanged.m_signal(tab);
+		SetUpShellBrowser(tab, pidlDirectory, addHistoryEntry);
 	});
 
-	tab.GetShellBrowser()->columnsChanged.AddObserver([this, &tab]() {
-		tabColumnsChanged.m_signal(tab);
-	});
-
-	HRESULT hr = tab.GetShellBrowser()->GetNavigationController()->BrowseFolder(
-		pidlDirectory, addHistoryEntry);
+	if (tab.IsLoaded())
+	{
+		HRESULT hr = SetUpShellBrowser(tab, pidlDirectory, addHistoryEntry);
 
-	if (hr != S_OK)
+		if (hr != S_OK)
+		{
+			/* Folder was not browsed. Likely that the path does not exist
+			(or is locked, cannot be found, etc). */
+			return E_FAIL;
+		}
+	}
+	else
 	{
-		/* Folder was not browsed. Likely that the path does not exist
-		(or is locked, cannot be found, etc). */
-		return E_FAIL;
+		// Normally, the icon is set once the tab has finished navigating.
+		SetTabIcon(tab);
+
+		// The tab control should always have a selected item. Setting the
+		// selection directly (rather than broadcasting it) means the tab won't
+		// be loaded here.
+		if (!selected && TabCtrl_GetCurSel(m_hwnd) == -1)
+		{
+			TabCtrl_SetCurSel(m_hwnd, index);
+		}
 	}
 
 	if (selected)
 	{
 		int previousIndex = TabCtrl_SetCurSel(m_hwnd, index);
 
+		// Observers of the selection only have const access to the tab, so it
+		// needs to be loaded before it's selected.
+		tab.EnsureLoaded();
+
 		if (previousIndex != -1)
 		{
 			tabSelectedSignal.m_signal(tab);
@@ -1063,6 +1102,53 @@ HRESULT TabContainer::SetUpNewTab(Tab &tab, PCIDLIST_ABSOLUTE pidlDirectory,
 	return S_OK;
 }
 
+HRESULT TabContainer::SetUpShellBrowser(
+	Tab &tab, PCIDLIST_ABSOLUTE pidlDirectory, bool addHistoryEntry)
+{
+	// Note that for the listview window to be shown, it has to have a non-zero
+	// size. If the size is zero at the point it's shown, it will instead remain
+	// hidden, even if it's later resized. Currently, if the tab is selected,
+	// the listview is shown during the OnTabSelected() call that follows this
+	// method. Therefore, the listview needs to have a non-zero size before
+	// that point.
+	m_expp->SetListViewInitialPosition(tab.GetShellBrowser()->GetListView());
+
+	// Capturing the tab by reference here is safe, since the tab object is
+	// guaranteed to exist whenever this method is called.
+	tab.GetShellBrowser()->AddNavigationCompletedObserver(
+		[this, &tab](PCIDLIST_ABSOLUTE pidlDirectory, bool addHistoryEntry) {
+			UNREFERENCED_PARAMETER(pidlDirectory);
+			UNREFERENCED_PARAMETER(addHistoryEntry);
+
+			// Re-broadcast the event. This allows other classes to be notified of
+			// navigations in any tab, without having to observe navigation events
+			// for each tab individually.
+			tabNavigationCompletedSignal.m_signal(tab);
+		});
+
+	tab.GetShellBrowser()->listViewSelectionChanged.AddObserver([this, &tab]() {
+		tabListViewSelectionChanged.m_signal(tab);
+	});
+
+	tab.GetShellBrowser()->columnsChanged.AddObserver([this, &tab]() {
+		tabColumnsChanged.m_signal(tab);
+	});
+
+	tabLoadedSignal.m_signal(tab);
+
+	auto *navigationController = tab.GetShellBrowser()->GetNavigationController();
+
+	// If the tab's history has been restored (e.g. because the tab was
+	// hibernated), returning to the current entry allows a cached listing of
+	// the folder to be shown.
+	if (!addHistoryEntry && navigationController->GetCurrentEntry())
+	{
+		return navigationController->GoToOffset(0);
+	}
+
+	return navigationController->BrowseFolder(pidlDirectory, addHistoryEntry);
+}
+
 void TabContainer::InsertNewTab(
 	int index, int tabId, PCIDLIST_ABSOLUTE pidlDirectory, std::optional<std::wstring> customName)
 {
@@ -1110,9 +1196,13 @@ bool TabContainer::CloseTab(const Tab &tab)
 
 	RemoveTabFromControl(tab);
 
-	m_expp->GetDirectoryMonitor()->StopDirectoryMonitor(tab.GetShellBrowser()->GetDirMonitorId());
+	if (tab.IsLoaded())
+	{
+		m_expp->GetDirectoryMonitor()->StopDirectoryMonitor(
+			tab.GetShellBrowser()->GetDirMonitorId());
 
-	tab.GetShellBrowser()->Release();
+		tab.GetShellBrowser()->Release();
+	}
 
 	// This is needed, as the erase() call below will remove the element
 	// from the tabs container (which will invalidate the reference
@@ -1126,6 +1216,20 @@ bool TabContainer::CloseTab(const Tab &tab)
 	return true;
 }
 
+bool TabContainer::HibernateTab(Tab &tab)
+{
+	if (!tab.IsLoaded() || IsTabSelected(tab))
+	{
+		return false;
+	}
+
+	m_expp->GetDirectoryMonitor()->StopDirectoryMonitor(tab.GetShellBrowser()->GetDirMonitorId());
+
+	tab.Unload();
+
+	return true;
+}
+
 void TabContainer::RemoveTabFromControl(const Tab &tab)
 {
 	m_tabSelectionHistory.erase(
@@ -1247,12 +1351,15 @@ void TabContainer::SelectTabAtIndex(int index)
 
 	int previousIndex = TabCtrl_SetCurSel(m_hwnd, index);
 
+	Tab &tab = GetTabByIndex(index);
+	tab.EnsureLoaded();
+
 	if (previousIndex == -1)
 	{
 		return;
 	}
 
-	tabSelectedSignal.m_signal(GetTabByIndex(index));
+	tabSelectedSignal.m_signal(tab);
 }
 
 Tab &TabContainer::GetSelectedTab()
@@ -1364,6 +1471,6 @@ std::vector<std::reference_wrapper<const Tab>> TabContainer::GetAllTabsInOrder()
 
 void TabContainer::DuplicateTab(const Tab &tab)
 {
-	std::wstring currentDirectory = tab.GetShellBrowser()->GetDirectory();
+	std::wstring currentDirectory = tab.GetDirectory();
 	CreateNewTab(currentDirectory.c_str());
 }
\ No newline at end of file
@@ -31,6 +31,7 @@ BOOST_PARAMETER_NAME(name)
 BOOST_PARAMETER_NAME(index)
 BOOST_PARAMETER_NAME(selected)
 BOOST_PARAMETER_NAME(lockState)
+BOOST_PARAMETER_NAME(deferLoad)
 
 // The use of Boost Parameter here allows values to be set by name
 // during construction. It would be better (and simpler) for this to be
@@ -45,12 +46,18 @@ struct TabSettingsImpl
 		lockState = args[_lockState | std::nullopt];
 		index = args[_index | std::nullopt];
 		selected = args[_selected | std::nullopt];
+		deferLoad = args[_deferLoad | std::nullopt];
 	}
 
 	std::optional<std::wstring> name;
 	std::optional<Tab::LockState> lockState;
 	std::optional<int> index;
 	std::optional<bool> selected;
+
+	// If set, the tab will only hold its directory and folder settings until
+	// it's first selected (or otherwise used). The folder won't be enumerated
+	// before then.
+	std::optional<bool> deferLoad;
 };
 
 // Used when creating a tab.
@@ -66,6 +73,7 @@ struct TabSettings : TabSettingsImpl
 			(lockState, (Tab::LockState))
 			(index, (int))
 			(selected, (bool))
+			(deferLoad, (bool))
 		)
 	)
 	// clang-format on
@@ -102,6 +110,11 @@ public:
 	void DuplicateTab(const Tab &tab);
 	bool CloseTab(const Tab &tab);
 
+	// Unloads the tab, in order to free the resources used by its folder. The
+	// tab will be reloaded (with its previous state) the next time it's used.
+	// The selected tab can't be hibernated.
+	bool HibernateTab(Tab &tab);
+
 	// Eventually, this should be removed.
 	std::unordered_map<int, std::unique_ptr<Tab>> &GetTabs();
 
@@ -112,6 +125,11 @@ public:
 
 	// Signals
 	SignalWrapper<TabContainer, void(int tabId, BOOL switchToNewTab)> tabCreatedSignal;
+
+	// Triggered when a tab's ShellBrowser is created. For most tabs, that
+	// happens during creation, but tabs created with deferLoad set will only
+	// trigger this once they're loaded.
+	SignalWrapper<TabContainer, void(const Tab &tab)> tabLoadedSignal;
 	SignalWrapper<TabContainer, void(const Tab &tab)> tabNavigationCompletedSignal;
 	SignalWrapper<TabContainer, void(const Tab &tab, Tab::PropertyType propertyType)>
 		tabUpdatedSignal;
@@ -150,6 +168,7 @@ private:
 
 	HRESULT SetUpNewTab(Tab &tab, PCIDLIST_ABSOLUTE pidlDirectory, const TabSettings &tabSettings,
 		bool addHistoryEntry, int *newTabId);
+	HRESULT SetUpShellBrowser(Tab &tab, PCIDLIST_ABSOLUTE pidlDirectory, bool addHistoryEntry);
 
 	void OnTabCtrlLButtonDown(POINT *pt);
 	void OnTabCtrlLButtonUp();
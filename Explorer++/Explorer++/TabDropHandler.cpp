@@ -196,7 +196,9 @@ DWORD TabDropHandler::DetermineCurrentDragEffect(
 
 	if (iTab != -1)
 	{
-		const Tab &tab = m_tabContainer->GetTabByIndex(iTab);
+		// Checking whether items can be created in the tab's folder requires
+		// the tab to be loaded.
+		Tab &tab = m_tabContainer->GetTabByIndex(iTab);
 
 		if (tab.GetShellBrowser()->CanCreate())
 		{
@@ -264,7 +266,7 @@ HRESULT __stdcall TabDropHandler::Drop(
 	{
 		const Tab &tab = m_tabContainer->GetTabByIndex(iTab);
 
-		std::wstring destDirectory = tab.GetShellBrowser()->GetDirectory();
+		std::wstring destDirectory = tab.GetDirectory();
 
 		DropHandler *pDropHandler = DropHandler::CreateNew();
 		pDropHandler->Drop(pDataObject, grfKeyState, pt, pdwEffect, m_hTabCtrl, m_DragType,
@@ -26,8 +26,8 @@ void Explorerplusplus::InitializeTabs()
 
 	m_tabContainer = TabContainer::Create(m_hTabBacking, this, this, &m_FileActionHandler,
 		&m_cachedIcons, &m_bookmarkTree, m_hLanguageModule, m_config);
-	m_tabContainer->tabCreatedSignal.AddObserver(
-		boost::bind(&Explorerplusplus::OnTabCreated, this, _1, _2), boost::signals2::at_front);
+	m_tabContainer->tabLoadedSignal.AddObserver(
+		boost::bind(&Explorerplusplus::OnTabLoaded, this, _1), boost::signals2::at_front);
 	m_tabContainer->tabNavigationCompletedSignal.AddObserver(
 		boost::bind(&Explorerplusplus::OnNavigationCompleted, this, _1), boost::signals2::at_front);
 	m_tabContainer->tabSelectedSignal.AddObserver(
@@ -49,12 +49,8 @@ void Explorerplusplus::InitializeTabs()
 	m_tabsInitializedSignal();
 }
 
-void Explorerplusplus::OnTabCreated(int tabId, BOOL switchToNewTab)
+void Explorerplusplus::OnTabLoaded(const Tab &tab)
 {
-	UNREFERENCED_PARAMETER(switchToNewTab);
-
-	const Tab &tab = m_tabContainer->GetTab(tabId);
-
 	/* TODO: This subclass needs to be removed. */
 	SetWindowSubclass(tab.GetShellBrowser()->GetListView(), ListViewProcStub, 0,
 		reinterpret_cast<DWORD_PTR>(this));
@@ -0,0 +1,46 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "TabHibernationPolicy.h"
+#include <algorithm>
+
+std::vector<int> SelectTabsToHibernate(std::vector<TabHibernationCandidate> candidates,
+	size_t otherMemoryUsage, const TabHibernationLimits &limits,
+	std::chrono::steady_clock::time_point now)
+{
+	std::sort(candidates.begin(), candidates.end(),
+		[](const TabHibernationCandidate &candidate1, const TabHibernationCandidate &candidate2) {
+			return candidate1.lastActiveTime < candidate2.lastActiveTime;
+		});
+
+	size_t totalMemoryUsage = otherMemoryUsage;
+
+	for (const auto &candidate : candidates)
+	{
+		totalMemoryUsage += candidate.memoryUsage;
+	}
+
+	std::vector<int> tabIds;
+
+	for (const auto &candidate : candidates)
+	{
+		bool idle = limits.idleTimeout.count() > 0
+			&& (now - candidate.lastActiveTime) >= limits.idleTimeout;
+		bool overBudget = limits.memoryBudget > 0 && totalMemoryUsage > limits.memoryBudget;
+
+		// Since the candidates are processed in order of activity, once a
+		// tab is found that doesn't need to be hibernated, none of the
+		// remaining tabs will need to be either.
+		if (!idle && !overBudget)
+		{
+			break;
+		}
+
+		tabIds.push_back(candidate.tabId);
+		totalMemoryUsage -= candidate.memoryUsage;
+	}
+
+	return tabIds;
+}
\ No newline at end of file
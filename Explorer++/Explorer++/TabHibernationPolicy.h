@@ -0,0 +1,40 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+struct TabHibernationCandidate
+{
+	int tabId;
+
+	// The last time the tab was selected.
+	std::chrono::steady_clock::time_point lastActiveTime;
+
+	size_t memoryUsage;
+};
+
+struct TabHibernationLimits
+{
+	// Tabs that haven't been active for at least this long will be
+	// hibernated. A value of 0 means tabs won't be hibernated because they're
+	// idle.
+	std::chrono::minutes idleTimeout;
+
+	// If the total memory used by all loaded tabs exceeds this value, the
+	// least recently active tabs will be hibernated until the usage is back
+	// within the budget. A value of 0 means there's no budget.
+	size_t memoryBudget;
+};
+
+// Returns the IDs of the tabs that should be hibernated, with the least
+// recently active tab first. The candidates should only include tabs that
+// are able to be hibernated. The memory used by any other loaded tabs (e.g.
+// the selected tab) should be passed in separately, since it still counts
+// towards the budget.
+std::vector<int> SelectTabsToHibernate(std::vector<TabHibernationCandidate> candidates,
+	size_t otherMemoryUsage, const TabHibernationLimits &limits,
+	std::chrono::steady_clock::time_point now);
\ No newline at end of file
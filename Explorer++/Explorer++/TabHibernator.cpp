@@ -0,0 +1,118 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "TabHibernator.h"
+#include "Config.h"
+#include "ShellBrowser/ShellBrowser.h"
+#include "Tab.h"
+#include "TabContainer.h"
+#include "TabHibernationPolicy.h"
+#include <boost/range/adaptor/map.hpp>
+
+TabHibernator::TabHibernator(TabContainer *tabContainer, std::shared_ptr<const Config> config) :
+	m_tabContainer(tabContainer),
+	m_config(config)
+{
+	// Any tabs that already exist are treated as having just been used.
+	auto now = std::chrono::steady_clock::now();
+
+	for (const auto &tab : m_tabContainer->GetAllTabs() | boost::adaptors::map_values)
+	{
+		m_lastActiveTimes[tab->GetId()] = now;
+	}
+
+	m_selectedTabId = m_tabContainer->GetSelectedTab().GetId();
+
+	m_connections.push_back(m_tabContainer->tabCreatedSignal.AddObserver(
+		boost::bind(&TabHibernator::OnTabCreated, this, _1, _2)));
+	m_connections.push_back(m_tabContainer->tabSelectedSignal.AddObserver(
+		boost::bind(&TabHibernator::OnTabSelected, this, _1)));
+	m_connections.push_back(m_tabContainer->tabRemovedSignal.AddObserver(
+		boost::bind(&TabHibernator::OnTabRemoved, this, _1)));
+}
+
+bool TabHibernator::IsEnabled() const
+{
+	return m_config->tabHibernationIdleTimeout > 0 || m_config->tabHibernationMemoryBudget > 0;
+}
+
+void TabHibernator::OnTabCreated(int tabId, BOOL switchToNewTab)
+{
+	UNREFERENCED_PARAMETER(switchToNewTab);
+
+	m_lastActiveTimes[tabId] = std::chrono::steady_clock::now();
+}
+
+void TabHibernator::OnTabSelected(const Tab &tab)
+{
+	auto now = std::chrono::steady_clock::now();
+
+	// A tab stops being active at the point it's deselected.
+	if (m_selectedTabId)
+	{
+		auto itr = m_lastActiveTimes.find(*m_selectedTabId);
+
+		if (itr != m_lastActiveTimes.end())
+		{
+			itr->second = now;
+		}
+	}
+
+	m_lastActiveTimes[tab.GetId()] = now;
+	m_selectedTabId = tab.GetId();
+}
+
+void TabHibernator::OnTabRemoved(int tabId)
+{
+	m_lastActiveTimes.erase(tabId);
+
+	if (m_selectedTabId == tabId)
+	{
+		m_selectedTabId.reset();
+	}
+}
+
+void TabHibernator::HibernateTabs()
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	auto now = std::chrono::steady_clock::now();
+
+	std::vector<TabHibernationCandidate> candidates;
+	size_t otherMemoryUsage = 0;
+
+	for (const auto &tab : m_tabContainer->GetAllTabs() | boost::adaptors::map_values)
+	{
+		if (!tab->IsLoaded())
+		{
+			continue;
+		}
+
+		size_t memoryUsage = tab->GetShellBrowser()->GetMemoryUsage();
+
+		if (m_tabContainer->IsTabSelected(*tab))
+		{
+			otherMemoryUsage += memoryUsage;
+			continue;
+		}
+
+		auto itr = m_lastActiveTimes.find(tab->GetId());
+		auto lastActiveTime = (itr != m_lastActiveTimes.end()) ? itr->second : now;
+
+		candidates.push_back({ tab->GetId(), lastActiveTime, memoryUsage });
+	}
+
+	TabHibernationLimits limits;
+	limits.idleTimeout = std::chrono::minutes(m_config->tabHibernationIdleTimeout);
+	limits.memoryBudget = static_cast<size_t>(m_config->tabHibernationMemoryBudget) * 1024 * 1024;
+
+	for (int tabId : SelectTabsToHibernate(candidates, otherMemoryUsage, limits, now))
+	{
+		m_tabContainer->HibernateTab(m_tabContainer->GetTab(tabId));
+	}
+}
\ No newline at end of file
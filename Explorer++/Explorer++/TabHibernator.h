@@ -0,0 +1,45 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <boost/signals2.hpp>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+struct Config;
+class Tab;
+class TabContainer;
+
+// Hibernates background tabs that have been idle for a while, or that are
+// using more memory than the configured budget allows. A hibernated tab is
+// reloaded (with its history, selection and scroll position) the next time
+// it's selected.
+class TabHibernator
+{
+public:
+	TabHibernator(TabContainer *tabContainer, std::shared_ptr<const Config> config);
+
+	bool IsEnabled() const;
+
+	// This should be called periodically. Each call will hibernate whichever
+	// tabs are currently eligible, or do nothing if hibernation is disabled.
+	void HibernateTabs();
+
+private:
+	void OnTabCreated(int tabId, BOOL switchToNewTab);
+	void OnTabSelected(const Tab &tab);
+	void OnTabRemoved(int tabId);
+
+	TabContainer *m_tabContainer;
+	std::shared_ptr<const Config> m_config;
+
+	std::unordered_map<int, std::chrono::steady_clock::time_point> m_lastActiveTimes;
+	std::optional<int> m_selectedTabId;
+
+	std::vector<boost::signals2::scoped_connection> m_connections;
+};
\ No newline at end of file
@@ -14,6 +14,8 @@
 #include "Explorer++_internal.h"
 #include "MainResource.h"
 #include "ResourceHelper.h"
+#include "ShellBrowser/FolderListing.h"
+#include "ShellBrowser/FolderListingCache.h"
 #include "ShellBrowser/ShellBrowser.h"
 #include "TabContainer.h"
 #include "../Helper/Macros.h"
@@ -323,7 +325,10 @@ LRESULT CALLBACK TaskbarThumbnails::TabProxyWndProc(
 		return 0;
 
 	case WM_SETFOCUS:
-		SetFocus(tab->GetShellBrowser()->GetListView());
+		if (tab->IsLoaded())
+		{
+			SetFocus(tab->GetShellBrowser()->GetListView());
+		}
 		break;
 
 	case WM_SYSCOMMAND:
@@ -333,7 +338,10 @@ LRESULT CALLBACK TaskbarThumbnails::TabProxyWndProc(
 			break;
 
 		default:
-			SendMessage(tab->GetShellBrowser()->GetListView(), WM_SYSCOMMAND, wParam, lParam);
+			if (tab->IsLoaded())
+			{
+				SendMessage(tab->GetShellBrowser()->GetListView(), WM_SYSCOMMAND, wParam, lParam);
+			}
 			break;
 		}
 		break;
@@ -347,7 +355,10 @@ LRESULT CALLBACK TaskbarThumbnails::TabProxyWndProc(
 	A thumbnail will be dynamically generated, provided the main window
 	is not currently minimized (as we won't be able to grab a screenshot
 	of it). If the main window is minimized, we'll use a cached screenshot
-	of the tab (taken before the main window was minimized). */
+	of the tab (taken before the main window was minimized).
+
+	Previews are generated without loading the tab. If the tab isn't loaded,
+	its directory (and any cached listing for it) is drawn instead. */
 	case WM_DWMSENDICONICTHUMBNAIL:
 		OnDwmSendIconicThumbnail(hwnd, *tab, HIWORD(lParam), LOWORD(lParam));
 		return 0;
@@ -362,10 +373,7 @@ LRESULT CALLBACK TaskbarThumbnails::TabProxyWndProc(
 		{
 			wil::unique_hbitmap bitmap = GetTabLivePreviewBitmap(*tab);
 
-			RECT rcTab;
-			GetClientRect(tab->GetShellBrowser()->GetListView(), &rcTab);
-			MapWindowPoints(tab->GetShellBrowser()->GetListView(), m_expp->GetMainWindow(),
-				reinterpret_cast<LPPOINT>(&rcTab), 2);
+			RECT rcTab = GetTabRect(*tab);
 
 			MENUBARINFO mbi;
 			mbi.cbSize = sizeof(mbi);
@@ -494,32 +502,16 @@ wil::unique_hbitmap TaskbarThumbnails::CaptureTabScreenshot(const Tab &tab)
 		SRCCOPY);
 
 	/* Now draw the tab onto the main window. */
-	RECT rcTab;
-	GetClientRect(tab.GetShellBrowser()->GetListView(), &rcTab);
+	RECT rcTab = GetTabRect(tab);
 
-	wil::unique_hdc_window hdcTab = wil::GetDC(tab.GetShellBrowser()->GetListView());
-	wil::unique_hdc hdcTabSrc(CreateCompatibleDC(hdcTab.get()));
+	wil::unique_hdc hdcTabSrc(CreateCompatibleDC(hdc.get()));
 	wil::unique_hbitmap hbmTab(
-		CreateCompatibleBitmap(hdcTab.get(), GetRectWidth(&rcTab), GetRectHeight(&rcTab)));
+		CreateCompatibleBitmap(hdc.get(), GetRectWidth(&rcTab), GetRectHeight(&rcTab)));
 
 	auto tabPreviousBitmap = wil::SelectObject(hdcTabSrc.get(), hbmTab.get());
 
-	BOOL bVisible = IsWindowVisible(tab.GetShellBrowser()->GetListView());
+	DrawTabContents(tab, hdcTabSrc.get(), GetRectWidth(&rcTab), GetRectHeight(&rcTab));
 
-	if (!bVisible)
-	{
-		ShowWindow(tab.GetShellBrowser()->GetListView(), SW_SHOW);
-	}
-
-	PrintWindow(tab.GetShellBrowser()->GetListView(), hdcTabSrc.get(), PW_CLIENTONLY);
-
-	if (!bVisible)
-	{
-		ShowWindow(tab.GetShellBrowser()->GetListView(), SW_HIDE);
-	}
-
-	MapWindowPoints(tab.GetShellBrowser()->GetListView(), m_expp->GetMainWindow(),
-		reinterpret_cast<LPPOINT>(&rcTab), 2);
 	BitBlt(hdcSrc.get(), rcTab.left, rcTab.top, GetRectWidth(&rcTab), GetRectHeight(&rcTab),
 		hdcTabSrc.get(), 0, 0, SRCCOPY);
 
@@ -548,11 +540,10 @@ wil::unique_hbitmap TaskbarThumbnails::CaptureTabScreenshot(const Tab &tab)
 
 wil::unique_hbitmap TaskbarThumbnails::GetTabLivePreviewBitmap(const Tab &tab)
 {
-	wil::unique_hdc_window hdcTab = wil::GetDC(tab.GetShellBrowser()->GetListView());
-	wil::unique_hdc hdcTabSrc(CreateCompatibleDC(hdcTab.get()));
+	wil::unique_hdc_window hdc = wil::GetDC(m_expp->GetMainWindow());
+	wil::unique_hdc hdcTabSrc(CreateCompatibleDC(hdc.get()));
 
-	RECT rcTab;
-	GetClientRect(tab.GetShellBrowser()->GetListView(), &rcTab);
+	RECT rcTab = GetTabRect(tab);
 
 	wil::unique_hbitmap hbmTab;
 	Gdiplus::Color color(0, 0, 0);
@@ -561,26 +552,113 @@ wil::unique_hbitmap TaskbarThumbnails::GetTabLivePreviewBitmap(const Tab &tab)
 
 	auto tabPreviousBitmap = wil::SelectObject(hdcTabSrc.get(), hbmTab.get());
 
-	BOOL bVisible = IsWindowVisible(tab.GetShellBrowser()->GetListView());
+	DrawTabContents(tab, hdcTabSrc.get(), GetRectWidth(&rcTab), GetRectHeight(&rcTab));
+
+	SetStretchBltMode(hdcTabSrc.get(), HALFTONE);
+	SetBrushOrgEx(hdcTabSrc.get(), 0, 0, nullptr);
+	StretchBlt(hdcTabSrc.get(), 0, 0, GetRectWidth(&rcTab), GetRectHeight(&rcTab), hdcTabSrc.get(),
+		0, 0, GetRectWidth(&rcTab), GetRectHeight(&rcTab), SRCCOPY);
+
+	return hbmTab;
+}
+
+/* Returns the area covered by the tab's listview, in main window
+coordinates. */
+RECT TaskbarThumbnails::GetTabRect(const Tab &tab)
+{
+	/* An unloaded tab has no listview. If it did, it would be in the same
+	position as the listview in the selected tab (which is always loaded). */
+	HWND listView = tab.IsLoaded()
+		? tab.GetShellBrowser()->GetListView()
+		: m_tabContainer->GetSelectedTab().GetShellBrowser()->GetListView();
+
+	RECT rcTab;
+	GetClientRect(listView, &rcTab);
+	MapWindowPoints(listView, m_expp->GetMainWindow(), reinterpret_cast<LPPOINT>(&rcTab), 2);
+
+	return rcTab;
+}
+
+void TaskbarThumbnails::DrawTabContents(const Tab &tab, HDC hdc, int width, int height)
+{
+	if (!tab.IsLoaded())
+	{
+		DrawUnloadedTabContents(tab, hdc, width, height);
+		return;
+	}
+
+	HWND listView = tab.GetShellBrowser()->GetListView();
+	BOOL bVisible = IsWindowVisible(listView);
 
 	if (!bVisible)
 	{
-		ShowWindow(tab.GetShellBrowser()->GetListView(), SW_SHOW);
+		ShowWindow(listView, SW_SHOW);
 	}
 
-	PrintWindow(tab.GetShellBrowser()->GetListView(), hdcTabSrc.get(), PW_CLIENTONLY);
+	PrintWindow(listView, hdc, PW_CLIENTONLY);
 
 	if (!bVisible)
 	{
-		ShowWindow(tab.GetShellBrowser()->GetListView(), SW_HIDE);
+		ShowWindow(listView, SW_HIDE);
 	}
+}
 
-	SetStretchBltMode(hdcTabSrc.get(), HALFTONE);
-	SetBrushOrgEx(hdcTabSrc.get(), 0, 0, nullptr);
-	StretchBlt(hdcTabSrc.get(), 0, 0, GetRectWidth(&rcTab), GetRectHeight(&rcTab), hdcTabSrc.get(),
-		0, 0, GetRectWidth(&rcTab), GetRectHeight(&rcTab), SRCCOPY);
+/* Draws the icon and name of the tab's directory, followed by the names of
+the items in the directory, if a listing for it has been cached. */
+void TaskbarThumbnails::DrawUnloadedTabContents(const Tab &tab, HDC hdc, int width, int height)
+{
+	RECT rc = { 0, 0, width, height };
+	FillRect(hdc, &rc, GetSysColorBrush(COLOR_WINDOW));
 
-	return hbmTab;
+	auto pidlDirectory = tab.GetDirectoryIdl();
+	int iconSize = GetSystemMetrics(SM_CXICON);
+
+	SHFILEINFO shfi;
+	DWORD_PTR res = SHGetFileInfo((LPCTSTR) pidlDirectory.get(), 0, &shfi, sizeof(shfi),
+		SHGFI_PIDL | SHGFI_ICON | SHGFI_LARGEICON);
+
+	if (res)
+	{
+		wil::unique_hicon icon(shfi.hIcon);
+		DrawIconEx(hdc, UNLOADED_TAB_PREVIEW_MARGIN, UNLOADED_TAB_PREVIEW_MARGIN, icon.get(), 0,
+			0, 0, nullptr, DI_NORMAL);
+	}
+
+	auto previousFont = wil::SelectObject(hdc, GetStockObject(DEFAULT_GUI_FONT));
+	SetBkMode(hdc, TRANSPARENT);
+	SetTextColor(hdc, GetSysColor(COLOR_WINDOWTEXT));
+
+	RECT rcName = { iconSize + 2 * UNLOADED_TAB_PREVIEW_MARGIN, UNLOADED_TAB_PREVIEW_MARGIN,
+		width - UNLOADED_TAB_PREVIEW_MARGIN, iconSize + UNLOADED_TAB_PREVIEW_MARGIN };
+	DrawText(hdc, tab.GetName().c_str(), -1, &rcName,
+		DT_SINGLELINE | DT_VCENTER | DT_END_ELLIPSIS | DT_NOPREFIX);
+
+	auto listing = m_expp->GetFolderListingCache()->Find(pidlDirectory.get());
+
+	if (!listing)
+	{
+		return;
+	}
+
+	TEXTMETRIC tm;
+	GetTextMetrics(hdc, &tm);
+
+	int y = iconSize + 2 * UNLOADED_TAB_PREVIEW_MARGIN;
+
+	for (const auto &item : listing->items)
+	{
+		if (y + tm.tmHeight > height)
+		{
+			break;
+		}
+
+		RECT rcItem = { UNLOADED_TAB_PREVIEW_MARGIN, y, width - UNLOADED_TAB_PREVIEW_MARGIN,
+			y + tm.tmHeight };
+		DrawText(hdc, item.displayName.c_str(), -1, &rcItem,
+			DT_SINGLELINE | DT_END_ELLIPSIS | DT_NOPREFIX);
+
+		y += tm.tmHeight;
+	}
 }
 
 void TaskbarThumbnails::OnTabSelectionChanged(const Tab &tab)
@@ -655,7 +733,7 @@ void TaskbarThumbnails::SetTabProxyIcon(const Tab &tab)
 	{
 		if (tabProxyInfo.iTabId == tab.GetId())
 		{
-			auto pidlDirectory = tab.GetShellBrowser()->GetDirectoryIdl();
+			auto pidlDirectory = tab.GetDirectoryIdl();
 
 			/* TODO: The proxy icon may also be the lock icon, if
 			the tab is locked. */
@@ -21,6 +21,8 @@ public:
 private:
 	DISALLOW_COPY_AND_ASSIGN(TaskbarThumbnails);
 
+	static const int UNLOADED_TAB_PREVIEW_MARGIN = 8;
+
 	struct TabProxyInfo
 	{
 		ATOM atomClass;
@@ -49,6 +51,9 @@ private:
 	void OnDwmSendIconicThumbnail(HWND tabProxy, const Tab &tab, int maxWidth, int maxHeight);
 	wil::unique_hbitmap CaptureTabScreenshot(const Tab &tab);
 	wil::unique_hbitmap GetTabLivePreviewBitmap(const Tab &tab);
+	RECT GetTabRect(const Tab &tab);
+	void DrawTabContents(const Tab &tab, HDC hdc, int width, int height);
+	void DrawUnloadedTabContents(const Tab &tab, HDC hdc, int width, int height);
 	void OnTabSelectionChanged(const Tab &tab);
 	void OnNavigationCompleted(const Tab &tab);
 	void SetTabProxyIcon(const Tab &tab);
@@ -0,0 +1,75 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "Tracing.h"
+#include "../Helper/Logging.h"
+#include "../Helper/Macros.h"
+#include "../Helper/ProcessHelper.h"
+#include "../Helper/Tracing.h"
+#include <fstream>
+
+namespace
+{
+bool g_tracingEnabled = false;
+}
+
+void SetTracingEnabled(bool enabled)
+{
+	g_tracingEnabled = enabled;
+
+	TraceRecorder *recorder = g_traceRecorder.load(std::memory_order_acquire);
+
+	if (recorder)
+	{
+		recorder->SetEnabled(enabled);
+	}
+}
+
+void InitializeTracing()
+{
+	// The recorder is always created, so that tracing can be enabled later on
+	// (e.g. once the settings have been loaded). While it's disabled, the only
+	// cost to each trace point is checking whether it's enabled. As with the
+	// logger, the recorder is intentionally leaked, since events can be
+	// recorded right up until the process exits.
+	auto *recorder = new TraceRecorder();
+	recorder->SetEnabled(g_tracingEnabled);
+	recorder->SetCurrentThreadName("Main");
+	g_traceRecorder.store(recorder, std::memory_order_release);
+}
+
+void ShutdownTracing(const TCHAR *filename)
+{
+	TraceRecorder *recorder = g_traceRecorder.load(std::memory_order_acquire);
+
+	if (!recorder)
+	{
+		return;
+	}
+
+	// No further events are needed once the trace has been written.
+	recorder->SetEnabled(false);
+
+	if (recorder->GetStats().numRecorded == 0)
+	{
+		return;
+	}
+
+	TCHAR traceFile[MAX_PATH];
+	GetProcessImageName(GetCurrentProcessId(), traceFile, SIZEOF_ARRAY(traceFile));
+
+	PathRemoveFileSpec(traceFile);
+	PathAppend(traceFile, filename);
+
+	std::ofstream stream(traceFile, std::ios_base::out | std::ios_base::binary);
+
+	if (!stream.is_open())
+	{
+		LOG(warning) << L"Couldn't open the trace file " << traceFile;
+		return;
+	}
+
+	recorder->WriteChromeTrace(stream, GetCurrentProcessId());
+}
\ No newline at end of file
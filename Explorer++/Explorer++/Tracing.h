@@ -0,0 +1,15 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Tracing is disabled by default. It can be enabled or disabled at any point,
+// either before or after InitializeTracing() is called.
+void SetTracingEnabled(bool enabled);
+
+void InitializeTracing();
+
+// If any events were recorded, writes them to the specified file (in the
+// same directory as the executable) in the Chrome trace event format.
+void ShutdownTracing(const TCHAR *filename);
\ No newline at end of file
@@ -14,16 +14,12 @@ UiTheming::UiTheming(IExplorerplusplus *expp, TabContainer *tabContainer) :
 	m_tabContainer(tabContainer),
 	m_customListViewColorsApplied(false)
 {
-	m_connections.emplace_back(m_tabContainer->tabCreatedSignal.AddObserver(
-		boost::bind(&UiTheming::OnTabCreated, this, _1, _2)));
+	m_connections.emplace_back(m_tabContainer->tabLoadedSignal.AddObserver(
+		boost::bind(&UiTheming::OnTabLoaded, this, _1)));
 }
 
-void UiTheming::OnTabCreated(int tabId, BOOL switchToNewTab)
+void UiTheming::OnTabLoaded(const Tab &tab)
 {
-	UNREFERENCED_PARAMETER(switchToNewTab);
-
-	const Tab &tab = m_tabContainer->GetTab(tabId);
-
 	if (m_customListViewColorsApplied)
 	{
 		ApplyListViewColorsForTab(tab, m_listViewBackgroundColor, m_listViewTextColor);
@@ -47,6 +43,12 @@ bool UiTheming::ApplyListViewColorsForAllTabs(COLORREF backgroundColor, COLORREF
 
 	for (const auto &item : m_tabContainer->GetAllTabs())
 	{
+		// Colors will be applied to unloaded tabs once they're loaded.
+		if (!item.second->IsLoaded())
+		{
+			continue;
+		}
+
 		bool res = ApplyListViewColorsForTab(*item.second, backgroundColor, textColor);
 
 		if (!res)
@@ -19,7 +19,7 @@ public:
 	void SetTreeViewColors(COLORREF backgroundColor, COLORREF textColor);
 
 private:
-	void OnTabCreated(int tabId, BOOL switchToNewTab);
+	void OnTabLoaded(const Tab &tab);
 
 	bool ApplyListViewColorsForAllTabs(COLORREF backgroundColor, COLORREF textColor);
 	bool ApplyListViewColorsForTab(const Tab &tab, COLORREF backgroundColor, COLORREF textColor);
@@ -0,0 +1,44 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <memory>
+
+// Holds an immutable, reference-counted copy of a value. Background tasks
+// can capture the current snapshot (which is only a pointer copy) and will
+// continue to see that version of the data, even if a newer version is
+// published while the task is running. Publishing a new value never
+// modifies an existing snapshot; it simply swaps in a new one.
+template <typename T>
+class VersionedSnapshot
+{
+public:
+	using Snapshot = std::shared_ptr<const T>;
+
+	VersionedSnapshot() : m_snapshot(std::make_shared<const T>())
+	{
+	}
+
+	// As with ValueWrapper, this allows the parent Config struct to be
+	// copied. The copy will share the current snapshot.
+	VersionedSnapshot(const VersionedSnapshot &other) : m_snapshot(other.get())
+	{
+	}
+
+	VersionedSnapshot &operator=(const VersionedSnapshot &other) = delete;
+
+	Snapshot get() const
+	{
+		return std::atomic_load(&m_snapshot);
+	}
+
+	void publish(const T &value)
+	{
+		std::atomic_store(&m_snapshot, std::make_shared<const T>(value));
+	}
+
+private:
+	Snapshot m_snapshot;
+};
\ No newline at end of file
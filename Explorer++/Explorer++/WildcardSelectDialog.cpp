@@ -13,6 +13,7 @@
 #include "../Helper/Macros.h"
 #include "../Helper/RegistrySettings.h"
 #include "../Helper/XMLSettings.h"
+#include "../Helper/XmlStream.h"
 
 const TCHAR WildcardSelectDialogPersistentSettings::SETTINGS_KEY[] = _T("WildcardSelect");
 
@@ -199,23 +200,23 @@ void WildcardSelectDialogPersistentSettings::LoadExtraRegistrySettings(HKEY hKey
 		hKey, SETTING_CURRENT_TEXT, m_szPattern, SIZEOF_ARRAY(m_szPattern));
 }
 
-void WildcardSelectDialogPersistentSettings::SaveExtraXMLSettings(
-	IXMLDOMDocument *pXMLDom, IXMLDOMElement *pParentNode)
+void WildcardSelectDialogPersistentSettings::SaveExtraXMLSettings(XmlStreamWriter &writer)
 {
-	NXMLSettings::AddStringListToNode(pXMLDom, pParentNode, SETTING_PATTERN_LIST, m_PatternList);
-	NXMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_CURRENT_TEXT, m_szPattern);
+	NXMLSettings::AddStringListToNode(writer, SETTING_PATTERN_LIST, m_PatternList);
+	writer.WriteAttribute(SETTING_CURRENT_TEXT, m_szPattern);
 }
 
-void WildcardSelectDialogPersistentSettings::LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue)
+void WildcardSelectDialogPersistentSettings::LoadExtraXMLSettings(
+	const WCHAR *wszName, const WCHAR *wszValue)
 {
-	if (CompareString(LOCALE_INVARIANT, NORM_IGNORECASE, bstrName, lstrlen(SETTING_PATTERN_LIST),
+	if (CompareString(LOCALE_INVARIANT, NORM_IGNORECASE, wszName, lstrlen(SETTING_PATTERN_LIST),
 			SETTING_PATTERN_LIST, lstrlen(SETTING_PATTERN_LIST))
 		== CSTR_EQUAL)
 	{
-		m_PatternList.emplace_back(bstrValue);
+		m_PatternList.emplace_back(wszValue);
 	}
-	else if (lstrcmpi(bstrName, SETTING_CURRENT_TEXT) == 0)
+	else if (lstrcmpi(wszName, SETTING_CURRENT_TEXT) == 0)
 	{
-		StringCchCopy(m_szPattern, SIZEOF_ARRAY(m_szPattern), bstrValue);
+		StringCchCopy(m_szPattern, SIZEOF_ARRAY(m_szPattern), wszValue);
 	}
 }
\ No newline at end of file
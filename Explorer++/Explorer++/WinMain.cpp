@@ -15,6 +15,7 @@
 #include "MainResource.h"
 #include "ModelessDialogs.h"
 #include "RegistrySettings.h"
+#include "Tracing.h"
 #include "Version.h"
 #include "XMLSettings.h"
 #include "../Helper/Logging.h"
@@ -147,7 +148,7 @@ int WINAPI WinMain(HINSTANCE hInstance,HINSTANCE hPrevInstance,
 		false;
 #endif
 
-	boost::log::core::get()->set_logging_enabled(enableLogging);
+	SetLoggingEnabled(enableLogging);
 
 	/* Initialize OLE, as well as the various window classes that
 	will be needed (listview, TreeView, comboboxex, etc.). */
@@ -189,6 +190,16 @@ int WINAPI WinMain(HINSTANCE hInstance,HINSTANCE hPrevInstance,
 
 	InitializeLogging(NExplorerplusplus::LOG_FILENAME);
 
+	auto loggingCleanup = wil::scope_exit([] {
+		ShutdownLogging();
+	});
+
+	InitializeTracing();
+
+	auto tracingCleanup = wil::scope_exit([] {
+		ShutdownTracing(NExplorerplusplus::TRACE_FILENAME);
+	});
+
 	bool shouldExit = false;
 
 	/* Can't open folders that are children of the
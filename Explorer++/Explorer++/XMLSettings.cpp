@@ -24,10 +24,14 @@
 #include "ShellBrowser/Columns.h"
 #include "ShellBrowser/ShellBrowser.h"
 #include "TabContainer.h"
+#include "XMLSettings.h"
 #include "../Helper/Macros.h"
+#include "../Helper/PerfectHash.h"
 #include "../Helper/ProcessHelper.h"
 #include "../Helper/XMLSettings.h"
+#include "../Helper/XmlStream.h"
 #include <boost/range/adaptor/map.hpp>
+#include <fstream>
 
 #define COLUMN_TYPE_GENERIC			0
 #define COLUMN_TYPE_MYCOMPUTER		1
@@ -37,79 +41,169 @@
 #define COLUMN_TYPE_NETWORK			5
 #define COLUMN_TYPE_NETWORKPLACES	6
 
-/* These represent the pre-hashed values of attribute
-names. They are used to avoid string comparisons
-on each attribute. If the hash function or any of
-the attribute names change in any way, these values
-will need to be changed correspondingly. */
-#define HASH_ALWAYSOPENINNEWTAB		1123321600
-#define HASH_AUTOARRANGEGLOBAL		151507311
-#define HASH_CONFIRMCLOSETABS		2636757395
-#define HASH_DISPLAYCENTRECOLOR		3404143227
-#define HASH_DISPLAYFONT			362757714
-#define HASH_DISPLAYSURROUNDCOLOR	1807564604
-#define HASH_DISPLAYTEXTCOLOR		4212809823
-#define HASH_DISPLAYWINDOWWIDTH		3332824435
-#define HASH_DISPLAYWINDOWHEIGHT	2017415020
-#define HASH_DISPLAYWINDOWVERTICAL	2262072301
-#define HASH_LANGUAGE				3526403497
-#define HASH_LASTSELECTEDTAB		1712438393
-#define HASH_NEXTTOCURRENT			743165450
-#define HASH_SHOWADDRESSBAR			3302864385
-#define HASH_SHOWBOOKMARKSTOOLBAR	1216493954
-#define HASH_SHOWDRIVESTOOLBAR		899091590
-#define HASH_SHOWDISPLAYWINDOW		351410676
-#define HASH_SHOWEXTENSIONS			3743594966
-#define HASH_SHOWFOLDERS			948345109
-#define HASH_SHOWFOLDERSIZES		3684676528
-#define HASH_SHOWFRIENDLYDATES		467626964
-#define HASH_SHOWFULLTITLEPATH		1871292168
-#define HASH_SHOWGRIDLINESGLOBAL	1707929656
-#define HASH_SHOWHIDDENGLOBAL		558199811
-#define HASH_SHOWSTATUSBAR			3554629247
-#define HASH_SHOWINFOTIPS			3018038962
-#define HASH_SHOWTOOLBAR			1852868921
-#define HASH_SORTASCENDINGGLOBAL	2605638058
-#define HASH_STARTUPMODE			1344265373
-#define HASH_TOOLBARSTATE			3436473849
-#define HASH_TREEVIEWDELAYENABLED	2186637066
-#define HASH_TREEVIEWWIDTH			4257779536
-#define HASH_VIEWMODEGLOBAL			3743629718
-#define HASH_POSITION				3300187802
-#define HASH_LOCKTOOLBARS			3842965076
-#define HASH_NEWTABDIRECTORY		3570078203
-#define HASH_INFOTIPTYPE			3366492864
-#define HASH_SHOWAPPLICATIONTOOLBAR	101571053
-#define HASH_USEFULLROWSELECT		3780943197
-#define HASH_SHOWINGROUPSGLOBAL		4239388334
-#define HASH_EXTENDTABCONTROL		4097866437
-#define HASH_SHOWFILEPREVIEWS		1834921243
-#define HASH_REPLACEEXPLORERMODE	2422294263
-#define HASH_SHOWUSERNAMETITLEBAR	2618183549
-#define HASH_HIDESYSTEMFILESGLOBAL	1667356744
-#define HASH_HIDELINKEXTENSIONGLOBAL	1073100667
-#define HASH_ALLOWMULTIPLEINSTANCES	3463984536
-#define HASH_ONECLICKACTIVATE		1118178238
-#define HASH_ONECLICKACTIVATEHOVERTIME	3023373873
-#define HASH_FORCESAMETABWIDTH		2315576081
-#define HASH_DOUBLECLICKTABCLOSE	1866215987
-#define HASH_HANDLEZIPFILES			1074212343
-#define HASH_INSERTSORTED			1109371947
-#define HASH_SHOWPRIVILEGETITLEBAR	4071561587
-#define HASH_DISABLEFOLDERSIZENETWORKREMOVABLE	2610679594
-#define HASH_ALWAYSSHOWTABBAR		148004675
-#define HASH_CHECKBOXSELECTION		456677010
-#define HASH_FORCESIZE				1918861263
-#define HASH_SIZEDISPLAYFOMRAT		3548127263
-#define HASH_CLOSEMAINWINDOWONTABCLOSE	1151827266
-#define HASH_SHOWTABBARATBOTTOM		4099029340
-#define HASH_SHOWTASKBARTHUMBNAILS	2202555045
-#define HASH_SYNCHRONIZETREEVIEW	1687787660
-#define HASH_TVAUTOEXPAND			1228854897
-#define HASH_OVERWRITEEXISTINGFILESCONFIRMATION	1625342835
-#define HASH_LARGETOOLBARICONS		10895007
-#define HASH_PLAYNAVIGATIONSOUND	1987363412
-#define HASH_ICON_THEME				3998265761
+/* Identifies each of the settings in the
+Settings section of the config file. */
+enum class SettingName
+{
+	AlwaysOpenInNewTab,
+	AutoArrangeGlobal,
+	ConfirmCloseTabs,
+	DisplayCentreColor,
+	DisplayFont,
+	DisplaySurroundColor,
+	DisplayTextColor,
+	DisplayWindowWidth,
+	DisplayWindowHeight,
+	DisplayWindowVertical,
+	Language,
+	LastSelectedTab,
+	NextToCurrent,
+	ShowAddressBar,
+	ShowBookmarksToolbar,
+	ShowDrivesToolbar,
+	ShowDisplayWindow,
+	ShowExtensions,
+	ShowFolders,
+	ShowFolderSizes,
+	ShowFriendlyDates,
+	ShowFullTitlePath,
+	ShowGridlinesGlobal,
+	ShowHiddenGlobal,
+	ShowStatusBar,
+	ShowInfoTips,
+	ShowToolbar,
+	SortAscendingGlobal,
+	StartupMode,
+	ToolbarState,
+	TreeViewDelayEnabled,
+	TreeViewWidth,
+	ViewModeGlobal,
+	Position,
+	LockToolbars,
+	NewTabDirectory,
+	InfoTipType,
+	ShowApplicationToolbar,
+	UseFullRowSelect,
+	ShowInGroupsGlobal,
+	ExtendTabControl,
+	ShowFilePreviews,
+	ReplaceExplorerMode,
+	ShowUserNameTitleBar,
+	HideSystemFilesGlobal,
+	HideLinkExtensionGlobal,
+	AllowMultipleInstances,
+	OneClickActivate,
+	OneClickActivateHoverTime,
+	ForceSameTabWidth,
+	DoubleClickTabClose,
+	HandleZipFiles,
+	InsertSorted,
+	ShowPrivilegeLevelInTitleBar,
+	DisableFolderSizesNetworkRemovable,
+	AlwaysShowTabBar,
+	CheckBoxSelection,
+	ForceSize,
+	SizeDisplayFormat,
+	CloseMainWindowOnTabClose,
+	ShowTabBarAtBottom,
+	ShowTaskbarThumbnails,
+	SynchronizeTreeview,
+	TVAutoExpandSelected,
+	OverwriteExistingFilesConfirmation,
+	LargeToolbarIcons,
+	PlayNavigationSound,
+	PrefetchFolders,
+	PersistIconCache,
+	EnableTracing,
+	ThumbnailCacheSize,
+	ThumbnailDiskCacheSize,
+	ThumbnailSize,
+	TabHibernationIdleTimeout,
+	TabHibernationMemoryBudget,
+	IconTheme,
+};
+
+/* Maps the name attribute of each setting to its
+identifier. The map is built at compile time and
+lookups need only a single string comparison. */
+constexpr auto SETTING_NAMES = MakePerfectHashMap<SettingName>({
+	{ L"AlwaysOpenInNewTab", SettingName::AlwaysOpenInNewTab },
+	{ L"AutoArrangeGlobal", SettingName::AutoArrangeGlobal },
+	{ L"ConfirmCloseTabs", SettingName::ConfirmCloseTabs },
+	{ L"DisplayCentreColor", SettingName::DisplayCentreColor },
+	{ L"DisplayFont", SettingName::DisplayFont },
+	{ L"DisplaySurroundColor", SettingName::DisplaySurroundColor },
+	{ L"DisplayTextColor", SettingName::DisplayTextColor },
+	{ L"DisplayWindowWidth", SettingName::DisplayWindowWidth },
+	{ L"DisplayWindowHeight", SettingName::DisplayWindowHeight },
+	{ L"DisplayWindowVertical", SettingName::DisplayWindowVertical },
+	{ L"Language", SettingName::Language },
+	{ L"LastSelectedTab", SettingName::LastSelectedTab },
+	{ L"NextToCurrent", SettingName::NextToCurrent },
+	{ L"ShowAddressBar", SettingName::ShowAddressBar },
+	{ L"ShowBookmarksToolbar", SettingName::ShowBookmarksToolbar },
+	{ L"ShowDrivesToolbar", SettingName::ShowDrivesToolbar },
+	{ L"ShowDisplayWindow", SettingName::ShowDisplayWindow },
+	{ L"ShowExtensions", SettingName::ShowExtensions },
+	{ L"ShowFolders", SettingName::ShowFolders },
+	{ L"ShowFolderSizes", SettingName::ShowFolderSizes },
+	{ L"ShowFriendlyDates", SettingName::ShowFriendlyDates },
+	{ L"ShowFullTitlePath", SettingName::ShowFullTitlePath },
+	{ L"ShowGridlinesGlobal", SettingName::ShowGridlinesGlobal },
+	{ L"ShowHiddenGlobal", SettingName::ShowHiddenGlobal },
+	{ L"ShowStatusBar", SettingName::ShowStatusBar },
+	{ L"ShowInfoTips", SettingName::ShowInfoTips },
+	{ L"ShowToolbar", SettingName::ShowToolbar },
+	{ L"SortAscendingGlobal", SettingName::SortAscendingGlobal },
+	{ L"StartupMode", SettingName::StartupMode },
+	{ L"ToolbarState", SettingName::ToolbarState },
+	{ L"TreeViewDelayEnabled", SettingName::TreeViewDelayEnabled },
+	{ L"TreeViewWidth", SettingName::TreeViewWidth },
+	{ L"ViewModeGlobal", SettingName::ViewModeGlobal },
+	{ L"Position", SettingName::Position },
+	{ L"LockToolbars", SettingName::LockToolbars },
+	{ L"NewTabDirectory", SettingName::NewTabDirectory },
+	{ L"InfoTipType", SettingName::InfoTipType },
+	{ L"ShowApplicationToolbar", SettingName::ShowApplicationToolbar },
+	{ L"UseFullRowSelect", SettingName::UseFullRowSelect },
+	{ L"ShowInGroupsGlobal", SettingName::ShowInGroupsGlobal },
+	{ L"ExtendTabControl", SettingName::ExtendTabControl },
+	{ L"ShowFilePreviews", SettingName::ShowFilePreviews },
+	{ L"ReplaceExplorerMode", SettingName::ReplaceExplorerMode },
+	{ L"ShowUserNameTitleBar", SettingName::ShowUserNameTitleBar },
+	{ L"HideSystemFilesGlobal", SettingName::HideSystemFilesGlobal },
+	{ L"HideLinkExtensionGlobal", SettingName::HideLinkExtensionGlobal },
+	{ L"AllowMultipleInstances", SettingName::AllowMultipleInstances },
+	{ L"OneClickActivate", SettingName::OneClickActivate },
+	{ L"OneClickActivateHoverTime", SettingName::OneClickActivateHoverTime },
+	{ L"ForceSameTabWidth", SettingName::ForceSameTabWidth },
+	{ L"DoubleClickTabClose", SettingName::DoubleClickTabClose },
+	{ L"HandleZipFiles", SettingName::HandleZipFiles },
+	{ L"InsertSorted", SettingName::InsertSorted },
+	{ L"ShowPrivilegeLevelInTitleBar", SettingName::ShowPrivilegeLevelInTitleBar },
+	{ L"DisableFolderSizesNetworkRemovable", SettingName::DisableFolderSizesNetworkRemovable },
+	{ L"AlwaysShowTabBar", SettingName::AlwaysShowTabBar },
+	{ L"CheckBoxSelection", SettingName::CheckBoxSelection },
+	{ L"ForceSize", SettingName::ForceSize },
+	{ L"SizeDisplayFormat", SettingName::SizeDisplayFormat },
+	{ L"CloseMainWindowOnTabClose", SettingName::CloseMainWindowOnTabClose },
+	{ L"ShowTabBarAtBottom", SettingName::ShowTabBarAtBottom },
+	{ L"ShowTaskbarThumbnails", SettingName::ShowTaskbarThumbnails },
+	{ L"SynchronizeTreeview", SettingName::SynchronizeTreeview },
+	{ L"TVAutoExpandSelected", SettingName::TVAutoExpandSelected },
+	{ L"OverwriteExistingFilesConfirmation", SettingName::OverwriteExistingFilesConfirmation },
+	{ L"LargeToolbarIcons", SettingName::LargeToolbarIcons },
+	{ L"PlayNavigationSound", SettingName::PlayNavigationSound },
+	{ L"PrefetchFolders", SettingName::PrefetchFolders },
+	{ L"PersistIconCache", SettingName::PersistIconCache },
+	{ L"EnableTracing", SettingName::EnableTracing },
+	{ L"ThumbnailCacheSize", SettingName::ThumbnailCacheSize },
+	{ L"ThumbnailDiskCacheSize", SettingName::ThumbnailDiskCacheSize },
+	{ L"ThumbnailSize", SettingName::ThumbnailSize },
+	{ L"TabHibernationIdleTimeout", SettingName::TabHibernationIdleTimeout },
+	{ L"TabHibernationMemoryBudget", SettingName::TabHibernationMemoryBudget },
+	{ L"IconTheme", SettingName::IconTheme },
+});
 
 struct ColumnXMLSaveData
 {
@@ -137,824 +231,596 @@ static ColumnXMLSaveData ColumnData[] =
 {_T("OriginalLocation"),ColumnType::OriginalLocation},{_T("DateDeleted"),ColumnType::DateDeleted},
 {_T("Documents"),ColumnType::PrinterNumDocuments},{_T("Status"),ColumnType::PrinterStatus}};
 
-unsigned long hash_setting(unsigned char *str);
-
-BOOL LoadWindowPositionFromXML(WINDOWPLACEMENT *pwndpl)
+/* Reads the config file that sits alongside the
+executable. */
+std::optional<std::wstring> ReadXMLConfigFile()
 {
-	IXMLDOMDocument *pXMLDom;
 	TCHAR szConfigFile[MAX_PATH];
-	IXMLDOMNodeList		*pNodes = nullptr;
-	IXMLDOMNode			*pNode = nullptr;
-	IXMLDOMNamedNodeMap	*am = nullptr;
-	IXMLDOMNode			*pChildNode = nullptr;
-	BSTR						bstrName;
-	BSTR						bstrValue;
-	BSTR						bstr = nullptr;
-	VARIANT_BOOL				status;
-	VARIANT						var;
-	HRESULT						hr;
-	long						length;
-	long						nChildNodes;
-	int							i = 0;
-
-	pXMLDom = NXMLSettings::DomFromCOM();
-
-	if(!pXMLDom)
-		goto clean;
 
 	GetProcessImageName(GetCurrentProcessId(),szConfigFile, SIZEOF_ARRAY(szConfigFile));
 	PathRemoveFileSpec(szConfigFile);
 	PathAppend(szConfigFile, NExplorerplusplus::XML_FILENAME);
 
-	var = NXMLSettings::VariantString(szConfigFile);
-	pXMLDom->load(var, &status);
+	std::ifstream inputStream(szConfigFile, std::ios::binary);
 
-	if(status != VARIANT_TRUE)
-		goto clean;
-
-	bstr = SysAllocString(L"//WindowPosition/*");
-	pXMLDom->selectNodes(bstr, &pNodes);
-
-	pwndpl->length = sizeof(WINDOWPLACEMENT);
-
-	if(!pNodes)
+	if(!inputStream)
 	{
-		goto clean;
+		return std::nullopt;
 	}
-	else
-	{
-		pNodes->get_length(&length);
 
-		/* There should only be one node
-		under 'WindowPosition'. */
-		if(length == 1)
-		{
-			pNodes->get_item(0, &pNode);
+	std::string data((std::istreambuf_iterator<char>(inputStream)),
+		std::istreambuf_iterator<char>());
 
-			hr = pNode->get_attributes(&am);
+	return DecodeXmlDocument(data);
+}
 
-			if(SUCCEEDED(hr))
-			{
-				am->get_length(&nChildNodes);
+/* Moves the reader to the next element with the
+specified name. */
+static bool FindElement(XmlStreamReader &reader, std::wstring_view name)
+{
+	while(true)
+	{
+		XmlStreamReader::Token token = reader.ReadNext();
 
-				for(i = 1; i < nChildNodes; i++)
-				{
-					am->get_item(i, &pChildNode);
-
-					/* Element name. */
-					pChildNode->get_nodeName(&bstrName);
-
-					/* Element value. */
-					pChildNode->get_text(&bstrValue);
-
-					if(lstrcmp(bstrName, _T("Flags")) == 0)
-						pwndpl->flags = NXMLSettings::DecodeIntValue(bstrValue);
-					else if(lstrcmp(bstrName, _T("ShowCmd")) == 0)
-						pwndpl->showCmd = NXMLSettings::DecodeIntValue(bstrValue);
-					else if(lstrcmp(bstrName, _T("MinPositionX")) == 0)
-						pwndpl->ptMinPosition.x = NXMLSettings::DecodeIntValue(bstrValue);
-					else if(lstrcmp(bstrName, _T("MinPositionY")) == 0)
-						pwndpl->ptMinPosition.y = NXMLSettings::DecodeIntValue(bstrValue);
-					else if(lstrcmp(bstrName, _T("MaxPositionX")) == 0)
-						pwndpl->ptMaxPosition.x = NXMLSettings::DecodeIntValue(bstrValue);
-					else if(lstrcmp(bstrName, _T("MaxPositionY")) == 0)
-						pwndpl->ptMaxPosition.y = NXMLSettings::DecodeIntValue(bstrValue);
-					else if(lstrcmp(bstrName, _T("NormalPositionLeft")) == 0)
-						pwndpl->rcNormalPosition.left = NXMLSettings::DecodeIntValue(bstrValue);
-					else if(lstrcmp(bstrName, _T("NormalPositionTop")) == 0)
-						pwndpl->rcNormalPosition.top = NXMLSettings::DecodeIntValue(bstrValue);
-					else if(lstrcmp(bstrName, _T("NormalPositionRight")) == 0)
-						pwndpl->rcNormalPosition.right = NXMLSettings::DecodeIntValue(bstrValue);
-					else if(lstrcmp(bstrName, _T("NormalPositionBottom")) == 0)
-						pwndpl->rcNormalPosition.bottom = NXMLSettings::DecodeIntValue(bstrValue);
-				}
-			}
+		if(token == XmlStreamReader::Token::Error
+			|| token == XmlStreamReader::Token::EndDocument)
+		{
+			return false;
+		}
 
-			pNode->Release();
-			pNode = nullptr;
+		if(token == XmlStreamReader::Token::StartElement && reader.GetName() == name)
+		{
+			return true;
 		}
 	}
-
-clean:
-	if(&var) VariantClear(&var);
-	if(bstr) SysFreeString(bstr);
-	if(pNodes) pNodes->Release();
-	if(pNode) pNode->Release();
-
-	return TRUE;
 }
 
-BOOL LoadAllowMultipleInstancesFromXML()
+/* The functions below are called before the main
+window is created, so they only read as much of
+the config file as they need, rather than loading
+the entire document. */
+BOOL LoadWindowPositionFromXML(WINDOWPLACEMENT *pwndpl)
 {
-	IXMLDOMDocument *pXMLDom;
-	TCHAR szConfigFile[MAX_PATH];
-	VARIANT_BOOL status;
-	VARIANT var;
-	BOOL bAllowMultipleInstances = TRUE;
-	BSTR bstr = nullptr;
-	IXMLDOMNodeList *pNodes = nullptr;
-	IXMLDOMNode *pNode = nullptr;
-	IXMLDOMNamedNodeMap *am = nullptr;
-	IXMLDOMNode *pNodeAttribute = nullptr;
-	BSTR bstrName;
-	BSTR bstrValue;
-	HRESULT hr;
-	BOOL bFound = FALSE;
-	long length;
-
-	pXMLDom = NXMLSettings::DomFromCOM();
-
-	if(!pXMLDom)
-		goto clean;
-
-	GetProcessImageName(GetCurrentProcessId(),szConfigFile, SIZEOF_ARRAY(szConfigFile));
-	PathRemoveFileSpec(szConfigFile);
-	PathAppend(szConfigFile, NExplorerplusplus::XML_FILENAME);
-
-	var = NXMLSettings::VariantString(szConfigFile);
-	pXMLDom->load(var, &status);
-
-	if(status != VARIANT_TRUE)
-		goto clean;
+	auto document = ReadXMLConfigFile();
 
-	bstr = SysAllocString(L"//Settings/*");
-	pXMLDom->selectNodes(bstr, &pNodes);
-
-	if(!pNodes)
+	if(!document)
 	{
-		goto clean;
+		return FALSE;
 	}
-	else
-	{
-		pNodes->get_length(&length);
 
-		for(long i = 0; i < length; i++)
-		{
-			if(bFound)
-				break;
+	XmlStreamReader reader(*document);
 
-			pNodes->get_item(i, &pNode);
+	if(!FindElement(reader, L"WindowPosition"))
+	{
+		return FALSE;
+	}
 
-			hr = pNode->get_attributes(&am);
+	int depth = reader.GetDepth();
+	WINDOWPLACEMENT wndpl = {};
+	int nChildElements = 0;
 
-			if(SUCCEEDED(hr))
-			{
-				hr = am->get_item(0, &pNodeAttribute);
+	while(true)
+	{
+		XmlStreamReader::Token token = reader.ReadNext();
 
-				if(SUCCEEDED(hr))
-				{
-					/* Element name. */
-					pNodeAttribute->get_text(&bstrName);
+		if(token == XmlStreamReader::Token::Error
+			|| token == XmlStreamReader::Token::EndDocument)
+		{
+			return FALSE;
+		}
 
-					/* Element value. */
-					pNode->get_text(&bstrValue);
+		if(token == XmlStreamReader::Token::EndElement && reader.GetDepth() == depth)
+		{
+			break;
+		}
 
-					if(lstrcmp(bstrName, _T("AllowMultipleInstances")) == 0)
-					{
-						bAllowMultipleInstances = NXMLSettings::DecodeBoolValue(bstrValue);
+		if(token != XmlStreamReader::Token::StartElement || reader.GetDepth() != depth + 1)
+		{
+			continue;
+		}
 
-						bFound = TRUE;
-					}
+		nChildElements++;
 
-					pNodeAttribute->Release();
-					pNodeAttribute = nullptr;
-				}
-			}
+		for(size_t i = 0; i < reader.GetNumAttributes(); i++)
+		{
+			const std::wstring &name = reader.GetAttributeName(i);
+			const WCHAR *value = reader.GetAttributeValue(i).c_str();
+
+			if(name == L"Flags")
+				wndpl.flags = NXMLSettings::DecodeIntValue(value);
+			else if(name == L"ShowCmd")
+				wndpl.showCmd = NXMLSettings::DecodeIntValue(value);
+			else if(name == L"MinPositionX")
+				wndpl.ptMinPosition.x = NXMLSettings::DecodeIntValue(value);
+			else if(name == L"MinPositionY")
+				wndpl.ptMinPosition.y = NXMLSettings::DecodeIntValue(value);
+			else if(name == L"MaxPositionX")
+				wndpl.ptMaxPosition.x = NXMLSettings::DecodeIntValue(value);
+			else if(name == L"MaxPositionY")
+				wndpl.ptMaxPosition.y = NXMLSettings::DecodeIntValue(value);
+			else if(name == L"NormalPositionLeft")
+				wndpl.rcNormalPosition.left = NXMLSettings::DecodeIntValue(value);
+			else if(name == L"NormalPositionTop")
+				wndpl.rcNormalPosition.top = NXMLSettings::DecodeIntValue(value);
+			else if(name == L"NormalPositionRight")
+				wndpl.rcNormalPosition.right = NXMLSettings::DecodeIntValue(value);
+			else if(name == L"NormalPositionBottom")
+				wndpl.rcNormalPosition.bottom = NXMLSettings::DecodeIntValue(value);
+		}
 
-			pNode->Release();
-			pNode = nullptr;
+		if(!reader.SkipElement())
+		{
+			return FALSE;
 		}
 	}
 
-clean:
-	if(&var) VariantClear(&var);
+	/* There should only be one node
+	under 'WindowPosition'. */
+	if(nChildElements != 1)
+	{
+		return FALSE;
+	}
 
-	return bAllowMultipleInstances;
+	*pwndpl = wndpl;
+	pwndpl->length = sizeof(WINDOWPLACEMENT);
+
+	return TRUE;
 }
 
-void Explorerplusplus::LoadGenericSettingsFromXML(IXMLDOMDocument *pXMLDom)
+BOOL LoadAllowMultipleInstancesFromXML()
 {
-	BSTR						bstr = nullptr;
-	IXMLDOMNodeList		*pNodes = nullptr;
-	IXMLDOMNode			*pNode = nullptr;
-	IXMLDOMNamedNodeMap	*am = nullptr;
-	IXMLDOMNode			*pNodeAttribute = nullptr;
-	BSTR						bstrName;
-	BSTR						bstrValue;
-	HRESULT						hr;
-	long						length;
-
-	if(pXMLDom == nullptr)
-		goto clean;
-
-	bstr = SysAllocString(L"//Settings/*");
-	pXMLDom->selectNodes(bstr,&pNodes);
-
-	if(!pNodes)
+	auto document = ReadXMLConfigFile();
+
+	if(!document)
 	{
-		goto clean;
+		return TRUE;
 	}
-	else
+
+	XmlStreamReader reader(*document);
+
+	if(!FindElement(reader, L"Settings"))
 	{
-		pNodes->get_length(&length);
+		return TRUE;
+	}
 
-		for(long i = 0;i < length;i++)
-		{
-			pNodes->get_item(i,&pNode);
+	int depth = reader.GetDepth();
 
-			hr = pNode->get_attributes(&am);
+	while(true)
+	{
+		XmlStreamReader::Token token = reader.ReadNext();
 
-			if(SUCCEEDED(hr))
-			{
-				hr = am->get_item(0,&pNodeAttribute);
+		if(token == XmlStreamReader::Token::Error
+			|| token == XmlStreamReader::Token::EndDocument
+			|| (token == XmlStreamReader::Token::EndElement && reader.GetDepth() == depth))
+		{
+			return TRUE;
+		}
 
-				if(SUCCEEDED(hr))
-				{
-					/* Element name. */
-					pNodeAttribute->get_text(&bstrName);
+		if(token != XmlStreamReader::Token::StartElement || reader.GetDepth() != depth + 1)
+		{
+			continue;
+		}
 
-					/* Element value. */
-					pNode->get_text(&bstrValue);
+		auto name = reader.FindAttribute(L"name");
 
-					/* Map the external attribute and value to an
-					internal variable. */
-					MapAttributeToValue(pNode,bstrName,bstrValue);
+		if(name && *name == L"AllowMultipleInstances")
+		{
+			auto value = reader.ReadElementText();
 
-					pNodeAttribute->Release();
-					pNodeAttribute = nullptr;
-				}
+			if(!value)
+			{
+				return TRUE;
 			}
 
-			pNode->Release();
-			pNode = nullptr;
+			return NXMLSettings::DecodeBoolValue(value->c_str());
+		}
+
+		if(!reader.SkipElement())
+		{
+			return TRUE;
 		}
 	}
+}
 
-clean:
-	return;
+void Explorerplusplus::LoadGenericSettingsFromXML(const XmlSections &sections)
+{
+	auto reader = sections.OpenSection(L"Settings");
+
+	if(!reader)
+	{
+		return;
+	}
+
+	int depth = reader->GetDepth();
+
+	while(reader->ReadChildElement(depth))
+	{
+		auto name = reader->FindAttribute(L"name");
+
+		if(!name)
+		{
+			continue;
+		}
+
+		/* Map the external attribute and value to an
+		internal variable. */
+		MapAttributeToValue(*reader,*name);
+	}
 }
 
-void Explorerplusplus::SaveGenericSettingsToXML(IXMLDOMDocument *pXMLDom,
-IXMLDOMElement *pRoot)
+void Explorerplusplus::SaveGenericSettingsToXML(XmlStreamWriter &writer)
 {
-	IXMLDOMElement					*pe = nullptr;
-	IXMLDOMElement					*pParentNode = nullptr;
-	BSTR									bstr = nullptr;
-	BSTR									bstr_wsnt= SysAllocString(L"\n\t");
-	BSTR									bstr_wsntt = SysAllocString(L"\n\t\t");
-	WCHAR									szValue[32];
-
-	bstr = SysAllocString(L"Settings");
-	pXMLDom->createElement(bstr,&pe);
-	SysFreeString(bstr);
-	bstr = nullptr;
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("AllowMultipleInstances"),NXMLSettings::EncodeBoolValue(m_config->allowMultipleInstances));
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("AlwaysOpenInNewTab"),NXMLSettings::EncodeBoolValue(m_config->alwaysOpenNewTab));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("AlwaysShowTabBar"),NXMLSettings::EncodeBoolValue(m_config->alwaysShowTabBar.get()));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("AutoArrangeGlobal"),NXMLSettings::EncodeBoolValue(m_config->defaultFolderSettings.autoArrange));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("CheckBoxSelection"),NXMLSettings::EncodeBoolValue(m_config->checkBoxSelection));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("CloseMainWindowOnTabClose"),NXMLSettings::EncodeBoolValue(m_config->closeMainWindowOnTabClose));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ConfirmCloseTabs"),NXMLSettings::EncodeBoolValue(m_config->confirmCloseTabs));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("DisableFolderSizesNetworkRemovable"),
+	WCHAR	szValue[32];
+
+	writer.StartElement(L"Settings");
+
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("AllowMultipleInstances"),NXMLSettings::EncodeBoolValue(m_config->allowMultipleInstances));
+
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("AlwaysOpenInNewTab"),NXMLSettings::EncodeBoolValue(m_config->alwaysOpenNewTab));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("AlwaysShowTabBar"),NXMLSettings::EncodeBoolValue(m_config->alwaysShowTabBar.get()));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("AutoArrangeGlobal"),NXMLSettings::EncodeBoolValue(m_config->defaultFolderSettings.autoArrange));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("CheckBoxSelection"),NXMLSettings::EncodeBoolValue(m_config->checkBoxSelection));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("CloseMainWindowOnTabClose"),NXMLSettings::EncodeBoolValue(m_config->closeMainWindowOnTabClose));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ConfirmCloseTabs"),NXMLSettings::EncodeBoolValue(m_config->confirmCloseTabs));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("DisableFolderSizesNetworkRemovable"),
 		NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.disableFolderSizesNetworkRemovable));
 
 	COLORREF centreColor;
 
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::CreateElementNode(pXMLDom,&pParentNode,pe,_T("Setting"),_T("DisplayCentreColor"));
+	NXMLSettings::StartNamedElement(writer,_T("Setting"),_T("DisplayCentreColor"));
 	centreColor = (COLORREF)SendMessage(m_hDisplayWindow,DWM_GETCENTRECOLOR,0,0);
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("r"),NXMLSettings::EncodeIntValue(GetRValue(centreColor)));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("g"),NXMLSettings::EncodeIntValue(GetGValue(centreColor)));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("b"),NXMLSettings::EncodeIntValue(GetBValue(centreColor)));
-	pParentNode->Release();
-	pParentNode = nullptr;
+	writer.WriteAttribute(_T("r"),NXMLSettings::EncodeIntValue(GetRValue(centreColor)));
+	writer.WriteAttribute(_T("g"),NXMLSettings::EncodeIntValue(GetGValue(centreColor)));
+	writer.WriteAttribute(_T("b"),NXMLSettings::EncodeIntValue(GetBValue(centreColor)));
+	writer.EndElement();
 
 	HFONT hFont;
 	LOGFONT fontInfo;
 
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::CreateElementNode(pXMLDom,&pParentNode,pe,_T("Setting"),_T("DisplayFont"));
+	NXMLSettings::StartNamedElement(writer,_T("Setting"),_T("DisplayFont"));
 	SendMessage(m_hDisplayWindow,DWM_GETFONT,(WPARAM)&hFont,0);
 	GetObject(hFont,sizeof(LOGFONT),&fontInfo);
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("Height"),NXMLSettings::EncodeIntValue(fontInfo.lfHeight));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("Width"),NXMLSettings::EncodeIntValue(fontInfo.lfWidth));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("Weight"),NXMLSettings::EncodeIntValue(fontInfo.lfWeight));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("Italic"),NXMLSettings::EncodeBoolValue(fontInfo.lfItalic));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("Underline"),NXMLSettings::EncodeBoolValue(fontInfo.lfUnderline));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("Strikeout"),NXMLSettings::EncodeBoolValue(fontInfo.lfStrikeOut));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("Font"),fontInfo.lfFaceName);
+	writer.WriteAttribute(_T("Height"),NXMLSettings::EncodeIntValue(fontInfo.lfHeight));
+	writer.WriteAttribute(_T("Width"),NXMLSettings::EncodeIntValue(fontInfo.lfWidth));
+	writer.WriteAttribute(_T("Weight"),NXMLSettings::EncodeIntValue(fontInfo.lfWeight));
+	writer.WriteAttribute(_T("Italic"),NXMLSettings::EncodeBoolValue(fontInfo.lfItalic));
+	writer.WriteAttribute(_T("Underline"),NXMLSettings::EncodeBoolValue(fontInfo.lfUnderline));
+	writer.WriteAttribute(_T("Strikeout"),NXMLSettings::EncodeBoolValue(fontInfo.lfStrikeOut));
+	writer.WriteAttribute(_T("Font"),fontInfo.lfFaceName);
+	writer.EndElement();
 
 	COLORREF surroundColor;
 
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::CreateElementNode(pXMLDom,&pParentNode,pe,_T("Setting"),_T("DisplaySurroundColor"));
+	NXMLSettings::StartNamedElement(writer,_T("Setting"),_T("DisplaySurroundColor"));
 	surroundColor = (COLORREF)SendMessage(m_hDisplayWindow,DWM_GETSURROUNDCOLOR,0,0);
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("r"),NXMLSettings::EncodeIntValue(GetRValue(surroundColor)));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("g"),NXMLSettings::EncodeIntValue(GetGValue(surroundColor)));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("b"),NXMLSettings::EncodeIntValue(GetBValue(surroundColor)));
-	pParentNode->Release();
-	pParentNode = nullptr;
+	writer.WriteAttribute(_T("r"),NXMLSettings::EncodeIntValue(GetRValue(surroundColor)));
+	writer.WriteAttribute(_T("g"),NXMLSettings::EncodeIntValue(GetGValue(surroundColor)));
+	writer.WriteAttribute(_T("b"),NXMLSettings::EncodeIntValue(GetBValue(surroundColor)));
+	writer.EndElement();
 
 	COLORREF textColor;
 
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::CreateElementNode(pXMLDom,&pParentNode,pe,_T("Setting"),_T("DisplayTextColor"));
+	NXMLSettings::StartNamedElement(writer,_T("Setting"),_T("DisplayTextColor"));
 	textColor = (COLORREF)SendMessage(m_hDisplayWindow,DWM_GETTEXTCOLOR,0,0);
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("r"),NXMLSettings::EncodeIntValue(GetRValue(textColor)));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("g"),NXMLSettings::EncodeIntValue(GetGValue(textColor)));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("b"),NXMLSettings::EncodeIntValue(GetBValue(textColor)));
-	pParentNode->Release();
-	pParentNode = nullptr;
+	writer.WriteAttribute(_T("r"),NXMLSettings::EncodeIntValue(GetRValue(textColor)));
+	writer.WriteAttribute(_T("g"),NXMLSettings::EncodeIntValue(GetGValue(textColor)));
+	writer.WriteAttribute(_T("b"),NXMLSettings::EncodeIntValue(GetBValue(textColor)));
+	writer.EndElement();
 
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
 	_itow_s(m_config->displayWindowWidth,szValue,SIZEOF_ARRAY(szValue),10);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("DisplayWindowWidth"),szValue);
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("DisplayWindowWidth"),szValue);
 
 	_itow_s(m_config->displayWindowHeight,szValue,SIZEOF_ARRAY(szValue),10);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("DisplayWindowHeight"),szValue);
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("DisplayWindowVertical"),NXMLSettings::EncodeBoolValue(m_config->displayWindowVertical));
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("DoubleClickTabClose"),NXMLSettings::EncodeBoolValue(m_config->doubleClickTabClose));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ExtendTabControl"),NXMLSettings::EncodeBoolValue(m_config->extendTabControl));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ForceSameTabWidth"),NXMLSettings::EncodeBoolValue(m_config->forceSameTabWidth.get()));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ForceSize"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.forceSize));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("HandleZipFiles"),NXMLSettings::EncodeBoolValue(m_config->handleZipFiles));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("HideLinkExtensionGlobal"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.hideLinkExtension));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("HideSystemFilesGlobal"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.hideSystemFiles));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("InfoTipType"),NXMLSettings::EncodeIntValue(static_cast<int>(m_config->infoTipType)));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("InsertSorted"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.insertSorted));
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("DisplayWindowHeight"),szValue);
+
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("DisplayWindowVertical"),NXMLSettings::EncodeBoolValue(m_config->displayWindowVertical));
+
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("DoubleClickTabClose"),NXMLSettings::EncodeBoolValue(m_config->doubleClickTabClose));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ExtendTabControl"),NXMLSettings::EncodeBoolValue(m_config->extendTabControl));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ForceSameTabWidth"),NXMLSettings::EncodeBoolValue(m_config->forceSameTabWidth.get()));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ForceSize"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.forceSize));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("HandleZipFiles"),NXMLSettings::EncodeBoolValue(m_config->handleZipFiles));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("HideLinkExtensionGlobal"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.hideLinkExtension));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("HideSystemFilesGlobal"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.hideSystemFiles));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("InfoTipType"),NXMLSettings::EncodeIntValue(static_cast<int>(m_config->infoTipType)));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("InsertSorted"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.insertSorted));
+
 	_itow_s(m_config->language,szValue,SIZEOF_ARRAY(szValue),10);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("Language"),szValue);
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("Language"),szValue);
 
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("LargeToolbarIcons"),NXMLSettings::EncodeBoolValue(m_config->useLargeToolbarIcons.get()));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("LargeToolbarIcons"),NXMLSettings::EncodeBoolValue(m_config->useLargeToolbarIcons.get()));
 
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
 	_itow_s(m_iLastSelectedTab,szValue,SIZEOF_ARRAY(szValue),10);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("LastSelectedTab"),szValue);
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("LockToolbars"),NXMLSettings::EncodeBoolValue(m_config->lockToolbars));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("NextToCurrent"),NXMLSettings::EncodeBoolValue(m_config->openNewTabNextToCurrent));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("NewTabDirectory"),m_config->defaultTabDirectory.c_str());
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("OneClickActivate"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.oneClickActivate));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("OneClickActivateHoverTime"),NXMLSettings::EncodeIntValue(m_config->globalFolderSettings.oneClickActivateHoverTime));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("OverwriteExistingFilesConfirmation"),NXMLSettings::EncodeBoolValue(m_config->overwriteExistingFilesConfirmation));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("PlayNavigationSound"),NXMLSettings::EncodeBoolValue(m_config->playNavigationSound));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ReplaceExplorerMode"),NXMLSettings::EncodeIntValue(static_cast<int>(m_config->replaceExplorerMode)));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowAddressBar"),NXMLSettings::EncodeBoolValue(m_config->showAddressBar));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowApplicationToolbar"),NXMLSettings::EncodeBoolValue(m_config->showApplicationToolbar));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowBookmarksToolbar"),NXMLSettings::EncodeBoolValue(m_config->showBookmarksToolbar));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowDrivesToolbar"),NXMLSettings::EncodeBoolValue(m_config->showDrivesToolbar));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowDisplayWindow"),NXMLSettings::EncodeBoolValue(m_config->showDisplayWindow));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowExtensions"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.showExtensions));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowFilePreviews"),NXMLSettings::EncodeBoolValue(m_config->showFilePreviews));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowFolders"),NXMLSettings::EncodeBoolValue(m_config->showFolders));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowFolderSizes"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.showFolderSizes));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowFriendlyDates"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.showFriendlyDates));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowFullTitlePath"),NXMLSettings::EncodeBoolValue(m_config->showFullTitlePath.get()));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowGridlinesGlobal"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.showGridlines));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowHiddenGlobal"),NXMLSettings::EncodeBoolValue(m_config->defaultFolderSettings.showHidden));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowInfoTips"),NXMLSettings::EncodeBoolValue(m_config->showInfoTips));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowInGroupsGlobal"),NXMLSettings::EncodeBoolValue(m_config->defaultFolderSettings.showInGroups));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowPrivilegeLevelInTitleBar"),NXMLSettings::EncodeBoolValue(m_config->showPrivilegeLevelInTitleBar.get()));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowStatusBar"),NXMLSettings::EncodeBoolValue(m_config->showStatusBar));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowTabBarAtBottom"),NXMLSettings::EncodeBoolValue(m_config->showTabBarAtBottom));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowTaskbarThumbnails"),NXMLSettings::EncodeBoolValue(m_config->showTaskbarThumbnails));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowToolbar"),NXMLSettings::EncodeBoolValue(m_config->showMainToolbar));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ShowUserNameTitleBar"),NXMLSettings::EncodeBoolValue(m_config->showUserNameInTitleBar.get()));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("SizeDisplayFormat"),NXMLSettings::EncodeIntValue(static_cast<int>(m_config->globalFolderSettings.sizeDisplayFormat)));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("SortAscendingGlobal"),NXMLSettings::EncodeBoolValue(m_config->defaultFolderSettings.sortAscending));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("StartupMode"),NXMLSettings::EncodeIntValue(static_cast<int>(m_config->startupMode)));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("SynchronizeTreeview"),NXMLSettings::EncodeBoolValue(m_config->synchronizeTreeview));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("TVAutoExpandSelected"),NXMLSettings::EncodeBoolValue(m_config->treeViewAutoExpandSelected));
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("UseFullRowSelect"),NXMLSettings::EncodeBoolValue(m_config->useFullRowSelect));
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom, bstr_wsntt, pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom, pe, _T("Setting"), _T("IconTheme"), NXMLSettings::EncodeIntValue(m_config->iconTheme));
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom, bstr_wsntt, pe);
-	NXMLSettings::CreateElementNode(pXMLDom, &pParentNode, pe, _T("Setting"), _T("ToolbarState"));
-
-	MainToolbarPersistentSettings::GetInstance().SaveXMLSettings(pXMLDom, pParentNode);
-
-	pParentNode->Release();
-	pParentNode = nullptr;
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("TreeViewDelayEnabled"),NXMLSettings::EncodeBoolValue(m_config->treeViewDelayEnabled));
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("LastSelectedTab"),szValue);
+
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("LockToolbars"),NXMLSettings::EncodeBoolValue(m_config->lockToolbars));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("NextToCurrent"),NXMLSettings::EncodeBoolValue(m_config->openNewTabNextToCurrent));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("NewTabDirectory"),m_config->defaultTabDirectory.c_str());
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("OneClickActivate"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.oneClickActivate));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("OneClickActivateHoverTime"),NXMLSettings::EncodeIntValue(m_config->globalFolderSettings.oneClickActivateHoverTime));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("OverwriteExistingFilesConfirmation"),NXMLSettings::EncodeBoolValue(m_config->overwriteExistingFilesConfirmation));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("PlayNavigationSound"),NXMLSettings::EncodeBoolValue(m_config->playNavigationSound));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("PrefetchFolders"),NXMLSettings::EncodeBoolValue(m_config->prefetchFolders));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("PersistIconCache"),NXMLSettings::EncodeBoolValue(m_config->persistIconCache));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("EnableTracing"),NXMLSettings::EncodeBoolValue(m_config->enableTracing));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ThumbnailCacheSize"),NXMLSettings::EncodeIntValue(m_config->thumbnailCacheSize));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ThumbnailDiskCacheSize"),NXMLSettings::EncodeIntValue(m_config->thumbnailDiskCacheSize));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ThumbnailSize"),NXMLSettings::EncodeIntValue(m_config->thumbnailSize));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("TabHibernationIdleTimeout"),NXMLSettings::EncodeIntValue(m_config->tabHibernationIdleTimeout));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("TabHibernationMemoryBudget"),NXMLSettings::EncodeIntValue(m_config->tabHibernationMemoryBudget));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ReplaceExplorerMode"),NXMLSettings::EncodeIntValue(static_cast<int>(m_config->replaceExplorerMode)));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowAddressBar"),NXMLSettings::EncodeBoolValue(m_config->showAddressBar));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowApplicationToolbar"),NXMLSettings::EncodeBoolValue(m_config->showApplicationToolbar));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowBookmarksToolbar"),NXMLSettings::EncodeBoolValue(m_config->showBookmarksToolbar));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowDrivesToolbar"),NXMLSettings::EncodeBoolValue(m_config->showDrivesToolbar));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowDisplayWindow"),NXMLSettings::EncodeBoolValue(m_config->showDisplayWindow));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowExtensions"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.showExtensions));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowFilePreviews"),NXMLSettings::EncodeBoolValue(m_config->showFilePreviews));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowFolders"),NXMLSettings::EncodeBoolValue(m_config->showFolders));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowFolderSizes"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.showFolderSizes));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowFriendlyDates"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.showFriendlyDates));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowFullTitlePath"),NXMLSettings::EncodeBoolValue(m_config->showFullTitlePath.get()));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowGridlinesGlobal"),NXMLSettings::EncodeBoolValue(m_config->globalFolderSettings.showGridlines));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowHiddenGlobal"),NXMLSettings::EncodeBoolValue(m_config->defaultFolderSettings.showHidden));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowInfoTips"),NXMLSettings::EncodeBoolValue(m_config->showInfoTips));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowInGroupsGlobal"),NXMLSettings::EncodeBoolValue(m_config->defaultFolderSettings.showInGroups));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowPrivilegeLevelInTitleBar"),NXMLSettings::EncodeBoolValue(m_config->showPrivilegeLevelInTitleBar.get()));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowStatusBar"),NXMLSettings::EncodeBoolValue(m_config->showStatusBar));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowTabBarAtBottom"),NXMLSettings::EncodeBoolValue(m_config->showTabBarAtBottom));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowTaskbarThumbnails"),NXMLSettings::EncodeBoolValue(m_config->showTaskbarThumbnails));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowToolbar"),NXMLSettings::EncodeBoolValue(m_config->showMainToolbar));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ShowUserNameTitleBar"),NXMLSettings::EncodeBoolValue(m_config->showUserNameInTitleBar.get()));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("SizeDisplayFormat"),NXMLSettings::EncodeIntValue(static_cast<int>(m_config->globalFolderSettings.sizeDisplayFormat)));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("SortAscendingGlobal"),NXMLSettings::EncodeBoolValue(m_config->defaultFolderSettings.sortAscending));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("StartupMode"),NXMLSettings::EncodeIntValue(static_cast<int>(m_config->startupMode)));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("SynchronizeTreeview"),NXMLSettings::EncodeBoolValue(m_config->synchronizeTreeview));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("TVAutoExpandSelected"),NXMLSettings::EncodeBoolValue(m_config->treeViewAutoExpandSelected));
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("UseFullRowSelect"),NXMLSettings::EncodeBoolValue(m_config->useFullRowSelect));
+
+	NXMLSettings::WriteStandardSetting(writer, _T("Setting"), _T("IconTheme"), NXMLSettings::EncodeIntValue(m_config->iconTheme));
+
+	NXMLSettings::StartNamedElement(writer, _T("Setting"), _T("ToolbarState"));
+
+	MainToolbarPersistentSettings::GetInstance().SaveXMLSettings(writer);
+
+	writer.EndElement();
+
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("TreeViewDelayEnabled"),NXMLSettings::EncodeBoolValue(m_config->treeViewDelayEnabled));
+
 	_itow_s(m_config->treeViewWidth,szValue,SIZEOF_ARRAY(szValue),10);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("TreeViewWidth"),szValue);
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("TreeViewWidth"),szValue);
 
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
 	_itow_s(m_config->defaultFolderSettings.viewMode,szValue,SIZEOF_ARRAY(szValue),10);
-	NXMLSettings::WriteStandardSetting(pXMLDom,pe,_T("Setting"),_T("ViewModeGlobal"),szValue);
+	NXMLSettings::WriteStandardSetting(writer,_T("Setting"),_T("ViewModeGlobal"),szValue);
 
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsnt,pe);
+	writer.EndElement();
 
-	NXMLSettings::AppendChildToParent(pe,pRoot);
-	pe->Release();
-	pe = nullptr;
-
-	SaveWindowPositionToXML(pXMLDom,pRoot);
+	SaveWindowPositionToXML(writer);
 }
 
-int Explorerplusplus::LoadTabSettingsFromXML(IXMLDOMDocument *pXMLDom)
+int Explorerplusplus::LoadTabSettingsFromXML(const XmlSections &sections)
 {
-	IXMLDOMNodeList		*pNodes = nullptr;
-	IXMLDOMNode			*pNode = nullptr;
-	IXMLDOMNode			*pColumnsNode = nullptr;
-	IXMLDOMNode			*pColumnNode = nullptr;
-	IXMLDOMNamedNodeMap	*am = nullptr;
-	IXMLDOMNode			*pChildNode = nullptr;
-	BSTR				bstrName;
-	BSTR				bstrValue;
-	BSTR				bstr = nullptr;
-	HRESULT				hr;
-	TCHAR				szDirectory[MAX_PATH];
-	FolderColumns		initialColumns;
-	long				length;
-	long				lChildNodes;
-	long				j = 0;
-	int					nTabsCreated = 0;
-
-	if(pXMLDom == nullptr)
-		goto clean;
-
-	bstr = SysAllocString(L"//Tabs/*");
-	pXMLDom->selectNodes(bstr,&pNodes);
-
-	if(!pNodes)
+	auto reader = sections.OpenSection(L"Tabs");
+	int nTabsCreated = 0;
+
+	if(!reader)
 	{
-		goto clean;
+		return nTabsCreated;
 	}
-	else
+
+	int depth = reader->GetDepth();
+	int i = 0;
+
+	while(reader->ReadChildElement(depth))
 	{
-		pNodes->get_length(&length);
+		TabSettings tabSettings;
+		FolderSettings folderSettings;
+		FolderColumns initialColumns;
+		std::wstring directory;
 
-		for(long i = 0;i < length;i++)
-		{
-			/* This should never fail, as the number
-			of nodes has already been counted (so
-			they must exist). */
-			hr = pNodes->get_item(i,&pNode);
+		tabSettings.index = i++;
 
-			TabSettings tabSettings;
-			FolderSettings folderSettings;
+		/* The tab that was selected will be
+		reselected (and loaded) by RestoreTabs().
+		The other tabs are only loaded once
+		they're used. */
+		tabSettings.deferLoad = true;
 
-			initialColumns = {};
+		for(size_t j = 0;j < reader->GetNumAttributes();j++)
+		{
+			const std::wstring &name = reader->GetAttributeName(j);
+			const std::wstring &value = reader->GetAttributeValue(j);
+
+			/* The name attribute is just a tab number
+			(0,1,2...). This number can be safely
+			ignored, as MapTabAttributeValue() doesn't
+			recognize it. */
+			if(name == L"Directory")
+				directory = value;
+			else
+				MapTabAttributeValue(name.c_str(),value.c_str(),tabSettings,folderSettings);
+		}
 
-			if(SUCCEEDED(hr))
+		int tabDepth = reader->GetDepth();
+
+		while(reader->ReadChildElement(tabDepth))
+		{
+			if(reader->GetName() != L"Columns")
 			{
-				hr = pNode->get_attributes(&am);
+				continue;
+			}
 
-				if(SUCCEEDED(hr))
-				{
-					tabSettings.index = i;
-					tabSettings.selected = true;
+			int columnsDepth = reader->GetDepth();
+			std::vector<Column_t> column;
+			int iColumnType;
 
-					/* Retrieve the total number of attributes
-					attached to this node. */
-					am->get_length(&lChildNodes);
+			while(reader->ReadChildElement(columnsDepth))
+			{
+				iColumnType = LoadColumnFromXML(*reader,column);
 
-					/* For each tab, the first attribute will just be
-					a tab number (0,1,2...). This number can be safely
-					ignored. */
-					for(j = 1;j < lChildNodes;j++)
-					{
-						am->get_item(j,&pChildNode);
+				switch(iColumnType)
+				{
+				case COLUMN_TYPE_GENERIC:
+					initialColumns.realFolderColumns = column;
+					break;
 
-						/* Element name. */
-						pChildNode->get_nodeName(&bstrName);
+				case COLUMN_TYPE_MYCOMPUTER:
+					initialColumns.myComputerColumns = column;
+					break;
 
-						/* Element value. */
-						pChildNode->get_text(&bstrValue);
+				case COLUMN_TYPE_CONTROLPANEL:
+					initialColumns.controlPanelColumns = column;
+					break;
 
-						if(lstrcmp(bstrName,L"Directory") == 0)
-							StringCchCopy(szDirectory,SIZEOF_ARRAY(szDirectory),bstrValue);
-						else
-							MapTabAttributeValue(bstrName,bstrValue,tabSettings,folderSettings);
-					}
+				case COLUMN_TYPE_RECYCLEBIN:
+					initialColumns.recycleBinColumns = column;
+					break;
 
-					hr = pNode->get_firstChild(&pColumnsNode);
+				case COLUMN_TYPE_PRINTERS:
+					initialColumns.printersColumns = column;
+					break;
 
-					if(hr == S_OK)
-					{
-						hr = pColumnsNode->get_nextSibling(&pColumnsNode);
-
-						if(hr == S_OK)
-						{
-							hr = pColumnsNode->get_firstChild(&pColumnNode);
-
-							if(hr == S_OK)
-							{
-								pColumnNode->get_nextSibling(&pColumnNode);
-
-								std::vector<Column_t> column;
-								int iColumnType;
-
-								while(pColumnNode != nullptr)
-								{
-									iColumnType = LoadColumnFromXML(pColumnNode,column);
-
-									switch(iColumnType)
-									{
-									case COLUMN_TYPE_GENERIC:
-										initialColumns.realFolderColumns = column;
-										break;
-
-									case COLUMN_TYPE_MYCOMPUTER:
-										initialColumns.myComputerColumns = column;
-										break;
-
-									case COLUMN_TYPE_CONTROLPANEL:
-										initialColumns.controlPanelColumns = column;
-										break;
-
-									case COLUMN_TYPE_RECYCLEBIN:
-										initialColumns.recycleBinColumns = column;
-										break;
-
-									case COLUMN_TYPE_PRINTERS:
-										initialColumns.printersColumns = column;
-										break;
-
-									case COLUMN_TYPE_NETWORK:
-										initialColumns.networkConnectionsColumns = column;
-										break;
-
-									case COLUMN_TYPE_NETWORKPLACES:
-										initialColumns.myNetworkPlacesColumns = column;
-										break;
-									}
-
-									pColumnNode->get_nextSibling(&pColumnNode);
-									pColumnNode->get_nextSibling(&pColumnNode);
-								}
-							}
-						}
-					}
+				case COLUMN_TYPE_NETWORK:
+					initialColumns.networkConnectionsColumns = column;
+					break;
 
-					ValidateSingleColumnSet(VALIDATE_REALFOLDER_COLUMNS, initialColumns.realFolderColumns);
-					ValidateSingleColumnSet(VALIDATE_CONTROLPANEL_COLUMNS, initialColumns.controlPanelColumns);
-					ValidateSingleColumnSet(VALIDATE_MYCOMPUTER_COLUMNS, initialColumns.myComputerColumns);
-					ValidateSingleColumnSet(VALIDATE_RECYCLEBIN_COLUMNS, initialColumns.recycleBinColumns);
-					ValidateSingleColumnSet(VALIDATE_PRINTERS_COLUMNS, initialColumns.printersColumns);
-					ValidateSingleColumnSet(VALIDATE_NETWORKCONNECTIONS_COLUMNS, initialColumns.networkConnectionsColumns);
-					ValidateSingleColumnSet(VALIDATE_MYNETWORKPLACES_COLUMNS, initialColumns.myNetworkPlacesColumns);
+				case COLUMN_TYPE_NETWORKPLACES:
+					initialColumns.myNetworkPlacesColumns = column;
+					break;
 				}
 			}
+		}
 
-			hr = m_tabContainer->CreateNewTab(szDirectory, tabSettings, &folderSettings, initialColumns);
+		ValidateSingleColumnSet(VALIDATE_REALFOLDER_COLUMNS, initialColumns.realFolderColumns);
+		ValidateSingleColumnSet(VALIDATE_CONTROLPANEL_COLUMNS, initialColumns.controlPanelColumns);
+		ValidateSingleColumnSet(VALIDATE_MYCOMPUTER_COLUMNS, initialColumns.myComputerColumns);
+		ValidateSingleColumnSet(VALIDATE_RECYCLEBIN_COLUMNS, initialColumns.recycleBinColumns);
+		ValidateSingleColumnSet(VALIDATE_PRINTERS_COLUMNS, initialColumns.printersColumns);
+		ValidateSingleColumnSet(VALIDATE_NETWORKCONNECTIONS_COLUMNS, initialColumns.networkConnectionsColumns);
+		ValidateSingleColumnSet(VALIDATE_MYNETWORKPLACES_COLUMNS, initialColumns.myNetworkPlacesColumns);
 
-			if(hr == S_OK)
-				nTabsCreated++;
+		HRESULT hr = m_tabContainer->CreateNewTab(directory.c_str(), tabSettings, &folderSettings, initialColumns);
 
-			pNode->Release();
-			pNode = nullptr;
-		}
+		if(hr == S_OK)
+			nTabsCreated++;
 	}
 
-clean:
-	if (bstr) SysFreeString(bstr);
-	if (pNodes) pNodes->Release();
-	if (pNode) pNode->Release();
-
 	return nTabsCreated;
 }
 
-void Explorerplusplus::SaveTabSettingsToXML(IXMLDOMDocument *pXMLDom,
-IXMLDOMElement *pRoot)
+void Explorerplusplus::SaveTabSettingsToXML(XmlStreamWriter &writer)
 {
-	IXMLDOMElement	*pe = nullptr;
-	BSTR					bstr = nullptr;
-	BSTR					bstr_wsnt= SysAllocString(L"\n\t");
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsnt,pRoot);
-
-	bstr = SysAllocString(L"Tabs");
-	pXMLDom->createElement(bstr,&pe);
-	SysFreeString(bstr);
-	bstr = nullptr;
+	TCHAR	szNodeName[32];
+	UINT	sortMode;
+	UINT	viewMode;
+	int		tabNum = 0;
 
-	SaveTabSettingsToXMLnternal(pXMLDom,pe);
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsnt,pe);
-
-	NXMLSettings::AppendChildToParent(pe,pRoot);
-	pe->Release();
-	pe = nullptr;
-}
-
-void Explorerplusplus::SaveTabSettingsToXMLnternal(IXMLDOMDocument *pXMLDom,IXMLDOMElement *pe)
-{
-	IXMLDOMElement	*pParentNode = nullptr;
-	IXMLDOMElement	*pColumnsNode = nullptr;
-	BSTR					bstr_wsntt = SysAllocString(L"\n\t\t");
-	BSTR					bstr_wsnttt = SysAllocString(L"\n\t\t\t");
-	BSTR					bstr = nullptr;
-	TCHAR					szNodeName[32];
-	UINT					sortMode;
-	UINT					viewMode;
-	int						tabNum = 0;
+	writer.StartElement(L"Tabs");
 
 	for (auto tabRef : m_tabContainer->GetAllTabsInOrder())
 	{
 		auto &tab = tabRef.get();
 
-		NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-
 		StringCchPrintf(szNodeName, SIZEOF_ARRAY(szNodeName), _T("%d"), tabNum);
-		NXMLSettings::CreateElementNode(pXMLDom,&pParentNode,pe,_T("Tab"),szNodeName);
-
-		std::wstring tabDirectory = tab.GetShellBrowser()->GetDirectory();
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("Directory"), tabDirectory.c_str());
-
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("ApplyFilter"),
-			NXMLSettings::EncodeBoolValue(tab.GetShellBrowser()->GetFilterStatus()));
+		NXMLSettings::StartNamedElement(writer,_T("Tab"),szNodeName);
 
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("AutoArrange"),
-			NXMLSettings::EncodeBoolValue(tab.GetShellBrowser()->GetAutoArrange()));
+		/* Tabs that haven't been loaded yet can
+		be saved without loading them. */
+		std::wstring tabDirectory = tab.GetDirectory();
+		writer.WriteAttribute(_T("Directory"), tabDirectory);
 
-		std::wstring filter = tab.GetShellBrowser()->GetFilter();
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("Filter"),filter.c_str());
+		FolderSettings folderSettings = tab.GetFolderSettings();
 
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("FilterCaseSensitive"),
-			NXMLSettings::EncodeBoolValue(tab.GetShellBrowser()->GetFilterCaseSensitive()));
+		writer.WriteAttribute(_T("ApplyFilter"),
+			NXMLSettings::EncodeBoolValue(folderSettings.applyFilter));
 
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("ShowHidden"),
-			NXMLSettings::EncodeBoolValue(tab.GetShellBrowser()->GetShowHidden()));
+		writer.WriteAttribute(_T("AutoArrange"),
+			NXMLSettings::EncodeBoolValue(folderSettings.autoArrange));
 
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("ShowInGroups"),
-			NXMLSettings::EncodeBoolValue(tab.GetShellBrowser()->GetShowInGroups()));
+		writer.WriteAttribute(_T("Filter"),folderSettings.filter);
 
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("SortAscending"),
-			NXMLSettings::EncodeBoolValue(tab.GetShellBrowser()->GetSortAscending()));
+		writer.WriteAttribute(_T("FilterCaseSensitive"),
+			NXMLSettings::EncodeBoolValue(folderSettings.filterCaseSensitive));
 
-		sortMode = tab.GetShellBrowser()->GetSortMode();
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("SortMode"),NXMLSettings::EncodeIntValue(sortMode));
+		writer.WriteAttribute(_T("ShowHidden"),
+			NXMLSettings::EncodeBoolValue(folderSettings.showHidden));
 
-		viewMode = tab.GetShellBrowser()->GetViewMode();
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("ViewMode"),NXMLSettings::EncodeIntValue(viewMode));
+		writer.WriteAttribute(_T("ShowInGroups"),
+			NXMLSettings::EncodeBoolValue(folderSettings.showInGroups));
 
-		bstr = SysAllocString(L"Columns");
-		pXMLDom->createElement(bstr,&pColumnsNode);
-		SysFreeString(bstr);
-		bstr = nullptr;
+		writer.WriteAttribute(_T("SortAscending"),
+			NXMLSettings::EncodeBoolValue(folderSettings.sortAscending));
 
-		auto folderColumns = tab.GetShellBrowser()->ExportAllColumns();
+		sortMode = folderSettings.sortMode;
+		writer.WriteAttribute(_T("SortMode"),NXMLSettings::EncodeIntValue(sortMode));
 
-		int TAB_INDENT = 4;
-
-		SaveColumnToXML(pXMLDom,pColumnsNode, folderColumns.realFolderColumns, _T("Generic"), TAB_INDENT);
-		SaveColumnToXML(pXMLDom,pColumnsNode, folderColumns.myComputerColumns, _T("MyComputer"), TAB_INDENT);
-		SaveColumnToXML(pXMLDom,pColumnsNode, folderColumns.controlPanelColumns, _T("ControlPanel"), TAB_INDENT);
-		SaveColumnToXML(pXMLDom,pColumnsNode, folderColumns.recycleBinColumns, _T("RecycleBin"), TAB_INDENT);
-		SaveColumnToXML(pXMLDom,pColumnsNode, folderColumns.printersColumns, _T("Printers"), TAB_INDENT);
-		SaveColumnToXML(pXMLDom,pColumnsNode, folderColumns.networkConnectionsColumns, _T("Network"), TAB_INDENT);
-		SaveColumnToXML(pXMLDom,pColumnsNode, folderColumns.myNetworkPlacesColumns, _T("NetworkPlaces"), TAB_INDENT);
-
-		NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsnttt,pColumnsNode);
+		viewMode = folderSettings.viewMode;
+		writer.WriteAttribute(_T("ViewMode"),NXMLSettings::EncodeIntValue(viewMode));
 
 		/* High-level settings. */
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("Locked"),
+		writer.WriteAttribute(_T("Locked"),
 			NXMLSettings::EncodeBoolValue(tab.GetLockState() == Tab::LockState::Locked));
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("AddressLocked"),
+		writer.WriteAttribute(_T("AddressLocked"),
 			NXMLSettings::EncodeBoolValue(tab.GetLockState() == Tab::LockState::AddressLocked));
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("UseCustomName"),
+		writer.WriteAttribute(_T("UseCustomName"),
 			NXMLSettings::EncodeBoolValue(tab.GetUseCustomName()));
 
 		if(tab.GetUseCustomName())
-			NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("CustomName"), tab.GetName().c_str());
+			writer.WriteAttribute(_T("CustomName"), tab.GetName());
 		else
-			NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("CustomName"), EMPTY_STRING);
+			writer.WriteAttribute(_T("CustomName"), EMPTY_STRING);
+
+		writer.StartElement(L"Columns");
 
-		NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsnttt,pParentNode);
+		auto folderColumns = tab.GetFolderColumns();
 
-		NXMLSettings::AppendChildToParent(pColumnsNode,pParentNode);
-		pColumnsNode->Release();
-		pColumnsNode = nullptr;
+		SaveColumnToXML(writer, folderColumns.realFolderColumns, _T("Generic"));
+		SaveColumnToXML(writer, folderColumns.myComputerColumns, _T("MyComputer"));
+		SaveColumnToXML(writer, folderColumns.controlPanelColumns, _T("ControlPanel"));
+		SaveColumnToXML(writer, folderColumns.recycleBinColumns, _T("RecycleBin"));
+		SaveColumnToXML(writer, folderColumns.printersColumns, _T("Printers"));
+		SaveColumnToXML(writer, folderColumns.networkConnectionsColumns, _T("Network"));
+		SaveColumnToXML(writer, folderColumns.myNetworkPlacesColumns, _T("NetworkPlaces"));
 
-		NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pParentNode);
+		writer.EndElement();
 
-		pParentNode->Release();
-		pParentNode = nullptr;
+		writer.EndElement();
 
 		tabNum++;
 	}
 
-	SysFreeString(bstr_wsntt);
-	SysFreeString(bstr_wsnttt);
+	writer.EndElement();
 }
 
-int Explorerplusplus::LoadColumnFromXML(IXMLDOMNode *pNode, std::vector<Column_t> &outputColumns)
+int Explorerplusplus::LoadColumnFromXML(const XmlStreamReader &reader,
+	std::vector<Column_t> &outputColumns)
 {
-	IXMLDOMNamedNodeMap	*am = nullptr;
-	IXMLDOMNode			*pAttributeNode = nullptr;
-	Column_t					column;
-	BSTR						bstrName;
-	BSTR						bstrValue;
-	TCHAR						szWidth[32];
-	HRESULT						hr;
-	long						nAttributeNodes;
-	int							iColumnType = -1;
-	long						i = 0;
+	Column_t	column;
+	TCHAR		szWidth[32];
+	int			iColumnType = -1;
 
 	outputColumns.clear();
 
-	hr = pNode->get_attributes(&am);
-
-	if(FAILED(hr))
-		return -1;
-
-	/* Retrieve the total number of attributes
-	attached to this node. */
-	am->get_length(&nAttributeNodes);
-
-	for(i = 0;i < nAttributeNodes;i++)
+	for(size_t i = 0;i < reader.GetNumAttributes();i++)
 	{
-		am->get_item(i, &pAttributeNode);
-
-		/* Element name. */
-		pAttributeNode->get_nodeName(&bstrName);
+		const std::wstring &name = reader.GetAttributeName(i);
+		const WCHAR *value = reader.GetAttributeValue(i).c_str();
 
-		/* Element value. */
-		pAttributeNode->get_text(&bstrValue);
-
-		if(lstrcmp(bstrName,_T("name")) == 0)
+		if(name == _T("name"))
 		{
-			if(lstrcmp(bstrValue,_T("Generic")) == 0)
+			if(lstrcmp(value,_T("Generic")) == 0)
 				iColumnType = COLUMN_TYPE_GENERIC;
-			else if(lstrcmp(bstrValue,_T("MyComputer")) == 0)
+			else if(lstrcmp(value,_T("MyComputer")) == 0)
 				iColumnType = COLUMN_TYPE_MYCOMPUTER;
-			else if(lstrcmp(bstrValue,_T("ControlPanel")) == 0)
+			else if(lstrcmp(value,_T("ControlPanel")) == 0)
 				iColumnType = COLUMN_TYPE_CONTROLPANEL;
-			else if(lstrcmp(bstrValue,_T("RecycleBin")) == 0)
+			else if(lstrcmp(value,_T("RecycleBin")) == 0)
 				iColumnType = COLUMN_TYPE_RECYCLEBIN;
-			else if(lstrcmp(bstrValue,_T("Printers")) == 0)
+			else if(lstrcmp(value,_T("Printers")) == 0)
 				iColumnType = COLUMN_TYPE_PRINTERS;
-			else if(lstrcmp(bstrValue,_T("Network")) == 0)
+			else if(lstrcmp(value,_T("Network")) == 0)
 				iColumnType = COLUMN_TYPE_NETWORK;
-			else if(lstrcmp(bstrValue,_T("NetworkPlaces")) == 0)
+			else if(lstrcmp(value,_T("NetworkPlaces")) == 0)
 				iColumnType = COLUMN_TYPE_NETWORKPLACES;
 		}
 		else
@@ -965,20 +831,20 @@ int Explorerplusplus::LoadColumnFromXML(IXMLDOMNode *pNode, std::vector<Column_t
 			{
 				StringCchPrintf(szWidth,SIZEOF_ARRAY(szWidth),_T("%s_Width"),ColumnData[j].szName);
 
-				if(lstrcmp(bstrName,ColumnData[j].szName) == 0)
+				if(name == ColumnData[j].szName)
 				{
 					column.type = ColumnData[j].type;
 
-					column.bChecked	= NXMLSettings::DecodeBoolValue(bstrValue);
+					column.bChecked	= NXMLSettings::DecodeBoolValue(value);
 
 					outputColumns.push_back(column);
 					break;
 				}
-				else if(lstrcmp(bstrName,szWidth) == 0)
+				else if(name == szWidth)
 				{
 					if(!outputColumns.empty())
 					{
-						outputColumns.back().iWidth = NXMLSettings::DecodeIntValue(bstrValue);
+						outputColumns.back().iWidth = NXMLSettings::DecodeIntValue(value);
 					}
 
 					break;
@@ -990,150 +856,94 @@ int Explorerplusplus::LoadColumnFromXML(IXMLDOMNode *pNode, std::vector<Column_t
 	return iColumnType;
 }
 
-void Explorerplusplus::LoadBookmarksFromXML(IXMLDOMDocument *pXMLDom)
+void Explorerplusplus::LoadBookmarksFromXML(const XmlSections &sections)
 {
-	BookmarkXmlStorage::Load(pXMLDom, &m_bookmarkTree);
+	BookmarkXmlStorage::Load(sections, &m_bookmarkTree);
 }
 
-void Explorerplusplus::SaveBookmarksToXML(IXMLDOMDocument *pXMLDom,
-IXMLDOMElement *pRoot)
+void Explorerplusplus::SaveBookmarksToXML(XmlStreamWriter &writer)
 {
-	BookmarkXmlStorage::Save(pXMLDom, pRoot, &m_bookmarkTree, 1);
+	BookmarkXmlStorage::Save(writer, &m_bookmarkTree);
 }
 
-int Explorerplusplus::LoadDefaultColumnsFromXML(IXMLDOMDocument *pXMLDom)
+int Explorerplusplus::LoadDefaultColumnsFromXML(const XmlSections &sections)
 {
-	IXMLDOMNodeList	*pNodes = nullptr;
-	IXMLDOMNode		*pNode = nullptr;
-	BSTR			bstr = nullptr;
-	std::vector<Column_t>	columnSet;
-	long			length;
-	int				iColumnType;
-
-	if(!pXMLDom)
-		goto clean;
-
-	bstr = SysAllocString(L"//DefaultColumns/*");
-	pXMLDom->selectNodes(bstr,&pNodes);
+	auto reader = sections.OpenSection(L"DefaultColumns");
 
-	if(!pNodes)
+	if(!reader)
 	{
-		goto clean;
+		return 0;
 	}
-	else
-	{
-		pNodes->get_length(&length);
-
-		auto &folderColumns = m_config->globalFolderSettings.folderColumns;
 
-		for(long i = 0; i < length; i++)
-		{
-			pNodes->get_item(i, &pNode);
+	auto &folderColumns = m_config->globalFolderSettings.folderColumns;
+	std::vector<Column_t>	columnSet;
+	int				iColumnType;
+	int				depth = reader->GetDepth();
 
-			iColumnType = LoadColumnFromXML(pNode,columnSet);
+	while(reader->ReadChildElement(depth))
+	{
+		iColumnType = LoadColumnFromXML(*reader,columnSet);
 
-			switch(iColumnType)
-			{
-			case COLUMN_TYPE_GENERIC:
-				folderColumns.realFolderColumns = columnSet;
-				break;
+		switch(iColumnType)
+		{
+		case COLUMN_TYPE_GENERIC:
+			folderColumns.realFolderColumns = columnSet;
+			break;
 
-			case COLUMN_TYPE_MYCOMPUTER:
-				folderColumns.myComputerColumns = columnSet;
-				break;
+		case COLUMN_TYPE_MYCOMPUTER:
+			folderColumns.myComputerColumns = columnSet;
+			break;
 
-			case COLUMN_TYPE_CONTROLPANEL:
-				folderColumns.controlPanelColumns = columnSet;
-				break;
+		case COLUMN_TYPE_CONTROLPANEL:
+			folderColumns.controlPanelColumns = columnSet;
+			break;
 
-			case COLUMN_TYPE_RECYCLEBIN:
-				folderColumns.recycleBinColumns = columnSet;
-				break;
+		case COLUMN_TYPE_RECYCLEBIN:
+			folderColumns.recycleBinColumns = columnSet;
+			break;
 
-			case COLUMN_TYPE_PRINTERS:
-				folderColumns.printersColumns = columnSet;
-				break;
+		case COLUMN_TYPE_PRINTERS:
+			folderColumns.printersColumns = columnSet;
+			break;
 
-			case COLUMN_TYPE_NETWORK:
-				folderColumns.networkConnectionsColumns = columnSet;
-				break;
+		case COLUMN_TYPE_NETWORK:
+			folderColumns.networkConnectionsColumns = columnSet;
+			break;
 
-			case COLUMN_TYPE_NETWORKPLACES:
-				folderColumns.myNetworkPlacesColumns = columnSet;
-				break;
-			}
-
-			pNode->Release();
-			pNode = nullptr;
+		case COLUMN_TYPE_NETWORKPLACES:
+			folderColumns.myNetworkPlacesColumns = columnSet;
+			break;
 		}
 	}
 
-clean:
-	if (bstr) SysFreeString(bstr);
-	if (pNodes) pNodes->Release();
-	if (pNode) pNode->Release();
-
 	return 0;
 }
 
-void Explorerplusplus::SaveDefaultColumnsToXML(IXMLDOMDocument *pXMLDom,
-IXMLDOMElement *pRoot)
+void Explorerplusplus::SaveDefaultColumnsToXML(XmlStreamWriter &writer)
 {
-	IXMLDOMElement	*pColumnsNode = nullptr;
-	BSTR					bstr_wsnt = SysAllocString(L"\n\t");
-	BSTR					bstr;
-
-	bstr = SysAllocString(L"DefaultColumns");
-	pXMLDom->createElement(bstr,&pColumnsNode);
-	SysFreeString(bstr);
-	bstr = nullptr;
-
-	SaveDefaultColumnsToXMLInternal(pXMLDom,pColumnsNode);
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsnt,pColumnsNode);
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsnt,pRoot);
-
-	NXMLSettings::AppendChildToParent(pColumnsNode,pRoot);
-	pColumnsNode->Release();
-	pColumnsNode = nullptr;
-}
+	const auto &folderColumns = m_config->globalFolderSettings.folderColumns;
 
-void Explorerplusplus::SaveDefaultColumnsToXMLInternal(IXMLDOMDocument *pXMLDom,
-IXMLDOMElement *pColumnsNode)
-{
-	int DEFAULT_INDENT = 2;
+	writer.StartElement(L"DefaultColumns");
 
-	const auto &folderColumns = m_config->globalFolderSettings.folderColumns;
+	SaveColumnToXML(writer, folderColumns.realFolderColumns, _T("Generic"));
+	SaveColumnToXML(writer, folderColumns.myComputerColumns, _T("MyComputer"));
+	SaveColumnToXML(writer, folderColumns.controlPanelColumns, _T("ControlPanel"));
+	SaveColumnToXML(writer, folderColumns.recycleBinColumns, _T("RecycleBin"));
+	SaveColumnToXML(writer, folderColumns.printersColumns, _T("Printers"));
+	SaveColumnToXML(writer, folderColumns.networkConnectionsColumns, _T("Network"));
+	SaveColumnToXML(writer, folderColumns.myNetworkPlacesColumns, _T("NetworkPlaces"));
 
-	SaveColumnToXML(pXMLDom,pColumnsNode, folderColumns.realFolderColumns, _T("Generic"), DEFAULT_INDENT);
-	SaveColumnToXML(pXMLDom,pColumnsNode, folderColumns.myComputerColumns, _T("MyComputer"), DEFAULT_INDENT);
-	SaveColumnToXML(pXMLDom,pColumnsNode, folderColumns.controlPanelColumns, _T("ControlPanel"), DEFAULT_INDENT);
-	SaveColumnToXML(pXMLDom,pColumnsNode, folderColumns.recycleBinColumns, _T("RecycleBin"), DEFAULT_INDENT);
-	SaveColumnToXML(pXMLDom,pColumnsNode, folderColumns.printersColumns, _T("Printers"), DEFAULT_INDENT);
-	SaveColumnToXML(pXMLDom,pColumnsNode, folderColumns.networkConnectionsColumns, _T("Network"), DEFAULT_INDENT);
-	SaveColumnToXML(pXMLDom,pColumnsNode, folderColumns.myNetworkPlacesColumns, _T("NetworkPlaces"), DEFAULT_INDENT);
+	writer.EndElement();
 }
 
-void Explorerplusplus::SaveColumnToXML(IXMLDOMDocument *pXMLDom,
-	IXMLDOMElement *pColumnsNode, const std::vector<Column_t> &columns,
-	const TCHAR *szColumnSet, int iIndent)
+void Explorerplusplus::SaveColumnToXML(XmlStreamWriter &writer,
+	const std::vector<Column_t> &columns, const TCHAR *szColumnSet)
 {
-	IXMLDOMElement	*pColumnNode = nullptr;
 	TCHAR			*pszColumnSaveName = nullptr;
-	WCHAR			wszIndent[128];
 	TCHAR			szWidth[32];
-	BSTR			bstr_indent = SysAllocString(L"\n\t\t\t\t");
 	int				i = 0;
 
-	StringCchPrintf(wszIndent,SIZEOF_ARRAY(wszIndent),L"\n");
-
-	for(i = 0;i < iIndent;i++)
-		StringCchCat(wszIndent,SIZEOF_ARRAY(wszIndent),L"\t");
-
-	bstr_indent = SysAllocString(wszIndent);
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_indent,pColumnsNode);
-	NXMLSettings::CreateElementNode(pXMLDom,&pColumnNode,pColumnsNode,_T("Column"),szColumnSet);
+	NXMLSettings::StartNamedElement(writer,_T("Column"),szColumnSet);
 
 	for(auto itr = columns.begin();itr != columns.end();itr++)
 	{
@@ -1146,610 +956,500 @@ void Explorerplusplus::SaveColumnToXML(IXMLDOMDocument *pXMLDom,
 			}
 		}
 
-		NXMLSettings::AddAttributeToNode(pXMLDom,pColumnNode,pszColumnSaveName,NXMLSettings::EncodeBoolValue(itr->bChecked));
+		writer.WriteAttribute(pszColumnSaveName,NXMLSettings::EncodeBoolValue(itr->bChecked));
 
 		StringCchPrintf(szWidth,SIZEOF_ARRAY(szWidth),_T("%s_Width"),pszColumnSaveName);
-		NXMLSettings::AddAttributeToNode(pXMLDom,pColumnNode,szWidth,NXMLSettings::EncodeIntValue(itr->iWidth));
+		writer.WriteAttribute(szWidth,NXMLSettings::EncodeIntValue(itr->iWidth));
 	}
 
-	SysFreeString(bstr_indent);
+	writer.EndElement();
 }
 
-void Explorerplusplus::SaveWindowPositionToXML(IXMLDOMDocument *pXMLDom,
-IXMLDOMElement *pRoot)
+void Explorerplusplus::SaveWindowPositionToXML(XmlStreamWriter &writer)
 {
-	IXMLDOMElement	*pWndPosNode = nullptr;
-	BSTR					bstr_wsnt = SysAllocString(L"\n\t");
-	BSTR					bstr;
-
-	bstr = SysAllocString(L"WindowPosition");
-	pXMLDom->createElement(bstr,&pWndPosNode);
-	SysFreeString(bstr);
-	bstr = nullptr;
-
-	SaveWindowPositionToXMLInternal(pXMLDom,pWndPosNode);
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsnt,pWndPosNode);
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsnt,pRoot);
-
-	NXMLSettings::AppendChildToParent(pWndPosNode,pRoot);
-	pWndPosNode->Release();
-	pWndPosNode = nullptr;
-}
-
-void Explorerplusplus::SaveWindowPositionToXMLInternal(IXMLDOMDocument *pXMLDom,
-IXMLDOMElement *pWndPosNode)
-{
-	IXMLDOMElement	*pParentNode = nullptr;
 	WINDOWPLACEMENT			wndpl;
-	BSTR					bstr_wsntt = SysAllocString(L"\n\t\t");
 
 	wndpl.length = sizeof(WINDOWPLACEMENT);
 	GetWindowPlacement(m_hContainer,&wndpl);
 
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pWndPosNode);
-
-	NXMLSettings::CreateElementNode(pXMLDom,&pParentNode,pWndPosNode,_T("Setting"),_T("Position"));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("Flags"),NXMLSettings::EncodeIntValue(wndpl.flags));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("ShowCmd"),NXMLSettings::EncodeIntValue(wndpl.showCmd));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("MinPositionX"),NXMLSettings::EncodeIntValue(wndpl.ptMinPosition.x));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("MinPositionY"),NXMLSettings::EncodeIntValue(wndpl.ptMinPosition.y));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("MaxPositionX"),NXMLSettings::EncodeIntValue(wndpl.ptMaxPosition.x));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("MaxPositionY"),NXMLSettings::EncodeIntValue(wndpl.ptMaxPosition.y));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("NormalPositionLeft"),NXMLSettings::EncodeIntValue(wndpl.rcNormalPosition.left));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("NormalPositionTop"),NXMLSettings::EncodeIntValue(wndpl.rcNormalPosition.top));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("NormalPositionRight"),NXMLSettings::EncodeIntValue(wndpl.rcNormalPosition.right));
-	NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("NormalPositionBottom"),NXMLSettings::EncodeIntValue(wndpl.rcNormalPosition.bottom));
-
-	pParentNode->Release();
-	pParentNode = nullptr;
+	writer.StartElement(L"WindowPosition");
+
+	NXMLSettings::StartNamedElement(writer,_T("Setting"),_T("Position"));
+	writer.WriteAttribute(_T("Flags"),NXMLSettings::EncodeIntValue(wndpl.flags));
+	writer.WriteAttribute(_T("ShowCmd"),NXMLSettings::EncodeIntValue(wndpl.showCmd));
+	writer.WriteAttribute(_T("MinPositionX"),NXMLSettings::EncodeIntValue(wndpl.ptMinPosition.x));
+	writer.WriteAttribute(_T("MinPositionY"),NXMLSettings::EncodeIntValue(wndpl.ptMinPosition.y));
+	writer.WriteAttribute(_T("MaxPositionX"),NXMLSettings::EncodeIntValue(wndpl.ptMaxPosition.x));
+	writer.WriteAttribute(_T("MaxPositionY"),NXMLSettings::EncodeIntValue(wndpl.ptMaxPosition.y));
+	writer.WriteAttribute(_T("NormalPositionLeft"),NXMLSettings::EncodeIntValue(wndpl.rcNormalPosition.left));
+	writer.WriteAttribute(_T("NormalPositionTop"),NXMLSettings::EncodeIntValue(wndpl.rcNormalPosition.top));
+	writer.WriteAttribute(_T("NormalPositionRight"),NXMLSettings::EncodeIntValue(wndpl.rcNormalPosition.right));
+	writer.WriteAttribute(_T("NormalPositionBottom"),NXMLSettings::EncodeIntValue(wndpl.rcNormalPosition.bottom));
+	writer.EndElement();
+
+	writer.EndElement();
 }
 
-void Explorerplusplus::LoadToolbarInformationFromXML(IXMLDOMDocument *pXMLDom)
+void Explorerplusplus::LoadToolbarInformationFromXML(const XmlSections &sections)
 {
-	IXMLDOMNodeList		*pNodes = nullptr;
-	IXMLDOMNode			*pNode = nullptr;
-	IXMLDOMNamedNodeMap	*am = nullptr;
-	IXMLDOMNode			*pChildNode = nullptr;
-	BSTR						bstrName;
-	BSTR						bstrValue;
-	BSTR						bstr = nullptr;
-	HRESULT						hr;
-	long						length;
-	long						lChildNodes;
-	long						j = 0;
-
-	if(pXMLDom == nullptr)
-		goto clean;
-
-	bstr = SysAllocString(L"//Toolbars/*");
-	pXMLDom->selectNodes(bstr,&pNodes);
-
-	if(!pNodes)
+	auto reader = sections.OpenSection(L"Toolbars");
+
+	if(!reader)
 	{
-		goto clean;
+		return;
 	}
-	else
-	{
-		pNodes->get_length(&length);
-
-		for(long i = 0;i < length;i++)
-		{
-			/* This should never fail, as the number
-			of nodes has already been counted (so
-			they must exist). */
-			hr = pNodes->get_item(i,&pNode);
-
-			if(SUCCEEDED(hr))
-			{
-				hr = pNode->get_attributes(&am);
-
-				if(SUCCEEDED(hr))
-				{
-					BOOL bUseChevron = FALSE;
-
-					if(m_ToolbarInformation[i].fStyle & RBBS_USECHEVRON)
-						bUseChevron = TRUE;
-
-					/* Retrieve the total number of attributes
-					attached to this node. */
-					am->get_length(&lChildNodes);
-
-					/* For each tab, the first attribute will just be
-					a toolbar number (0,1,2...). This number can be safely
-					ignored. */
-					for(j = 1;j < lChildNodes;j++)
-					{
-						am->get_item(j,&pChildNode);
 
-						/* Element name. */
-						pChildNode->get_nodeName(&bstrName);
+	int depth = reader->GetDepth();
+	int i = 0;
 
-						/* Element value. */
-						pChildNode->get_text(&bstrValue);
-
-						if(lstrcmp(bstrName,L"id") == 0)
-							m_ToolbarInformation[i].wID = NXMLSettings::DecodeIntValue(bstrValue);
-						else if(lstrcmp(bstrName,L"Style") == 0)
-							m_ToolbarInformation[i].fStyle = NXMLSettings::DecodeIntValue(bstrValue);
-						else if(lstrcmp(bstrName,L"Length") == 0)
-							m_ToolbarInformation[i].cx = NXMLSettings::DecodeIntValue(bstrValue);
-					}
+	for(;reader->ReadChildElement(depth);i++)
+	{
+		BOOL bUseChevron = FALSE;
 
-					if(bUseChevron)
-						m_ToolbarInformation[i].fStyle |= RBBS_USECHEVRON;
-				}
-			}
+		if(m_ToolbarInformation[i].fStyle & RBBS_USECHEVRON)
+			bUseChevron = TRUE;
 
-			pNode->Release();
-			pNode = nullptr;
+		for(size_t j = 0;j < reader->GetNumAttributes();j++)
+		{
+			const std::wstring &name = reader->GetAttributeName(j);
+			const WCHAR *value = reader->GetAttributeValue(j).c_str();
+
+			/* The name attribute is just a toolbar number
+			(0,1,2...), so it isn't checked for here. */
+			if(name == L"id")
+				m_ToolbarInformation[i].wID = NXMLSettings::DecodeIntValue(value);
+			else if(name == L"Style")
+				m_ToolbarInformation[i].fStyle = NXMLSettings::DecodeIntValue(value);
+			else if(name == L"Length")
+				m_ToolbarInformation[i].cx = NXMLSettings::DecodeIntValue(value);
 		}
-	}
-
-clean:
-	if (bstr) SysFreeString(bstr);
-	if (pNodes) pNodes->Release();
-	if (pNode) pNode->Release();
-}
-
-void Explorerplusplus::SaveToolbarInformationToXML(IXMLDOMDocument *pXMLDom,
-IXMLDOMElement *pRoot)
-{
-	IXMLDOMElement	*pe = nullptr;
-	BSTR					bstr = nullptr;
-	BSTR					bstr_wsnt = SysAllocString(L"\n\t");
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsnt,pRoot);
-
-	bstr = SysAllocString(L"Toolbars");
-	pXMLDom->createElement(bstr,&pe);
-	SysFreeString(bstr);
-	bstr = nullptr;
 
-	SaveToolbarInformationToXMLnternal(pXMLDom,pe);
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsnt,pe);
-
-	NXMLSettings::AppendChildToParent(pe,pRoot);
-	pe->Release();
-	pe = nullptr;
+		if(bUseChevron)
+			m_ToolbarInformation[i].fStyle |= RBBS_USECHEVRON;
+	}
 }
 
-void Explorerplusplus::SaveToolbarInformationToXMLnternal(IXMLDOMDocument *pXMLDom,
-IXMLDOMElement *pe)
+void Explorerplusplus::SaveToolbarInformationToXML(XmlStreamWriter &writer)
 {
-	IXMLDOMElement	*pParentNode = nullptr;
-	BSTR					bstr_wsntt = SysAllocString(L"\n\t\t");
-	BSTR					bstr_wsnttt = SysAllocString(L"\n\t\t\t");
 	REBARBANDINFO			rbi;
 	TCHAR					szNodeName[32];
 	int						nBands;
 	int						i = 0;
 
+	writer.StartElement(L"Toolbars");
+
 	nBands = (int)SendMessage(m_hMainRebar,RB_GETBANDCOUNT,0,0);
 
 	for(i = 0;i < nBands;i++)
 	{
-		NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pe);
-
 		rbi.cbSize = sizeof(rbi);
 		rbi.fMask = RBBIM_ID|RBBIM_CHILD|RBBIM_SIZE|RBBIM_STYLE;
 		SendMessage(m_hMainRebar,RB_GETBANDINFO,i,(LPARAM)&rbi);
 
 		StringCchPrintf(szNodeName, SIZEOF_ARRAY(szNodeName), _T("%d"), i);
-		NXMLSettings::CreateElementNode(pXMLDom,&pParentNode,pe,_T("Toolbar"),szNodeName);
+		NXMLSettings::StartNamedElement(writer,_T("Toolbar"),szNodeName);
 
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("id"),
+		writer.WriteAttribute(_T("id"),
 			NXMLSettings::EncodeIntValue(rbi.wID));
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("Style"),
+		writer.WriteAttribute(_T("Style"),
 			NXMLSettings::EncodeIntValue(rbi.fStyle));
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,_T("Length"),
+		writer.WriteAttribute(_T("Length"),
 			NXMLSettings::EncodeIntValue(rbi.cx));
 
-		pParentNode->Release();
-		pParentNode = nullptr;
+		writer.EndElement();
 	}
 
-	SysFreeString(bstr_wsntt);
-	SysFreeString(bstr_wsnttt);
+	writer.EndElement();
 }
 
-void Explorerplusplus::LoadApplicationToolbarFromXML(IXMLDOMDocument *pXMLDom)
+void Explorerplusplus::LoadApplicationToolbarFromXML(const XmlSections &sections)
 {
-	IXMLDOMNodeList		*pNodes = nullptr;
-	IXMLDOMNode			*pNode = nullptr;
-	BSTR						bstr = nullptr;
-	HRESULT						hr;
+	auto reader = sections.OpenSection(L"ApplicationToolbar");
 
-	if(!pXMLDom)
-		goto clean;
-
-	bstr = SysAllocString(L"//ApplicationButton");
-	hr = pXMLDom->selectSingleNode(bstr,&pNode);
-
-	if(hr == S_OK)
+	if(reader)
 	{
-		ApplicationToolbarPersistentSettings::GetInstance().LoadXMLSettings(pNode);
+		ApplicationToolbarPersistentSettings::GetInstance().LoadXMLSettings(*reader);
 	}
+}
 
-clean:
-	if (bstr) SysFreeString(bstr);
-	if (pNodes) pNodes->Release();
-	if (pNode) pNode->Release();
+void Explorerplusplus::SaveApplicationToolbarToXML(XmlStreamWriter &writer)
+{
+	writer.StartElement(L"ApplicationToolbar");
+	ApplicationToolbarPersistentSettings::GetInstance().SaveXMLSettings(writer);
+	writer.EndElement();
 }
 
-void Explorerplusplus::SaveApplicationToolbarToXML(IXMLDOMDocument *pXMLDom,
-IXMLDOMElement *pRoot)
+/* Maps attribute name to their corresponding internal variable.
+The reader should be positioned on the element for the setting.
+The name is only used to look up the setting, before the reader
+is moved. */
+void Explorerplusplus::MapAttributeToValue(XmlStreamReader &reader,std::wstring_view wszName)
 {
-	IXMLDOMElement		*pe = nullptr;
-	BSTR						bstr_wsnt = SysAllocString(L"\n\t");
-	BSTR						bstr;
+	auto settingName = SETTING_NAMES.Find(wszName);
 
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsnt,pRoot);
+	if(!settingName)
+	{
+		return;
+	}
 
-	bstr = SysAllocString(L"ApplicationToolbar");
-	pXMLDom->createElement(bstr,&pe);
-	SysFreeString(bstr);
-	bstr = nullptr;
+	/* These settings are stored in the attributes of the
+	element, rather than in its text. */
+	switch(*settingName)
+	{
+	case SettingName::DisplayCentreColor:
+		m_config->displayWindowCentreColor = NXMLSettings::ReadXMLColorData2(reader);
+		return;
 
-	ApplicationToolbarPersistentSettings::GetInstance().SaveXMLSettings(pXMLDom,pe);
+	case SettingName::DisplayFont:
+		m_config->displayWindowFont = NXMLSettings::ReadXMLFontData(reader);
+		return;
 
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsnt,pe);
+	case SettingName::DisplaySurroundColor:
+		m_config->displayWindowSurroundColor = NXMLSettings::ReadXMLColorData2(reader);
+		return;
 
-	NXMLSettings::AppendChildToParent(pe, pRoot);
-	pe->Release();
-	pe = nullptr;
+	case SettingName::DisplayTextColor:
+		m_config->displayWindowTextColor = NXMLSettings::ReadXMLColorData(reader);
+		return;
 
-	SysFreeString(bstr_wsnt);
-}
+	case SettingName::ToolbarState:
+		MainToolbarPersistentSettings::GetInstance().LoadXMLSettings(reader);
+		return;
 
-unsigned long hash_setting(unsigned char *str)
-{
-	unsigned long hash = 5381;
-	int c;
+	case SettingName::Position:
+		{
+			WINDOWPLACEMENT wndpl;
+			BOOL		bMaximized = FALSE;
 
-	while((c = *str++) != '\0')
-		hash = ((hash << 5) + hash) + c;
+			for(size_t i = 0;i < reader.GetNumAttributes();i++)
+			{
+				const std::wstring &name = reader.GetAttributeName(i);
+				const WCHAR *value = reader.GetAttributeValue(i).c_str();
+
+				if(name == L"Left")
+					wndpl.rcNormalPosition.left = NXMLSettings::DecodeIntValue(value);
+				else if(name == L"Top")
+					wndpl.rcNormalPosition.top = NXMLSettings::DecodeIntValue(value);
+				else if(name == L"Right")
+					wndpl.rcNormalPosition.right = NXMLSettings::DecodeIntValue(value);
+				else if(name == L"Bottom")
+					wndpl.rcNormalPosition.bottom = NXMLSettings::DecodeIntValue(value);
+				else if(name == L"Maximized")
+					bMaximized = NXMLSettings::DecodeBoolValue(value);
+			}
 
-	return hash;
-}
+			wndpl.length	= sizeof(WINDOWPLACEMENT);
+			wndpl.showCmd	= SW_HIDE;
 
-/* Maps attribute name to their corresponding internal variable. */
-void Explorerplusplus::MapAttributeToValue(IXMLDOMNode *pNode,
-WCHAR *wszName,WCHAR *wszValue)
-{
-	unsigned char	szName[512];
-	unsigned long	uNameHash;
+			if(bMaximized)
+				wndpl.showCmd |= SW_MAXIMIZE;
 
-	WideCharToMultiByte(CP_ACP,0,wszName,-1,(LPSTR)szName,
-		SIZEOF_ARRAY(szName), nullptr, nullptr);
+			SetWindowPlacement(m_hContainer,&wndpl);
+		}
+		return;
 
-	uNameHash = hash_setting(szName);
+	default:
+		break;
+	}
+
+	auto value = reader.ReadElementText();
 
-	switch(uNameHash)
+	if(!value)
 	{
-	case HASH_ALLOWMULTIPLEINSTANCES:
+		return;
+	}
+
+	const WCHAR *wszValue = value->c_str();
+
+	switch(*settingName)
+	{
+	case SettingName::AllowMultipleInstances:
 		m_config->allowMultipleInstances = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_ALWAYSOPENINNEWTAB:
+	case SettingName::AlwaysOpenInNewTab:
 		m_config->alwaysOpenNewTab = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_ALWAYSSHOWTABBAR:
+	case SettingName::AlwaysShowTabBar:
 		m_config->alwaysShowTabBar.set(NXMLSettings::DecodeBoolValue(wszValue));
 		break;
 
-	case HASH_AUTOARRANGEGLOBAL:
+	case SettingName::AutoArrangeGlobal:
 		m_config->defaultFolderSettings.autoArrange = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_CHECKBOXSELECTION:
+	case SettingName::CheckBoxSelection:
 		m_config->checkBoxSelection = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_CLOSEMAINWINDOWONTABCLOSE:
+	case SettingName::CloseMainWindowOnTabClose:
 		m_config->closeMainWindowOnTabClose = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_CONFIRMCLOSETABS:
+	case SettingName::ConfirmCloseTabs:
 		m_config->confirmCloseTabs = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_DISABLEFOLDERSIZENETWORKREMOVABLE:
+	case SettingName::DisableFolderSizesNetworkRemovable:
 		m_config->globalFolderSettings.disableFolderSizesNetworkRemovable = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_DISPLAYCENTRECOLOR:
-		m_config->displayWindowCentreColor = NXMLSettings::ReadXMLColorData2(pNode);
-		break;
-
-	case HASH_DISPLAYFONT:
-		m_config->displayWindowFont = NXMLSettings::ReadXMLFontData(pNode);
-		break;
-
-	case HASH_DISPLAYSURROUNDCOLOR:
-		m_config->displayWindowSurroundColor = NXMLSettings::ReadXMLColorData2(pNode);
-		break;
-
-	case HASH_DISPLAYTEXTCOLOR:
-		m_config->displayWindowTextColor = NXMLSettings::ReadXMLColorData(pNode);
-		break;
-
-	case HASH_DISPLAYWINDOWWIDTH:
+	case SettingName::DisplayWindowWidth:
 		m_config->displayWindowWidth = NXMLSettings::DecodeIntValue(wszValue);
 		break;
 
-	case HASH_DISPLAYWINDOWHEIGHT:
+	case SettingName::DisplayWindowHeight:
 		m_config->displayWindowHeight = NXMLSettings::DecodeIntValue(wszValue);
 		break;
 
-	case HASH_DISPLAYWINDOWVERTICAL:
+	case SettingName::DisplayWindowVertical:
 		m_config->displayWindowVertical = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_DOUBLECLICKTABCLOSE:
+	case SettingName::DoubleClickTabClose:
 		m_config->doubleClickTabClose = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_EXTENDTABCONTROL:
+	case SettingName::ExtendTabControl:
 		m_config->extendTabControl = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_FORCESAMETABWIDTH:
+	case SettingName::ForceSameTabWidth:
 		m_config->forceSameTabWidth.set(NXMLSettings::DecodeBoolValue(wszValue));
 		break;
 
-	case HASH_FORCESIZE:
+	case SettingName::ForceSize:
 		m_config->globalFolderSettings.forceSize = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_HANDLEZIPFILES:
+	case SettingName::HandleZipFiles:
 		m_config->handleZipFiles = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_HIDELINKEXTENSIONGLOBAL:
+	case SettingName::HideLinkExtensionGlobal:
 		m_config->globalFolderSettings.hideLinkExtension = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_HIDESYSTEMFILESGLOBAL:
+	case SettingName::HideSystemFilesGlobal:
 		m_config->globalFolderSettings.hideSystemFiles = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_INSERTSORTED:
+	case SettingName::InsertSorted:
 		m_config->globalFolderSettings.insertSorted = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_LANGUAGE:
+	case SettingName::Language:
 		m_config->language = NXMLSettings::DecodeIntValue(wszValue);
 		m_bLanguageLoaded = true;
 		break;
 
-	case HASH_LARGETOOLBARICONS:
+	case SettingName::LargeToolbarIcons:
 		m_config->useLargeToolbarIcons.set(NXMLSettings::DecodeBoolValue(wszValue));
 		break;
 
-	case HASH_LASTSELECTEDTAB:
+	case SettingName::LastSelectedTab:
 		m_iLastSelectedTab = NXMLSettings::DecodeIntValue(wszValue);
 		break;
 
-	case HASH_LOCKTOOLBARS:
+	case SettingName::LockToolbars:
 		m_config->lockToolbars = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_NEXTTOCURRENT:
+	case SettingName::NextToCurrent:
 		m_config->openNewTabNextToCurrent = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_ONECLICKACTIVATE:
+	case SettingName::OneClickActivate:
 		m_config->globalFolderSettings.oneClickActivate = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_ONECLICKACTIVATEHOVERTIME:
+	case SettingName::OneClickActivateHoverTime:
 		m_config->globalFolderSettings.oneClickActivateHoverTime = NXMLSettings::DecodeIntValue(wszValue);
 		break;
 
-	case HASH_OVERWRITEEXISTINGFILESCONFIRMATION:
+	case SettingName::OverwriteExistingFilesConfirmation:
 		m_config->overwriteExistingFilesConfirmation = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_PLAYNAVIGATIONSOUND:
+	case SettingName::PlayNavigationSound:
 		m_config->playNavigationSound = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_REPLACEEXPLORERMODE:
+	case SettingName::PrefetchFolders:
+		m_config->prefetchFolders = NXMLSettings::DecodeBoolValue(wszValue);
+		break;
+
+	case SettingName::PersistIconCache:
+		m_config->persistIconCache = NXMLSettings::DecodeBoolValue(wszValue);
+		break;
+
+	case SettingName::EnableTracing:
+		m_config->enableTracing = NXMLSettings::DecodeBoolValue(wszValue);
+		break;
+
+	case SettingName::ThumbnailCacheSize:
+		m_config->thumbnailCacheSize = NXMLSettings::DecodeIntValue(wszValue);
+		break;
+
+	case SettingName::ThumbnailDiskCacheSize:
+		m_config->thumbnailDiskCacheSize = NXMLSettings::DecodeIntValue(wszValue);
+		break;
+
+	case SettingName::ThumbnailSize:
+		m_config->thumbnailSize = NXMLSettings::DecodeIntValue(wszValue);
+		break;
+
+	case SettingName::TabHibernationIdleTimeout:
+		m_config->tabHibernationIdleTimeout = NXMLSettings::DecodeIntValue(wszValue);
+		break;
+
+	case SettingName::TabHibernationMemoryBudget:
+		m_config->tabHibernationMemoryBudget = NXMLSettings::DecodeIntValue(wszValue);
+		break;
+
+	case SettingName::ReplaceExplorerMode:
 		m_config->replaceExplorerMode = static_cast<DefaultFileManager::ReplaceExplorerMode>(NXMLSettings::DecodeIntValue(wszValue));
 		break;
 
-	case HASH_SHOWADDRESSBAR:
+	case SettingName::ShowAddressBar:
 		m_config->showAddressBar = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWAPPLICATIONTOOLBAR:
+	case SettingName::ShowApplicationToolbar:
 		m_config->showApplicationToolbar = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWBOOKMARKSTOOLBAR:
+	case SettingName::ShowBookmarksToolbar:
 		m_config->showBookmarksToolbar = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWDRIVESTOOLBAR:
+	case SettingName::ShowDrivesToolbar:
 		m_config->showDrivesToolbar = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWDISPLAYWINDOW:
+	case SettingName::ShowDisplayWindow:
 		m_config->showDisplayWindow = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWEXTENSIONS:
+	case SettingName::ShowExtensions:
 		m_config->globalFolderSettings.showExtensions = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWFILEPREVIEWS:
+	case SettingName::ShowFilePreviews:
 		m_config->showFilePreviews = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWFOLDERS:
+	case SettingName::ShowFolders:
 		m_config->showFolders = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWFOLDERSIZES:
+	case SettingName::ShowFolderSizes:
 		m_config->globalFolderSettings.showFolderSizes = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWFRIENDLYDATES:
+	case SettingName::ShowFriendlyDates:
 		m_config->globalFolderSettings.showFriendlyDates = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWFULLTITLEPATH:
+	case SettingName::ShowFullTitlePath:
 		m_config->showFullTitlePath.set(NXMLSettings::DecodeBoolValue(wszValue));
 		break;
 
-	case HASH_SHOWGRIDLINESGLOBAL:
+	case SettingName::ShowGridlinesGlobal:
 		m_config->globalFolderSettings.showGridlines = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWHIDDENGLOBAL:
+	case SettingName::ShowHiddenGlobal:
 		m_config->defaultFolderSettings.showHidden = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWINFOTIPS:
+	case SettingName::ShowInfoTips:
 		m_config->showInfoTips = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWINGROUPSGLOBAL:
+	case SettingName::ShowInGroupsGlobal:
 		m_config->defaultFolderSettings.showInGroups = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWPRIVILEGETITLEBAR:
+	case SettingName::ShowPrivilegeLevelInTitleBar:
 		m_config->showPrivilegeLevelInTitleBar.set(NXMLSettings::DecodeBoolValue(wszValue));
 		break;
 
-	case HASH_SHOWSTATUSBAR:
+	case SettingName::ShowStatusBar:
 		m_config->showStatusBar = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWTABBARATBOTTOM:
+	case SettingName::ShowTabBarAtBottom:
 		m_config->showTabBarAtBottom = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWTASKBARTHUMBNAILS:
+	case SettingName::ShowTaskbarThumbnails:
 		m_config->showTaskbarThumbnails = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWTOOLBAR:
+	case SettingName::ShowToolbar:
 		m_config->showMainToolbar = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_SHOWUSERNAMETITLEBAR:
+	case SettingName::ShowUserNameTitleBar:
 		m_config->showUserNameInTitleBar.set(NXMLSettings::DecodeBoolValue(wszValue));
 		break;
 
-	case HASH_SIZEDISPLAYFOMRAT:
+	case SettingName::SizeDisplayFormat:
 		m_config->globalFolderSettings.sizeDisplayFormat = static_cast<SizeDisplayFormat>(NXMLSettings::DecodeIntValue(wszValue));
 		break;
 
-	case HASH_SORTASCENDINGGLOBAL:
+	case SettingName::SortAscendingGlobal:
 		m_config->defaultFolderSettings.sortAscending = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_STARTUPMODE:
+	case SettingName::StartupMode:
 		m_config->startupMode = static_cast<StartupMode>(NXMLSettings::DecodeIntValue(wszValue));
 		break;
 
-	case HASH_SYNCHRONIZETREEVIEW:
+	case SettingName::SynchronizeTreeview:
 		m_config->synchronizeTreeview = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_TVAUTOEXPAND:
+	case SettingName::TVAutoExpandSelected:
 		m_config->treeViewAutoExpandSelected = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_USEFULLROWSELECT:
+	case SettingName::UseFullRowSelect:
 		m_config->useFullRowSelect = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_TOOLBARSTATE:
-		MainToolbarPersistentSettings::GetInstance().LoadXMLSettings(pNode);
-		break;
-
-	case HASH_TREEVIEWDELAYENABLED:
+	case SettingName::TreeViewDelayEnabled:
 		m_config->treeViewDelayEnabled = NXMLSettings::DecodeBoolValue(wszValue);
 		break;
 
-	case HASH_TREEVIEWWIDTH:
+	case SettingName::TreeViewWidth:
 		m_config->treeViewWidth = NXMLSettings::DecodeIntValue(wszValue);
 		break;
 
-	case HASH_VIEWMODEGLOBAL:
+	case SettingName::ViewModeGlobal:
 		m_config->defaultFolderSettings.viewMode = ViewMode::_from_integral(NXMLSettings::DecodeIntValue(wszValue));
 		break;
 
-	case HASH_POSITION:
-		{
-			IXMLDOMNode	*pChildNode = nullptr;
-			IXMLDOMNamedNodeMap	*am = nullptr;
-			WINDOWPLACEMENT wndpl;
-			BSTR		bstrName;
-			BSTR		bstrValue;
-			BOOL		bMaximized = FALSE;
-
-			pNode->get_attributes(&am);
-
-			long lChildNodes;
-			long j = 0;
-
-			/* Retrieve the total number of attributes
-			attached to this node. */
-			am->get_length(&lChildNodes);
-
-			for(j = 1;j < lChildNodes;j++)
-			{
-				am->get_item(j, &pChildNode);
-
-				/* Element name. */
-				pChildNode->get_nodeName(&bstrName);
-
-				/* Element value. */
-				pChildNode->get_text(&bstrValue);
-
-				if(lstrcmp(bstrName,L"Left") == 0)
-					wndpl.rcNormalPosition.left = NXMLSettings::DecodeIntValue(bstrValue);
-				else if(lstrcmp(bstrName,L"Top") == 0)
-					wndpl.rcNormalPosition.top = NXMLSettings::DecodeIntValue(bstrValue);
-				else if(lstrcmp(bstrName,L"Right") == 0)
-					wndpl.rcNormalPosition.right = NXMLSettings::DecodeIntValue(bstrValue);
-				else if(lstrcmp(bstrName,L"Bottom") == 0)
-					wndpl.rcNormalPosition.bottom = NXMLSettings::DecodeIntValue(bstrValue);
-				else if(lstrcmp(bstrName,L"Maximized") == 0)
-					bMaximized = NXMLSettings::DecodeBoolValue(bstrValue);
-			}
-
-			wndpl.length	= sizeof(WINDOWPLACEMENT);
-			wndpl.showCmd	= SW_HIDE;
-
-			if(bMaximized)
-				wndpl.showCmd |= SW_MAXIMIZE;
-
-			SetWindowPlacement(m_hContainer,&wndpl);
-		}
-		break;
-
-	case HASH_NEWTABDIRECTORY:
+	case SettingName::NewTabDirectory:
 		m_config->defaultTabDirectory = wszValue;
 		break;
 
-	case HASH_INFOTIPTYPE:
+	case SettingName::InfoTipType:
 		m_config->infoTipType = static_cast<InfoTipType>(NXMLSettings::DecodeIntValue(wszValue));
 		break;
 
-	case HASH_ICON_THEME:
+	case SettingName::IconTheme:
 		m_config->iconTheme = IconTheme::_from_integral(NXMLSettings::DecodeIntValue(wszValue));
 		break;
+
+	default:
+		break;
 	}
 }
 
-void Explorerplusplus::MapTabAttributeValue(WCHAR *wszName,WCHAR *wszValue,
+void Explorerplusplus::MapTabAttributeValue(const WCHAR *wszName,const WCHAR *wszValue,
 	TabSettings &tabSettings, FolderSettings &folderSettings)
 {
 	if(lstrcmp(wszName,L"ApplyFilter") == 0)
@@ -5,6 +5,9 @@
 #pragma once
 
 #include <Windows.h>
+#include <optional>
+#include <string>
 
+std::optional<std::wstring> ReadXMLConfigFile();
 BOOL LoadWindowPositionFromXML(WINDOWPLACEMENT *pwndpl);
 BOOL LoadAllowMultipleInstancesFromXML(void);
\ No newline at end of file
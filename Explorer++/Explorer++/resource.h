@@ -142,6 +142,7 @@
 #define IDD_THIRD_PARTY_CREDITS         325
 #define IDS_MENU_BOOKMARK_THIS_TAB      326
 #define IDS_MENU_MANAGE_BOOKMARKS       327
+#define IDD_MEMORY_USAGE                327
 #define IDS_BOOKMARKS_OTHER_BOOKMARKS   328
 #define IDS_ADD_BOOKMARK_TITLE_EDIT_FOLDER 329
 #define IDS_ADD_BOOKMARK_TITLE_ADD_BOOKMARK 330
@@ -365,6 +366,8 @@
 #define IDC_GROUP_LISTVIEW              1342
 #define IDC_GROUP_TREEVIEW              1343
 #define IDC_GROUP_DISPLAY_WINDOW        1344
+#define IDC_MEMORY_USAGE_LISTVIEW       1345
+#define IDC_MEMORY_USAGE_REFRESH        1346
 #define IDS_COLUMN_DESCRIPTION_NAME     2000
 #define IDS_COLUMN_DESCRIPTION_TYPE     2001
 #define IDS_COLUMN_DESCRIPTION_SIZE     2002
@@ -607,6 +610,12 @@
 #define IDS_GENERAL_TOTALFILESIZE       8215
 #define IDS_GENERAL_CALCULATING         8216
 #define IDS_TAB_CLOSE_TIP               8217
+#define IDS_SHELL_TREE_VIEW_LOADING     8218
+#define IDS_MEMORY_USAGE_COLUMN_TAB     8219
+#define IDS_MEMORY_USAGE_COLUMN_COMPONENT 8220
+#define IDS_MEMORY_USAGE_COLUMN_MEMORY  8221
+#define IDS_MEMORY_USAGE_SHARED         8222
+#define IDS_MEMORY_USAGE_TOTAL          8223
 #define IDM_FILE_NEWTAB                 40056
 #define IDM_FILE_CLOSETAB               40057
 #define IDM_FILE_OPENCOMMANDPROMPT      40059
@@ -798,6 +807,7 @@
 #define IDM_MB_ORGANIZE_PASTE           40541
 #define IDM_DISPLAYWINDOW_VERTICAL      40542
 #define IDM_POPUP_SHOW_COLUMNS          40543
+#define IDM_TOOLS_MEMORYUSAGE           40544
 #define IDM_SORTBY_NAME                 50000
 #define IDM_SORTBY_SIZE                 50001
 #define IDM_SORTBY_TYPE                 50002
@@ -935,9 +945,9 @@
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
-#define _APS_NEXT_RESOURCE_VALUE        327
-#define _APS_NEXT_COMMAND_VALUE         40544
-#define _APS_NEXT_CONTROL_VALUE         1345
+#define _APS_NEXT_RESOURCE_VALUE        328
+#define _APS_NEXT_COMMAND_VALUE         40545
+#define _APS_NEXT_CONTROL_VALUE         1347
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
 #endif
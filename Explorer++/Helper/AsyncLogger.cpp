@@ -0,0 +1,587 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "AsyncLogger.h"
+#include <algorithm>
+#include <cstring>
+#include <cwchar>
+
+namespace
+{
+enum class ArgumentType : uint8_t
+{
+	Bool,
+	Char,
+	WideChar,
+	Integer,
+	UnsignedInteger,
+	Double,
+	String,
+	WideString
+};
+
+std::atomic<uint64_t> g_nextLoggerId = 1;
+}
+
+struct AsyncLogger::Record
+{
+	uint64_t sequence;
+	Clock::rep time;
+	int severity;
+	uint16_t size;
+	bool truncated;
+	uint8_t data[RECORD_DATA_SIZE];
+};
+
+// A single-producer, single-consumer ring buffer. Records are written by the
+// thread that owns the buffer and read by the background thread. The indexes
+// only ever increase; the slot for an index is found by wrapping it.
+struct AsyncLogger::ThreadBuffer
+{
+	std::array<Record, RECORDS_PER_THREAD> records;
+
+	// The index of the next record to read. Only written by the background
+	// thread.
+	alignas(64) std::atomic<uint64_t> head = 0;
+
+	// The index of the next record to write. Only written by the owning thread.
+	alignas(64) std::atomic<uint64_t> tail = 0;
+
+	std::atomic<uint64_t> numDropped = 0;
+
+	// Set once the owning thread has exited, at which point the buffer can be
+	// freed once it's been drained.
+	std::atomic<bool> retired = false;
+
+	// Only accessed by the owning thread. Used to detect a message being logged
+	// while another is still being built on the same thread (e.g. from within a
+	// stream operator).
+	bool buildingMessage = false;
+};
+
+AsyncLogger::Message::Message(AsyncLogger *logger, int severity)
+{
+	if (!logger || logger->m_stopped.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	ThreadBuffer *buffer = logger->GetThreadBuffer();
+
+	if (buffer->buildingMessage)
+	{
+		buffer->numDropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+
+	// The acquire here pairs with the release in Drain(), so that a slot is
+	// only reused once the background thread has finished reading from it.
+	if (tail - buffer->head.load(std::memory_order_acquire) >= RECORDS_PER_THREAD)
+	{
+		buffer->numDropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	m_buffer = buffer;
+	m_buffer->buildingMessage = true;
+
+	m_record = &buffer->records[tail % RECORDS_PER_THREAD];
+	m_record->sequence = logger->m_nextSequence.fetch_add(1, std::memory_order_relaxed);
+	m_record->time = Clock::now().time_since_epoch().count();
+	m_record->severity = severity;
+	m_record->size = 0;
+	m_record->truncated = false;
+}
+
+AsyncLogger::Message::~Message()
+{
+	if (!m_record)
+	{
+		return;
+	}
+
+	m_buffer->buildingMessage = false;
+	m_buffer->tail.store(
+		m_buffer->tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(bool value)
+{
+	uint8_t data = value ? 1 : 0;
+	AppendArgument(static_cast<uint8_t>(ArgumentType::Bool), &data, sizeof(data));
+	return *this;
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(char value)
+{
+	AppendArgument(static_cast<uint8_t>(ArgumentType::Char), &value, sizeof(value));
+	return *this;
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(wchar_t value)
+{
+	AppendArgument(static_cast<uint8_t>(ArgumentType::WideChar), &value, sizeof(value));
+	return *this;
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(short value)
+{
+	return *this << static_cast<long long>(value);
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(unsigned short value)
+{
+	return *this << static_cast<unsigned long long>(value);
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(int value)
+{
+	return *this << static_cast<long long>(value);
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(unsigned int value)
+{
+	return *this << static_cast<unsigned long long>(value);
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(long value)
+{
+	return *this << static_cast<long long>(value);
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(unsigned long value)
+{
+	return *this << static_cast<unsigned long long>(value);
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(long long value)
+{
+	int64_t data = value;
+	AppendArgument(static_cast<uint8_t>(ArgumentType::Integer), &data, sizeof(data));
+	return *this;
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(unsigned long long value)
+{
+	uint64_t data = value;
+	AppendArgument(static_cast<uint8_t>(ArgumentType::UnsignedInteger), &data, sizeof(data));
+	return *this;
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(float value)
+{
+	return *this << static_cast<double>(value);
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(double value)
+{
+	AppendArgument(static_cast<uint8_t>(ArgumentType::Double), &value, sizeof(value));
+	return *this;
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(const wchar_t *value)
+{
+	return *this << std::wstring_view(value);
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(const char *value)
+{
+	return *this << std::string_view(value);
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(const std::wstring &value)
+{
+	return *this << std::wstring_view(value);
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(const std::string &value)
+{
+	return *this << std::string_view(value);
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(std::wstring_view value)
+{
+	AppendString(static_cast<uint8_t>(ArgumentType::WideString), value.data(), value.size(),
+		sizeof(wchar_t));
+	return *this;
+}
+
+AsyncLogger::Message &AsyncLogger::Message::operator<<(std::string_view value)
+{
+	AppendString(
+		static_cast<uint8_t>(ArgumentType::String), value.data(), value.size(), sizeof(char));
+	return *this;
+}
+
+// Each argument is stored as a one byte type, followed by its value. Once an
+// argument has been truncated, any remaining arguments are ignored.
+void AsyncLogger::Message::AppendArgument(uint8_t type, const void *data, size_t size)
+{
+	if (!m_record || m_record->truncated)
+	{
+		return;
+	}
+
+	if (RECORD_DATA_SIZE - m_record->size < sizeof(type) + size)
+	{
+		m_record->truncated = true;
+		return;
+	}
+
+	uint8_t *destination = m_record->data + m_record->size;
+	*destination = type;
+	std::memcpy(destination + sizeof(type), data, size);
+	m_record->size += static_cast<uint16_t>(sizeof(type) + size);
+}
+
+// Strings are stored as a two byte length, followed by the characters. As much
+// of the string as will fit is stored.
+void AsyncLogger::Message::AppendString(
+	uint8_t type, const void *data, size_t length, size_t charSize)
+{
+	if (!m_record || m_record->truncated)
+	{
+		return;
+	}
+
+	constexpr size_t headerSize = sizeof(uint8_t) + sizeof(uint16_t);
+	size_t available = RECORD_DATA_SIZE - m_record->size;
+
+	if (available < headerSize)
+	{
+		m_record->truncated = true;
+		return;
+	}
+
+	auto storedLength =
+		static_cast<uint16_t>(std::min(length, (available - headerSize) / charSize));
+
+	uint8_t *destination = m_record->data + m_record->size;
+	*destination = type;
+	std::memcpy(destination + sizeof(uint8_t), &storedLength, sizeof(storedLength));
+	std::memcpy(destination + headerSize, data, storedLength * charSize);
+	m_record->size += static_cast<uint16_t>(headerSize + storedLength * charSize);
+
+	if (storedLength < length)
+	{
+		m_record->truncated = true;
+	}
+}
+
+AsyncLogger::AsyncLogger(Sink sink, int droppedMessagesSeverity) :
+	m_id(g_nextLoggerId.fetch_add(1)),
+	m_sink(sink),
+	m_droppedMessagesSeverity(droppedMessagesSeverity)
+{
+	m_flusherThread = std::thread(&AsyncLogger::FlusherMain, this);
+}
+
+AsyncLogger::~AsyncLogger()
+{
+	Stop();
+}
+
+void AsyncLogger::Flush()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (m_stopRequested)
+	{
+		return;
+	}
+
+	uint64_t flushRequest = ++m_flushRequests;
+	m_flushCondition.notify_one();
+	m_flushCompletedCondition.wait(
+		lock, [this, flushRequest] { return m_flushesCompleted >= flushRequest; });
+}
+
+void AsyncLogger::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopRequested = true;
+	}
+
+	m_flushCondition.notify_one();
+
+	if (m_flusherThread.joinable())
+	{
+		m_flusherThread.join();
+	}
+
+	m_stopped.store(true, std::memory_order_relaxed);
+}
+
+AsyncLogger::Stats AsyncLogger::GetStats() const
+{
+	Stats stats;
+	stats.numWritten = m_numWritten.load(std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(m_buffersMutex);
+	stats.numDropped = m_numDroppedFromRetiredBuffers;
+
+	for (const auto &buffer : m_buffers)
+	{
+		stats.numDropped += buffer->numDropped.load(std::memory_order_relaxed);
+	}
+
+	return stats;
+}
+
+AsyncLogger::ThreadBuffer *AsyncLogger::GetThreadBuffer()
+{
+	// A thread will generally only log to a single logger, so only the buffer
+	// for the most recently used logger is retained.
+	struct CurrentThreadBuffer
+	{
+		~CurrentThreadBuffer()
+		{
+			if (buffer)
+			{
+				buffer->retired.store(true, std::memory_order_release);
+			}
+		}
+
+		uint64_t loggerId = 0;
+		std::shared_ptr<ThreadBuffer> buffer;
+	};
+
+	thread_local CurrentThreadBuffer currentThreadBuffer;
+
+	if (currentThreadBuffer.loggerId != m_id)
+	{
+		if (currentThreadBuffer.buffer)
+		{
+			currentThreadBuffer.buffer->retired.store(true, std::memory_order_release);
+		}
+
+		// This is the only point at which a lock is taken on the logging
+		// thread and it only happens once per thread.
+		auto buffer = std::make_shared<ThreadBuffer>();
+
+		{
+			std::lock_guard<std::mutex> lock(m_buffersMutex);
+			m_buffers.push_back(buffer);
+		}
+
+		currentThreadBuffer.loggerId = m_id;
+		currentThreadBuffer.buffer = buffer;
+	}
+
+	return currentThreadBuffer.buffer.get();
+}
+
+std::wstring AsyncLogger::FormatRecord(const Record &record)
+{
+	std::wostringstream stream;
+	size_t offset = 0;
+
+	while (offset < record.size)
+	{
+		auto type = static_cast<ArgumentType>(record.data[offset]);
+		const uint8_t *data = record.data + offset + sizeof(uint8_t);
+		offset += sizeof(uint8_t);
+
+		switch (type)
+		{
+		case ArgumentType::Bool:
+			stream << (*data != 0);
+			offset += sizeof(uint8_t);
+			break;
+
+		case ArgumentType::Char:
+		{
+			char value;
+			std::memcpy(&value, data, sizeof(value));
+			stream << value;
+			offset += sizeof(value);
+		}
+		break;
+
+		case ArgumentType::WideChar:
+		{
+			wchar_t value;
+			std::memcpy(&value, data, sizeof(value));
+			stream << value;
+			offset += sizeof(value);
+		}
+		break;
+
+		case ArgumentType::Integer:
+		{
+			int64_t value;
+			std::memcpy(&value, data, sizeof(value));
+			stream << value;
+			offset += sizeof(value);
+		}
+		break;
+
+		case ArgumentType::UnsignedInteger:
+		{
+			uint64_t value;
+			std::memcpy(&value, data, sizeof(value));
+			stream << value;
+			offset += sizeof(value);
+		}
+		break;
+
+		case ArgumentType::Double:
+		{
+			double value;
+			std::memcpy(&value, data, sizeof(value));
+			stream << value;
+			offset += sizeof(value);
+		}
+		break;
+
+		case ArgumentType::String:
+		case ArgumentType::WideString:
+		{
+			uint16_t length;
+			std::memcpy(&length, data, sizeof(length));
+			data += sizeof(length);
+			offset += sizeof(length);
+
+			if (type == ArgumentType::String)
+			{
+				stream << std::string(reinterpret_cast<const char *>(data), length).c_str();
+				offset += length * sizeof(char);
+			}
+			else
+			{
+				std::wstring value(length, L'\0');
+				std::memcpy(value.data(), data, length * sizeof(wchar_t));
+				stream << value;
+				offset += length * sizeof(wchar_t);
+			}
+		}
+		break;
+		}
+	}
+
+	if (record.truncated)
+	{
+		stream << L"...";
+	}
+
+	return stream.str();
+}
+
+void AsyncLogger::FlusherMain()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
+	{
+		m_flushCondition.wait_for(lock, FLUSH_INTERVAL,
+			[this] { return m_stopRequested || m_flushRequests != m_flushesCompleted; });
+
+		uint64_t flushRequests = m_flushRequests;
+		bool stopRequested = m_stopRequested;
+
+		lock.unlock();
+		Drain();
+		lock.lock();
+
+		m_flushesCompleted = flushRequests;
+		m_flushCompletedCondition.notify_all();
+
+		if (stopRequested)
+		{
+			break;
+		}
+	}
+}
+
+void AsyncLogger::Drain()
+{
+	std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+	{
+		std::lock_guard<std::mutex> lock(m_buffersMutex);
+		buffers = m_buffers;
+	}
+
+	struct PendingEntry
+	{
+		uint64_t sequence;
+		Entry entry;
+	};
+
+	std::vector<PendingEntry> pendingEntries;
+	std::vector<ThreadBuffer *> drainedRetiredBuffers;
+	uint64_t numDropped = 0;
+
+	for (auto &buffer : buffers)
+	{
+		// The retired flag is read before the tail, so that if the thread has
+		// exited, every record it committed will be visible.
+		bool retired = buffer->retired.load(std::memory_order_acquire);
+		uint64_t head = buffer->head.load(std::memory_order_relaxed);
+		uint64_t tail = buffer->tail.load(std::memory_order_acquire);
+
+		for (; head < tail; head++)
+		{
+			const Record &record = buffer->records[head % RECORDS_PER_THREAD];
+			pendingEntries.push_back({ record.sequence,
+				{ record.severity, Clock::time_point(Clock::duration(record.time)),
+					FormatRecord(record) } });
+		}
+
+		// The release here pairs with the acquire in the Message constructor.
+		buffer->head.store(tail, std::memory_order_release);
+
+		if (retired)
+		{
+			drainedRetiredBuffers.push_back(buffer.get());
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+		for (auto *retiredBuffer : drainedRetiredBuffers)
+		{
+			m_numDroppedFromRetiredBuffers +=
+				retiredBuffer->numDropped.load(std::memory_order_relaxed);
+
+			auto itr = std::find_if(m_buffers.begin(), m_buffers.end(),
+				[retiredBuffer](const auto &buffer) { return buffer.get() == retiredBuffer; });
+			m_buffers.erase(itr);
+		}
+
+		numDropped = m_numDroppedFromRetiredBuffers;
+
+		for (const auto &buffer : m_buffers)
+		{
+			numDropped += buffer->numDropped.load(std::memory_order_relaxed);
+		}
+	}
+
+	// Messages from different threads are interleaved in the order in which
+	// they were started.
+	std::sort(pendingEntries.begin(), pendingEntries.end(),
+		[](const PendingEntry &first, const PendingEntry &second) {
+			return first.sequence < second.sequence;
+		});
+
+	if (numDropped > m_numDroppedReported)
+	{
+		m_sink({ m_droppedMessagesSeverity, Clock::now(),
+			std::to_wstring(numDropped - m_numDroppedReported)
+				+ L" log message(s) were dropped because the log buffer was full" });
+		m_numDroppedReported = numDropped;
+	}
+
+	for (const auto &pendingEntry : pendingEntries)
+	{
+		m_sink(pendingEntry.entry);
+	}
+
+	m_numWritten.fetch_add(pendingEntries.size(), std::memory_order_relaxed);
+}
\ No newline at end of file
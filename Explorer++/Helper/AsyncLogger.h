@@ -0,0 +1,187 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// A logger that moves almost all of the cost of logging off the calling thread.
+//
+// Each thread that logs a message is given its own fixed-size ring buffer. A
+// message is recorded by copying its arguments (in an unformatted, binary form)
+// into the next free slot, which doesn't require any locks or allocations.
+// A background thread periodically drains the buffers, formats each message and
+// passes it to the sink.
+//
+// The amount of memory used per thread is fixed. If a thread logs messages
+// faster than they can be drained, the messages that don't fit are dropped and
+// counted. The number of dropped messages is reported to the sink.
+class AsyncLogger
+{
+private:
+	struct Record;
+	struct ThreadBuffer;
+
+public:
+	using Clock = std::chrono::system_clock;
+
+	struct Entry
+	{
+		int severity;
+		Clock::time_point time;
+		std::wstring message;
+	};
+
+	struct Stats
+	{
+		uint64_t numWritten = 0;
+		uint64_t numDropped = 0;
+	};
+
+	// Called on the background thread for each message, in the order in which
+	// the messages were logged.
+	using Sink = std::function<void(const Entry &entry)>;
+
+	// The maximum number of messages each thread can have waiting to be
+	// written.
+	static constexpr size_t RECORDS_PER_THREAD = 256;
+
+	// The space available for the arguments of each message. Arguments that
+	// don't fit are truncated.
+	static constexpr size_t RECORD_DATA_SIZE = 224;
+
+	// Builds a single message. The message is committed when this object is
+	// destroyed (i.e. at the end of the statement that created it).
+	class Message
+	{
+	public:
+		Message(AsyncLogger *logger, int severity);
+		~Message();
+
+		Message &operator<<(bool value);
+		Message &operator<<(char value);
+		Message &operator<<(wchar_t value);
+		Message &operator<<(short value);
+		Message &operator<<(unsigned short value);
+		Message &operator<<(int value);
+		Message &operator<<(unsigned int value);
+		Message &operator<<(long value);
+		Message &operator<<(unsigned long value);
+		Message &operator<<(long long value);
+		Message &operator<<(unsigned long long value);
+		Message &operator<<(float value);
+		Message &operator<<(double value);
+		Message &operator<<(const wchar_t *value);
+		Message &operator<<(const char *value);
+		Message &operator<<(const std::wstring &value);
+		Message &operator<<(const std::string &value);
+		Message &operator<<(std::wstring_view value);
+		Message &operator<<(std::string_view value);
+
+		// Character arrays (e.g. fixed-size buffers) are treated as strings.
+		template <size_t N>
+		Message &operator<<(const wchar_t (&value)[N])
+		{
+			return *this << static_cast<const wchar_t *>(value);
+		}
+
+		template <size_t N>
+		Message &operator<<(const char (&value)[N])
+		{
+			return *this << static_cast<const char *>(value);
+		}
+
+		// Any other type is formatted immediately, using its stream operator.
+		template <typename T>
+		Message &operator<<(const T &value)
+		{
+			if (!m_record)
+			{
+				return *this;
+			}
+
+			std::wostringstream stream;
+			stream << value;
+			return *this << stream.str();
+		}
+
+	private:
+		Message(const Message &) = delete;
+		Message &operator=(const Message &) = delete;
+
+		void AppendArgument(uint8_t type, const void *data, size_t size);
+		void AppendString(uint8_t type, const void *data, size_t length, size_t charSize);
+
+		ThreadBuffer *m_buffer = nullptr;
+		Record *m_record = nullptr;
+	};
+
+	AsyncLogger(Sink sink, int droppedMessagesSeverity);
+
+	// Stops the background thread, after writing out any remaining messages.
+	~AsyncLogger();
+
+	// Blocks until every message committed before this call has been passed to
+	// the sink. Shouldn't be called from within the sink.
+	void Flush();
+
+	// Stops the background thread, after writing out any remaining messages.
+	// Any messages logged after this are discarded.
+	void Stop();
+
+	Stats GetStats() const;
+
+private:
+	static constexpr std::chrono::milliseconds FLUSH_INTERVAL = std::chrono::milliseconds(50);
+
+	AsyncLogger(const AsyncLogger &) = delete;
+	AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+	static std::wstring FormatRecord(const Record &record);
+
+	ThreadBuffer *GetThreadBuffer();
+
+	void FlusherMain();
+	void Drain();
+
+	const uint64_t m_id;
+	const Sink m_sink;
+	const int m_droppedMessagesSeverity;
+
+	std::atomic<uint64_t> m_nextSequence = 0;
+	std::atomic<bool> m_stopped = false;
+
+	mutable std::mutex m_buffersMutex;
+	std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+
+	// The number of messages dropped by threads that have since exited. Guarded
+	// by m_buffersMutex.
+	uint64_t m_numDroppedFromRetiredBuffers = 0;
+
+	// Only accessed by the background thread.
+	uint64_t m_numDroppedReported = 0;
+
+	std::atomic<uint64_t> m_numWritten = 0;
+
+	std::mutex m_mutex;
+	std::condition_variable m_flushCondition;
+	std::condition_variable m_flushCompletedCondition;
+	uint64_t m_flushRequests = 0;
+	uint64_t m_flushesCompleted = 0;
+	bool m_stopRequested = false;
+	std::thread m_flusherThread;
+};
\ No newline at end of file
@@ -0,0 +1,54 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "BufferPool.h"
+
+BufferPool::BufferPool(size_t bufferSize, size_t maxFreeBuffers) :
+	m_bufferSize(bufferSize),
+	m_maxFreeBuffers(maxFreeBuffers)
+{
+}
+
+BufferPool::Buffer BufferPool::Acquire()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_freeBuffers.empty())
+		{
+			Buffer buffer = std::move(m_freeBuffers.back());
+			m_freeBuffers.pop_back();
+			return buffer;
+		}
+	}
+
+	return std::make_unique<std::byte[]>(m_bufferSize);
+}
+
+void BufferPool::Release(Buffer buffer)
+{
+	if (!buffer)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_freeBuffers.size() < m_maxFreeBuffers)
+	{
+		m_freeBuffers.push_back(std::move(buffer));
+	}
+}
+
+size_t BufferPool::GetBufferSize() const
+{
+	return m_bufferSize;
+}
+
+size_t BufferPool::GetNumFreeBuffers() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_freeBuffers.size();
+}
\ No newline at end of file
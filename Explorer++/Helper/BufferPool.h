@@ -0,0 +1,36 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Hands out fixed-size buffers, keeping released buffers around so that they
+// can be reused, rather than being allocated each time they're needed. This
+// class can be used from multiple threads.
+class BufferPool
+{
+public:
+	using Buffer = std::unique_ptr<std::byte[]>;
+
+	// At most maxFreeBuffers buffers will be retained once they've been
+	// released. Any others are freed.
+	BufferPool(size_t bufferSize, size_t maxFreeBuffers);
+
+	Buffer Acquire();
+	void Release(Buffer buffer);
+
+	size_t GetBufferSize() const;
+	size_t GetNumFreeBuffers() const;
+
+private:
+	const size_t m_bufferSize;
+	const size_t m_maxFreeBuffers;
+
+	mutable std::mutex m_mutex;
+	std::vector<Buffer> m_freeBuffers;
+};
\ No newline at end of file
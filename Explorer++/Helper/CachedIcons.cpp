@@ -4,62 +4,487 @@
 
 #include "stdafx.h"
 #include "CachedIcons.h"
-#include "ShellHelper.h"
+#include <istream>
+#include <mutex>
+#include <ostream>
 
-CachedIcons::CachedIcons(std::size_t maxItems) : m_maxItems(maxItems)
+namespace
 {
+	const uint32_t FILE_MAGIC = 0x43495845;
+	const uint32_t FILE_VERSION = 1;
+
+	// The maximum length of a path on Windows. Anything longer than this
+	// indicates the file is corrupt.
+	const uint32_t MAX_LOCATION_FILE_LENGTH = 32767;
+
+	// The top eight bits of an icon index retrieved with SHGFI_OVERLAYINDEX
+	// contain the overlay index.
+	const int ICON_INDEX_MASK = 0x00FFFFFF;
+
+	const uint64_t HASH_SEED = 0x9E3779B97F4A7C15ULL;
+	const uint64_t HASH_MULTIPLIER_1 = 0x87C37B91114253D5ULL;
+	const uint64_t HASH_MULTIPLIER_2 = 0x4CF5AD432745937FULL;
+
+	// The finalizer from MurmurHash3.
+	uint64_t MixBits(uint64_t value)
+	{
+		value ^= value >> 33;
+		value *= 0xFF51AFD7ED558CCDULL;
+		value ^= value >> 33;
+		value *= 0xC4CEB9FE1A85EC53ULL;
+		value ^= value >> 33;
+		return value;
+	}
+
+	uint64_t MixBlock(uint64_t hash, uint64_t block)
+	{
+		block *= HASH_MULTIPLIER_1;
+		block ^= block >> 31;
+		return (hash ^ block) * HASH_MULTIPLIER_2;
+	}
+
+	// Paths are hashed on every lookup, so this processes four UTF-16 code
+	// units at a time. The result of this is written to disk, so it needs to
+	// be the same from one session to the next (which isn't guaranteed by
+	// std::hash).
+	uint64_t HashString(const std::wstring &str, uint64_t seed = HASH_SEED)
+	{
+		uint64_t hash = seed ^ (str.size() * HASH_MULTIPLIER_1);
+		std::size_t i = 0;
+
+		for (; i + 4 <= str.size(); i += 4)
+		{
+			uint64_t block = static_cast<uint64_t>(static_cast<uint16_t>(str[i]))
+				| (static_cast<uint64_t>(static_cast<uint16_t>(str[i + 1])) << 16)
+				| (static_cast<uint64_t>(static_cast<uint16_t>(str[i + 2])) << 32)
+				| (static_cast<uint64_t>(static_cast<uint16_t>(str[i + 3])) << 48);
+			hash = MixBlock(hash, block);
+		}
+
+		uint64_t block = 0;
+
+		for (int shift = 0; i < str.size(); i++, shift += 16)
+		{
+			block |= static_cast<uint64_t>(static_cast<uint16_t>(str[i])) << shift;
+		}
+
+		return MixBits(MixBlock(hash, block));
+	}
+
+	template <typename T>
+	void WriteValue(std::ostream &stream, T value)
+	{
+		stream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+	}
+
+	template <typename T>
+	bool ReadValue(std::istream &stream, T &value)
+	{
+		stream.read(reinterpret_cast<char *>(&value), sizeof(value));
+		return static_cast<bool>(stream);
+	}
 }
 
-CachedIcons::iterator CachedIcons::end()
+CachedIcons::CachedIcons(
+	std::size_t maxItems, LocationResolver locationResolver, std::size_t numShards) :
+	m_maxItemsPerShard((maxItems + numShards - 1) / numShards),
+	m_locationResolver(locationResolver)
 {
-	CachedIconSetByPath &pathIndex = m_cachedIconSet.get<1>();
-	return pathIndex.end();
+	for (std::size_t i = 0; i < numShards; i++)
+	{
+		m_shards.push_back(std::make_unique<Shard>(&m_memoryCounter));
+	}
+}
+
+std::optional<int> CachedIcons::findByPath(const std::wstring &filePath, ItemType itemType)
+{
+	auto iconIndex = findByKey(hashPath(filePath));
+
+	if (iconIndex || itemType == ItemType::Unknown)
+	{
+		return iconIndex;
+	}
+
+	return findByKey(hashClass(filePath, itemType));
+}
+
+std::optional<int> CachedIcons::findByKey(uint64_t key)
+{
+	Shard &shard = getShard(key);
+	auto &keyIndex = shard.cachedIconSet.get<1>();
+	IconLocation location;
+
+	{
+		std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+		auto itr = keyIndex.find(key);
+
+		if (itr == keyIndex.end())
+		{
+			return std::nullopt;
+		}
+
+		if (itr->iconIndex != UNRESOLVED_ICON_INDEX)
+		{
+			return itr->iconIndex;
+		}
+
+		location.file = getLocationFile(itr->locationFileId);
+		location.index = itr->locationIndex;
+	}
+
+	// This entry was loaded from a previous session, so the icon needs to be
+	// added to the system image list before it can be used. That's only done
+	// once.
+	std::optional<int> iconIndex;
+
+	if (m_locationResolver)
+	{
+		iconIndex = m_locationResolver(location);
+	}
+
+	std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+	auto itr = keyIndex.find(key);
+
+	if (itr != keyIndex.end() && itr->iconIndex == UNRESOLVED_ICON_INDEX)
+	{
+		if (iconIndex)
+		{
+			keyIndex.modify(itr, [&iconIndex](CachedIcon &cachedIcon) {
+				cachedIcon.iconIndex = *iconIndex;
+			});
+		}
+		else
+		{
+			keyIndex.erase(itr);
+		}
+	}
+
+	return iconIndex;
 }
 
 void CachedIcons::addOrUpdateFileIcon(const std::wstring &filePath, int iconIndex)
 {
-	auto cachedItr = findByPath(filePath);
+	addOrUpdateFileIcon(filePath, iconIndex, IconDetails());
+}
+
+void CachedIcons::addOrUpdateFileIcon(
+	const std::wstring &filePath, int iconIndex, const IconDetails &iconDetails)
+{
+	CachedIcon cachedIcon;
 
-	if (cachedItr != end())
+	if (iconDetails.perClass && iconDetails.itemType != ItemType::Unknown)
 	{
-		CachedIcon existingCachedIcon = *cachedItr;
-		existingCachedIcon.iconIndex = iconIndex;
-		replace(cachedItr, existingCachedIcon);
+		// Overlays are specific to an individual item, so they're not stored
+		// for an entire class.
+		cachedIcon.key = hashClass(filePath, iconDetails.itemType);
+		cachedIcon.iconIndex = iconIndex & ICON_INDEX_MASK;
 	}
 	else
 	{
-		CachedIcon cachedIcon;
-		cachedIcon.filePath = filePath;
+		cachedIcon.key = hashPath(filePath);
 		cachedIcon.iconIndex = iconIndex;
-		insert(cachedIcon);
+	}
+
+	if (iconDetails.location)
+	{
+		cachedIcon.locationFileId = internLocationFile(iconDetails.location->file);
+		cachedIcon.locationIndex = iconDetails.location->index;
+	}
+	else
+	{
+		cachedIcon.locationFileId = NO_LOCATION;
+		cachedIcon.locationIndex = 0;
+	}
+
+	addOrUpdate(cachedIcon);
+}
+
+// If the icon already exists, it will be replaced and moved to the front of
+// the list, which will stop it from being removed if the list grows over the
+// maximum allowed size (the first icons to be removed are those at the back
+// of the list).
+void CachedIcons::addOrUpdate(const CachedIcon &cachedIcon)
+{
+	Shard &shard = getShard(cachedIcon.key);
+
+	std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+	auto &keyIndex = shard.cachedIconSet.get<1>();
+	auto itr = keyIndex.find(cachedIcon.key);
+
+	if (itr != keyIndex.end())
+	{
+		keyIndex.replace(itr, cachedIcon);
+		shard.cachedIconSet.relocate(
+			shard.cachedIconSet.begin(), shard.cachedIconSet.project<0>(itr));
+		return;
+	}
+
+	insertIntoShard(shard, cachedIcon, true);
+}
+
+void CachedIcons::insertIntoShard(Shard &shard, const CachedIcon &cachedIcon, bool mostRecent)
+{
+	if (mostRecent)
+	{
+		shard.cachedIconSet.push_front(cachedIcon);
+
+		if (shard.cachedIconSet.size() > m_maxItemsPerShard)
+		{
+			shard.cachedIconSet.pop_back();
+		}
+	}
+	else if (shard.cachedIconSet.size() < m_maxItemsPerShard)
+	{
+		// Existing entries are always newer, so won't be replaced here.
+		shard.cachedIconSet.push_back(cachedIcon);
 	}
 }
 
-void CachedIcons::insert(const CachedIcon &cachedIcon)
+std::size_t CachedIcons::size() const
 {
-	m_cachedIconSet.push_front(cachedIcon);
+	std::size_t total = 0;
 
-	if (m_cachedIconSet.size() > m_maxItems)
+	for (const auto &shard : m_shards)
 	{
-		m_cachedIconSet.pop_back();
+		std::shared_lock<std::shared_mutex> lock(shard->mutex);
+		total += shard->cachedIconSet.size();
 	}
+
+	return total;
 }
 
-// Replaces an existing cached icon. The icon will also be moved to the
-// front of the list, which will stop it from being removed if the list
-// grows over the maximum allowed size (the first icons to be removed
-// are those at the back of the list).
-void CachedIcons::replace(CachedIconSetByPath::iterator itr, const CachedIcon &cachedIcon)
+std::size_t CachedIcons::getMemoryUsage() const
 {
-	CachedIconSetByPath &pathIndex = m_cachedIconSet.get<1>();
-	pathIndex.replace(itr, cachedIcon);
+	std::size_t memoryUsage = m_memoryCounter.GetBytes();
+
+	std::shared_lock<std::shared_mutex> lock(m_locationFilesMutex);
+
+	for (const auto &file : m_locationFiles)
+	{
+		memoryUsage += (file.capacity() + 1) * sizeof(wchar_t);
+	}
+
+	return memoryUsage;
+}
+
+void CachedIcons::save(std::ostream &stream) const
+{
+	std::vector<std::wstring> locationFiles;
+
+	{
+		std::shared_lock<std::shared_mutex> lock(m_locationFilesMutex);
+		locationFiles.assign(m_locationFiles.begin(), m_locationFiles.end());
+	}
+
+	// Entries are written from most to least recent (within each shard),
+	// which is the order they'll be added back in when loaded.
+	std::vector<CachedIcon> cachedIcons;
+
+	for (const auto &shard : m_shards)
+	{
+		std::shared_lock<std::shared_mutex> lock(shard->mutex);
+
+		for (const auto &cachedIcon : shard->cachedIconSet)
+		{
+			if (cachedIcon.locationFileId != NO_LOCATION)
+			{
+				cachedIcons.push_back(cachedIcon);
+			}
+		}
+	}
+
+	WriteValue(stream, FILE_MAGIC);
+	WriteValue(stream, FILE_VERSION);
+
+	WriteValue(stream, static_cast<uint32_t>(locationFiles.size()));
+
+	for (const auto &file : locationFiles)
+	{
+		WriteValue(stream, static_cast<uint32_t>(file.size()));
+
+		for (wchar_t c : file)
+		{
+			WriteValue(stream, static_cast<uint16_t>(c));
+		}
+	}
+
+	WriteValue(stream, static_cast<uint32_t>(cachedIcons.size()));
+
+	for (const auto &cachedIcon : cachedIcons)
+	{
+		WriteValue(stream, cachedIcon.key);
+		WriteValue(stream, cachedIcon.locationFileId);
+		WriteValue(stream, static_cast<int32_t>(cachedIcon.locationIndex));
+	}
+}
+
+bool CachedIcons::load(std::istream &stream)
+{
+	uint32_t magic;
+	uint32_t version;
+
+	if (!ReadValue(stream, magic) || magic != FILE_MAGIC || !ReadValue(stream, version)
+		|| version != FILE_VERSION)
+	{
+		return false;
+	}
+
+	uint32_t numLocationFiles;
+
+	if (!ReadValue(stream, numLocationFiles))
+	{
+		return false;
+	}
+
+	std::vector<std::wstring> locationFiles;
+
+	for (uint32_t i = 0; i < numLocationFiles; i++)
+	{
+		uint32_t length;
+
+		if (!ReadValue(stream, length) || length > MAX_LOCATION_FILE_LENGTH)
+		{
+			return false;
+		}
+
+		std::wstring file;
+
+		for (uint32_t j = 0; j < length; j++)
+		{
+			uint16_t codeUnit;
+
+			if (!ReadValue(stream, codeUnit))
+			{
+				return false;
+			}
+
+			file.push_back(static_cast<wchar_t>(codeUnit));
+		}
+
+		locationFiles.push_back(std::move(file));
+	}
+
+	uint32_t numCachedIcons;
+
+	if (!ReadValue(stream, numCachedIcons))
+	{
+		return false;
+	}
+
+	std::vector<CachedIcon> cachedIcons;
+
+	for (uint32_t i = 0; i < numCachedIcons; i++)
+	{
+		CachedIcon cachedIcon;
+		int32_t locationIndex;
+
+		if (!ReadValue(stream, cachedIcon.key) || !ReadValue(stream, cachedIcon.locationFileId)
+			|| !ReadValue(stream, locationIndex) || cachedIcon.locationFileId >= locationFiles.size())
+		{
+			return false;
+		}
+
+		cachedIcon.iconIndex = UNRESOLVED_ICON_INDEX;
+		cachedIcon.locationIndex = locationIndex;
+		cachedIcons.push_back(cachedIcon);
+	}
+
+	// The file IDs used in this cache won't necessarily match the IDs that
+	// were saved.
+	std::vector<uint32_t> locationFileIds;
+
+	for (const auto &file : locationFiles)
+	{
+		locationFileIds.push_back(internLocationFile(file));
+	}
+
+	for (auto &cachedIcon : cachedIcons)
+	{
+		cachedIcon.locationFileId = locationFileIds[cachedIcon.locationFileId];
+
+		Shard &shard = getShard(cachedIcon.key);
+		std::unique_lock<std::shared_mutex> lock(shard.mutex);
+		insertIntoShard(shard, cachedIcon, false);
+	}
+
+	return true;
+}
+
+uint64_t CachedIcons::hashPath(const std::wstring &filePath)
+{
+	return HashString(filePath);
+}
+
+// Class keys use a '|' prefix, which can't appear in a path, so they won't
+// clash with path keys.
+uint64_t CachedIcons::hashClass(const std::wstring &filePath, ItemType itemType)
+{
+	if (itemType == ItemType::Folder)
+	{
+		return HashString(L"|folder|");
+	}
+
+	std::wstring extension;
+	auto fileNameStart = filePath.find_last_of(L"\\/");
+	auto extensionStart = filePath.find_last_of(L'.');
+
+	if (extensionStart != std::wstring::npos
+		&& (fileNameStart == std::wstring::npos || extensionStart > fileNameStart))
+	{
+		extension = filePath.substr(extensionStart);
+	}
+
+	// Extensions are case-insensitive. Only ASCII characters are folded here,
+	// which covers almost every extension in use.
+	for (auto &c : extension)
+	{
+		if (c >= L'A' && c <= L'Z')
+		{
+			c = c - L'A' + L'a';
+		}
+	}
+
+	return HashString(extension, HashString(L"|file|"));
+}
+
+CachedIcons::Shard &CachedIcons::getShard(uint64_t key)
+{
+	// The lower bits of the key are used by the hashed index within each
+	// shard, so the upper bits are used to pick the shard.
+	return *m_shards[(key >> 32) % m_shards.size()];
+}
+
+uint32_t CachedIcons::internLocationFile(const std::wstring &file)
+{
+	{
+		std::shared_lock<std::shared_mutex> lock(m_locationFilesMutex);
+
+		auto itr = m_locationFileIds.find(file);
+
+		if (itr != m_locationFileIds.end())
+		{
+			return itr->second;
+		}
+	}
+
+	std::unique_lock<std::shared_mutex> lock(m_locationFilesMutex);
+
+	auto [itr, inserted] =
+		m_locationFileIds.insert({ file, static_cast<uint32_t>(m_locationFiles.size()) });
+
+	if (inserted)
+	{
+		m_locationFiles.push_back(file);
+	}
 
-	auto sequenceItr = m_cachedIconSet.iterator_to(*itr);
-	m_cachedIconSet.relocate(m_cachedIconSet.begin(), sequenceItr);
+	return itr->second;
 }
 
-CachedIcons::iterator CachedIcons::findByPath(const std::wstring &filePath)
+std::wstring CachedIcons::getLocationFile(uint32_t locationFileId) const
 {
-	CachedIconSetByPath &pathIndex = m_cachedIconSet.get<1>();
-	return pathIndex.find(filePath);
+	std::shared_lock<std::shared_mutex> lock(m_locationFilesMutex);
+	return m_locationFiles[locationFileId];
 }
\ No newline at end of file
@@ -4,39 +4,153 @@
 
 #pragma once
 
+#include "MemoryAccounting.h"
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/sequenced_index.hpp>
 #include <boost/multi_index_container.hpp>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
-struct CachedIcon
+// The file (and index within that file) that an icon is loaded from. Unlike
+// an index into the system image list, this stays the same across sessions.
+struct IconLocation
 {
-	std::wstring filePath;
-	int iconIndex;
+	std::wstring file;
+	int index;
 };
 
+// Additional information about an icon, as reported by the shell when the
+// icon was retrieved.
+struct IconDetails
+{
+	enum class ItemType
+	{
+		Unknown,
+		File,
+		Folder
+	};
+
+	ItemType itemType = ItemType::Unknown;
+
+	// Indicates that every item of the same type (i.e. every file with the
+	// same extension, or every folder) shares this icon.
+	bool perClass = false;
+
+	std::optional<IconLocation> location;
+};
+
+// Caches system image list icon indexes, so that an icon can be shown
+// immediately, before a full (and potentially slow) icon lookup has
+// completed.
+//
+// Entries are keyed by a 64-bit hash of the item's path, rather than the
+// path itself. The icons stored here are only ever used as placeholders, so
+// the (extremely unlikely) event of a hash collision would simply result in
+// the wrong icon being shown briefly. Icons that are shared by an entire
+// class of items (e.g. all .txt files) are stored once, under a key derived
+// from the class, rather than once per item.
+//
+// The cache is split into a number of independently locked shards and can
+// be safely accessed from multiple threads. Each shard removes its least
+// recently added/updated icons once it's full.
 class CachedIcons
 {
 public:
+	using ItemType = IconDetails::ItemType;
+
+	// Maps an icon location into the system image list. This is used to
+	// restore entries that were loaded from a previous session.
+	using LocationResolver = std::function<std::optional<int>(const IconLocation &location)>;
+
+	static constexpr std::size_t DEFAULT_NUM_SHARDS = 16;
+
+	CachedIcons(std::size_t maxItems, LocationResolver locationResolver = nullptr,
+		std::size_t numShards = DEFAULT_NUM_SHARDS);
+
+	CachedIcons(const CachedIcons &) = delete;
+	CachedIcons &operator=(const CachedIcons &) = delete;
+
+	std::optional<int> findByPath(
+		const std::wstring &filePath, ItemType itemType = ItemType::Unknown);
+	void addOrUpdateFileIcon(const std::wstring &filePath, int iconIndex);
+	void addOrUpdateFileIcon(
+		const std::wstring &filePath, int iconIndex, const IconDetails &iconDetails);
+
+	std::size_t size() const;
+
+	// Returns the memory used by the cached entries. This doesn't include the
+	// memory used by the icons themselves, which are owned by the system image
+	// list.
+	std::size_t getMemoryUsage() const;
+
+	// Only entries that have an icon location are saved. Entries that are
+	// loaded will be resolved (using the LocationResolver passed to the
+	// constructor) the first time they're retrieved.
+	void save(std::ostream &stream) const;
+	bool load(std::istream &stream);
+
+	static uint64_t hashPath(const std::wstring &filePath);
+	static uint64_t hashClass(const std::wstring &filePath, ItemType itemType);
+
+private:
+	static constexpr int UNRESOLVED_ICON_INDEX = -1;
+	static constexpr uint32_t NO_LOCATION = UINT32_MAX;
+
+	struct CachedIcon
+	{
+		uint64_t key;
+		int iconIndex;
+		uint32_t locationFileId;
+		int locationIndex;
+	};
+
 	typedef boost::multi_index_container<CachedIcon,
 		boost::multi_index::indexed_by<boost::multi_index::sequenced<>,
 			boost::multi_index::hashed_unique<
-				boost::multi_index::member<CachedIcon, std::wstring, &CachedIcon::filePath>>>>
+				boost::multi_index::member<CachedIcon, uint64_t, &CachedIcon::key>>>,
+		CountingAllocator<CachedIcon>>
 		CachedIconSet;
 
-	using CachedIconSetByPath = CachedIconSet::nth_index<1>::type;
-	using iterator = CachedIconSetByPath::iterator;
+	struct Shard
+	{
+		explicit Shard(MemoryCounter *memoryCounter) :
+			cachedIconSet(CachedIconSet::ctor_args_list(),
+				CountingAllocator<CachedIcon>(memoryCounter))
+		{
+		}
 
-	CachedIcons(std::size_t maxItems);
+		CachedIconSet cachedIconSet;
+		mutable std::shared_mutex mutex;
+	};
 
-	iterator end();
+	Shard &getShard(uint64_t key);
+	std::optional<int> findByKey(uint64_t key);
+	void addOrUpdate(const CachedIcon &cachedIcon);
+	void insertIntoShard(Shard &shard, const CachedIcon &cachedIcon, bool mostRecent);
 
-	void addOrUpdateFileIcon(const std::wstring &filePath, int iconIndex);
-	void insert(const CachedIcon &cachedIcon);
-	void replace(CachedIconSetByPath::iterator itr, const CachedIcon &cachedIcon);
-	iterator findByPath(const std::wstring &filePath);
+	uint32_t internLocationFile(const std::wstring &file);
+	std::wstring getLocationFile(uint32_t locationFileId) const;
 
-private:
-	CachedIconSet m_cachedIconSet;
-	std::size_t m_maxItems;
+	// Shared by all shards. This needs to be declared before the shards, since
+	// they use it until they're destroyed.
+	MemoryCounter m_memoryCounter;
+
+	std::vector<std::unique_ptr<Shard>> m_shards;
+	const std::size_t m_maxItemsPerShard;
+	const LocationResolver m_locationResolver;
+
+	// Many icons are loaded from the same small set of files, so each file
+	// name is only stored once.
+	std::deque<std::wstring> m_locationFiles;
+	std::unordered_map<std::wstring, uint32_t> m_locationFileIds;
+	mutable std::shared_mutex m_locationFilesMutex;
 };
\ No newline at end of file
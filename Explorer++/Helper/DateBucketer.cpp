@@ -0,0 +1,73 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "DateBucketer.h"
+#include <algorithm>
+
+DateBucketer::DateBucketer(
+	const boost::gregorian::date &today, LocalDateToTimestamp localDateToTimestamp) :
+	m_today(today)
+{
+	using namespace boost::gregorian;
+
+	// Note that this assumes that Sunday is the first day of the week.
+	date startOfWeek = today - days(today.day_of_week().as_number());
+	date startOfMonth = date(today.year(), today.month(), 1);
+	date startOfYear = date(today.year(), 1, 1);
+
+	// The start date of each bucket, from Today through to LastYear. Anything
+	// on or after the first date is in the future.
+	std::array<date, NUM_BOUNDARIES> startDates = { today + days(1), today, today - days(1),
+		startOfWeek, startOfWeek - weeks(1), startOfMonth, startOfMonth - months(1), startOfYear,
+		startOfYear - years(1) };
+
+	for (size_t i = 0; i < NUM_BOUNDARIES; i++)
+	{
+		m_boundaries[i] = localDateToTimestamp(startDates[i]);
+	}
+
+	// The start dates aren't necessarily in order (e.g. the start of the week
+	// can be before the start of the month). A bucket only applies if none of
+	// the previous buckets do, so each boundary is capped by the ones before
+	// it. That leaves any bucket that's covered by a more recent one empty.
+	for (size_t i = 1; i < NUM_BOUNDARIES; i++)
+	{
+		m_boundaries[i] = std::min(m_boundaries[i], m_boundaries[i - 1]);
+	}
+}
+
+DateBucket DateBucketer::Classify(uint64_t timestamp) const
+{
+	int bucket = 0;
+
+	for (uint64_t boundary : m_boundaries)
+	{
+		bucket += (timestamp < boundary);
+	}
+
+	return static_cast<DateBucket>(bucket);
+}
+
+// The comparisons here don't involve any branches, so this loop can be
+// vectorized by the compiler.
+void DateBucketer::ClassifyAll(const uint64_t *timestamps, DateBucket *buckets, size_t count) const
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		int bucket = 0;
+
+		for (uint64_t boundary : m_boundaries)
+		{
+			bucket += (timestamps[i] < boundary);
+		}
+
+		buckets[i] = static_cast<DateBucket>(bucket);
+	}
+}
+
+const boost::gregorian::date &DateBucketer::GetToday() const
+{
+	return m_today;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <boost/date_time/gregorian/gregorian_types.hpp>
+#include <array>
+#include <cstdint>
+#include <functional>
+
+// The buckets used when describing a date relative to the current day. These
+// are ordered from the most recent to the least recent.
+enum class DateBucket
+{
+	Future,
+	Today,
+	Yesterday,
+	ThisWeek,
+	LastWeek,
+	ThisMonth,
+	LastMonth,
+	ThisYear,
+	LastYear,
+	LongAgo
+};
+
+// Classifies timestamps into date buckets (today, yesterday, this week, etc).
+// The boundaries between the buckets are calculated once, up front, so that
+// classifying a timestamp only involves a fixed set of integer comparisons.
+//
+// Timestamps use the same units as a FILETIME (i.e. 100-nanosecond intervals
+// since January 1, 1601 UTC), which means that a file time can be classified
+// directly, without first being converted to a local date.
+class DateBucketer
+{
+public:
+	// Returns the timestamp at which the specified local date begins.
+	using LocalDateToTimestamp = std::function<uint64_t(const boost::gregorian::date &localDate)>;
+
+	DateBucketer(const boost::gregorian::date &today, LocalDateToTimestamp localDateToTimestamp);
+
+	DateBucket Classify(uint64_t timestamp) const;
+	void ClassifyAll(const uint64_t *timestamps, DateBucket *buckets, size_t count) const;
+
+	const boost::gregorian::date &GetToday() const;
+
+private:
+	static constexpr size_t NUM_BOUNDARIES = static_cast<size_t>(DateBucket::LongAgo);
+
+	boost::gregorian::date m_today;
+
+	// Each entry is the earliest timestamp that belongs to the corresponding
+	// bucket (or a more recent one). The entries never increase, so the
+	// bucket for a timestamp is simply the number of entries it's less than.
+	std::array<uint64_t, NUM_BOUNDARIES> m_boundaries;
+};
\ No newline at end of file
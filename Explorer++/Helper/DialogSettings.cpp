@@ -15,6 +15,7 @@
 #include "RegistrySettings.h"
 #include "WindowHelper.h"
 #include "XMLSettings.h"
+#include "XmlStream.h"
 
 const TCHAR DialogSettings::SETTING_POSITION[] = _T("Position");
 const TCHAR DialogSettings::SETTING_POSITION_X[] = _T("PosX");
@@ -87,71 +88,64 @@ void DialogSettings::LoadRegistrySettings(HKEY hParentKey)
 	}
 }
 
-void DialogSettings::SaveXMLSettings(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pe)
+void DialogSettings::SaveXMLSettings(XmlStreamWriter &writer)
 {
 	if (!m_bStateSaved)
 	{
 		return;
 	}
 
-	BSTR bstr_wsntt = SysAllocString(L"\n\t\t");
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom, bstr_wsntt, pe);
-	SysFreeString(bstr_wsntt);
-
-	IXMLDOMElement *pParentNode = nullptr;
-	NXMLSettings::CreateElementNode(
-		pXMLDom, &pParentNode, pe, _T("DialogState"), m_szSettingsKey.c_str());
+	NXMLSettings::StartNamedElement(writer, _T("DialogState"), m_szSettingsKey.c_str());
 
 	if (m_bSavePosition)
 	{
-		NXMLSettings::AddAttributeToNode(
-			pXMLDom, pParentNode, SETTING_POSITION_X, NXMLSettings::EncodeIntValue(m_ptDialog.x));
-		NXMLSettings::AddAttributeToNode(
-			pXMLDom, pParentNode, SETTING_POSITION_Y, NXMLSettings::EncodeIntValue(m_ptDialog.y));
-		NXMLSettings::AddAttributeToNode(
-			pXMLDom, pParentNode, SETTING_WIDTH, NXMLSettings::EncodeIntValue(m_iWidth));
-		NXMLSettings::AddAttributeToNode(
-			pXMLDom, pParentNode, SETTING_HEIGHT, NXMLSettings::EncodeIntValue(m_iHeight));
+		writer.WriteAttribute(SETTING_POSITION_X, NXMLSettings::EncodeIntValue(m_ptDialog.x));
+		writer.WriteAttribute(SETTING_POSITION_Y, NXMLSettings::EncodeIntValue(m_ptDialog.y));
+		writer.WriteAttribute(SETTING_WIDTH, NXMLSettings::EncodeIntValue(m_iWidth));
+		writer.WriteAttribute(SETTING_HEIGHT, NXMLSettings::EncodeIntValue(m_iHeight));
 	}
 
-	SaveExtraXMLSettings(pXMLDom, pParentNode);
+	SaveExtraXMLSettings(writer);
+
+	writer.EndElement();
 }
 
-void DialogSettings::LoadXMLSettings(IXMLDOMNamedNodeMap *pam, long lChildNodes)
+void DialogSettings::LoadXMLSettings(const XmlStreamReader &reader)
 {
-	IXMLDOMNode *pNode = nullptr;
-	BSTR bstrName;
-	BSTR bstrValue;
-
-	for (int i = 1; i < lChildNodes; i++)
+	for (size_t i = 0; i < reader.GetNumAttributes(); i++)
 	{
-		pam->get_item(i, &pNode);
+		const WCHAR *wszName = reader.GetAttributeName(i).c_str();
+		const WCHAR *wszValue = reader.GetAttributeValue(i).c_str();
 
-		pNode->get_nodeName(&bstrName);
-		pNode->get_text(&bstrValue);
+		/* The name attribute identifies the dialog
+		itself, so it can be skipped. */
+		if (lstrcmp(wszName, _T("name")) == 0)
+		{
+			continue;
+		}
 
 		bool bHandled = false;
 
 		if (m_bSavePosition)
 		{
-			if (lstrcmpi(bstrName, SETTING_POSITION_X) == 0)
+			if (lstrcmpi(wszName, SETTING_POSITION_X) == 0)
 			{
-				m_ptDialog.x = NXMLSettings::DecodeIntValue(bstrValue);
+				m_ptDialog.x = NXMLSettings::DecodeIntValue(wszValue);
 				bHandled = true;
 			}
-			else if (lstrcmpi(bstrName, SETTING_POSITION_Y) == 0)
+			else if (lstrcmpi(wszName, SETTING_POSITION_Y) == 0)
 			{
-				m_ptDialog.y = NXMLSettings::DecodeIntValue(bstrValue);
+				m_ptDialog.y = NXMLSettings::DecodeIntValue(wszValue);
 				bHandled = true;
 			}
-			else if (lstrcmpi(bstrName, SETTING_WIDTH) == 0)
+			else if (lstrcmpi(wszName, SETTING_WIDTH) == 0)
 			{
-				m_iWidth = NXMLSettings::DecodeIntValue(bstrValue);
+				m_iWidth = NXMLSettings::DecodeIntValue(wszValue);
 				bHandled = true;
 			}
-			else if (lstrcmpi(bstrName, SETTING_HEIGHT) == 0)
+			else if (lstrcmpi(wszName, SETTING_HEIGHT) == 0)
 			{
-				m_iHeight = NXMLSettings::DecodeIntValue(bstrValue);
+				m_iHeight = NXMLSettings::DecodeIntValue(wszValue);
 				bHandled = true;
 			}
 		}
@@ -160,7 +154,7 @@ void DialogSettings::LoadXMLSettings(IXMLDOMNamedNodeMap *pam, long lChildNodes)
 		{
 			/* Pass the node name and value to any
 			descendant class to handle. */
-			LoadExtraXMLSettings(bstrName, bstrValue);
+			LoadExtraXMLSettings(wszName, wszValue);
 		}
 	}
 
@@ -191,16 +185,15 @@ void DialogSettings::LoadExtraRegistrySettings(HKEY hKey)
 	UNREFERENCED_PARAMETER(hKey);
 }
 
-void DialogSettings::SaveExtraXMLSettings(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pParentNode)
+void DialogSettings::SaveExtraXMLSettings(XmlStreamWriter &writer)
 {
-	UNREFERENCED_PARAMETER(pXMLDom);
-	UNREFERENCED_PARAMETER(pParentNode);
+	UNREFERENCED_PARAMETER(writer);
 }
 
-void DialogSettings::LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue)
+void DialogSettings::LoadExtraXMLSettings(const WCHAR *wszName, const WCHAR *wszValue)
 {
-	UNREFERENCED_PARAMETER(bstrName);
-	UNREFERENCED_PARAMETER(bstrValue);
+	UNREFERENCED_PARAMETER(wszName);
+	UNREFERENCED_PARAMETER(wszValue);
 }
 
 void DialogSettings::SaveDialogPosition(HWND hDlg)
@@ -5,11 +5,13 @@
 #pragma once
 
 #include "Macros.h"
-#include <MsXml2.h>
 #include <objbase.h>
 #include <list>
 #include <string>
 
+class XmlStreamReader;
+class XmlStreamWriter;
+
 class DialogSettings
 {
 public:
@@ -19,8 +21,8 @@ public:
 	void SaveRegistrySettings(HKEY hParentKey);
 	void LoadRegistrySettings(HKEY hParentKey);
 
-	void SaveXMLSettings(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pe);
-	void LoadXMLSettings(IXMLDOMNamedNodeMap *pam, long lChildNodes);
+	void SaveXMLSettings(XmlStreamWriter &writer);
+	void LoadXMLSettings(const XmlStreamReader &reader);
 
 	bool GetSettingsKey(TCHAR *out, size_t cchMax) const;
 
@@ -42,8 +44,8 @@ private:
 	virtual void SaveExtraRegistrySettings(HKEY hKey);
 	virtual void LoadExtraRegistrySettings(HKEY hKey);
 
-	virtual void SaveExtraXMLSettings(IXMLDOMDocument *pXMLDom, IXMLDOMElement *pParentNode);
-	virtual void LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue);
+	virtual void SaveExtraXMLSettings(XmlStreamWriter &writer);
+	virtual void LoadExtraXMLSettings(const WCHAR *wszName, const WCHAR *wszValue);
 
 	const std::wstring m_szSettingsKey;
 	const bool m_bSavePosition;
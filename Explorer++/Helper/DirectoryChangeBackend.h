@@ -0,0 +1,74 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// The types of change a watch can be notified about. The values match the
+// corresponding FILE_NOTIFY_CHANGE_* flags, so on Windows, a filter can be
+// passed straight through to ReadDirectoryChangesW.
+namespace DirectoryChangeFilter
+{
+constexpr uint32_t FileName = 0x1;
+constexpr uint32_t DirName = 0x2;
+constexpr uint32_t Attributes = 0x4;
+constexpr uint32_t Size = 0x8;
+constexpr uint32_t LastWrite = 0x10;
+constexpr uint32_t LastAccess = 0x20;
+constexpr uint32_t Creation = 0x40;
+constexpr uint32_t Security = 0x100;
+}
+
+// The values match the corresponding FILE_ACTION_* values.
+enum class DirectoryChangeAction : uint32_t
+{
+	Added = 1,
+	Removed = 2,
+	Modified = 3,
+	RenamedOldName = 4,
+	RenamedNewName = 5
+};
+
+struct DirectoryWatchRequest
+{
+	std::wstring path;
+	uint32_t filter;
+	bool watchSubtree;
+};
+
+struct DirectoryChangeEvent
+{
+	int watchId;
+	DirectoryChangeAction action;
+
+	// The name of the item that changed, relative to the watched directory.
+	std::wstring fileName;
+};
+
+// Provides the platform-specific part of SharedDirectoryMonitor. AddWatch()
+// and RemoveWatch() can be called from any thread. WaitForEvents() is only
+// ever called from a single thread.
+class DirectoryChangeBackend
+{
+public:
+	virtual ~DirectoryChangeBackend() = default;
+
+	// Returns the ID of the new watch. IDs are never reused.
+	virtual std::optional<int> AddWatch(const DirectoryWatchRequest &request) = 0;
+
+	// Stops the watch. Events that have already been queued for the watch may
+	// still be returned from WaitForEvents().
+	virtual void RemoveWatch(int watchId) = 0;
+
+	// Blocks until at least one change has been detected, or Wake() has been
+	// called. Any events are appended to the vector, which may be left empty.
+	virtual void WaitForEvents(std::vector<DirectoryChangeEvent> &events) = 0;
+
+	// Causes a pending (or the next) call to WaitForEvents() to return.
+	virtual void Wake() = 0;
+};
\ No newline at end of file
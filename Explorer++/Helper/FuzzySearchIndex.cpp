@@ -0,0 +1,721 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "FuzzySearchIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <cwctype>
+#include <utility>
+
+namespace
+{
+	// Used to pad the trigrams that mark the start of a word. This character
+	// won't appear in any normalized text.
+	constexpr wchar_t PADDING_CHARACTER = L'\0';
+
+	// Matches in the detail text count for less than matches in the title.
+	constexpr double DETAIL_MATCH_WEIGHT = 0.5;
+
+	constexpr double PREFIX_MATCH_SCORE = 1;
+	constexpr double WORD_START_MATCH_SCORE = 0.75;
+	constexpr double SUBSTRING_MATCH_SCORE = 0.5;
+
+	// Determines how much frecency affects the ranking of a result, relative to
+	// the quality of the text match.
+	constexpr double FRECENCY_WEIGHT = 0.1;
+
+	// A list of slots is considered sparse, relative to a posting list (or the
+	// index as a whole), if it's at least this many times shorter. Sparse
+	// lists are processed one slot at a time. Otherwise, it's quicker to walk
+	// through the longer list in order.
+	constexpr std::size_t SPARSE_LIST_RATIO = 16;
+
+	bool IsWordCharacter(wchar_t c)
+	{
+		return std::iswalnum(c);
+	}
+}
+
+void FuzzySearchIndex::AddOrUpdate(
+	const std::wstring &key, std::wstring_view title, std::wstring_view detail)
+{
+	std::wstring normalizedTitle = Normalize(title);
+	std::wstring normalizedDetail = Normalize(detail);
+
+	Usage usage;
+	auto itr = m_slotsByKey.find(key);
+
+	if (itr != m_slotsByKey.end())
+	{
+		const Document &existingDocument = m_documents[itr->second];
+
+		if (existingDocument.title == normalizedTitle
+			&& existingDocument.detail == normalizedDetail)
+		{
+			return;
+		}
+
+		// Entries in the posting lists can't be cheaply removed, so the
+		// existing slot is retired and the updated document is indexed in a
+		// new slot.
+		usage = existingDocument.usage;
+		RemoveSlot(itr->second);
+	}
+
+	auto slot = static_cast<Slot>(m_documents.size());
+	m_documents.push_back(
+		{ key, std::move(normalizedTitle), std::move(normalizedDetail), usage, true });
+	m_slotsByKey[key] = slot;
+	IndexDocument(slot);
+
+	MaybeCompact();
+}
+
+void FuzzySearchIndex::Remove(const std::wstring &key)
+{
+	auto itr = m_slotsByKey.find(key);
+
+	if (itr == m_slotsByKey.end())
+	{
+		return;
+	}
+
+	RemoveSlot(itr->second);
+	m_slotsByKey.erase(itr);
+
+	MaybeCompact();
+}
+
+void FuzzySearchIndex::Clear()
+{
+	m_documents.clear();
+	m_slotsByKey.clear();
+	m_postings.clear();
+	m_deadSlots = 0;
+}
+
+void FuzzySearchIndex::RecordUse(const std::wstring &key, Clock::time_point time)
+{
+	auto itr = m_slotsByKey.find(key);
+
+	if (itr == m_slotsByKey.end())
+	{
+		return;
+	}
+
+	Usage &usage = m_documents[itr->second].usage;
+	usage.count++;
+	usage.lastUse = std::max(usage.lastUse, time);
+}
+
+std::vector<FuzzySearchIndex::Result> FuzzySearchIndex::Search(
+	std::wstring_view query, std::size_t maxResults, Clock::time_point now) const
+{
+	std::wstring normalizedQuery = Normalize(query);
+	std::vector<std::wstring_view> terms;
+
+	for (std::size_t i = 0; i < normalizedQuery.size();)
+	{
+		while (i < normalizedQuery.size() && std::iswspace(normalizedQuery[i]))
+		{
+			i++;
+		}
+
+		std::size_t start = i;
+
+		while (i < normalizedQuery.size() && !std::iswspace(normalizedQuery[i]))
+		{
+			i++;
+		}
+
+		if (i > start)
+		{
+			terms.push_back(std::wstring_view(normalizedQuery).substr(start, i - start));
+		}
+	}
+
+	if (terms.empty() || maxResults == 0)
+	{
+		return {};
+	}
+
+	std::vector<TermQuery> termQueries;
+
+	for (auto term : terms)
+	{
+		termQueries.push_back(PrepareTerm(term));
+	}
+
+	// Matching the most selective terms first means that fewer documents have
+	// to be checked against the remaining terms.
+	std::stable_sort(termQueries.begin(), termQueries.end(),
+		[](const TermQuery &first, const TermQuery &second) { return first.cost < second.cost; });
+
+	// A document matches the query if it matches every term. Its score for each
+	// term is the fraction of the term's trigrams it contains, plus a bonus if
+	// it contains the term exactly.
+	std::vector<std::uint16_t> counts(m_documents.size(), 0);
+	TermMatch match;
+	TermMatch nextMatch;
+
+	for (std::size_t i = 0; i < termQueries.size(); i++)
+	{
+		nextMatch.slots.clear();
+		nextMatch.scores.clear();
+		nextMatch.maxTextScores.clear();
+		MatchTerm(termQueries[i], (i == 0) ? nullptr : &match, counts, nextMatch);
+
+		if (nextMatch.slots.empty())
+		{
+			return {};
+		}
+
+		std::swap(match, nextMatch);
+	}
+
+	// Documents with the same score are returned in the order they were added.
+	auto ranksBefore = [](const std::pair<double, Slot> &first,
+						   const std::pair<double, Slot> &second) {
+		if (first.first != second.first)
+		{
+			return first.first > second.first;
+		}
+
+		return first.second < second.second;
+	};
+	auto ranksAfter = [&ranksBefore](const std::pair<double, Slot> &first,
+						  const std::pair<double, Slot> &second) {
+		return ranksBefore(second, first);
+	};
+
+	// This is a heap with the worst of the current results at the front.
+	std::vector<std::pair<double, Slot>> rankedSlots;
+
+	auto addRankedSlot = [&](const std::pair<double, Slot> &rankedSlot) {
+		if (rankedSlots.size() < maxResults)
+		{
+			rankedSlots.push_back(rankedSlot);
+			std::push_heap(rankedSlots.begin(), rankedSlots.end(), ranksBefore);
+		}
+		else if (ranksBefore(rankedSlot, rankedSlots.front()))
+		{
+			std::pop_heap(rankedSlots.begin(), rankedSlots.end(), ranksBefore);
+			rankedSlots.back() = rankedSlot;
+			std::push_heap(rankedSlots.begin(), rankedSlots.end(), ranksBefore);
+		}
+	};
+
+	// Checking whether a document contains each term exactly requires
+	// searching its text, which is relatively expensive when there are a large
+	// number of candidates. So, each document that could contain a term is
+	// given the highest score it could have and those documents are then
+	// checked from best to worst, stopping once none of the remaining documents
+	// could make it into the results. Each of these entries refers to an index
+	// in the match, rather than a slot. As the slots are sorted, the order is
+	// the same.
+	std::vector<std::pair<double, Slot>> maxScores;
+
+	for (Slot i = 0; i < match.slots.size(); i++)
+	{
+		Slot slot = match.slots[i];
+		double score = ApplyFrecency(
+			match.scores[i] + match.maxTextScores[i], m_documents[slot].usage, now);
+
+		if (match.maxTextScores[i] > 0)
+		{
+			maxScores.emplace_back(score, i);
+		}
+		else
+		{
+			addRankedSlot({ score, slot });
+		}
+	}
+
+	std::make_heap(maxScores.begin(), maxScores.end(), ranksAfter);
+
+	for (auto end = maxScores.end(); end != maxScores.begin(); --end)
+	{
+		if (rankedSlots.size() == maxResults
+			&& !ranksBefore(maxScores.front(), rankedSlots.front()))
+		{
+			break;
+		}
+
+		Slot index = maxScores.front().second;
+		std::pop_heap(maxScores.begin(), end, ranksAfter);
+
+		Slot slot = match.slots[index];
+		const Document &document = m_documents[slot];
+		double textScore = 0;
+
+		for (auto term : terms)
+		{
+			textScore += GetTextMatchScore(document, term);
+		}
+
+		addRankedSlot(
+			{ ApplyFrecency(match.scores[index] + textScore, document.usage, now), slot });
+	}
+
+	std::sort(rankedSlots.begin(), rankedSlots.end(), ranksBefore);
+
+	std::vector<Result> results;
+
+	for (const auto &[score, slot] : rankedSlots)
+	{
+		results.push_back({ m_documents[slot].key, score });
+	}
+
+	return results;
+}
+
+FuzzySearchIndex::TermQuery FuzzySearchIndex::PrepareTerm(std::wstring_view term) const
+{
+	static const std::vector<Slot> emptyPostings;
+
+	TermQuery query;
+	query.term = term;
+	query.requiredMatches = 1;
+	query.numCandidateLists = 0;
+	query.cost = 0;
+	query.wordStartPostings = nullptr;
+
+	std::vector<Trigram> trigrams;
+
+	if (term.size() < 3)
+	{
+		// Short terms are only matched against the start of each word.
+		if (!IsWordCharacter(term[0]) || (term.size() == 2 && !IsWordCharacter(term[1])))
+		{
+			return query;
+		}
+
+		trigrams.push_back((term.size() == 1)
+				? MakeTrigram(PADDING_CHARACTER, PADDING_CHARACTER, term[0])
+				: MakeTrigram(PADDING_CHARACTER, term[0], term[1]));
+	}
+	else
+	{
+		AddTrigrams(term, trigrams);
+		std::sort(trigrams.begin(), trigrams.end());
+		trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+		query.requiredMatches = std::max<std::size_t>(1,
+			static_cast<std::size_t>(std::ceil(trigrams.size() * MIN_TRIGRAM_MATCH_FRACTION)));
+
+		// If the term starts with a word character, a document can only
+		// contain it at the start of its title, or at the start of any other
+		// word, if the document has the matching word start trigram.
+		if (IsWordCharacter(term[0]))
+		{
+			auto itr = m_postings.find(IsWordCharacter(term[1])
+					? MakeTrigram(PADDING_CHARACTER, term[0], term[1])
+					: MakeTrigram(PADDING_CHARACTER, PADDING_CHARACTER, term[0]));
+			query.wordStartPostings = (itr != m_postings.end()) ? &itr->second : &emptyPostings;
+		}
+	}
+
+	for (Trigram trigram : trigrams)
+	{
+		auto itr = m_postings.find(trigram);
+		query.postings.push_back((itr != m_postings.end()) ? &itr->second : &emptyPostings);
+	}
+
+	std::sort(query.postings.begin(), query.postings.end(),
+		[](const auto *first, const auto *second) { return first->size() < second->size(); });
+
+	query.numCandidateLists = query.postings.size() - query.requiredMatches + 1;
+
+	for (std::size_t i = 0; i < query.numCandidateLists; i++)
+	{
+		query.cost += query.postings[i]->size();
+	}
+
+	return query;
+}
+
+// If a previous match is provided, only the documents in it are checked and
+// their existing scores are added to. Either way, the matching slots are
+// returned in sorted order.
+void FuzzySearchIndex::MatchTerm(const TermQuery &query, const TermMatch *previousMatch,
+	std::vector<std::uint16_t> &counts, TermMatch &match) const
+{
+	if (query.postings.empty())
+	{
+		return;
+	}
+
+	const std::vector<Slot> *candidates = nullptr;
+	std::vector<Slot> touchedSlots;
+	std::size_t firstCountedList = 0;
+
+	// Each document that's still under consideration has a non-zero count, so
+	// when there are existing candidates, their counts start at 1.
+	std::uint16_t initialCount = 0;
+
+	if (previousMatch)
+	{
+		initialCount = 1;
+		candidates = &previousMatch->slots;
+
+		for (Slot slot : *candidates)
+		{
+			counts[slot] = initialCount;
+		}
+	}
+	else
+	{
+		for (std::size_t i = 0; i < query.numCandidateLists; i++)
+		{
+			for (Slot slot : *query.postings[i])
+			{
+				if (counts[slot]++ == 0)
+				{
+					touchedSlots.push_back(slot);
+				}
+			}
+		}
+
+		// Slots that came from more than one list need to be put back in order.
+		if (query.numCandidateLists > 1
+			&& touchedSlots.size() * SPARSE_LIST_RATIO <= counts.size())
+		{
+			std::sort(touchedSlots.begin(), touchedSlots.end());
+		}
+		else if (query.numCandidateLists > 1)
+		{
+			touchedSlots.clear();
+
+			for (Slot slot = 0; slot < counts.size(); slot++)
+			{
+				if (counts[slot] != 0)
+				{
+					touchedSlots.push_back(slot);
+				}
+			}
+		}
+
+		firstCountedList = query.numCandidateLists;
+		candidates = &touchedSlots;
+	}
+
+	// The remaining lists can only add matches to documents that have already
+	// been found.
+	for (std::size_t i = firstCountedList; i < query.postings.size(); i++)
+	{
+		const auto &postings = *query.postings[i];
+
+		if (candidates->size() * SPARSE_LIST_RATIO <= postings.size())
+		{
+			auto itr = postings.begin();
+
+			for (Slot slot : *candidates)
+			{
+				itr = std::lower_bound(itr, postings.end(), slot);
+
+				if (itr == postings.end())
+				{
+					break;
+				}
+
+				if (*itr == slot)
+				{
+					counts[slot]++;
+				}
+			}
+		}
+		else
+		{
+			for (Slot slot : postings)
+			{
+				counts[slot] += (counts[slot] != 0);
+			}
+		}
+	}
+
+	std::vector<Slot>::const_iterator wordStartItr;
+
+	if (query.wordStartPostings)
+	{
+		wordStartItr = query.wordStartPostings->begin();
+	}
+
+	for (std::size_t i = 0; i < candidates->size(); i++)
+	{
+		Slot slot = (*candidates)[i];
+		std::size_t numMatches = counts[slot] - initialCount;
+		counts[slot] = 0;
+
+		if (numMatches < query.requiredMatches || !m_documents[slot].live)
+		{
+			continue;
+		}
+
+		double score = static_cast<double>(numMatches) / query.postings.size();
+
+		// A document can only contain the term exactly if it contains all of
+		// the term's trigrams. And it can only contain the term at the start of
+		// a word if it has the corresponding word start trigram. These limits
+		// are checked here, since they don't require the document's text to be
+		// searched.
+		double maxTextScore = 0;
+
+		if (numMatches == query.postings.size())
+		{
+			maxTextScore = PREFIX_MATCH_SCORE;
+
+			if (query.wordStartPostings)
+			{
+				const auto &wordStartPostings = *query.wordStartPostings;
+				wordStartItr = std::lower_bound(wordStartItr, wordStartPostings.end(), slot);
+
+				if (wordStartItr == wordStartPostings.end() || *wordStartItr != slot)
+				{
+					maxTextScore = SUBSTRING_MATCH_SCORE;
+				}
+			}
+		}
+
+		if (previousMatch)
+		{
+			score += previousMatch->scores[i];
+			maxTextScore += previousMatch->maxTextScores[i];
+		}
+
+		match.slots.push_back(slot);
+		match.scores.push_back(score);
+		match.maxTextScores.push_back(maxTextScore);
+	}
+}
+
+double FuzzySearchIndex::GetTextMatchScore(const Document &document, std::wstring_view term)
+{
+	double titleScore = GetTextMatchScore(document.title, term);
+
+	// A match in the detail text can't score higher than this, so there's no
+	// need to check it.
+	if (titleScore >= DETAIL_MATCH_WEIGHT)
+	{
+		return titleScore;
+	}
+
+	return std::max(titleScore, DETAIL_MATCH_WEIGHT * GetTextMatchScore(document.detail, term));
+}
+
+double FuzzySearchIndex::GetTextMatchScore(std::wstring_view text, std::wstring_view term)
+{
+	auto index = text.find(term);
+
+	if (index == std::wstring_view::npos)
+	{
+		return 0;
+	}
+
+	if (index == 0)
+	{
+		return PREFIX_MATCH_SCORE;
+	}
+
+	for (; index != std::wstring_view::npos; index = text.find(term, index + 1))
+	{
+		if (IsWordStart(text, index))
+		{
+			return WORD_START_MATCH_SCORE;
+		}
+	}
+
+	return SUBSTRING_MATCH_SCORE;
+}
+
+double FuzzySearchIndex::ApplyFrecency(double score, const Usage &usage, Clock::time_point now)
+{
+	double frecency = GetFrecency(usage, now);
+
+	if (frecency == 0)
+	{
+		return score;
+	}
+
+	return score * (1 + FRECENCY_WEIGHT * std::log1p(frecency));
+}
+
+// Frecency is calculated in a similar way to Firefox, with each use weighted
+// by how recent the last use was.
+double FuzzySearchIndex::GetFrecency(const Usage &usage, Clock::time_point now)
+{
+	if (usage.count == 0)
+	{
+		return 0;
+	}
+
+	auto daysSinceLastUse =
+		std::chrono::duration_cast<std::chrono::hours>(now - usage.lastUse).count() / 24;
+	int weight;
+
+	if (daysSinceLastUse <= 4)
+	{
+		weight = 100;
+	}
+	else if (daysSinceLastUse <= 14)
+	{
+		weight = 70;
+	}
+	else if (daysSinceLastUse <= 31)
+	{
+		weight = 50;
+	}
+	else if (daysSinceLastUse <= 90)
+	{
+		weight = 30;
+	}
+	else
+	{
+		weight = 10;
+	}
+
+	return static_cast<double>(usage.count) * weight;
+}
+
+std::size_t FuzzySearchIndex::GetSize() const
+{
+	return m_slotsByKey.size();
+}
+
+std::size_t FuzzySearchIndex::GetMemoryUsage() const
+{
+	std::size_t total = m_documents.capacity() * sizeof(Document);
+
+	for (const auto &document : m_documents)
+	{
+		total += (document.key.capacity() + document.title.capacity()
+					 + document.detail.capacity())
+			* sizeof(wchar_t);
+	}
+
+	total += m_slotsByKey.bucket_count() * sizeof(void *);
+	total += m_slotsByKey.size() * (sizeof(std::pair<const std::wstring, Slot>) + sizeof(void *));
+
+	total += m_postings.bucket_count() * sizeof(void *);
+
+	for (const auto &[trigram, slots] : m_postings)
+	{
+		total += sizeof(std::pair<const Trigram, std::vector<Slot>>) + sizeof(void *);
+		total += slots.capacity() * sizeof(Slot);
+	}
+
+	return total;
+}
+
+std::wstring FuzzySearchIndex::Normalize(std::wstring_view text)
+{
+	std::wstring normalizedText(text);
+	std::transform(normalizedText.begin(), normalizedText.end(), normalizedText.begin(),
+		[](wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+	normalizedText.erase(
+		std::remove(normalizedText.begin(), normalizedText.end(), PADDING_CHARACTER),
+		normalizedText.end());
+	return normalizedText;
+}
+
+void FuzzySearchIndex::AddTrigrams(std::wstring_view text, std::vector<Trigram> &trigrams)
+{
+	for (std::size_t i = 0; i + 2 < text.size(); i++)
+	{
+		trigrams.push_back(MakeTrigram(text[i], text[i + 1], text[i + 2]));
+	}
+}
+
+void FuzzySearchIndex::AddWordStartTrigrams(std::wstring_view text, std::vector<Trigram> &trigrams)
+{
+	for (std::size_t i = 0; i < text.size(); i++)
+	{
+		if (!IsWordStart(text, i))
+		{
+			continue;
+		}
+
+		trigrams.push_back(MakeTrigram(PADDING_CHARACTER, PADDING_CHARACTER, text[i]));
+
+		if (i + 1 < text.size() && IsWordCharacter(text[i + 1]))
+		{
+			trigrams.push_back(MakeTrigram(PADDING_CHARACTER, text[i], text[i + 1]));
+		}
+	}
+}
+
+FuzzySearchIndex::Trigram FuzzySearchIndex::MakeTrigram(wchar_t c1, wchar_t c2, wchar_t c3)
+{
+	// Each character is stored in 21 bits, which is enough to hold any Unicode
+	// code point.
+	constexpr Trigram mask = 0x1FFFFF;
+	return ((static_cast<Trigram>(c1) & mask) << 42) | ((static_cast<Trigram>(c2) & mask) << 21)
+		| (static_cast<Trigram>(c3) & mask);
+}
+
+bool FuzzySearchIndex::IsWordStart(std::wstring_view text, std::size_t index)
+{
+	return IsWordCharacter(text[index]) && (index == 0 || !IsWordCharacter(text[index - 1]));
+}
+
+void FuzzySearchIndex::IndexDocument(Slot slot)
+{
+	const Document &document = m_documents[slot];
+
+	std::vector<Trigram> trigrams;
+	AddTrigrams(document.title, trigrams);
+	AddTrigrams(document.detail, trigrams);
+	AddWordStartTrigrams(document.title, trigrams);
+	AddWordStartTrigrams(document.detail, trigrams);
+
+	// Each slot appears at most once in any posting list.
+	std::sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+	for (Trigram trigram : trigrams)
+	{
+		m_postings[trigram].push_back(slot);
+	}
+}
+
+void FuzzySearchIndex::RemoveSlot(Slot slot)
+{
+	Document &document = m_documents[slot];
+	document.live = false;
+
+	// The strings aren't needed any more, so their memory can be released now.
+	document.title = std::wstring();
+	document.detail = std::wstring();
+
+	m_deadSlots++;
+}
+
+void FuzzySearchIndex::MaybeCompact()
+{
+	if (m_deadSlots < MIN_DEAD_SLOTS_BEFORE_COMPACTION || m_deadSlots < m_slotsByKey.size())
+	{
+		return;
+	}
+
+	std::vector<Document> liveDocuments;
+	liveDocuments.reserve(m_slotsByKey.size());
+
+	for (auto &document : m_documents)
+	{
+		if (document.live)
+		{
+			liveDocuments.push_back(std::move(document));
+		}
+	}
+
+	m_documents = std::move(liveDocuments);
+	m_postings.clear();
+	m_deadSlots = 0;
+
+	for (Slot slot = 0; slot < m_documents.size(); slot++)
+	{
+		m_slotsByKey[m_documents[slot].key] = slot;
+		IndexDocument(slot);
+	}
+}
\ No newline at end of file
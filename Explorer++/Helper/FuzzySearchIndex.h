@@ -0,0 +1,145 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// An in-memory index that supports incremental updates and fuzzy, ranked
+// searches over a set of documents. Each document is identified by a unique key
+// and has a title and a detail string (e.g. a name and a location). Searches are
+// case-insensitive.
+//
+// Text is indexed by trigram. Each query term of three or more characters
+// matches documents that contain a sufficient proportion of the term's
+// trigrams. That means that small typos are tolerated. Shorter terms match the
+// start of a word. Results are ranked by how closely each term matched, then
+// weighted by frecency (a combination of how often and how recently a document
+// was used).
+class FuzzySearchIndex
+{
+public:
+	using Clock = std::chrono::system_clock;
+
+	struct Result
+	{
+		std::wstring key;
+		double score;
+	};
+
+	// Adds the document, or updates it if a document with the same key already
+	// exists. Any usage information for the document is retained when it's
+	// updated.
+	void AddOrUpdate(const std::wstring &key, std::wstring_view title, std::wstring_view detail);
+	void Remove(const std::wstring &key);
+	void Clear();
+
+	// Records a use of the document, which will increase its frecency.
+	void RecordUse(const std::wstring &key, Clock::time_point time = Clock::now());
+
+	// Returns up to maxResults documents that match every term in the query,
+	// ordered from best to worst match.
+	std::vector<Result> Search(std::wstring_view query, std::size_t maxResults,
+		Clock::time_point now = Clock::now()) const;
+
+	std::size_t GetSize() const;
+	std::size_t GetMemoryUsage() const;
+
+private:
+	using Trigram = std::uint64_t;
+	using Slot = std::uint32_t;
+
+	// The fraction of a term's trigrams that need to be present in a document
+	// for the document to match.
+	static constexpr double MIN_TRIGRAM_MATCH_FRACTION = 0.6;
+
+	// Removed documents leave their slots (and entries in the posting lists) in
+	// place until this many have accumulated, at which point the index is
+	// rebuilt.
+	static constexpr std::size_t MIN_DEAD_SLOTS_BEFORE_COMPACTION = 1024;
+
+	struct Usage
+	{
+		int count = 0;
+		Clock::time_point lastUse;
+	};
+
+	struct Document
+	{
+		std::wstring key;
+		std::wstring title;
+		std::wstring detail;
+		Usage usage;
+		bool live;
+	};
+
+	// The posting lists that a single query term is matched against.
+	struct TermQuery
+	{
+		std::wstring_view term;
+
+		// Sorted from shortest to longest. A trigram that doesn't appear in
+		// the index has an empty list.
+		std::vector<const std::vector<Slot> *> postings;
+
+		std::size_t requiredMatches;
+
+		// A document can only have the required number of matches if it
+		// appears in at least one of this many of the shortest posting lists.
+		// Those lists are the only ones that need to be scanned in full.
+		std::size_t numCandidateLists;
+
+		// The number of entries in those lists. Terms with a lower cost are
+		// matched first.
+		std::size_t cost;
+
+		// Documents that could contain the term at the start of a word. This
+		// is null if that can't be determined from the index.
+		const std::vector<Slot> *wordStartPostings;
+	};
+
+	// The documents that match one or more terms, along with their combined
+	// scores for those terms.
+	struct TermMatch
+	{
+		std::vector<Slot> slots;
+
+		// These scores are based only on how many of each term's trigrams a
+		// document contains.
+		std::vector<double> scores;
+
+		// The highest additional score each document could have, if its text
+		// were searched for each term.
+		std::vector<double> maxTextScores;
+	};
+
+	static std::wstring Normalize(std::wstring_view text);
+	static void AddTrigrams(std::wstring_view text, std::vector<Trigram> &trigrams);
+	static void AddWordStartTrigrams(std::wstring_view text, std::vector<Trigram> &trigrams);
+	static Trigram MakeTrigram(wchar_t c1, wchar_t c2, wchar_t c3);
+	static bool IsWordStart(std::wstring_view text, std::size_t index);
+	static double GetTextMatchScore(const Document &document, std::wstring_view term);
+	static double GetTextMatchScore(std::wstring_view text, std::wstring_view term);
+
+	static double ApplyFrecency(double score, const Usage &usage, Clock::time_point now);
+	static double GetFrecency(const Usage &usage, Clock::time_point now);
+
+	void IndexDocument(Slot slot);
+	void RemoveSlot(Slot slot);
+	void MaybeCompact();
+	TermQuery PrepareTerm(std::wstring_view term) const;
+	void MatchTerm(const TermQuery &query, const TermMatch *previousMatch,
+		std::vector<std::uint16_t> &counts, TermMatch &match) const;
+
+	std::vector<Document> m_documents;
+	std::unordered_map<std::wstring, Slot> m_slotsByKey;
+	std::unordered_map<Trigram, std::vector<Slot>> m_postings;
+	std::size_t m_deadSlots = 0;
+};
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include "TimeHelper.h"
 #include <boost/date_time/gregorian/gregorian.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <optional>
 
 enum class VersionSubBlockType
 {
@@ -22,6 +23,8 @@ BOOL GetFileVersionValue(const TCHAR *szFullFileName, VersionSubBlockType subBlo
 	const TCHAR *szVersionInfo, TCHAR *szVersionBuffer, UINT cchMax);
 BOOL GetStringTableValue(void *pBlock, LangAndCodePage *plcp, UINT nItems,
 	const TCHAR *szVersionInfo, TCHAR *szVersionBuffer, UINT cchMax);
+BOOL FormatFriendlyTimeString(const TCHAR *dateComponent, const SYSTEMTIME *localSystemTime,
+	TCHAR *szBuffer, size_t cchMax);
 
 BOOL CreateFileTimeString(const FILETIME *utcFileTime,
 	TCHAR *szBuffer, size_t cchMax, BOOL bFriendlyDate)
@@ -34,7 +37,42 @@ BOOL CreateFileTimeString(const FILETIME *utcFileTime,
 		return FALSE;
 	}
 
-	return CreateSystemTimeString(&localSystemTime, szBuffer, cchMax, bFriendlyDate);
+	if (bFriendlyDate)
+	{
+		/* This function is called for every item shown
+		in the listview, so the date boundaries are only
+		calculated once per day (per thread). The file
+		time can then be classified directly. */
+		thread_local std::optional<DateBucketer> dateBucketer;
+
+		if (!dateBucketer
+			|| dateBucketer->GetToday() != boost::gregorian::day_clock::local_day())
+		{
+			dateBucketer.emplace(CreateDateBucketerForCurrentDay());
+		}
+
+		switch (dateBucketer->Classify(FileTimeToTimestamp(*utcFileTime)))
+		{
+		case DateBucket::Today:
+			ret = FormatFriendlyTimeString(_T("Today"), &localSystemTime, szBuffer, cchMax);
+			break;
+
+		case DateBucket::Yesterday:
+			ret = FormatFriendlyTimeString(_T("Yesterday"), &localSystemTime, szBuffer, cchMax);
+			break;
+
+		default:
+			ret = FALSE;
+			break;
+		}
+
+		if (ret)
+		{
+			return TRUE;
+		}
+	}
+
+	return CreateSystemTimeString(&localSystemTime, szBuffer, cchMax, FALSE);
 }
 
 BOOL CreateSystemTimeString(const SYSTEMTIME *localSystemTime,
@@ -106,6 +144,12 @@ BOOL CreateFriendlySystemTimeString(const SYSTEMTIME *localSystemTime,
 		return FALSE;
 	}
 
+	return FormatFriendlyTimeString(dateComponent, localSystemTime, szBuffer, cchMax);
+}
+
+BOOL FormatFriendlyTimeString(const TCHAR *dateComponent, const SYSTEMTIME *localSystemTime,
+	TCHAR *szBuffer, size_t cchMax)
+{
 	TCHAR timeComponent[512];
 	int timeFormatted = GetTimeFormat(LOCALE_USER_DEFAULT, LOCALE_USE_CP_ACP, localSystemTime,
 		nullptr, timeComponent, SIZEOF_ARRAY(timeComponent));
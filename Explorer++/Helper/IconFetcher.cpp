@@ -4,14 +4,14 @@
 
 #include "stdafx.h"
 #include "IconFetcher.h"
-#include "CachedIcons.h"
+#include "Tracing.h"
 #include "WindowSubclassWrapper.h"
 
-IconFetcher::IconFetcher(HWND hwnd, CachedIcons *cachedIcons) :
+IconFetcher::IconFetcher(HWND hwnd, IconResolutionService *iconResolutionService) :
 	m_hwnd(hwnd),
-	m_cachedIcons(cachedIcons),
-	m_iconThreadPool(1, std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED), CoUninitialize),
-	m_iconResultIDCounter(0)
+	m_iconResolutionService(iconResolutionService),
+	m_resultQueue(std::make_shared<IconResultQueue>(hwnd, WM_APP_ICON_RESULTS_READY)),
+	m_requestIdCounter(0)
 {
 	m_windowSubclasses.push_back(std::make_unique<WindowSubclassWrapper>(
 		hwnd, WindowSubclassStub, SUBCLASS_ID, reinterpret_cast<DWORD_PTR>(this)));
@@ -19,7 +19,9 @@ IconFetcher::IconFetcher(HWND hwnd, CachedIcons *cachedIcons) :
 
 IconFetcher::~IconFetcher()
 {
-	m_iconThreadPool.clear_queue();
+	// Requests may still be in progress, but their results will now be
+	// discarded.
+	m_resultQueue->Close();
 }
 
 LRESULT CALLBACK IconFetcher::WindowSubclassStub(
@@ -36,8 +38,8 @@ LRESULT CALLBACK IconFetcher::WindowSubclass(HWND hwnd, UINT msg, WPARAM wParam,
 {
 	switch (msg)
 	{
-	case WM_APP_ICON_RESULT_READY:
-		ProcessIconResult(static_cast<int>(wParam));
+	case WM_APP_ICON_RESULTS_READY:
+		ProcessIconResults();
 		return 0;
 		break;
 	}
@@ -47,136 +49,56 @@ LRESULT CALLBACK IconFetcher::WindowSubclass(HWND hwnd, UINT msg, WPARAM wParam,
 
 void IconFetcher::QueueIconTask(std::wstring_view path, Callback callback)
 {
-	int iconResultID = m_iconResultIDCounter++;
-
-	auto iconResult = m_iconThreadPool.push(
-		[this, iconResultID, copiedPath = std::wstring(path)](int id) -> std::optional<IconResult> {
-			UNREFERENCED_PARAMETER(id);
-
-			// SHGetFileInfo will fail for non-filesystem paths that are passed in
-			// as strings. For example, attempting to retrieve the icon for the
-			// recycle bin will fail if you pass the parsing path (i.e.
-			// ::{645FF040-5081-101B-9F08-00AA002F954E}). If, however, you pass the
-			// pidl, the function will succeed. Therefore, paths will always be
-			// converted to pidls first here.
-			unique_pidl_absolute pidl;
-			HRESULT hr =
-				SHParseDisplayName(copiedPath.c_str(), nullptr, wil::out_param(pidl), 0, nullptr);
-
-			if (FAILED(hr))
-			{
-				return std::nullopt;
-			}
-
-			auto iconIndex = FindIconAsync(pidl.get());
-
-			if (!iconIndex)
-			{
-				return std::nullopt;
-			}
-
-			IconResult result;
-			result.iconIndex = *iconIndex;
-			result.path = copiedPath;
-
-			PostMessage(m_hwnd, WM_APP_ICON_RESULT_READY, iconResultID, 0);
-
-			return result;
-		});
-
-	FutureResult futureResult;
-	futureResult.callback = callback;
-	futureResult.iconResult = std::move(iconResult);
-	m_iconResults.insert({ iconResultID, std::move(futureResult) });
+	int requestId = m_requestIdCounter++;
+	m_callbacks.insert({ requestId, callback });
+
+	m_iconResolutionService->QueueRequest(path, m_resultQueue, requestId);
 }
 
 void IconFetcher::QueueIconTask(PCIDLIST_ABSOLUTE pidl, Callback callback)
 {
-	int iconResultID = m_iconResultIDCounter++;
-
-	BasicItemInfo basicItemInfo;
-	basicItemInfo.pidl.reset(ILCloneFull(pidl));
-
-	auto iconResult = m_iconThreadPool.push(
-		[this, iconResultID, basicItemInfo](int id) -> std::optional<IconResult> {
-			UNREFERENCED_PARAMETER(id);
-
-			auto iconIndex = FindIconAsync(basicItemInfo.pidl.get());
-
-			if (!iconIndex)
-			{
-				return std::nullopt;
-			}
-
-			IconResult result;
-			result.iconIndex = *iconIndex;
+	int requestId = m_requestIdCounter++;
+	m_callbacks.insert({ requestId, callback });
 
-			TCHAR filePath[MAX_PATH];
-			HRESULT hr = GetDisplayName(basicItemInfo.pidl.get(), filePath,
-				static_cast<UINT>(std::size(filePath)), SHGDN_FORPARSING);
-
-			if (SUCCEEDED(hr))
-			{
-				result.path = filePath;
-			}
-
-			PostMessage(m_hwnd, WM_APP_ICON_RESULT_READY, iconResultID, 0);
-
-			return result;
-		});
-
-	FutureResult futureResult;
-	futureResult.callback = callback;
-	futureResult.iconResult = std::move(iconResult);
-	m_iconResults.insert({ iconResultID, std::move(futureResult) });
+	m_iconResolutionService->QueueRequest(pidl, m_resultQueue, requestId);
 }
 
-std::optional<int> IconFetcher::FindIconAsync(PCIDLIST_ABSOLUTE pidl)
+void IconFetcher::ProcessIconResults()
 {
-	// Must use SHGFI_ICON here, rather than SHGFO_SYSICONINDEX, or else
-	// icon overlays won't be applied.
-	SHFILEINFO shfi;
-	DWORD_PTR res = SHGetFileInfo(reinterpret_cast<LPCTSTR>(pidl), 0, &shfi, sizeof(shfi),
-		SHGFI_PIDL | SHGFI_ICON | SHGFI_OVERLAYINDEX);
+	auto results = m_resultQueue->TakeAll();
 
-	if (res == 0)
-	{
-		return std::nullopt;
-	}
+	TRACE_EVENT1("icons", "ProcessIconResults", "numResults", results.size());
 
-	DestroyIcon(shfi.hIcon);
-
-	return shfi.iIcon;
-}
-
-void IconFetcher::ProcessIconResult(int iconResultId)
-{
-	auto itr = m_iconResults.find(iconResultId);
-
-	if (itr == m_iconResults.end())
+	for (const auto &result : results)
 	{
-		return;
-	}
+		auto itr = m_callbacks.find(result.requestId);
 
-	auto &futureResult = itr->second;
-	auto result = futureResult.iconResult.get();
+		if (itr == m_callbacks.end())
+		{
+			continue;
+		}
 
-	if (!result)
-	{
-		// Icon lookup failed.
-		return;
-	}
+		// The callback may queue further requests, so it's removed from the
+		// map before being invoked.
+		auto callback = std::move(itr->second);
+		m_callbacks.erase(itr);
 
-	if (!result->path.empty())
-	{
-		m_cachedIcons->addOrUpdateFileIcon(result->path, result->iconIndex);
-	}
+		if (!result.iconIndex)
+		{
+			// Icon lookup failed.
+			continue;
+		}
 
-	futureResult.callback(result->iconIndex);
+		callback(*result.iconIndex);
+	}
 }
 
+// Any requests that are still pending won't be cancelled outright, since
+// another window may be waiting for the same icon. The results will simply
+// be ignored.
 void IconFetcher::ClearQueue()
 {
-	m_iconThreadPool.clear_queue();
-	m_iconResults.clear();
+	m_resultQueue->Close();
+	m_resultQueue = std::make_shared<IconResultQueue>(m_hwnd, WM_APP_ICON_RESULTS_READY);
+	m_callbacks.clear();
 }
\ No newline at end of file
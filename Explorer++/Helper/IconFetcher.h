@@ -4,15 +4,12 @@
 
 #pragma once
 
-#include "ShellHelper.h"
-#include "../ThirdParty/CTPL/cpl_stl.h"
+#include "IconResolutionService.h"
 #include <ShlObj.h>
 #include <functional>
-#include <future>
-#include <optional>
+#include <memory>
 #include <unordered_map>
 
-class CachedIcons;
 class WindowSubclassWrapper;
 
 class IconFetcherInterface
@@ -25,10 +22,13 @@ public:
 	virtual void ClearQueue() = 0;
 };
 
+// Requests icons on behalf of a particular window. The icons themselves are
+// retrieved by the (shared) IconResolutionService and the callbacks are then
+// invoked on the thread that owns the window.
 class IconFetcher : public IconFetcherInterface
 {
 public:
-	IconFetcher(HWND hwnd, CachedIcons *cachedIcons);
+	IconFetcher(HWND hwnd, IconResolutionService *iconResolutionService);
 	virtual ~IconFetcher();
 
 	void QueueIconTask(std::wstring_view path, Callback callback) override;
@@ -42,45 +42,19 @@ private:
 	// passed to the constructor, so it's not possible to tell what other WM_APP messages are in
 	// use. To try to avoid clashes with other messages sent throughout the application, the last
 	// value in the range will be used.
-	static const UINT WM_APP_ICON_RESULT_READY = 0xBFFF;
-
-	struct BasicItemInfo
-	{
-		BasicItemInfo() = default;
-
-		BasicItemInfo(const BasicItemInfo &other)
-		{
-			pidl.reset(ILCloneFull(other.pidl.get()));
-		}
-
-		unique_pidl_absolute pidl;
-	};
-
-	struct IconResult
-	{
-		int iconIndex;
-		std::wstring path;
-	};
-
-	struct FutureResult
-	{
-		Callback callback;
-		std::future<std::optional<IconResult>> iconResult;
-	};
+	static const UINT WM_APP_ICON_RESULTS_READY = 0xBFFF;
 
 	static LRESULT CALLBACK WindowSubclassStub(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam,
 		UINT_PTR uIdSubclass, DWORD_PTR dwRefData);
 	LRESULT CALLBACK WindowSubclass(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
-	static std::optional<int> FindIconAsync(PCIDLIST_ABSOLUTE pidl);
-	void ProcessIconResult(int iconResultId);
+	void ProcessIconResults();
 
 	const HWND m_hwnd;
 	std::vector<std::unique_ptr<WindowSubclassWrapper>> m_windowSubclasses;
 
-	ctpl::thread_pool m_iconThreadPool;
-	std::unordered_map<int, FutureResult> m_iconResults;
-	int m_iconResultIDCounter;
-	CachedIcons *m_cachedIcons;
-	std::function<void(int data)> m_callback;
+	IconResolutionService *m_iconResolutionService;
+	std::shared_ptr<IconResultQueue> m_resultQueue;
+	std::unordered_map<int, Callback> m_callbacks;
+	int m_requestIdCounter;
 };
\ No newline at end of file
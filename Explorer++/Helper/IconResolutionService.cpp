@@ -0,0 +1,342 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "IconResolutionService.h"
+#include "Tracing.h"
+#include <wil/com.h>
+#include <algorithm>
+#include <thread>
+
+IconResultQueue::IconResultQueue(HWND hwnd, UINT message) :
+	m_hwnd(hwnd),
+	m_message(message),
+	m_messagePending(false),
+	m_closed(false)
+{
+}
+
+void IconResultQueue::Push(int requestId, std::optional<int> iconIndex)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_closed)
+	{
+		return;
+	}
+
+	m_results.push_back({ requestId, iconIndex });
+
+	// If a message has already been posted, but not yet processed, this
+	// result will be picked up when it is.
+	if (!m_messagePending)
+	{
+		m_messagePending = PostMessage(m_hwnd, m_message, 0, 0);
+	}
+}
+
+std::vector<IconResultQueue::Result> IconResultQueue::TakeAll()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::vector<Result> results;
+	results.swap(m_results);
+	m_messagePending = false;
+
+	return results;
+}
+
+void IconResultQueue::Close()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_closed = true;
+	m_results.clear();
+}
+
+bool IconResultQueue::IsClosed() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_closed;
+}
+
+IconResolutionService::IconResolutionService(CachedIcons *cachedIcons) :
+	m_cachedIcons(cachedIcons),
+	m_threadPool(GetNumWorkers(), std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED),
+		CoUninitialize)
+{
+}
+
+IconResolutionService::~IconResolutionService()
+{
+	m_threadPool.clear_queue();
+}
+
+int IconResolutionService::GetNumWorkers()
+{
+	return static_cast<int>(std::clamp(std::thread::hardware_concurrency(), 1U, MAX_WORKERS));
+}
+
+void IconResolutionService::QueueRequest(
+	std::wstring_view path, std::shared_ptr<IconResultQueue> resultQueue, int requestId)
+{
+	PendingRequest request;
+	request.path = path;
+
+	QueueRequest(GetRequestKey(path), std::move(request), { resultQueue, requestId });
+}
+
+void IconResolutionService::QueueRequest(
+	PCIDLIST_ABSOLUTE pidl, std::shared_ptr<IconResultQueue> resultQueue, int requestId)
+{
+	PendingRequest request;
+	request.pidl.reset(ILCloneFull(pidl));
+
+	QueueRequest(GetRequestKey(pidl), std::move(request), { resultQueue, requestId });
+}
+
+void IconResolutionService::QueueRequest(
+	const std::string &key, PendingRequest request, const Subscriber &subscriber)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto itr = m_pendingRequests.find(key);
+
+		if (itr != m_pendingRequests.end())
+		{
+			// The same icon has already been requested, so this request will
+			// simply receive the result of that lookup.
+			itr->second.subscribers.push_back(subscriber);
+			return;
+		}
+
+		request.subscribers.push_back(subscriber);
+		m_pendingRequests.insert({ key, std::move(request) });
+	}
+
+	auto queuedTime = GetTraceTimestamp();
+
+	m_threadPool.push([this, key, queuedTime](int id) {
+		UNREFERENCED_PARAMETER(id);
+
+		TRACE_ELAPSED("icons", "IconRequestQueued", queuedTime);
+
+		ResolveRequest(key);
+	});
+}
+
+void IconResolutionService::ResolveRequest(const std::string &key)
+{
+	TRACE_EVENT("icons", "ResolveIcon");
+
+	unique_pidl_absolute pidl;
+	std::wstring path;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto itr = m_pendingRequests.find(key);
+
+		if (itr == m_pendingRequests.end())
+		{
+			return;
+		}
+
+		// A window will clear its queue if the items it's showing change (e.g.
+		// because a tab has navigated to a different folder). If every window
+		// that requested this icon has done that, there's no need to look the
+		// icon up.
+		bool anyWaiting = std::any_of(itr->second.subscribers.begin(),
+			itr->second.subscribers.end(), [](const Subscriber &subscriber) {
+				return !subscriber.resultQueue->IsClosed();
+			});
+
+		if (!anyWaiting)
+		{
+			m_pendingRequests.erase(itr);
+			return;
+		}
+
+		if (itr->second.pidl)
+		{
+			pidl.reset(ILCloneFull(itr->second.pidl.get()));
+		}
+
+		path = itr->second.path;
+	}
+
+	auto iconIndex = FindIconAsync(pidl.get(), path);
+
+	// Any requests made for this icon while the lookup was in progress will
+	// also receive the result.
+	std::vector<Subscriber> subscribers;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto itr = m_pendingRequests.find(key);
+
+		if (itr == m_pendingRequests.end())
+		{
+			return;
+		}
+
+		subscribers = std::move(itr->second.subscribers);
+		m_pendingRequests.erase(itr);
+	}
+
+	for (const auto &subscriber : subscribers)
+	{
+		subscriber.resultQueue->Push(subscriber.requestId, iconIndex);
+	}
+}
+
+std::optional<int> IconResolutionService::FindIconAsync(
+	PCIDLIST_ABSOLUTE pidl, const std::wstring &path)
+{
+	unique_pidl_absolute parsedPidl;
+
+	if (!pidl)
+	{
+		// SHGetFileInfo will fail for non-filesystem paths that are passed in
+		// as strings. For example, attempting to retrieve the icon for the
+		// recycle bin will fail if you pass the parsing path (i.e.
+		// ::{645FF040-5081-101B-9F08-00AA002F954E}). If, however, you pass the
+		// pidl, the function will succeed. Therefore, paths will always be
+		// converted to pidls first here.
+		HRESULT hr =
+			SHParseDisplayName(path.c_str(), nullptr, wil::out_param(parsedPidl), 0, nullptr);
+
+		if (FAILED(hr))
+		{
+			return std::nullopt;
+		}
+
+		pidl = parsedPidl.get();
+	}
+
+	// Must use SHGFI_ICON here, rather than SHGFO_SYSICONINDEX, or else
+	// icon overlays won't be applied.
+	SHFILEINFO shfi;
+	DWORD_PTR res = SHGetFileInfo(reinterpret_cast<LPCTSTR>(pidl), 0, &shfi, sizeof(shfi),
+		SHGFI_PIDL | SHGFI_ICON | SHGFI_OVERLAYINDEX);
+
+	if (res == 0)
+	{
+		return std::nullopt;
+	}
+
+	DestroyIcon(shfi.hIcon);
+
+	std::wstring cachePath = path;
+
+	if (cachePath.empty())
+	{
+		TCHAR filePath[MAX_PATH];
+		HRESULT hr = GetDisplayName(
+			pidl, filePath, static_cast<UINT>(std::size(filePath)), SHGDN_FORPARSING);
+
+		if (SUCCEEDED(hr))
+		{
+			cachePath = filePath;
+		}
+	}
+
+	if (!cachePath.empty())
+	{
+		m_cachedIcons->addOrUpdateFileIcon(cachePath, shfi.iIcon, GetIconDetailsAsync(pidl));
+	}
+
+	return shfi.iIcon;
+}
+
+// Retrieves the information needed to share the icon between items of the
+// same type and to restore it in a later session. SHGetFileInfo doesn't
+// expose any of this, so the icon extractor is queried directly.
+IconDetails IconResolutionService::GetIconDetailsAsync(PCIDLIST_ABSOLUTE pidl)
+{
+	IconDetails iconDetails;
+
+	wil::com_ptr<IShellFolder> parent;
+	PCITEMID_CHILD child;
+	HRESULT hr = SHBindToParent(pidl, IID_PPV_ARGS(&parent), &child);
+
+	if (FAILED(hr))
+	{
+		return iconDetails;
+	}
+
+	// Compressed files (e.g. .zip files) are folders as far as the shell is
+	// concerned, but files on the filesystem. Items here are classified in
+	// the same way as they are in the filesystem, so that a lookup based on
+	// an item's file attributes will match.
+	SFGAOF attributes = SFGAO_FOLDER | SFGAO_STREAM;
+	hr = parent->GetAttributesOf(1, &child, &attributes);
+
+	if (FAILED(hr))
+	{
+		return iconDetails;
+	}
+
+	iconDetails.itemType =
+		(WI_IsFlagSet(attributes, SFGAO_FOLDER) && WI_IsFlagClear(attributes, SFGAO_STREAM))
+		? IconDetails::ItemType::Folder
+		: IconDetails::ItemType::File;
+
+	wil::com_ptr<IExtractIcon> extractIcon;
+	hr = parent->GetUIObjectOf(
+		nullptr, 1, &child, __uuidof(IExtractIcon), nullptr, extractIcon.put_void());
+
+	if (FAILED(hr))
+	{
+		return iconDetails;
+	}
+
+	TCHAR iconFile[MAX_PATH];
+	int iconIndex;
+	UINT flags;
+	hr = extractIcon->GetIconLocation(
+		GIL_FORSHELL, iconFile, static_cast<UINT>(std::size(iconFile)), &iconIndex, &flags);
+
+	if (hr != S_OK)
+	{
+		return iconDetails;
+	}
+
+	iconDetails.perClass = WI_IsFlagSet(flags, GIL_PERCLASS);
+
+	if (WI_IsFlagClear(flags, GIL_NOTFILENAME))
+	{
+		iconDetails.location = IconLocation{ iconFile, iconIndex };
+	}
+
+	return iconDetails;
+}
+
+std::optional<int> IconResolutionService::ResolveIconLocation(const IconLocation &location)
+{
+	int iconIndex = Shell_GetCachedImageIndexW(location.file.c_str(), location.index, 0);
+
+	if (iconIndex == -1)
+	{
+		return std::nullopt;
+	}
+
+	return iconIndex;
+}
+
+// Requests made by path and by pidl are kept separate, since the same item
+// may be represented differently in each case.
+std::string IconResolutionService::GetRequestKey(std::wstring_view path)
+{
+	return "P"
+		+ std::string(
+			reinterpret_cast<const char *>(path.data()), path.size() * sizeof(wchar_t));
+}
+
+std::string IconResolutionService::GetRequestKey(PCIDLIST_ABSOLUTE pidl)
+{
+	return "I" + std::string(reinterpret_cast<const char *>(pidl), ILGetSize(pidl));
+}
\ No newline at end of file
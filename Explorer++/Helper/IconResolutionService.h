@@ -0,0 +1,116 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "CachedIcons.h"
+#include "Macros.h"
+#include "ShellHelper.h"
+#include "../ThirdParty/CTPL/cpl_stl.h"
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Collects the results of icon requests made on behalf of a particular
+// window. Rather than posting a message for every result, a single message
+// is posted for each batch of results, so that the window can process every
+// result that's available in one go.
+class IconResultQueue
+{
+public:
+	struct Result
+	{
+		int requestId;
+		std::optional<int> iconIndex;
+	};
+
+	IconResultQueue(HWND hwnd, UINT message);
+
+	// Called from a worker thread.
+	void Push(int requestId, std::optional<int> iconIndex);
+
+	// Called from the thread that owns the window, in response to the message
+	// passed to the constructor.
+	std::vector<Result> TakeAll();
+
+	// Once closed, no further results will be added and no further messages
+	// will be posted.
+	void Close();
+	bool IsClosed() const;
+
+private:
+	DISALLOW_COPY_AND_ASSIGN(IconResultQueue);
+
+	const HWND m_hwnd;
+	const UINT m_message;
+
+	mutable std::mutex m_mutex;
+	std::vector<Result> m_results;
+	bool m_messagePending;
+	bool m_closed;
+};
+
+// Retrieves icons on a set of background threads. This is shared by every
+// window that shows icons, so that when several windows request the icon for
+// the same item (e.g. a folder that's shown in multiple tabs, the treeview
+// and the bookmarks toolbar), only a single lookup is performed. Each
+// resolved icon is also added to the shared icon cache.
+class IconResolutionService
+{
+public:
+	IconResolutionService(CachedIcons *cachedIcons);
+	~IconResolutionService();
+
+	void QueueRequest(
+		std::wstring_view path, std::shared_ptr<IconResultQueue> resultQueue, int requestId);
+	void QueueRequest(
+		PCIDLIST_ABSOLUTE pidl, std::shared_ptr<IconResultQueue> resultQueue, int requestId);
+
+	// Adds the icon at the specified location to the system image list (if
+	// it's not already present) and returns its index.
+	static std::optional<int> ResolveIconLocation(const IconLocation &location);
+
+private:
+	DISALLOW_COPY_AND_ASSIGN(IconResolutionService);
+
+	static constexpr unsigned int MAX_WORKERS = 4;
+
+	struct Subscriber
+	{
+		std::shared_ptr<IconResultQueue> resultQueue;
+		int requestId;
+	};
+
+	// Only one of the pidl or path will be set, depending on how the request
+	// was made.
+	struct PendingRequest
+	{
+		unique_pidl_absolute pidl;
+		std::wstring path;
+		std::vector<Subscriber> subscribers;
+	};
+
+	static int GetNumWorkers();
+	static std::string GetRequestKey(std::wstring_view path);
+	static std::string GetRequestKey(PCIDLIST_ABSOLUTE pidl);
+
+	void QueueRequest(const std::string &key, PendingRequest request, const Subscriber &subscriber);
+	void ResolveRequest(const std::string &key);
+	std::optional<int> FindIconAsync(PCIDLIST_ABSOLUTE pidl, const std::wstring &path);
+	static IconDetails GetIconDetailsAsync(PCIDLIST_ABSOLUTE pidl);
+
+	CachedIcons *m_cachedIcons;
+
+	std::mutex m_mutex;
+	std::unordered_map<std::string, PendingRequest> m_pendingRequests;
+
+	// This is declared last, so that it's destroyed first. That ensures that
+	// any running tasks have finished before the pending requests are
+	// destroyed.
+	ctpl::thread_pool m_threadPool;
+};
\ No newline at end of file
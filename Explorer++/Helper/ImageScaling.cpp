@@ -0,0 +1,289 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "ImageScaling.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define IMAGE_SCALING_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+constexpr size_t NUM_CHANNELS = 4;
+
+// The source pixels that contribute to a single destination pixel (or row).
+struct Contribution
+{
+	uint32_t first;
+	uint32_t count;
+	size_t weightsOffset;
+};
+
+// The weights along one axis. The two axes are scaled independently, since
+// the area covered by a destination pixel is simply the product of its
+// horizontal and vertical coverage.
+struct AxisWeights
+{
+	std::vector<Contribution> contributions;
+	std::vector<float> weights;
+};
+
+AxisWeights CalculateAxisWeights(uint32_t sourceSize, uint32_t destinationSize)
+{
+	AxisWeights axisWeights;
+	axisWeights.contributions.reserve(destinationSize);
+
+	double scale = static_cast<double>(sourceSize) / destinationSize;
+
+	for (uint32_t i = 0; i < destinationSize; i++)
+	{
+		double start = i * scale;
+		double end = (std::min)((i + 1) * scale, static_cast<double>(sourceSize));
+
+		auto first = static_cast<uint32_t>(std::floor(start));
+		auto last = (std::min)(static_cast<uint32_t>(std::ceil(end)), sourceSize);
+
+		Contribution contribution;
+		contribution.first = first;
+		contribution.count = 0;
+		contribution.weightsOffset = axisWeights.weights.size();
+
+		for (uint32_t j = first; j < last; j++)
+		{
+			double overlap = (std::min)(end, j + 1.0) - (std::max)(start, static_cast<double>(j));
+
+			if (overlap <= 0)
+			{
+				break;
+			}
+
+			// When scaling up, a destination pixel covers less than a single
+			// source pixel, so the weights are normalized by the covered
+			// span, rather than the scale.
+			axisWeights.weights.push_back(static_cast<float>(overlap / (end - start)));
+			contribution.count++;
+		}
+
+		axisWeights.contributions.push_back(contribution);
+	}
+
+	return axisWeights;
+}
+
+struct ScalarKernel
+{
+	static void ScaleRow(const uint8_t *sourceRow, const AxisWeights &weights, float *output)
+	{
+		for (const auto &contribution : weights.contributions)
+		{
+			float accumulator[NUM_CHANNELS] = {};
+			const uint8_t *pixel = sourceRow + contribution.first * NUM_CHANNELS;
+			const float *weight = &weights.weights[contribution.weightsOffset];
+
+			for (uint32_t i = 0; i < contribution.count; i++)
+			{
+				for (size_t channel = 0; channel < NUM_CHANNELS; channel++)
+				{
+					accumulator[channel] += static_cast<float>(pixel[channel]) * weight[i];
+				}
+
+				pixel += NUM_CHANNELS;
+			}
+
+			std::memcpy(output, accumulator, sizeof(accumulator));
+			output += NUM_CHANNELS;
+		}
+	}
+
+	static void AccumulateRow(const float *row, float weight, float *accumulator, size_t numValues)
+	{
+		for (size_t i = 0; i < numValues; i++)
+		{
+			accumulator[i] += row[i] * weight;
+		}
+	}
+
+	static void StoreRow(const float *accumulator, uint8_t *destinationRow, size_t numValues)
+	{
+		for (size_t i = 0; i < numValues; i++)
+		{
+			auto value = static_cast<int>(accumulator[i] + 0.5f);
+			destinationRow[i] = static_cast<uint8_t>((std::min)(value, 255));
+		}
+	}
+};
+
+#ifdef IMAGE_SCALING_SSE2
+
+// Each pixel fits exactly into a single register (one float per channel), so
+// the vector versions perform the same operations as the scalar versions, in
+// the same order, and produce identical results.
+struct Sse2Kernel
+{
+	static void ScaleRow(const uint8_t *sourceRow, const AxisWeights &weights, float *output)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		for (const auto &contribution : weights.contributions)
+		{
+			__m128 accumulator = _mm_setzero_ps();
+			const uint8_t *pixel = sourceRow + contribution.first * NUM_CHANNELS;
+			const float *weight = &weights.weights[contribution.weightsOffset];
+
+			for (uint32_t i = 0; i < contribution.count; i++)
+			{
+				int32_t packedPixel;
+				std::memcpy(&packedPixel, pixel, sizeof(packedPixel));
+
+				__m128i widened = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packedPixel), zero);
+				widened = _mm_unpacklo_epi16(widened, zero);
+
+				accumulator = _mm_add_ps(
+					accumulator, _mm_mul_ps(_mm_cvtepi32_ps(widened), _mm_set1_ps(weight[i])));
+
+				pixel += NUM_CHANNELS;
+			}
+
+			_mm_storeu_ps(output, accumulator);
+			output += NUM_CHANNELS;
+		}
+	}
+
+	static void AccumulateRow(const float *row, float weight, float *accumulator, size_t numValues)
+	{
+		const __m128 weights = _mm_set1_ps(weight);
+		size_t i = 0;
+
+		for (; i + 4 <= numValues; i += 4)
+		{
+			__m128 sum = _mm_add_ps(
+				_mm_loadu_ps(accumulator + i), _mm_mul_ps(_mm_loadu_ps(row + i), weights));
+			_mm_storeu_ps(accumulator + i, sum);
+		}
+
+		ScalarKernel::AccumulateRow(row + i, weight, accumulator + i, numValues - i);
+	}
+
+	static void StoreRow(const float *accumulator, uint8_t *destinationRow, size_t numValues)
+	{
+		const __m128 half = _mm_set1_ps(0.5f);
+		size_t i = 0;
+
+		for (; i + 16 <= numValues; i += 16)
+		{
+			__m128i values[4];
+
+			for (size_t j = 0; j < 4; j++)
+			{
+				values[j] =
+					_mm_cvttps_epi32(_mm_add_ps(_mm_loadu_ps(accumulator + i + j * 4), half));
+			}
+
+			// Both packing operations saturate, which clamps each value to
+			// [0, 255].
+			__m128i packed = _mm_packus_epi16(
+				_mm_packs_epi32(values[0], values[1]), _mm_packs_epi32(values[2], values[3]));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(destinationRow + i), packed);
+		}
+
+		ScalarKernel::StoreRow(accumulator + i, destinationRow + i, numValues - i);
+	}
+};
+
+#endif
+
+template <typename Kernel>
+void ScaleImageWithKernel(const uint8_t *source, uint32_t sourceWidth, uint32_t sourceHeight,
+	uint8_t *destination, uint32_t destinationWidth, uint32_t destinationHeight)
+{
+	if (sourceWidth == 0 || sourceHeight == 0 || destinationWidth == 0 || destinationHeight == 0)
+	{
+		return;
+	}
+
+	AxisWeights horizontalWeights = CalculateAxisWeights(sourceWidth, destinationWidth);
+	AxisWeights verticalWeights = CalculateAxisWeights(sourceHeight, destinationHeight);
+
+	size_t sourceRowSize = static_cast<size_t>(sourceWidth) * NUM_CHANNELS;
+	size_t destinationRowSize = static_cast<size_t>(destinationWidth) * NUM_CHANNELS;
+
+	std::vector<float> scaledRow(destinationRowSize);
+	std::vector<float> accumulator(destinationRowSize);
+
+	// The rows that contribute to each destination row only ever move
+	// forward, and consecutive destination rows share at most one source row,
+	// so only the most recently scaled row needs to be retained.
+	auto scaledRowIndex = static_cast<uint32_t>(-1);
+
+	for (const auto &contribution : verticalWeights.contributions)
+	{
+		std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+
+		for (uint32_t i = 0; i < contribution.count; i++)
+		{
+			uint32_t rowIndex = contribution.first + i;
+
+			if (rowIndex != scaledRowIndex)
+			{
+				Kernel::ScaleRow(source + rowIndex * sourceRowSize, horizontalWeights,
+					scaledRow.data());
+				scaledRowIndex = rowIndex;
+			}
+
+			Kernel::AccumulateRow(scaledRow.data(),
+				verticalWeights.weights[contribution.weightsOffset + i], accumulator.data(),
+				destinationRowSize);
+		}
+
+		Kernel::StoreRow(accumulator.data(), destination, destinationRowSize);
+		destination += destinationRowSize;
+	}
+}
+}
+
+namespace ImageScaling
+{
+void ScaleImage(const uint8_t *source, uint32_t sourceWidth, uint32_t sourceHeight,
+	uint8_t *destination, uint32_t destinationWidth, uint32_t destinationHeight)
+{
+#ifdef IMAGE_SCALING_SSE2
+	ScaleImageWithKernel<Sse2Kernel>(
+		source, sourceWidth, sourceHeight, destination, destinationWidth, destinationHeight);
+#else
+	ScaleImageWithKernel<ScalarKernel>(
+		source, sourceWidth, sourceHeight, destination, destinationWidth, destinationHeight);
+#endif
+}
+
+void ScaleImageScalar(const uint8_t *source, uint32_t sourceWidth, uint32_t sourceHeight,
+	uint8_t *destination, uint32_t destinationWidth, uint32_t destinationHeight)
+{
+	ScaleImageWithKernel<ScalarKernel>(
+		source, sourceWidth, sourceHeight, destination, destinationWidth, destinationHeight);
+}
+
+std::pair<uint32_t, uint32_t> GetScaledSize(
+	uint32_t sourceWidth, uint32_t sourceHeight, uint32_t maxWidth, uint32_t maxHeight)
+{
+	if (sourceWidth <= maxWidth && sourceHeight <= maxHeight)
+	{
+		return { sourceWidth, sourceHeight };
+	}
+
+	double scale = (std::min)(static_cast<double>(maxWidth) / sourceWidth,
+		static_cast<double>(maxHeight) / sourceHeight);
+
+	auto width = static_cast<uint32_t>(std::lround(sourceWidth * scale));
+	auto height = static_cast<uint32_t>(std::lround(sourceHeight * scale));
+
+	return { std::clamp(width, 1u, (std::max)(maxWidth, 1u)),
+		std::clamp(height, 1u, (std::max)(maxHeight, 1u)) };
+}
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+// Scales 32-bit images using area averaging. Each destination pixel is the
+// average of the source pixels it covers, weighted by how much of each source
+// pixel is covered. This produces much better results than point sampling
+// when reducing the size of an image.
+//
+// The four channels are averaged independently, so the source should either
+// be opaque or use premultiplied alpha.
+//
+// Images are stored with no padding between rows.
+namespace ImageScaling
+{
+// Uses SSE2 where it's available, falling back to ScaleImageScalar otherwise.
+void ScaleImage(const uint8_t *source, uint32_t sourceWidth, uint32_t sourceHeight,
+	uint8_t *destination, uint32_t destinationWidth, uint32_t destinationHeight);
+
+// Produces the same results as ScaleImage, without any vectorization. This is
+// exposed so that the two implementations can be compared.
+void ScaleImageScalar(const uint8_t *source, uint32_t sourceWidth, uint32_t sourceHeight,
+	uint8_t *destination, uint32_t destinationWidth, uint32_t destinationHeight);
+
+// Returns the size of the largest image that fits within the specified
+// bounds while preserving the source aspect ratio. Images are never scaled
+// up, so if the source already fits, its size is returned unchanged.
+std::pair<uint32_t, uint32_t> GetScaledSize(
+	uint32_t sourceWidth, uint32_t sourceHeight, uint32_t maxWidth, uint32_t maxHeight);
+}
\ No newline at end of file
@@ -0,0 +1,443 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "InotifyDirectoryChangeBackend.h"
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+
+namespace
+{
+// wchar_t holds UTF-32 on Linux.
+std::string WideToUtf8(const std::wstring &text)
+{
+	std::string output;
+
+	for (wchar_t c : text)
+	{
+		auto codePoint = static_cast<uint32_t>(c);
+
+		if (codePoint < 0x80)
+		{
+			output += static_cast<char>(codePoint);
+		}
+		else if (codePoint < 0x800)
+		{
+			output += static_cast<char>(0xC0 | (codePoint >> 6));
+			output += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else if (codePoint < 0x10000)
+		{
+			output += static_cast<char>(0xE0 | (codePoint >> 12));
+			output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			output += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else
+		{
+			output += static_cast<char>(0xF0 | (codePoint >> 18));
+			output += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+			output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			output += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+	}
+
+	return output;
+}
+
+std::wstring Utf8ToWide(const std::string &text)
+{
+	std::wstring output;
+	size_t i = 0;
+
+	while (i < text.size())
+	{
+		auto byte = static_cast<unsigned char>(text[i]);
+		uint32_t codePoint;
+		size_t length;
+
+		if (byte < 0x80)
+		{
+			codePoint = byte;
+			length = 1;
+		}
+		else if ((byte & 0xE0) == 0xC0)
+		{
+			codePoint = byte & 0x1F;
+			length = 2;
+		}
+		else if ((byte & 0xF0) == 0xE0)
+		{
+			codePoint = byte & 0x0F;
+			length = 3;
+		}
+		else
+		{
+			codePoint = byte & 0x07;
+			length = 4;
+		}
+
+		for (size_t j = 1; j < length && i + j < text.size(); j++)
+		{
+			codePoint = (codePoint << 6) | (static_cast<unsigned char>(text[i + j]) & 0x3F);
+		}
+
+		output += static_cast<wchar_t>(codePoint);
+		i += length;
+	}
+
+	return output;
+}
+
+uint32_t FilterToMask(uint32_t filter)
+{
+	uint32_t mask = IN_ONLYDIR | IN_MASK_ADD;
+
+	if (filter & (DirectoryChangeFilter::FileName | DirectoryChangeFilter::DirName))
+	{
+		mask |= IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+	}
+
+	if (filter & (DirectoryChangeFilter::Size | DirectoryChangeFilter::LastWrite))
+	{
+		mask |= IN_MODIFY;
+	}
+
+	if (filter & (DirectoryChangeFilter::Attributes | DirectoryChangeFilter::Security))
+	{
+		mask |= IN_ATTRIB;
+	}
+
+	return mask;
+}
+
+// Since descriptors are shared between watches, an event may not be relevant
+// to every watch that uses the descriptor.
+std::optional<DirectoryChangeAction> MaskToAction(uint32_t mask, uint32_t filter)
+{
+	uint32_t nameFilter =
+		(mask & IN_ISDIR) ? DirectoryChangeFilter::DirName : DirectoryChangeFilter::FileName;
+
+	if ((mask & IN_CREATE) && (filter & nameFilter))
+	{
+		return DirectoryChangeAction::Added;
+	}
+	else if ((mask & IN_DELETE) && (filter & nameFilter))
+	{
+		return DirectoryChangeAction::Removed;
+	}
+	else if ((mask & IN_MOVED_FROM) && (filter & nameFilter))
+	{
+		return DirectoryChangeAction::RenamedOldName;
+	}
+	else if ((mask & IN_MOVED_TO) && (filter & nameFilter))
+	{
+		return DirectoryChangeAction::RenamedNewName;
+	}
+	else if ((mask & IN_MODIFY)
+		&& (filter & (DirectoryChangeFilter::Size | DirectoryChangeFilter::LastWrite)))
+	{
+		return DirectoryChangeAction::Modified;
+	}
+	else if ((mask & IN_ATTRIB)
+		&& (filter & (DirectoryChangeFilter::Attributes | DirectoryChangeFilter::Security)))
+	{
+		return DirectoryChangeAction::Modified;
+	}
+
+	return std::nullopt;
+}
+
+std::string JoinPath(const std::string &directory, const std::string &name)
+{
+	if (directory.empty())
+	{
+		return name;
+	}
+
+	return directory + "/" + name;
+}
+}
+
+std::unique_ptr<InotifyDirectoryChangeBackend> InotifyDirectoryChangeBackend::Create()
+{
+	int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+	if (inotifyFd == -1)
+	{
+		return nullptr;
+	}
+
+	int wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if (wakeFd == -1)
+	{
+		close(inotifyFd);
+		return nullptr;
+	}
+
+	return std::unique_ptr<InotifyDirectoryChangeBackend>(
+		new InotifyDirectoryChangeBackend(inotifyFd, wakeFd));
+}
+
+InotifyDirectoryChangeBackend::InotifyDirectoryChangeBackend(int inotifyFd, int wakeFd) :
+	m_inotifyFd(inotifyFd),
+	m_wakeFd(wakeFd),
+	m_bufferPool(READ_BUFFER_SIZE, 1),
+	m_watchIdCounter(1)
+{
+}
+
+InotifyDirectoryChangeBackend::~InotifyDirectoryChangeBackend()
+{
+	// Closing the inotify descriptor removes all of its watches.
+	close(m_inotifyFd);
+	close(m_wakeFd);
+}
+
+std::optional<int> InotifyDirectoryChangeBackend::AddWatch(const DirectoryWatchRequest &request)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	int watchId = m_watchIdCounter++;
+
+	Watch watch;
+	watch.request = request;
+	watch.rootPath = WideToUtf8(request.path);
+
+	if (!AddDescriptor(watchId, watch, ""))
+	{
+		return std::nullopt;
+	}
+
+	if (request.watchSubtree)
+	{
+		AddSubdirectoryDescriptors(watchId, watch, "");
+	}
+
+	m_watches.emplace(watchId, std::move(watch));
+
+	return watchId;
+}
+
+// Should be called with m_mutex held.
+bool InotifyDirectoryChangeBackend::AddDescriptor(
+	int watchId, Watch &watch, const std::string &relativePath)
+{
+	std::string path =
+		relativePath.empty() ? watch.rootPath : watch.rootPath + "/" + relativePath;
+	int descriptor =
+		inotify_add_watch(m_inotifyFd, path.c_str(), FilterToMask(watch.request.filter));
+
+	if (descriptor == -1)
+	{
+		return false;
+	}
+
+	// A directory that's created while the subtree is being walked may be
+	// found both by the walk and through the resulting event.
+	if (std::find(watch.descriptors.begin(), watch.descriptors.end(), descriptor)
+		!= watch.descriptors.end())
+	{
+		return true;
+	}
+
+	watch.descriptors.push_back(descriptor);
+	m_descriptorUsers[descriptor].push_back({ watchId, relativePath });
+
+	return true;
+}
+
+// Should be called with m_mutex held.
+void InotifyDirectoryChangeBackend::AddSubdirectoryDescriptors(
+	int watchId, Watch &watch, const std::string &relativePath)
+{
+	std::filesystem::path directory =
+		relativePath.empty() ? watch.rootPath : watch.rootPath + "/" + relativePath;
+	std::error_code error;
+
+	for (std::filesystem::recursive_directory_iterator itr(
+			 directory, std::filesystem::directory_options::skip_permission_denied, error);
+		 !error && itr != std::filesystem::recursive_directory_iterator(); itr.increment(error))
+	{
+		if (itr->is_directory(error) && !itr->is_symlink(error))
+		{
+			std::string subdirectory = itr->path().lexically_relative(watch.rootPath).string();
+			AddDescriptor(watchId, watch, subdirectory);
+		}
+	}
+}
+
+void InotifyDirectoryChangeBackend::RemoveWatch(int watchId)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto itr = m_watches.find(watchId);
+
+	if (itr == m_watches.end())
+	{
+		return;
+	}
+
+	for (int descriptor : itr->second.descriptors)
+	{
+		auto &users = m_descriptorUsers[descriptor];
+		users.erase(std::remove_if(users.begin(), users.end(),
+						[watchId](const DescriptorUser &user) { return user.watchId == watchId; }),
+			users.end());
+
+		if (users.empty())
+		{
+			m_descriptorUsers.erase(descriptor);
+			inotify_rm_watch(m_inotifyFd, descriptor);
+		}
+	}
+
+	m_watches.erase(itr);
+}
+
+// Called once a directory has been deleted (or moved out of the watched
+// file system), at which point the kernel will have removed the descriptor
+// and may go on to reuse it. Should be called with m_mutex held.
+void InotifyDirectoryChangeBackend::RemoveDescriptor(int descriptor)
+{
+	auto itr = m_descriptorUsers.find(descriptor);
+
+	if (itr == m_descriptorUsers.end())
+	{
+		return;
+	}
+
+	for (const auto &user : itr->second)
+	{
+		auto watchItr = m_watches.find(user.watchId);
+
+		if (watchItr != m_watches.end())
+		{
+			auto &descriptors = watchItr->second.descriptors;
+			descriptors.erase(
+				std::remove(descriptors.begin(), descriptors.end(), descriptor), descriptors.end());
+		}
+	}
+
+	m_descriptorUsers.erase(itr);
+}
+
+void InotifyDirectoryChangeBackend::WaitForEvents(std::vector<DirectoryChangeEvent> &events)
+{
+	pollfd fds[2] = { { m_inotifyFd, POLLIN, 0 }, { m_wakeFd, POLLIN, 0 } };
+
+	if (poll(fds, 2, -1) <= 0)
+	{
+		return;
+	}
+
+	if (fds[1].revents & POLLIN)
+	{
+		uint64_t value;
+		[[maybe_unused]] auto res = read(m_wakeFd, &value, sizeof(value));
+	}
+
+	if (!(fds[0].revents & POLLIN))
+	{
+		return;
+	}
+
+	BufferPool::Buffer buffer = m_bufferPool.Acquire();
+
+	while (true)
+	{
+		ssize_t numBytes = read(m_inotifyFd, buffer.get(), READ_BUFFER_SIZE);
+
+		if (numBytes <= 0)
+		{
+			break;
+		}
+
+		ProcessEvents(buffer.get(), static_cast<size_t>(numBytes), events);
+	}
+
+	m_bufferPool.Release(std::move(buffer));
+}
+
+void InotifyDirectoryChangeBackend::ProcessEvents(
+	const std::byte *buffer, size_t size, std::vector<DirectoryChangeEvent> &events)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	size_t offset = 0;
+
+	while (offset + sizeof(inotify_event) <= size)
+	{
+		auto *inotifyEvent = reinterpret_cast<const inotify_event *>(buffer + offset);
+		offset += sizeof(inotify_event) + inotifyEvent->len;
+
+		if (inotifyEvent->mask & IN_IGNORED)
+		{
+			RemoveDescriptor(inotifyEvent->wd);
+			continue;
+		}
+
+		// An overflow isn't associated with any particular watch. Events
+		// without a name refer to the watched directory itself.
+		if (inotifyEvent->wd == -1 || inotifyEvent->len == 0)
+		{
+			continue;
+		}
+
+		auto usersItr = m_descriptorUsers.find(inotifyEvent->wd);
+
+		if (usersItr == m_descriptorUsers.end())
+		{
+			continue;
+		}
+
+		std::string name = inotifyEvent->name;
+
+		// Adding descriptors below may invalidate the iterator, so the users
+		// are copied.
+		std::vector<DescriptorUser> users = usersItr->second;
+
+		for (const auto &user : users)
+		{
+			auto watchItr = m_watches.find(user.watchId);
+
+			if (watchItr == m_watches.end())
+			{
+				continue;
+			}
+
+			Watch &watch = watchItr->second;
+			std::string relativeName = JoinPath(user.relativePath, name);
+
+			if (watch.request.watchSubtree && (inotifyEvent->mask & IN_ISDIR)
+				&& (inotifyEvent->mask & (IN_CREATE | IN_MOVED_TO)))
+			{
+				if (AddDescriptor(user.watchId, watch, relativeName))
+				{
+					AddSubdirectoryDescriptors(user.watchId, watch, relativeName);
+				}
+			}
+
+			auto action = MaskToAction(inotifyEvent->mask, watch.request.filter);
+
+			if (!action)
+			{
+				continue;
+			}
+
+			events.push_back({ user.watchId, *action, Utf8ToWide(relativeName) });
+		}
+	}
+}
+
+void InotifyDirectoryChangeBackend::Wake()
+{
+	uint64_t value = 1;
+	[[maybe_unused]] auto res = write(m_wakeFd, &value, sizeof(value));
+}
\ No newline at end of file
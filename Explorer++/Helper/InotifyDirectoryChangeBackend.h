@@ -0,0 +1,74 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "BufferPool.h"
+#include "DirectoryChangeBackend.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A Linux implementation of DirectoryChangeBackend. This isn't used by the
+// application itself. It exists so that SharedDirectoryMonitor can be
+// exercised against a real file system on Linux (see
+// TestExplorer++/SharedDirectoryMonitorStressTest.cpp). It's therefore not
+// part of the Visual Studio project.
+//
+// inotify watches aren't recursive, so subtree watches are implemented by
+// adding a watch for each subdirectory, both when the watch is added and
+// whenever a directory is subsequently created within it.
+class InotifyDirectoryChangeBackend : public DirectoryChangeBackend
+{
+public:
+	static std::unique_ptr<InotifyDirectoryChangeBackend> Create();
+	~InotifyDirectoryChangeBackend();
+
+	InotifyDirectoryChangeBackend(const InotifyDirectoryChangeBackend &) = delete;
+	InotifyDirectoryChangeBackend &operator=(const InotifyDirectoryChangeBackend &) = delete;
+
+	std::optional<int> AddWatch(const DirectoryWatchRequest &request) override;
+	void RemoveWatch(int watchId) override;
+	void WaitForEvents(std::vector<DirectoryChangeEvent> &events) override;
+	void Wake() override;
+
+private:
+	static constexpr size_t READ_BUFFER_SIZE = 64 * 1024;
+
+	// inotify returns the same descriptor if a directory is watched more than
+	// once, so each descriptor can be shared between several watches.
+	struct DescriptorUser
+	{
+		int watchId;
+
+		// The path of the directory, relative to the root of the watch.
+		std::string relativePath;
+	};
+
+	struct Watch
+	{
+		DirectoryWatchRequest request;
+		std::string rootPath;
+		std::vector<int> descriptors;
+	};
+
+	InotifyDirectoryChangeBackend(int inotifyFd, int wakeFd);
+
+	bool AddDescriptor(int watchId, Watch &watch, const std::string &relativePath);
+	void AddSubdirectoryDescriptors(int watchId, Watch &watch, const std::string &relativePath);
+	void RemoveDescriptor(int descriptor);
+	void ProcessEvents(const std::byte *buffer, size_t size,
+		std::vector<DirectoryChangeEvent> &events);
+
+	const int m_inotifyFd;
+	const int m_wakeFd;
+	BufferPool m_bufferPool;
+
+	std::mutex m_mutex;
+	std::unordered_map<int, Watch> m_watches;
+	std::unordered_map<int, std::vector<DescriptorUser>> m_descriptorUsers;
+	int m_watchIdCounter;
+};
\ No newline at end of file
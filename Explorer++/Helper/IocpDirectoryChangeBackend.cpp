@@ -0,0 +1,234 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "IocpDirectoryChangeBackend.h"
+
+std::unique_ptr<IocpDirectoryChangeBackend> IocpDirectoryChangeBackend::Create()
+{
+	wil::unique_handle completionPort(
+		CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1));
+
+	if (!completionPort)
+	{
+		return nullptr;
+	}
+
+	return std::unique_ptr<IocpDirectoryChangeBackend>(
+		new IocpDirectoryChangeBackend(std::move(completionPort)));
+}
+
+IocpDirectoryChangeBackend::IocpDirectoryChangeBackend(wil::unique_handle completionPort) :
+	m_completionPort(std::move(completionPort)),
+	m_bufferPool(NOTIFICATION_BUFFER_SIZE, MAX_FREE_BUFFERS),
+	m_watchIdCounter(1)
+{
+}
+
+IocpDirectoryChangeBackend::~IocpDirectoryChangeBackend()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		for (auto &[watchId, watch] : m_watches)
+		{
+			watch->removing = true;
+			CancelIoEx(watch->directory.get(), &watch->overlapped);
+		}
+	}
+
+	std::vector<DirectoryChangeEvent> events;
+
+	while (true)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (m_watches.empty())
+			{
+				break;
+			}
+		}
+
+		if (!ProcessCompletion(CANCELLATION_TIMEOUT, events))
+		{
+			break;
+		}
+	}
+
+	// If a read still hasn't completed, the system may yet write to its
+	// buffer, so the remaining watches are deliberately leaked.
+	for (auto &[watchId, watch] : m_watches)
+	{
+		watch.release();
+	}
+}
+
+std::optional<int> IocpDirectoryChangeBackend::AddWatch(const DirectoryWatchRequest &request)
+{
+	HANDLE directory = CreateFile(request.path.c_str(), FILE_LIST_DIRECTORY,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+
+	if (directory == INVALID_HANDLE_VALUE)
+	{
+		return std::nullopt;
+	}
+
+	return AddWatchForHandle(directory, request);
+}
+
+std::optional<int> IocpDirectoryChangeBackend::AddWatchForHandle(
+	HANDLE directory, const DirectoryWatchRequest &request)
+{
+	auto watch = std::make_unique<Watch>();
+	watch->directory.reset(directory);
+	watch->request = request;
+	watch->overlapped = {};
+	watch->removing = false;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	int watchId = m_watchIdCounter++;
+
+	if (!CreateIoCompletionPort(directory, m_completionPort.get(), watchId, 0))
+	{
+		return std::nullopt;
+	}
+
+	watch->buffer = m_bufferPool.Acquire();
+
+	if (!ReadChanges(*watch))
+	{
+		m_bufferPool.Release(std::move(watch->buffer));
+		return std::nullopt;
+	}
+
+	m_watches.emplace(watchId, std::move(watch));
+
+	return watchId;
+}
+
+bool IocpDirectoryChangeBackend::ReadChanges(Watch &watch)
+{
+	watch.overlapped = {};
+
+	return ReadDirectoryChangesW(watch.directory.get(), watch.buffer.get(),
+		NOTIFICATION_BUFFER_SIZE, watch.request.watchSubtree, watch.request.filter, nullptr,
+		&watch.overlapped, nullptr);
+}
+
+void IocpDirectoryChangeBackend::RemoveWatch(int watchId)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto itr = m_watches.find(watchId);
+
+	if (itr == m_watches.end() || itr->second->removing)
+	{
+		return;
+	}
+
+	// There's always exactly one read outstanding for each watch. Once it's
+	// been cancelled (or if it's already completed), its completion packet
+	// will be dequeued in ProcessCompletion(), at which point the watch will
+	// be destroyed.
+	itr->second->removing = true;
+	CancelIoEx(itr->second->directory.get(), &itr->second->overlapped);
+}
+
+void IocpDirectoryChangeBackend::WaitForEvents(std::vector<DirectoryChangeEvent> &events)
+{
+	ProcessCompletion(INFINITE, events);
+}
+
+// Returns false if nothing was dequeued.
+bool IocpDirectoryChangeBackend::ProcessCompletion(
+	DWORD timeout, std::vector<DirectoryChangeEvent> &events)
+{
+	DWORD numBytes;
+	ULONG_PTR completionKey;
+	OVERLAPPED *overlapped;
+	BOOL res = GetQueuedCompletionStatus(
+		m_completionPort.get(), &numBytes, &completionKey, &overlapped, timeout);
+
+	if (!overlapped)
+	{
+		// Either the wait timed out, or this is a wake-up packet.
+		return res && completionKey == WAKE_COMPLETION_KEY;
+	}
+
+	int watchId = static_cast<int>(completionKey);
+	BufferPool::Buffer completedBuffer;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto itr = m_watches.find(watchId);
+
+		if (itr == m_watches.end())
+		{
+			return true;
+		}
+
+		Watch &watch = *itr->second;
+
+		// If the read failed, the directory has most likely been deleted, so
+		// there's no point trying to watch it again.
+		if (!res || watch.removing)
+		{
+			m_bufferPool.Release(std::move(watch.buffer));
+			m_watches.erase(itr);
+			return true;
+		}
+
+		completedBuffer = std::move(watch.buffer);
+		watch.buffer = m_bufferPool.Acquire();
+
+		if (!ReadChanges(watch))
+		{
+			m_bufferPool.Release(std::move(watch.buffer));
+			m_watches.erase(itr);
+		}
+	}
+
+	// A successful read that returns no data indicates that the buffer
+	// overflowed. There's no indication of what changed in that case.
+	if (numBytes > 0)
+	{
+		ParseNotifications(watchId, completedBuffer.get(), numBytes, events);
+	}
+
+	m_bufferPool.Release(std::move(completedBuffer));
+
+	return true;
+}
+
+void IocpDirectoryChangeBackend::ParseNotifications(
+	int watchId, const std::byte *buffer, DWORD size, std::vector<DirectoryChangeEvent> &events)
+{
+	DWORD offset = 0;
+
+	while (offset + sizeof(FILE_NOTIFY_INFORMATION) <= size)
+	{
+		auto *notification = reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(buffer + offset);
+
+		/* FileNameLength is size in bytes NOT characters. */
+		events.push_back({ watchId, static_cast<DirectoryChangeAction>(notification->Action),
+			std::wstring(
+				notification->FileName, notification->FileNameLength / sizeof(WCHAR)) });
+
+		if (notification->NextEntryOffset == 0)
+		{
+			break;
+		}
+
+		offset += notification->NextEntryOffset;
+	}
+}
+
+void IocpDirectoryChangeBackend::Wake()
+{
+	PostQueuedCompletionStatus(m_completionPort.get(), 0, WAKE_COMPLETION_KEY, nullptr);
+}
\ No newline at end of file
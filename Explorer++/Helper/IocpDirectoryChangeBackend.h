@@ -0,0 +1,76 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "BufferPool.h"
+#include "DirectoryChangeBackend.h"
+#include <wil/resource.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Reads directory changes using ReadDirectoryChangesW. Every watch is
+// associated with a single I/O completion port, so all changes can be read
+// from one thread, without that thread having to wait in an alertable state.
+//
+// Notification buffers are taken from a pool. When a read completes, a new
+// read is issued (into a fresh buffer) before the completed buffer is parsed,
+// which keeps the window in which changes can be missed as small as possible.
+class IocpDirectoryChangeBackend : public DirectoryChangeBackend
+{
+public:
+	static std::unique_ptr<IocpDirectoryChangeBackend> Create();
+	~IocpDirectoryChangeBackend();
+
+	IocpDirectoryChangeBackend(const IocpDirectoryChangeBackend &) = delete;
+	IocpDirectoryChangeBackend &operator=(const IocpDirectoryChangeBackend &) = delete;
+
+	std::optional<int> AddWatch(const DirectoryWatchRequest &request) override;
+
+	// Watches a directory that has already been opened by the caller. The
+	// handle must have been opened with FILE_FLAG_OVERLAPPED. Ownership of the
+	// handle is always transferred, even if the watch can't be added; the
+	// handle will be closed once the watch has been removed.
+	std::optional<int> AddWatchForHandle(HANDLE directory, const DirectoryWatchRequest &request);
+
+	void RemoveWatch(int watchId) override;
+	void WaitForEvents(std::vector<DirectoryChangeEvent> &events) override;
+	void Wake() override;
+
+private:
+	// Watch IDs are used as completion keys, so they start at 1.
+	static constexpr ULONG_PTR WAKE_COMPLETION_KEY = 0;
+
+	// ReadDirectoryChangesW will fail if a buffer larger than 64KB is used to
+	// watch a directory on a network share.
+	static constexpr DWORD NOTIFICATION_BUFFER_SIZE = 64 * 1024;
+	static constexpr size_t MAX_FREE_BUFFERS = 8;
+
+	// How long the destructor will wait for cancelled reads to complete.
+	static constexpr DWORD CANCELLATION_TIMEOUT = 5000;
+
+	struct Watch
+	{
+		wil::unique_hfile directory;
+		DirectoryWatchRequest request;
+		OVERLAPPED overlapped;
+		BufferPool::Buffer buffer;
+		bool removing;
+	};
+
+	explicit IocpDirectoryChangeBackend(wil::unique_handle completionPort);
+
+	bool ReadChanges(Watch &watch);
+	bool ProcessCompletion(DWORD timeout, std::vector<DirectoryChangeEvent> &events);
+	static void ParseNotifications(int watchId, const std::byte *buffer, DWORD size,
+		std::vector<DirectoryChangeEvent> &events);
+
+	const wil::unique_handle m_completionPort;
+	BufferPool m_bufferPool;
+
+	std::mutex m_mutex;
+	std::unordered_map<int, std::unique_ptr<Watch>> m_watches;
+	int m_watchIdCounter;
+};
\ No newline at end of file
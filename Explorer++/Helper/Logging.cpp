@@ -5,4 +5,4 @@
 #include "stdafx.h"
 #include "Logging.h"
 
-BOOST_LOG_GLOBAL_LOGGER_DEFAULT(logger, boost::log::sources::wseverity_logger_mt<SeverityLevel>)
\ No newline at end of file
+std::atomic<AsyncLogger *> g_logger = nullptr;
\ No newline at end of file
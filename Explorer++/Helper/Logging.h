@@ -4,9 +4,8 @@
 
 #pragma once
 
-#include <boost\log\common.hpp>
-#include <boost\log\sources\global_logger_storage.hpp>
-#include <boost\log\sources\severity_logger.hpp>
+#include "AsyncLogger.h"
+#include <atomic>
 
 enum SeverityLevel
 {
@@ -42,6 +41,22 @@ inline std::basic_ostream<CharT, TraitsT>& operator<< (
 	return stream;
 }
 
-BOOST_LOG_GLOBAL_LOGGER(logger, boost::log::sources::wseverity_logger_mt<SeverityLevel>)
-
-#define LOG(severity) BOOST_LOG_SEV(logger::get(), severity)
\ No newline at end of file
+// Messages below this severity are removed at compile time, so that the
+// arguments aren't evaluated and no code is generated for them. To exclude
+// debug messages from a build, for example, define this as info.
+#ifndef LOG_MINIMUM_SEVERITY
+#define LOG_MINIMUM_SEVERITY debug
+#endif
+
+// The logger that LOG() writes to. Messages logged while this is null are
+// discarded.
+extern std::atomic<AsyncLogger *> g_logger;
+
+// Messages are recorded on the calling thread and formatted and written on a
+// background thread. See AsyncLogger for details.
+#define LOG(severity)                                  \
+	if constexpr ((severity) < (LOG_MINIMUM_SEVERITY)) \
+	{                                                  \
+	}                                                  \
+	else                                               \
+		AsyncLogger::Message(g_logger.load(std::memory_order_acquire), (severity))
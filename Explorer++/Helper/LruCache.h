@@ -0,0 +1,105 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <cassert>
+#include <functional>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+// A fixed-capacity map that discards the least recently used item once it's
+// full. Values are returned by copy, so large values should be stored
+// through a shared_ptr.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache
+{
+public:
+	explicit LruCache(size_t capacity) : m_capacity(capacity)
+	{
+		assert(capacity > 0);
+	}
+
+	// Marks the item as the most recently used item.
+	std::optional<Value> Get(const Key &key)
+	{
+		auto itr = m_index.find(key);
+
+		if (itr == m_index.end())
+		{
+			return std::nullopt;
+		}
+
+		m_items.splice(m_items.begin(), m_items, itr->second);
+
+		return itr->second->second;
+	}
+
+	bool Contains(const Key &key) const
+	{
+		return m_index.count(key) > 0;
+	}
+
+	// Any existing item with the same key will be replaced.
+	void Put(const Key &key, Value value)
+	{
+		auto itr = m_index.find(key);
+
+		if (itr != m_index.end())
+		{
+			itr->second->second = std::move(value);
+			m_items.splice(m_items.begin(), m_items, itr->second);
+			return;
+		}
+
+		if (m_items.size() == m_capacity)
+		{
+			m_index.erase(m_items.back().first);
+			m_items.pop_back();
+		}
+
+		m_items.emplace_front(key, std::move(value));
+		m_index.insert({ key, m_items.begin() });
+	}
+
+	void Remove(const Key &key)
+	{
+		auto itr = m_index.find(key);
+
+		if (itr == m_index.end())
+		{
+			return;
+		}
+
+		m_items.erase(itr->second);
+		m_index.erase(itr);
+	}
+
+	void Clear()
+	{
+		m_items.clear();
+		m_index.clear();
+	}
+
+	size_t GetSize() const
+	{
+		return m_items.size();
+	}
+
+	size_t GetCapacity() const
+	{
+		return m_capacity;
+	}
+
+private:
+	using ItemList = std::list<std::pair<Key, Value>>;
+
+	const size_t m_capacity;
+
+	// Ordered from most to least recently used.
+	ItemList m_items;
+	std::unordered_map<Key, typename ItemList::iterator, Hash> m_index;
+};
\ No newline at end of file
@@ -0,0 +1,116 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <wil/resource.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::filesystem::path &path)
+{
+	// The file is shared for writing, so that it can continue to be appended
+	// to while it's mapped.
+	wil::unique_hfile file(CreateFile(path.c_str(), GENERIC_READ,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr));
+
+	if (!file)
+	{
+		return nullptr;
+	}
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(file.get(), &fileSize) || fileSize.QuadPart == 0
+		|| static_cast<unsigned long long>(fileSize.QuadPart) > SIZE_MAX)
+	{
+		return nullptr;
+	}
+
+	wil::unique_handle mapping(
+		CreateFileMapping(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+
+	if (!mapping)
+	{
+		return nullptr;
+	}
+
+	// The view keeps the mapping (and file) alive, so the handles can be
+	// closed once it's been created.
+	void *view = MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0);
+
+	if (!view)
+	{
+		return nullptr;
+	}
+
+	return std::unique_ptr<MappedFile>(
+		new MappedFile(static_cast<const uint8_t *>(view), static_cast<size_t>(fileSize.QuadPart)));
+}
+
+MappedFile::~MappedFile()
+{
+	UnmapViewOfFile(m_data);
+}
+
+#else
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::filesystem::path &path)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+
+	if (fd == -1)
+	{
+		return nullptr;
+	}
+
+	struct stat fileInfo;
+
+	if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size == 0)
+	{
+		close(fd);
+		return nullptr;
+	}
+
+	void *view = mmap(nullptr, fileInfo.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (view == MAP_FAILED)
+	{
+		return nullptr;
+	}
+
+	return std::unique_ptr<MappedFile>(
+		new MappedFile(static_cast<const uint8_t *>(view), static_cast<size_t>(fileInfo.st_size)));
+}
+
+MappedFile::~MappedFile()
+{
+	munmap(const_cast<uint8_t *>(m_data), m_size);
+}
+
+#endif
+
+MappedFile::MappedFile(const uint8_t *data, size_t size) : m_data(data), m_size(size)
+{
+}
+
+const uint8_t *MappedFile::GetData() const
+{
+	return m_data;
+}
+
+size_t MappedFile::GetSize() const
+{
+	return m_size;
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+// A read-only view of an entire file. The file can still be appended to while
+// it's mapped, though the view won't include any data that's appended (a new
+// view needs to be created for that).
+class MappedFile
+{
+public:
+	// Returns null if the file doesn't exist, is empty or can't be mapped.
+	static std::unique_ptr<MappedFile> Open(const std::filesystem::path &path);
+
+	~MappedFile();
+
+	const uint8_t *GetData() const;
+	size_t GetSize() const;
+
+private:
+	MappedFile(const uint8_t *data, size_t size);
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	const uint8_t *const m_data;
+	const size_t m_size;
+};
\ No newline at end of file
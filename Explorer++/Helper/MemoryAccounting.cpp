@@ -0,0 +1,147 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "MemoryAccounting.h"
+#include <cstdlib>
+#include <map>
+#include <tuple>
+#include <utility>
+
+void MemoryCounter::Add(std::size_t bytes)
+{
+	m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void MemoryCounter::Subtract(std::size_t bytes)
+{
+	m_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+std::size_t MemoryCounter::GetBytes() const
+{
+	return m_bytes.load(std::memory_order_relaxed);
+}
+
+void *CountingRealloc(MemoryCounter *counter, void *ptr, std::size_t oldSize, std::size_t newSize)
+{
+	if (!ptr)
+	{
+		oldSize = 0;
+	}
+
+	if (newSize == 0)
+	{
+		std::free(ptr);
+		counter->Subtract(oldSize);
+		return nullptr;
+	}
+
+	void *newPtr = std::realloc(ptr, newSize);
+
+	// If the reallocation fails, the original block is left untouched.
+	if (!newPtr)
+	{
+		return nullptr;
+	}
+
+	counter->Subtract(oldSize);
+	counter->Add(newSize);
+
+	return newPtr;
+}
+
+MemoryAccountant::Registration::Registration(std::weak_ptr<State> state, int id) :
+	m_state(state),
+	m_id(id)
+{
+}
+
+MemoryAccountant::Registration::~Registration()
+{
+	Reset();
+}
+
+MemoryAccountant::Registration::Registration(Registration &&other) noexcept :
+	m_state(std::move(other.m_state)),
+	m_id(std::exchange(other.m_id, 0))
+{
+}
+
+MemoryAccountant::Registration &MemoryAccountant::Registration::operator=(
+	Registration &&other) noexcept
+{
+	if (this != &other)
+	{
+		Reset();
+
+		m_state = std::move(other.m_state);
+		m_id = std::exchange(other.m_id, 0);
+	}
+
+	return *this;
+}
+
+void MemoryAccountant::Registration::Reset()
+{
+	auto state = m_state.lock();
+
+	if (state)
+	{
+		std::scoped_lock lock(state->mutex);
+		state->sources.erase(m_id);
+	}
+
+	m_state.reset();
+	m_id = 0;
+}
+
+MemoryAccountant::MemoryAccountant() : m_state(std::make_shared<State>())
+{
+}
+
+MemoryAccountant::Registration MemoryAccountant::AddCounter(
+	const std::wstring &category, std::optional<int> tabId, const MemoryCounter *counter)
+{
+	return AddSource(category, tabId, [counter] { return counter->GetBytes(); });
+}
+
+MemoryAccountant::Registration MemoryAccountant::AddSource(
+	const std::wstring &category, std::optional<int> tabId, SizeFunction sizeFunction)
+{
+	std::scoped_lock lock(m_state->mutex);
+
+	int id = m_state->idCounter++;
+	m_state->sources.insert({ id, { category, tabId, sizeFunction } });
+
+	return Registration(m_state, id);
+}
+
+std::vector<MemoryUsageEntry> MemoryAccountant::GetEntries() const
+{
+	// Note that std::nullopt compares less than any tab ID, so shared memory
+	// will be listed first.
+	std::map<std::tuple<std::optional<int>, std::wstring>, std::size_t> totals;
+
+	{
+		// The lock is held while the size functions are called, so that a
+		// component can't be destroyed (which would require it to remove its
+		// registration) while its usage is being retrieved.
+		std::scoped_lock lock(m_state->mutex);
+
+		for (const auto &[id, source] : m_state->sources)
+		{
+			totals[{ source.tabId, source.category }] += source.sizeFunction();
+		}
+	}
+
+	std::vector<MemoryUsageEntry> entries;
+
+	for (const auto &[key, bytes] : totals)
+	{
+		entries.push_back({ std::get<1>(key), std::get<0>(key), bytes });
+	}
+
+	return entries;
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Tracks the number of bytes currently allocated by a component. This class
+// can be safely updated from multiple threads.
+class MemoryCounter
+{
+public:
+	MemoryCounter() = default;
+
+	MemoryCounter(const MemoryCounter &) = delete;
+	MemoryCounter &operator=(const MemoryCounter &) = delete;
+
+	void Add(std::size_t bytes);
+	void Subtract(std::size_t bytes);
+	std::size_t GetBytes() const;
+
+private:
+	std::atomic<std::size_t> m_bytes = 0;
+};
+
+// A standard allocator that records each allocation against a MemoryCounter.
+// Containers that use this allocator will report the memory used by their
+// nodes and buckets (though not memory that's separately allocated by the
+// elements themselves).
+template <typename T>
+class CountingAllocator
+{
+public:
+	using value_type = T;
+
+	template <typename U>
+	struct rebind
+	{
+		using other = CountingAllocator<U>;
+	};
+
+	explicit CountingAllocator(MemoryCounter *counter) noexcept : m_counter(counter)
+	{
+	}
+
+	template <typename U>
+	CountingAllocator(const CountingAllocator<U> &other) noexcept : m_counter(other.GetCounter())
+	{
+	}
+
+	T *allocate(std::size_t n)
+	{
+		T *ptr = std::allocator<T>().allocate(n);
+		m_counter->Add(n * sizeof(T));
+		return ptr;
+	}
+
+	void deallocate(T *ptr, std::size_t n) noexcept
+	{
+		std::allocator<T>().deallocate(ptr, n);
+		m_counter->Subtract(n * sizeof(T));
+	}
+
+	MemoryCounter *GetCounter() const noexcept
+	{
+		return m_counter;
+	}
+
+private:
+	MemoryCounter *m_counter;
+};
+
+template <typename T, typename U>
+bool operator==(const CountingAllocator<T> &first, const CountingAllocator<U> &second) noexcept
+{
+	return first.GetCounter() == second.GetCounter();
+}
+
+template <typename T, typename U>
+bool operator!=(const CountingAllocator<T> &first, const CountingAllocator<U> &second) noexcept
+{
+	return !(first == second);
+}
+
+// Resizes (or frees, if newSize is 0) a block of memory, recording the change
+// against the counter. This follows the semantics of a Lua allocation
+// function, so oldSize is ignored when ptr is null.
+void *CountingRealloc(MemoryCounter *counter, void *ptr, std::size_t oldSize, std::size_t newSize);
+
+struct MemoryUsageEntry
+{
+	std::wstring category;
+
+	// Memory that isn't owned by any single tab (e.g. memory used by a shared
+	// cache) has no tab ID.
+	std::optional<int> tabId;
+
+	std::size_t bytes;
+};
+
+// Collects memory usage from the different parts of the application, so that
+// it can be reported in one place. Each source of memory is registered under
+// a category and (optionally) a tab. A source is either a MemoryCounter or a
+// function that calculates the current usage on demand, for components that
+// don't allocate through a counter.
+class MemoryAccountant
+{
+private:
+	struct State;
+
+public:
+	using SizeFunction = std::function<std::size_t()>;
+
+	// Removes the associated source when destroyed. It's safe for a
+	// registration to outlive the accountant it was created by.
+	class Registration
+	{
+	public:
+		Registration() = default;
+		~Registration();
+
+		Registration(Registration &&other) noexcept;
+		Registration &operator=(Registration &&other) noexcept;
+
+		Registration(const Registration &) = delete;
+		Registration &operator=(const Registration &) = delete;
+
+	private:
+		friend class MemoryAccountant;
+
+		Registration(std::weak_ptr<State> state, int id);
+		void Reset();
+
+		std::weak_ptr<State> m_state;
+		int m_id = 0;
+	};
+
+	MemoryAccountant();
+
+	MemoryAccountant(const MemoryAccountant &) = delete;
+	MemoryAccountant &operator=(const MemoryAccountant &) = delete;
+
+	[[nodiscard]] Registration AddCounter(
+		const std::wstring &category, std::optional<int> tabId, const MemoryCounter *counter);
+	[[nodiscard]] Registration AddSource(
+		const std::wstring &category, std::optional<int> tabId, SizeFunction sizeFunction);
+
+	// Sources that share the same category and tab are combined into a single
+	// entry. Entries are ordered by tab (with shared memory first), then by
+	// category.
+	std::vector<MemoryUsageEntry> GetEntries() const;
+
+private:
+	struct Source
+	{
+		std::wstring category;
+		std::optional<int> tabId;
+		SizeFunction sizeFunction;
+	};
+
+	struct State
+	{
+		mutable std::mutex mutex;
+		std::unordered_map<int, Source> sources;
+		int idCounter = 1;
+	};
+
+	std::shared_ptr<State> m_state;
+};
\ No newline at end of file
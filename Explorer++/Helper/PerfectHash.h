@@ -0,0 +1,210 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+// A fixed map from strings to values, whose hash function is chosen at compile
+// time so that no two keys collide. Looking up a key therefore involves
+// hashing it once and then performing a single string comparison.
+//
+// The table is built using "hash and displace": keys are first divided into
+// small buckets, then, starting with the largest bucket, a seed is found that
+// places every key in the bucket into an empty slot. Lookups use the seed
+// stored for the key's bucket.
+//
+// Maps should be declared constexpr, so that any failure to build the table
+// is reported as a compile error, e.g.:
+//
+// constexpr auto COLORS = MakePerfectHashMap<Color>({ { L"Red", Color::Red },
+//     { L"Green", Color::Green } });
+template <typename Value, size_t N>
+class PerfectHashMap
+{
+public:
+	using Entry = std::pair<std::wstring_view, Value>;
+
+	constexpr explicit PerfectHashMap(const std::array<Entry, N> &entries) :
+		m_entries(entries),
+		m_seeds{},
+		m_slots{}
+	{
+		std::array<uint32_t, N> keyHashes{};
+		std::array<size_t, NUM_BUCKETS + 1> bucketStarts{};
+
+		for (size_t i = 0; i < N; i++)
+		{
+			keyHashes[i] = HashKey(entries[i].first);
+			bucketStarts[keyHashes[i] % NUM_BUCKETS + 1]++;
+		}
+
+		size_t largestBucketSize = 0;
+
+		for (size_t bucket = 0; bucket < NUM_BUCKETS; bucket++)
+		{
+			if (bucketStarts[bucket + 1] > largestBucketSize)
+			{
+				largestBucketSize = bucketStarts[bucket + 1];
+			}
+
+			bucketStarts[bucket + 1] += bucketStarts[bucket];
+		}
+
+		// Groups the keys by bucket, so that each bucket's keys are stored
+		// contiguously.
+		std::array<size_t, N> bucketKeys{};
+		std::array<size_t, NUM_BUCKETS> bucketPositions{};
+
+		for (size_t i = 0; i < N; i++)
+		{
+			size_t bucket = keyHashes[i] % NUM_BUCKETS;
+			bucketKeys[bucketStarts[bucket] + bucketPositions[bucket]++] = i;
+		}
+
+		for (size_t size = largestBucketSize; size > 0; size--)
+		{
+			for (size_t bucket = 0; bucket < NUM_BUCKETS; bucket++)
+			{
+				if (bucketStarts[bucket + 1] - bucketStarts[bucket] == size)
+				{
+					PlaceBucket(bucket, keyHashes, bucketKeys, bucketStarts[bucket],
+						bucketStarts[bucket + 1]);
+				}
+			}
+		}
+	}
+
+	constexpr std::optional<Value> Find(std::wstring_view key) const
+	{
+		uint32_t keyHash = HashKey(key);
+		uint32_t seed = m_seeds[keyHash % NUM_BUCKETS];
+		uint16_t slot = m_slots[Mix(keyHash, seed) % NUM_SLOTS];
+
+		if (slot == EMPTY_SLOT || m_entries[slot - 1].first != key)
+		{
+			return std::nullopt;
+		}
+
+		return m_entries[slot - 1].second;
+	}
+
+	static constexpr size_t GetSize()
+	{
+		return N;
+	}
+
+private:
+	static_assert(N > 0 && N < UINT16_MAX, "Unsupported number of entries");
+
+	static constexpr size_t NUM_BUCKETS = (N + 1) / 2;
+
+	static constexpr size_t GetNumSlots()
+	{
+		size_t numSlots = 1;
+
+		while (numSlots < N + N / 4)
+		{
+			numSlots *= 2;
+		}
+
+		return numSlots;
+	}
+
+	static constexpr size_t NUM_SLOTS = GetNumSlots();
+	static constexpr uint16_t EMPTY_SLOT = 0;
+	static constexpr uint32_t MAX_SEED = 1 << 20;
+
+	// FNV-1a.
+	static constexpr uint32_t HashKey(std::wstring_view key)
+	{
+		uint32_t hash = 2166136261;
+
+		for (wchar_t c : key)
+		{
+			hash ^= static_cast<uint32_t>(c);
+			hash *= 16777619;
+		}
+
+		return hash;
+	}
+
+	// Only the key's hash is rehashed for each seed, so trying a seed doesn't
+	// depend on the length of the key.
+	static constexpr uint32_t Mix(uint32_t keyHash, uint32_t seed)
+	{
+		uint32_t hash = keyHash ^ (seed * 0x9e3779b9);
+		hash ^= hash >> 16;
+		hash *= 0x85ebca6b;
+		hash ^= hash >> 13;
+		hash *= 0xc2b2ae35;
+		hash ^= hash >> 16;
+		return hash;
+	}
+
+	// Places the keys in bucketKeys[first, last), which all belong to the
+	// specified bucket.
+	constexpr void PlaceBucket(size_t bucket, const std::array<uint32_t, N> &keyHashes,
+		const std::array<size_t, N> &bucketKeys, size_t first, size_t last)
+	{
+		for (uint32_t seed = 0; seed < MAX_SEED; seed++)
+		{
+			size_t numPlaced = 0;
+
+			for (size_t i = first; i < last; i++)
+			{
+				size_t slot = Mix(keyHashes[bucketKeys[i]], seed) % NUM_SLOTS;
+
+				if (m_slots[slot] != EMPTY_SLOT)
+				{
+					break;
+				}
+
+				m_slots[slot] = static_cast<uint16_t>(bucketKeys[i] + 1);
+				numPlaced++;
+			}
+
+			if (numPlaced == last - first)
+			{
+				m_seeds[bucket] = seed;
+				return;
+			}
+
+			// Undoes the placements made with this seed.
+			for (size_t i = first; i < first + numPlaced; i++)
+			{
+				m_slots[Mix(keyHashes[bucketKeys[i]], seed) % NUM_SLOTS] = EMPTY_SLOT;
+			}
+		}
+
+		// Only reachable if two keys are identical, or have the same hash.
+		throw std::logic_error("Unable to build perfect hash table");
+	}
+
+	std::array<Entry, N> m_entries;
+	std::array<uint32_t, NUM_BUCKETS> m_seeds;
+	std::array<uint16_t, NUM_SLOTS> m_slots;
+};
+
+namespace PerfectHashDetail
+{
+template <typename Value, size_t N, size_t... Indexes>
+constexpr PerfectHashMap<Value, N> MakePerfectHashMap(
+	const std::pair<std::wstring_view, Value> (&entries)[N], std::index_sequence<Indexes...>)
+{
+	return PerfectHashMap<Value, N>({ entries[Indexes]... });
+}
+}
+
+template <typename Value, size_t N>
+constexpr PerfectHashMap<Value, N> MakePerfectHashMap(
+	const std::pair<std::wstring_view, Value> (&entries)[N])
+{
+	return PerfectHashDetail::MakePerfectHashMap(entries, std::make_index_sequence<N>());
+}
\ No newline at end of file
@@ -0,0 +1,218 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "SharedDirectoryMonitor.h"
+#include <algorithm>
+#include <cwctype>
+
+SharedDirectoryMonitor::SharedDirectoryMonitor(std::unique_ptr<DirectoryChangeBackend> backend) :
+	m_backend(std::move(backend)),
+	m_subscriptionIdCounter(0),
+	m_stopping(false)
+{
+	m_workerThread = std::thread(&SharedDirectoryMonitor::Run, this);
+}
+
+SharedDirectoryMonitor::~SharedDirectoryMonitor()
+{
+	m_stopping = true;
+	m_backend->Wake();
+	m_workerThread.join();
+
+	for (const auto &[watchId, watch] : m_watches)
+	{
+		m_backend->RemoveWatch(watchId);
+	}
+}
+
+std::optional<int> SharedDirectoryMonitor::Subscribe(
+	const DirectoryWatchRequest &request, Callback callback)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	WatchKey key = MakeWatchKey(request);
+	auto itr = m_sharedWatchIds.find(key);
+
+	if (itr != m_sharedWatchIds.end())
+	{
+		return AddSubscription(itr->second, std::move(callback));
+	}
+
+	auto watchId = m_backend->AddWatch(request);
+
+	if (!watchId)
+	{
+		return std::nullopt;
+	}
+
+	m_sharedWatchIds.emplace(key, *watchId);
+	m_watches.emplace(*watchId, Watch{ key, {} });
+
+	return AddSubscription(*watchId, std::move(callback));
+}
+
+int SharedDirectoryMonitor::SubscribeToExclusiveWatch(int watchId, Callback callback)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_watches.emplace(watchId, Watch{ std::nullopt, {} });
+
+	return AddSubscription(watchId, std::move(callback));
+}
+
+// Should be called with m_mutex held.
+int SharedDirectoryMonitor::AddSubscription(int watchId, Callback callback)
+{
+	int subscriptionId = m_subscriptionIdCounter++;
+
+	m_watches.at(watchId).subscriptionIds.push_back(subscriptionId);
+	m_subscriptions.emplace(
+		subscriptionId, Subscription{ watchId, std::make_shared<Callback>(std::move(callback)) });
+
+	return subscriptionId;
+}
+
+void SharedDirectoryMonitor::Unsubscribe(int subscriptionId)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto itr = m_subscriptions.find(subscriptionId);
+
+		if (itr == m_subscriptions.end())
+		{
+			return;
+		}
+
+		int watchId = itr->second.watchId;
+		m_subscriptions.erase(itr);
+
+		Watch &watch = m_watches.at(watchId);
+		watch.subscriptionIds.erase(std::remove(watch.subscriptionIds.begin(),
+										watch.subscriptionIds.end(), subscriptionId),
+			watch.subscriptionIds.end());
+
+		if (watch.subscriptionIds.empty())
+		{
+			if (watch.key)
+			{
+				m_sharedWatchIds.erase(*watch.key);
+			}
+
+			m_watches.erase(watchId);
+			m_backend->RemoveWatch(watchId);
+		}
+	}
+
+	// The callback may currently be running on the worker thread. Waiting for
+	// the current batch of events to be dispatched means the caller can safely
+	// free anything the callback refers to. There's no need to wait if this
+	// was called from within a callback.
+	if (std::this_thread::get_id() != m_workerThread.get_id())
+	{
+		std::lock_guard<std::mutex> dispatchLock(m_dispatchMutex);
+	}
+}
+
+size_t SharedDirectoryMonitor::GetNumWatches() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_watches.size();
+}
+
+void SharedDirectoryMonitor::Run()
+{
+	std::vector<DirectoryChangeEvent> events;
+
+	while (true)
+	{
+		events.clear();
+		m_backend->WaitForEvents(events);
+
+		if (m_stopping)
+		{
+			break;
+		}
+
+		std::lock_guard<std::mutex> dispatchLock(m_dispatchMutex);
+
+		for (const auto &event : events)
+		{
+			DispatchEvent(event);
+		}
+	}
+}
+
+void SharedDirectoryMonitor::DispatchEvent(const DirectoryChangeEvent &event)
+{
+	std::vector<int> subscriptionIds;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto itr = m_watches.find(event.watchId);
+
+		// The watch may have been removed after this event was queued.
+		if (itr == m_watches.end())
+		{
+			return;
+		}
+
+		subscriptionIds = itr->second.subscriptionIds;
+	}
+
+	for (int subscriptionId : subscriptionIds)
+	{
+		std::shared_ptr<Callback> callback;
+
+		{
+			// A previous callback may have unsubscribed this subscription.
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			auto itr = m_subscriptions.find(subscriptionId);
+
+			if (itr == m_subscriptions.end())
+			{
+				continue;
+			}
+
+			callback = itr->second.callback;
+		}
+
+		(*callback)(event.fileName, event.action);
+	}
+}
+
+SharedDirectoryMonitor::WatchKey SharedDirectoryMonitor::MakeWatchKey(
+	const DirectoryWatchRequest &request)
+{
+	std::wstring path = request.path;
+
+	while (path.size() > 1 && (path.back() == '\\' || path.back() == '/'))
+	{
+		path.pop_back();
+	}
+
+#ifdef _WIN32
+	// Paths are case-insensitive on Windows.
+	std::transform(path.begin(), path.end(), path.begin(),
+		[](wchar_t c) { return static_cast<wchar_t>(std::towupper(c)); });
+#endif
+
+	return { path, request.filter, request.watchSubtree };
+}
+
+bool SharedDirectoryMonitor::WatchKey::operator==(const WatchKey &other) const
+{
+	return path == other.path && filter == other.filter && watchSubtree == other.watchSubtree;
+}
+
+size_t SharedDirectoryMonitor::WatchKeyHash::operator()(const WatchKey &key) const
+{
+	size_t hash = std::hash<std::wstring>()(key.path);
+	hash ^= std::hash<uint32_t>()(key.filter) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= std::hash<bool>()(key.watchSubtree) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	return hash;
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "DirectoryChangeBackend.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Monitors directories on behalf of any number of subscribers. Subscribers
+// that ask to watch the same directory, with the same filter, share a single
+// underlying watch, which is only removed once the last of them has
+// unsubscribed. Each change is then fanned out to every subscriber.
+//
+// All changes are read on a single worker thread, which is also the thread
+// the callbacks are invoked on. Once Unsubscribe() returns, the callback for
+// that subscription won't be invoked again, so callbacks mustn't block on a
+// thread that may call Unsubscribe().
+//
+// This class doesn't depend on any Windows APIs. The platform-specific work
+// is done by the DirectoryChangeBackend that's passed in.
+class SharedDirectoryMonitor
+{
+public:
+	using Callback =
+		std::function<void(const std::wstring &fileName, DirectoryChangeAction action)>;
+
+	explicit SharedDirectoryMonitor(std::unique_ptr<DirectoryChangeBackend> backend);
+	~SharedDirectoryMonitor();
+
+	SharedDirectoryMonitor(const SharedDirectoryMonitor &) = delete;
+	SharedDirectoryMonitor &operator=(const SharedDirectoryMonitor &) = delete;
+
+	// Returns the ID of the subscription, or nothing if the directory couldn't
+	// be watched.
+	std::optional<int> Subscribe(const DirectoryWatchRequest &request, Callback callback);
+
+	// Subscribes to a watch the caller has already added to the backend. The
+	// watch won't be shared with any other subscriber and will be removed
+	// once the subscription ends.
+	int SubscribeToExclusiveWatch(int watchId, Callback callback);
+
+	void Unsubscribe(int subscriptionId);
+
+	// The number of watches that have been added to the backend and not yet
+	// removed.
+	size_t GetNumWatches() const;
+
+private:
+	struct WatchKey
+	{
+		std::wstring path;
+		uint32_t filter;
+		bool watchSubtree;
+
+		bool operator==(const WatchKey &other) const;
+	};
+
+	struct WatchKeyHash
+	{
+		size_t operator()(const WatchKey &key) const;
+	};
+
+	struct Watch
+	{
+		// Exclusive watches aren't keyed, since they're never shared.
+		std::optional<WatchKey> key;
+
+		std::vector<int> subscriptionIds;
+	};
+
+	struct Subscription
+	{
+		int watchId;
+		std::shared_ptr<Callback> callback;
+	};
+
+	static WatchKey MakeWatchKey(const DirectoryWatchRequest &request);
+
+	int AddSubscription(int watchId, Callback callback);
+	void Run();
+	void DispatchEvent(const DirectoryChangeEvent &event);
+
+	const std::unique_ptr<DirectoryChangeBackend> m_backend;
+
+	mutable std::mutex m_mutex;
+	std::unordered_map<WatchKey, int, WatchKeyHash> m_sharedWatchIds;
+	std::unordered_map<int, Watch> m_watches;
+	std::unordered_map<int, Subscription> m_subscriptions;
+	int m_subscriptionIdCounter;
+
+	// Held by the worker thread while callbacks are being invoked.
+	std::mutex m_dispatchMutex;
+
+	std::atomic<bool> m_stopping;
+	std::thread m_workerThread;
+};
\ No newline at end of file
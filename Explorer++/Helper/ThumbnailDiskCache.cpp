@@ -0,0 +1,696 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "ThumbnailDiskCache.h"
+#include <algorithm>
+
+namespace
+{
+// All values are stored in little-endian order, regardless of the platform.
+class BinaryWriter
+{
+public:
+	void WriteUint32(uint32_t value)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			m_data.push_back(static_cast<uint8_t>(value >> (i * 8)));
+		}
+	}
+
+	void WriteUint64(uint64_t value)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			m_data.push_back(static_cast<uint8_t>(value >> (i * 8)));
+		}
+	}
+
+	void WriteKey(const ThumbnailKey &key)
+	{
+		WriteUint64(key.pathHash);
+		WriteUint64(key.fileSize);
+		WriteUint64(key.lastWriteTime);
+		WriteUint32(key.width);
+		WriteUint32(key.height);
+	}
+
+	const std::vector<uint8_t> &GetData() const
+	{
+		return m_data;
+	}
+
+private:
+	std::vector<uint8_t> m_data;
+};
+
+class BinaryReader
+{
+public:
+	BinaryReader(const uint8_t *data, size_t size) : m_data(data), m_size(size), m_position(0)
+	{
+	}
+
+	bool ReadUint32(uint32_t &value)
+	{
+		if (m_size - m_position < 4)
+		{
+			return false;
+		}
+
+		value = 0;
+
+		for (int i = 0; i < 4; i++)
+		{
+			value |= static_cast<uint32_t>(m_data[m_position++]) << (i * 8);
+		}
+
+		return true;
+	}
+
+	bool ReadUint64(uint64_t &value)
+	{
+		if (m_size - m_position < 8)
+		{
+			return false;
+		}
+
+		value = 0;
+
+		for (int i = 0; i < 8; i++)
+		{
+			value |= static_cast<uint64_t>(m_data[m_position++]) << (i * 8);
+		}
+
+		return true;
+	}
+
+	bool ReadKey(ThumbnailKey &key)
+	{
+		return ReadUint64(key.pathHash) && ReadUint64(key.fileSize)
+			&& ReadUint64(key.lastWriteTime) && ReadUint32(key.width) && ReadUint32(key.height);
+	}
+
+private:
+	const uint8_t *m_data;
+	size_t m_size;
+	size_t m_position;
+};
+
+size_t CombineHash(size_t seed, uint64_t value)
+{
+	return seed ^ (std::hash<uint64_t>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+void WriteFileHeader(BinaryWriter &writer, uint32_t magic, uint32_t version)
+{
+	writer.WriteUint32(magic);
+	writer.WriteUint32(version);
+}
+
+bool WriteToStream(std::ostream &stream, const std::vector<uint8_t> &data)
+{
+	stream.write(reinterpret_cast<const char *>(data.data()), data.size());
+	return static_cast<bool>(stream);
+}
+}
+
+bool ThumbnailKey::operator==(const ThumbnailKey &other) const
+{
+	return pathHash == other.pathHash && fileSize == other.fileSize
+		&& lastWriteTime == other.lastWriteTime && width == other.width
+		&& height == other.height;
+}
+
+size_t ThumbnailDiskCache::KeyHash::operator()(const ThumbnailKey &key) const
+{
+	size_t seed = std::hash<uint64_t>()(key.pathHash);
+	seed = CombineHash(seed, key.fileSize);
+	seed = CombineHash(seed, key.lastWriteTime);
+	seed = CombineHash(seed, (static_cast<uint64_t>(key.width) << 32) | key.height);
+	return seed;
+}
+
+bool ThumbnailDiskCache::PathKey::operator==(const PathKey &other) const
+{
+	return pathHash == other.pathHash && width == other.width && height == other.height;
+}
+
+size_t ThumbnailDiskCache::PathKeyHash::operator()(const PathKey &pathKey) const
+{
+	size_t seed = std::hash<uint64_t>()(pathKey.pathHash);
+	return CombineHash(seed, (static_cast<uint64_t>(pathKey.width) << 32) | pathKey.height);
+}
+
+ThumbnailDiskCache::ThumbnailDiskCache(const std::filesystem::path &packFilePath,
+	const std::filesystem::path &indexFilePath, uint64_t maxSize) :
+	m_packFilePath(packFilePath),
+	m_indexFilePath(indexFilePath),
+	m_maxSize(maxSize),
+	m_packFileSize(0),
+	m_liveBytes(0),
+	m_useCounter(0),
+	m_compactionQueued(false),
+	m_compactionThreadPool(1)
+{
+	Initialize();
+}
+
+ThumbnailDiskCache::~ThumbnailDiskCache()
+{
+	// Any queued compaction needs to finish before the index is saved, since
+	// compaction changes the position of each thumbnail.
+	m_compactionThreadPool.stop(true);
+
+	SaveIndex();
+}
+
+void ThumbnailDiskCache::Initialize()
+{
+	m_mappedPackFile = MappedFile::Open(m_packFilePath);
+
+	if (!m_mappedPackFile || !LoadIndex())
+	{
+		if (!RebuildIndex())
+		{
+			ResetPackFile();
+		}
+	}
+
+	OpenPackFileForWriting();
+}
+
+bool ThumbnailDiskCache::LoadIndex()
+{
+	auto mappedIndexFile = MappedFile::Open(m_indexFilePath);
+
+	if (!mappedIndexFile || !m_mappedPackFile)
+	{
+		return false;
+	}
+
+	BinaryReader reader(mappedIndexFile->GetData(), mappedIndexFile->GetSize());
+
+	uint32_t magic;
+	uint32_t version;
+	uint64_t packFileSize;
+	uint64_t useCounter;
+	uint64_t numEntries;
+
+	if (!reader.ReadUint32(magic) || magic != INDEX_FILE_MAGIC || !reader.ReadUint32(version)
+		|| version != FILE_VERSION || !reader.ReadUint64(packFileSize)
+		|| !reader.ReadUint64(useCounter) || !reader.ReadUint64(numEntries))
+	{
+		return false;
+	}
+
+	// If the pack file has changed since the index was written, the index
+	// can't be relied upon.
+	if (packFileSize != m_mappedPackFile->GetSize())
+	{
+		return false;
+	}
+
+	std::unordered_map<ThumbnailKey, Entry, KeyHash> entries;
+
+	for (uint64_t i = 0; i < numEntries; i++)
+	{
+		ThumbnailKey key;
+		Entry entry;
+
+		if (!reader.ReadKey(key) || !reader.ReadUint64(entry.offset)
+			|| !reader.ReadUint64(entry.lastUsed))
+		{
+			return false;
+		}
+
+		if (entry.offset < FILE_HEADER_SIZE || entry.offset > packFileSize
+			|| packFileSize - entry.offset < RECORD_HEADER_SIZE)
+		{
+			return false;
+		}
+
+		// The size of each record is taken from the pack file, so that it's
+		// not possible for the index to point outside a record.
+		BinaryReader recordReader(m_mappedPackFile->GetData() + entry.offset, RECORD_HEADER_SIZE);
+		ThumbnailKey recordKey = {};
+		uint32_t imageWidth = 0;
+		uint32_t imageHeight = 0;
+		uint32_t pixelsSize = 0;
+		recordReader.ReadKey(recordKey);
+		recordReader.ReadUint32(imageWidth);
+		recordReader.ReadUint32(imageHeight);
+		recordReader.ReadUint32(pixelsSize);
+
+		entry.size = RECORD_HEADER_SIZE + static_cast<uint64_t>(pixelsSize);
+
+		if (!(recordKey == key)
+			|| pixelsSize != static_cast<uint64_t>(imageWidth) * imageHeight * 4
+			|| packFileSize - entry.offset < entry.size)
+		{
+			return false;
+		}
+
+		entries.insert({ key, entry });
+	}
+
+	m_entries.clear();
+	m_latestEntries.clear();
+	m_liveBytes = 0;
+
+	for (const auto &[key, entry] : entries)
+	{
+		AddEntry(key, entry);
+	}
+
+	m_packFileSize = packFileSize;
+	m_useCounter = useCounter;
+
+	return true;
+}
+
+// Each record in the pack file contains its key, so the index can be
+// recreated from the pack file alone. Records later in the file are more
+// recent.
+bool ThumbnailDiskCache::RebuildIndex()
+{
+	m_entries.clear();
+	m_latestEntries.clear();
+	m_packFileSize = 0;
+	m_liveBytes = 0;
+	m_useCounter = 0;
+
+	if (!m_mappedPackFile)
+	{
+		return false;
+	}
+
+	const uint8_t *data = m_mappedPackFile->GetData();
+	uint64_t size = m_mappedPackFile->GetSize();
+
+	BinaryReader headerReader(data, static_cast<size_t>(size));
+	uint32_t magic;
+	uint32_t version;
+
+	if (!headerReader.ReadUint32(magic) || magic != PACK_FILE_MAGIC
+		|| !headerReader.ReadUint32(version) || version != FILE_VERSION)
+	{
+		return false;
+	}
+
+	uint64_t offset = FILE_HEADER_SIZE;
+
+	while (size - offset >= RECORD_HEADER_SIZE)
+	{
+		BinaryReader recordReader(data + offset, RECORD_HEADER_SIZE);
+		ThumbnailKey key = {};
+		uint32_t imageWidth = 0;
+		uint32_t imageHeight = 0;
+		uint32_t pixelsSize = 0;
+		recordReader.ReadKey(key);
+		recordReader.ReadUint32(imageWidth);
+		recordReader.ReadUint32(imageHeight);
+		recordReader.ReadUint32(pixelsSize);
+
+		uint64_t recordSize = RECORD_HEADER_SIZE + static_cast<uint64_t>(pixelsSize);
+
+		// A truncated record (e.g. because the application exited while the
+		// record was being written) marks the end of the usable data.
+		if (pixelsSize != static_cast<uint64_t>(imageWidth) * imageHeight * 4
+			|| size - offset < recordSize)
+		{
+			break;
+		}
+
+		AddEntry(key, { offset, recordSize, m_useCounter++ });
+
+		offset += recordSize;
+	}
+
+	// Anything after the last complete record will be overwritten.
+	m_packFileSize = offset;
+
+	if (offset != size)
+	{
+		m_mappedPackFile.reset();
+		std::error_code errorCode;
+		std::filesystem::resize_file(m_packFilePath, offset, errorCode);
+
+		if (errorCode)
+		{
+			return false;
+		}
+
+		m_mappedPackFile = MappedFile::Open(m_packFilePath);
+	}
+
+	return true;
+}
+
+void ThumbnailDiskCache::ResetPackFile()
+{
+	m_mappedPackFile.reset();
+	m_entries.clear();
+	m_latestEntries.clear();
+	m_liveBytes = 0;
+	m_useCounter = 0;
+
+	std::ofstream stream(m_packFilePath, std::ios::binary | std::ios::trunc);
+	BinaryWriter writer;
+	WriteFileHeader(writer, PACK_FILE_MAGIC, FILE_VERSION);
+
+	m_packFileSize = WriteToStream(stream, writer.GetData()) ? FILE_HEADER_SIZE : 0;
+}
+
+bool ThumbnailDiskCache::OpenPackFileForWriting()
+{
+	m_packFileStream.close();
+	m_packFileStream.clear();
+
+	if (m_packFileSize == 0)
+	{
+		return false;
+	}
+
+	m_packFileStream.open(m_packFilePath, std::ios::binary | std::ios::app);
+
+	return m_packFileStream.is_open();
+}
+
+void ThumbnailDiskCache::AddEntry(const ThumbnailKey &key, const Entry &entry)
+{
+	auto [latestItr, inserted] = m_latestEntries.insert({ GetPathKey(key), key });
+
+	if (!inserted)
+	{
+		// A thumbnail for a previous version of the file will never be used
+		// again, so it can be discarded.
+		auto existingItr = m_entries.find(latestItr->second);
+
+		if (existingItr != m_entries.end() && !(existingItr->first == key))
+		{
+			m_liveBytes -= existingItr->second.size;
+			m_entries.erase(existingItr);
+		}
+
+		latestItr->second = key;
+	}
+
+	auto [itr, entryInserted] = m_entries.insert({ key, entry });
+
+	if (!entryInserted)
+	{
+		m_liveBytes -= itr->second.size;
+		itr->second = entry;
+	}
+
+	m_liveBytes += entry.size;
+}
+
+void ThumbnailDiskCache::RemoveEntry(std::unordered_map<ThumbnailKey, Entry, KeyHash>::iterator itr)
+{
+	m_latestEntries.erase(GetPathKey(itr->first));
+	m_liveBytes -= itr->second.size;
+	m_entries.erase(itr);
+}
+
+ThumbnailDiskCache::PathKey ThumbnailDiskCache::GetPathKey(const ThumbnailKey &key)
+{
+	return { key.pathHash, key.width, key.height };
+}
+
+bool ThumbnailDiskCache::EnsureMapped(uint64_t end)
+{
+	if (m_mappedPackFile && m_mappedPackFile->GetSize() >= end)
+	{
+		return true;
+	}
+
+	// The pack file has been appended to since it was mapped.
+	m_mappedPackFile = MappedFile::Open(m_packFilePath);
+
+	return m_mappedPackFile && m_mappedPackFile->GetSize() >= end;
+}
+
+std::optional<ThumbnailImage> ThumbnailDiskCache::Find(const ThumbnailKey &key)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto itr = m_entries.find(key);
+
+	if (itr == m_entries.end())
+	{
+		return std::nullopt;
+	}
+
+	const Entry &entry = itr->second;
+
+	if (!EnsureMapped(entry.offset + entry.size))
+	{
+		RemoveEntry(itr);
+		return std::nullopt;
+	}
+
+	const uint8_t *record = m_mappedPackFile->GetData() + entry.offset;
+	BinaryReader reader(record, RECORD_HEADER_SIZE);
+	ThumbnailKey recordKey = {};
+	ThumbnailImage image = {};
+	uint32_t pixelsSize = 0;
+	reader.ReadKey(recordKey);
+	reader.ReadUint32(image.width);
+	reader.ReadUint32(image.height);
+	reader.ReadUint32(pixelsSize);
+
+	if (!(recordKey == key) || RECORD_HEADER_SIZE + static_cast<uint64_t>(pixelsSize) != entry.size)
+	{
+		RemoveEntry(itr);
+		return std::nullopt;
+	}
+
+	image.pixels.assign(record + RECORD_HEADER_SIZE, record + entry.size);
+	itr->second.lastUsed = m_useCounter++;
+
+	return image;
+}
+
+bool ThumbnailDiskCache::Add(const ThumbnailKey &key, const ThumbnailImage &image)
+{
+	if (image.pixels.size() != static_cast<uint64_t>(image.width) * image.height * 4
+		|| image.pixels.size() > UINT32_MAX)
+	{
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_packFileStream.is_open())
+		{
+			return false;
+		}
+
+		BinaryWriter writer;
+		writer.WriteKey(key);
+		writer.WriteUint32(image.width);
+		writer.WriteUint32(image.height);
+		writer.WriteUint32(static_cast<uint32_t>(image.pixels.size()));
+
+		if (!WriteToStream(m_packFileStream, writer.GetData())
+			|| !WriteToStream(m_packFileStream, image.pixels) || !m_packFileStream.flush())
+		{
+			// The pack file may now contain a partial record, so the index
+			// will need to be rebuilt the next time the cache is loaded.
+			m_packFileStream.close();
+			return false;
+		}
+
+		uint64_t recordSize = RECORD_HEADER_SIZE + image.pixels.size();
+		AddEntry(key, { m_packFileSize, recordSize, m_useCounter++ });
+		m_packFileSize += recordSize;
+
+		if (!NeedsCompaction() || m_compactionQueued.exchange(true))
+		{
+			return true;
+		}
+	}
+
+	m_compactionThreadPool.push([this](int) { Compact(); });
+
+	return true;
+}
+
+bool ThumbnailDiskCache::NeedsCompaction() const
+{
+	if (m_packFileSize > m_maxSize)
+	{
+		return true;
+	}
+
+	uint64_t wastedBytes = GetWastedBytesInternal();
+
+	return wastedBytes >= MIN_WASTED_SPACE_COMPACTION_SIZE
+		&& wastedBytes * 100 >= m_packFileSize * WASTED_SPACE_COMPACTION_PERCENTAGE;
+}
+
+void ThumbnailDiskCache::Compact()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	CompactInternal();
+	m_compactionQueued = false;
+}
+
+// Rewrites the pack file, keeping only the most recently used thumbnails. The
+// cache is locked for the duration, so lookups made in the meantime will
+// wait. Since lookups are made from background threads, that won't block the
+// UI.
+void ThumbnailDiskCache::CompactInternal()
+{
+	std::vector<std::pair<ThumbnailKey, Entry>> entries(m_entries.begin(), m_entries.end());
+
+	std::sort(entries.begin(), entries.end(), [](const auto &first, const auto &second) {
+		return first.second.lastUsed > second.second.lastUsed;
+	});
+
+	uint64_t targetSize = m_maxSize * COMPACTION_TARGET_PERCENTAGE / 100;
+	uint64_t newSize = FILE_HEADER_SIZE;
+	size_t numRetained = 0;
+
+	for (const auto &[key, entry] : entries)
+	{
+		if (newSize + entry.size > targetSize)
+		{
+			break;
+		}
+
+		newSize += entry.size;
+		numRetained++;
+	}
+
+	entries.resize(numRetained);
+
+	if (!entries.empty() && !EnsureMapped(m_packFileSize))
+	{
+		entries.clear();
+	}
+
+	// Records are written in the order they were last used, so that, if the
+	// index is ever rebuilt, the order will be the same.
+	std::reverse(entries.begin(), entries.end());
+
+	std::filesystem::path tempFilePath = m_packFilePath;
+	tempFilePath += L".tmp";
+
+	std::ofstream tempStream(tempFilePath, std::ios::binary | std::ios::trunc);
+	BinaryWriter headerWriter;
+	WriteFileHeader(headerWriter, PACK_FILE_MAGIC, FILE_VERSION);
+	bool success = WriteToStream(tempStream, headerWriter.GetData());
+
+	uint64_t offset = FILE_HEADER_SIZE;
+
+	for (auto &[key, entry] : entries)
+	{
+		if (!success)
+		{
+			break;
+		}
+
+		tempStream.write(
+			reinterpret_cast<const char *>(m_mappedPackFile->GetData() + entry.offset), entry.size);
+		success = static_cast<bool>(tempStream);
+
+		entry.offset = offset;
+		offset += entry.size;
+	}
+
+	tempStream.close();
+
+	// The pack file can't be replaced while it's open or mapped.
+	m_packFileStream.close();
+	m_mappedPackFile.reset();
+
+	std::error_code errorCode;
+
+	if (success)
+	{
+		std::filesystem::rename(tempFilePath, m_packFilePath, errorCode);
+	}
+
+	if (!success || errorCode)
+	{
+		std::filesystem::remove(tempFilePath, errorCode);
+		ResetPackFile();
+		OpenPackFileForWriting();
+		return;
+	}
+
+	m_entries.clear();
+	m_latestEntries.clear();
+	m_liveBytes = 0;
+
+	for (const auto &[key, entry] : entries)
+	{
+		AddEntry(key, entry);
+	}
+
+	m_packFileSize = offset;
+	m_mappedPackFile = MappedFile::Open(m_packFilePath);
+	OpenPackFileForWriting();
+
+	SaveIndexInternal();
+}
+
+bool ThumbnailDiskCache::SaveIndex()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return SaveIndexInternal();
+}
+
+bool ThumbnailDiskCache::SaveIndexInternal()
+{
+	BinaryWriter writer;
+	WriteFileHeader(writer, INDEX_FILE_MAGIC, FILE_VERSION);
+	writer.WriteUint64(m_packFileSize);
+	writer.WriteUint64(m_useCounter);
+	writer.WriteUint64(m_entries.size());
+
+	for (const auto &[key, entry] : m_entries)
+	{
+		writer.WriteKey(key);
+		writer.WriteUint64(entry.offset);
+		writer.WriteUint64(entry.lastUsed);
+	}
+
+	std::ofstream stream(m_indexFilePath, std::ios::binary | std::ios::trunc);
+	return WriteToStream(stream, writer.GetData());
+}
+
+size_t ThumbnailDiskCache::GetNumEntries() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_entries.size();
+}
+
+uint64_t ThumbnailDiskCache::GetPackFileSize() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_packFileSize;
+}
+
+uint64_t ThumbnailDiskCache::GetWastedBytes() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return GetWastedBytesInternal();
+}
+
+uint64_t ThumbnailDiskCache::GetWastedBytesInternal() const
+{
+	if (m_packFileSize < FILE_HEADER_SIZE)
+	{
+		return 0;
+	}
+
+	return m_packFileSize - FILE_HEADER_SIZE - m_liveBytes;
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "MappedFile.h"
+#include "../ThirdParty/CTPL/cpl_stl.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Identifies a thumbnail. If the file is modified, its size and/or last write
+// time will change, so a thumbnail for the previous version will never be
+// returned.
+struct ThumbnailKey
+{
+	uint64_t pathHash;
+	uint64_t fileSize;
+	uint64_t lastWriteTime;
+
+	// The size of the thumbnail that was requested. The image itself may be
+	// smaller than this (e.g. if the aspect ratio has been preserved).
+	uint32_t width;
+	uint32_t height;
+
+	bool operator==(const ThumbnailKey &other) const;
+};
+
+// A 32-bit image, stored top-down, with no padding between rows.
+struct ThumbnailImage
+{
+	uint32_t width;
+	uint32_t height;
+	std::vector<uint8_t> pixels;
+};
+
+// Stores thumbnails on disk, so that they don't have to be extracted again
+// each time a folder is opened.
+//
+// Thumbnails are appended to a pack file, which is memory-mapped for reading.
+// The pack file is self-describing, so the index (which maps each key to its
+// position in the pack file and records when it was last used) is only an
+// optimization. If the index is missing, or doesn't match the pack file (e.g.
+// because the application exited without saving it), it's rebuilt by
+// scanning the pack file.
+//
+// Once the pack file exceeds its maximum size, or too much of it is taken up
+// by thumbnails that have been replaced, it's compacted in the background. The
+// least recently used thumbnails are discarded during compaction.
+//
+// This class can be used from multiple threads.
+class ThumbnailDiskCache
+{
+public:
+	ThumbnailDiskCache(const std::filesystem::path &packFilePath,
+		const std::filesystem::path &indexFilePath, uint64_t maxSize);
+	~ThumbnailDiskCache();
+
+	std::optional<ThumbnailImage> Find(const ThumbnailKey &key);
+	bool Add(const ThumbnailKey &key, const ThumbnailImage &image);
+
+	// Compacts the pack file immediately, on the calling thread. This
+	// normally happens automatically.
+	void Compact();
+
+	bool SaveIndex();
+
+	size_t GetNumEntries() const;
+	uint64_t GetPackFileSize() const;
+
+	// The number of bytes in the pack file that are used by thumbnails that
+	// have since been replaced or evicted.
+	uint64_t GetWastedBytes() const;
+
+private:
+	static constexpr uint32_t PACK_FILE_MAGIC = 0x4B415054;
+	static constexpr uint32_t INDEX_FILE_MAGIC = 0x58444954;
+	static constexpr uint32_t FILE_VERSION = 1;
+
+	static constexpr size_t FILE_HEADER_SIZE = 8;
+	static constexpr size_t RECORD_HEADER_SIZE = 44;
+
+	// Compaction will reduce the pack file to this proportion of the maximum
+	// size, so that it's not immediately needed again.
+	static constexpr uint64_t COMPACTION_TARGET_PERCENTAGE = 75;
+
+	// Wasted space is only reclaimed once it makes up at least this
+	// proportion of the pack file.
+	static constexpr uint64_t WASTED_SPACE_COMPACTION_PERCENTAGE = 50;
+	static constexpr uint64_t MIN_WASTED_SPACE_COMPACTION_SIZE = 1024 * 1024;
+
+	struct KeyHash
+	{
+		size_t operator()(const ThumbnailKey &key) const;
+	};
+
+	// Only the most recent thumbnail for each path and size is retained. This
+	// is used to find the thumbnail that a new thumbnail replaces.
+	struct PathKey
+	{
+		uint64_t pathHash;
+		uint32_t width;
+		uint32_t height;
+
+		bool operator==(const PathKey &other) const;
+	};
+
+	struct PathKeyHash
+	{
+		size_t operator()(const PathKey &pathKey) const;
+	};
+
+	struct Entry
+	{
+		uint64_t offset;
+		uint64_t size;
+		uint64_t lastUsed;
+	};
+
+	ThumbnailDiskCache(const ThumbnailDiskCache &) = delete;
+	ThumbnailDiskCache &operator=(const ThumbnailDiskCache &) = delete;
+
+	static PathKey GetPathKey(const ThumbnailKey &key);
+
+	void Initialize();
+	bool LoadIndex();
+	bool RebuildIndex();
+	void ResetPackFile();
+	bool OpenPackFileForWriting();
+	bool EnsureMapped(uint64_t end);
+	void AddEntry(const ThumbnailKey &key, const Entry &entry);
+	void RemoveEntry(std::unordered_map<ThumbnailKey, Entry, KeyHash>::iterator itr);
+	bool NeedsCompaction() const;
+	uint64_t GetWastedBytesInternal() const;
+	void CompactInternal();
+	bool SaveIndexInternal();
+
+	const std::filesystem::path m_packFilePath;
+	const std::filesystem::path m_indexFilePath;
+	const uint64_t m_maxSize;
+
+	mutable std::mutex m_mutex;
+	std::unordered_map<ThumbnailKey, Entry, KeyHash> m_entries;
+	std::unordered_map<PathKey, ThumbnailKey, PathKeyHash> m_latestEntries;
+	uint64_t m_packFileSize;
+	uint64_t m_liveBytes;
+	uint64_t m_useCounter;
+
+	std::unique_ptr<MappedFile> m_mappedPackFile;
+	std::ofstream m_packFileStream;
+
+	std::atomic<bool> m_compactionQueued;
+
+	// This is declared last, so that any queued compaction finishes before
+	// the rest of the object is destroyed.
+	ctpl::thread_pool m_compactionThreadPool;
+};
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include "stdafx.h"
 #include "TimeHelper.h"
+#include <boost/date_time/gregorian/gregorian.hpp>
 
 
 BOOL LocalSystemTimeToFileTime(const SYSTEMTIME *lpLocalTime, FILETIME *lpFileTime)
@@ -45,4 +46,33 @@ void MergeDateTime(SYSTEMTIME *pstOutput, const SYSTEMTIME *pstDate, const SYSTE
 	pstOutput->wMinute = pstTime->wMinute;
 	pstOutput->wSecond = pstTime->wSecond;
 	pstOutput->wMilliseconds = pstTime->wMilliseconds;
+}
+
+uint64_t FileTimeToTimestamp(const FILETIME &fileTime)
+{
+	ULARGE_INTEGER timestamp;
+	timestamp.LowPart = fileTime.dwLowDateTime;
+	timestamp.HighPart = fileTime.dwHighDateTime;
+	return timestamp.QuadPart;
+}
+
+DateBucketer CreateDateBucketerForCurrentDay()
+{
+	return DateBucketer(boost::gregorian::day_clock::local_day(),
+		[](const boost::gregorian::date &localDate) -> uint64_t {
+			SYSTEMTIME localSystemTime = {};
+			localSystemTime.wYear = localDate.year();
+			localSystemTime.wMonth = localDate.month();
+			localSystemTime.wDay = localDate.day();
+
+			FILETIME fileTime;
+			BOOL res = LocalSystemTimeToFileTime(&localSystemTime, &fileTime);
+
+			if (!res)
+			{
+				return 0;
+			}
+
+			return FileTimeToTimestamp(fileTime);
+		});
 }
\ No newline at end of file
@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include "DateBucketer.h"
+
 BOOL LocalSystemTimeToFileTime(const SYSTEMTIME *lpLocalTime, FILETIME *lpFileTime);
 BOOL FileTimeToLocalSystemTime(const FILETIME *lpFileTime, SYSTEMTIME *lpLocalTime);
-void MergeDateTime(SYSTEMTIME *pstOutput, const SYSTEMTIME *pstDate, const SYSTEMTIME *pstTime);
\ No newline at end of file
+void MergeDateTime(SYSTEMTIME *pstOutput, const SYSTEMTIME *pstDate, const SYSTEMTIME *pstTime);
+uint64_t FileTimeToTimestamp(const FILETIME &fileTime);
+DateBucketer CreateDateBucketerForCurrentDay();
\ No newline at end of file
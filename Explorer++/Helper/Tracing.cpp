@@ -0,0 +1,309 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "Tracing.h"
+#include <array>
+#include <cstdio>
+
+std::atomic<TraceRecorder *> g_traceRecorder = nullptr;
+
+namespace
+{
+std::atomic<uint64_t> g_nextRecorderId = 1;
+std::atomic<uint32_t> g_nextThreadId = 1;
+
+// Thread IDs are only used to group events in the exported trace, so a
+// sequential ID is used, rather than anything platform-specific.
+uint32_t GetCurrentThreadTraceId()
+{
+	thread_local uint32_t threadId = g_nextThreadId.fetch_add(1);
+	return threadId;
+}
+
+void WriteJsonString(std::ostream &stream, const char *value)
+{
+	stream << '"';
+
+	for (const char *current = value; *current != '\0'; current++)
+	{
+		char c = *current;
+
+		switch (c)
+		{
+		case '"':
+			stream << "\\\"";
+			break;
+
+		case '\\':
+			stream << "\\\\";
+			break;
+
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				char escaped[7];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+				stream << escaped;
+			}
+			else
+			{
+				stream << c;
+			}
+			break;
+		}
+	}
+
+	stream << '"';
+}
+
+// Trace timestamps are in microseconds. They're written with a fixed number of
+// decimal places, so that the output doesn't depend on the stream's locale or
+// precision.
+void WriteMicroseconds(std::ostream &stream, int64_t nanoseconds)
+{
+	if (nanoseconds < 0)
+	{
+		stream << '-';
+		nanoseconds = -nanoseconds;
+	}
+
+	char fraction[4];
+	std::snprintf(fraction, sizeof(fraction), "%03d", static_cast<int>(nanoseconds % 1000));
+	stream << (nanoseconds / 1000) << '.' << fraction;
+}
+}
+
+struct TraceRecorder::Event
+{
+	const char *category;
+	const char *name;
+	const char *argName;
+	int64_t timestamp;
+	int64_t duration;
+	int64_t argValue;
+	char phase;
+};
+
+struct TraceRecorder::EventChunk
+{
+	std::array<Event, EVENTS_PER_CHUNK> events;
+};
+
+struct TraceRecorder::ThreadBuffer
+{
+	uint32_t threadId;
+
+	// Guards the list of chunks (though not their contents, which are
+	// published through numEvents) and the thread name.
+	mutable std::mutex mutex;
+	std::vector<std::unique_ptr<EventChunk>> chunks;
+	std::string threadName;
+
+	// The number of events that have been fully written. Only written by the
+	// owning thread.
+	std::atomic<size_t> numEvents = 0;
+
+	std::atomic<uint64_t> numDropped = 0;
+};
+
+TraceRecorder::TraceRecorder() :
+	m_id(g_nextRecorderId.fetch_add(1)),
+	m_startTime(Clock::now())
+{
+}
+
+void TraceRecorder::SetEnabled(bool enabled)
+{
+	m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool TraceRecorder::IsEnabled() const
+{
+	return m_enabled.load(std::memory_order_relaxed);
+}
+
+void TraceRecorder::AddCompleteEvent(const char *category, const char *name,
+	Clock::time_point startTime, Clock::time_point endTime, const char *argName,
+	int64_t argValue)
+{
+	int64_t timestamp = GetTimestamp(startTime);
+	AddEvent(
+		{ category, name, argName, timestamp, GetTimestamp(endTime) - timestamp, argValue, 'X' });
+}
+
+void TraceRecorder::AddCounterEvent(const char *category, const char *name, int64_t value)
+{
+	AddEvent({ category, name, "value", GetTimestamp(Clock::now()), 0, value, 'C' });
+}
+
+void TraceRecorder::AddInstantEvent(const char *category, const char *name)
+{
+	AddEvent({ category, name, nullptr, GetTimestamp(Clock::now()), 0, 0, 'i' });
+}
+
+void TraceRecorder::SetCurrentThreadName(const std::string &name)
+{
+	ThreadBuffer *buffer = GetThreadBuffer();
+
+	std::lock_guard<std::mutex> lock(buffer->mutex);
+	buffer->threadName = name;
+}
+
+void TraceRecorder::AddEvent(const Event &event)
+{
+	ThreadBuffer *buffer = GetThreadBuffer();
+	size_t numEvents = buffer->numEvents.load(std::memory_order_relaxed);
+	size_t chunkIndex = numEvents / EVENTS_PER_CHUNK;
+
+	if (chunkIndex == buffer->chunks.size())
+	{
+		if (chunkIndex == MAX_CHUNKS_PER_THREAD)
+		{
+			buffer->numDropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		auto chunk = std::make_unique<EventChunk>();
+
+		std::lock_guard<std::mutex> lock(buffer->mutex);
+		buffer->chunks.push_back(std::move(chunk));
+	}
+
+	// The list of chunks is only ever modified by this thread, so it's safe to
+	// read it here without holding the lock.
+	buffer->chunks[chunkIndex]->events[numEvents % EVENTS_PER_CHUNK] = event;
+
+	// The release here pairs with the acquire in WriteChromeTrace(), so that the
+	// event is fully visible before it's exported.
+	buffer->numEvents.store(numEvents + 1, std::memory_order_release);
+}
+
+TraceRecorder::ThreadBuffer *TraceRecorder::GetThreadBuffer()
+{
+	// As with AsyncLogger, a thread will generally only trace to a single
+	// recorder, so only the buffer for the most recently used recorder is
+	// retained. Unlike a log buffer, a trace buffer is kept by the recorder
+	// after the thread exits, since its events are needed for the export.
+	struct CurrentThreadBuffer
+	{
+		uint64_t recorderId = 0;
+		std::shared_ptr<ThreadBuffer> buffer;
+	};
+
+	thread_local CurrentThreadBuffer currentThreadBuffer;
+
+	if (currentThreadBuffer.recorderId != m_id)
+	{
+		auto buffer = std::make_shared<ThreadBuffer>();
+		buffer->threadId = GetCurrentThreadTraceId();
+
+		{
+			std::lock_guard<std::mutex> lock(m_buffersMutex);
+			m_buffers.push_back(buffer);
+		}
+
+		currentThreadBuffer.recorderId = m_id;
+		currentThreadBuffer.buffer = buffer;
+	}
+
+	return currentThreadBuffer.buffer.get();
+}
+
+int64_t TraceRecorder::GetTimestamp(Clock::time_point timePoint) const
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(timePoint - m_startTime).count();
+}
+
+void TraceRecorder::WriteChromeTrace(std::ostream &stream, uint32_t processId) const
+{
+	std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+	{
+		std::lock_guard<std::mutex> lock(m_buffersMutex);
+		buffers = m_buffers;
+	}
+
+	stream << "{\"traceEvents\":[";
+
+	bool first = true;
+
+	for (const auto &buffer : buffers)
+	{
+		std::lock_guard<std::mutex> lock(buffer->mutex);
+
+		if (!buffer->threadName.empty())
+		{
+			stream << (first ? "\n" : ",\n");
+			first = false;
+
+			stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << processId
+				   << ",\"tid\":" << buffer->threadId << ",\"args\":{\"name\":";
+			WriteJsonString(stream, buffer->threadName.c_str());
+			stream << "}}";
+		}
+
+		size_t numEvents = buffer->numEvents.load(std::memory_order_acquire);
+
+		for (size_t i = 0; i < numEvents; i++)
+		{
+			stream << (first ? "\n" : ",\n");
+			first = false;
+
+			const Event &event = buffer->chunks[i / EVENTS_PER_CHUNK]->events[i % EVENTS_PER_CHUNK];
+			WriteEvent(stream, event, processId, buffer->threadId);
+		}
+	}
+
+	stream << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":"
+		   << GetStats().numDropped << "}}\n";
+}
+
+void TraceRecorder::WriteEvent(
+	std::ostream &stream, const Event &event, uint32_t processId, uint32_t threadId)
+{
+	stream << "{\"name\":";
+	WriteJsonString(stream, event.name);
+	stream << ",\"cat\":";
+	WriteJsonString(stream, event.category);
+	stream << ",\"ph\":\"" << event.phase << "\",\"ts\":";
+	WriteMicroseconds(stream, event.timestamp);
+
+	if (event.phase == 'X')
+	{
+		stream << ",\"dur\":";
+		WriteMicroseconds(stream, event.duration);
+	}
+	else if (event.phase == 'i')
+	{
+		// Instant events are scoped to the thread they occurred on.
+		stream << ",\"s\":\"t\"";
+	}
+
+	stream << ",\"pid\":" << processId << ",\"tid\":" << threadId;
+
+	if (event.argName)
+	{
+		stream << ",\"args\":{";
+		WriteJsonString(stream, event.argName);
+		stream << ":" << event.argValue << "}";
+	}
+
+	stream << "}";
+}
+
+TraceRecorder::Stats TraceRecorder::GetStats() const
+{
+	Stats stats;
+
+	std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+	for (const auto &buffer : m_buffers)
+	{
+		stats.numRecorded += buffer->numEvents.load(std::memory_order_relaxed);
+		stats.numDropped += buffer->numDropped.load(std::memory_order_relaxed);
+	}
+
+	return stats;
+}
\ No newline at end of file
@@ -0,0 +1,192 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Records trace events (timed spans and counters), which can then be exported
+// in the Chrome trace event format and viewed in chrome://tracing or Perfetto.
+//
+// Each thread records events into its own buffer. Adding an event only
+// involves writing to that buffer, with a lock being taken once every
+// EVENTS_PER_CHUNK events, when a new chunk is allocated. Once a thread's
+// buffer is full, any further events from that thread are dropped and counted.
+//
+// Event categories, names and argument names are stored as pointers, so they
+// should be string literals.
+class TraceRecorder
+{
+private:
+	struct Event;
+	struct EventChunk;
+	struct ThreadBuffer;
+
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Stats
+	{
+		uint64_t numRecorded = 0;
+		uint64_t numDropped = 0;
+	};
+
+	static constexpr size_t EVENTS_PER_CHUNK = 1024;
+	static constexpr size_t MAX_CHUNKS_PER_THREAD = 256;
+
+	TraceRecorder();
+
+	// Events are only recorded while the recorder is enabled. Disabling the
+	// recorder retains the events that have already been recorded.
+	void SetEnabled(bool enabled);
+	bool IsEnabled() const;
+
+	void AddCompleteEvent(const char *category, const char *name, Clock::time_point startTime,
+		Clock::time_point endTime, const char *argName = nullptr, int64_t argValue = 0);
+	void AddCounterEvent(const char *category, const char *name, int64_t value);
+	void AddInstantEvent(const char *category, const char *name);
+
+	// The name is shown for the current thread in the exported trace.
+	void SetCurrentThreadName(const std::string &name);
+
+	// Writes every event recorded so far as a JSON object. Can be called while
+	// events are still being recorded on other threads.
+	void WriteChromeTrace(std::ostream &stream, uint32_t processId) const;
+
+	Stats GetStats() const;
+
+private:
+	TraceRecorder(const TraceRecorder &) = delete;
+	TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+	static void WriteEvent(
+		std::ostream &stream, const Event &event, uint32_t processId, uint32_t threadId);
+
+	ThreadBuffer *GetThreadBuffer();
+	void AddEvent(const Event &event);
+	int64_t GetTimestamp(Clock::time_point timePoint) const;
+
+	const uint64_t m_id;
+	const Clock::time_point m_startTime;
+	std::atomic<bool> m_enabled = false;
+
+	mutable std::mutex m_buffersMutex;
+	std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+};
+
+// The recorder that the TRACE_ macros below add events to. Events are
+// discarded while this is null.
+extern std::atomic<TraceRecorder *> g_traceRecorder;
+
+// Returns the recorder that events should be added to, or null if tracing is
+// disabled. When tracing is disabled, this is the only work done by each of
+// the TRACE_ macros.
+inline TraceRecorder *GetActiveTraceRecorder()
+{
+	TraceRecorder *recorder = g_traceRecorder.load(std::memory_order_acquire);
+
+	if (!recorder || !recorder->IsEnabled())
+	{
+		return nullptr;
+	}
+
+	return recorder;
+}
+
+// Returns the current time if tracing is enabled and a default-constructed time
+// point otherwise. Intended to be captured when a task is queued, so that the
+// time the task spent waiting can be traced with TRACE_ELAPSED().
+inline TraceRecorder::Clock::time_point GetTraceTimestamp()
+{
+	if (!GetActiveTraceRecorder())
+	{
+		return {};
+	}
+
+	return TraceRecorder::Clock::now();
+}
+
+// Records the time between its construction and destruction as a single
+// event.
+class TraceSpan
+{
+public:
+	TraceSpan(TraceRecorder *recorder, const char *category, const char *name,
+		const char *argName = nullptr, int64_t argValue = 0) :
+		m_recorder(recorder),
+		m_category(category),
+		m_name(name),
+		m_argName(argName),
+		m_argValue(argValue)
+	{
+		if (m_recorder)
+		{
+			m_startTime = TraceRecorder::Clock::now();
+		}
+	}
+
+	~TraceSpan()
+	{
+		if (m_recorder)
+		{
+			m_recorder->AddCompleteEvent(m_category, m_name, m_startTime,
+				TraceRecorder::Clock::now(), m_argName, m_argValue);
+		}
+	}
+
+private:
+	TraceSpan(const TraceSpan &) = delete;
+	TraceSpan &operator=(const TraceSpan &) = delete;
+
+	TraceRecorder *const m_recorder;
+	const char *const m_category;
+	const char *const m_name;
+	const char *const m_argName;
+	const int64_t m_argValue;
+	TraceRecorder::Clock::time_point m_startTime;
+};
+
+#define TRACE_CONCATENATE_INNER(a, b) a##b
+#define TRACE_CONCATENATE(a, b) TRACE_CONCATENATE_INNER(a, b)
+
+// Traces the remainder of the enclosing scope.
+#define TRACE_EVENT(category, name)                                                                \
+	TraceSpan TRACE_CONCATENATE(traceSpan, __LINE__)(GetActiveTraceRecorder(), (category), (name))
+
+// Traces the remainder of the enclosing scope, along with a single numeric
+// argument.
+#define TRACE_EVENT1(category, name, argName, argValue)                                    \
+	TraceSpan TRACE_CONCATENATE(traceSpan, __LINE__)(GetActiveTraceRecorder(), (category), \
+		(name), (argName), static_cast<int64_t>(argValue))
+
+#define TRACE_COUNTER(category, name, value)                                                 \
+	do                                                                                       \
+	{                                                                                        \
+		if (TraceRecorder *traceRecorder = GetActiveTraceRecorder())                         \
+		{                                                                                    \
+			traceRecorder->AddCounterEvent((category), (name), static_cast<int64_t>(value)); \
+		}                                                                                    \
+	} while (false)
+
+// Traces the time from startTime (as returned by GetTraceTimestamp()) until
+// now. Nothing is recorded if tracing was disabled at startTime.
+#define TRACE_ELAPSED(category, name, startTime)                                \
+	do                                                                          \
+	{                                                                           \
+		TraceRecorder *traceRecorder = GetActiveTraceRecorder();                \
+                                                                                \
+		if (traceRecorder && (startTime) != TraceRecorder::Clock::time_point()) \
+		{                                                                       \
+			traceRecorder->AddCompleteEvent(                                    \
+				(category), (name), (startTime), TraceRecorder::Clock::now());  \
+		}                                                                       \
+	} while (false)
@@ -11,167 +11,24 @@
 #include "XMLSettings.h"
 #include "Helper.h"
 #include "Macros.h"
-#include <wil/com.h>
-#include <comdef.h>
+#include "XmlStream.h"
 
 static const TCHAR BOOL_YES[] = _T("yes");
 static const TCHAR BOOL_NO[] = _T("no");
 
-/* Helper function to create a DOM instance. */
-IXMLDOMDocument *NXMLSettings::DomFromCOM()
+void NXMLSettings::WriteStandardSetting(XmlStreamWriter &writer,
+	const TCHAR *szElementName,const TCHAR *szAttributeName,
+	const TCHAR *szAttributeValue)
 {
-	HRESULT					hr;
-	IXMLDOMDocument	*pxmldoc = nullptr;
-
-	hr = CoCreateInstance(__uuidof(DOMDocument30),nullptr,CLSCTX_INPROC_SERVER,
-		__uuidof(IXMLDOMDocument),reinterpret_cast<LPVOID *>(&pxmldoc));
-
-	if(SUCCEEDED(hr))
-	{
-		pxmldoc->put_async(VARIANT_FALSE);
-		pxmldoc->put_validateOnParse(VARIANT_FALSE);
-		pxmldoc->put_resolveExternals(VARIANT_FALSE);
-		pxmldoc->put_preserveWhiteSpace(VARIANT_TRUE);
-	}
-
-	return pxmldoc;
-}
-
-void NXMLSettings::WriteStandardSetting(IXMLDOMDocument *pXMLDom,
-	IXMLDOMElement *pGrandparentNode, const TCHAR *szElementName,
-	const TCHAR *szAttributeName, const TCHAR *szAttributeValue)
-{
-	IXMLDOMElement		*pParentNode = nullptr;
-	IXMLDOMAttribute	*pa = nullptr;
-	IXMLDOMAttribute	*pa1 = nullptr;
-	BSTR						bstr = nullptr;
-	BSTR						bstr_wsntt = SysAllocString(L"\n\t\t");
-	VARIANT						var;
-
-	bstr = SysAllocString(szElementName);
-	pXMLDom->createElement(bstr,&pParentNode);
-	SysFreeString(bstr);
-	bstr = nullptr;
-
-	NXMLSettings::AddWhiteSpaceToNode(pXMLDom,bstr_wsntt,pParentNode);
-
-	/* This will form an attribute of the form:
-	name="AttributeName" */
-	bstr = SysAllocString(L"name");
-
-	var = NXMLSettings::VariantString(szAttributeName);
-
-	pXMLDom->createAttribute(bstr,&pa);
-	pa->put_value(var);
-	pParentNode->setAttributeNode(pa,&pa1);
-	SysFreeString(bstr);
-	bstr = nullptr;
-
-	if (pa1)
-	{
-		pa1->Release();
-		pa1 = nullptr;
-	}
-
-	pa->Release();
-	pa = nullptr;
-	VariantClear(&var);
-
-	bstr = SysAllocString(szAttributeValue);
-	pParentNode->put_text(bstr);
-	SysFreeString(bstr);
-	bstr = nullptr;
-
-	SysFreeString(bstr_wsntt);
-	bstr_wsntt = nullptr;
-
-	NXMLSettings::AppendChildToParent(pParentNode,pGrandparentNode);
-
-	pParentNode->Release();
-	pParentNode = nullptr;
+	/* This will form an element of the form:
+	<ElementName name="AttributeName">AttributeValue</ElementName> */
+	StartNamedElement(writer,szElementName,szAttributeName);
+	writer.WriteText(szAttributeValue);
+	writer.EndElement();
 }
 
-VARIANT NXMLSettings::VariantString(const WCHAR *str)
-{
-	VARIANT	var;
-
-	VariantInit(&var);
-	V_BSTR(&var) = SysAllocString(str);
-	V_VT(&var) = VT_BSTR;
-
-	return var;
-}
-
-/* Helper function to append a whitespace text node to a
-specified element. */
-void NXMLSettings::AddWhiteSpaceToNode(IXMLDOMDocument* pDom,
-	BSTR bstrWs, IXMLDOMNode *pNode)
-{
-	IXMLDOMText	*pws = nullptr;
-	IXMLDOMNode	*pBuf = nullptr;
-
-	HRESULT hr = pDom->createTextNode(bstrWs,&pws);
-
-	if(FAILED(hr))
-	{
-		goto clean;
-	}
-
-	hr = pNode->appendChild(pws,&pBuf);
-
-	if(FAILED(hr))
-	{
-		goto clean;
-	}
-
-clean:
-	SafeRelease(&pws);
-	SafeRelease(&pBuf);
-}
-
-/* Helper function to append a child to a parent node. */
-void NXMLSettings::AppendChildToParent(IXMLDOMNode *pChild, IXMLDOMNode *pParent)
-{
-	IXMLDOMNode	*pNode = nullptr;
-	pParent->appendChild(pChild, &pNode);
-	SafeRelease(&pNode);
-}
-
-void NXMLSettings::AddAttributeToNode(IXMLDOMDocument *pXMLDom,
-IXMLDOMElement *pParentNode,const WCHAR *wszAttributeName,
-const WCHAR *wszAttributeValue)
-{
-	IXMLDOMAttribute	*pa = nullptr;
-	IXMLDOMAttribute	*pa1 = nullptr;
-	BSTR						bstr = nullptr;
-	VARIANT						var;
-
-	bstr = SysAllocString(wszAttributeName);
-
-	var = VariantString(wszAttributeValue);
-
-	pXMLDom->createAttribute(bstr,&pa);
-	pa->put_value(var);
-	pParentNode->setAttributeNode(pa,&pa1);
-
-	SysFreeString(bstr);
-	bstr = nullptr;
-
-	if(pa1)
-	{
-		pa1->Release();
-		pa1 = nullptr;
-	}
-
-	pa->Release();
-	pa = nullptr;
-
-	VariantClear(&var);
-}
-
-void NXMLSettings::AddStringListToNode(IXMLDOMDocument *pXMLDom,
-IXMLDOMElement *pParentNode,const TCHAR *szBaseKeyName,
-	const std::list<std::wstring> &strList)
+void NXMLSettings::AddStringListToNode(XmlStreamWriter &writer,
+	const TCHAR *szBaseKeyName,const std::list<std::wstring> &strList)
 {
 	TCHAR szNode[64];
 	int i = 0;
@@ -180,77 +37,18 @@ IXMLDOMElement *pParentNode,const TCHAR *szBaseKeyName,
 	{
 		StringCchPrintf(szNode,SIZEOF_ARRAY(szNode),_T("%s%d"),
 			szBaseKeyName,i++);
-		NXMLSettings::AddAttributeToNode(pXMLDom,pParentNode,
-			szNode,str.c_str());
+		writer.WriteAttribute(szNode,str);
 	}
 }
 
-void NXMLSettings::CreateElementNode(IXMLDOMDocument *pXMLDom,
-	IXMLDOMElement **pParentNode,
-	IXMLDOMElement *pGrandparentNode, const WCHAR *szElementName,
-	const WCHAR *szAttributeName)
+/* Starts an element that has a name attribute. Further
+attributes and children can then be written, before the
+caller ends the element. */
+void NXMLSettings::StartNamedElement(XmlStreamWriter &writer,
+	const WCHAR *szElementName,const WCHAR *szAttributeName)
 {
-	BSTR bstrElement = nullptr;
-	BSTR bstrName = nullptr;
-	VARIANT var;
-	bool varInitialized = false;
-	IXMLDOMAttribute *pa = nullptr;
-	IXMLDOMAttribute *pa1 = nullptr;
-	HRESULT hr;
-
-	bstrElement = SysAllocString(szElementName);
-
-	if(bstrElement == nullptr)
-	{
-		goto clean;
-	}
-
-	hr = pXMLDom->createElement(bstrElement, pParentNode);
-
-	if(FAILED(hr))
-	{
-		goto clean;
-	}
-
-	bstrName = SysAllocString(L"name");
-
-	if(bstrName == nullptr)
-	{
-		goto clean;
-	}
-
-	var = VariantString(szAttributeName);
-	varInitialized = true;
-
-	hr = pXMLDom->createAttribute(bstrName, &pa);
-
-	if(FAILED(hr))
-	{
-		goto clean;
-	}
-
-	hr = pa->put_value(var);
-
-	if(FAILED(hr))
-	{
-		goto clean;
-	}
-
-	hr = (*pParentNode)->setAttributeNode(pa, &pa1);
-
-	if(FAILED(hr))
-	{
-		goto clean;
-	}
-
-	AppendChildToParent(*pParentNode, pGrandparentNode);
-
-clean:
-	SafeBSTRRelease(bstrElement);
-	SafeBSTRRelease(bstrName);
-	if(varInitialized) { VariantClear(&var); }
-	SafeRelease(&pa);
-	SafeRelease(&pa1);
+	writer.StartElement(szElementName);
+	writer.WriteAttribute(L"name",szAttributeName);
 }
 
 const TCHAR	*NXMLSettings::EncodeBoolValue(BOOL value)
@@ -288,24 +86,11 @@ int NXMLSettings::DecodeIntValue(const WCHAR *wszValue)
 	return _wtoi(wszValue);
 }
 
-COLORREF NXMLSettings::ReadXMLColorData(IXMLDOMNode *pNode)
+COLORREF NXMLSettings::ReadXMLColorData(const XmlStreamReader &reader)
 {
-	IXMLDOMNode			*pChildNode = nullptr;
-	IXMLDOMNamedNodeMap	*am = nullptr;
-	BSTR						bstrName;
-	BSTR						bstrValue;
-	long						lChildNodes;
-	BYTE						r = 0;
-	BYTE						g = 0;
-	BYTE						b = 0;
-	long						i = 0;
-
-	pNode->get_attributes(&am);
-
-	am->get_length(&lChildNodes);
-
-	/* RGB data requires three attributes (R,G,B). */
-	/*if(lChildNodes != 3)*/
+	BYTE	r = 0;
+	BYTE	g = 0;
+	BYTE	b = 0;
 
 	/* Attribute name should be one of: r,g,b
 	Attribute value should be a value between
@@ -314,132 +99,71 @@ COLORREF NXMLSettings::ReadXMLColorData(IXMLDOMNode *pNode)
 	not need to be checked for, as each color
 	value is a byte, and can only hold values
 	between 0x00 and 0xFF. */
-	for(i = 1;i < lChildNodes;i++)
+	for(size_t i = 0;i < reader.GetNumAttributes();i++)
 	{
-		am->get_item(i,&pChildNode);
-
-		/* Element name. */
-		pChildNode->get_nodeName(&bstrName);
+		const std::wstring &name = reader.GetAttributeName(i);
+		const WCHAR *value = reader.GetAttributeValue(i).c_str();
 
-		/* Element value. */
-		pChildNode->get_text(&bstrValue);
-
-		if (lstrcmp(bstrName, L"r") == 0)
+		if (name == L"r")
 		{
-			r = (BYTE) NXMLSettings::DecodeIntValue(bstrValue);
+			r = (BYTE) NXMLSettings::DecodeIntValue(value);
 		}
-		else if (lstrcmp(bstrName, L"g") == 0)
+		else if (name == L"g")
 		{
-			g = (BYTE) NXMLSettings::DecodeIntValue(bstrValue);
+			g = (BYTE) NXMLSettings::DecodeIntValue(value);
 		}
-		else if (lstrcmp(bstrName, L"b") == 0)
+		else if (name == L"b")
 		{
-			b = (BYTE) NXMLSettings::DecodeIntValue(bstrValue);
+			b = (BYTE) NXMLSettings::DecodeIntValue(value);
 		}
 	}
 
 	return RGB(r,g,b);
 }
 
-Gdiplus::Color NXMLSettings::ReadXMLColorData2(IXMLDOMNode *pNode)
+Gdiplus::Color NXMLSettings::ReadXMLColorData2(const XmlStreamReader &reader)
 {
-	IXMLDOMNode			*pChildNode = nullptr;
-	IXMLDOMNamedNodeMap	*am = nullptr;
-	Gdiplus::Color				color;
-	BSTR						bstrName;
-	BSTR						bstrValue;
-	long						lChildNodes;
-	BYTE						r = 0;
-	BYTE						g = 0;
-	BYTE						b = 0;
-	long						i = 0;
-
-	pNode->get_attributes(&am);
+	COLORREF color = ReadXMLColorData(reader);
 
-	am->get_length(&lChildNodes);
-
-	/* RGB data requires three attributes (R,G,B). */
-	/*if(lChildNodes != 3)*/
-
-	/* Attribute name should be one of: r,g,b
-	Attribute value should be a value between 0x00 and 0xFF. */
-	for(i = 1;i < lChildNodes;i++)
-	{
-		am->get_item(i,&pChildNode);
-
-		/* Element name. */
-		pChildNode->get_nodeName(&bstrName);
-
-		/* Element value. */
-		pChildNode->get_text(&bstrValue);
-
-		if (lstrcmp(bstrName, L"r") == 0)
-		{
-			r = (BYTE) NXMLSettings::DecodeIntValue(bstrValue);
-		}
-		else if (lstrcmp(bstrName, L"g") == 0)
-		{
-			g = (BYTE) NXMLSettings::DecodeIntValue(bstrValue);
-		}
-		else if (lstrcmp(bstrName, L"b") == 0)
-		{
-			b = (BYTE) NXMLSettings::DecodeIntValue(bstrValue);
-		}
-	}
-
-	color = Gdiplus::Color(r,g,b);
-
-	return color;
+	return Gdiplus::Color(GetRValue(color),GetGValue(color),GetBValue(color));
 }
 
-HFONT NXMLSettings::ReadXMLFontData(IXMLDOMNode *pNode)
+HFONT NXMLSettings::ReadXMLFontData(const XmlStreamReader &reader)
 {
-	IXMLDOMNode			*pChildNode = nullptr;
-	IXMLDOMNamedNodeMap	*am = nullptr;
-	LOGFONT						fontInfo;
-	BSTR						bstrName;
-	BSTR						bstrValue;
-	long						lChildNodes;
-	long						i = 0;
-
-	pNode->get_attributes(&am);
-
-	am->get_length(&lChildNodes);
+	LOGFONT	fontInfo;
 
-	for(i = 1;i < lChildNodes;i++)
+	for(size_t i = 0;i < reader.GetNumAttributes();i++)
 	{
-		am->get_item(i,&pChildNode);
+		const std::wstring &name = reader.GetAttributeName(i);
+		const WCHAR *value = reader.GetAttributeValue(i).c_str();
 
-		pChildNode->get_nodeName(&bstrName);
-		pChildNode->get_text(&bstrValue);
-
-		if (lstrcmp(bstrName, L"Height") == 0)
+		if (name == L"Height")
 		{
-			fontInfo.lfHeight = NXMLSettings::DecodeIntValue(bstrValue);
+			fontInfo.lfHeight = NXMLSettings::DecodeIntValue(value);
 		}
-		else if (lstrcmp(bstrName, L"Width") == 0)
+		else if (name == L"Width")
 		{
-			fontInfo.lfWidth = NXMLSettings::DecodeIntValue(bstrValue);
+			fontInfo.lfWidth = NXMLSettings::DecodeIntValue(value);
 		}
-		else if (lstrcmp(bstrName, L"Weight") == 0)
+		else if (name == L"Weight")
 		{
-			fontInfo.lfWeight = NXMLSettings::DecodeIntValue(bstrValue);
+			fontInfo.lfWeight = NXMLSettings::DecodeIntValue(value);
 		}
-		else if (lstrcmp(bstrName, L"Italic") == 0)
+		else if (name == L"Italic")
 		{
-			fontInfo.lfItalic = (BYTE) NXMLSettings::DecodeBoolValue(bstrValue);
+			fontInfo.lfItalic = (BYTE) NXMLSettings::DecodeBoolValue(value);
 		}
-		else if (lstrcmp(bstrName, L"Underline") == 0)
+		else if (name == L"Underline")
 		{
-			fontInfo.lfUnderline = (BYTE) NXMLSettings::DecodeBoolValue(bstrValue);
+			fontInfo.lfUnderline = (BYTE) NXMLSettings::DecodeBoolValue(value);
 		}
-		else if (lstrcmp(bstrName, L"Strikeout") == 0)
+		else if (name == L"Strikeout")
 		{
-			fontInfo.lfStrikeOut = (BYTE) NXMLSettings::DecodeBoolValue(bstrValue);
+			fontInfo.lfStrikeOut = (BYTE) NXMLSettings::DecodeBoolValue(value);
 		}
-		else if (lstrcmp(bstrName, L"Font") == 0)
+		else if (name == L"Font")
 		{
-			StringCchCopy(fontInfo.lfFaceName, SIZEOF_ARRAY(fontInfo.lfFaceName), bstrValue);
+			StringCchCopy(fontInfo.lfFaceName, SIZEOF_ARRAY(fontInfo.lfFaceName), value);
 		}
 	}
 
@@ -455,15 +179,14 @@ HFONT NXMLSettings::ReadXMLFontData(IXMLDOMNode *pNode)
 	return CreateFontIndirect(&fontInfo);
 }
 
-bool NXMLSettings::ReadDateTime(IXMLDOMNamedNodeMap *attributeMap, const std::wstring &baseKeyName,
+bool NXMLSettings::ReadDateTime(const XmlStreamReader &reader, const std::wstring &baseKeyName,
 	FILETIME &dateTime)
 {
 	std::wstring lowDateTime;
 	std::wstring highDateTime;
-	HRESULT hr1 = GetStringFromMap(attributeMap, baseKeyName + L"Low", lowDateTime);
-	HRESULT hr2 = GetStringFromMap(attributeMap, baseKeyName + L"High", highDateTime);
 
-	if (FAILED(hr1) || FAILED(hr2))
+	if (!GetStringAttribute(reader, baseKeyName + L"Low", lowDateTime)
+		|| !GetStringAttribute(reader, baseKeyName + L"High", highDateTime))
 	{
 		return false;
 	}
@@ -474,56 +197,39 @@ bool NXMLSettings::ReadDateTime(IXMLDOMNamedNodeMap *attributeMap, const std::ws
 	return true;
 }
 
-void NXMLSettings::SaveDateTime(IXMLDOMDocument *xmlDocument, IXMLDOMElement *parentNode,
-	const std::wstring &baseKeyName, const FILETIME &dateTime)
+void NXMLSettings::SaveDateTime(XmlStreamWriter &writer, const std::wstring &baseKeyName,
+	const FILETIME &dateTime)
 {
-	AddAttributeToNode(xmlDocument, parentNode, (baseKeyName + L"Low").c_str(), std::to_wstring(dateTime.dwLowDateTime).c_str());
-	AddAttributeToNode(xmlDocument, parentNode, (baseKeyName + L"High").c_str(), std::to_wstring(dateTime.dwHighDateTime).c_str());
+	writer.WriteAttribute(baseKeyName + L"Low", std::to_wstring(dateTime.dwLowDateTime));
+	writer.WriteAttribute(baseKeyName + L"High", std::to_wstring(dateTime.dwHighDateTime));
 }
 
-HRESULT NXMLSettings::GetIntFromMap(IXMLDOMNamedNodeMap *attributeMap, const std::wstring &name, int &outputValue)
+bool NXMLSettings::GetIntAttribute(const XmlStreamReader &reader, const std::wstring &name,
+	int &outputValue)
 {
 	std::wstring outputString;
-	HRESULT hr = GetStringFromMap(attributeMap, name, outputString);
 
-	if (FAILED(hr))
+	if (!GetStringAttribute(reader, name, outputString))
 	{
-		return hr;
+		return false;
 	}
 
 	outputValue = DecodeIntValue(outputString.c_str());
 
-	return hr;
+	return true;
 }
 
-HRESULT NXMLSettings::GetStringFromMap(IXMLDOMNamedNodeMap *attributeMap, const std::wstring &name, std::wstring &outputValue)
+bool NXMLSettings::GetStringAttribute(const XmlStreamReader &reader, const std::wstring &name,
+	std::wstring &outputValue)
 {
-	wil::com_ptr<IXMLDOMNode> node;
-	auto nodeName = wil::make_bstr(name.c_str());
-	HRESULT hr = attributeMap->getNamedItem(nodeName.get(), &node);
-
-	if (FAILED(hr))
-	{
-		return hr;
-	}
-
-	BSTR value;
-	hr = node->get_text(&value);
+	auto value = reader.FindAttribute(name);
 
-	if (FAILED(hr))
+	if (!value)
 	{
-		return hr;
+		return false;
 	}
 
-	outputValue = _bstr_t(value);
-
-	return hr;
-}
+	outputValue = *value;
 
-void NXMLSettings::SafeBSTRRelease(BSTR bstr)
-{
-	if(bstr != nullptr)
-	{
-		SysFreeString(bstr);
-	}
+	return true;
 }
\ No newline at end of file
@@ -5,36 +5,30 @@
 #pragma once
 
 #include <gdiplus.h>
-#include <objbase.h>
-#include <MsXml2.h>
+#include <list>
+#include <string>
+
+class XmlStreamReader;
+class XmlStreamWriter;
 
 namespace NXMLSettings
 {
-	IXMLDOMDocument	*DomFromCOM();
-	void	WriteStandardSetting(IXMLDOMDocument *pXMLDom,IXMLDOMElement *pGrandparentNode,
-		const TCHAR *szElementName,const TCHAR *szAttributeName,const TCHAR *szAttributeValue);
-	VARIANT VariantString(const WCHAR *str);
-	void	AddWhiteSpaceToNode(IXMLDOMDocument* pDom,BSTR bstrWs,IXMLDOMNode *pNode);
-	void	AppendChildToParent(IXMLDOMNode *pChild, IXMLDOMNode *pParent);
-	void	AddAttributeToNode(IXMLDOMDocument *pXMLDom,IXMLDOMElement *pParentNode,
-		const WCHAR *wszAttributeName,const WCHAR *wszAttributeValue);
-	void	AddStringListToNode(IXMLDOMDocument *pXMLDom,IXMLDOMElement *pParentNode,
-		const TCHAR *szBaseKeyName,const std::list<std::wstring> &strList);
-	void	CreateElementNode(IXMLDOMDocument *pXMLDom,IXMLDOMElement **pParentNode,
-		IXMLDOMElement *pGrandparentNode,const WCHAR *szElementName,const WCHAR *szAttributeName);
+	void	WriteStandardSetting(XmlStreamWriter &writer,const TCHAR *szElementName,
+		const TCHAR *szAttributeName,const TCHAR *szAttributeValue);
+	void	AddStringListToNode(XmlStreamWriter &writer,const TCHAR *szBaseKeyName,
+		const std::list<std::wstring> &strList);
+	void	StartNamedElement(XmlStreamWriter &writer,const WCHAR *szElementName,
+		const WCHAR *szAttributeName);
 	const TCHAR	*EncodeBoolValue(BOOL value);
 	BOOL	DecodeBoolValue(const TCHAR *value);
 	WCHAR	*EncodeIntValue(int iValue);
 	int		DecodeIntValue(const WCHAR *wszValue);
-	COLORREF	ReadXMLColorData(IXMLDOMNode *pNode);
-	Gdiplus::Color	ReadXMLColorData2(IXMLDOMNode *pNode);
-	HFONT	ReadXMLFontData(IXMLDOMNode *pNode);
-
-	bool	ReadDateTime(IXMLDOMNamedNodeMap *attributeMap, const std::wstring &baseKeyName, FILETIME &dateTime);
-	void	SaveDateTime(IXMLDOMDocument *xmlDocument, IXMLDOMElement *parentNode, const std::wstring &baseKeyName,
-		const FILETIME &dateTime);
-	HRESULT	GetIntFromMap(IXMLDOMNamedNodeMap *attributeMap, const std::wstring &name, int &outputValue);
-	HRESULT	GetStringFromMap(IXMLDOMNamedNodeMap *attributeMap, const std::wstring &name, std::wstring &outputValue);
+	COLORREF	ReadXMLColorData(const XmlStreamReader &reader);
+	Gdiplus::Color	ReadXMLColorData2(const XmlStreamReader &reader);
+	HFONT	ReadXMLFontData(const XmlStreamReader &reader);
 
-	void	SafeBSTRRelease(BSTR bstr);
+	bool	ReadDateTime(const XmlStreamReader &reader, const std::wstring &baseKeyName, FILETIME &dateTime);
+	void	SaveDateTime(XmlStreamWriter &writer, const std::wstring &baseKeyName, const FILETIME &dateTime);
+	bool	GetIntAttribute(const XmlStreamReader &reader, const std::wstring &name, int &outputValue);
+	bool	GetStringAttribute(const XmlStreamReader &reader, const std::wstring &name, std::wstring &outputValue);
 }
\ No newline at end of file
@@ -0,0 +1,1056 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "XmlStream.h"
+#include <cstdint>
+
+namespace
+{
+bool IsWhitespace(wchar_t c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool IsNameTerminator(wchar_t c)
+{
+	return IsWhitespace(c) || c == '/' || c == '>' || c == '=' || c == '<' || c == '?';
+}
+
+// wchar_t is 16 bits on Windows (so characters outside the BMP are stored
+// as surrogate pairs) and 32 bits elsewhere.
+void AppendCodePoint(uint32_t codePoint, std::wstring &output)
+{
+	if (sizeof(wchar_t) == 2 && codePoint >= 0x10000)
+	{
+		codePoint -= 0x10000;
+		output += static_cast<wchar_t>(0xD800 + (codePoint >> 10));
+		output += static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF));
+	}
+	else
+	{
+		output += static_cast<wchar_t>(codePoint);
+	}
+}
+
+std::optional<std::wstring> DecodeUtf8(const std::string &data, size_t offset)
+{
+	std::wstring output;
+	output.reserve(data.size() - offset);
+
+	size_t i = offset;
+
+	while (i < data.size())
+	{
+		auto byte = static_cast<uint8_t>(data[i]);
+
+		if (byte < 0x80)
+		{
+			output += static_cast<wchar_t>(byte);
+			i++;
+			continue;
+		}
+
+		size_t length;
+		uint32_t codePoint;
+
+		if ((byte & 0xE0) == 0xC0)
+		{
+			length = 2;
+			codePoint = byte & 0x1F;
+		}
+		else if ((byte & 0xF0) == 0xE0)
+		{
+			length = 3;
+			codePoint = byte & 0x0F;
+		}
+		else if ((byte & 0xF8) == 0xF0)
+		{
+			length = 4;
+			codePoint = byte & 0x07;
+		}
+		else
+		{
+			return std::nullopt;
+		}
+
+		if (i + length > data.size())
+		{
+			return std::nullopt;
+		}
+
+		for (size_t j = 1; j < length; j++)
+		{
+			auto continuationByte = static_cast<uint8_t>(data[i + j]);
+
+			if ((continuationByte & 0xC0) != 0x80)
+			{
+				return std::nullopt;
+			}
+
+			codePoint = (codePoint << 6) | (continuationByte & 0x3F);
+		}
+
+		AppendCodePoint(codePoint, output);
+		i += length;
+	}
+
+	return output;
+}
+
+std::optional<std::wstring> DecodeUtf16(const std::string &data, bool bigEndian)
+{
+	if (data.size() % 2 != 0)
+	{
+		return std::nullopt;
+	}
+
+	std::wstring output;
+	output.reserve(data.size() / 2);
+
+	auto readUnit = [&data, bigEndian](size_t index)
+	{
+		auto first = static_cast<uint8_t>(data[index]);
+		auto second = static_cast<uint8_t>(data[index + 1]);
+		return static_cast<uint32_t>(bigEndian ? (first << 8) | second : (second << 8) | first);
+	};
+
+	// Skips the byte order mark.
+	for (size_t i = 2; i < data.size(); i += 2)
+	{
+		uint32_t unit = readUnit(i);
+
+		if (unit >= 0xD800 && unit <= 0xDBFF)
+		{
+			if (i + 3 >= data.size())
+			{
+				return std::nullopt;
+			}
+
+			uint32_t lowUnit = readUnit(i + 2);
+
+			if (lowUnit < 0xDC00 || lowUnit > 0xDFFF)
+			{
+				return std::nullopt;
+			}
+
+			AppendCodePoint(0x10000 + ((unit - 0xD800) << 10) + (lowUnit - 0xDC00), output);
+			i += 2;
+		}
+		else
+		{
+			output += static_cast<wchar_t>(unit);
+		}
+	}
+
+	return output;
+}
+}
+
+std::optional<std::wstring> DecodeXmlDocument(const std::string &data)
+{
+	if (data.size() >= 2 && static_cast<uint8_t>(data[0]) == 0xFF
+		&& static_cast<uint8_t>(data[1]) == 0xFE)
+	{
+		return DecodeUtf16(data, false);
+	}
+	else if (data.size() >= 2 && static_cast<uint8_t>(data[0]) == 0xFE
+		&& static_cast<uint8_t>(data[1]) == 0xFF)
+	{
+		return DecodeUtf16(data, true);
+	}
+	else if (data.size() >= 3 && static_cast<uint8_t>(data[0]) == 0xEF
+		&& static_cast<uint8_t>(data[1]) == 0xBB && static_cast<uint8_t>(data[2]) == 0xBF)
+	{
+		return DecodeUtf8(data, 3);
+	}
+
+	return DecodeUtf8(data, 0);
+}
+
+std::string EncodeXmlDocument(std::wstring_view document)
+{
+	std::string output;
+	output.reserve(document.size());
+
+	for (size_t i = 0; i < document.size(); i++)
+	{
+		auto codePoint = static_cast<uint32_t>(document[i]);
+
+		if (sizeof(wchar_t) == 2 && codePoint >= 0xD800 && codePoint <= 0xDBFF
+			&& i + 1 < document.size())
+		{
+			auto lowUnit = static_cast<uint32_t>(document[i + 1]);
+
+			if (lowUnit >= 0xDC00 && lowUnit <= 0xDFFF)
+			{
+				codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowUnit - 0xDC00);
+				i++;
+			}
+		}
+
+		if (codePoint < 0x80)
+		{
+			output += static_cast<char>(codePoint);
+		}
+		else if (codePoint < 0x800)
+		{
+			output += static_cast<char>(0xC0 | (codePoint >> 6));
+			output += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else if (codePoint < 0x10000)
+		{
+			output += static_cast<char>(0xE0 | (codePoint >> 12));
+			output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			output += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else
+		{
+			output += static_cast<char>(0xF0 | (codePoint >> 18));
+			output += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+			output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			output += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+	}
+
+	return output;
+}
+
+XmlStreamReader::XmlStreamReader(std::wstring_view document) :
+	m_document(document),
+	m_position(0),
+	m_tokenOffset(0),
+	m_token(Token::None),
+	m_numAttributes(0),
+	m_depth(0),
+	m_pendingEndElement(false),
+	m_rootElementClosed(false)
+{
+}
+
+XmlStreamReader::Token XmlStreamReader::ReadNext()
+{
+	if (m_token == Token::Error || m_token == Token::EndDocument)
+	{
+		return m_token;
+	}
+
+	if (m_token == Token::EndElement)
+	{
+		m_depth--;
+
+		if (m_depth == 0)
+		{
+			m_rootElementClosed = true;
+		}
+	}
+
+	if (m_pendingEndElement)
+	{
+		m_pendingEndElement = false;
+		m_numAttributes = 0;
+		m_token = Token::EndElement;
+		return m_token;
+	}
+
+	m_numAttributes = 0;
+
+	while (m_position < m_document.size())
+	{
+		m_tokenOffset = m_position;
+
+		if (m_document[m_position] == '<')
+		{
+			Token token = ReadMarkup();
+
+			// Comments, processing instructions and declarations don't
+			// produce a token.
+			if (token != Token::EndDocument)
+			{
+				m_token = token;
+				return m_token;
+			}
+
+			continue;
+		}
+
+		Token token = ReadCharacterData();
+
+		if (token != Token::EndDocument)
+		{
+			m_token = token;
+			return m_token;
+		}
+	}
+
+	if (m_depth != 0 || !m_rootElementClosed)
+	{
+		return SetError();
+	}
+
+	m_token = Token::EndDocument;
+	return m_token;
+}
+
+// Returns EndDocument if the markup was skipped.
+XmlStreamReader::Token XmlStreamReader::ReadMarkup()
+{
+	if (StartsWith(L"<?"))
+	{
+		return SkipPast(L"?>") ? Token::EndDocument : SetError();
+	}
+	else if (StartsWith(L"<!--"))
+	{
+		return SkipPast(L"-->") ? Token::EndDocument : SetError();
+	}
+	else if (StartsWith(L"<![CDATA["))
+	{
+		if (m_depth == 0)
+		{
+			return SetError();
+		}
+
+		size_t start = m_position + 9;
+		size_t end = m_document.find(L"]]>", start);
+
+		if (end == std::wstring_view::npos)
+		{
+			return SetError();
+		}
+
+		m_text.assign(m_document.substr(start, end - start));
+		m_position = end + 3;
+		return Token::Text;
+	}
+	else if (StartsWith(L"<!"))
+	{
+		// A DOCTYPE declaration.
+		return SkipPast(L">") ? Token::EndDocument : SetError();
+	}
+	else if (StartsWith(L"</"))
+	{
+		return ReadEndElement();
+	}
+
+	return ReadStartElement();
+}
+
+XmlStreamReader::Token XmlStreamReader::ReadStartElement()
+{
+	if (m_rootElementClosed)
+	{
+		return SetError();
+	}
+
+	m_position++;
+
+	if (!ReadName(m_name))
+	{
+		return SetError();
+	}
+
+	while (true)
+	{
+		SkipWhitespace();
+
+		if (m_position >= m_document.size())
+		{
+			return SetError();
+		}
+
+		if (StartsWith(L"/>"))
+		{
+			m_position += 2;
+			m_pendingEndElement = true;
+			break;
+		}
+		else if (m_document[m_position] == '>')
+		{
+			m_position++;
+			break;
+		}
+
+		if (m_numAttributes == m_attributes.size())
+		{
+			m_attributes.emplace_back();
+		}
+
+		auto &attribute = m_attributes[m_numAttributes];
+
+		if (!ReadName(attribute.first))
+		{
+			return SetError();
+		}
+
+		SkipWhitespace();
+
+		if (m_position >= m_document.size() || m_document[m_position] != '=')
+		{
+			return SetError();
+		}
+
+		m_position++;
+		SkipWhitespace();
+
+		if (!ReadAttributeValue(attribute.second))
+		{
+			return SetError();
+		}
+
+		m_numAttributes++;
+	}
+
+	PushElement(m_name);
+
+	return Token::StartElement;
+}
+
+XmlStreamReader::Token XmlStreamReader::ReadEndElement()
+{
+	m_position += 2;
+
+	if (!ReadName(m_name))
+	{
+		return SetError();
+	}
+
+	SkipWhitespace();
+
+	if (m_position >= m_document.size() || m_document[m_position] != '>')
+	{
+		return SetError();
+	}
+
+	m_position++;
+
+	if (m_depth == 0 || m_openElements[m_depth - 1] != m_name)
+	{
+		return SetError();
+	}
+
+	return Token::EndElement;
+}
+
+// Returns EndDocument if the text consisted entirely of whitespace.
+XmlStreamReader::Token XmlStreamReader::ReadCharacterData()
+{
+	size_t end = m_document.find('<', m_position);
+
+	if (end == std::wstring_view::npos)
+	{
+		end = m_document.size();
+	}
+
+	std::wstring_view text = m_document.substr(m_position, end - m_position);
+	m_position = end;
+
+	bool whitespaceOnly = true;
+
+	for (wchar_t c : text)
+	{
+		if (!IsWhitespace(c))
+		{
+			whitespaceOnly = false;
+			break;
+		}
+	}
+
+	if (whitespaceOnly)
+	{
+		return Token::EndDocument;
+	}
+
+	if (m_depth == 0)
+	{
+		return SetError();
+	}
+
+	if (!DecodeText(text, false, m_text))
+	{
+		return SetError();
+	}
+
+	return Token::Text;
+}
+
+std::optional<std::wstring> XmlStreamReader::ReadElementText()
+{
+	if (m_token != Token::StartElement)
+	{
+		return std::nullopt;
+	}
+
+	int depth = m_depth;
+	std::wstring text;
+
+	// Whitespace-only text is skipped by ReadNext(), but should be included
+	// here.
+	while (true)
+	{
+		if (m_pendingEndElement)
+		{
+			ReadNext();
+		}
+		else
+		{
+			size_t start = m_position;
+			size_t end = m_document.find('<', m_position);
+
+			if (end != std::wstring_view::npos && end > start)
+			{
+				std::wstring decodedText;
+
+				if (!DecodeText(m_document.substr(start, end - start), false, decodedText))
+				{
+					SetError();
+					return std::nullopt;
+				}
+
+				text += decodedText;
+				m_position = end;
+			}
+
+			if (ReadNext() == Token::Text)
+			{
+				// Either CDATA, or text that follows a comment.
+				text += m_text;
+				continue;
+			}
+		}
+
+		if (m_token == Token::Error || m_token == Token::EndDocument)
+		{
+			return std::nullopt;
+		}
+
+		if (m_token == Token::EndElement && m_depth == depth)
+		{
+			return text;
+		}
+	}
+}
+
+bool XmlStreamReader::SkipElement()
+{
+	if (m_token != Token::StartElement)
+	{
+		return false;
+	}
+
+	int depth = m_depth;
+
+	while (true)
+	{
+		Token token = ReadNext();
+
+		if (token == Token::Error || token == Token::EndDocument)
+		{
+			return false;
+		}
+
+		if (token == Token::EndElement && m_depth == depth)
+		{
+			return true;
+		}
+	}
+}
+
+std::optional<std::wstring_view> XmlStreamReader::ReadElementMarkup()
+{
+	size_t start = m_tokenOffset;
+
+	if (!SkipElement())
+	{
+		return std::nullopt;
+	}
+
+	return m_document.substr(start, m_position - start);
+}
+
+bool XmlStreamReader::ReadChildElement(int parentDepth)
+{
+	while (true)
+	{
+		Token token = ReadNext();
+
+		if (token == Token::Error || token == Token::EndDocument
+			|| (token == Token::EndElement && m_depth == parentDepth))
+		{
+			return false;
+		}
+
+		if (token == Token::StartElement && m_depth == parentDepth + 1)
+		{
+			return true;
+		}
+	}
+}
+
+XmlStreamReader::Token XmlStreamReader::GetToken() const
+{
+	return m_token;
+}
+
+const std::wstring &XmlStreamReader::GetName() const
+{
+	return m_name;
+}
+
+const std::wstring &XmlStreamReader::GetText() const
+{
+	return m_text;
+}
+
+int XmlStreamReader::GetDepth() const
+{
+	return m_depth;
+}
+
+size_t XmlStreamReader::GetNumAttributes() const
+{
+	return m_numAttributes;
+}
+
+const std::wstring &XmlStreamReader::GetAttributeName(size_t index) const
+{
+	return m_attributes[index].first;
+}
+
+const std::wstring &XmlStreamReader::GetAttributeValue(size_t index) const
+{
+	return m_attributes[index].second;
+}
+
+std::optional<std::wstring_view> XmlStreamReader::FindAttribute(std::wstring_view name) const
+{
+	for (size_t i = 0; i < m_numAttributes; i++)
+	{
+		if (m_attributes[i].first == name)
+		{
+			return m_attributes[i].second;
+		}
+	}
+
+	return std::nullopt;
+}
+
+size_t XmlStreamReader::GetErrorOffset() const
+{
+	return m_position;
+}
+
+XmlStreamReader::Token XmlStreamReader::SetError()
+{
+	m_token = Token::Error;
+	m_numAttributes = 0;
+	return m_token;
+}
+
+bool XmlStreamReader::SkipPast(std::wstring_view terminator)
+{
+	size_t end = m_document.find(terminator, m_position);
+
+	if (end == std::wstring_view::npos)
+	{
+		return false;
+	}
+
+	m_position = end + terminator.size();
+	return true;
+}
+
+bool XmlStreamReader::ReadName(std::wstring &name)
+{
+	size_t start = m_position;
+
+	while (m_position < m_document.size() && !IsNameTerminator(m_document[m_position]))
+	{
+		m_position++;
+	}
+
+	if (m_position == start)
+	{
+		return false;
+	}
+
+	name.assign(m_document.substr(start, m_position - start));
+	return true;
+}
+
+bool XmlStreamReader::ReadAttributeValue(std::wstring &value)
+{
+	if (m_position >= m_document.size())
+	{
+		return false;
+	}
+
+	wchar_t quote = m_document[m_position];
+
+	if (quote != '"' && quote != '\'')
+	{
+		return false;
+	}
+
+	size_t start = m_position + 1;
+	size_t end = m_document.find(quote, start);
+
+	if (end == std::wstring_view::npos)
+	{
+		return false;
+	}
+
+	m_position = end + 1;
+
+	return DecodeText(m_document.substr(start, end - start), true, value);
+}
+
+void XmlStreamReader::SkipWhitespace()
+{
+	while (m_position < m_document.size() && IsWhitespace(m_document[m_position]))
+	{
+		m_position++;
+	}
+}
+
+bool XmlStreamReader::StartsWith(std::wstring_view text) const
+{
+	return m_document.compare(m_position, text.size(), text) == 0;
+}
+
+// Replaces entity and character references and normalizes line endings. In
+// attribute values, literal whitespace characters are also replaced with
+// spaces, as required by the XML specification.
+bool XmlStreamReader::DecodeText(std::wstring_view text, bool isAttributeValue, std::wstring &output)
+{
+	output.clear();
+
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		wchar_t c = text[i];
+
+		if (c == '<')
+		{
+			return false;
+		}
+		else if (c == '\r')
+		{
+			if (i + 1 < text.size() && text[i + 1] == '\n')
+			{
+				i++;
+			}
+
+			output += isAttributeValue ? ' ' : '\n';
+		}
+		else if (isAttributeValue && (c == '\n' || c == '\t'))
+		{
+			output += ' ';
+		}
+		else if (c == '&')
+		{
+			size_t end = text.find(';', i);
+
+			if (end == std::wstring_view::npos)
+			{
+				return false;
+			}
+
+			std::wstring_view entity = text.substr(i + 1, end - i - 1);
+
+			if (entity == L"lt")
+			{
+				output += '<';
+			}
+			else if (entity == L"gt")
+			{
+				output += '>';
+			}
+			else if (entity == L"amp")
+			{
+				output += '&';
+			}
+			else if (entity == L"quot")
+			{
+				output += '"';
+			}
+			else if (entity == L"apos")
+			{
+				output += '\'';
+			}
+			else if (entity.size() >= 2 && entity[0] == '#')
+			{
+				bool hex = entity[1] == 'x';
+				uint32_t codePoint = 0;
+
+				for (size_t j = hex ? 2 : 1; j < entity.size(); j++)
+				{
+					wchar_t digit = entity[j];
+					uint32_t value;
+
+					if (digit >= '0' && digit <= '9')
+					{
+						value = digit - '0';
+					}
+					else if (hex && digit >= 'a' && digit <= 'f')
+					{
+						value = digit - 'a' + 10;
+					}
+					else if (hex && digit >= 'A' && digit <= 'F')
+					{
+						value = digit - 'A' + 10;
+					}
+					else
+					{
+						return false;
+					}
+
+					codePoint = codePoint * (hex ? 16 : 10) + value;
+
+					if (codePoint > 0x10FFFF)
+					{
+						return false;
+					}
+				}
+
+				AppendCodePoint(codePoint, output);
+			}
+			else
+			{
+				return false;
+			}
+
+			i = end;
+		}
+		else
+		{
+			output += c;
+		}
+	}
+
+	return true;
+}
+
+void XmlStreamReader::PushElement(const std::wstring &name)
+{
+	if (static_cast<size_t>(m_depth) == m_openElements.size())
+	{
+		m_openElements.emplace_back();
+	}
+
+	m_openElements[m_depth].assign(name);
+	m_depth++;
+}
+
+XmlSections::XmlSections(std::wstring_view document)
+{
+	XmlStreamReader reader(document);
+
+	if (reader.ReadNext() != XmlStreamReader::Token::StartElement)
+	{
+		return;
+	}
+
+	while (reader.ReadChildElement(1))
+	{
+		std::wstring name = reader.GetName();
+		auto markup = reader.ReadElementMarkup();
+
+		if (!markup)
+		{
+			m_sections.clear();
+			return;
+		}
+
+		m_sections.emplace_back(std::move(name), *markup);
+	}
+
+	// The rest of the document still needs to be checked, so that a file
+	// that's been truncated isn't accepted.
+	if (reader.GetToken() == XmlStreamReader::Token::Error
+		|| reader.ReadNext() != XmlStreamReader::Token::EndDocument)
+	{
+		m_sections.clear();
+	}
+}
+
+std::optional<XmlStreamReader> XmlSections::OpenSection(std::wstring_view name) const
+{
+	for (const auto &[sectionName, markup] : m_sections)
+	{
+		if (sectionName == name)
+		{
+			XmlStreamReader reader(markup);
+			reader.ReadNext();
+			return reader;
+		}
+	}
+
+	return std::nullopt;
+}
+
+XmlStreamWriter::XmlStreamWriter() : m_startTagOpen(false)
+{
+}
+
+void XmlStreamWriter::WriteDeclaration()
+{
+	m_document += L"<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
+}
+
+void XmlStreamWriter::WriteComment(std::wstring_view comment)
+{
+	CloseStartTag();
+	StartLine(m_openElements.size());
+
+	m_document += L"<!--";
+	m_document += comment;
+	m_document += L"-->";
+
+	if (!m_openElements.empty())
+	{
+		m_openElements.back().hasChildElements = true;
+	}
+}
+
+void XmlStreamWriter::StartElement(std::wstring_view name)
+{
+	CloseStartTag();
+	StartLine(m_openElements.size());
+
+	if (!m_openElements.empty())
+	{
+		m_openElements.back().hasChildElements = true;
+	}
+
+	m_document += '<';
+	m_document += name;
+
+	m_openElements.push_back({ std::wstring(name), false });
+	m_startTagOpen = true;
+}
+
+void XmlStreamWriter::WriteAttribute(std::wstring_view name, std::wstring_view value)
+{
+	if (!m_startTagOpen)
+	{
+		return;
+	}
+
+	m_document += ' ';
+	m_document += name;
+	m_document += L"=\"";
+	WriteEscaped(value, true);
+	m_document += '"';
+}
+
+void XmlStreamWriter::WriteText(std::wstring_view text)
+{
+	CloseStartTag();
+	WriteEscaped(text, false);
+}
+
+void XmlStreamWriter::EndElement()
+{
+	if (m_openElements.empty())
+	{
+		return;
+	}
+
+	if (m_startTagOpen)
+	{
+		m_document += L"/>";
+		m_startTagOpen = false;
+		m_openElements.pop_back();
+		return;
+	}
+
+	OpenElement &element = m_openElements.back();
+
+	if (element.hasChildElements)
+	{
+		StartLine(m_openElements.size() - 1);
+	}
+
+	m_document += L"</";
+	m_document += element.name;
+	m_document += '>';
+
+	m_openElements.pop_back();
+}
+
+const std::wstring &XmlStreamWriter::GetDocument() const
+{
+	return m_document;
+}
+
+void XmlStreamWriter::CloseStartTag()
+{
+	if (m_startTagOpen)
+	{
+		m_document += '>';
+		m_startTagOpen = false;
+	}
+}
+
+void XmlStreamWriter::StartLine(size_t indent)
+{
+	if (!m_document.empty())
+	{
+		m_document += L"\r\n";
+	}
+
+	m_document.append(indent, '\t');
+}
+
+void XmlStreamWriter::WriteEscaped(std::wstring_view text, bool isAttributeValue)
+{
+	for (wchar_t c : text)
+	{
+		switch (c)
+		{
+		case '<':
+			m_document += L"&lt;";
+			break;
+
+		case '>':
+			m_document += L"&gt;";
+			break;
+
+		case '&':
+			m_document += L"&amp;";
+			break;
+
+		case '"':
+			if (isAttributeValue)
+			{
+				m_document += L"&quot;";
+			}
+			else
+			{
+				m_document += c;
+			}
+			break;
+
+		// Literal whitespace in an attribute value would be normalized to a
+		// space when the document is read back in.
+		case '\t':
+		case '\n':
+		case '\r':
+			if (isAttributeValue || c == '\r')
+			{
+				m_document += L"&#";
+				m_document += std::to_wstring(static_cast<int>(c));
+				m_document += ';';
+			}
+			else
+			{
+				m_document += c;
+			}
+			break;
+
+		default:
+			m_document += c;
+			break;
+		}
+	}
+}
\ No newline at end of file
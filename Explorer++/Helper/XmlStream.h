@@ -0,0 +1,193 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Converts the raw contents of an XML file to text. UTF-8 and UTF-16 (with a
+// byte order mark) are supported. Returns nothing if the data isn't valid.
+std::optional<std::wstring> DecodeXmlDocument(const std::string &data);
+
+// Encodes the document as UTF-8.
+std::string EncodeXmlDocument(std::wstring_view document);
+
+// A forward-only XML reader. Unlike a DOM parser, no tree is built, so
+// reading a document only requires a single pass over the text, with very
+// few allocations. This is sufficient for the settings schema, which only
+// uses elements, attributes and text. The internal subset of a DTD isn't
+// supported.
+//
+// The reader refers to the document that's passed in, which must outlive it.
+// This class doesn't depend on any Windows APIs.
+class XmlStreamReader
+{
+public:
+	enum class Token
+	{
+		// ReadNext() hasn't been called yet.
+		None,
+
+		StartElement,
+		EndElement,
+		Text,
+		EndDocument,
+		Error
+	};
+
+	explicit XmlStreamReader(std::wstring_view document);
+
+	// Moves to the next element or piece of text. Text that consists
+	// entirely of whitespace is skipped. Self-closing elements produce both a
+	// StartElement and an EndElement token. Once Error or EndDocument has been
+	// returned, the same token will be returned from every subsequent call.
+	Token ReadNext();
+
+	Token GetToken() const;
+
+	// The name of the current element. Valid for StartElement and EndElement.
+	const std::wstring &GetName() const;
+
+	// The text of the current Text token.
+	const std::wstring &GetText() const;
+
+	// The depth of the current element, where the root element has a depth
+	// of 1. Text has the depth of the element that contains it.
+	int GetDepth() const;
+
+	// The attributes of the current StartElement.
+	size_t GetNumAttributes() const;
+	const std::wstring &GetAttributeName(size_t index) const;
+	const std::wstring &GetAttributeValue(size_t index) const;
+	std::optional<std::wstring_view> FindAttribute(std::wstring_view name) const;
+
+	// Should be called when positioned on a StartElement. Returns the text
+	// contained within the element (including any text within nested
+	// elements) and moves to the corresponding EndElement.
+	std::optional<std::wstring> ReadElementText();
+
+	// Should be called when positioned on a StartElement. Moves to the
+	// corresponding EndElement, skipping everything in between.
+	bool SkipElement();
+
+	// Should be called when positioned on a StartElement. Returns the markup
+	// of the element, from the start of its start tag to the end of its end
+	// tag, and moves to the corresponding EndElement.
+	std::optional<std::wstring_view> ReadElementMarkup();
+
+	// Moves to the next element that's a direct child of the element at the
+	// specified depth. Anything nested more deeply is skipped. Returns false
+	// once the end of the parent element has been reached, or if an error
+	// occurs, e.g.
+	//
+	// int depth = reader.GetDepth();
+	//
+	// while (reader.ReadChildElement(depth))
+	// {
+	// 	...
+	// }
+	bool ReadChildElement(int parentDepth);
+
+	// The offset into the document at which an error was encountered.
+	size_t GetErrorOffset() const;
+
+private:
+	Token SetError();
+	Token ReadMarkup();
+	Token ReadStartElement();
+	Token ReadEndElement();
+	Token ReadCharacterData();
+	bool SkipPast(std::wstring_view terminator);
+	bool ReadName(std::wstring &name);
+	bool ReadAttributeValue(std::wstring &value);
+	void SkipWhitespace();
+	bool StartsWith(std::wstring_view text) const;
+	bool DecodeText(std::wstring_view text, bool isAttributeValue, std::wstring &output);
+	void PushElement(const std::wstring &name);
+
+	const std::wstring_view m_document;
+	size_t m_position;
+	size_t m_tokenOffset;
+	Token m_token;
+	std::wstring m_name;
+	std::wstring m_text;
+
+	// Attribute strings are reused across elements, so that their buffers
+	// don't need to be reallocated each time. Only the first
+	// m_numAttributes entries are valid.
+	std::vector<std::pair<std::wstring, std::wstring>> m_attributes;
+	size_t m_numAttributes;
+
+	// The names of the open elements. As with the attributes, only the first
+	// m_depth entries are valid.
+	std::vector<std::wstring> m_openElements;
+	int m_depth;
+
+	bool m_pendingEndElement;
+	bool m_rootElementClosed;
+};
+
+// Splits a document into its sections (the children of the root element) in a
+// single pass. Each section can then be read independently, in any order,
+// without the rest of the document having to be read again. If the document
+// isn't well-formed, it won't have any sections, so that a partially valid
+// file isn't half loaded.
+//
+// As with XmlStreamReader, the document must outlive this object.
+class XmlSections
+{
+public:
+	XmlSections() = default;
+	explicit XmlSections(std::wstring_view document);
+
+	// Returns a reader positioned on the StartElement of the first section
+	// with the specified name, or nothing if there's no such section.
+	std::optional<XmlStreamReader> OpenSection(std::wstring_view name) const;
+
+private:
+	std::vector<std::pair<std::wstring, std::wstring_view>> m_sections;
+};
+
+// Writes an XML document in a single pass. Each element is written on a new
+// line and indented with tabs, except that text is written inline, e.g.
+//
+// <Settings>
+// 	<Setting name="ShowFolders">yes</Setting>
+// </Settings>
+class XmlStreamWriter
+{
+public:
+	XmlStreamWriter();
+
+	void WriteDeclaration();
+	void WriteComment(std::wstring_view comment);
+	void StartElement(std::wstring_view name);
+
+	// Must be called directly after StartElement() (or another call to
+	// WriteAttribute()).
+	void WriteAttribute(std::wstring_view name, std::wstring_view value);
+
+	void WriteText(std::wstring_view text);
+	void EndElement();
+
+	const std::wstring &GetDocument() const;
+
+private:
+	struct OpenElement
+	{
+		std::wstring name;
+		bool hasChildElements;
+	};
+
+	void CloseStartTag();
+	void StartLine(size_t indent);
+	void WriteEscaped(std::wstring_view text, bool isAttributeValue);
+
+	std::wstring m_document;
+	std::vector<OpenElement> m_openElements;
+	bool m_startTagOpen;
+};
\ No newline at end of file
@@ -0,0 +1,300 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+// Debug messages are excluded at compile time in this file, so that the
+// filtering performed by LOG() can be tested.
+#define LOG_MINIMUM_SEVERITY info
+
+#include "../Helper/AsyncLogger.h"
+#include "../Helper/Logging.h"
+#include <gtest/gtest.h>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+struct Point
+{
+	int x;
+	int y;
+};
+
+std::wostream &operator<<(std::wostream &stream, const Point &point)
+{
+	stream << L"(" << point.x << L", " << point.y << L")";
+	return stream;
+}
+}
+
+class AsyncLoggerTest : public Test
+{
+protected:
+	static constexpr int DROPPED_SEVERITY = 100;
+
+	AsyncLogger::Sink MakeSink()
+	{
+		return [this](const AsyncLogger::Entry &entry) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_entries.push_back(entry);
+		};
+	}
+
+	std::vector<AsyncLogger::Entry> GetEntries()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_entries;
+	}
+
+	std::mutex m_mutex;
+	std::vector<AsyncLogger::Entry> m_entries;
+};
+
+TEST_F(AsyncLoggerTest, Formatting)
+{
+	AsyncLogger logger(MakeSink(), DROPPED_SEVERITY);
+
+	std::wstring wideString = L"wide";
+	std::string narrowString = "narrow";
+	wchar_t buffer[16] = L"buffer";
+
+	AsyncLogger::Message(&logger, 1) << L"Values: " << 42 << L" " << -7L << L" " << 3000000000ULL
+									 << L" " << 1.5 << L" " << true << L" " << 'c' << L'w';
+	AsyncLogger::Message(&logger, 2) << wideString << L"|" << narrowString << L"|" << "literal"
+									 << L"|" << std::wstring_view(L"view") << L"|" << buffer;
+
+	logger.Flush();
+
+	auto entries = GetEntries();
+	ASSERT_EQ(entries.size(), 2U);
+	EXPECT_EQ(entries[0].severity, 1);
+	EXPECT_EQ(entries[0].message, L"Values: 42 -7 3000000000 1.5 1 cw");
+	EXPECT_EQ(entries[1].severity, 2);
+	EXPECT_EQ(entries[1].message, L"wide|narrow|literal|view|buffer");
+}
+
+TEST_F(AsyncLoggerTest, ArbitraryType)
+{
+	AsyncLogger logger(MakeSink(), DROPPED_SEVERITY);
+
+	// Types without a dedicated overload are formatted immediately, using their
+	// stream operator.
+	AsyncLogger::Message(&logger, 0) << L"Point: " << Point{ 1, 2 };
+
+	logger.Flush();
+
+	auto entries = GetEntries();
+	ASSERT_EQ(entries.size(), 1U);
+	EXPECT_EQ(entries[0].message, L"Point: (1, 2)");
+}
+
+TEST_F(AsyncLoggerTest, Truncation)
+{
+	AsyncLogger logger(MakeSink(), DROPPED_SEVERITY);
+
+	std::wstring longString(AsyncLogger::RECORD_DATA_SIZE, L'a');
+	AsyncLogger::Message(&logger, 0) << longString << L"ignored";
+
+	logger.Flush();
+
+	auto entries = GetEntries();
+	ASSERT_EQ(entries.size(), 1U);
+
+	const std::wstring &message = entries[0].message;
+	ASSERT_GT(message.size(), 3U);
+	EXPECT_LT(message.size(), longString.size());
+	EXPECT_EQ(message.substr(message.size() - 3), L"...");
+	EXPECT_EQ(message.substr(0, message.size() - 3), std::wstring(message.size() - 3, L'a'));
+}
+
+TEST_F(AsyncLoggerTest, OrderAcrossThreads)
+{
+	AsyncLogger logger(MakeSink(), DROPPED_SEVERITY);
+
+	constexpr int numThreads = 4;
+	constexpr int messagesPerThread = 50;
+
+	std::vector<std::thread> threads;
+
+	for (int i = 0; i < numThreads; i++)
+	{
+		threads.emplace_back([&logger, i] {
+			for (int j = 0; j < messagesPerThread; j++)
+			{
+				AsyncLogger::Message(&logger, 0) << i << L":" << j;
+			}
+		});
+	}
+
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+
+	logger.Flush();
+
+	auto entries = GetEntries();
+	ASSERT_EQ(entries.size(), static_cast<size_t>(numThreads * messagesPerThread));
+
+	// Messages from the same thread should be written in the order in which they
+	// were logged.
+	std::vector<int> nextMessage(numThreads, 0);
+
+	for (const auto &entry : entries)
+	{
+		size_t separator = entry.message.find(L':');
+		ASSERT_NE(separator, std::wstring::npos);
+
+		int thread = std::stoi(entry.message.substr(0, separator));
+		int message = std::stoi(entry.message.substr(separator + 1));
+		EXPECT_EQ(message, nextMessage[thread]);
+		nextMessage[thread] = message + 1;
+	}
+
+	EXPECT_EQ(logger.GetStats().numWritten, static_cast<uint64_t>(numThreads * messagesPerThread));
+	EXPECT_EQ(logger.GetStats().numDropped, 0U);
+}
+
+TEST_F(AsyncLoggerTest, DroppedMessages)
+{
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool sinkBlocked = false;
+	bool releaseSink = false;
+	std::vector<AsyncLogger::Entry> entries;
+
+	// The sink blocks on the first message, so that the buffer fills up.
+	AsyncLogger logger(
+		[&](const AsyncLogger::Entry &entry) {
+			std::unique_lock<std::mutex> lock(mutex);
+
+			if (!sinkBlocked)
+			{
+				sinkBlocked = true;
+				condition.notify_all();
+				condition.wait(lock, [&] { return releaseSink; });
+			}
+
+			entries.push_back(entry);
+		},
+		DROPPED_SEVERITY);
+
+	AsyncLogger::Message(&logger, 0) << L"First";
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [&] { return sinkBlocked; });
+	}
+
+	constexpr size_t numExtraMessages = 10;
+
+	for (size_t i = 0; i < AsyncLogger::RECORDS_PER_THREAD + numExtraMessages; i++)
+	{
+		AsyncLogger::Message(&logger, 0) << L"Message " << i;
+	}
+
+	EXPECT_EQ(logger.GetStats().numDropped, numExtraMessages);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		releaseSink = true;
+	}
+
+	condition.notify_all();
+	logger.Flush();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	ASSERT_EQ(entries.size(), AsyncLogger::RECORDS_PER_THREAD + 2);
+	EXPECT_EQ(entries[0].message, L"First");
+
+	// The number of dropped messages should be reported before the messages
+	// that were retained.
+	EXPECT_EQ(entries[1].severity, DROPPED_SEVERITY);
+	EXPECT_EQ(entries[1].message,
+		std::to_wstring(numExtraMessages)
+			+ L" log message(s) were dropped because the log buffer was full");
+	EXPECT_EQ(entries[2].message, L"Message 0");
+}
+
+TEST_F(AsyncLoggerTest, NestedMessage)
+{
+	AsyncLogger logger(MakeSink(), DROPPED_SEVERITY);
+
+	{
+		AsyncLogger::Message outer(&logger, 0);
+		outer << L"Outer";
+
+		// A message started while another is being built on the same thread is
+		// dropped, rather than corrupting the outer message.
+		AsyncLogger::Message(&logger, 0) << L"Inner";
+	}
+
+	logger.Flush();
+
+	auto entries = GetEntries();
+	ASSERT_EQ(entries.size(), 2U);
+	EXPECT_EQ(entries[0].severity, DROPPED_SEVERITY);
+	EXPECT_EQ(entries[1].message, L"Outer");
+}
+
+TEST_F(AsyncLoggerTest, Stop)
+{
+	AsyncLogger logger(MakeSink(), DROPPED_SEVERITY);
+
+	AsyncLogger::Message(&logger, 0) << L"Before";
+
+	// Messages pending when the logger is stopped should still be written.
+	logger.Stop();
+
+	AsyncLogger::Message(&logger, 0) << L"After";
+	logger.Flush();
+
+	auto entries = GetEntries();
+	ASSERT_EQ(entries.size(), 1U);
+	EXPECT_EQ(entries[0].message, L"Before");
+}
+
+TEST_F(AsyncLoggerTest, NullLogger)
+{
+	bool evaluated = false;
+	auto evaluate = [&evaluated] {
+		evaluated = true;
+		return 1;
+	};
+
+	// Messages logged without a logger are discarded (though their arguments are
+	// still evaluated).
+	AsyncLogger::Message(nullptr, 0) << L"Discarded " << evaluate();
+	EXPECT_TRUE(evaluated);
+}
+
+TEST_F(AsyncLoggerTest, CompileTimeFiltering)
+{
+	AsyncLogger logger(MakeSink(), DROPPED_SEVERITY);
+	g_logger.store(&logger);
+
+	bool debugEvaluated = false;
+	auto evaluateDebug = [&debugEvaluated] {
+		debugEvaluated = true;
+		return 1;
+	};
+
+	LOG(debug) << L"Excluded " << evaluateDebug();
+	LOG(info) << L"Included " << 2;
+
+	g_logger.store(nullptr);
+	logger.Flush();
+
+	EXPECT_FALSE(debugEvaluated);
+
+	auto entries = GetEntries();
+	ASSERT_EQ(entries.size(), 1U);
+	EXPECT_EQ(entries[0].severity, info);
+	EXPECT_EQ(entries[0].message, L"Included 2");
+}
\ No newline at end of file
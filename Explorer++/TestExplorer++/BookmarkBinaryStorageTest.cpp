@@ -0,0 +1,238 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "Bookmarks/BookmarkBinaryStorage.h"
+#include "BookmarkStorageHelper.h"
+#include "Bookmarks/BookmarkTree.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+
+using namespace testing;
+
+namespace
+{
+std::string SerializeTree(BookmarkTree *bookmarkTree)
+{
+	BookmarkBinaryStorage storage(bookmarkTree);
+	return storage.Serialize();
+}
+
+bool LoadTree(const std::string &data, BookmarkTree *bookmarkTree)
+{
+	BookmarkBinaryStorage storage(bookmarkTree);
+	return storage.Load(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+}
+
+void ExpectDatesEqual(const BookmarkItem *firstItem, const BookmarkItem *secondItem)
+{
+	FILETIME firstDateCreated = firstItem->GetDateCreated();
+	FILETIME secondDateCreated = secondItem->GetDateCreated();
+	EXPECT_EQ(CompareFileTime(&firstDateCreated, &secondDateCreated), 0);
+
+	FILETIME firstDateModified = firstItem->GetDateModified();
+	FILETIME secondDateModified = secondItem->GetDateModified();
+	EXPECT_EQ(CompareFileTime(&firstDateModified, &secondDateModified), 0);
+}
+}
+
+class BookmarkBinaryStorageTest : public Test
+{
+protected:
+	void SetUp() override
+	{
+		auto testInfo = UnitTest::GetInstance()->current_test_info();
+		m_directory = std::filesystem::temp_directory_path()
+			/ (std::string("BookmarkBinaryStorageTest_") + testInfo->name());
+		std::filesystem::remove_all(m_directory);
+		std::filesystem::create_directories(m_directory);
+
+		m_snapshotPath = m_directory / "Bookmarks.dat";
+	}
+
+	void TearDown() override
+	{
+		std::error_code errorCode;
+		std::filesystem::remove_all(m_directory, errorCode);
+	}
+
+	std::filesystem::path m_directory;
+	std::filesystem::path m_snapshotPath;
+};
+
+TEST_F(BookmarkBinaryStorageTest, RoundTrip)
+{
+	BookmarkTree referenceBookmarkTree;
+	BuildV2LoadSaveReferenceTree(&referenceBookmarkTree);
+
+	std::string data = SerializeTree(&referenceBookmarkTree);
+
+	BookmarkTree loadedBookmarkTree;
+	ASSERT_TRUE(LoadTree(data, &loadedBookmarkTree));
+
+	CompareBookmarkTrees(&loadedBookmarkTree, &referenceBookmarkTree, true);
+}
+
+TEST_F(BookmarkBinaryStorageTest, RoundTripDates)
+{
+	BookmarkTree referenceBookmarkTree;
+	BuildV2LoadSaveReferenceTree(&referenceBookmarkTree);
+
+	std::string data = SerializeTree(&referenceBookmarkTree);
+
+	BookmarkTree loadedBookmarkTree;
+	ASSERT_TRUE(LoadTree(data, &loadedBookmarkTree));
+
+	ExpectDatesEqual(loadedBookmarkTree.GetBookmarksMenuFolder(),
+		referenceBookmarkTree.GetBookmarksMenuFolder());
+
+	// The first item in the menu folder is a folder that contains another
+	// folder. The dates of each should be unaffected by the children being
+	// added to them when the snapshot is loaded.
+	const auto *loadedFolder = loadedBookmarkTree.GetBookmarksMenuFolder()->GetChildren()[0].get();
+	const auto *referenceFolder =
+		referenceBookmarkTree.GetBookmarksMenuFolder()->GetChildren()[0].get();
+	ExpectDatesEqual(loadedFolder, referenceFolder);
+	ExpectDatesEqual(loadedFolder->GetChildren()[0].get(), referenceFolder->GetChildren()[0].get());
+}
+
+TEST_F(BookmarkBinaryStorageTest, NonStandardGuid)
+{
+	BookmarkTree referenceBookmarkTree;
+	BuildV2LoadSaveReferenceTree(&referenceBookmarkTree);
+
+	// A GUID that was edited by hand in the config file won't necessarily be
+	// valid, but it should still be preserved.
+	auto bookmark = std::make_unique<BookmarkItem>(L"not-a-guid", L"Windows", L"C:\\Windows");
+	referenceBookmarkTree.AddBookmarkItem(
+		referenceBookmarkTree.GetOtherBookmarksFolder(), std::move(bookmark), 0);
+
+	// Lowercase GUIDs are also preserved as-is.
+	bookmark = std::make_unique<BookmarkItem>(
+		L"6e2d3c2a-4b1f-4d8e-9f5a-7c3b2a1d0e9f", L"Program Files", L"C:\\Program Files");
+	referenceBookmarkTree.AddBookmarkItem(
+		referenceBookmarkTree.GetOtherBookmarksFolder(), std::move(bookmark), 1);
+
+	std::string data = SerializeTree(&referenceBookmarkTree);
+
+	BookmarkTree loadedBookmarkTree;
+	ASSERT_TRUE(LoadTree(data, &loadedBookmarkTree));
+
+	CompareBookmarkTrees(&loadedBookmarkTree, &referenceBookmarkTree, true);
+	EXPECT_NE(loadedBookmarkTree.GetBookmarkItemById(L"not-a-guid"), nullptr);
+	EXPECT_NE(
+		loadedBookmarkTree.GetBookmarkItemById(L"6e2d3c2a-4b1f-4d8e-9f5a-7c3b2a1d0e9f"), nullptr);
+}
+
+TEST_F(BookmarkBinaryStorageTest, SaveAndLoadFile)
+{
+	BookmarkTree referenceBookmarkTree;
+	BuildV2LoadSaveReferenceTree(&referenceBookmarkTree);
+
+	BookmarkBinaryStorage referenceStorage(&referenceBookmarkTree);
+	ASSERT_TRUE(referenceStorage.Save(m_snapshotPath));
+
+	// The temporary file should have been renamed over the snapshot.
+	EXPECT_FALSE(std::filesystem::exists(m_directory / "Bookmarks.dat.tmp"));
+
+	BookmarkTree loadedBookmarkTree;
+	BookmarkBinaryStorage loadedStorage(&loadedBookmarkTree);
+	ASSERT_TRUE(loadedStorage.Load(m_snapshotPath));
+
+	CompareBookmarkTrees(&loadedBookmarkTree, &referenceBookmarkTree, true);
+}
+
+TEST_F(BookmarkBinaryStorageTest, IncrementalSave)
+{
+	BookmarkTree referenceBookmarkTree;
+	BuildV2LoadSaveReferenceTree(&referenceBookmarkTree);
+
+	BookmarkBinaryStorage referenceStorage(&referenceBookmarkTree);
+	std::string originalData = referenceStorage.Serialize();
+
+	BookmarkTree bookmarkTree;
+	BookmarkBinaryStorage storage(&bookmarkTree);
+	ASSERT_TRUE(storage.Load(
+		reinterpret_cast<const uint8_t *>(originalData.data()), originalData.size()));
+
+	// Nothing has changed since the snapshot was loaded, so it should be
+	// written back out unchanged.
+	EXPECT_EQ(storage.Serialize(), originalData);
+
+	// Make changes that only affect some of the permanent folders.
+	bookmarkTree.GetBookmarksToolbarFolder()->GetChildren()[0]->SetName(L"Local Disk");
+	bookmarkTree.MoveBookmarkItem(bookmarkTree.GetBookmarksMenuFolder()->GetChildren()[2].get(),
+		bookmarkTree.GetBookmarksMenuFolder()->GetChildren()[1].get(), 0);
+
+	referenceBookmarkTree.GetBookmarksToolbarFolder()->GetChildren()[0]->SetName(L"Local Disk");
+	referenceBookmarkTree.MoveBookmarkItem(
+		referenceBookmarkTree.GetBookmarksMenuFolder()->GetChildren()[2].get(),
+		referenceBookmarkTree.GetBookmarksMenuFolder()->GetChildren()[1].get(), 0);
+
+	std::string updatedData = storage.Serialize();
+	EXPECT_NE(updatedData, originalData);
+
+	BookmarkTree loadedBookmarkTree;
+	ASSERT_TRUE(LoadTree(updatedData, &loadedBookmarkTree));
+
+	CompareBookmarkTrees(&loadedBookmarkTree, &referenceBookmarkTree, true);
+}
+
+TEST_F(BookmarkBinaryStorageTest, IncrementalSaveAfterRemoval)
+{
+	BookmarkTree referenceBookmarkTree;
+	BuildV2LoadSaveReferenceTree(&referenceBookmarkTree);
+
+	std::string originalData = SerializeTree(&referenceBookmarkTree);
+
+	BookmarkTree bookmarkTree;
+	BookmarkBinaryStorage storage(&bookmarkTree);
+	ASSERT_TRUE(storage.Load(
+		reinterpret_cast<const uint8_t *>(originalData.data()), originalData.size()));
+
+	// Removing a nested item should cause the folder that contains it to be
+	// re-encoded.
+	auto *menuFolder = bookmarkTree.GetBookmarksMenuFolder()->GetChildren()[0].get();
+	bookmarkTree.RemoveBookmarkItem(menuFolder->GetChildren()[0].get());
+
+	auto *referenceMenuFolder =
+		referenceBookmarkTree.GetBookmarksMenuFolder()->GetChildren()[0].get();
+	referenceBookmarkTree.RemoveBookmarkItem(referenceMenuFolder->GetChildren()[0].get());
+
+	BookmarkTree loadedBookmarkTree;
+	ASSERT_TRUE(LoadTree(storage.Serialize(), &loadedBookmarkTree));
+
+	CompareBookmarkTrees(&loadedBookmarkTree, &referenceBookmarkTree, true);
+}
+
+TEST_F(BookmarkBinaryStorageTest, LoadMissingFile)
+{
+	BookmarkTree bookmarkTree;
+	BookmarkBinaryStorage storage(&bookmarkTree);
+	EXPECT_FALSE(storage.Load(m_snapshotPath));
+}
+
+TEST_F(BookmarkBinaryStorageTest, LoadInvalidData)
+{
+	BookmarkTree referenceBookmarkTree;
+	BuildV2LoadSaveReferenceTree(&referenceBookmarkTree);
+
+	std::string data = SerializeTree(&referenceBookmarkTree);
+
+	// Every truncated form of the snapshot should be rejected, without any
+	// items being added to the tree.
+	for (size_t size = 0; size < data.size(); size++)
+	{
+		BookmarkTree bookmarkTree;
+		EXPECT_FALSE(LoadTree(data.substr(0, size), &bookmarkTree)) << size;
+		EXPECT_TRUE(bookmarkTree.GetBookmarksToolbarFolder()->GetChildren().empty());
+		EXPECT_TRUE(bookmarkTree.GetBookmarksMenuFolder()->GetChildren().empty());
+		EXPECT_TRUE(bookmarkTree.GetOtherBookmarksFolder()->GetChildren().empty());
+	}
+
+	std::string invalidMagic = data;
+	invalidMagic[0] = 'Z';
+
+	BookmarkTree bookmarkTree;
+	EXPECT_FALSE(LoadTree(invalidMagic, &bookmarkTree));
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "Bookmarks/BookmarkSearchIndex.h"
+#include "Bookmarks/BookmarkTree.h"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace testing;
+
+class BookmarkSearchIndexTest : public Test
+{
+protected:
+	BookmarkSearchIndexTest() : m_searchIndex(&m_bookmarkTree)
+	{
+	}
+
+	std::vector<BookmarkItem *> Search(std::wstring_view query)
+	{
+		return m_searchIndex.Search(query, 10);
+	}
+
+	BookmarkTree m_bookmarkTree;
+	BookmarkSearchIndex m_searchIndex;
+};
+
+TEST_F(BookmarkSearchIndexTest, AddItems)
+{
+	auto folder = std::make_unique<BookmarkItem>(std::nullopt, L"Work", std::nullopt);
+	auto bookmark =
+		std::make_unique<BookmarkItem>(std::nullopt, L"Reports", L"C:\\Users\\Default\\Documents");
+	auto rawBookmark = bookmark.get();
+	folder->AddChild(std::move(bookmark));
+	auto rawFolder = m_bookmarkTree.AddBookmarkItem(
+		m_bookmarkTree.GetBookmarksToolbarFolder(), std::move(folder), 0);
+
+	EXPECT_THAT(Search(L"work"), ElementsAre(rawFolder));
+	EXPECT_THAT(Search(L"reports"), ElementsAre(rawBookmark));
+	EXPECT_THAT(Search(L"documents"), ElementsAre(rawBookmark));
+
+	// The permanent folders shouldn't be returned.
+	EXPECT_THAT(Search(L"bookmarks"), IsEmpty());
+}
+
+TEST_F(BookmarkSearchIndexTest, ExistingItems)
+{
+	auto rawBookmark = m_bookmarkTree.AddBookmarkItem(m_bookmarkTree.GetBookmarksMenuFolder(),
+		std::make_unique<BookmarkItem>(std::nullopt, L"Downloads", L"C:\\Downloads"), 0);
+
+	BookmarkSearchIndex searchIndex(&m_bookmarkTree);
+	EXPECT_THAT(searchIndex.Search(L"downloads", 10), ElementsAre(rawBookmark));
+}
+
+TEST_F(BookmarkSearchIndexTest, UpdateItem)
+{
+	auto rawBookmark = m_bookmarkTree.AddBookmarkItem(m_bookmarkTree.GetBookmarksMenuFolder(),
+		std::make_unique<BookmarkItem>(std::nullopt, L"Downloads", L"C:\\Downloads"), 0);
+
+	rawBookmark->SetName(L"Music");
+	EXPECT_THAT(Search(L"downloads"), ElementsAre(rawBookmark));
+	EXPECT_THAT(Search(L"music"), ElementsAre(rawBookmark));
+
+	rawBookmark->SetLocation(L"C:\\Music");
+	EXPECT_THAT(Search(L"downloads"), IsEmpty());
+}
+
+TEST_F(BookmarkSearchIndexTest, RemoveItems)
+{
+	auto folder = std::make_unique<BookmarkItem>(std::nullopt, L"Work", std::nullopt);
+	folder->AddChild(std::make_unique<BookmarkItem>(std::nullopt, L"Reports", L"C:\\Reports"));
+	auto rawFolder = m_bookmarkTree.AddBookmarkItem(
+		m_bookmarkTree.GetBookmarksToolbarFolder(), std::move(folder), 0);
+
+	m_bookmarkTree.RemoveBookmarkItem(rawFolder);
+
+	EXPECT_THAT(Search(L"work"), IsEmpty());
+	EXPECT_THAT(Search(L"reports"), IsEmpty());
+}
+
+TEST_F(BookmarkSearchIndexTest, Visits)
+{
+	auto rawBookmark1 = m_bookmarkTree.AddBookmarkItem(m_bookmarkTree.GetBookmarksMenuFolder(),
+		std::make_unique<BookmarkItem>(std::nullopt, L"Reports 1", L"C:\\Reports1"), 0);
+	auto rawBookmark2 = m_bookmarkTree.AddBookmarkItem(m_bookmarkTree.GetBookmarksMenuFolder(),
+		std::make_unique<BookmarkItem>(std::nullopt, L"Reports 2", L"C:\\Reports2"), 1);
+
+	EXPECT_THAT(Search(L"reports"), ElementsAre(rawBookmark1, rawBookmark2));
+
+	m_searchIndex.RecordVisit(rawBookmark2);
+	EXPECT_THAT(Search(L"reports"), ElementsAre(rawBookmark2, rawBookmark1));
+}
\ No newline at end of file
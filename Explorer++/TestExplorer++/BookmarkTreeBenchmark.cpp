@@ -0,0 +1,129 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+// Compares looking up bookmarks through the GUID index in BookmarkTree with the
+// recursive search it replaced, across a range of tree sizes. These tests are
+// disabled by default and can be run with
+// --gtest_also_run_disabled_tests --gtest_filter=BookmarkTreeBenchmark.*
+
+#include "Bookmarks/BookmarkTree.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// The search that was used before BookmarkTree indexed its items.
+	BookmarkItem *LegacyGetBookmarkItemById(BookmarkItem *bookmarkItem, std::wstring_view guid)
+	{
+		if (bookmarkItem->GetGUID() == guid)
+		{
+			return bookmarkItem;
+		}
+
+		if (!bookmarkItem->IsFolder())
+		{
+			return nullptr;
+		}
+
+		for (auto &child : bookmarkItem->GetChildren())
+		{
+			BookmarkItem *result = LegacyGetBookmarkItemById(child.get(), guid);
+
+			if (result)
+			{
+				return result;
+			}
+		}
+
+		return nullptr;
+	}
+
+	constexpr int BOOKMARKS_PER_FOLDER = 100;
+	constexpr int NUM_LOOKUPS = 1000;
+
+	// Adds the specified number of bookmarks to the tree, split across folders,
+	// and returns the GUIDs of the bookmarks.
+	std::vector<std::wstring> PopulateTree(BookmarkTree &bookmarkTree, int numBookmarks)
+	{
+		std::vector<std::wstring> guids;
+
+		for (int i = 0; i < numBookmarks; i += BOOKMARKS_PER_FOLDER)
+		{
+			auto folder = std::make_unique<BookmarkItem>(
+				std::nullopt, L"Folder " + std::to_wstring(i), std::nullopt);
+
+			for (int j = i; j < i + BOOKMARKS_PER_FOLDER && j < numBookmarks; j++)
+			{
+				auto bookmark = std::make_unique<BookmarkItem>(std::nullopt,
+					L"Bookmark " + std::to_wstring(j), L"C:\\Folder" + std::to_wstring(j));
+				guids.push_back(bookmark->GetGUID());
+				folder->AddChild(std::move(bookmark));
+			}
+
+			bookmarkTree.AddBookmarkItem(bookmarkTree.GetBookmarksMenuFolder(), std::move(folder),
+				bookmarkTree.GetBookmarksMenuFolder()->GetChildren().size());
+		}
+
+		return guids;
+	}
+
+	template <typename Function>
+	double MeasureMilliseconds(Function function)
+	{
+		auto start = std::chrono::steady_clock::now();
+		function();
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+	void PrintResult(const char *name, double legacyMs, double currentMs)
+	{
+		printf("%-28s legacy: %8.2f ms  current: %8.2f ms  (%.2fx)\n", name, legacyMs, currentMs,
+			legacyMs / currentMs);
+	}
+
+	void BenchmarkLookups(int numBookmarks)
+	{
+		BookmarkTree bookmarkTree;
+		auto guids = PopulateTree(bookmarkTree, numBookmarks);
+
+		std::mt19937 generator(0);
+		std::uniform_int_distribution<std::size_t> distribution(0, guids.size() - 1);
+		std::vector<std::wstring> lookups;
+
+		for (int i = 0; i < NUM_LOOKUPS; i++)
+		{
+			lookups.push_back(guids[distribution(generator)]);
+		}
+
+		double legacyMs = MeasureMilliseconds([&] {
+			for (const auto &guid : lookups)
+			{
+				ASSERT_NE(LegacyGetBookmarkItemById(bookmarkTree.GetRoot(), guid), nullptr);
+			}
+		});
+
+		double currentMs = MeasureMilliseconds([&] {
+			for (const auto &guid : lookups)
+			{
+				ASSERT_NE(bookmarkTree.GetBookmarkItemById(guid), nullptr);
+			}
+		});
+
+		std::string name = std::to_string(numBookmarks) + " bookmarks";
+		PrintResult(name.c_str(), legacyMs, currentMs);
+	}
+}
+
+TEST(BookmarkTreeBenchmark, DISABLED_LookupById)
+{
+	for (int numBookmarks : { 1000, 10000, 50000 })
+	{
+		BenchmarkLookups(numBookmarks);
+	}
+}
\ No newline at end of file
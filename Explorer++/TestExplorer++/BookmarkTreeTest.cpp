@@ -138,6 +138,60 @@ TEST(BookmarkTreeTest, RemoveChildren)
 	EXPECT_EQ(bookmarkTree.GetOtherBookmarksFolder()->GetChildren().size(), 0);
 }
 
+TEST(BookmarkTreeTest, GetBookmarkItemById)
+{
+	BookmarkTree bookmarkTree;
+
+	EXPECT_EQ(bookmarkTree.GetBookmarkItemById(bookmarkTree.GetRoot()->GetGUID()),
+		bookmarkTree.GetRoot());
+	EXPECT_EQ(bookmarkTree.GetBookmarkItemById(bookmarkTree.GetBookmarksMenuFolder()->GetGUID()),
+		bookmarkTree.GetBookmarksMenuFolder());
+	EXPECT_EQ(bookmarkTree.GetBookmarkItemById(L"unknown"), nullptr);
+
+	// Any children of an item should be indexed when the item is added.
+	auto folder = std::make_unique<BookmarkItem>(std::nullopt, L"Test folder", std::nullopt);
+	auto rawFolder = folder.get();
+	auto bookmark = std::make_unique<BookmarkItem>(std::nullopt, L"Test bookmark", L"C:\\");
+	auto rawBookmark = bookmark.get();
+	folder->AddChild(std::move(bookmark));
+	bookmarkTree.AddBookmarkItem(bookmarkTree.GetBookmarksMenuFolder(), std::move(folder), 0);
+
+	EXPECT_EQ(bookmarkTree.GetBookmarkItemById(rawFolder->GetGUID()), rawFolder);
+	EXPECT_EQ(bookmarkTree.GetBookmarkItemById(rawBookmark->GetGUID()), rawBookmark);
+
+	bookmarkTree.MoveBookmarkItem(rawFolder, bookmarkTree.GetOtherBookmarksFolder(), 0);
+
+	EXPECT_EQ(bookmarkTree.GetBookmarkItemById(rawFolder->GetGUID()), rawFolder);
+	EXPECT_EQ(bookmarkTree.GetBookmarkItemById(rawBookmark->GetGUID()), rawBookmark);
+
+	std::wstring folderGuid = rawFolder->GetGUID();
+	std::wstring bookmarkGuid = rawBookmark->GetGUID();
+	bookmarkTree.RemoveBookmarkItem(rawFolder);
+
+	EXPECT_EQ(bookmarkTree.GetBookmarkItemById(folderGuid), nullptr);
+	EXPECT_EQ(bookmarkTree.GetBookmarkItemById(bookmarkGuid), nullptr);
+}
+
+TEST(BookmarkTreeTest, MemoryUsage)
+{
+	BookmarkTree bookmarkTree;
+
+	size_t initialUsage = bookmarkTree.GetMemoryUsage();
+	EXPECT_GT(initialUsage, 0U);
+
+	auto bookmark = std::make_unique<BookmarkItem>(std::nullopt, L"Test bookmark", L"C:\\");
+	auto rawBookmark = bookmark.get();
+	bookmarkTree.AddBookmarkItem(bookmarkTree.GetBookmarksMenuFolder(), std::move(bookmark), 0);
+
+	EXPECT_GE(bookmarkTree.GetMemoryUsage(), initialUsage + sizeof(BookmarkItem));
+
+	bookmarkTree.RemoveBookmarkItem(rawBookmark);
+
+	// The capacity of the parent folder's list of children won't shrink, so
+	// the usage may not return to exactly the same value.
+	EXPECT_LT(bookmarkTree.GetMemoryUsage(), initialUsage + sizeof(BookmarkItem));
+}
+
 TEST_F(BookmarkTreeObserverTest, Add)
 {
 	m_bookmarkTree.bookmarkItemAddedSignal.AddObserver(
@@ -6,36 +6,18 @@
 #include "BookmarkStorageHelper.h"
 #include "Bookmarks/BookmarkTree.h"
 #include "ResourceHelper.h"
-#include "../Helper/XMLSettings.h"
+#include "../Helper/XmlStream.h"
 #include <gtest/gtest.h>
-#include <wil/com.h>
-#include <wil/resource.h>
+#include <fstream>
 #include <optional>
 
 using namespace testing;
 
-struct XmlDocumentData
-{
-	wil::com_ptr<IXMLDOMDocument> xmlDocument;
-	wil::com_ptr<IXMLDOMElement> root;
-};
-
-wil::com_ptr<IXMLDOMDocument> LoadXmlDocument(const std::wstring &filePath);
-std::optional<XmlDocumentData> CreateXmlDocument();
+std::optional<std::wstring> LoadXmlDocument(const std::wstring &filePath);
 
 class BookmarkXmlStorageTest : public Test
 {
 protected:
-	BookmarkXmlStorageTest()
-	{
-		CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
-	}
-
-	~BookmarkXmlStorageTest()
-	{
-		CoUninitialize();
-	}
-
 	void PerformLoadTest(
 		const std::wstring &filename, BookmarkTree *referenceBookmarkTree, bool compareGuids)
 	{
@@ -43,8 +25,10 @@ protected:
 		auto xmlDocument = LoadXmlDocument(xmlFilePath);
 		ASSERT_TRUE(xmlDocument);
 
+		XmlSections sections(*xmlDocument);
+
 		BookmarkTree loadedBookmarkTree;
-		BookmarkXmlStorage::Load(xmlDocument.get(), &loadedBookmarkTree);
+		BookmarkXmlStorage::Load(sections, &loadedBookmarkTree);
 
 		CompareBookmarkTrees(&loadedBookmarkTree, referenceBookmarkTree, compareGuids);
 	}
@@ -63,14 +47,16 @@ TEST_F(BookmarkXmlStorageTest, V2Save)
 	BookmarkTree referenceBookmarkTree;
 	BuildV2LoadSaveReferenceTree(&referenceBookmarkTree);
 
-	auto xmlDocumentData = CreateXmlDocument();
-	ASSERT_TRUE(xmlDocumentData);
+	XmlStreamWriter writer;
+	writer.WriteDeclaration();
+	writer.StartElement(L"ExplorerPlusPlus");
+	BookmarkXmlStorage::Save(writer, &referenceBookmarkTree);
+	writer.EndElement();
 
-	BookmarkXmlStorage::Save(
-		xmlDocumentData->xmlDocument.get(), xmlDocumentData->root.get(), &referenceBookmarkTree, 1);
+	XmlSections sections(writer.GetDocument());
 
 	BookmarkTree loadedBookmarkTree;
-	BookmarkXmlStorage::Load(xmlDocumentData->xmlDocument.get(), &loadedBookmarkTree);
+	BookmarkXmlStorage::Load(sections, &loadedBookmarkTree);
 
 	CompareBookmarkTrees(&loadedBookmarkTree, &referenceBookmarkTree, true);
 }
@@ -92,46 +78,17 @@ TEST_F(BookmarkXmlStorageTest, V1NestedShowOnToolbarLoad)
 		L"bookmarks-v1-config-nested-show-on-toolbar.xml", &referenceBookmarkTree, false);
 }
 
-wil::com_ptr<IXMLDOMDocument> LoadXmlDocument(const std::wstring &filePath)
-{
-	wil::com_ptr<IXMLDOMDocument> xmlDocument(NXMLSettings::DomFromCOM());
-
-	if (!xmlDocument)
-	{
-		return nullptr;
-	}
-
-	VARIANT_BOOL status;
-	VARIANT variantFilePath = NXMLSettings::VariantString(filePath.c_str());
-	xmlDocument->load(variantFilePath, &status);
-
-	if (status != VARIANT_TRUE)
-	{
-		return nullptr;
-	}
-
-	return xmlDocument;
-}
-
-std::optional<XmlDocumentData> CreateXmlDocument()
+std::optional<std::wstring> LoadXmlDocument(const std::wstring &filePath)
 {
-	wil::com_ptr<IXMLDOMDocument> xmlDocument(NXMLSettings::DomFromCOM());
+	std::ifstream inputStream(filePath, std::ios::binary);
 
-	if (!xmlDocument)
+	if (!inputStream)
 	{
-		return {};
+		return std::nullopt;
 	}
 
-	auto tag = wil::make_bstr(L"xml");
-	auto attribute = wil::make_bstr(L"version='1.0'");
-	wil::com_ptr<IXMLDOMProcessingInstruction> processingInstruction;
-	xmlDocument->createProcessingInstruction(tag.get(), attribute.get(), &processingInstruction);
-	NXMLSettings::AppendChildToParent(processingInstruction.get(), xmlDocument.get());
-
-	auto rootTag = wil::make_bstr(L"ExplorerPlusPlus");
-	wil::com_ptr<IXMLDOMElement> root;
-	xmlDocument->createElement(rootTag.get(), &root);
-	NXMLSettings::AppendChildToParent(root.get(), xmlDocument.get());
+	std::string data(
+		(std::istreambuf_iterator<char>(inputStream)), std::istreambuf_iterator<char>());
 
-	return XmlDocumentData{ std::move(xmlDocument), std::move(root) };
+	return DecodeXmlDocument(data);
 }
\ No newline at end of file
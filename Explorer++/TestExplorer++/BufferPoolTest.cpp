@@ -0,0 +1,42 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "../Helper/BufferPool.h"
+#include <gtest/gtest.h>
+
+TEST(BufferPoolTest, ReusesReleasedBuffers)
+{
+	BufferPool pool(1024, 2);
+
+	BufferPool::Buffer buffer = pool.Acquire();
+	ASSERT_NE(buffer, nullptr);
+	std::byte *originalBuffer = buffer.get();
+
+	pool.Release(std::move(buffer));
+	EXPECT_EQ(pool.GetNumFreeBuffers(), 1U);
+
+	BufferPool::Buffer reusedBuffer = pool.Acquire();
+	EXPECT_EQ(reusedBuffer.get(), originalBuffer);
+	EXPECT_EQ(pool.GetNumFreeBuffers(), 0U);
+}
+
+TEST(BufferPoolTest, LimitsFreeBuffers)
+{
+	BufferPool pool(1024, 2);
+
+	BufferPool::Buffer buffers[] = { pool.Acquire(), pool.Acquire(), pool.Acquire() };
+
+	for (auto &buffer : buffers)
+	{
+		pool.Release(std::move(buffer));
+	}
+
+	EXPECT_EQ(pool.GetNumFreeBuffers(), 2U);
+}
+
+TEST(BufferPoolTest, BufferSize)
+{
+	BufferPool pool(4096, 1);
+	EXPECT_EQ(pool.GetBufferSize(), 4096U);
+}
\ No newline at end of file
@@ -0,0 +1,275 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+// Compares CachedIcons with the single-threaded, path-keyed container it
+// replaced. These tests are disabled by default and can be run with
+// --gtest_also_run_disabled_tests --gtest_filter=CachedIconsBenchmark.*
+//
+// CachedIcons doesn't depend on any Windows APIs, so this file can also be
+// built and run on Linux, e.g.:
+//
+// g++ -std=c++17 -O2 -I<dir containing an empty stdafx.h>
+//     -DUNREFERENCED_PARAMETER(P)=(void)(P) TestExplorer++/CachedIconsBenchmark.cpp
+//     Helper/CachedIcons.cpp -lgtest -lgtest_main -pthread
+
+#include "../Helper/CachedIcons.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace
+{
+	// The previous implementation of CachedIcons.
+	class LegacyCachedIcons
+	{
+	public:
+		struct CachedIcon
+		{
+			std::wstring filePath;
+			int iconIndex;
+		};
+
+		typedef boost::multi_index_container<CachedIcon,
+			boost::multi_index::indexed_by<boost::multi_index::sequenced<>,
+				boost::multi_index::hashed_unique<
+					boost::multi_index::member<CachedIcon, std::wstring, &CachedIcon::filePath>>>>
+			CachedIconSet;
+
+		LegacyCachedIcons(std::size_t maxItems) : m_maxItems(maxItems)
+		{
+		}
+
+		void addOrUpdateFileIcon(const std::wstring &filePath, int iconIndex)
+		{
+			auto &pathIndex = m_cachedIconSet.get<1>();
+			auto itr = pathIndex.find(filePath);
+
+			if (itr != pathIndex.end())
+			{
+				pathIndex.replace(itr, { filePath, iconIndex });
+				m_cachedIconSet.relocate(m_cachedIconSet.begin(), m_cachedIconSet.project<0>(itr));
+				return;
+			}
+
+			m_cachedIconSet.push_front({ filePath, iconIndex });
+
+			if (m_cachedIconSet.size() > m_maxItems)
+			{
+				m_cachedIconSet.pop_back();
+			}
+		}
+
+		std::optional<int> findByPath(const std::wstring &filePath)
+		{
+			auto &pathIndex = m_cachedIconSet.get<1>();
+			auto itr = pathIndex.find(filePath);
+
+			if (itr == pathIndex.end())
+			{
+				return std::nullopt;
+			}
+
+			return itr->iconIndex;
+		}
+
+	private:
+		CachedIconSet m_cachedIconSet;
+		std::size_t m_maxItems;
+	};
+
+	const std::size_t MAX_ITEMS = 1000;
+	const int NUM_LOOKUPS = 1000000;
+	const int NUM_THREADS = 4;
+
+	const wchar_t *const EXTENSIONS[] = { L".txt", L".cpp", L".h", L".jpg", L".png", L".pdf",
+		L".docx", L".xlsx", L".zip", L".mp3" };
+
+	std::vector<std::wstring> GeneratePaths(std::size_t count)
+	{
+		std::vector<std::wstring> paths;
+
+		for (std::size_t i = 0; i < count; i++)
+		{
+			paths.push_back(L"C:\\Users\\user\\Documents\\Projects\\Folder"
+				+ std::to_wstring(i % 50) + L"\\File" + std::to_wstring(i)
+				+ EXTENSIONS[i % std::size(EXTENSIONS)]);
+		}
+
+		return paths;
+	}
+
+	template <typename Function>
+	double MeasureMilliseconds(Function function)
+	{
+		auto start = std::chrono::steady_clock::now();
+		function();
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+	void PrintResult(const char *name, double legacyMs, double currentMs)
+	{
+		printf("%-28s legacy: %8.2f ms  current: %8.2f ms  (%.2fx)\n", name, legacyMs, currentMs,
+			legacyMs / currentMs);
+	}
+}
+
+TEST(CachedIconsBenchmark, DISABLED_SingleThreadedLookups)
+{
+	auto paths = GeneratePaths(MAX_ITEMS);
+
+	LegacyCachedIcons legacyCachedIcons(MAX_ITEMS);
+	CachedIcons cachedIcons(MAX_ITEMS * 2);
+
+	for (std::size_t i = 0; i < paths.size(); i++)
+	{
+		legacyCachedIcons.addOrUpdateFileIcon(paths[i], static_cast<int>(i));
+		cachedIcons.addOrUpdateFileIcon(paths[i], static_cast<int>(i));
+	}
+
+	std::mt19937 generator(0);
+	std::uniform_int_distribution<std::size_t> distribution(0, paths.size() - 1);
+	std::vector<std::size_t> lookupOrder;
+
+	for (int i = 0; i < NUM_LOOKUPS; i++)
+	{
+		lookupOrder.push_back(distribution(generator));
+	}
+
+	int legacyHits = 0;
+	double legacyMs = MeasureMilliseconds([&] {
+		for (auto index : lookupOrder)
+		{
+			legacyHits += legacyCachedIcons.findByPath(paths[index]).has_value();
+		}
+	});
+
+	int hits = 0;
+	double currentMs = MeasureMilliseconds([&] {
+		for (auto index : lookupOrder)
+		{
+			hits += cachedIcons.findByPath(paths[index]).has_value();
+		}
+	});
+
+	EXPECT_EQ(legacyHits, NUM_LOOKUPS);
+	EXPECT_EQ(hits, NUM_LOOKUPS);
+
+	PrintResult("Single-threaded lookups", legacyMs, currentMs);
+}
+
+// The legacy container can only be used from a single thread, so it's
+// protected by a mutex here. That's the minimum that would be required to
+// allow workers to consult it.
+TEST(CachedIconsBenchmark, DISABLED_ConcurrentLookups)
+{
+	auto paths = GeneratePaths(MAX_ITEMS);
+
+	LegacyCachedIcons legacyCachedIcons(MAX_ITEMS);
+	std::mutex legacyMutex;
+	CachedIcons cachedIcons(MAX_ITEMS * 2);
+
+	for (std::size_t i = 0; i < paths.size(); i++)
+	{
+		legacyCachedIcons.addOrUpdateFileIcon(paths[i], static_cast<int>(i));
+		cachedIcons.addOrUpdateFileIcon(paths[i], static_cast<int>(i));
+	}
+
+	auto runThreads = [&paths](auto lookup) {
+		std::vector<std::thread> threads;
+
+		for (int i = 0; i < NUM_THREADS; i++)
+		{
+			threads.emplace_back([&paths, lookup, i]() mutable {
+				std::mt19937 generator(i);
+				std::uniform_int_distribution<std::size_t> distribution(0, paths.size() - 1);
+
+				for (int j = 0; j < NUM_LOOKUPS / NUM_THREADS; j++)
+				{
+					lookup(paths[distribution(generator)]);
+				}
+			});
+		}
+
+		for (auto &thread : threads)
+		{
+			thread.join();
+		}
+	};
+
+	double legacyMs = MeasureMilliseconds([&] {
+		runThreads([&legacyCachedIcons, &legacyMutex](const std::wstring &path) {
+			std::lock_guard<std::mutex> lock(legacyMutex);
+			legacyCachedIcons.findByPath(path);
+		});
+	});
+
+	double currentMs = MeasureMilliseconds([&] {
+		runThreads([&cachedIcons](const std::wstring &path) { cachedIcons.findByPath(path); });
+	});
+
+	PrintResult("Concurrent lookups", legacyMs, currentMs);
+}
+
+// Simulates browsing a set of folders that contain more files than the cache
+// can hold. Most files have an icon that's shared with every other file of
+// the same type, which the current implementation only stores once.
+TEST(CachedIconsBenchmark, DISABLED_LargeFolderHitRate)
+{
+	auto paths = GeneratePaths(MAX_ITEMS * 10);
+
+	LegacyCachedIcons legacyCachedIcons(MAX_ITEMS);
+	CachedIcons cachedIcons(MAX_ITEMS);
+
+	IconDetails iconDetails;
+	iconDetails.itemType = IconDetails::ItemType::File;
+	iconDetails.perClass = true;
+
+	int legacyHits = 0;
+	double legacyMs = MeasureMilliseconds([&] {
+		for (int pass = 0; pass < 2; pass++)
+		{
+			for (std::size_t i = 0; i < paths.size(); i++)
+			{
+				if (legacyCachedIcons.findByPath(paths[i]))
+				{
+					legacyHits++;
+				}
+				else
+				{
+					legacyCachedIcons.addOrUpdateFileIcon(
+						paths[i], static_cast<int>(i % std::size(EXTENSIONS)));
+				}
+			}
+		}
+	});
+
+	int hits = 0;
+	double currentMs = MeasureMilliseconds([&] {
+		for (int pass = 0; pass < 2; pass++)
+		{
+			for (std::size_t i = 0; i < paths.size(); i++)
+			{
+				if (cachedIcons.findByPath(paths[i], CachedIcons::ItemType::File))
+				{
+					hits++;
+				}
+				else
+				{
+					cachedIcons.addOrUpdateFileIcon(
+						paths[i], static_cast<int>(i % std::size(EXTENSIONS)), iconDetails);
+				}
+			}
+		}
+	});
+
+	PrintResult("Large folder lookups", legacyMs, currentMs);
+	printf("%-28s legacy: %8d      current: %8d      (of %zu)\n", "Large folder hits", legacyHits,
+		hits, paths.size() * 2);
+
+	EXPECT_GT(hits, legacyHits);
+}
\ No newline at end of file
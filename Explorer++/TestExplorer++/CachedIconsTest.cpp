@@ -4,85 +4,224 @@
 
 #include "../Helper/CachedIcons.h"
 #include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
 
+// These tests use a single shard, so that the order in which icons are
+// removed is predictable.
 TEST(CachedIconsTest, TestMaxSize)
 {
-	CachedIcons cachedIcons(2);
+	CachedIcons cachedIcons(2, nullptr, 1);
 
-	CachedIcon cachedIcon;
-	cachedIcon.filePath = L"C:\\file1";
-	cachedIcon.iconIndex = 0;
-	cachedIcons.insert(cachedIcon);
+	cachedIcons.addOrUpdateFileIcon(L"C:\\file1", 0);
+	cachedIcons.addOrUpdateFileIcon(L"C:\\file2", 0);
 
-	cachedIcon.filePath = L"C:\\file2";
-	cachedIcon.iconIndex = 0;
-	cachedIcons.insert(cachedIcon);
+	auto iconIndex = cachedIcons.findByPath(L"C:\\file1");
+	EXPECT_TRUE(iconIndex.has_value());
 
-	auto itr = cachedIcons.findByPath(L"C:\\file1");
-	EXPECT_TRUE(itr != cachedIcons.end());
-
-	cachedIcon.filePath = L"C:\\file3";
-	cachedIcon.iconIndex = 0;
-	cachedIcons.insert(cachedIcon);
+	cachedIcons.addOrUpdateFileIcon(L"C:\\file3", 0);
 
 	// The cache can hold a maximum of 2 icons, so the addition of the third
 	// icon above should have pushed out the oldest item.
-	itr = cachedIcons.findByPath(L"C:\\file1");
-	EXPECT_TRUE(itr == cachedIcons.end());
+	iconIndex = cachedIcons.findByPath(L"C:\\file1");
+	EXPECT_FALSE(iconIndex.has_value());
 
 	// But the second item should still be there.
-	itr = cachedIcons.findByPath(L"C:\\file2");
-	EXPECT_TRUE(itr != cachedIcons.end());
+	iconIndex = cachedIcons.findByPath(L"C:\\file2");
+	EXPECT_TRUE(iconIndex.has_value());
 }
 
-TEST(CachedIconsTest, TestLookup)
+TEST(CachedIconsTest, TestMemoryUsage)
 {
-	CachedIcons cachedIcons(2);
+	CachedIcons cachedIcons(100, nullptr, 1);
 
-	CachedIcon cachedIcon;
-	cachedIcon.filePath = L"C:\\file1";
-	cachedIcon.iconIndex = 0;
-	cachedIcons.insert(cachedIcon);
+	std::size_t initialUsage = cachedIcons.getMemoryUsage();
 
-	auto itr = cachedIcons.findByPath(L"C:\\file1");
-	EXPECT_TRUE(itr != cachedIcons.end());
+	for (int i = 0; i < 50; i++)
+	{
+		cachedIcons.addOrUpdateFileIcon(L"C:\\file" + std::to_wstring(i), 0);
+	}
 
-	itr = cachedIcons.findByPath(L"C:\\non-existent");
-	EXPECT_TRUE(itr == cachedIcons.end());
+	EXPECT_GT(cachedIcons.getMemoryUsage(), initialUsage);
 }
 
-TEST(CachedIconsTest, TestReplace)
+TEST(CachedIconsTest, TestLookup)
 {
-	CachedIcons cachedIcons(2);
+	CachedIcons cachedIcons(2, nullptr, 1);
+
+	cachedIcons.addOrUpdateFileIcon(L"C:\\file1", 0);
 
-	CachedIcon cachedIcon;
-	cachedIcon.filePath = L"C:\\file1";
-	cachedIcon.iconIndex = 0;
-	cachedIcons.insert(cachedIcon);
+	auto iconIndex = cachedIcons.findByPath(L"C:\\file1");
+	EXPECT_TRUE(iconIndex.has_value());
 
-	cachedIcon.filePath = L"C:\\file2";
-	cachedIcon.iconIndex = 0;
-	cachedIcons.insert(cachedIcon);
+	iconIndex = cachedIcons.findByPath(L"C:\\non-existent");
+	EXPECT_FALSE(iconIndex.has_value());
+}
+
+TEST(CachedIconsTest, TestReplace)
+{
+	CachedIcons cachedIcons(2, nullptr, 1);
 
-	auto itr = cachedIcons.findByPath(L"C:\\file1");
-	cachedIcon = *itr;
-	cachedIcon.iconIndex = 1;
-	cachedIcons.replace(itr, cachedIcon);
+	cachedIcons.addOrUpdateFileIcon(L"C:\\file1", 0);
+	cachedIcons.addOrUpdateFileIcon(L"C:\\file2", 0);
+	cachedIcons.addOrUpdateFileIcon(L"C:\\file1", 1);
 
-	itr = cachedIcons.findByPath(L"C:\\file1");
-	EXPECT_EQ(itr->iconIndex, 1);
+	auto iconIndex = cachedIcons.findByPath(L"C:\\file1");
+	EXPECT_EQ(iconIndex, 1);
 
-	cachedIcon.filePath = L"C:\\file3";
-	cachedIcon.iconIndex = 0;
-	cachedIcons.insert(cachedIcon);
+	cachedIcons.addOrUpdateFileIcon(L"C:\\file3", 0);
 
 	// Replacing the item above should have moved it to the front of the
 	// list. This means that when the third item was inserted, the
 	// second item is what should have been removed.
-	itr = cachedIcons.findByPath(L"C:\\file2");
-	EXPECT_TRUE(itr == cachedIcons.end());
+	iconIndex = cachedIcons.findByPath(L"C:\\file2");
+	EXPECT_FALSE(iconIndex.has_value());
 
 	// The replaced item should still exist.
-	itr = cachedIcons.findByPath(L"C:\\file1");
-	EXPECT_TRUE(itr != cachedIcons.end());
+	iconIndex = cachedIcons.findByPath(L"C:\\file1");
+	EXPECT_TRUE(iconIndex.has_value());
+}
+
+TEST(CachedIconsTest, TestPerClassIcons)
+{
+	CachedIcons cachedIcons(100);
+
+	IconDetails iconDetails;
+	iconDetails.itemType = IconDetails::ItemType::File;
+	iconDetails.perClass = true;
+
+	// The overlay index (stored in the upper bits) should be ignored.
+	cachedIcons.addOrUpdateFileIcon(L"C:\\file1.txt", 0x01000005, iconDetails);
+
+	// Every other file with the same extension should share the icon.
+	EXPECT_EQ(cachedIcons.findByPath(L"C:\\dir\\file2.TXT", CachedIcons::ItemType::File), 5);
+
+	// But only if the caller knows that the item is a file.
+	EXPECT_FALSE(cachedIcons.findByPath(L"C:\\dir\\file2.txt").has_value());
+	EXPECT_FALSE(
+		cachedIcons.findByPath(L"C:\\dir\\folder.txt", CachedIcons::ItemType::Folder).has_value());
+
+	EXPECT_FALSE(cachedIcons.findByPath(L"C:\\file3.doc", CachedIcons::ItemType::File).has_value());
+	EXPECT_FALSE(cachedIcons.findByPath(L"C:\\txt", CachedIcons::ItemType::File).has_value());
+	EXPECT_FALSE(
+		cachedIcons.findByPath(L"C:\\dir.txt\\file", CachedIcons::ItemType::File).has_value());
+
+	// An icon that's specific to an item takes precedence.
+	cachedIcons.addOrUpdateFileIcon(L"C:\\dir\\file2.txt", 7);
+	EXPECT_EQ(cachedIcons.findByPath(L"C:\\dir\\file2.txt", CachedIcons::ItemType::File), 7);
+
+	EXPECT_EQ(cachedIcons.size(), 2U);
+}
+
+TEST(CachedIconsTest, TestSaveAndLoad)
+{
+	CachedIcons cachedIcons(100);
+
+	IconDetails iconDetails;
+	iconDetails.itemType = IconDetails::ItemType::Folder;
+	iconDetails.perClass = true;
+	iconDetails.location = IconLocation{ L"C:\\Windows\\System32\\imageres.dll", -3 };
+	cachedIcons.addOrUpdateFileIcon(L"C:\\folder", 3, iconDetails);
+
+	iconDetails.itemType = IconDetails::ItemType::File;
+	iconDetails.perClass = false;
+	iconDetails.location = IconLocation{ L"C:\\app.exe", 0 };
+	cachedIcons.addOrUpdateFileIcon(L"C:\\app.exe", 10, iconDetails);
+
+	// Icons without a location can't be restored, so won't be saved.
+	cachedIcons.addOrUpdateFileIcon(L"C:\\file", 12);
+
+	std::stringstream stream;
+	cachedIcons.save(stream);
+
+	std::vector<std::wstring> resolvedFiles;
+
+	CachedIcons loadedCachedIcons(100, [&resolvedFiles](const IconLocation &location) {
+		resolvedFiles.push_back(location.file);
+		return std::optional<int>(100 + location.index);
+	});
+	EXPECT_TRUE(loadedCachedIcons.load(stream));
+	EXPECT_EQ(loadedCachedIcons.size(), 2U);
+
+	// Icons are resolved when they're first retrieved and only once.
+	EXPECT_EQ(loadedCachedIcons.findByPath(L"C:\\app.exe"), 100);
+	EXPECT_EQ(loadedCachedIcons.findByPath(L"C:\\app.exe"), 100);
+	EXPECT_EQ(loadedCachedIcons.findByPath(L"D:\\other", CachedIcons::ItemType::Folder), 97);
+	EXPECT_FALSE(loadedCachedIcons.findByPath(L"C:\\file").has_value());
+
+	std::vector<std::wstring> expectedResolvedFiles = { L"C:\\app.exe",
+		L"C:\\Windows\\System32\\imageres.dll" };
+	EXPECT_EQ(resolvedFiles, expectedResolvedFiles);
+}
+
+TEST(CachedIconsTest, TestLoadInvalid)
+{
+	CachedIcons cachedIcons(100);
+
+	std::stringstream emptyStream;
+	EXPECT_FALSE(cachedIcons.load(emptyStream));
+
+	CachedIcons otherCachedIcons(100);
+	IconDetails iconDetails;
+	iconDetails.location = IconLocation{ L"C:\\app.exe", 0 };
+	otherCachedIcons.addOrUpdateFileIcon(L"C:\\app.exe", 10, iconDetails);
+
+	std::stringstream stream;
+	otherCachedIcons.save(stream);
+
+	// Truncated data should be rejected in its entirety.
+	std::string data = stream.str();
+	std::stringstream truncatedStream(data.substr(0, data.size() - 1));
+	EXPECT_FALSE(cachedIcons.load(truncatedStream));
+	EXPECT_EQ(cachedIcons.size(), 0U);
+}
+
+TEST(CachedIconsTest, TestUnresolvedIconRemoved)
+{
+	CachedIcons cachedIcons(100);
+	IconDetails iconDetails;
+	iconDetails.location = IconLocation{ L"C:\\app.exe", 0 };
+	cachedIcons.addOrUpdateFileIcon(L"C:\\app.exe", 10, iconDetails);
+
+	std::stringstream stream;
+	cachedIcons.save(stream);
+
+	CachedIcons loadedCachedIcons(
+		100, [](const IconLocation &) -> std::optional<int> { return std::nullopt; });
+	EXPECT_TRUE(loadedCachedIcons.load(stream));
+	EXPECT_FALSE(loadedCachedIcons.findByPath(L"C:\\app.exe").has_value());
+	EXPECT_EQ(loadedCachedIcons.size(), 0U);
+}
+
+TEST(CachedIconsTest, TestConcurrentAccess)
+{
+	CachedIcons cachedIcons(1000);
+	std::vector<std::thread> threads;
+
+	for (int i = 0; i < 4; i++)
+	{
+		threads.emplace_back([&cachedIcons, i] {
+			for (int j = 0; j < 1000; j++)
+			{
+				std::wstring path = L"C:\\" + std::to_wstring(i) + L"\\" + std::to_wstring(j);
+				cachedIcons.addOrUpdateFileIcon(path, j);
+
+				auto iconIndex = cachedIcons.findByPath(path);
+
+				// The icon may have already been removed, but if it's still
+				// present, it should be correct.
+				if (iconIndex)
+				{
+					EXPECT_EQ(*iconIndex, j);
+				}
+			}
+		});
+	}
+
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+
+	EXPECT_LE(cachedIcons.size(), 1000U + CachedIcons::DEFAULT_NUM_SHARDS);
 }
\ No newline at end of file
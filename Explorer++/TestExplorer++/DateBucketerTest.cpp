@@ -0,0 +1,128 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "../Helper/DateBucketer.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace boost::gregorian;
+
+namespace
+{
+const uint64_t TICKS_PER_MINUTE = 60ULL * 10000000ULL;
+const uint64_t TICKS_PER_DAY = 24ULL * 60ULL * TICKS_PER_MINUTE;
+
+// Local times are treated as being this far ahead of UTC.
+const int64_t UTC_OFFSET_MINUTES = 150;
+
+uint64_t LocalTimeToTimestamp(const date &localDate, int hour = 0, int minute = 0)
+{
+	int64_t localMinutes = (localDate - date(1601, 1, 1)).days() * 24 * 60 + hour * 60 + minute;
+	return static_cast<uint64_t>(localMinutes - UTC_OFFSET_MINUTES) * TICKS_PER_MINUTE;
+}
+
+DateBucketer CreateDateBucketer(const date &today)
+{
+	return DateBucketer(today, [](const date &localDate) {
+		return LocalTimeToTimestamp(localDate);
+	});
+}
+}
+
+TEST(DateBucketerTest, RecentDays)
+{
+	// A Wednesday.
+	date today(2020, 6, 17);
+	auto dateBucketer = CreateDateBucketer(today);
+
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(today + days(1))), DateBucket::Future);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(today, 23, 59)), DateBucket::Today);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(today)), DateBucket::Today);
+	EXPECT_EQ(
+		dateBucketer.Classify(LocalTimeToTimestamp(today - days(1), 23, 59)), DateBucket::Yesterday);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(today - days(1))), DateBucket::Yesterday);
+
+	// The boundaries are based on local time, which is ahead of UTC here. So,
+	// the last minute before midnight (local time) is still yesterday.
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(today) - TICKS_PER_MINUTE),
+		DateBucket::Yesterday);
+}
+
+TEST(DateBucketerTest, WeeksMonthsAndYears)
+{
+	// A Wednesday.
+	date today(2020, 6, 17);
+	auto dateBucketer = CreateDateBucketer(today);
+
+	// Weeks start on Sunday.
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 6, 14))), DateBucket::ThisWeek);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 6, 13))), DateBucket::LastWeek);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 6, 7))), DateBucket::LastWeek);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 6, 6))), DateBucket::ThisMonth);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 6, 1))), DateBucket::ThisMonth);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 5, 31))), DateBucket::LastMonth);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 5, 1))), DateBucket::LastMonth);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 4, 30))), DateBucket::ThisYear);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 1, 1))), DateBucket::ThisYear);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2019, 12, 31))), DateBucket::LastYear);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2019, 1, 1))), DateBucket::LastYear);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2018, 12, 31))), DateBucket::LongAgo);
+	EXPECT_EQ(dateBucketer.Classify(0), DateBucket::LongAgo);
+}
+
+TEST(DateBucketerTest, OverlappingBoundaries)
+{
+	// A Thursday, early in the month. The current week started in the
+	// previous month, so any date this month is either today, yesterday or
+	// this week.
+	date today(2020, 7, 2);
+	auto dateBucketer = CreateDateBucketer(today);
+
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 6, 30))), DateBucket::ThisWeek);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 6, 28))), DateBucket::ThisWeek);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 6, 21))), DateBucket::LastWeek);
+
+	// Last month begins after the start of last week, so this is still
+	// classified as last month.
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 6, 20))), DateBucket::LastMonth);
+
+	// A Sunday. Yesterday was in the previous week.
+	today = date(2020, 6, 14);
+	dateBucketer = CreateDateBucketer(today);
+
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 6, 13))), DateBucket::Yesterday);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 6, 12))), DateBucket::LastWeek);
+
+	// The first day of the year.
+	today = date(2021, 1, 1);
+	dateBucketer = CreateDateBucketer(today);
+
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 12, 31))), DateBucket::Yesterday);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 12, 27))), DateBucket::ThisWeek);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 12, 20))), DateBucket::LastWeek);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 12, 19))), DateBucket::LastMonth);
+	EXPECT_EQ(dateBucketer.Classify(LocalTimeToTimestamp(date(2020, 11, 30))), DateBucket::LastYear);
+}
+
+TEST(DateBucketerTest, ClassifyAll)
+{
+	date today(2020, 6, 17);
+	auto dateBucketer = CreateDateBucketer(today);
+
+	std::vector<uint64_t> timestamps;
+
+	for (uint64_t timestamp = LocalTimeToTimestamp(date(2018, 6, 1));
+		 timestamp < LocalTimeToTimestamp(today + days(7)); timestamp += TICKS_PER_DAY / 3)
+	{
+		timestamps.push_back(timestamp);
+	}
+
+	std::vector<DateBucket> buckets(timestamps.size());
+	dateBucketer.ClassifyAll(timestamps.data(), buckets.data(), timestamps.size());
+
+	for (size_t i = 0; i < timestamps.size(); i++)
+	{
+		EXPECT_EQ(buckets[i], dateBucketer.Classify(timestamps[i]));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "../Explorer++/ShellBrowser/FolderListingCache.h"
+#include "../Explorer++/ShellBrowser/FolderListing.h"
+#include "../Helper/ShellHelper.h"
+#include <gtest/gtest.h>
+#include <ShlObj.h>
+#include <memory>
+#include <string>
+
+namespace
+{
+std::shared_ptr<const FolderListing> CreateListing(size_t displayNameLength)
+{
+	unique_pidl_absolute pidlItem(SHSimpleIDListFromPath(L"C:\\Fake\\Item"));
+
+	FolderListingItem item;
+	item.pidlChild.reset(ILCloneChild(ILFindLastID(pidlItem.get())));
+	item.displayName = std::wstring(displayNameLength, 'a');
+	item.wfd = {};
+
+	auto listing = std::make_shared<FolderListing>();
+	listing->items.push_back(std::move(item));
+	listing->showHidden = FALSE;
+	listing->sortAscending = TRUE;
+
+	return listing;
+}
+}
+
+TEST(FolderListingCacheTest, InsertAndFind)
+{
+	FolderListingCache cache(100000);
+
+	unique_pidl_absolute pidlDirectory(SHSimpleIDListFromPath(L"C:\\Fake"));
+	ASSERT_TRUE(pidlDirectory);
+
+	auto listing = CreateListing(10);
+	cache.Insert(pidlDirectory.get(), listing);
+
+	EXPECT_TRUE(cache.Contains(pidlDirectory.get()));
+	EXPECT_EQ(cache.Find(pidlDirectory.get()), listing);
+	EXPECT_EQ(cache.GetMemoryUsage(), listing->GetMemoryUsage());
+
+	cache.Remove(pidlDirectory.get());
+	EXPECT_FALSE(cache.Contains(pidlDirectory.get()));
+	EXPECT_EQ(cache.GetMemoryUsage(), 0U);
+}
+
+TEST(FolderListingCacheTest, MaxListingSize)
+{
+	const size_t maxBytes = 100000;
+	FolderListingCache cache(maxBytes);
+
+	// A single listing should only be able to take up a fraction of the cache.
+	EXPECT_EQ(cache.GetMaxListingSize(), maxBytes / 4);
+
+	unique_pidl_absolute pidlDirectory1(SHSimpleIDListFromPath(L"C:\\Fake1"));
+	ASSERT_TRUE(pidlDirectory1);
+
+	unique_pidl_absolute pidlDirectory2(SHSimpleIDListFromPath(L"C:\\Fake2"));
+	ASSERT_TRUE(pidlDirectory2);
+
+	auto smallListing = CreateListing(10);
+	ASSERT_LE(smallListing->GetMemoryUsage(), cache.GetMaxListingSize());
+
+	cache.Insert(pidlDirectory1.get(), smallListing);
+	EXPECT_TRUE(cache.Contains(pidlDirectory1.get()));
+
+	// This listing would fit within the cache, but is too large to be worth
+	// storing.
+	auto largeListing = CreateListing(cache.GetMaxListingSize() / sizeof(wchar_t));
+	ASSERT_GT(largeListing->GetMemoryUsage(), cache.GetMaxListingSize());
+	ASSERT_LT(largeListing->GetMemoryUsage(), maxBytes);
+
+	cache.Insert(pidlDirectory2.get(), largeListing);
+	EXPECT_FALSE(cache.Contains(pidlDirectory2.get()));
+
+	// Attempting to store the large listing shouldn't have removed anything.
+	EXPECT_TRUE(cache.Contains(pidlDirectory1.get()));
+	EXPECT_EQ(cache.GetMemoryUsage(), smallListing->GetMemoryUsage());
+}
\ No newline at end of file
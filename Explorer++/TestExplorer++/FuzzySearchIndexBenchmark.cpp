@@ -0,0 +1,155 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+// Measures queries against a FuzzySearchIndex containing 100,000 documents,
+// comparing them with a linear, case-insensitive substring scan. These tests
+// are disabled by default and can be run with
+// --gtest_also_run_disabled_tests --gtest_filter=FuzzySearchIndexBenchmark.*
+//
+// FuzzySearchIndex doesn't depend on any Windows APIs, so this file can also be
+// built and run on Linux, e.g.:
+//
+// g++ -std=c++17 -O2 -I<dir containing an empty stdafx.h>
+//     TestExplorer++/FuzzySearchIndexBenchmark.cpp Helper/FuzzySearchIndex.cpp
+//     -lgtest -lgtest_main -pthread
+
+#include "../Helper/FuzzySearchIndex.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cwctype>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr int NUM_DOCUMENTS = 100000;
+	constexpr int NUM_ITERATIONS = 20;
+	constexpr std::size_t MAX_RESULTS = 50;
+
+	// Queries are expected to complete within this time.
+	constexpr double MAX_QUERY_MS = 5;
+
+	struct Document
+	{
+		std::wstring key;
+		std::wstring title;
+		std::wstring detail;
+	};
+
+	std::wstring ToLower(std::wstring text)
+	{
+		std::transform(text.begin(), text.end(), text.begin(),
+			[](wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+		return text;
+	}
+
+	// The approach that would otherwise be needed to search bookmarks: check
+	// every name and location for the query.
+	std::size_t LegacySearch(const std::vector<Document> &documents, const std::wstring &query)
+	{
+		std::wstring normalizedQuery = ToLower(query);
+		std::size_t numMatches = 0;
+
+		for (const auto &document : documents)
+		{
+			if (ToLower(document.title).find(normalizedQuery) != std::wstring::npos
+				|| ToLower(document.detail).find(normalizedQuery) != std::wstring::npos)
+			{
+				numMatches++;
+			}
+		}
+
+		return numMatches;
+	}
+
+	std::vector<Document> GenerateDocuments()
+	{
+		const std::vector<std::wstring> words = { L"Projects", L"Documents", L"Reports",
+			L"Archive", L"Photos", L"Music", L"Downloads", L"Work", L"Personal", L"Backup",
+			L"Source", L"Invoices", L"Travel", L"Family", L"Games", L"Videos", L"Notes",
+			L"Clients", L"Drafts", L"Shared" };
+
+		std::mt19937 generator(0);
+		std::uniform_int_distribution<std::size_t> wordDistribution(0, words.size() - 1);
+		std::uniform_int_distribution<int> numberDistribution(0, 9999);
+
+		std::vector<Document> documents;
+
+		for (int i = 0; i < NUM_DOCUMENTS; i++)
+		{
+			std::wstring title = words[wordDistribution(generator)] + L" "
+				+ words[wordDistribution(generator)] + L" "
+				+ std::to_wstring(numberDistribution(generator));
+			std::wstring detail = L"C:\\Users\\Default\\" + words[wordDistribution(generator)]
+				+ L"\\" + words[wordDistribution(generator)] + L"\\" + title;
+
+			documents.push_back({ std::to_wstring(i), title, detail });
+		}
+
+		return documents;
+	}
+
+	template <typename Function>
+	double MeasureMilliseconds(Function function)
+	{
+		auto start = std::chrono::steady_clock::now();
+		function();
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+	void PrintResult(const char *name, double legacyMs, double currentMs)
+	{
+		printf("%-28s legacy: %8.2f ms  current: %8.2f ms  (%.2fx)\n", name, legacyMs, currentMs,
+			legacyMs / currentMs);
+	}
+}
+
+TEST(FuzzySearchIndexBenchmark, DISABLED_Queries)
+{
+	auto documents = GenerateDocuments();
+
+	FuzzySearchIndex index;
+
+	double buildMs = MeasureMilliseconds([&] {
+		for (const auto &document : documents)
+		{
+			index.AddOrUpdate(document.key, document.title, document.detail);
+		}
+	});
+
+	printf("Built index of %zu documents in %.2f ms (approximately %zu KB)\n", index.GetSize(),
+		buildMs, index.GetMemoryUsage() / 1024);
+
+	const std::vector<std::pair<const char *, std::wstring>> queries = { { "Word prefix", L"p" },
+		{ "Single word", L"invoices" }, { "Substring", L"load" }, { "Misspelling", L"documnts" },
+		{ "Multiple terms", L"work reports 12" }, { "Path fragment", L"default\\travel" },
+		{ "No matches", L"zzzz" } };
+
+	for (const auto &[name, query] : queries)
+	{
+		double legacyMs = MeasureMilliseconds([&] {
+			for (int i = 0; i < NUM_ITERATIONS; i++)
+			{
+				LegacySearch(documents, query);
+			}
+		});
+
+		double currentMs = MeasureMilliseconds([&] {
+			for (int i = 0; i < NUM_ITERATIONS; i++)
+			{
+				index.Search(query, MAX_RESULTS);
+			}
+		});
+
+		legacyMs /= NUM_ITERATIONS;
+		currentMs /= NUM_ITERATIONS;
+
+		PrintResult(name, legacyMs, currentMs);
+		EXPECT_LT(currentMs, MAX_QUERY_MS) << name;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,171 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "../Helper/FuzzySearchIndex.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+	std::vector<std::wstring> GetKeys(const std::vector<FuzzySearchIndex::Result> &results)
+	{
+		std::vector<std::wstring> keys;
+
+		for (const auto &result : results)
+		{
+			keys.push_back(result.key);
+		}
+
+		return keys;
+	}
+}
+
+class FuzzySearchIndexTest : public testing::Test
+{
+protected:
+	std::vector<std::wstring> Search(std::wstring_view query)
+	{
+		return GetKeys(m_index.Search(query, 10));
+	}
+
+	FuzzySearchIndex m_index;
+};
+
+TEST_F(FuzzySearchIndexTest, SubstringMatch)
+{
+	m_index.AddOrUpdate(L"1", L"Downloads", L"C:\\Users\\Default\\Downloads");
+	m_index.AddOrUpdate(L"2", L"Pictures", L"C:\\Users\\Default\\Pictures");
+
+	EXPECT_EQ(Search(L"load"), std::vector<std::wstring>{ L"1" });
+	EXPECT_EQ(Search(L"TURES"), std::vector<std::wstring>{ L"2" });
+	EXPECT_TRUE(Search(L"music").empty());
+}
+
+TEST_F(FuzzySearchIndexTest, ShortTermsMatchWordStart)
+{
+	m_index.AddOrUpdate(L"1", L"Project files", L"");
+	m_index.AddOrUpdate(L"2", L"Photos", L"");
+
+	EXPECT_EQ(Search(L"f"), std::vector<std::wstring>{ L"1" });
+	EXPECT_EQ(Search(L"ph"), std::vector<std::wstring>{ L"2" });
+
+	// "o" appears in both names, but not at the start of a word.
+	EXPECT_TRUE(Search(L"o").empty());
+}
+
+TEST_F(FuzzySearchIndexTest, TypoTolerance)
+{
+	m_index.AddOrUpdate(L"1", L"Documents", L"");
+	m_index.AddOrUpdate(L"2", L"Music", L"");
+
+	EXPECT_EQ(Search(L"documnts"), std::vector<std::wstring>{ L"1" });
+}
+
+TEST_F(FuzzySearchIndexTest, Ranking)
+{
+	m_index.AddOrUpdate(L"detail", L"Other", L"D:\\Reports");
+	m_index.AddOrUpdate(L"word", L"Annual reports", L"");
+	m_index.AddOrUpdate(L"prefix", L"Reports", L"");
+	m_index.AddOrUpdate(L"fuzzy", L"Reportz", L"");
+
+	EXPECT_EQ(Search(L"reports"),
+		(std::vector<std::wstring>{ L"prefix", L"word", L"detail", L"fuzzy" }));
+}
+
+TEST_F(FuzzySearchIndexTest, AllTermsMustMatch)
+{
+	m_index.AddOrUpdate(L"1", L"Work projects", L"C:\\Work");
+	m_index.AddOrUpdate(L"2", L"Home projects", L"C:\\Home");
+
+	EXPECT_EQ(Search(L"proj work"), std::vector<std::wstring>{ L"1" });
+	EXPECT_EQ(Search(L"  home   projects "), std::vector<std::wstring>{ L"2" });
+	EXPECT_TRUE(Search(L"home work").empty());
+	EXPECT_TRUE(Search(L"   ").empty());
+}
+
+TEST_F(FuzzySearchIndexTest, BestMatchesFoundAmongManyCandidates)
+{
+	// Each of these documents contains the term, but only in the detail text.
+	for (int i = 0; i < 1000; i++)
+	{
+		m_index.AddOrUpdate(
+			std::to_wstring(i), L"Item " + std::to_wstring(i), L"D:\\Reports\\Archive");
+	}
+
+	m_index.AddOrUpdate(L"substring", L"Old unreports", L"");
+	m_index.AddOrUpdate(L"prefix", L"Reports", L"");
+
+	EXPECT_EQ(GetKeys(m_index.Search(L"reports archive", 1)), std::vector<std::wstring>{ L"0" });
+	EXPECT_EQ(GetKeys(m_index.Search(L"reports", 3)),
+		(std::vector<std::wstring>{ L"prefix", L"substring", L"0" }));
+}
+
+TEST_F(FuzzySearchIndexTest, MaxResults)
+{
+	for (int i = 0; i < 20; i++)
+	{
+		m_index.AddOrUpdate(std::to_wstring(i), L"Folder " + std::to_wstring(i), L"");
+	}
+
+	EXPECT_EQ(m_index.Search(L"folder", 5).size(), 5U);
+	EXPECT_EQ(m_index.Search(L"folder", 50).size(), 20U);
+}
+
+TEST_F(FuzzySearchIndexTest, UpdateAndRemove)
+{
+	m_index.AddOrUpdate(L"1", L"Downloads", L"");
+	EXPECT_EQ(m_index.GetSize(), 1U);
+
+	m_index.AddOrUpdate(L"1", L"Music", L"");
+	EXPECT_EQ(m_index.GetSize(), 1U);
+	EXPECT_TRUE(Search(L"downloads").empty());
+	EXPECT_EQ(Search(L"music"), std::vector<std::wstring>{ L"1" });
+
+	m_index.Remove(L"1");
+	EXPECT_EQ(m_index.GetSize(), 0U);
+	EXPECT_TRUE(Search(L"music").empty());
+
+	// Removing an unknown key should have no effect.
+	m_index.Remove(L"2");
+}
+
+TEST_F(FuzzySearchIndexTest, Frecency)
+{
+	auto now = FuzzySearchIndex::Clock::now();
+
+	m_index.AddOrUpdate(L"unused", L"Reports 1", L"");
+	m_index.AddOrUpdate(L"old", L"Reports 2", L"");
+	m_index.AddOrUpdate(L"recent", L"Reports 3", L"");
+
+	m_index.RecordUse(L"old", now - 24h * 365);
+	m_index.RecordUse(L"recent", now - 1h);
+
+	EXPECT_EQ(GetKeys(m_index.Search(L"reports", 10, now)),
+		(std::vector<std::wstring>{ L"recent", L"old", L"unused" }));
+
+	// Usage should be retained when a document is updated.
+	m_index.AddOrUpdate(L"recent", L"Reports 4", L"");
+	EXPECT_EQ(GetKeys(m_index.Search(L"reports", 1, now)), std::vector<std::wstring>{ L"recent" });
+}
+
+TEST_F(FuzzySearchIndexTest, Compaction)
+{
+	for (int i = 0; i < 3000; i++)
+	{
+		m_index.AddOrUpdate(std::to_wstring(i), L"Item " + std::to_wstring(i), L"");
+	}
+
+	for (int i = 0; i < 2500; i++)
+	{
+		m_index.Remove(std::to_wstring(i));
+	}
+
+	EXPECT_EQ(m_index.GetSize(), 500U);
+	EXPECT_EQ(m_index.Search(L"item", 1000).size(), 500U);
+	EXPECT_EQ(Search(L"item 2999"), std::vector<std::wstring>{ L"2999" });
+	EXPECT_TRUE(Search(L"item 1234").empty());
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+// Measures the throughput of the vectorized and scalar area-averaging
+// scalers, for the sizes generated from each extracted thumbnail. These tests
+// are disabled by default and can be run with
+// --gtest_also_run_disabled_tests --gtest_filter=ImageScalingBenchmark.*
+//
+// ImageScaling doesn't depend on any Windows APIs, so this file can also be
+// built and run on Linux, e.g.:
+//
+// g++ -std=c++17 -O2 -I<dir containing an empty stdafx.h>
+//     TestExplorer++/ImageScalingBenchmark.cpp Helper/ImageScaling.cpp
+//     -lgtest -lgtest_main -pthread
+
+#include "../Helper/ImageScaling.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+using ScaleFunction = void (*)(const uint8_t *, uint32_t, uint32_t, uint8_t *, uint32_t, uint32_t);
+
+// Returns the number of source megapixels processed per second.
+double MeasureThroughput(ScaleFunction scaleFunction, const std::vector<uint8_t> &source,
+	uint32_t sourceSize, uint32_t destinationSize, int iterations)
+{
+	std::vector<uint8_t> destination(static_cast<size_t>(destinationSize) * destinationSize * 4);
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < iterations; i++)
+	{
+		scaleFunction(source.data(), sourceSize, sourceSize, destination.data(), destinationSize,
+			destinationSize);
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+
+	return (static_cast<double>(sourceSize) * sourceSize * iterations) / (seconds * 1000000);
+}
+}
+
+TEST(ImageScalingBenchmark, DISABLED_Throughput)
+{
+	const uint32_t sourceSize = 256;
+	const uint32_t destinationSizes[] = { 192, 160, 120, 96, 64 };
+	const int iterations = 2000;
+
+	std::mt19937 generator(1);
+	std::uniform_int_distribution<int> distribution(0, 255);
+
+	std::vector<uint8_t> source(sourceSize * sourceSize * 4);
+
+	for (auto &value : source)
+	{
+		value = static_cast<uint8_t>(distribution(generator));
+	}
+
+	for (uint32_t destinationSize : destinationSizes)
+	{
+		double scalar = MeasureThroughput(
+			ImageScaling::ScaleImageScalar, source, sourceSize, destinationSize, iterations);
+		double vectorized = MeasureThroughput(
+			ImageScaling::ScaleImage, source, sourceSize, destinationSize, iterations);
+
+		printf("%3u -> %3u  scalar: %8.1f MP/s  vectorized: %8.1f MP/s  (%.2fx)\n", sourceSize,
+			destinationSize, scalar, vectorized, vectorized / scalar);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "../Helper/ImageScaling.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace ImageScaling;
+
+namespace
+{
+std::vector<uint8_t> BuildRandomImage(uint32_t width, uint32_t height, unsigned int seed)
+{
+	std::mt19937 generator(seed);
+	std::uniform_int_distribution<int> distribution(0, 255);
+
+	std::vector<uint8_t> image(static_cast<size_t>(width) * height * 4);
+
+	for (auto &value : image)
+	{
+		value = static_cast<uint8_t>(distribution(generator));
+	}
+
+	return image;
+}
+
+std::vector<uint8_t> Scale(const std::vector<uint8_t> &source, uint32_t sourceWidth,
+	uint32_t sourceHeight, uint32_t destinationWidth, uint32_t destinationHeight)
+{
+	std::vector<uint8_t> destination(static_cast<size_t>(destinationWidth) * destinationHeight * 4);
+	ScaleImage(source.data(), sourceWidth, sourceHeight, destination.data(), destinationWidth,
+		destinationHeight);
+	return destination;
+}
+}
+
+TEST(ImageScalingTest, SolidColor)
+{
+	std::vector<uint8_t> source;
+
+	for (int i = 0; i < 37 * 23; i++)
+	{
+		source.insert(source.end(), { 10, 128, 250, 255 });
+	}
+
+	auto destination = Scale(source, 37, 23, 11, 7);
+
+	for (size_t i = 0; i < destination.size(); i += 4)
+	{
+		EXPECT_EQ(destination[i], 10);
+		EXPECT_EQ(destination[i + 1], 128);
+		EXPECT_EQ(destination[i + 2], 250);
+		EXPECT_EQ(destination[i + 3], 255);
+	}
+}
+
+TEST(ImageScalingTest, IntegerRatio)
+{
+	// When halving the size of an image, each destination pixel should be the
+	// exact average of a 2x2 block.
+	auto source = BuildRandomImage(8, 6, 1);
+	auto destination = Scale(source, 8, 6, 4, 3);
+
+	for (uint32_t y = 0; y < 3; y++)
+	{
+		for (uint32_t x = 0; x < 4; x++)
+		{
+			for (uint32_t channel = 0; channel < 4; channel++)
+			{
+				auto sourceValue = [&](uint32_t sourceX, uint32_t sourceY) {
+					return source[(sourceY * 8 + sourceX) * 4 + channel];
+				};
+
+				int sum = sourceValue(x * 2, y * 2) + sourceValue(x * 2 + 1, y * 2)
+					+ sourceValue(x * 2, y * 2 + 1) + sourceValue(x * 2 + 1, y * 2 + 1);
+				int expected = (sum + 2) / 4;
+
+				EXPECT_NEAR(destination[(y * 4 + x) * 4 + channel], expected, 1);
+			}
+		}
+	}
+}
+
+TEST(ImageScalingTest, FractionalRatio)
+{
+	// Scaling 3 pixels to 2 means that the middle source pixel is split evenly
+	// between the two destination pixels.
+	std::vector<uint8_t> source = { 0, 0, 0, 0, 90, 90, 90, 90, 180, 180, 180, 180 };
+	auto destination = Scale(source, 3, 1, 2, 1);
+
+	// (0 * 1 + 90 * 0.5) / 1.5 = 30 and (90 * 0.5 + 180 * 1) / 1.5 = 150
+	EXPECT_EQ(destination[0], 30);
+	EXPECT_EQ(destination[4], 150);
+}
+
+TEST(ImageScalingTest, SameSize)
+{
+	auto source = BuildRandomImage(19, 13, 2);
+	auto destination = Scale(source, 19, 13, 19, 13);
+
+	EXPECT_EQ(destination, source);
+}
+
+TEST(ImageScalingTest, PreservesAverage)
+{
+	auto source = BuildRandomImage(256, 192, 3);
+	auto destination = Scale(source, 256, 192, 1, 1);
+
+	for (uint32_t channel = 0; channel < 4; channel++)
+	{
+		double sum = 0;
+
+		for (size_t i = channel; i < source.size(); i += 4)
+		{
+			sum += source[i];
+		}
+
+		EXPECT_NEAR(destination[channel], sum / (256 * 192), 1.0);
+	}
+}
+
+TEST(ImageScalingTest, MatchesScalar)
+{
+	// Odd sizes ensure that the vectorized loops also exercise their scalar
+	// tails.
+	const std::pair<uint32_t, uint32_t> sizes[] = { { 256, 256 }, { 120, 90 }, { 97, 53 },
+		{ 33, 17 }, { 5, 3 }, { 1, 1 } };
+
+	auto source = BuildRandomImage(257, 193, 4);
+
+	for (const auto &[width, height] : sizes)
+	{
+		auto destination = Scale(source, 257, 193, width, height);
+
+		std::vector<uint8_t> expected(destination.size());
+		ScaleImageScalar(source.data(), 257, 193, expected.data(), width, height);
+
+		for (size_t i = 0; i < destination.size(); i++)
+		{
+			ASSERT_NEAR(destination[i], expected[i], 1) << width << "x" << height << " " << i;
+		}
+	}
+}
+
+TEST(ImageScalingTest, ScaleUp)
+{
+	std::vector<uint8_t> source = { 10, 20, 30, 40, 50, 60, 70, 80 };
+	auto destination = Scale(source, 2, 1, 4, 1);
+
+	std::vector<uint8_t> expected = { 10, 20, 30, 40, 10, 20, 30, 40, 50, 60, 70, 80, 50, 60, 70,
+		80 };
+	EXPECT_EQ(destination, expected);
+}
+
+TEST(ImageScalingTest, GetScaledSize)
+{
+	EXPECT_EQ(GetScaledSize(256, 256, 96, 96), std::make_pair(96u, 96u));
+	EXPECT_EQ(GetScaledSize(256, 128, 96, 96), std::make_pair(96u, 48u));
+	EXPECT_EQ(GetScaledSize(100, 250, 96, 96), std::make_pair(38u, 96u));
+	EXPECT_EQ(GetScaledSize(4000, 1, 96, 96), std::make_pair(96u, 1u));
+
+	// Images are never scaled up.
+	EXPECT_EQ(GetScaledSize(64, 32, 96, 96), std::make_pair(64u, 32u));
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "../Helper/LruCache.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+TEST(LruCacheTest, PutAndGet)
+{
+	LruCache<std::wstring, int> cache(3);
+
+	cache.Put(L"a", 1);
+	cache.Put(L"b", 2);
+
+	EXPECT_EQ(cache.Get(L"a"), 1);
+	EXPECT_EQ(cache.Get(L"b"), 2);
+	EXPECT_EQ(cache.Get(L"c"), std::nullopt);
+	EXPECT_EQ(cache.GetSize(), 2U);
+}
+
+TEST(LruCacheTest, EvictsLeastRecentlyUsed)
+{
+	LruCache<int, int> cache(2);
+
+	cache.Put(1, 10);
+	cache.Put(2, 20);
+
+	// Using the first item means that the second item is now the least
+	// recently used.
+	EXPECT_EQ(cache.Get(1), 10);
+
+	cache.Put(3, 30);
+
+	EXPECT_TRUE(cache.Contains(1));
+	EXPECT_FALSE(cache.Contains(2));
+	EXPECT_TRUE(cache.Contains(3));
+	EXPECT_EQ(cache.GetSize(), 2U);
+}
+
+TEST(LruCacheTest, ContainsDoesNotUpdateOrder)
+{
+	LruCache<int, int> cache(2);
+
+	cache.Put(1, 10);
+	cache.Put(2, 20);
+
+	EXPECT_TRUE(cache.Contains(1));
+
+	cache.Put(3, 30);
+
+	EXPECT_FALSE(cache.Contains(1));
+	EXPECT_TRUE(cache.Contains(2));
+}
+
+TEST(LruCacheTest, Replace)
+{
+	LruCache<int, int> cache(2);
+
+	cache.Put(1, 10);
+	cache.Put(2, 20);
+	cache.Put(1, 11);
+
+	EXPECT_EQ(cache.GetSize(), 2U);
+
+	cache.Put(3, 30);
+
+	// Replacing an item also marks it as the most recently used.
+	EXPECT_EQ(cache.Get(1), 11);
+	EXPECT_FALSE(cache.Contains(2));
+}
+
+TEST(LruCacheTest, RemoveAndClear)
+{
+	LruCache<int, std::shared_ptr<int>> cache(4);
+
+	auto value = std::make_shared<int>(5);
+	cache.Put(1, value);
+	cache.Put(2, std::make_shared<int>(6));
+
+	cache.Remove(1);
+	cache.Remove(7);
+	EXPECT_FALSE(cache.Contains(1));
+	EXPECT_EQ(cache.GetSize(), 1U);
+	EXPECT_EQ(value.use_count(), 1);
+
+	cache.Clear();
+	EXPECT_EQ(cache.GetSize(), 0U);
+	EXPECT_EQ(cache.Get(2), std::nullopt);
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "../Helper/MemoryAccounting.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+TEST(CountingAllocatorTest, Vector)
+{
+	MemoryCounter counter;
+
+	{
+		std::vector<int, CountingAllocator<int>> values((CountingAllocator<int>(&counter)));
+		values.reserve(100);
+		EXPECT_EQ(counter.GetBytes(), 100 * sizeof(int));
+
+		values.assign(50, 1);
+		EXPECT_EQ(counter.GetBytes(), 100 * sizeof(int));
+	}
+
+	EXPECT_EQ(counter.GetBytes(), 0U);
+}
+
+TEST(CountingAllocatorTest, UnorderedMap)
+{
+	using Map = std::unordered_map<int, std::wstring, std::hash<int>, std::equal_to<int>,
+		CountingAllocator<std::pair<const int, std::wstring>>>;
+
+	MemoryCounter counter;
+
+	{
+		Map map(0, std::hash<int>(), std::equal_to<int>(), Map::allocator_type(&counter));
+
+		for (int i = 0; i < 100; i++)
+		{
+			map.insert({ i, L"Item" });
+		}
+
+		// Each node will be at least as large as the value it contains.
+		std::size_t bytesUsed = counter.GetBytes();
+		EXPECT_GE(bytesUsed, 100 * sizeof(Map::value_type));
+
+		map.erase(0);
+		EXPECT_LT(counter.GetBytes(), bytesUsed);
+	}
+
+	EXPECT_EQ(counter.GetBytes(), 0U);
+}
+
+TEST(CountingAllocatorTest, Equality)
+{
+	MemoryCounter counter1;
+	MemoryCounter counter2;
+
+	EXPECT_EQ(CountingAllocator<int>(&counter1), CountingAllocator<char>(&counter1));
+	EXPECT_NE(CountingAllocator<int>(&counter1), CountingAllocator<int>(&counter2));
+}
+
+TEST(CountingReallocTest, AllocateResizeFree)
+{
+	MemoryCounter counter;
+
+	// When allocating a new block, Lua passes a type code in place of the
+	// old size.
+	void *ptr = CountingRealloc(&counter, nullptr, 5, 64);
+	ASSERT_NE(ptr, nullptr);
+	EXPECT_EQ(counter.GetBytes(), 64U);
+
+	ptr = CountingRealloc(&counter, ptr, 64, 256);
+	ASSERT_NE(ptr, nullptr);
+	EXPECT_EQ(counter.GetBytes(), 256U);
+
+	ptr = CountingRealloc(&counter, ptr, 256, 16);
+	ASSERT_NE(ptr, nullptr);
+	EXPECT_EQ(counter.GetBytes(), 16U);
+
+	EXPECT_EQ(CountingRealloc(&counter, ptr, 16, 0), nullptr);
+	EXPECT_EQ(counter.GetBytes(), 0U);
+}
+
+TEST(MemoryAccountantTest, AggregatesEntries)
+{
+	MemoryAccountant accountant;
+
+	MemoryCounter counter1;
+	counter1.Add(100);
+	MemoryCounter counter2;
+	counter2.Add(50);
+
+	auto registration1 = accountant.AddCounter(L"Items", 1, &counter1);
+	auto registration2 = accountant.AddCounter(L"Items", 1, &counter2);
+	auto registration3 = accountant.AddSource(L"Thumbnails", 1, [] { return 30; });
+	auto registration4 = accountant.AddSource(L"Items", 2, [] { return 20; });
+	auto registration5 = accountant.AddSource(L"Icon cache", std::nullopt, [] { return 10; });
+
+	auto entries = accountant.GetEntries();
+	ASSERT_EQ(entries.size(), 4U);
+
+	EXPECT_EQ(entries[0].category, L"Icon cache");
+	EXPECT_EQ(entries[0].tabId, std::nullopt);
+	EXPECT_EQ(entries[0].bytes, 10U);
+
+	EXPECT_EQ(entries[1].category, L"Items");
+	EXPECT_EQ(entries[1].tabId, 1);
+	EXPECT_EQ(entries[1].bytes, 150U);
+
+	EXPECT_EQ(entries[2].category, L"Thumbnails");
+	EXPECT_EQ(entries[2].tabId, 1);
+	EXPECT_EQ(entries[2].bytes, 30U);
+
+	EXPECT_EQ(entries[3].category, L"Items");
+	EXPECT_EQ(entries[3].tabId, 2);
+	EXPECT_EQ(entries[3].bytes, 20U);
+
+	// The counter is read each time the entries are retrieved.
+	counter2.Subtract(50);
+	EXPECT_EQ(accountant.GetEntries()[1].bytes, 100U);
+}
+
+TEST(MemoryAccountantTest, Registration)
+{
+	MemoryAccountant accountant;
+
+	{
+		auto registration = accountant.AddSource(L"Items", 1, [] { return 10; });
+		EXPECT_EQ(accountant.GetEntries().size(), 1U);
+
+		MemoryAccountant::Registration movedRegistration = std::move(registration);
+		EXPECT_EQ(accountant.GetEntries().size(), 1U);
+	}
+
+	EXPECT_TRUE(accountant.GetEntries().empty());
+}
+
+TEST(MemoryAccountantTest, RegistrationOutlivesAccountant)
+{
+	MemoryAccountant::Registration registration;
+
+	{
+		MemoryAccountant accountant;
+		registration = accountant.AddSource(L"Items", 1, [] { return 10; });
+	}
+
+	// Destroying the registration here shouldn't have any effect.
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "../Helper/PerfectHash.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+enum class Color
+{
+	Red,
+	Green,
+	Blue,
+	Yellow,
+	Cyan
+};
+
+constexpr auto COLORS = MakePerfectHashMap<Color>({ { L"Red", Color::Red },
+	{ L"Green", Color::Green }, { L"Blue", Color::Blue }, { L"Yellow", Color::Yellow },
+	{ L"Cyan", Color::Cyan } });
+}
+
+TEST(PerfectHashTest, Find)
+{
+	EXPECT_EQ(COLORS.Find(L"Red"), Color::Red);
+	EXPECT_EQ(COLORS.Find(L"Green"), Color::Green);
+	EXPECT_EQ(COLORS.Find(L"Blue"), Color::Blue);
+	EXPECT_EQ(COLORS.Find(L"Yellow"), Color::Yellow);
+	EXPECT_EQ(COLORS.Find(L"Cyan"), Color::Cyan);
+
+	EXPECT_EQ(COLORS.Find(L"red"), std::nullopt);
+	EXPECT_EQ(COLORS.Find(L""), std::nullopt);
+	EXPECT_EQ(COLORS.Find(L"Magenta"), std::nullopt);
+}
+
+TEST(PerfectHashTest, CompileTimeLookup)
+{
+	static_assert(COLORS.Find(L"Blue") == Color::Blue);
+	static_assert(!COLORS.Find(L"Black"));
+	static_assert(COLORS.GetSize() == 5);
+}
+
+TEST(PerfectHashTest, ManyKeys)
+{
+	// Generates a large set of similar keys at compile time, to check that a
+	// table can still be built.
+	constexpr std::pair<std::wstring_view, int> entries[] = { { L"Setting0", 0 },
+		{ L"Setting1", 1 }, { L"Setting2", 2 }, { L"Setting3", 3 }, { L"Setting4", 4 },
+		{ L"Setting5", 5 }, { L"Setting6", 6 }, { L"Setting7", 7 }, { L"Setting8", 8 },
+		{ L"Setting9", 9 }, { L"Setting10", 10 }, { L"Setting11", 11 }, { L"Setting12", 12 },
+		{ L"Setting13", 13 }, { L"Setting14", 14 }, { L"Setting15", 15 }, { L"Setting16", 16 },
+		{ L"Setting17", 17 }, { L"Setting18", 18 }, { L"Setting19", 19 }, { L"Setting20", 20 },
+		{ L"Setting21", 21 }, { L"Setting22", 22 }, { L"Setting23", 23 }, { L"Setting24", 24 },
+		{ L"Setting25", 25 }, { L"Setting26", 26 }, { L"Setting27", 27 }, { L"Setting28", 28 },
+		{ L"Setting29", 29 }, { L"Setting30", 30 }, { L"Setting31", 31 } };
+	constexpr auto map = MakePerfectHashMap(entries);
+
+	for (const auto &[key, value] : entries)
+	{
+		EXPECT_EQ(map.Find(key), value);
+		EXPECT_EQ(map.Find(std::wstring(key) + L"x"), std::nullopt);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#define STRICT_TYPED_ITEMIDS
+
+#include "../Explorer++/PreservedTab.h"
+#include "../Explorer++/ShellBrowser/HistoryEntry.h"
+#include "../Explorer++/ShellBrowser/PreservedHistoryEntry.h"
+#include "../Explorer++/Tab.h"
+#include "../Helper/ShellHelper.h"
+#include <gtest/gtest.h>
+#include <ShlObj.h>
+
+namespace
+{
+unique_pidl_absolute CreateSimplePidl(const std::wstring &path)
+{
+	return unique_pidl_absolute(SHSimpleIDListFromPath(path.c_str()));
+}
+
+std::unique_ptr<PreservedHistoryEntry> CreatePreservedHistoryEntry(const std::wstring &path)
+{
+	auto pidl = CreateSimplePidl(path);
+	return std::make_unique<PreservedHistoryEntry>(HistoryEntry(pidl.get(), path));
+}
+}
+
+TEST(PreservedTabTest, NeverLoadedTab)
+{
+	UnloadedTabState unloadedState;
+	unloadedState.pidlDirectory = CreateSimplePidl(L"C:\\Fake");
+	ASSERT_TRUE(unloadedState.pidlDirectory);
+
+	Tab tab(std::move(unloadedState), nullptr, nullptr, nullptr);
+	ASSERT_FALSE(tab.IsLoaded());
+
+	PreservedTab preservedTab(tab, 0);
+
+	// The only entry should be the directory the tab was created in.
+	ASSERT_EQ(preservedTab.history.size(), 1U);
+	EXPECT_EQ(preservedTab.currentEntry, 0);
+
+	auto pidlDirectory = CreateSimplePidl(L"C:\\Fake");
+	EXPECT_TRUE(CompareIdls(preservedTab.history[0]->pidl.get(), pidlDirectory.get()));
+}
+
+TEST(PreservedTabTest, HibernatedTab)
+{
+	const std::wstring paths[] = { L"C:\\Fake1", L"C:\\Fake2", L"C:\\Fake3" };
+
+	UnloadedTabState unloadedState;
+	unloadedState.pidlDirectory = CreateSimplePidl(paths[1]);
+	ASSERT_TRUE(unloadedState.pidlDirectory);
+
+	for (const auto &path : paths)
+	{
+		unloadedState.history.push_back(CreatePreservedHistoryEntry(path));
+	}
+
+	unloadedState.currentEntry = 1;
+
+	Tab tab(std::move(unloadedState), nullptr, nullptr, nullptr);
+	ASSERT_FALSE(tab.IsLoaded());
+
+	PreservedTab preservedTab(tab, 0);
+
+	// The back and forward history of a hibernated tab should be retained.
+	ASSERT_EQ(preservedTab.history.size(), std::size(paths));
+	EXPECT_EQ(preservedTab.currentEntry, 1);
+
+	for (size_t i = 0; i < std::size(paths); i++)
+	{
+		auto pidl = CreateSimplePidl(paths[i]);
+		EXPECT_TRUE(CompareIdls(preservedTab.history[i]->pidl.get(), pidl.get()));
+		EXPECT_EQ(preservedTab.history[i]->displayName, paths[i]);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,237 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+// Stress tests SharedDirectoryMonitor against a real file system, using the
+// inotify backend. Many subscribers watch the same set of directories while
+// files are created in them, and every subscriber is expected to see every
+// change. These tests are disabled by default and can be run with
+// --gtest_also_run_disabled_tests --gtest_filter=SharedDirectoryMonitorStressTest.*
+//
+// The inotify backend is Linux-only, so this file isn't part of the Visual
+// Studio project. It can be built with, e.g.:
+//
+// g++ -std=c++17 -O2 -I<dir containing an empty stdafx.h>
+//     TestExplorer++/SharedDirectoryMonitorStressTest.cpp
+//     Helper/SharedDirectoryMonitor.cpp Helper/InotifyDirectoryChangeBackend.cpp
+//     Helper/BufferPool.cpp -lgtest -lgtest_main -pthread
+
+#include "../Helper/InotifyDirectoryChangeBackend.h"
+#include "../Helper/SharedDirectoryMonitor.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+std::filesystem::path CreateTemporaryDirectory()
+{
+	auto path = std::filesystem::temp_directory_path()
+		/ ("SharedDirectoryMonitorStressTest-"
+			+ std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+	std::filesystem::create_directories(path);
+	return path;
+}
+
+bool WaitForCount(const std::atomic<int> &count, int expected)
+{
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+
+	while (count < expected)
+	{
+		if (std::chrono::steady_clock::now() > deadline)
+		{
+			return false;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	return true;
+}
+}
+
+TEST(SharedDirectoryMonitorStressTest, DISABLED_ManySubscribers)
+{
+	const int numDirectories = 8;
+	const int subscribersPerDirectory = 32;
+	const int filesPerDirectory = 500;
+
+	std::filesystem::path root = CreateTemporaryDirectory();
+
+	auto backend = InotifyDirectoryChangeBackend::Create();
+	ASSERT_NE(backend, nullptr);
+	SharedDirectoryMonitor monitor(std::move(backend));
+
+	std::vector<std::filesystem::path> directories;
+	std::vector<std::atomic<int>> counts(numDirectories * subscribersPerDirectory);
+	std::vector<int> subscriptionIds;
+
+	for (int i = 0; i < numDirectories; i++)
+	{
+		directories.push_back(root / std::to_string(i));
+		std::filesystem::create_directory(directories.back());
+
+		for (int j = 0; j < subscribersPerDirectory; j++)
+		{
+			std::atomic<int> &count = counts[i * subscribersPerDirectory + j];
+
+			auto subscriptionId = monitor.Subscribe(
+				{ directories.back().wstring(), DirectoryChangeFilter::FileName, false },
+				[&count](const std::wstring &fileName, DirectoryChangeAction action)
+				{
+					if (action == DirectoryChangeAction::Added && !fileName.empty())
+					{
+						count++;
+					}
+				});
+			ASSERT_TRUE(subscriptionId);
+			subscriptionIds.push_back(*subscriptionId);
+		}
+	}
+
+	EXPECT_EQ(monitor.GetNumWatches(), static_cast<size_t>(numDirectories));
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < filesPerDirectory; i++)
+	{
+		for (const auto &directory : directories)
+		{
+			std::ofstream(directory / ("file" + std::to_string(i) + ".txt"));
+		}
+	}
+
+	for (const auto &count : counts)
+	{
+		EXPECT_TRUE(WaitForCount(count, filesPerDirectory));
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+	int totalEvents = numDirectories * subscribersPerDirectory * filesPerDirectory;
+
+	printf("%d callbacks in %.3f seconds (%.0f callbacks/second)\n", totalEvents, seconds,
+		totalEvents / seconds);
+
+	for (int subscriptionId : subscriptionIds)
+	{
+		monitor.Unsubscribe(subscriptionId);
+	}
+
+	EXPECT_EQ(monitor.GetNumWatches(), 0U);
+
+	std::filesystem::remove_all(root);
+}
+
+TEST(SharedDirectoryMonitorStressTest, DISABLED_SubscribeWhileChanging)
+{
+	const int iterations = 2000;
+
+	std::filesystem::path root = CreateTemporaryDirectory();
+
+	auto backend = InotifyDirectoryChangeBackend::Create();
+	ASSERT_NE(backend, nullptr);
+	SharedDirectoryMonitor monitor(std::move(backend));
+
+	std::atomic<bool> stop = false;
+
+	// Continuously creates and deletes files, so that events are being
+	// dispatched while subscriptions are being added and removed.
+	std::thread writer(
+		[&root, &stop]
+		{
+			int i = 0;
+
+			while (!stop)
+			{
+				auto path = root / ("file" + std::to_string(i++ % 100) + ".txt");
+				std::ofstream(path).put('a');
+				std::filesystem::remove(path);
+			}
+		});
+
+	std::atomic<int> numCallbacks = 0;
+
+	for (int i = 0; i < iterations; i++)
+	{
+		auto subscriptionId =
+			monitor.Subscribe({ root.wstring(), DirectoryChangeFilter::FileName, false },
+				[&numCallbacks](const std::wstring &, DirectoryChangeAction) { numCallbacks++; });
+		ASSERT_TRUE(subscriptionId);
+
+		monitor.Unsubscribe(*subscriptionId);
+		EXPECT_EQ(monitor.GetNumWatches(), 0U);
+	}
+
+	stop = true;
+	writer.join();
+
+	printf("%d callbacks received across %d subscriptions\n", numCallbacks.load(), iterations);
+
+	std::filesystem::remove_all(root);
+}
+
+
+TEST(SharedDirectoryMonitorStressTest, DISABLED_SubtreeWatch)
+{
+	const int depth = 20;
+
+	std::filesystem::path root = CreateTemporaryDirectory();
+
+	auto backend = InotifyDirectoryChangeBackend::Create();
+	ASSERT_NE(backend, nullptr);
+	SharedDirectoryMonitor monitor(std::move(backend));
+
+	std::mutex mutex;
+	std::set<std::wstring> fileNames;
+	std::atomic<int> numFiles = 0;
+
+	DirectoryWatchRequest request = { root.wstring(),
+		DirectoryChangeFilter::FileName | DirectoryChangeFilter::DirName, true };
+	auto subscriptionId = monitor.Subscribe(request,
+		[&mutex, &fileNames, &numFiles](const std::wstring &fileName, DirectoryChangeAction action)
+		{
+			if (action == DirectoryChangeAction::Added
+				&& fileName.size() >= 4 && fileName.substr(fileName.size() - 4) == L".txt")
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				fileNames.insert(fileName);
+				numFiles++;
+			}
+		});
+	ASSERT_TRUE(subscriptionId);
+
+	// Each directory is created after the watch has started, so it has to be
+	// picked up as it's created.
+	std::filesystem::path directory = root;
+	std::wstring relativeDirectory;
+
+	for (int i = 0; i < depth; i++)
+	{
+		directory /= "d";
+		relativeDirectory += L"d/";
+		std::filesystem::create_directory(directory);
+
+		// Gives the backend a chance to add the new directory before the file
+		// is created in it.
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+		std::ofstream(directory / "file.txt");
+	}
+
+	EXPECT_TRUE(WaitForCount(numFiles, depth));
+
+	std::lock_guard<std::mutex> lock(mutex);
+	EXPECT_EQ(fileNames.count(relativeDirectory + L"file.txt"), 1U);
+
+	std::filesystem::remove_all(root);
+}
\ No newline at end of file
@@ -0,0 +1,259 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "../Helper/SharedDirectoryMonitor.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace
+{
+// Events are only delivered when the test posts them.
+class FakeDirectoryChangeBackend : public DirectoryChangeBackend
+{
+public:
+	std::optional<int> AddWatch(const DirectoryWatchRequest &request) override
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (request.path == L"C:\\Missing")
+		{
+			return std::nullopt;
+		}
+
+		int watchId = m_watchIdCounter++;
+		m_activeWatchIds.insert(watchId);
+		return watchId;
+	}
+
+	void RemoveWatch(int watchId) override
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_activeWatchIds.erase(watchId);
+	}
+
+	void WaitForEvents(std::vector<DirectoryChangeEvent> &events) override
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cv.wait(lock, [this] { return m_woken || !m_pendingEvents.empty(); });
+
+		events.insert(events.end(), m_pendingEvents.begin(), m_pendingEvents.end());
+		m_pendingEvents.clear();
+		m_woken = false;
+	}
+
+	void Wake() override
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_woken = true;
+		m_cv.notify_one();
+	}
+
+	void PostEvent(int watchId, const std::wstring &fileName)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pendingEvents.push_back({ watchId, DirectoryChangeAction::Added, fileName });
+		m_cv.notify_one();
+	}
+
+	std::set<int> GetActiveWatchIds()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_activeWatchIds;
+	}
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::deque<DirectoryChangeEvent> m_pendingEvents;
+	std::set<int> m_activeWatchIds;
+	bool m_woken = false;
+	int m_watchIdCounter = 1;
+};
+
+// Records the names passed to a subscription's callback.
+class Recorder
+{
+public:
+	SharedDirectoryMonitor::Callback GetCallback()
+	{
+		return [this](const std::wstring &fileName, DirectoryChangeAction)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_fileNames.push_back(fileName);
+			m_cv.notify_all();
+		};
+	}
+
+	std::vector<std::wstring> WaitForFileNames(size_t count)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cv.wait_for(
+			lock, std::chrono::seconds(5), [this, count] { return m_fileNames.size() >= count; });
+		return m_fileNames;
+	}
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::vector<std::wstring> m_fileNames;
+};
+
+DirectoryWatchRequest MakeRequest(const std::wstring &path, uint32_t filter)
+{
+	return { path, filter, false };
+}
+}
+
+class SharedDirectoryMonitorTest : public testing::Test
+{
+protected:
+	SharedDirectoryMonitorTest()
+	{
+		auto backend = std::make_unique<FakeDirectoryChangeBackend>();
+		m_backend = backend.get();
+		m_monitor = std::make_unique<SharedDirectoryMonitor>(std::move(backend));
+	}
+
+	FakeDirectoryChangeBackend *m_backend;
+	std::unique_ptr<SharedDirectoryMonitor> m_monitor;
+};
+
+TEST_F(SharedDirectoryMonitorTest, SharesWatchesForSameDirectory)
+{
+	Recorder recorder1;
+	Recorder recorder2;
+
+	auto subscription1 = m_monitor->Subscribe(
+		MakeRequest(L"C:\\Folder", DirectoryChangeFilter::FileName), recorder1.GetCallback());
+	auto subscription2 = m_monitor->Subscribe(
+		MakeRequest(L"C:\\Folder\\", DirectoryChangeFilter::FileName), recorder2.GetCallback());
+	ASSERT_TRUE(subscription1);
+	ASSERT_TRUE(subscription2);
+	EXPECT_NE(*subscription1, *subscription2);
+
+	EXPECT_EQ(m_monitor->GetNumWatches(), 1U);
+	ASSERT_EQ(m_backend->GetActiveWatchIds().size(), 1U);
+
+	int watchId = *m_backend->GetActiveWatchIds().begin();
+	m_backend->PostEvent(watchId, L"file.txt");
+
+	EXPECT_EQ(recorder1.WaitForFileNames(1), std::vector<std::wstring>{ L"file.txt" });
+	EXPECT_EQ(recorder2.WaitForFileNames(1), std::vector<std::wstring>{ L"file.txt" });
+}
+
+TEST_F(SharedDirectoryMonitorTest, DifferentFiltersUseSeparateWatches)
+{
+	Recorder recorder1;
+	Recorder recorder2;
+
+	auto subscription1 = m_monitor->Subscribe(
+		MakeRequest(L"C:\\Folder", DirectoryChangeFilter::FileName), recorder1.GetCallback());
+	auto subscription2 = m_monitor->Subscribe(
+		MakeRequest(L"C:\\Folder", DirectoryChangeFilter::DirName), recorder2.GetCallback());
+	ASSERT_TRUE(subscription1);
+	ASSERT_TRUE(subscription2);
+
+	EXPECT_EQ(m_monitor->GetNumWatches(), 2U);
+	EXPECT_EQ(m_backend->GetActiveWatchIds().size(), 2U);
+}
+
+TEST_F(SharedDirectoryMonitorTest, WatchRemovedWithLastSubscriber)
+{
+	Recorder recorder1;
+	Recorder recorder2;
+
+	auto subscription1 = m_monitor->Subscribe(
+		MakeRequest(L"C:\\Folder", DirectoryChangeFilter::FileName), recorder1.GetCallback());
+	auto subscription2 = m_monitor->Subscribe(
+		MakeRequest(L"C:\\Folder", DirectoryChangeFilter::FileName), recorder2.GetCallback());
+	ASSERT_TRUE(subscription1);
+	ASSERT_TRUE(subscription2);
+
+	m_monitor->Unsubscribe(*subscription1);
+	EXPECT_EQ(m_monitor->GetNumWatches(), 1U);
+	EXPECT_EQ(m_backend->GetActiveWatchIds().size(), 1U);
+
+	m_monitor->Unsubscribe(*subscription2);
+	EXPECT_EQ(m_monitor->GetNumWatches(), 0U);
+	EXPECT_TRUE(m_backend->GetActiveWatchIds().empty());
+}
+
+TEST_F(SharedDirectoryMonitorTest, UnsubscribedCallbackNotInvoked)
+{
+	Recorder recorder1;
+	Recorder recorder2;
+
+	auto subscription1 = m_monitor->Subscribe(
+		MakeRequest(L"C:\\Folder", DirectoryChangeFilter::FileName), recorder1.GetCallback());
+	auto subscription2 = m_monitor->Subscribe(
+		MakeRequest(L"C:\\Folder", DirectoryChangeFilter::FileName), recorder2.GetCallback());
+	ASSERT_TRUE(subscription1);
+	ASSERT_TRUE(subscription2);
+
+	int watchId = *m_backend->GetActiveWatchIds().begin();
+
+	m_monitor->Unsubscribe(*subscription1);
+	m_backend->PostEvent(watchId, L"file.txt");
+
+	EXPECT_EQ(recorder2.WaitForFileNames(1).size(), 1U);
+	EXPECT_TRUE(recorder1.WaitForFileNames(0).empty());
+}
+
+TEST_F(SharedDirectoryMonitorTest, FailedWatch)
+{
+	Recorder recorder;
+
+	auto subscription = m_monitor->Subscribe(
+		MakeRequest(L"C:\\Missing", DirectoryChangeFilter::FileName), recorder.GetCallback());
+	EXPECT_FALSE(subscription);
+	EXPECT_EQ(m_monitor->GetNumWatches(), 0U);
+}
+
+TEST_F(SharedDirectoryMonitorTest, ExclusiveWatchNotShared)
+{
+	Recorder recorder1;
+	Recorder recorder2;
+
+	auto watchId =
+		m_backend->AddWatch(MakeRequest(L"C:\\Folder", DirectoryChangeFilter::FileName));
+	ASSERT_TRUE(watchId);
+
+	int subscription1 = m_monitor->SubscribeToExclusiveWatch(*watchId, recorder1.GetCallback());
+	auto subscription2 = m_monitor->Subscribe(
+		MakeRequest(L"C:\\Folder", DirectoryChangeFilter::FileName), recorder2.GetCallback());
+	ASSERT_TRUE(subscription2);
+
+	EXPECT_EQ(m_monitor->GetNumWatches(), 2U);
+
+	m_monitor->Unsubscribe(subscription1);
+	EXPECT_EQ(m_backend->GetActiveWatchIds().count(*watchId), 0U);
+	EXPECT_EQ(m_monitor->GetNumWatches(), 1U);
+}
+
+TEST_F(SharedDirectoryMonitorTest, UnsubscribeFromCallback)
+{
+	std::optional<int> subscription;
+	Recorder recorder;
+	auto recorderCallback = recorder.GetCallback();
+
+	subscription = m_monitor->Subscribe(MakeRequest(L"C:\\Folder", DirectoryChangeFilter::FileName),
+		[this, &subscription, recorderCallback](
+			const std::wstring &fileName, DirectoryChangeAction action)
+		{
+			m_monitor->Unsubscribe(*subscription);
+			recorderCallback(fileName, action);
+		});
+	ASSERT_TRUE(subscription);
+
+	int watchId = *m_backend->GetActiveWatchIds().begin();
+	m_backend->PostEvent(watchId, L"file.txt");
+
+	EXPECT_EQ(recorder.WaitForFileNames(1).size(), 1U);
+	EXPECT_EQ(m_monitor->GetNumWatches(), 0U);
+}
\ No newline at end of file
@@ -27,6 +27,11 @@ public:
 		return S_OK;
 	}
 
+	HRESULT BrowseFolderFromHistory(PCIDLIST_ABSOLUTE pidlDirectory) override
+	{
+		return BrowseFolder(pidlDirectory, false);
+	}
+
 	boost::signals2::connection AddNavigationCompletedObserver(
 		const NavigationCompletedSignal::slot_type &observer,
 		boost::signals2::connect_position position = boost::signals2::at_back) override
@@ -48,6 +53,11 @@ public:
 				return m_fake.BrowseFolder(pidlDirectory, addHistoryEntry);
 			});
 
+		ON_CALL(*this, BrowseFolderFromHistoryImpl)
+			.WillByDefault([this](PCIDLIST_ABSOLUTE pidlDirectory) {
+				return m_fake.BrowseFolderFromHistory(pidlDirectory);
+			});
+
 		ON_CALL(*this, AddNavigationCompletedObserverImpl)
 			.WillByDefault([this](const NavigationCompletedSignal::slot_type &observer,
 							   boost::signals2::connect_position position) {
@@ -56,6 +66,7 @@ public:
 	}
 
 	MOCK_METHOD(HRESULT, BrowseFolderImpl, (PCIDLIST_ABSOLUTE pidlDirectory, bool addHistoryEntry));
+	MOCK_METHOD(HRESULT, BrowseFolderFromHistoryImpl, (PCIDLIST_ABSOLUTE pidlDirectory));
 	MOCK_METHOD(boost::signals2::connection, AddNavigationCompletedObserverImpl,
 		(const NavigationCompletedSignal::slot_type &observer,
 			boost::signals2::connect_position position));
@@ -65,6 +76,11 @@ public:
 		return BrowseFolderImpl(pidlDirectory, addHistoryEntry);
 	}
 
+	HRESULT BrowseFolderFromHistory(PCIDLIST_ABSOLUTE pidlDirectory) override
+	{
+		return BrowseFolderFromHistoryImpl(pidlDirectory);
+	}
+
 	boost::signals2::connection AddNavigationCompletedObserver(
 		const NavigationCompletedSignal::slot_type &observer,
 		boost::signals2::connect_position position = boost::signals2::at_back) override
@@ -240,6 +256,51 @@ TEST_F(ShellNavigationControllerTest, BackForward)
 	EXPECT_EQ(m_navigationController.GetNumHistoryEntries(), 2);
 }
 
+TEST_F(ShellNavigationControllerTest, HistoryNavigation)
+{
+	unique_pidl_absolute pidl1(SHSimpleIDListFromPath(L"C:\\Fake1"));
+	ASSERT_TRUE(pidl1);
+
+	unique_pidl_absolute pidl2(SHSimpleIDListFromPath(L"C:\\Fake2"));
+	ASSERT_TRUE(pidl2);
+
+	auto matchesPidl = [](PCIDLIST_ABSOLUTE expectedPidl) {
+		return Truly([expectedPidl](PCIDLIST_ABSOLUTE pidl) {
+			return CompareIdls(pidl, expectedPidl) != FALSE;
+		});
+	};
+
+	HRESULT hr = m_navigationController.BrowseFolder(pidl1.get());
+	ASSERT_HRESULT_SUCCEEDED(hr);
+
+	hr = m_navigationController.BrowseFolder(pidl2.get());
+	ASSERT_HRESULT_SUCCEEDED(hr);
+
+	// Going back or forward should allow the navigator to use a cached listing
+	// for the folder.
+	EXPECT_CALL(m_navigator, BrowseFolderImpl).Times(0);
+	EXPECT_CALL(m_navigator, BrowseFolderFromHistoryImpl(matchesPidl(pidl1.get())));
+
+	hr = m_navigationController.GoBack();
+	ASSERT_HRESULT_SUCCEEDED(hr);
+	Mock::VerifyAndClearExpectations(&m_navigator);
+
+	EXPECT_CALL(m_navigator, BrowseFolderImpl).Times(0);
+	EXPECT_CALL(m_navigator, BrowseFolderFromHistoryImpl(matchesPidl(pidl2.get())));
+
+	hr = m_navigationController.GoForward();
+	ASSERT_HRESULT_SUCCEEDED(hr);
+	Mock::VerifyAndClearExpectations(&m_navigator);
+
+	// Refreshing, on the other hand, should always result in the folder being
+	// enumerated again.
+	EXPECT_CALL(m_navigator, BrowseFolderImpl(matchesPidl(pidl2.get()), false));
+	EXPECT_CALL(m_navigator, BrowseFolderFromHistoryImpl).Times(0);
+
+	hr = m_navigationController.Refresh();
+	ASSERT_HRESULT_SUCCEEDED(hr);
+}
+
 TEST_F(ShellNavigationControllerTest, RetrieveHistory)
 {
 	HRESULT hr = NavigateToFolder(L"C:\\Fake1");
@@ -0,0 +1,91 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "../Explorer++/TabHibernationPolicy.h"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+using namespace testing;
+
+namespace
+{
+const size_t MB = 1024 * 1024;
+
+class TabHibernationPolicyTest : public Test
+{
+protected:
+	TabHibernationCandidate MakeCandidate(
+		int tabId, std::chrono::minutes idleTime, size_t memoryUsage = MB)
+	{
+		return { tabId, m_now - idleTime, memoryUsage };
+	}
+
+	const std::chrono::steady_clock::time_point m_now = std::chrono::steady_clock::now();
+};
+}
+
+TEST_F(TabHibernationPolicyTest, DisabledLimits)
+{
+	std::vector<TabHibernationCandidate> candidates = { MakeCandidate(1, 600min, 500 * MB),
+		MakeCandidate(2, 1200min, 500 * MB) };
+
+	TabHibernationLimits limits = { 0min, 0 };
+	EXPECT_THAT(SelectTabsToHibernate(candidates, 500 * MB, limits, m_now), IsEmpty());
+}
+
+TEST_F(TabHibernationPolicyTest, IdleTimeout)
+{
+	std::vector<TabHibernationCandidate> candidates = { MakeCandidate(1, 5min),
+		MakeCandidate(2, 30min), MakeCandidate(3, 10min), MakeCandidate(4, 60min) };
+
+	TabHibernationLimits limits = { 10min, 0 };
+
+	// Tabs that have been idle for exactly the timeout should be included.
+	EXPECT_THAT(SelectTabsToHibernate(candidates, 0, limits, m_now), ElementsAre(4, 2, 3));
+}
+
+TEST_F(TabHibernationPolicyTest, MemoryBudget)
+{
+	std::vector<TabHibernationCandidate> candidates = { MakeCandidate(1, 1min, 40 * MB),
+		MakeCandidate(2, 3min, 30 * MB), MakeCandidate(3, 2min, 20 * MB),
+		MakeCandidate(4, 0min, 10 * MB) };
+
+	// The total usage is 140MB. Hibernating the least recently used tab only
+	// brings that down to 110MB, so the next tab also needs to be hibernated.
+	TabHibernationLimits limits = { 0min, 100 * MB };
+	EXPECT_THAT(SelectTabsToHibernate(candidates, 40 * MB, limits, m_now), ElementsAre(2, 3));
+}
+
+TEST_F(TabHibernationPolicyTest, WithinMemoryBudget)
+{
+	std::vector<TabHibernationCandidate> candidates = { MakeCandidate(1, 1min, 40 * MB),
+		MakeCandidate(2, 3min, 30 * MB) };
+
+	TabHibernationLimits limits = { 0min, 100 * MB };
+	EXPECT_THAT(SelectTabsToHibernate(candidates, 30 * MB, limits, m_now), IsEmpty());
+}
+
+TEST_F(TabHibernationPolicyTest, OtherMemoryExceedsBudget)
+{
+	std::vector<TabHibernationCandidate> candidates = { MakeCandidate(1, 1min, 10 * MB),
+		MakeCandidate(2, 3min, 10 * MB) };
+
+	// Memory used by tabs that can't be hibernated can't be reclaimed, so every
+	// candidate will be hibernated.
+	TabHibernationLimits limits = { 0min, 100 * MB };
+	EXPECT_THAT(SelectTabsToHibernate(candidates, 200 * MB, limits, m_now), ElementsAre(2, 1));
+}
+
+TEST_F(TabHibernationPolicyTest, IdleTimeoutAndMemoryBudget)
+{
+	std::vector<TabHibernationCandidate> candidates = { MakeCandidate(1, 1min, 60 * MB),
+		MakeCandidate(2, 20min, 10 * MB), MakeCandidate(3, 2min, 50 * MB),
+		MakeCandidate(4, 30min, 10 * MB) };
+
+	// Tabs 4 and 2 are idle. Once they're hibernated, the usage is still
+	// 110MB, so tab 3 is also hibernated.
+	TabHibernationLimits limits = { 15min, 100 * MB };
+	EXPECT_THAT(SelectTabsToHibernate(candidates, 0, limits, m_now), ElementsAre(4, 2, 3));
+}
\ No newline at end of file
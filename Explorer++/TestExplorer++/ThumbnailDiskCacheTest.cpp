@@ -0,0 +1,286 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "../Helper/ThumbnailDiskCache.h"
+#include <gtest/gtest.h>
+#include <fstream>
+
+namespace
+{
+ThumbnailKey BuildKey(uint64_t pathHash, uint64_t lastWriteTime = 1000)
+{
+	return { pathHash, 4096, lastWriteTime, 120, 120 };
+}
+
+ThumbnailImage BuildImage(uint32_t width, uint32_t height, uint8_t seed)
+{
+	ThumbnailImage image;
+	image.width = width;
+	image.height = height;
+
+	for (uint32_t i = 0; i < width * height * 4; i++)
+	{
+		image.pixels.push_back(static_cast<uint8_t>(seed + i));
+	}
+
+	return image;
+}
+
+void ExpectImagesEqual(const ThumbnailImage &expected, const std::optional<ThumbnailImage> &actual)
+{
+	ASSERT_TRUE(actual.has_value());
+	EXPECT_EQ(actual->width, expected.width);
+	EXPECT_EQ(actual->height, expected.height);
+	EXPECT_EQ(actual->pixels, expected.pixels);
+}
+}
+
+class ThumbnailDiskCacheTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		auto testInfo = testing::UnitTest::GetInstance()->current_test_info();
+		m_directory = std::filesystem::temp_directory_path()
+			/ (std::string("ThumbnailDiskCacheTest_") + testInfo->name());
+		std::filesystem::remove_all(m_directory);
+		std::filesystem::create_directories(m_directory);
+
+		m_packFilePath = m_directory / "Thumbnails.pack";
+		m_indexFilePath = m_directory / "Thumbnails.idx";
+	}
+
+	void TearDown() override
+	{
+		std::error_code errorCode;
+		std::filesystem::remove_all(m_directory, errorCode);
+	}
+
+	std::unique_ptr<ThumbnailDiskCache> CreateCache(uint64_t maxSize = 1024 * 1024)
+	{
+		return std::make_unique<ThumbnailDiskCache>(m_packFilePath, m_indexFilePath, maxSize);
+	}
+
+	std::filesystem::path m_directory;
+	std::filesystem::path m_packFilePath;
+	std::filesystem::path m_indexFilePath;
+};
+
+TEST_F(ThumbnailDiskCacheTest, AddAndFind)
+{
+	auto cache = CreateCache();
+
+	auto image1 = BuildImage(10, 8, 1);
+	auto image2 = BuildImage(3, 5, 2);
+	EXPECT_TRUE(cache->Add(BuildKey(1), image1));
+	EXPECT_TRUE(cache->Add(BuildKey(2), image2));
+
+	ExpectImagesEqual(image1, cache->Find(BuildKey(1)));
+	ExpectImagesEqual(image2, cache->Find(BuildKey(2)));
+	EXPECT_FALSE(cache->Find(BuildKey(3)).has_value());
+	EXPECT_EQ(cache->GetNumEntries(), 2U);
+}
+
+TEST_F(ThumbnailDiskCacheTest, KeyMismatch)
+{
+	auto cache = CreateCache();
+	cache->Add(BuildKey(1), BuildImage(4, 4, 1));
+
+	// The file has since been modified.
+	EXPECT_FALSE(cache->Find(BuildKey(1, 2000)).has_value());
+
+	// A different thumbnail size was requested.
+	ThumbnailKey key = BuildKey(1);
+	key.width = 256;
+	key.height = 256;
+	EXPECT_FALSE(cache->Find(key).has_value());
+}
+
+TEST_F(ThumbnailDiskCacheTest, InvalidImage)
+{
+	auto cache = CreateCache();
+
+	ThumbnailImage image = BuildImage(4, 4, 1);
+	image.pixels.pop_back();
+	EXPECT_FALSE(cache->Add(BuildKey(1), image));
+	EXPECT_EQ(cache->GetNumEntries(), 0U);
+}
+
+TEST_F(ThumbnailDiskCacheTest, RoundTrip)
+{
+	auto image1 = BuildImage(16, 12, 1);
+	auto image2 = BuildImage(7, 9, 2);
+
+	{
+		auto cache = CreateCache();
+		cache->Add(BuildKey(1), image1);
+		cache->Add(BuildKey(2), image2);
+	}
+
+	auto cache = CreateCache();
+	EXPECT_EQ(cache->GetNumEntries(), 2U);
+	ExpectImagesEqual(image1, cache->Find(BuildKey(1)));
+	ExpectImagesEqual(image2, cache->Find(BuildKey(2)));
+
+	// It should still be possible to add items after reloading.
+	auto image3 = BuildImage(2, 2, 3);
+	EXPECT_TRUE(cache->Add(BuildKey(3), image3));
+	ExpectImagesEqual(image3, cache->Find(BuildKey(3)));
+}
+
+TEST_F(ThumbnailDiskCacheTest, MissingIndex)
+{
+	auto image = BuildImage(16, 12, 1);
+
+	{
+		auto cache = CreateCache();
+		cache->Add(BuildKey(1), image);
+	}
+
+	std::filesystem::remove(m_indexFilePath);
+
+	auto cache = CreateCache();
+	ExpectImagesEqual(image, cache->Find(BuildKey(1)));
+}
+
+// Simulates the application exiting without saving the index. The thumbnails
+// added after the index was saved should still be available.
+TEST_F(ThumbnailDiskCacheTest, StaleIndex)
+{
+	auto image1 = BuildImage(16, 12, 1);
+	auto image2 = BuildImage(7, 9, 2);
+	std::filesystem::path savedIndexFilePath = m_directory / "Saved.idx";
+
+	{
+		auto cache = CreateCache();
+		cache->Add(BuildKey(1), image1);
+		ASSERT_TRUE(cache->SaveIndex());
+		std::filesystem::copy_file(m_indexFilePath, savedIndexFilePath);
+
+		cache->Add(BuildKey(2), image2);
+	}
+
+	std::filesystem::copy_file(savedIndexFilePath, m_indexFilePath,
+		std::filesystem::copy_options::overwrite_existing);
+
+	auto cache = CreateCache();
+	EXPECT_EQ(cache->GetNumEntries(), 2U);
+	ExpectImagesEqual(image1, cache->Find(BuildKey(1)));
+	ExpectImagesEqual(image2, cache->Find(BuildKey(2)));
+}
+
+TEST_F(ThumbnailDiskCacheTest, TruncatedPackFile)
+{
+	auto image1 = BuildImage(16, 12, 1);
+	auto image2 = BuildImage(7, 9, 2);
+
+	{
+		auto cache = CreateCache();
+		cache->Add(BuildKey(1), image1);
+		cache->Add(BuildKey(2), image2);
+	}
+
+	// Remove part of the last record.
+	std::filesystem::resize_file(m_packFilePath, std::filesystem::file_size(m_packFilePath) - 10);
+
+	auto cache = CreateCache();
+	EXPECT_EQ(cache->GetNumEntries(), 1U);
+	ExpectImagesEqual(image1, cache->Find(BuildKey(1)));
+	EXPECT_FALSE(cache->Find(BuildKey(2)).has_value());
+
+	// The partial record should have been discarded, so that new records
+	// can be read back.
+	EXPECT_TRUE(cache->Add(BuildKey(2), image2));
+	ExpectImagesEqual(image2, cache->Find(BuildKey(2)));
+}
+
+TEST_F(ThumbnailDiskCacheTest, CorruptPackFile)
+{
+	{
+		std::ofstream stream(m_packFilePath, std::ios::binary);
+		stream << "This isn't a pack file";
+	}
+
+	auto cache = CreateCache();
+	EXPECT_EQ(cache->GetNumEntries(), 0U);
+
+	auto image = BuildImage(4, 4, 1);
+	EXPECT_TRUE(cache->Add(BuildKey(1), image));
+	ExpectImagesEqual(image, cache->Find(BuildKey(1)));
+}
+
+TEST_F(ThumbnailDiskCacheTest, ReplacedThumbnail)
+{
+	auto cache = CreateCache();
+
+	auto image1 = BuildImage(4, 4, 1);
+	auto image2 = BuildImage(4, 4, 2);
+	cache->Add(BuildKey(1, 1000), image1);
+
+	// The same file, after it's been modified.
+	cache->Add(BuildKey(1, 2000), image2);
+
+	EXPECT_EQ(cache->GetNumEntries(), 1U);
+	EXPECT_FALSE(cache->Find(BuildKey(1, 1000)).has_value());
+	ExpectImagesEqual(image2, cache->Find(BuildKey(1, 2000)));
+	EXPECT_GT(cache->GetWastedBytes(), 0U);
+}
+
+TEST_F(ThumbnailDiskCacheTest, Compact)
+{
+	const uint64_t maxSize = 64 * 1024;
+	auto cache = CreateCache(maxSize);
+
+	for (uint64_t i = 0; i < 5; i++)
+	{
+		cache->Add(BuildKey(i), BuildImage(32, 32, static_cast<uint8_t>(i)));
+	}
+
+	// Replace one of the thumbnails, so that there's some wasted space.
+	cache->Add(BuildKey(0, 2000), BuildImage(32, 32, 0));
+	EXPECT_GT(cache->GetWastedBytes(), 0U);
+
+	cache->Compact();
+
+	// Every thumbnail fits within the maximum size, so compaction should only
+	// have removed the wasted space.
+	EXPECT_EQ(cache->GetWastedBytes(), 0U);
+	EXPECT_LE(cache->GetPackFileSize(), maxSize);
+	EXPECT_EQ(cache->GetPackFileSize(), std::filesystem::file_size(m_packFilePath));
+
+	ExpectImagesEqual(BuildImage(32, 32, 0), cache->Find(BuildKey(0, 2000)));
+
+	for (uint64_t i = 1; i < 5; i++)
+	{
+		ExpectImagesEqual(BuildImage(32, 32, static_cast<uint8_t>(i)), cache->Find(BuildKey(i)));
+	}
+}
+
+TEST_F(ThumbnailDiskCacheTest, SizeCap)
+{
+	const uint64_t maxSize = 64 * 1024;
+
+	{
+		auto cache = CreateCache(maxSize);
+
+		// The least recently used items are evicted first, so the first item
+		// should be retained, since it's repeatedly used.
+		for (uint64_t i = 0; i < 200; i++)
+		{
+			cache->Add(BuildKey(i), BuildImage(32, 32, static_cast<uint8_t>(i)));
+			cache->Find(BuildKey(0));
+		}
+	}
+
+	// Compaction happens in the background, but should have finished by the
+	// time the cache was destroyed.
+	auto cache = CreateCache(maxSize);
+	EXPECT_LE(cache->GetPackFileSize(), maxSize);
+	EXPECT_LE(std::filesystem::file_size(m_packFilePath), maxSize);
+	EXPECT_GT(cache->GetNumEntries(), 0U);
+
+	ExpectImagesEqual(BuildImage(32, 32, 0), cache->Find(BuildKey(0)));
+	ExpectImagesEqual(BuildImage(32, 32, 199), cache->Find(BuildKey(199)));
+	EXPECT_FALSE(cache->Find(BuildKey(1)).has_value());
+}
\ No newline at end of file
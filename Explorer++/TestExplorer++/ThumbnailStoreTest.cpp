@@ -0,0 +1,184 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "../Explorer++/ShellBrowser/ThumbnailStore.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+const size_t THUMBNAIL_SIZE = 100;
+}
+
+TEST(ThumbnailStoreTest, InsertAndLookup)
+{
+	ThumbnailStore thumbnailStore(THUMBNAIL_SIZE * 10);
+
+	auto result = thumbnailStore.Insert(1, THUMBNAIL_SIZE);
+	EXPECT_EQ(result.slot, 0);
+	EXPECT_TRUE(result.evictedKeys.empty());
+
+	result = thumbnailStore.Insert(2, THUMBNAIL_SIZE);
+	EXPECT_EQ(result.slot, 1);
+
+	EXPECT_EQ(thumbnailStore.Lookup(1), 0);
+	EXPECT_EQ(thumbnailStore.Lookup(2), 1);
+	EXPECT_EQ(thumbnailStore.Lookup(3), std::nullopt);
+
+	auto stats = thumbnailStore.GetStats();
+	EXPECT_EQ(stats.residentBytes, THUMBNAIL_SIZE * 2);
+	EXPECT_EQ(stats.numEntries, 2U);
+	EXPECT_EQ(stats.hits, 2U);
+	EXPECT_EQ(stats.misses, 1U);
+	EXPECT_EQ(stats.evictions, 0U);
+}
+
+TEST(ThumbnailStoreTest, EvictsLeastRecentlyUsed)
+{
+	ThumbnailStore thumbnailStore(THUMBNAIL_SIZE * 3);
+
+	thumbnailStore.Insert(1, THUMBNAIL_SIZE);
+	thumbnailStore.Insert(2, THUMBNAIL_SIZE);
+	thumbnailStore.Insert(3, THUMBNAIL_SIZE);
+
+	// This should make 2 the least recently used item.
+	thumbnailStore.Lookup(1);
+
+	auto result = thumbnailStore.Insert(4, THUMBNAIL_SIZE);
+	EXPECT_EQ(result.evictedKeys, std::vector<int>{ 2 });
+
+	// The slot previously used by 2 should be reused.
+	EXPECT_EQ(result.slot, 1);
+	EXPECT_EQ(thumbnailStore.GetNumSlots(), 3);
+
+	EXPECT_EQ(thumbnailStore.GetSlot(2), std::nullopt);
+	EXPECT_EQ(thumbnailStore.GetSlot(1), 0);
+	EXPECT_EQ(thumbnailStore.GetSlot(3), 2);
+	EXPECT_EQ(thumbnailStore.GetSlot(4), 1);
+
+	auto stats = thumbnailStore.GetStats();
+	EXPECT_EQ(stats.residentBytes, THUMBNAIL_SIZE * 3);
+	EXPECT_EQ(stats.evictions, 1U);
+}
+
+TEST(ThumbnailStoreTest, EvictsMultipleToFit)
+{
+	ThumbnailStore thumbnailStore(THUMBNAIL_SIZE * 3);
+
+	thumbnailStore.Insert(1, THUMBNAIL_SIZE);
+	thumbnailStore.Insert(2, THUMBNAIL_SIZE);
+	thumbnailStore.Insert(3, THUMBNAIL_SIZE);
+
+	auto result = thumbnailStore.Insert(4, THUMBNAIL_SIZE * 2);
+	EXPECT_EQ(result.evictedKeys, (std::vector<int>{ 1, 2 }));
+	EXPECT_EQ(thumbnailStore.GetStats().residentBytes, THUMBNAIL_SIZE * 3);
+}
+
+TEST(ThumbnailStoreTest, EvictionFilter)
+{
+	ThumbnailStore thumbnailStore(THUMBNAIL_SIZE * 2);
+
+	thumbnailStore.Insert(1, THUMBNAIL_SIZE);
+	thumbnailStore.Insert(2, THUMBNAIL_SIZE);
+
+	// 1 is the least recently used item, but it's visible, so it shouldn't
+	// be evicted.
+	auto result = thumbnailStore.Insert(3, THUMBNAIL_SIZE, [](int key) { return key != 1; });
+	EXPECT_EQ(result.evictedKeys, std::vector<int>{ 2 });
+	EXPECT_EQ(thumbnailStore.GetSlot(1), 0);
+
+	// If nothing can be evicted, the budget is exceeded, rather than
+	// evicting a visible thumbnail.
+	result = thumbnailStore.Insert(4, THUMBNAIL_SIZE, [](int) { return false; });
+	EXPECT_TRUE(result.evictedKeys.empty());
+	EXPECT_EQ(result.slot, 2);
+
+	auto stats = thumbnailStore.GetStats();
+	EXPECT_EQ(stats.numEntries, 3U);
+	EXPECT_EQ(stats.residentBytes, THUMBNAIL_SIZE * 3);
+}
+
+TEST(ThumbnailStoreTest, ReplaceKeepsSlot)
+{
+	ThumbnailStore thumbnailStore(THUMBNAIL_SIZE * 2);
+
+	thumbnailStore.Insert(1, THUMBNAIL_SIZE);
+	thumbnailStore.Insert(2, THUMBNAIL_SIZE);
+
+	auto result = thumbnailStore.Insert(1, THUMBNAIL_SIZE);
+	EXPECT_EQ(result.slot, 0);
+	EXPECT_TRUE(result.evictedKeys.empty());
+	EXPECT_EQ(thumbnailStore.GetStats().residentBytes, THUMBNAIL_SIZE * 2);
+
+	// Replacing 1 should also have made it the most recently used item.
+	result = thumbnailStore.Insert(3, THUMBNAIL_SIZE);
+	EXPECT_EQ(result.evictedKeys, std::vector<int>{ 2 });
+
+	// A larger replacement should evict other items, but never the item
+	// being replaced.
+	result = thumbnailStore.Insert(1, THUMBNAIL_SIZE * 2);
+	EXPECT_EQ(result.slot, 0);
+	EXPECT_EQ(result.evictedKeys, std::vector<int>{ 3 });
+	EXPECT_EQ(thumbnailStore.GetStats().residentBytes, THUMBNAIL_SIZE * 2);
+}
+
+TEST(ThumbnailStoreTest, Remove)
+{
+	ThumbnailStore thumbnailStore(THUMBNAIL_SIZE * 10);
+
+	thumbnailStore.Insert(1, THUMBNAIL_SIZE);
+	thumbnailStore.Insert(2, THUMBNAIL_SIZE);
+
+	thumbnailStore.Remove(1);
+	thumbnailStore.Remove(5);
+
+	EXPECT_EQ(thumbnailStore.GetSlot(1), std::nullopt);
+
+	auto stats = thumbnailStore.GetStats();
+	EXPECT_EQ(stats.numEntries, 1U);
+	EXPECT_EQ(stats.residentBytes, THUMBNAIL_SIZE);
+
+	// Removing an item isn't an eviction.
+	EXPECT_EQ(stats.evictions, 0U);
+
+	EXPECT_EQ(thumbnailStore.Insert(3, THUMBNAIL_SIZE).slot, 0);
+}
+
+TEST(ThumbnailStoreTest, Clear)
+{
+	ThumbnailStore thumbnailStore(THUMBNAIL_SIZE);
+
+	thumbnailStore.Insert(1, THUMBNAIL_SIZE);
+	thumbnailStore.Insert(2, THUMBNAIL_SIZE);
+	thumbnailStore.Lookup(2);
+
+	thumbnailStore.Clear();
+
+	EXPECT_EQ(thumbnailStore.GetNumSlots(), 0);
+	EXPECT_EQ(thumbnailStore.GetSlot(2), std::nullopt);
+
+	auto stats = thumbnailStore.GetStats();
+	EXPECT_EQ(stats.numEntries, 0U);
+	EXPECT_EQ(stats.residentBytes, 0U);
+	EXPECT_EQ(stats.hits, 1U);
+	EXPECT_EQ(stats.evictions, 1U);
+
+	EXPECT_EQ(thumbnailStore.Insert(3, THUMBNAIL_SIZE).slot, 0);
+}
+
+TEST(ThumbnailStoreTest, SetByteBudget)
+{
+	ThumbnailStore thumbnailStore(THUMBNAIL_SIZE * 4);
+
+	for (int i = 0; i < 4; i++)
+	{
+		thumbnailStore.Insert(i, THUMBNAIL_SIZE);
+	}
+
+	thumbnailStore.SetByteBudget(THUMBNAIL_SIZE * 2);
+	EXPECT_EQ(thumbnailStore.GetByteBudget(), THUMBNAIL_SIZE * 2);
+
+	auto result = thumbnailStore.Insert(4, THUMBNAIL_SIZE);
+	EXPECT_EQ(result.evictedKeys, (std::vector<int>{ 0, 1, 2 }));
+	EXPECT_EQ(thumbnailStore.GetStats().residentBytes, THUMBNAIL_SIZE * 2);
+}
\ No newline at end of file
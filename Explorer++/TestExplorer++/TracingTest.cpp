@@ -0,0 +1,184 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "../Helper/Tracing.h"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+size_t CountOccurrences(const std::string &text, const std::string &value)
+{
+	size_t count = 0;
+
+	for (size_t position = text.find(value); position != std::string::npos;
+		 position = text.find(value, position + value.size()))
+	{
+		count++;
+	}
+
+	return count;
+}
+}
+
+class TracingTest : public Test
+{
+protected:
+	static constexpr uint32_t PROCESS_ID = 1234;
+
+	void SetUp() override
+	{
+		m_recorder.SetEnabled(true);
+		g_traceRecorder.store(&m_recorder);
+	}
+
+	void TearDown() override
+	{
+		g_traceRecorder.store(nullptr);
+	}
+
+	std::string GetTrace()
+	{
+		std::ostringstream stream;
+		m_recorder.WriteChromeTrace(stream, PROCESS_ID);
+		return stream.str();
+	}
+
+	TraceRecorder m_recorder;
+};
+
+TEST_F(TracingTest, CompleteEvent)
+{
+	{
+		TRACE_EVENT("navigation", "BrowseFolder");
+		TRACE_EVENT1("navigation", "InsertItems", "numItems", 42);
+	}
+
+	EXPECT_EQ(m_recorder.GetStats().numRecorded, 2U);
+
+	std::string trace = GetTrace();
+	EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0U);
+	EXPECT_NE(trace.find("\"displayTimeUnit\":\"ms\""), std::string::npos);
+	EXPECT_NE(trace.find("{\"name\":\"BrowseFolder\",\"cat\":\"navigation\",\"ph\":\"X\",\"ts\":"),
+		std::string::npos);
+	EXPECT_NE(trace.find("\"pid\":1234"), std::string::npos);
+	EXPECT_NE(trace.find("\"args\":{\"numItems\":42}"), std::string::npos);
+	EXPECT_EQ(CountOccurrences(trace, "\"dur\":"), 2U);
+}
+
+TEST_F(TracingTest, CounterAndInstantEvents)
+{
+	TRACE_COUNTER("tasks", "PendingColumnResults", 7);
+	m_recorder.AddInstantEvent("navigation", "NavigationCancelled");
+
+	std::string trace = GetTrace();
+	EXPECT_NE(trace.find("{\"name\":\"PendingColumnResults\",\"cat\":\"tasks\",\"ph\":\"C\""),
+		std::string::npos);
+	EXPECT_NE(trace.find("\"args\":{\"value\":7}"), std::string::npos);
+	EXPECT_NE(trace.find("\"ph\":\"i\""), std::string::npos);
+	EXPECT_NE(trace.find("\"s\":\"t\""), std::string::npos);
+}
+
+TEST_F(TracingTest, Elapsed)
+{
+	auto queuedTime = GetTraceTimestamp();
+	EXPECT_NE(queuedTime, TraceRecorder::Clock::time_point());
+
+	TRACE_ELAPSED("tasks", "ColumnTaskQueued", queuedTime);
+
+	// A task queued while tracing was disabled won't have a timestamp.
+	TRACE_ELAPSED("tasks", "Ignored", TraceRecorder::Clock::time_point());
+
+	std::string trace = GetTrace();
+	EXPECT_NE(trace.find("\"name\":\"ColumnTaskQueued\""), std::string::npos);
+	EXPECT_EQ(trace.find("\"name\":\"Ignored\""), std::string::npos);
+}
+
+TEST_F(TracingTest, Disabled)
+{
+	m_recorder.SetEnabled(false);
+
+	{
+		TRACE_EVENT("navigation", "BrowseFolder");
+		TRACE_COUNTER("tasks", "PendingColumnResults", 1);
+	}
+
+	EXPECT_EQ(GetTraceTimestamp(), TraceRecorder::Clock::time_point());
+
+	g_traceRecorder.store(nullptr);
+
+	{
+		TRACE_EVENT("navigation", "BrowseFolder");
+	}
+
+	EXPECT_EQ(m_recorder.GetStats().numRecorded, 0U);
+	EXPECT_EQ(CountOccurrences(GetTrace(), "\"ph\":"), 0U);
+}
+
+TEST_F(TracingTest, MultipleThreads)
+{
+	constexpr int numThreads = 4;
+	constexpr int eventsPerThread = 100;
+
+	m_recorder.SetCurrentThreadName("Main");
+
+	std::vector<std::thread> threads;
+
+	for (int i = 0; i < numThreads; i++)
+	{
+		threads.emplace_back([] {
+			for (int j = 0; j < eventsPerThread; j++)
+			{
+				TRACE_EVENT("tasks", "ColumnTask");
+			}
+		});
+	}
+
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+
+	// The events from each thread should still be available once the thread
+	// has exited.
+	EXPECT_EQ(m_recorder.GetStats().numRecorded,
+		static_cast<uint64_t>(numThreads * eventsPerThread));
+
+	std::string trace = GetTrace();
+	EXPECT_EQ(CountOccurrences(trace, "\"name\":\"ColumnTask\""),
+		static_cast<size_t>(numThreads * eventsPerThread));
+	EXPECT_NE(trace.find("\"name\":\"thread_name\",\"ph\":\"M\""), std::string::npos);
+	EXPECT_NE(trace.find("\"args\":{\"name\":\"Main\"}"), std::string::npos);
+}
+
+TEST_F(TracingTest, DroppedEvents)
+{
+	constexpr size_t maxEvents =
+		TraceRecorder::EVENTS_PER_CHUNK * TraceRecorder::MAX_CHUNKS_PER_THREAD;
+	constexpr size_t numExtraEvents = 10;
+
+	for (size_t i = 0; i < maxEvents + numExtraEvents; i++)
+	{
+		TRACE_COUNTER("tasks", "Counter", i);
+	}
+
+	auto stats = m_recorder.GetStats();
+	EXPECT_EQ(stats.numRecorded, maxEvents);
+	EXPECT_EQ(stats.numDropped, numExtraEvents);
+
+	EXPECT_NE(GetTrace().find("\"droppedEvents\":10"), std::string::npos);
+}
+
+TEST_F(TracingTest, Escaping)
+{
+	m_recorder.SetCurrentThreadName("Worker \"1\"\\\n");
+
+	std::string trace = GetTrace();
+	EXPECT_NE(trace.find("\"args\":{\"name\":\"Worker \\\"1\\\"\\\\\\u000a\"}"), std::string::npos);
+}
\ No newline at end of file
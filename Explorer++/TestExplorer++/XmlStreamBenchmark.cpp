@@ -0,0 +1,252 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+// Measures how long it takes to read and write a large, generated config file
+// (with thousands of bookmarks and a long list of tabs) using XmlStreamReader
+// and XmlStreamWriter. The config file is read the same way it's read on
+// startup: the document is split into sections, each of which is then read
+// separately. These tests are disabled by default and can be run
+// with --gtest_also_run_disabled_tests --gtest_filter=XmlStreamBenchmark.*
+//
+// XmlStream doesn't depend on any Windows APIs, so this file can also be
+// built and run on Linux, e.g.:
+//
+// g++ -std=c++17 -O2 -I<dir containing an empty stdafx.h>
+//     TestExplorer++/XmlStreamBenchmark.cpp Helper/XmlStream.cpp
+//     -lgtest -lgtest_main -pthread
+
+#include "../Helper/PerfectHash.h"
+#include "../Helper/XmlStream.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+constexpr int NUM_SETTINGS = 75;
+constexpr int NUM_TABS = 200;
+constexpr int NUM_BOOKMARK_FOLDERS = 100;
+constexpr int BOOKMARKS_PER_FOLDER = 50;
+
+const wchar_t *const COLUMN_NAMES[] = { L"Name", L"Type", L"Size", L"DateModified",
+	L"Attributes", L"SizeOnDisk", L"ShortName", L"Owner" };
+
+std::wstring GenerateConfig()
+{
+	XmlStreamWriter writer;
+	writer.WriteDeclaration();
+	writer.WriteComment(L" Preference file for Explorer++ ");
+	writer.StartElement(L"ExplorerPlusPlus");
+
+	writer.StartElement(L"Settings");
+
+	for (int i = 0; i < NUM_SETTINGS; i++)
+	{
+		writer.StartElement(L"Setting");
+		writer.WriteAttribute(L"name", L"Setting" + std::to_wstring(i));
+		writer.WriteText(i % 2 == 0 ? L"yes" : L"no");
+		writer.EndElement();
+	}
+
+	writer.EndElement();
+
+	writer.StartElement(L"Tabs");
+
+	for (int i = 0; i < NUM_TABS; i++)
+	{
+		writer.StartElement(L"Tab");
+		writer.WriteAttribute(L"name", std::to_wstring(i));
+		writer.WriteAttribute(L"Directory", L"C:\\Users\\User\\Documents\\Folder" + std::to_wstring(i));
+		writer.WriteAttribute(L"ApplyFilter", L"no");
+		writer.WriteAttribute(L"AutoArrange", L"yes");
+		writer.WriteAttribute(L"Filter", L"");
+		writer.WriteAttribute(L"ShowHidden", L"no");
+		writer.WriteAttribute(L"SortMode", L"1");
+		writer.WriteAttribute(L"ViewMode", L"4");
+
+		writer.StartElement(L"Columns");
+
+		for (const wchar_t *columnSet : { L"Generic", L"MyComputer", L"ControlPanel",
+				 L"RecycleBin", L"Printers", L"Network", L"NetworkPlaces" })
+		{
+			writer.StartElement(L"Column");
+			writer.WriteAttribute(L"name", columnSet);
+
+			for (const wchar_t *column : COLUMN_NAMES)
+			{
+				writer.WriteAttribute(column, L"yes");
+				writer.WriteAttribute(std::wstring(column) + L"_Width", L"150");
+			}
+
+			writer.EndElement();
+		}
+
+		writer.EndElement();
+		writer.EndElement();
+	}
+
+	writer.EndElement();
+
+	writer.StartElement(L"Bookmarksv2");
+
+	for (int i = 0; i < NUM_BOOKMARK_FOLDERS; i++)
+	{
+		writer.StartElement(L"Bookmark");
+		writer.WriteAttribute(L"name", std::to_wstring(i));
+		writer.WriteAttribute(L"Type", L"0");
+		writer.WriteAttribute(L"GUID", L"{7A1B2C3D-4E5F-6789-ABCD-EF0123456789}");
+		writer.WriteAttribute(L"ItemName", L"Folder " + std::to_wstring(i));
+
+		for (int j = 0; j < BOOKMARKS_PER_FOLDER; j++)
+		{
+			writer.StartElement(L"Bookmark");
+			writer.WriteAttribute(L"name", std::to_wstring(j));
+			writer.WriteAttribute(L"Type", L"1");
+			writer.WriteAttribute(L"GUID", L"{0F1E2D3C-4B5A-6978-8796-A5B4C3D2E1F0}");
+			writer.WriteAttribute(L"ItemName", L"Bookmark & " + std::to_wstring(j));
+			writer.WriteAttribute(
+				L"Location", L"C:\\Projects\\Project" + std::to_wstring(i * 1000 + j));
+			writer.WriteAttribute(L"DateCreatedLow", L"3577643008");
+			writer.WriteAttribute(L"DateCreatedHigh", L"30828087");
+			writer.EndElement();
+		}
+
+		writer.EndElement();
+	}
+
+	writer.EndElement();
+
+	writer.EndElement();
+
+	return writer.GetDocument();
+}
+
+template <typename Function>
+double MeasureMilliseconds(Function function, int iterations)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < iterations; i++)
+	{
+		function();
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+}
+
+TEST(XmlStreamBenchmark, DISABLED_ReadAndWrite)
+{
+	const int iterations = 20;
+
+	std::wstring document = GenerateConfig();
+	std::string encodedDocument = EncodeXmlDocument(document);
+
+	size_t numElements = 0;
+	size_t numAttributes = 0;
+
+	double readTime = MeasureMilliseconds(
+		[&]()
+		{
+			auto decodedDocument = DecodeXmlDocument(encodedDocument);
+			ASSERT_TRUE(decodedDocument);
+
+			XmlSections sections(*decodedDocument);
+			numElements = 0;
+			numAttributes = 0;
+
+			for (const wchar_t *name : { L"Settings", L"Tabs", L"Bookmarksv2" })
+			{
+				auto reader = sections.OpenSection(name);
+				ASSERT_TRUE(reader);
+
+				XmlStreamReader::Token token = reader->GetToken();
+
+				do
+				{
+					ASSERT_NE(token, XmlStreamReader::Token::Error);
+
+					if (token == XmlStreamReader::Token::StartElement)
+					{
+						numElements++;
+						numAttributes += reader->GetNumAttributes();
+					}
+				} while ((token = reader->ReadNext()) != XmlStreamReader::Token::EndDocument);
+			}
+		},
+		iterations);
+
+	double writeTime = MeasureMilliseconds(
+		[]()
+		{
+			std::string output = EncodeXmlDocument(GenerateConfig());
+			EXPECT_FALSE(output.empty());
+		},
+		iterations);
+
+	printf("Document: %zu KB, %zu elements, %zu attributes\n", encodedDocument.size() / 1024,
+		numElements, numAttributes);
+	printf("Decode, split and read: %.2f ms\n", readTime);
+	printf("Generate and encode: %.2f ms\n", writeTime);
+}
+
+TEST(XmlStreamBenchmark, DISABLED_SettingDispatch)
+{
+	const int iterations = 1000000;
+
+	constexpr std::pair<std::wstring_view, int> entries[] = { { L"AllowMultipleInstances", 0 },
+		{ L"AlwaysOpenInNewTab", 1 }, { L"AlwaysShowTabBar", 2 }, { L"AutoArrangeGlobal", 3 },
+		{ L"CheckBoxSelection", 4 }, { L"CloseMainWindowOnTabClose", 5 },
+		{ L"ConfirmCloseTabs", 6 }, { L"DisplayCentreColor", 7 }, { L"DisplayFont", 8 },
+		{ L"DisplaySurroundColor", 9 }, { L"DisplayTextColor", 10 },
+		{ L"DisplayWindowWidth", 11 }, { L"DisplayWindowHeight", 12 },
+		{ L"ShowFolders", 13 }, { L"ShowHiddenGlobal", 14 }, { L"ViewModeGlobal", 15 } };
+	constexpr auto perfectHashMap = MakePerfectHashMap(entries);
+
+	std::unordered_map<std::wstring, int> unorderedMap;
+
+	for (const auto &[key, value] : entries)
+	{
+		unorderedMap.emplace(key, value);
+	}
+
+	std::vector<std::wstring> names;
+
+	for (const auto &[key, value] : entries)
+	{
+		names.emplace_back(key);
+	}
+
+	int perfectHashSum = 0;
+	double perfectHashTime = MeasureMilliseconds(
+		[&]()
+		{
+			for (const auto &name : names)
+			{
+				perfectHashSum += *perfectHashMap.Find(name);
+			}
+		},
+		iterations / static_cast<int>(names.size()));
+
+	int unorderedMapSum = 0;
+	double unorderedMapTime = MeasureMilliseconds(
+		[&]()
+		{
+			for (const auto &name : names)
+			{
+				unorderedMapSum += unorderedMap.find(name)->second;
+			}
+		},
+		iterations / static_cast<int>(names.size()));
+
+	EXPECT_EQ(perfectHashSum, unorderedMapSum);
+
+	printf("PerfectHashMap: %.1f ns per lookup\n", perfectHashTime * 1000000 / names.size());
+	printf("unordered_map: %.1f ns per lookup\n", unorderedMapTime * 1000000 / names.size());
+}
\ No newline at end of file
@@ -0,0 +1,390 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "../Helper/XmlStream.h"
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <vector>
+
+using Token = XmlStreamReader::Token;
+
+namespace
+{
+struct Element
+{
+	std::wstring name;
+	std::map<std::wstring, std::wstring> attributes;
+	std::wstring text;
+	std::vector<Element> children;
+
+	bool operator==(const Element &other) const
+	{
+		return name == other.name && attributes == other.attributes && text == other.text
+			&& children == other.children;
+	}
+};
+
+void WriteElement(XmlStreamWriter &writer, const Element &element)
+{
+	writer.StartElement(element.name);
+
+	for (const auto &[name, value] : element.attributes)
+	{
+		writer.WriteAttribute(name, value);
+	}
+
+	if (!element.text.empty())
+	{
+		writer.WriteText(element.text);
+	}
+
+	for (const auto &child : element.children)
+	{
+		WriteElement(writer, child);
+	}
+
+	writer.EndElement();
+}
+
+// Should be called when the reader is positioned on a StartElement.
+std::optional<Element> ReadElement(XmlStreamReader &reader)
+{
+	Element element;
+	element.name = reader.GetName();
+
+	for (size_t i = 0; i < reader.GetNumAttributes(); i++)
+	{
+		element.attributes[reader.GetAttributeName(i)] = reader.GetAttributeValue(i);
+	}
+
+	while (true)
+	{
+		switch (reader.ReadNext())
+		{
+		case Token::StartElement:
+		{
+			auto child = ReadElement(reader);
+
+			if (!child)
+			{
+				return std::nullopt;
+			}
+
+			element.children.push_back(*child);
+		}
+		break;
+
+		case Token::Text:
+			element.text += reader.GetText();
+			break;
+
+		case Token::EndElement:
+			return element;
+
+		default:
+			return std::nullopt;
+		}
+	}
+}
+
+std::optional<Element> ReadDocument(const std::wstring &document)
+{
+	XmlStreamReader reader(document);
+
+	if (reader.ReadNext() != Token::StartElement)
+	{
+		return std::nullopt;
+	}
+
+	auto root = ReadElement(reader);
+
+	if (!root || reader.ReadNext() != Token::EndDocument)
+	{
+		return std::nullopt;
+	}
+
+	return root;
+}
+
+std::vector<Token> ReadAllTokens(const std::wstring &document)
+{
+	XmlStreamReader reader(document);
+	std::vector<Token> tokens;
+
+	while (true)
+	{
+		Token token = reader.ReadNext();
+		tokens.push_back(token);
+
+		if (token == Token::EndDocument || token == Token::Error)
+		{
+			return tokens;
+		}
+	}
+}
+}
+
+TEST(XmlStreamReaderTest, Elements)
+{
+	std::wstring document = LR"(<?xml version="1.0"?>
+<!-- Preference file -->
+<Root>
+	<Setting name="ShowFolders">yes</Setting>
+	<Empty a="1"/>
+</Root>)";
+
+	XmlStreamReader reader(document);
+
+	ASSERT_EQ(reader.ReadNext(), Token::StartElement);
+	EXPECT_EQ(reader.GetName(), L"Root");
+	EXPECT_EQ(reader.GetDepth(), 1);
+
+	ASSERT_EQ(reader.ReadNext(), Token::StartElement);
+	EXPECT_EQ(reader.GetName(), L"Setting");
+	EXPECT_EQ(reader.GetDepth(), 2);
+	ASSERT_EQ(reader.GetNumAttributes(), 1U);
+	EXPECT_EQ(reader.GetAttributeName(0), L"name");
+	EXPECT_EQ(reader.FindAttribute(L"name"), L"ShowFolders");
+	EXPECT_EQ(reader.FindAttribute(L"missing"), std::nullopt);
+
+	ASSERT_EQ(reader.ReadNext(), Token::Text);
+	EXPECT_EQ(reader.GetText(), L"yes");
+
+	ASSERT_EQ(reader.ReadNext(), Token::EndElement);
+	EXPECT_EQ(reader.GetName(), L"Setting");
+
+	ASSERT_EQ(reader.ReadNext(), Token::StartElement);
+	EXPECT_EQ(reader.GetName(), L"Empty");
+	EXPECT_EQ(reader.FindAttribute(L"a"), L"1");
+
+	ASSERT_EQ(reader.ReadNext(), Token::EndElement);
+	EXPECT_EQ(reader.GetName(), L"Empty");
+	EXPECT_EQ(reader.GetDepth(), 2);
+
+	ASSERT_EQ(reader.ReadNext(), Token::EndElement);
+	EXPECT_EQ(reader.GetName(), L"Root");
+
+	EXPECT_EQ(reader.ReadNext(), Token::EndDocument);
+	EXPECT_EQ(reader.ReadNext(), Token::EndDocument);
+}
+
+TEST(XmlStreamReaderTest, References)
+{
+	auto root = ReadDocument(
+		LR"(<Root value="&lt;&amp;&gt;&quot;&apos;&#65;&#x42;">a &amp; b<![CDATA[<c>]]></Root>)");
+	ASSERT_TRUE(root);
+	EXPECT_EQ(root->attributes[L"value"], L"<&>\"'AB");
+	EXPECT_EQ(root->text, L"a & b<c>");
+}
+
+TEST(XmlStreamReaderTest, Whitespace)
+{
+	auto root = ReadDocument(L"<Root value=\"a\tb\r\nc\">line1\r\nline2</Root>");
+	ASSERT_TRUE(root);
+	EXPECT_EQ(root->attributes[L"value"], L"a b c");
+	EXPECT_EQ(root->text, L"line1\nline2");
+}
+
+TEST(XmlStreamReaderTest, ReadElementText)
+{
+	std::wstring document = L"<Root><a> x <!-- c --><b>y</b></a><c/><d>z</d></Root>";
+	XmlStreamReader reader(document);
+
+	ASSERT_EQ(reader.ReadNext(), Token::StartElement);
+	ASSERT_EQ(reader.ReadNext(), Token::StartElement);
+	EXPECT_EQ(reader.ReadElementText(), L" x y");
+	EXPECT_EQ(reader.GetToken(), Token::EndElement);
+	EXPECT_EQ(reader.GetName(), L"a");
+
+	ASSERT_EQ(reader.ReadNext(), Token::StartElement);
+	EXPECT_EQ(reader.ReadElementText(), L"");
+	EXPECT_EQ(reader.GetName(), L"c");
+
+	ASSERT_EQ(reader.ReadNext(), Token::StartElement);
+	EXPECT_TRUE(reader.SkipElement());
+	EXPECT_EQ(reader.GetName(), L"d");
+
+	EXPECT_EQ(reader.ReadNext(), Token::EndElement);
+	EXPECT_EQ(reader.ReadNext(), Token::EndDocument);
+}
+
+TEST(XmlStreamReaderTest, Errors)
+{
+	std::wstring invalidDocuments[] = { L"", L"<Root>", L"<Root></Other>", L"<Root a=1/>",
+		L"<Root a=\"1/>", L"<Root>&unknown;</Root>", L"<Root/><Root/>", L"text<Root/>",
+		L"<Root><!-- </Root>" };
+
+	for (const auto &document : invalidDocuments)
+	{
+		EXPECT_EQ(ReadAllTokens(document).back(), Token::Error) << document;
+	}
+}
+
+TEST(XmlStreamReaderTest, ChildElements)
+{
+	std::wstring document = L"<Root><a><nested/></a>text<b x=\"1\"/><!-- c --><c>d</c></Root>";
+
+	XmlStreamReader reader(document);
+	ASSERT_EQ(reader.ReadNext(), Token::StartElement);
+
+	int depth = reader.GetDepth();
+	std::vector<std::wstring> names;
+
+	while (reader.ReadChildElement(depth))
+	{
+		names.push_back(reader.GetName());
+	}
+
+	EXPECT_EQ(names, (std::vector<std::wstring>{ L"a", L"b", L"c" }));
+	EXPECT_EQ(reader.GetToken(), Token::EndElement);
+	EXPECT_EQ(reader.GetName(), L"Root");
+	EXPECT_EQ(reader.ReadNext(), Token::EndDocument);
+
+	XmlStreamReader invalidReader(L"<Root><a/><b>");
+	ASSERT_EQ(invalidReader.ReadNext(), Token::StartElement);
+	EXPECT_TRUE(invalidReader.ReadChildElement(1));
+	EXPECT_TRUE(invalidReader.ReadChildElement(1));
+	EXPECT_FALSE(invalidReader.ReadChildElement(1));
+	EXPECT_EQ(invalidReader.GetToken(), Token::Error);
+}
+
+TEST(XmlStreamReaderTest, ElementMarkup)
+{
+	std::wstring document = L"<Root>\r\n\t<a x=\"&amp;\">b<c/></a>\r\n\t<d/>\r\n</Root>";
+
+	XmlStreamReader reader(document);
+	ASSERT_EQ(reader.ReadNext(), Token::StartElement);
+
+	ASSERT_EQ(reader.ReadNext(), Token::StartElement);
+	EXPECT_EQ(reader.ReadElementMarkup(), L"<a x=\"&amp;\">b<c/></a>");
+	EXPECT_EQ(reader.GetName(), L"a");
+
+	ASSERT_EQ(reader.ReadNext(), Token::StartElement);
+	EXPECT_EQ(reader.ReadElementMarkup(), L"<d/>");
+
+	EXPECT_EQ(reader.ReadNext(), Token::EndElement);
+	EXPECT_EQ(reader.ReadNext(), Token::EndDocument);
+}
+
+TEST(XmlSectionsTest, OpenSection)
+{
+	std::wstring document = L"<?xml version=\"1.0\"?>\r\n"
+							L"<ExplorerPlusPlus>\r\n"
+							L"\t<Settings>\r\n"
+							L"\t\t<Setting name=\"ShowFolders\">yes</Setting>\r\n"
+							L"\t</Settings>\r\n"
+							L"\t<Toolbars/>\r\n"
+							L"</ExplorerPlusPlus>";
+
+	XmlSections sections(document);
+
+	// Sections can be read in any order.
+	auto toolbars = sections.OpenSection(L"Toolbars");
+	ASSERT_TRUE(toolbars);
+	EXPECT_EQ(toolbars->GetToken(), Token::StartElement);
+	EXPECT_EQ(toolbars->GetName(), L"Toolbars");
+	EXPECT_FALSE(toolbars->ReadChildElement(1));
+	EXPECT_EQ(toolbars->ReadNext(), Token::EndDocument);
+
+	auto settings = sections.OpenSection(L"Settings");
+	ASSERT_TRUE(settings);
+	EXPECT_EQ(settings->GetDepth(), 1);
+	ASSERT_TRUE(settings->ReadChildElement(1));
+	EXPECT_EQ(settings->FindAttribute(L"name"), L"ShowFolders");
+	EXPECT_EQ(settings->ReadElementText(), L"yes");
+	EXPECT_FALSE(settings->ReadChildElement(1));
+
+	EXPECT_FALSE(sections.OpenSection(L"Tabs"));
+	EXPECT_FALSE(sections.OpenSection(L"Setting"));
+}
+
+TEST(XmlSectionsTest, InvalidDocuments)
+{
+	// None of the sections should be available if any part of the document
+	// is invalid, including a part that comes after the section.
+	std::wstring invalidDocuments[] = { L"", L"<Root><Settings/>",
+		L"<Root><Settings/><Tabs></Root>", L"<Root><Settings/></Root><Other/>" };
+
+	for (const auto &document : invalidDocuments)
+	{
+		XmlSections sections(document);
+		EXPECT_FALSE(sections.OpenSection(L"Settings")) << document;
+	}
+}
+
+TEST(XmlStreamTest, RoundTrip)
+{
+	Element root = { L"ExplorerPlusPlus", {}, L"", {} };
+
+	Element settings = { L"Settings", {}, L"", {} };
+	settings.children.push_back({ L"Setting", { { L"name", L"ShowFolders" } }, L"yes", {} });
+	settings.children.push_back(
+		{ L"Setting", { { L"name", L"NewTabDirectory" } }, L"C:\\<Folder> & \"Files\"", {} });
+	settings.children.push_back({ L"Setting",
+		{ { L"name", L"DisplayTextColor" }, { L"r", L"0" }, { L"g", L"0" }, { L"b", L"0" } }, L"",
+		{} });
+	root.children.push_back(settings);
+
+	Element bookmarks = { L"Bookmarksv2", {}, L"", {} };
+	bookmarks.children.push_back({ L"Bookmark",
+		{ { L"Name", L"Line1\nLine2\tTabbed" }, { L"Location", L"C:\\" },
+			{ L"Description", L"\x4F60\x597D" } },
+		L"", {} });
+	root.children.push_back(bookmarks);
+
+	XmlStreamWriter writer;
+	writer.WriteDeclaration();
+	writer.WriteComment(L" Preference file for Explorer++ ");
+	WriteElement(writer, root);
+
+	EXPECT_EQ(ReadDocument(writer.GetDocument()), root);
+
+	// Each section should also be the same when it's read on its own.
+	XmlSections sections(writer.GetDocument());
+
+	for (const auto &section : root.children)
+	{
+		auto reader = sections.OpenSection(section.name);
+		ASSERT_TRUE(reader);
+		EXPECT_EQ(ReadElement(*reader), section);
+	}
+
+	// Encoding and decoding the document shouldn't change it.
+	auto decodedDocument = DecodeXmlDocument(EncodeXmlDocument(writer.GetDocument()));
+	ASSERT_TRUE(decodedDocument);
+	EXPECT_EQ(*decodedDocument, writer.GetDocument());
+}
+
+TEST(XmlStreamWriterTest, Layout)
+{
+	XmlStreamWriter writer;
+	writer.StartElement(L"Settings");
+	writer.StartElement(L"Setting");
+	writer.WriteAttribute(L"name", L"ShowFolders");
+	writer.WriteText(L"yes");
+	writer.EndElement();
+	writer.StartElement(L"Empty");
+	writer.EndElement();
+	writer.EndElement();
+
+	EXPECT_EQ(writer.GetDocument(),
+		L"<Settings>\r\n\t<Setting name=\"ShowFolders\">yes</Setting>\r\n\t<Empty/>\r\n"
+		L"</Settings>");
+}
+
+TEST(XmlDocumentEncodingTest, Decode)
+{
+	// UTF-8, with and without a byte order mark.
+	EXPECT_EQ(DecodeXmlDocument("<a>\xC3\xA9\xE2\x82\xAC</a>"), L"<a>\x00E9\x20AC</a>");
+	EXPECT_EQ(DecodeXmlDocument("\xEF\xBB\xBF<a/>"), L"<a/>");
+
+	// UTF-16LE and UTF-16BE.
+	EXPECT_EQ(DecodeXmlDocument(std::string("\xFF\xFE<\0a\0/\0>\0", 10)), L"<a/>");
+	EXPECT_EQ(DecodeXmlDocument(std::string("\xFE\xFF\0<\0a\0/\0>", 10)), L"<a/>");
+
+	// Truncated and invalid UTF-8 sequences.
+	EXPECT_EQ(DecodeXmlDocument("<a>\xE2\x82</a>"), std::nullopt);
+	EXPECT_EQ(DecodeXmlDocument("<a>\xFF</a>"), std::nullopt);
+}
\ No newline at end of file